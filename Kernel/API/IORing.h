@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// An I/O ring lives in memory owned by the process and is shared between
+// userspace and the kernel. Userspace fills submissions and advances
+// submission_tail, then calls io_ring_enter() to have the kernel consume up
+// to a given number of them in one go. For each consumed submission, the
+// kernel eventually appends a completion and advances completion_tail, either
+// right away or, for operations that had to wait, in a later io_ring_enter().
+// Userspace reaps completions by advancing completion_head.
+//
+// The ring is laid out as an IORing header, followed by `entries`
+// IORingSubmission slots, followed by `entries` IORingCompletion slots.
+// Indices are free-running and are masked with (entries - 1), so `entries`
+// must be a power of two.
+
+enum class IORingOpcode : u8 {
+    Nop = 0,
+    Read,
+    Write,
+    Fsync,
+    Accept,
+    Send,
+    Recv,
+};
+
+struct IORingSubmission {
+    IORingOpcode opcode { IORingOpcode::Nop };
+    u8 reserved[3] {};
+    i32 fd { -1 };
+    // File offset for Read and Write, or -1 to use and advance the file description's offset.
+    i64 offset { -1 };
+    u64 buffer { 0 };
+    u64 length { 0 };
+    // SOCK_NONBLOCK/SOCK_CLOEXEC for Accept, MSG_* flags for Send and Recv.
+    i32 flags { 0 };
+    u32 reserved2 { 0 };
+    u64 user_data { 0 };
+};
+static_assert(sizeof(IORingSubmission) == 48);
+
+struct IORingCompletion {
+    u64 user_data { 0 };
+    // The non-negative return value of the operation, or a negated errno value.
+    i64 result { 0 };
+};
+static_assert(sizeof(IORingCompletion) == 16);
+
+struct IORing {
+    u32 entries { 0 };
+    // Advanced by the kernel as submissions are consumed.
+    u32 submission_head { 0 };
+    // Advanced by userspace as submissions are queued.
+    u32 submission_tail { 0 };
+    // Advanced by userspace as completions are reaped.
+    u32 completion_head { 0 };
+    // Advanced by the kernel as completions are posted.
+    u32 completion_tail { 0 };
+    u32 reserved[11] {};
+};
+static_assert(sizeof(IORing) == 64);
+
+constexpr u32 IO_RING_MAX_ENTRIES = 4096;
+
+constexpr size_t io_ring_submissions_offset()
+{
+    return sizeof(IORing);
+}
+
+constexpr size_t io_ring_completions_offset(u32 entries)
+{
+    return io_ring_submissions_offset() + entries * sizeof(IORingSubmission);
+}
+
+constexpr size_t io_ring_size(u32 entries)
+{
+    return io_ring_completions_offset(entries) + entries * sizeof(IORingCompletion);
+}
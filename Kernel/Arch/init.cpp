@@ -44,6 +44,7 @@
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Library/Panic.h>
+#include <Kernel/Locking/MutexStatistics.h>
 #include <Kernel/Memory/MemoryManager.h>
 #include <Kernel/Net/NetworkTask.h>
 #include <Kernel/Net/NetworkingManagement.h>
@@ -392,6 +393,9 @@ void init_stage2(void*)
     }
 #endif
 
+    if (kernel_command_line().is_mutex_statistics_enabled())
+        MutexStatistics::initialize();
+
     // Initialize the PCI Bus as early as possible, for early boot (PCI based) serial logging
     PCI::initialize();
     if (!PCI::Access::is_disabled()) {
@@ -92,6 +92,11 @@ UNMAP_AFTER_INIT bool CommandLine::is_boot_profiling_enabled() const
     return contains("boot_prof"sv);
 }
 
+UNMAP_AFTER_INIT bool CommandLine::is_mutex_statistics_enabled() const
+{
+    return contains("mutex_stat"sv);
+}
+
 UNMAP_AFTER_INIT bool CommandLine::is_ide_enabled() const
 {
     return !contains("disable_ide"sv);
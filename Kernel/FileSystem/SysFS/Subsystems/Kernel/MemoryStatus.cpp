@@ -37,6 +37,8 @@ ErrorOr<void> SysFSMemoryStatus::try_generate(KBufferBuilder& builder)
     TRY(json.add("physical_uncommitted"sv, system_memory.physical_pages_uncommitted));
     TRY(json.add("kmalloc_call_count"sv, stats.kmalloc_call_count));
     TRY(json.add("kfree_call_count"sv, stats.kfree_call_count));
+    TRY(json.add("kmalloc_lock_acquire_count"sv, stats.lock_acquire_count));
+    TRY(json.add("kmalloc_lock_contended_count"sv, stats.lock_contended_count));
     TRY(json.finish());
     return {};
 }
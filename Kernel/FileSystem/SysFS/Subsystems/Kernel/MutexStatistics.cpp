@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonObjectSerializer.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/MutexStatistics.h>
+#include <Kernel/Locking/MutexStatistics.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT SysFSMutexStatistics::SysFSMutexStatistics(SysFSDirectory const& parent_directory)
+    : SysFSGlobalInformation(parent_directory)
+{
+}
+
+UNMAP_AFTER_INIT NonnullRefPtr<SysFSMutexStatistics> SysFSMutexStatistics::must_create(SysFSDirectory const& parent_directory)
+{
+    return adopt_ref_if_nonnull(new (nothrow) SysFSMutexStatistics(parent_directory)).release_nonnull();
+}
+
+ErrorOr<void> SysFSMutexStatistics::try_generate(KBufferBuilder& builder)
+{
+    auto json = TRY(JsonObjectSerializer<>::try_create(builder));
+    // Statistics are only kept when booting with "mutex_stat", and holder locations are only known
+    // with LOCK_DEBUG. Say so, so that an empty list isn't mistaken for an uncontended kernel.
+    TRY(json.add("enabled"sv, MutexStatistics::is_enabled()));
+    TRY(json.add("top_holders_available"sv, static_cast<bool>(LOCK_DEBUG)));
+    auto array = TRY(json.add_array("mutexes"sv));
+    TRY(MutexStatistics::for_each([&array](MutexStatistics const& statistics) -> ErrorOr<void> {
+        // The counters keep changing while we read them. Reading them in the reverse order of how a
+        // contended acquisition updates them keeps the snapshot consistent, e.g. no more contended
+        // acquisitions than acquisitions.
+        auto max_wait_time_ns = statistics.max_wait_time_ns();
+        auto total_wait_time_ns = statistics.total_wait_time_ns();
+        auto spin_acquisitions = statistics.spin_acquisitions();
+        auto contended_acquisitions = statistics.contended_acquisitions();
+        auto acquisitions = statistics.acquisitions();
+
+        auto obj = TRY(array.add_object());
+        TRY(obj.add("name"sv, statistics.name()));
+        TRY(obj.add("acquisitions"sv, acquisitions));
+        TRY(obj.add("contended_acquisitions"sv, contended_acquisitions));
+        TRY(obj.add("spin_acquisitions"sv, spin_acquisitions));
+        TRY(obj.add("total_wait_time_ns"sv, total_wait_time_ns));
+        TRY(obj.add("max_wait_time_ns"sv, max_wait_time_ns));
+        if constexpr (LOCK_DEBUG) {
+            auto holders = TRY(obj.add_array("top_holders"sv));
+            for (auto const& holder : statistics.top_holder_locations()) {
+                auto holder_obj = TRY(holders.add_object());
+                TRY(holder_obj.add("function"sv, holder.function_name));
+                TRY(holder_obj.add("file"sv, holder.filename));
+                TRY(holder_obj.add("line"sv, holder.line_number));
+                TRY(holder_obj.add("contentions"sv, holder.contentions));
+                TRY(holder_obj.finish());
+            }
+            TRY(holders.finish());
+        }
+        TRY(obj.finish());
+        return {};
+    }));
+    TRY(array.finish());
+    TRY(json.finish());
+    return {};
+}
+
+}
@@ -44,6 +44,9 @@ ErrorOr<void> SysFSNetworkAdaptersStats::try_generate(KBufferBuilder& builder)
         TRY(obj.add("link_speed"sv, adapter.link_speed()));
         TRY(obj.add("link_full_duplex"sv, adapter.link_full_duplex()));
         TRY(obj.add("mtu"sv, adapter.mtu()));
+        TRY(obj.add("checksum_offload"sv, adapter.supports_checksum_offload()));
+        TRY(obj.add("tcp_segmentation_offload"sv, adapter.supports_tcp_segmentation_offload()));
+        TRY(obj.add("receive_queues"sv, adapter.receive_queue_count()));
         TRY(obj.finish());
         return {};
     }));
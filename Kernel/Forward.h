@@ -31,12 +31,15 @@ class IPv4Socket;
 class Inode;
 class InodeIdentifier;
 class InodeWatcher;
+struct IORingJob;
+class IORingWorkQueue;
 class MountFile;
 class Jail;
 class KBuffer;
 class KString;
 class LocalSocket;
 class Mutex;
+class MutexStatistics;
 class MasterPTY;
 class Mount;
 class PerformanceEventBuffer;
@@ -10,6 +10,7 @@
 #include <Kernel/Debug.h>
 #include <Kernel/Heap/Heap.h>
 #include <Kernel/Heap/kmalloc.h>
+#include <Kernel/Interrupts/InterruptDisabler.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Library/Panic.h>
 #include <Kernel/Library/StdLib.h>
@@ -167,12 +168,27 @@ public:
 #ifndef HAS_ADDRESS_SANITIZER
         memset(ptr, KFREE_SCRUB_BYTE, m_slab_size);
 #endif
+        return_to_block(ptr);
+    }
 
-        auto* block = (KmallocSlabBlock*)((FlatPtr)ptr & KmallocSlabBlock::block_mask);
-        bool block_was_full = block->is_full();
-        block->deallocate(ptr);
-        if (block_was_full)
-            m_usable_blocks.append(*block);
+    // Hands out up to slabs.size() slabs to refill a per-CPU magazine. The slabs are not scrubbed.
+    size_t allocate_batch(Span<void*> slabs)
+    {
+        size_t count = 0;
+        while (count < slabs.size()) {
+            auto* ptr = allocate(m_slab_size, CallerWillInitializeMemory::Yes);
+            if (!ptr)
+                break;
+            slabs[count++] = ptr;
+        }
+        return count;
+    }
+
+    // Takes back slabs drained from a per-CPU magazine, which were already scrubbed when they were freed.
+    void deallocate_batch(ReadonlySpan<void*> slabs)
+    {
+        for (auto* ptr : slabs)
+            return_to_block(ptr);
     }
 
     size_t allocated_bytes() const
@@ -217,6 +233,15 @@ public:
     }
 
 private:
+    void return_to_block(void* ptr)
+    {
+        auto* block = (KmallocSlabBlock*)((FlatPtr)ptr & KmallocSlabBlock::block_mask);
+        bool block_was_full = block->is_full();
+        block->deallocate(ptr);
+        if (block_was_full)
+            m_usable_blocks.append(*block);
+    }
+
     size_t m_slab_size { 0 };
 
     KmallocSlabBlock::List m_usable_blocks;
@@ -239,14 +264,21 @@ struct KmallocGlobalData {
         subheaps.append(*subheap);
     }
 
+    Optional<size_t> slabheap_index_for(size_t size, size_t alignment) const
+    {
+        for (size_t i = 0; i < slabheap_count; ++i) {
+            if (size <= slabheaps[i].slab_size() && alignment <= slabheaps[i].slab_size())
+                return i;
+        }
+        return {};
+    }
+
     void* allocate(size_t size, size_t alignment, CallerWillInitializeMemory caller_will_initialize_memory)
     {
         VERIFY(!expansion_in_progress);
 
-        for (auto& slabheap : slabheaps) {
-            if (size <= slabheap.slab_size() && alignment <= slabheap.slab_size())
-                return slabheap.allocate(size, caller_will_initialize_memory);
-        }
+        if (auto index = slabheap_index_for(size, alignment); index.has_value())
+            return slabheaps[*index].allocate(size, caller_will_initialize_memory);
 
         for (auto& subheap : subheaps) {
             if (auto* ptr = subheap.allocator.allocate(size, alignment, caller_will_initialize_memory))
@@ -412,7 +444,8 @@ struct KmallocGlobalData {
 
     KmallocSubheap::List subheaps;
 
-    KmallocSlabheap slabheaps[6] = { 16, 32, 64, 128, 256, 512 };
+    static constexpr size_t slabheap_count = 6;
+    KmallocSlabheap slabheaps[slabheap_count] = { 16, 32, 64, 128, 256, 512 };
 
     bool expansion_in_progress { false };
 };
@@ -420,11 +453,53 @@ struct KmallocGlobalData {
 READONLY_AFTER_INIT static KmallocGlobalData* g_kmalloc_global;
 alignas(KmallocGlobalData) static u8 g_kmalloc_global_heap[sizeof(KmallocGlobalData)];
 
-static size_t g_kmalloc_call_count;
-static size_t g_kfree_call_count;
-static size_t g_nested_kfree_calls;
+// Small allocations are served from per-CPU magazines of free slabs, one for each slabheap size class,
+// so that the common kmalloc()/kfree() path does not need to take the global kmalloc lock.
+// Magazines are refilled from and drained to the slabheaps in batches.
+struct KmallocMagazine {
+    static constexpr size_t capacity = 32;
+    static constexpr size_t batch_size = capacity / 2;
+
+    size_t count { 0 };
+    void* slabs[capacity] {};
+};
+
+struct alignas(64) KmallocPerCPUData {
+    KmallocMagazine magazines[KmallocGlobalData::slabheap_count] {};
+    size_t kmalloc_call_count { 0 };
+    size_t kfree_call_count { 0 };
+    size_t nested_kfree_calls { 0 };
+};
+
+// NOTE: Each entry is only ever modified by its own CPU with interrupts disabled.
+static KmallocPerCPUData s_per_cpu_data[MAX_CPU_COUNT];
+
+static size_t g_kmalloc_lock_acquire_count;
+static size_t g_kmalloc_lock_contended_count;
 bool g_dump_kmalloc_stacks;
 
+static SpinlockLocker<decltype(s_lock)> lock_kmalloc_heap()
+{
+    // This is only a hint, but good enough to tell how often we had to wait for another CPU.
+    bool contended = s_lock.is_locked() && !s_lock.is_locked_by_current_processor();
+    SpinlockLocker lock(s_lock);
+    ++g_kmalloc_lock_acquire_count;
+    if (contended)
+        ++g_kmalloc_lock_contended_count;
+    return lock;
+}
+
+static bool should_use_magazines()
+{
+#ifdef HAS_ADDRESS_SANITIZER
+    // Slabs sitting in a magazine would need their own shadow memory tracking.
+    return false;
+#else
+    // Nested calls from within the locked slow path (e.g. a slabheap growing) must not touch the magazines.
+    return !g_dump_kmalloc_stacks && !s_lock.is_locked_by_current_processor();
+#endif
+}
+
 void kmalloc_enable_expand()
 {
     g_kmalloc_global->enable_expansion();
@@ -439,6 +514,76 @@ UNMAP_AFTER_INIT void kmalloc_init()
     s_lock.initialize();
 }
 
+static void add_kmalloc_perf_event(size_t size, void* ptr)
+{
+    Thread* current_thread = Thread::current();
+    if (!current_thread)
+        current_thread = Processor::idle_thread();
+    if (current_thread) {
+        // FIXME: By the time we check this, we have already allocated above.
+        //        This means that in the case of an infinite recursion, we can't catch it this way.
+        VERIFY(current_thread->is_allocation_enabled());
+        PerformanceManager::add_kmalloc_perf_event(*current_thread, size, (FlatPtr)ptr);
+    }
+}
+
+static void add_kfree_perf_event(KmallocPerCPUData& cpu_data, void* ptr)
+{
+    if (cpu_data.nested_kfree_calls != 1)
+        return;
+    Thread* current_thread = Thread::current();
+    if (!current_thread)
+        current_thread = Processor::idle_thread();
+    if (current_thread) {
+        VERIFY(current_thread->is_allocation_enabled());
+        PerformanceManager::add_kfree_perf_event(*current_thread, 0, (FlatPtr)ptr);
+    }
+}
+
+static void* allocate_from_magazine(size_t size, size_t slabheap_index, CallerWillInitializeMemory caller_will_initialize_memory)
+{
+    void* ptr = nullptr;
+    {
+        InterruptDisabler disabler;
+        auto& cpu_data = s_per_cpu_data[Processor::current_id()];
+        auto& magazine = cpu_data.magazines[slabheap_index];
+        if (magazine.count == 0) {
+            auto lock = lock_kmalloc_heap();
+            magazine.count = g_kmalloc_global->slabheaps[slabheap_index].allocate_batch({ magazine.slabs, KmallocMagazine::batch_size });
+            if (magazine.count == 0)
+                return nullptr;
+        }
+        ptr = magazine.slabs[--magazine.count];
+        ++cpu_data.kmalloc_call_count;
+        add_kmalloc_perf_event(size, ptr);
+    }
+
+    if (caller_will_initialize_memory == CallerWillInitializeMemory::No)
+        memset(ptr, KMALLOC_SCRUB_BYTE, g_kmalloc_global->slabheaps[slabheap_index].slab_size());
+    return ptr;
+}
+
+static void deallocate_to_magazine(void* ptr, size_t slabheap_index)
+{
+    VERIFY(g_kmalloc_global->is_valid_kmalloc_address(VirtualAddress { ptr }));
+    auto& slabheap = g_kmalloc_global->slabheaps[slabheap_index];
+    memset(ptr, KFREE_SCRUB_BYTE, slabheap.slab_size());
+
+    InterruptDisabler disabler;
+    auto& cpu_data = s_per_cpu_data[Processor::current_id()];
+    auto& magazine = cpu_data.magazines[slabheap_index];
+    if (magazine.count == KmallocMagazine::capacity) {
+        auto lock = lock_kmalloc_heap();
+        magazine.count -= KmallocMagazine::batch_size;
+        slabheap.deallocate_batch({ &magazine.slabs[magazine.count], KmallocMagazine::batch_size });
+    }
+    magazine.slabs[magazine.count++] = ptr;
+    ++cpu_data.kfree_call_count;
+    ++cpu_data.nested_kfree_calls;
+    add_kfree_perf_event(cpu_data, ptr);
+    --cpu_data.nested_kfree_calls;
+}
+
 static void* kmalloc_impl(size_t size, size_t alignment, CallerWillInitializeMemory caller_will_initialize_memory)
 {
     // Catch bad callers allocating under spinlock.
@@ -449,8 +594,15 @@ static void* kmalloc_impl(size_t size, size_t alignment, CallerWillInitializeMem
     // Alignment must be a power of two.
     VERIFY(is_power_of_two(alignment));
 
-    SpinlockLocker lock(s_lock);
-    ++g_kmalloc_call_count;
+    if (should_use_magazines()) {
+        if (auto index = g_kmalloc_global->slabheap_index_for(size, alignment); index.has_value()) {
+            if (auto* ptr = allocate_from_magazine(size, *index, caller_will_initialize_memory))
+                return ptr;
+        }
+    }
+
+    auto lock = lock_kmalloc_heap();
+    ++s_per_cpu_data[Processor::current_id()].kmalloc_call_count;
 
     if (g_dump_kmalloc_stacks && Kernel::g_kernel_symbols_available) {
         dbgln("kmalloc({})", size);
@@ -458,17 +610,7 @@ static void* kmalloc_impl(size_t size, size_t alignment, CallerWillInitializeMem
     }
 
     void* ptr = g_kmalloc_global->allocate(size, alignment, caller_will_initialize_memory);
-
-    Thread* current_thread = Thread::current();
-    if (!current_thread)
-        current_thread = Processor::idle_thread();
-    if (current_thread) {
-        // FIXME: By the time we check this, we have already allocated above.
-        //        This means that in the case of an infinite recursion, we can't catch it this way.
-        VERIFY(current_thread->is_allocation_enabled());
-        PerformanceManager::add_kmalloc_perf_event(*current_thread, size, (FlatPtr)ptr);
-    }
-
+    add_kmalloc_perf_event(size, ptr);
     return ptr;
 }
 
@@ -500,22 +642,20 @@ void kfree_sized(void* ptr, size_t size)
         Processor::verify_no_spinlocks_held();
     }
 
-    SpinlockLocker lock(s_lock);
-    ++g_kfree_call_count;
-    ++g_nested_kfree_calls;
-
-    if (g_nested_kfree_calls == 1) {
-        Thread* current_thread = Thread::current();
-        if (!current_thread)
-            current_thread = Processor::idle_thread();
-        if (current_thread) {
-            VERIFY(current_thread->is_allocation_enabled());
-            PerformanceManager::add_kfree_perf_event(*current_thread, 0, (FlatPtr)ptr);
+    if (should_use_magazines()) {
+        if (auto index = g_kmalloc_global->slabheap_index_for(size, 1); index.has_value()) {
+            deallocate_to_magazine(ptr, *index);
+            return;
         }
     }
 
+    auto lock = lock_kmalloc_heap();
+    auto& cpu_data = s_per_cpu_data[Processor::current_id()];
+    ++cpu_data.kfree_call_count;
+    ++cpu_data.nested_kfree_calls;
+    add_kfree_perf_event(cpu_data, ptr);
     g_kmalloc_global->deallocate(ptr, size);
-    --g_nested_kfree_calls;
+    --cpu_data.nested_kfree_calls;
 }
 
 size_t kmalloc_good_size(size_t size)
@@ -602,6 +742,21 @@ void get_kmalloc_stats(kmalloc_stats& stats)
     SpinlockLocker lock(s_lock);
     stats.bytes_allocated = g_kmalloc_global->allocated_bytes();
     stats.bytes_free = g_kmalloc_global->free_bytes();
-    stats.kmalloc_call_count = g_kmalloc_call_count;
-    stats.kfree_call_count = g_kfree_call_count;
+    stats.kmalloc_call_count = 0;
+    stats.kfree_call_count = 0;
+
+    // NOTE: Other CPUs keep going while we read their data, so this is only a snapshot.
+    for (auto const& cpu_data : s_per_cpu_data) {
+        stats.kmalloc_call_count += cpu_data.kmalloc_call_count;
+        stats.kfree_call_count += cpu_data.kfree_call_count;
+        for (size_t i = 0; i < KmallocGlobalData::slabheap_count; ++i) {
+            // Slabs cached in magazines are allocated as far as the slabheaps are concerned, but are free for all intents and purposes.
+            auto cached_bytes = min(cpu_data.magazines[i].count * g_kmalloc_global->slabheaps[i].slab_size(), stats.bytes_allocated);
+            stats.bytes_allocated -= cached_bytes;
+            stats.bytes_free += cached_bytes;
+        }
+    }
+
+    stats.lock_acquire_count = g_kmalloc_lock_acquire_count;
+    stats.lock_contended_count = g_kmalloc_lock_contended_count;
 }
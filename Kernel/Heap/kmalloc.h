@@ -52,6 +52,8 @@ struct kmalloc_stats {
     size_t bytes_free;
     size_t kmalloc_call_count;
     size_t kfree_call_count;
+    size_t lock_acquire_count;
+    size_t lock_contended_count;
 };
 void get_kmalloc_stats(kmalloc_stats&);
 
@@ -9,13 +9,78 @@
 #include <Kernel/KSyms.h>
 #include <Kernel/Locking/LockLocation.h>
 #include <Kernel/Locking/Mutex.h>
+#include <Kernel/Locking/MutexStatistics.h>
 #include <Kernel/Locking/Spinlock.h>
 #include <Kernel/Tasks/Thread.h>
+#include <Kernel/Time/TimeManagement.h>
 
 extern bool g_in_early_boot;
 
 namespace Kernel {
 
+// How long we busy-wait for a mutex held by a thread running on another processor before
+// going to sleep. This is in the same ballpark as the cost of blocking and being woken up again.
+static constexpr size_t max_spin_iterations = 1000;
+
+namespace {
+
+// Measures how long a thread had to wait for a contended mutex, and reports that to the
+// mutex statistics once it got the mutex. Does nothing if we aren't keeping statistics.
+class ContentionTimer {
+    AK_MAKE_NONCOPYABLE(ContentionTimer);
+    AK_MAKE_NONMOVABLE(ContentionTimer);
+
+public:
+    explicit ContentionTimer(MutexStatistics* statistics)
+        : m_statistics(statistics)
+    {
+    }
+
+    ~ContentionTimer()
+    {
+        if (!m_contended)
+            return;
+        auto wait_time = m_start.has_value() ? TimeManagement::the().monotonic_time(TimePrecision::Precise) - m_start.value() : Duration::zero();
+        m_statistics->record_contention(wait_time, m_did_spin && !m_did_block);
+    }
+
+    void start()
+    {
+        if (!m_statistics || m_contended)
+            return;
+        m_contended = true;
+        if (TimeManagement::is_initialized())
+            m_start = TimeManagement::the().monotonic_time(TimePrecision::Precise);
+    }
+
+    void set_did_spin() { m_did_spin = true; }
+    void set_did_block() { m_did_block = true; }
+
+private:
+    MutexStatistics* m_statistics { nullptr };
+    Optional<MonotonicTime> m_start;
+    bool m_contended { false };
+    bool m_did_spin { false };
+    bool m_did_block { false };
+};
+
+}
+
+MutexStatistics* Mutex::record_acquisition()
+{
+    if (!MutexStatistics::is_enabled())
+        return nullptr;
+
+    // Looking up the same name twice yields the same entry, so racing here is harmless.
+    auto* statistics = m_statistics.load(AK::MemoryOrder::memory_order_relaxed);
+    if (!statistics) {
+        statistics = &MutexStatistics::for_name(m_name);
+        m_statistics.store(statistics, AK::MemoryOrder::memory_order_relaxed);
+    }
+    statistics->record_acquisition();
+    return statistics;
+}
+
 void Mutex::lock(Mode mode, [[maybe_unused]] LockLocation const& location)
 {
     // NOTE: This may be called from an interrupt handler (not an IRQ handler)
@@ -29,8 +94,24 @@ void Mutex::lock(Mode mode, [[maybe_unused]] LockLocation const& location)
     VERIFY(mode != Mode::Unlocked);
     auto* current_thread = Thread::current();
 
+    auto* statistics = record_acquisition();
+    ContentionTimer contention_timer(statistics);
+
     SpinlockLocker lock(m_lock);
     bool did_block = false;
+
+    if (m_mode == Mode::Exclusive && m_holder != bit_cast<uintptr_t>(current_thread)) {
+        contention_timer.start();
+#if LOCK_DEBUG
+        if (statistics)
+            statistics->record_contended_holder(m_holder_location);
+#endif
+        // The holder is likely to release the lock soon if it's running right now, so spin for a bit
+        // instead of paying for a round trip through the scheduler.
+        if (m_behavior == MutexBehavior::Regular && spin_while_held_by_running_thread(lock))
+            contention_timer.set_did_spin();
+    }
+
     Mode current_mode = m_mode;
     switch (current_mode) {
     case Mode::Unlocked: {
@@ -40,6 +121,9 @@ void Mutex::lock(Mode mode, [[maybe_unused]] LockLocation const& location)
         VERIFY(m_shared_holders == 0);
         if (mode == Mode::Exclusive) {
             m_holder = bit_cast<uintptr_t>(current_thread);
+#if LOCK_DEBUG
+            m_holder_location = location;
+#endif
         } else {
             VERIFY(mode == Mode::Shared);
             ++m_shared_holders;
@@ -62,8 +146,13 @@ void Mutex::lock(Mode mode, [[maybe_unused]] LockLocation const& location)
         if (m_holder != bit_cast<uintptr_t>(current_thread)) {
             block(*current_thread, mode, lock, 1);
             did_block = true;
+            contention_timer.set_did_block();
             // If we blocked then m_mode should have been updated to what we requested
             VERIFY(m_mode == mode);
+#if LOCK_DEBUG
+            if (m_mode == Mode::Exclusive)
+                m_holder_location = location;
+#endif
         }
 
         if (m_mode == Mode::Exclusive) {
@@ -106,9 +195,14 @@ void Mutex::lock(Mode mode, [[maybe_unused]] LockLocation const& location)
             // and is asking to upgrade the lock to be exclusive without first releasing the shared lock. We have no
             // allocation-free way to detect such a scenario, so if you suspect that this is the cause of your deadlock,
             // try turning on LOCK_SHARED_UPGRADE_DEBUG.
+            contention_timer.start();
             block(*current_thread, mode, lock, 1);
             did_block = true;
+            contention_timer.set_did_block();
             VERIFY(m_mode == mode);
+#if LOCK_DEBUG
+            m_holder_location = location;
+#endif
         }
 
         dbgln_if(LOCK_TRACE_DEBUG, "Mutex::lock @ {} ({}): acquire {}, currently shared, locks held {}", this, m_name, mode_to_string(mode), m_times_locked);
@@ -207,6 +301,30 @@ void Mutex::unlock()
     }
 }
 
+bool Mutex::spin_while_held_by_running_thread(SpinlockLocker<Spinlock<LockRank::None>>& lock)
+{
+    VERIFY(m_mode == Mode::Exclusive);
+    if (Processor::count() == 1)
+        return false;
+
+    // As we are holding m_lock, the holder can't release the mutex and go away while we look at it.
+    auto holder = m_holder;
+    if (bit_cast<Thread*>(holder)->state() != Thread::State::Running)
+        return false;
+
+    // Once we let go of m_lock the holder thread may exit at any time, so from here on we only look
+    // at m_holder and never dereference it again. Should the holder get preempted, we simply give up
+    // after max_spin_iterations and block as usual.
+    lock.unlock();
+    for (size_t i = 0; i < max_spin_iterations; ++i) {
+        Processor::pause();
+        if (AK::atomic_load(&m_holder, AK::MemoryOrder::memory_order_relaxed) != holder)
+            break;
+    }
+    lock.lock();
+    return true;
+}
+
 void Mutex::block(Thread& current_thread, Mode mode, SpinlockLocker<Spinlock<LockRank::None>>& lock, u32 requested_locks)
 {
     if constexpr (LOCK_IN_CRITICAL_DEBUG) {
@@ -334,11 +452,21 @@ void Mutex::restore_exclusive_lock(u32 lock_count, [[maybe_unused]] LockLocation
 
     auto* current_thread = Thread::current();
     bool did_block = false;
+
+    auto* statistics = record_acquisition();
+    ContentionTimer contention_timer(statistics);
+
     SpinlockLocker lock(m_lock);
     [[maybe_unused]] auto previous_mode = m_mode;
     if (m_mode == Mode::Exclusive && m_holder != bit_cast<uintptr_t>(current_thread)) {
+        contention_timer.start();
+#if LOCK_DEBUG
+        if (statistics)
+            statistics->record_contended_holder(m_holder_location);
+#endif
         block(*current_thread, Mode::Exclusive, lock, lock_count);
         did_block = true;
+        contention_timer.set_did_block();
         // If we blocked then m_mode should have been updated to what we requested
         VERIFY(m_mode == Mode::Exclusive);
     }
@@ -366,6 +494,7 @@ void Mutex::restore_exclusive_lock(u32 lock_count, [[maybe_unused]] LockLocation
     }
 
 #if LOCK_DEBUG
+    m_holder_location = location;
     current_thread->holding_lock(*this, (int)lock_count, location);
 #endif
 }
@@ -85,6 +85,10 @@ private:
     // FIXME: Allow any lock rank.
     void block(Thread&, Mode, SpinlockLocker<Spinlock<LockRank::None>>&, u32);
     void unblock_waiters(Mode);
+    bool spin_while_held_by_running_thread(SpinlockLocker<Spinlock<LockRank::None>>&);
+
+    // Returns the statistics to report contention to, or nullptr if we aren't keeping statistics.
+    MutexStatistics* record_acquisition();
 
     StringView m_name;
     Mode m_mode { Mode::Unlocked };
@@ -103,6 +107,14 @@ private:
     uintptr_t m_holder { 0 };
     size_t m_shared_holders { 0 };
 
+#if LOCK_DEBUG
+    // Where the current exclusive holder acquired this lock, used to attribute contention.
+    LockLocation m_holder_location {};
+#endif
+
+    // Looked up lazily on the first acquisition, see record_acquisition().
+    Atomic<MutexStatistics*> m_statistics { nullptr };
+
     struct BlockedThreadLists {
         BlockedThreadList exclusive;
         BlockedThreadList shared;
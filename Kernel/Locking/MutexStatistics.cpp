@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/QuickSort.h>
+#include <Kernel/Arch/Processor.h>
+#include <Kernel/Locking/MutexStatistics.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+static constexpr size_t max_mutex_statistics_entries = 512;
+
+struct MutexStatistics::Counters {
+    Atomic<u64> acquisitions { 0 };
+    Atomic<u64> contended_acquisitions { 0 };
+    Atomic<u64> spin_acquisitions { 0 };
+    Atomic<u64> total_wait_time_ns { 0 };
+    Atomic<u64> max_wait_time_ns { 0 };
+};
+
+// One set of counters per processor for every entry, plus the overflow entry.
+using ProcessorCounters = Array<MutexStatistics::Counters, max_mutex_statistics_entries + 1>;
+static Atomic<ProcessorCounters*> s_processor_counters { nullptr };
+static u32 s_processor_count { 0 };
+
+// Entries are never removed, so once an entry has been published through s_entry_count
+// it can be read without taking s_entries_lock.
+static MutexStatistics s_entries[max_mutex_statistics_entries];
+static Atomic<size_t> s_entry_count { 0 };
+static Spinlock<LockRank::None> s_entries_lock {};
+
+// Everything that doesn't fit into the table is accounted here.
+static MutexStatistics s_overflow_entry;
+
+UNMAP_AFTER_INIT void MutexStatistics::initialize()
+{
+    VERIFY(!s_processor_counters.load(AK::MemoryOrder::memory_order_relaxed));
+    s_processor_count = Processor::count();
+    auto* processor_counters = new (nothrow) ProcessorCounters[s_processor_count];
+    if (!processor_counters) {
+        dmesgln("MutexStatistics: Not enough memory to keep statistics");
+        return;
+    }
+    s_processor_counters.store(processor_counters, AK::MemoryOrder::memory_order_release);
+    dmesgln("MutexStatistics: Keeping statistics for {} processors", s_processor_count);
+}
+
+bool MutexStatistics::is_enabled()
+{
+    return s_processor_counters.load(AK::MemoryOrder::memory_order_relaxed) != nullptr;
+}
+
+MutexStatistics::Counters& MutexStatistics::counters_for_current_processor()
+{
+    // We may be moved to another processor right after looking at the processor id. That's fine,
+    // the counters are atomic. It's just rare enough that it won't make the cache lines bounce.
+    auto* processor_counters = s_processor_counters.load(AK::MemoryOrder::memory_order_acquire);
+    VERIFY(processor_counters);
+    return processor_counters[Processor::current_id()][m_index];
+}
+
+template<typename Callback>
+void MutexStatistics::for_each_processor_counters(Callback callback) const
+{
+    auto* processor_counters = s_processor_counters.load(AK::MemoryOrder::memory_order_acquire);
+    if (!processor_counters)
+        return;
+    for (u32 i = 0; i < s_processor_count; ++i)
+        callback(processor_counters[i][m_index]);
+}
+
+MutexStatistics& MutexStatistics::for_name(StringView name)
+{
+    if (name.is_empty())
+        name = "(unnamed)"sv;
+
+    SpinlockLocker locker(s_entries_lock);
+    auto count = s_entry_count.load(AK::MemoryOrder::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        if (s_entries[i].m_name == name)
+            return s_entries[i];
+    }
+
+    if (count == max_mutex_statistics_entries) {
+        s_overflow_entry.m_name = "(other)"sv;
+        s_overflow_entry.m_index = max_mutex_statistics_entries;
+        return s_overflow_entry;
+    }
+
+    auto& entry = s_entries[count];
+    entry.m_name = name;
+    entry.m_index = count;
+    s_entry_count.store(count + 1, AK::MemoryOrder::memory_order_release);
+    return entry;
+}
+
+ErrorOr<void> MutexStatistics::for_each(Function<ErrorOr<void>(MutexStatistics const&)> callback)
+{
+    auto count = s_entry_count.load(AK::MemoryOrder::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i)
+        TRY(callback(s_entries[i]));
+    if (count == max_mutex_statistics_entries)
+        TRY(callback(s_overflow_entry));
+    return {};
+}
+
+u64 MutexStatistics::acquisitions() const
+{
+    u64 sum = 0;
+    for_each_processor_counters([&](auto& counters) { sum += counters.acquisitions.load(AK::MemoryOrder::memory_order_relaxed); });
+    return sum;
+}
+
+u64 MutexStatistics::contended_acquisitions() const
+{
+    u64 sum = 0;
+    for_each_processor_counters([&](auto& counters) { sum += counters.contended_acquisitions.load(AK::MemoryOrder::memory_order_relaxed); });
+    return sum;
+}
+
+u64 MutexStatistics::spin_acquisitions() const
+{
+    u64 sum = 0;
+    for_each_processor_counters([&](auto& counters) { sum += counters.spin_acquisitions.load(AK::MemoryOrder::memory_order_relaxed); });
+    return sum;
+}
+
+u64 MutexStatistics::total_wait_time_ns() const
+{
+    u64 sum = 0;
+    for_each_processor_counters([&](auto& counters) { sum += counters.total_wait_time_ns.load(AK::MemoryOrder::memory_order_relaxed); });
+    return sum;
+}
+
+u64 MutexStatistics::max_wait_time_ns() const
+{
+    u64 maximum = 0;
+    for_each_processor_counters([&](auto& counters) { maximum = max(maximum, counters.max_wait_time_ns.load(AK::MemoryOrder::memory_order_relaxed)); });
+    return maximum;
+}
+
+void MutexStatistics::record_acquisition()
+{
+    counters_for_current_processor().acquisitions.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+}
+
+void MutexStatistics::record_contention(Duration wait_time, bool acquired_by_spinning)
+{
+    auto& counters = counters_for_current_processor();
+    counters.contended_acquisitions.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    if (acquired_by_spinning)
+        counters.spin_acquisitions.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+
+    auto wait_time_ns = static_cast<u64>(max<i64>(wait_time.to_nanoseconds(), 0));
+    counters.total_wait_time_ns.fetch_add(wait_time_ns, AK::MemoryOrder::memory_order_relaxed);
+    auto max_wait_time_ns = counters.max_wait_time_ns.load(AK::MemoryOrder::memory_order_relaxed);
+    while (wait_time_ns > max_wait_time_ns) {
+        if (counters.max_wait_time_ns.compare_exchange_strong(max_wait_time_ns, wait_time_ns, AK::MemoryOrder::memory_order_relaxed))
+            break;
+    }
+}
+
+void MutexStatistics::record_contended_holder([[maybe_unused]] LockLocation const& location)
+{
+#if LOCK_DEBUG
+    SpinlockLocker locker(m_holder_locations_lock);
+
+    // Keep the locations with the most contentions. A new location replaces the one that was
+    // seen the least, which keeps the hot ones in the table even if there are many cold ones.
+    HolderLocation* least_contended = &m_holder_locations[0];
+    for (auto& holder : m_holder_locations) {
+        if (holder.line_number == location.line_number() && holder.filename == location.filename()) {
+            ++holder.contentions;
+            return;
+        }
+        if (holder.contentions < least_contended->contentions)
+            least_contended = &holder;
+    }
+    *least_contended = {
+        .function_name = location.function_name(),
+        .filename = location.filename(),
+        .line_number = location.line_number(),
+        .contentions = 1,
+    };
+#endif
+}
+
+Vector<MutexStatistics::HolderLocation, MutexStatistics::max_holder_locations> MutexStatistics::top_holder_locations() const
+{
+    Vector<HolderLocation, max_holder_locations> locations;
+#if LOCK_DEBUG
+    {
+        SpinlockLocker locker(m_holder_locations_lock);
+        for (auto const& holder : m_holder_locations) {
+            if (holder.contentions != 0)
+                locations.unchecked_append(holder);
+        }
+    }
+    quick_sort(locations, [](auto const& a, auto const& b) { return a.contentions > b.contentions; });
+#endif
+    return locations;
+}
+
+}
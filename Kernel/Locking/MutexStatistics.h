@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <AK/Error.h>
+#include <AK/Function.h>
+#include <AK/StringView.h>
+#include <AK/Time.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <Kernel/Locking/LockLocation.h>
+#include <Kernel/Locking/Spinlock.h>
+
+namespace Kernel {
+
+// Contention statistics of Kernel::Mutex, aggregated over all mutexes sharing the same name.
+// They are only kept when booting with the "mutex_stat" parameter. Every processor counts into
+// counters of its own, which are only added up when the statistics are read, so mutexes with a
+// popular name (like "Inode") don't make all processors fight over the same cache line.
+class MutexStatistics {
+    AK_MAKE_NONCOPYABLE(MutexStatistics);
+    AK_MAKE_NONMOVABLE(MutexStatistics);
+
+public:
+    static constexpr size_t max_holder_locations = 8;
+
+    struct HolderLocation {
+        StringView function_name;
+        StringView filename;
+        u32 line_number { 0 };
+        u64 contentions { 0 };
+    };
+
+    // Defined in MutexStatistics.cpp.
+    struct Counters;
+
+    MutexStatistics() = default;
+
+    // Must be called once all processors are up.
+    static void initialize();
+    static bool is_enabled();
+
+    static MutexStatistics& for_name(StringView name);
+    static ErrorOr<void> for_each(Function<ErrorOr<void>(MutexStatistics const&)>);
+
+    StringView name() const { return m_name; }
+    u64 acquisitions() const;
+    u64 contended_acquisitions() const;
+    u64 spin_acquisitions() const;
+    u64 total_wait_time_ns() const;
+    u64 max_wait_time_ns() const;
+
+    // Holder locations are only known when building with LOCK_DEBUG, otherwise this is always empty.
+    Vector<HolderLocation, max_holder_locations> top_holder_locations() const;
+
+    void record_acquisition();
+    void record_contention(Duration wait_time, bool acquired_by_spinning);
+    void record_contended_holder(LockLocation const&);
+
+private:
+    Counters& counters_for_current_processor();
+    template<typename Callback>
+    void for_each_processor_counters(Callback) const;
+
+    StringView m_name;
+    size_t m_index { 0 };
+
+#if LOCK_DEBUG
+    mutable Spinlock<LockRank::None> m_holder_locations_lock {};
+    Array<HolderLocation, max_holder_locations> m_holder_locations {};
+#endif
+};
+
+}
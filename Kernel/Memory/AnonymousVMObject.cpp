@@ -146,7 +146,15 @@ AnonymousVMObject::AnonymousVMObject(FixedArray<RefPtr<PhysicalPage>>&& new_phys
 {
     if (strategy == AllocationStrategy::AllocateNow) {
         // Allocate all pages right now. We know we can get all because we committed the amount needed
-        for (size_t i = 0; i < page_count(); ++i)
+        size_t i = 0;
+#if ARCH(X86_64)
+        // Try to back every whole large page worth of the object with contiguous physical memory, so that it can be mapped with large pages.
+        for (; i + pages_per_large_page <= page_count(); i += pages_per_large_page) {
+            if (!m_unused_committed_pages->try_take_large_page(physical_pages().slice(i, pages_per_large_page)))
+                break;
+        }
+#endif
+        for (; i < page_count(); ++i)
             physical_pages()[i] = m_unused_committed_pages->take_one();
     } else {
         auto& initial_page = (strategy == AllocationStrategy::Reserve) ? MM.lazy_committed_page() : MM.shared_zero_page();
@@ -276,6 +284,36 @@ NonnullRefPtr<PhysicalPage> AnonymousVMObject::allocate_committed_page(Badge<Reg
     return m_unused_committed_pages->take_one();
 }
 
+bool AnonymousVMObject::can_populate_large_page(size_t first_page_index) const
+{
+    VERIFY(m_lock.is_locked_by_current_processor());
+    VERIFY(first_page_index + pages_per_large_page <= page_count());
+
+    if (!m_unused_committed_pages.has_value() || m_unused_committed_pages->page_count() < pages_per_large_page)
+        return false;
+
+    for (auto const& page : physical_pages().slice(first_page_index, pages_per_large_page)) {
+        if (!page->is_lazy_committed_page())
+            return false;
+    }
+    return true;
+}
+
+bool AnonymousVMObject::try_populate_large_page(Badge<Region>, size_t first_page_index, ReadonlySpan<NonnullRefPtr<PhysicalPage>> pages)
+{
+    VERIFY(pages.size() == pages_per_large_page);
+
+    // The pages were allocated without holding our lock, so someone may have faulted in part of the chunk meanwhile.
+    if (!can_populate_large_page(first_page_index))
+        return false;
+
+    // They came out of uncommitted memory, so the pages we had committed for the chunk aren't needed anymore.
+    for (size_t i = 0; i < pages_per_large_page; ++i)
+        physical_pages()[first_page_index + i] = pages[i];
+    m_unused_committed_pages->uncommit(pages_per_large_page);
+    return true;
+}
+
 ErrorOr<void> AnonymousVMObject::ensure_cow_map()
 {
     if (m_cow_map.is_null())
@@ -26,6 +26,8 @@ public:
     virtual ErrorOr<NonnullLockRefPtr<VMObject>> try_clone() override;
 
     [[nodiscard]] NonnullRefPtr<PhysicalPage> allocate_committed_page(Badge<Region>);
+    [[nodiscard]] bool can_populate_large_page(size_t first_page_index) const;
+    [[nodiscard]] bool try_populate_large_page(Badge<Region>, size_t first_page_index, ReadonlySpan<NonnullRefPtr<PhysicalPage>>);
     PageFaultResponse handle_cow_fault(size_t, VirtualAddress);
     size_t cow_pages() const;
     bool should_cow(size_t page_index, bool) const;
@@ -638,6 +638,11 @@ PageTableEntry* MemoryManager::pte(PageDirectory& page_directory, VirtualAddress
     PageDirectoryEntry const& pde = pd[page_directory_index];
     if (!pde.is_present())
         return nullptr;
+#if ARCH(X86_64)
+    // A large page has no page table, and thus no entry for the page. Use ensure_pte() to split it up if needed.
+    if (pde.is_huge())
+        return nullptr;
+#endif
 
     return &quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()))[page_table_index];
 }
@@ -652,6 +657,53 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     auto& pde = pd[page_directory_index];
+#if ARCH(X86_64)
+    if (pde.is_present() && pde.is_huge()) {
+        // Someone wants to change a single page inside a large page, so split it up into a page table
+        // that maps the same physical memory with the same attributes.
+        auto page_table_or_error = allocate_physical_page(ShouldZeroFill::No);
+        if (page_table_or_error.is_error()) {
+            dbgln("MM: Unable to allocate page table to split large page at {}", vaddr);
+            return nullptr;
+        }
+        auto page_table = page_table_or_error.release_value();
+        // Allocating the page table may have purged memory, so make sure we're looking at the right page directory.
+        pd = quickmap_pd(page_directory, page_directory_table_index);
+        VERIFY(&pde == &pd[page_directory_index]);
+        VERIFY(pde.is_present() && pde.is_huge());
+
+        auto large_page_base = pde.page_table_base();
+        auto* ptes = quickmap_pt(page_table->paddr());
+        for (size_t i = 0; i < pages_per_large_page; ++i) {
+            auto& split_pte = ptes[i];
+            split_pte.clear();
+            split_pte.set_physical_page_base(large_page_base + i * PAGE_SIZE);
+            split_pte.set_writable(pde.is_writable());
+            split_pte.set_user_allowed(pde.is_user_allowed());
+            split_pte.set_cache_disabled(pde.is_cache_disabled());
+            split_pte.set_write_through(pde.is_write_through());
+            split_pte.set_global(pde.is_global());
+            split_pte.set_execute_disabled(pde.is_execute_disabled());
+            split_pte.set_present(true);
+        }
+
+        // The page table itself may be used by any kind of mapping, so the directory entry has to be permissive.
+        pde.set_huge(false);
+        pde.set_page_table_base(page_table->paddr().get());
+        pde.set_user_allowed(true);
+        pde.set_writable(true);
+        pde.set_cache_disabled(false);
+        pde.set_write_through(false);
+        pde.set_execute_disabled(false);
+        pde.set_global(&page_directory == m_kernel_page_directory.ptr());
+
+        // NOTE: This leaked ref is matched by the unref in MemoryManager::release_pte()
+        (void)page_table.leak_ref();
+
+        // Flush the large page translation, whoever needs the new attributes of the changed page will flush that one.
+        flush_tlb(&page_directory, VirtualAddress { vaddr.get() & ~(large_page_size - 1) }, pages_per_large_page);
+    }
+#endif
     if (pde.is_present())
         return &quickmap_pt(PhysicalAddress(pde.page_table_base()))[page_table_index];
 
@@ -683,6 +735,30 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
     return &quickmap_pt(PhysicalAddress(pde.page_table_base()))[page_table_index];
 }
 
+#if ARCH(X86_64)
+PageDirectoryEntry* MemoryManager::ensure_large_page_pde(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(page_directory.get_lock().is_locked_by_current_processor());
+    VERIFY(!(vaddr.get() & (large_page_size - 1)));
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x1ff;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    auto& pde = pd[page_directory_index];
+    if (pde.is_present() && !pde.is_huge()) {
+        // The whole range covered by this page table is about to be mapped by a single large page,
+        // so whatever was in it belonged to the caller and can go away. Other processors may still be
+        // walking the old page table though, so it must only be freed once they can no longer reach it.
+        auto page_table_base = PhysicalAddress { pde.page_table_base() };
+        pde.clear();
+        flush_tlb(&page_directory, vaddr, pages_per_large_page);
+        get_physical_page_entry(page_table_base).allocated.physical_page.unref();
+    }
+    return &pde;
+}
+#endif
+
 void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress vaddr, IsLastPTERelease is_last_pte_release)
 {
     VERIFY_INTERRUPTS_DISABLED();
@@ -693,6 +769,14 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     PageDirectoryEntry& pde = pd[page_directory_index];
+#if ARCH(X86_64)
+    if (pde.is_present() && pde.is_huge()) {
+        // Large pages are only ever used for chunks that lie entirely within a single region,
+        // so releasing any page of it means the whole large page is going away.
+        pde.clear();
+        return;
+    }
+#endif
     if (pde.is_present()) {
         auto* page_table = quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()));
         auto& pte = page_table[page_table_index];
@@ -894,7 +978,7 @@ ErrorOr<NonnullOwnPtr<Region>> MemoryManager::allocate_kernel_region(size_t size
         name_kstring = TRY(KString::try_create(name));
     auto vmobject = TRY(AnonymousVMObject::try_create_with_size(size, strategy));
     auto region = TRY(Region::create_unplaced(move(vmobject), 0, move(name_kstring), access, cacheable));
-    TRY(m_global_data.with([&](auto& global_data) { return global_data.region_tree.place_anywhere(*region, RandomizeVirtualAddress::No, size); }));
+    TRY(m_global_data.with([&](auto& global_data) { return global_data.region_tree.place_anywhere(*region, RandomizeVirtualAddress::No, size, preferred_alignment_for_region_of_size(size)); }));
     TRY(region->map(kernel_page_directory()));
     return region;
 }
@@ -907,7 +991,7 @@ ErrorOr<NonnullOwnPtr<Region>> MemoryManager::allocate_kernel_region(PhysicalAdd
     if (!name.is_null())
         name_kstring = TRY(KString::try_create(name));
     auto region = TRY(Region::create_unplaced(move(vmobject), 0, move(name_kstring), access, cacheable));
-    TRY(m_global_data.with([&](auto& global_data) { return global_data.region_tree.place_anywhere(*region, RandomizeVirtualAddress::No, size, PAGE_SIZE); }));
+    TRY(m_global_data.with([&](auto& global_data) { return global_data.region_tree.place_anywhere(*region, RandomizeVirtualAddress::No, size, preferred_alignment_for_region_of_size(size)); }));
     TRY(region->map(kernel_page_directory()));
     return region;
 }
@@ -921,7 +1005,7 @@ ErrorOr<NonnullOwnPtr<Region>> MemoryManager::allocate_kernel_region_with_vmobje
         name_kstring = TRY(KString::try_create(name));
 
     auto region = TRY(Region::create_unplaced(vmobject, 0, move(name_kstring), access, cacheable));
-    TRY(m_global_data.with([&](auto& global_data) { return global_data.region_tree.place_anywhere(*region, RandomizeVirtualAddress::No, size); }));
+    TRY(m_global_data.with([&](auto& global_data) { return global_data.region_tree.place_anywhere(*region, RandomizeVirtualAddress::No, size, preferred_alignment_for_region_of_size(size)); }));
     TRY(region->map(kernel_page_directory()));
     return region;
 }
@@ -1038,6 +1122,68 @@ NonnullRefPtr<PhysicalPage> MemoryManager::allocate_committed_physical_page(Badg
     return page.release_nonnull();
 }
 
+void MemoryManager::zero_fill_large_page(PhysicalAddress base)
+{
+    // This takes a while, so let interrupts in between the pages.
+    for (size_t i = 0; i < pages_per_large_page; ++i) {
+        InterruptDisabler disabler;
+        auto* ptr = quickmap_page(base.offset(i * PAGE_SIZE));
+        memset(ptr, 0, PAGE_SIZE);
+        unquickmap_page();
+    }
+}
+
+bool MemoryManager::allocate_committed_large_page(Badge<CommittedPhysicalPageSet>, Span<RefPtr<PhysicalPage>> pages)
+{
+    VERIFY(pages.size() == pages_per_large_page);
+
+    auto base = m_global_data.with([&](auto& global_data) -> Optional<PhysicalAddress> {
+        VERIFY(global_data.system_memory_info.physical_pages_committed >= pages_per_large_page);
+        for (auto& region : global_data.physical_regions) {
+            auto base = region->take_aligned_contiguous_free_pages(pages_per_large_page);
+            if (base.has_value()) {
+                global_data.system_memory_info.physical_pages_committed -= pages_per_large_page;
+                global_data.system_memory_info.physical_pages_used += pages_per_large_page;
+                return base;
+            }
+        }
+        return {};
+    });
+    if (!base.has_value())
+        return false;
+
+    zero_fill_large_page(*base);
+    for (size_t i = 0; i < pages_per_large_page; ++i)
+        pages[i] = PhysicalPage::create(base->offset(i * PAGE_SIZE));
+    return true;
+}
+
+ErrorOr<Vector<NonnullRefPtr<PhysicalPage>>> MemoryManager::allocate_large_page()
+{
+    Vector<NonnullRefPtr<PhysicalPage>> pages;
+    TRY(pages.try_ensure_capacity(pages_per_large_page));
+
+    auto base = TRY(m_global_data.with([&](auto& global_data) -> ErrorOr<PhysicalAddress> {
+        // We need to make sure we don't touch pages that we have committed to
+        if (global_data.system_memory_info.physical_pages_uncommitted < pages_per_large_page)
+            return ENOMEM;
+        for (auto& region : global_data.physical_regions) {
+            auto base = region->take_aligned_contiguous_free_pages(pages_per_large_page);
+            if (base.has_value()) {
+                global_data.system_memory_info.physical_pages_uncommitted -= pages_per_large_page;
+                global_data.system_memory_info.physical_pages_used += pages_per_large_page;
+                return *base;
+            }
+        }
+        return ENOMEM;
+    }));
+
+    zero_fill_large_page(base);
+    for (size_t i = 0; i < pages_per_large_page; ++i)
+        pages.unchecked_append(PhysicalPage::create(base.offset(i * PAGE_SIZE)));
+    return pages;
+}
+
 ErrorOr<NonnullRefPtr<PhysicalPage>> MemoryManager::allocate_physical_page(ShouldZeroFill should_zero_fill, bool* did_purge)
 {
     return m_global_data.with([&](auto&) -> ErrorOr<NonnullRefPtr<PhysicalPage>> {
@@ -1280,11 +1426,26 @@ NonnullRefPtr<PhysicalPage> CommittedPhysicalPageSet::take_one()
     return MM.allocate_committed_physical_page({}, MemoryManager::ShouldZeroFill::Yes);
 }
 
+bool CommittedPhysicalPageSet::try_take_large_page(Span<RefPtr<PhysicalPage>> pages)
+{
+    if (m_page_count < pages_per_large_page)
+        return false;
+    if (!MM.allocate_committed_large_page({}, pages))
+        return false;
+    m_page_count -= pages_per_large_page;
+    return true;
+}
+
 void CommittedPhysicalPageSet::uncommit_one()
 {
-    VERIFY(m_page_count > 0);
-    --m_page_count;
-    MM.uncommit_physical_pages({}, 1);
+    uncommit(1);
+}
+
+void CommittedPhysicalPageSet::uncommit(size_t page_count)
+{
+    VERIFY(m_page_count >= page_count);
+    m_page_count -= page_count;
+    MM.uncommit_physical_pages({}, page_count);
 }
 
 void MemoryManager::copy_physical_page(PhysicalPage& physical_page, u8 page_buffer[PAGE_SIZE])
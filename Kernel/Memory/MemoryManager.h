@@ -34,6 +34,16 @@ constexpr FlatPtr page_round_down(FlatPtr x)
     return ((FlatPtr)(x)) & ~(PAGE_SIZE - 1);
 }
 
+// Big regions are opportunistically mapped with large pages (on x86_64, 2 MiB page directory entries)
+// when both their virtual and physical memory is suitably aligned and contiguous.
+constexpr size_t large_page_size = 2 * MiB;
+constexpr size_t pages_per_large_page = large_page_size / PAGE_SIZE;
+
+constexpr size_t preferred_alignment_for_region_of_size(size_t size)
+{
+    return size >= large_page_size ? large_page_size : PAGE_SIZE;
+}
+
 inline FlatPtr virtual_to_low_physical(FlatPtr virtual_)
 {
     return virtual_ - physical_to_virtual_offset;
@@ -114,7 +124,9 @@ public:
     size_t page_count() const { return m_page_count; }
 
     [[nodiscard]] NonnullRefPtr<PhysicalPage> take_one();
+    [[nodiscard]] bool try_take_large_page(Span<RefPtr<PhysicalPage>>);
     void uncommit_one();
+    void uncommit(size_t page_count);
 
     void operator=(CommittedPhysicalPageSet&&) = delete;
 
@@ -164,8 +176,11 @@ public:
     void uncommit_physical_pages(Badge<CommittedPhysicalPageSet>, size_t page_count);
 
     NonnullRefPtr<PhysicalPage> allocate_committed_physical_page(Badge<CommittedPhysicalPageSet>, ShouldZeroFill = ShouldZeroFill::Yes);
+    bool allocate_committed_large_page(Badge<CommittedPhysicalPageSet>, Span<RefPtr<PhysicalPage>>);
     ErrorOr<NonnullRefPtr<PhysicalPage>> allocate_physical_page(ShouldZeroFill = ShouldZeroFill::Yes, bool* did_purge = nullptr);
     ErrorOr<Vector<NonnullRefPtr<PhysicalPage>>> allocate_contiguous_physical_pages(size_t size);
+    // Zero-filled, and aligned to the size of a large page.
+    ErrorOr<Vector<NonnullRefPtr<PhysicalPage>>> allocate_large_page();
     void deallocate_physical_page(PhysicalAddress);
 
     ErrorOr<NonnullOwnPtr<Region>> allocate_contiguous_kernel_region(size_t, StringView name, Region::Access access, Region::Cacheable = Region::Cacheable::Yes);
@@ -262,12 +277,16 @@ private:
     }
     u8* quickmap_page(PhysicalAddress const&);
     void unquickmap_page();
+    void zero_fill_large_page(PhysicalAddress);
 
     PageDirectoryEntry* quickmap_pd(PageDirectory&, size_t pdpt_index);
     PageTableEntry* quickmap_pt(PhysicalAddress);
 
     PageTableEntry* pte(PageDirectory&, VirtualAddress);
     PageTableEntry* ensure_pte(PageDirectory&, VirtualAddress);
+#if ARCH(X86_64)
+    PageDirectoryEntry* ensure_large_page_pde(PageDirectory&, VirtualAddress);
+#endif
     enum class IsLastPTERelease {
         Yes,
         No
@@ -102,6 +102,40 @@ Vector<NonnullRefPtr<PhysicalPage>> PhysicalRegion::take_contiguous_free_pages(s
     return physical_pages;
 }
 
+Optional<PhysicalAddress> PhysicalRegion::take_aligned_contiguous_free_pages(size_t count)
+{
+    // Takes `count` contiguous pages that are physically aligned to their combined size.
+    // The buddy allocator only aligns blocks relative to the base of their zone, so if that
+    // isn't aligned, allocate a block twice the size and give back what's around the aligned part.
+    VERIFY(is_power_of_two(count));
+    auto order = count_trailing_zeroes(count);
+    auto alignment = count * PAGE_SIZE;
+
+    Optional<PhysicalAddress> block_base;
+    size_t block_page_count = 0;
+    for (auto& zone : m_usable_zones) {
+        bool zone_is_aligned = (zone.base().get() % alignment) == 0;
+        block_page_count = zone_is_aligned ? count : count * 2;
+        block_base = zone.allocate_block(zone_is_aligned ? order : order + 1);
+        if (block_base.has_value()) {
+            if (zone.is_empty())
+                m_full_zones.append(zone);
+            break;
+        }
+    }
+
+    if (!block_base.has_value())
+        return {};
+
+    auto aligned_base = PhysicalAddress { align_up_to(block_base->get(), alignment) };
+    for (size_t i = 0; i < block_page_count; ++i) {
+        auto paddr = block_base->offset(i * PAGE_SIZE);
+        if (paddr < aligned_base || paddr >= aligned_base.offset(alignment))
+            return_page(paddr);
+    }
+    return aligned_base;
+}
+
 RefPtr<PhysicalPage> PhysicalRegion::take_free_page()
 {
     if (m_usable_zones.is_empty())
@@ -36,6 +36,7 @@ public:
 
     RefPtr<PhysicalPage> take_free_page();
     Vector<NonnullRefPtr<PhysicalPage>> take_contiguous_free_pages(size_t count);
+    Optional<PhysicalAddress> take_aligned_contiguous_free_pages(size_t count);
     void return_page(PhysicalAddress);
 
 private:
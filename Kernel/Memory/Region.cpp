@@ -246,6 +246,116 @@ bool Region::map_individual_page_impl(size_t page_index, RefPtr<PhysicalPage> pa
     return true;
 }
 
+#if ARCH(X86_64)
+bool Region::can_map_large_page(size_t page_index) const
+{
+    // NOTE: The PAT bit lives in a different place in large page entries, so leave write-combined regions alone.
+    //       That rules out the kernel's own framebuffer mappings. The ones that userspace gets from a
+    //       SharedFramebufferVMObject are never aligned (only anonymous mmap()s are), and would have to be split up
+    //       whenever the display connector switches them between the real framebuffer and the fake sink pages.
+    if (is_write_combine() || (!is_readable() && !is_writable()))
+        return false;
+    if (vaddr_from_page_index(page_index).get() % large_page_size)
+        return false;
+    return page_index + pages_per_large_page <= page_count();
+}
+
+bool Region::map_large_page_impl(size_t page_index)
+{
+    VERIFY(m_page_directory->get_lock().is_locked_by_current_processor());
+
+    if (!can_map_large_page(page_index))
+        return false;
+
+    SpinlockLocker vmobject_locker(vmobject().m_lock);
+
+    // Every page in the chunk has to be present, writable as far as COW is concerned, and physically contiguous.
+    auto first_page = physical_page(page_index);
+    if (!first_page || first_page->paddr().get() % large_page_size)
+        return false;
+    for (size_t i = 0; i < pages_per_large_page; ++i) {
+        auto page = physical_page(page_index + i);
+        if (!page || page->is_shared_zero_page() || page->is_lazy_committed_page() || should_cow(page_index + i))
+            return false;
+        if (page->paddr() != first_page->paddr().offset(i * PAGE_SIZE))
+            return false;
+    }
+
+    auto page_vaddr = vaddr_from_page_index(page_index);
+    bool user_allowed = page_vaddr.get() >= USER_RANGE_BASE && is_user_address(page_vaddr);
+    if (is_mmap() && !user_allowed) {
+        PANIC("About to map mmap'ed page at a kernel address");
+    }
+
+    auto* pde = MM.ensure_large_page_pde(*m_page_directory, page_vaddr);
+    pde->clear();
+    pde->set_page_table_base(first_page->paddr().get());
+    pde->set_huge(true);
+    pde->set_cache_disabled(!m_cacheable);
+    pde->set_writable(is_writable());
+    if (Processor::current().has_nx())
+        pde->set_execute_disabled(!is_executable());
+    pde->set_user_allowed(user_allowed);
+    pde->set_present(true);
+    return true;
+}
+
+Optional<PageFaultResponse> Region::try_handle_zero_fault_with_large_page(size_t page_index_in_region)
+{
+    // Other regions sharing the VMObject wouldn't know that a whole large page worth of it got populated at once.
+    if (is_shared())
+        return {};
+
+    auto chunk_base = vaddr_from_page_index(page_index_in_region).get() & ~(large_page_size - 1);
+    if (chunk_base < vaddr().get())
+        return {};
+    auto first_page_index = page_index_from_address(VirtualAddress { chunk_base });
+    if (!can_map_large_page(first_page_index))
+        return {};
+
+    auto& anonymous_vmobject = static_cast<AnonymousVMObject&>(vmobject());
+    RefPtr<PhysicalPage> page_faulted_in_by_someone_else;
+    {
+        SpinlockLocker locker(vmobject().m_lock);
+        auto page = physical_page(page_index_in_region);
+        if (!page->is_lazy_committed_page())
+            page_faulted_in_by_someone_else = move(page);
+        else if (!anonymous_vmobject.can_populate_large_page(translate_to_vmobject_page(first_page_index)))
+            return {};
+    }
+
+    if (page_faulted_in_by_someone_else) {
+        if (!remap_vmobject_page(translate_to_vmobject_page(page_index_in_region), page_faulted_in_by_someone_else.release_nonnull()))
+            return PageFaultResponse::OutOfMemory;
+        return PageFaultResponse::Continue;
+    }
+
+    // Zeroing 2 MiB takes a while, so do it before taking the VMObject lock rather than holding up everyone else
+    // faulting on it. If that fails, or we lose a race for the chunk, the page fault is handled one page at a time.
+    auto pages_or_error = MM.allocate_large_page();
+    if (pages_or_error.is_error())
+        return {};
+    {
+        SpinlockLocker locker(vmobject().m_lock);
+        if (!anonymous_vmobject.try_populate_large_page({}, translate_to_vmobject_page(first_page_index), pages_or_error.value()))
+            return {};
+    }
+
+    dbgln_if(PAGE_FAULT_DEBUG, "      >> ALLOCATED LARGE PAGE for Region({})[{}]", this, first_page_index);
+
+    SpinlockLocker page_lock(m_page_directory->get_lock());
+    if (!map_large_page_impl(first_page_index)) {
+        // All of the pages in the chunk were populated, so they all have to be mapped either way.
+        for (size_t i = 0; i < pages_per_large_page; ++i) {
+            if (!map_individual_page_impl(first_page_index + i))
+                return PageFaultResponse::OutOfMemory;
+        }
+    }
+    MemoryManager::flush_tlb(m_page_directory, VirtualAddress { chunk_base }, pages_per_large_page);
+    return PageFaultResponse::Continue;
+}
+#endif
+
 bool Region::map_individual_page_impl(size_t page_index)
 {
     RefPtr<PhysicalPage> page;
@@ -310,6 +420,12 @@ ErrorOr<void> Region::map(PageDirectory& page_directory, ShouldFlushTLB should_f
     set_page_directory(page_directory);
     size_t page_index = 0;
     while (page_index < page_count()) {
+#if ARCH(X86_64)
+        if (map_large_page_impl(page_index)) {
+            page_index += pages_per_large_page;
+            continue;
+        }
+#endif
         if (!map_individual_page_impl(page_index))
             break;
         ++page_index;
@@ -416,6 +532,13 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region, Physica
     if (current_thread != nullptr)
         current_thread->did_zero_fault();
 
+#if ARCH(X86_64)
+    if (page_in_slot_at_time_of_fault.is_lazy_committed_page()) {
+        if (auto response = try_handle_zero_fault_with_large_page(page_index_in_region); response.has_value())
+            return response.release_value();
+    }
+#endif
+
     RefPtr<PhysicalPage> new_physical_page;
 
     if (page_in_slot_at_time_of_fault.is_lazy_committed_page()) {
@@ -232,6 +232,12 @@ private:
     [[nodiscard]] bool map_individual_page_impl(size_t page_index);
     [[nodiscard]] bool map_individual_page_impl(size_t page_index, RefPtr<PhysicalPage>);
 
+#if ARCH(X86_64)
+    [[nodiscard]] bool can_map_large_page(size_t page_index) const;
+    [[nodiscard]] bool map_large_page_impl(size_t page_index);
+    [[nodiscard]] Optional<PageFaultResponse> try_handle_zero_fault_with_large_page(size_t page_index_in_region);
+#endif
+
     LockRefPtr<PageDirectory> m_page_directory;
     VirtualRange m_range;
     size_t m_offset_in_vmobject { 0 };
@@ -5,7 +5,6 @@
  */
 
 #include <Kernel/Heap/kmalloc.h>
-#include <Kernel/Interrupts/InterruptDisabler.h>
 #include <Kernel/Library/StdLib.h>
 #include <Kernel/Net/EtherType.h>
 #include <Kernel/Net/NetworkAdapter.h>
@@ -28,6 +27,15 @@ void NetworkAdapter::send_packet(ReadonlyBytes packet)
     send_raw(packet);
 }
 
+void NetworkAdapter::send_packet(ReadonlyBytes packet, PacketOffload const& offload)
+{
+    VERIFY(m_checksum_offload);
+    VERIFY(offload.tcp_segment_size == 0 || m_tcp_segmentation_offload);
+    m_packets_out++;
+    m_bytes_out += packet.size();
+    send_raw_with_offload(packet, offload);
+}
+
 void NetworkAdapter::send(MACAddress const& destination, ARPPacket const& packet)
 {
     size_t size_in_bytes = sizeof(EthernetFrameHeader) + sizeof(ARPPacket);
@@ -47,7 +55,10 @@ void NetworkAdapter::send(MACAddress const& destination, ARPPacket const& packet
 void NetworkAdapter::fill_in_ipv4_header(PacketWithTimestamp& packet, IPv4Address const& source_ipv4, MACAddress const& destination_mac, IPv4Address const& destination_ipv4, IPv4Protocol protocol, size_t payload_size, u8 type_of_service, u8 ttl)
 {
     size_t ipv4_packet_size = sizeof(IPv4Packet) + payload_size;
-    VERIFY(ipv4_packet_size <= mtu());
+    if (protocol == IPv4Protocol::TCP && m_tcp_segmentation_offload)
+        VERIFY(ipv4_packet_size <= max_tcp_segmentation_offload_size);
+    else
+        VERIFY(ipv4_packet_size <= mtu());
 
     size_t ethernet_frame_size = ipv4_payload_offset() + payload_size;
     VERIFY(packet.buffer->size() == ethernet_frame_size);
@@ -69,13 +80,19 @@ void NetworkAdapter::fill_in_ipv4_header(PacketWithTimestamp& packet, IPv4Addres
     ipv4.set_checksum(ipv4.compute_checksum());
 }
 
-void NetworkAdapter::did_receive(ReadonlyBytes payload)
+void NetworkAdapter::set_receive_queue_count(size_t count)
+{
+    VERIFY(count > 0 && count <= max_receive_queue_count);
+    m_receive_queue_count = count;
+}
+
+void NetworkAdapter::did_receive(ReadonlyBytes payload, size_t receive_queue)
 {
-    InterruptDisabler disabler;
-    m_packets_in++;
-    m_bytes_in += payload.size();
+    VERIFY(receive_queue < m_receive_queue_count);
+    m_packets_in.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    m_bytes_in.fetch_add(payload.size(), AK::MemoryOrder::memory_order_relaxed);
 
-    if (m_packet_queue_size == max_packet_buffers) {
+    if (m_receive_queues[receive_queue].with([](auto& queue) { return queue.size; }) == max_packet_buffers) {
         // FIXME: Keep track of the number of dropped packets
         return;
     }
@@ -88,20 +105,30 @@ void NetworkAdapter::did_receive(ReadonlyBytes payload)
 
     memcpy(packet->buffer->data(), payload.data(), payload.size());
 
-    m_packet_queue.append(*packet);
-    m_packet_queue_size++;
+    m_receive_queues[receive_queue].with([&](auto& queue) {
+        queue.packets.append(*packet);
+        queue.size++;
+    });
 
     if (on_receive)
-        on_receive();
+        on_receive(receive_queue);
 }
 
-size_t NetworkAdapter::dequeue_packet(u8* buffer, size_t buffer_size, UnixDateTime& packet_timestamp)
+bool NetworkAdapter::has_queued_packets(size_t receive_queue) const
 {
-    InterruptDisabler disabler;
-    if (m_packet_queue.is_empty())
+    return m_receive_queues[receive_queue].with([](auto const& queue) { return !queue.packets.is_empty(); });
+}
+
+size_t NetworkAdapter::dequeue_packet(size_t receive_queue, u8* buffer, size_t buffer_size, UnixDateTime& packet_timestamp)
+{
+    auto packet_with_timestamp = m_receive_queues[receive_queue].with([](auto& queue) -> RefPtr<PacketWithTimestamp> {
+        if (queue.packets.is_empty())
+            return nullptr;
+        queue.size--;
+        return queue.packets.take_first();
+    });
+    if (!packet_with_timestamp)
         return 0;
-    auto packet_with_timestamp = m_packet_queue.take_first();
-    m_packet_queue_size--;
     packet_timestamp = packet_with_timestamp->timestamp;
     auto& packet_buffer = packet_with_timestamp->buffer;
     size_t packet_size = packet_buffer->size();
@@ -6,17 +6,21 @@
 
 #pragma once
 
+#include <AK/Array.h>
+#include <AK/Atomic.h>
 #include <AK/AtomicRefCounted.h>
 #include <AK/ByteBuffer.h>
 #include <AK/Function.h>
 #include <AK/IntrusiveList.h>
 #include <AK/MACAddress.h>
+#include <AK/NumericLimits.h>
 #include <AK/Types.h>
 #include <Kernel/Bus/PCI/Definitions.h>
 #include <Kernel/Library/KBuffer.h>
 #include <Kernel/Library/LockWeakPtr.h>
 #include <Kernel/Library/LockWeakable.h>
 #include <Kernel/Library/UserOrKernelBuffer.h>
+#include <Kernel/Locking/SpinlockProtected.h>
 #include <Kernel/Net/ARP.h>
 #include <Kernel/Net/EthernetFrameHeader.h>
 #include <Kernel/Net/ICMP.h>
@@ -42,6 +46,19 @@ struct PacketWithTimestamp final : public AtomicRefCounted<PacketWithTimestamp>
     IntrusiveListNode<PacketWithTimestamp, RefPtr<PacketWithTimestamp>> packet_node;
 };
 
+// Work that the driver asks the adapter to do on an outgoing frame.
+struct PacketOffload {
+    // The adapter fills in the transport checksum over the bytes starting at checksum_start, storing it
+    // at checksum_start + checksum_offset. That field must already hold the (uncomplemented) pseudo-header sum.
+    u16 checksum_start { 0 };
+    u16 checksum_offset { 0 };
+
+    // If non-zero, the frame carries a TCP segment that the adapter splits into segments of at most this
+    // many payload bytes, each prefixed by a copy of the first header_length bytes of the frame.
+    u16 tcp_segment_size { 0 };
+    u16 header_length { 0 };
+};
+
 class NetworkingManagement;
 class NetworkAdapter
     : public AtomicRefCounted<NetworkAdapter>
@@ -54,6 +71,13 @@ public:
 
     static constexpr i32 LINKSPEED_INVALID = -1;
 
+    // The largest IPv4 packet a TCP segmentation offload may hand to the adapter.
+    static constexpr size_t max_tcp_segmentation_offload_size = NumericLimits<u16>::max();
+
+    // Adapters with more than one receive queue spread flows across them, keeping the packets of a flow on one
+    // queue, so that each queue can be processed on a CPU of its own.
+    static constexpr size_t max_receive_queue_count = 8;
+
     virtual ~NetworkAdapter();
 
     virtual StringView class_name() const = 0;
@@ -79,13 +103,16 @@ public:
     void send(MACAddress const&, ARPPacket const&);
     void fill_in_ipv4_header(PacketWithTimestamp&, IPv4Address const&, MACAddress const&, IPv4Address const&, IPv4Protocol, size_t, u8 type_of_service, u8 ttl);
 
-    size_t dequeue_packet(u8* buffer, size_t buffer_size, UnixDateTime& packet_timestamp);
-
-    bool has_queued_packets() const { return !m_packet_queue.is_empty(); }
+    size_t receive_queue_count() const { return m_receive_queue_count; }
+    size_t dequeue_packet(size_t receive_queue, u8* buffer, size_t buffer_size, UnixDateTime& packet_timestamp);
+    bool has_queued_packets(size_t receive_queue) const;
 
     u32 mtu() const { return m_mtu; }
     void set_mtu(u32 mtu) { m_mtu = mtu; }
 
+    bool supports_checksum_offload() const { return m_checksum_offload; }
+    bool supports_tcp_segmentation_offload() const { return m_tcp_segmentation_offload; }
+
     u32 packets_in() const { return m_packets_in; }
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
@@ -97,15 +124,21 @@ public:
     constexpr size_t layer3_payload_offset() const { return sizeof(EthernetFrameHeader); }
     constexpr size_t ipv4_payload_offset() const { return layer3_payload_offset() + sizeof(IPv4Packet); }
 
-    Function<void()> on_receive;
+    Function<void(size_t receive_queue)> on_receive;
 
     void send_packet(ReadonlyBytes);
+    void send_packet(ReadonlyBytes, PacketOffload const&);
 
 protected:
     NetworkAdapter(StringView);
     void set_mac_address(MACAddress const& mac_address) { m_mac_address = mac_address; }
-    void did_receive(ReadonlyBytes);
+    void set_checksum_offload(bool enabled) { m_checksum_offload = enabled; }
+    void set_tcp_segmentation_offload(bool enabled) { m_tcp_segmentation_offload = enabled; }
+    void set_receive_queue_count(size_t);
+    void did_receive(ReadonlyBytes, size_t receive_queue = 0);
     virtual void send_raw(ReadonlyBytes) = 0;
+    // Only called for adapters that advertise support for the requested offloads.
+    virtual void send_raw_with_offload(ReadonlyBytes, PacketOffload const&) { VERIFY_NOT_REACHED(); }
 
 private:
     MACAddress m_mac_address;
@@ -117,15 +150,23 @@ private:
 
     using PacketList = IntrusiveList<&PacketWithTimestamp::packet_node>;
 
-    PacketList m_packet_queue;
-    size_t m_packet_queue_size { 0 };
+    struct ReceiveQueue {
+        PacketList packets;
+        size_t size { 0 };
+    };
+
+    // These may be filled from interrupts on several CPUs at once.
+    Array<SpinlockProtected<ReceiveQueue, LockRank::None>, max_receive_queue_count> m_receive_queues;
+    size_t m_receive_queue_count { 1 };
     SpinlockProtected<PacketList, LockRank::None> m_unused_packets {};
     FixedStringBuffer<IFNAMSIZ> m_name;
-    u32 m_packets_in { 0 };
-    u32 m_bytes_in { 0 };
+    Atomic<u32> m_packets_in { 0 };
+    Atomic<u32> m_bytes_in { 0 };
     u32 m_packets_out { 0 };
     u32 m_bytes_out { 0 };
     u32 m_mtu { 1500 };
+    bool m_checksum_offload { false };
+    bool m_tcp_segmentation_offload { false };
 };
 
 }
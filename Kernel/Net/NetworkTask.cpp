@@ -35,28 +35,91 @@ static void send_tcp_rst(IPv4Packet const& ipv4_packet, TCPPacket const& tcp_pac
 static void flush_delayed_tcp_acks();
 static void retransmit_tcp_packets();
 
-static Thread* network_task = nullptr;
-static HashTable<NonnullRefPtr<TCPSocket>>* delayed_ack_sockets;
+// The first of these also runs the TCP timers. Each task processes every receive_task_count-th receive queue of
+// every adapter, starting with its own index, so the packets of one queue are always handled in order.
+struct ReceiveTask {
+    Atomic<Thread*> thread { nullptr };
+    WaitQueue packet_wait_queue;
+};
+static Array<ReceiveTask, NetworkAdapter::max_receive_queue_count>* receive_tasks;
+static size_t receive_task_count = 1;
+static MutexProtected<HashTable<NonnullRefPtr<TCPSocket>>>* delayed_ack_sockets;
 
 [[noreturn]] static void NetworkTask_main(void*);
+[[noreturn]] static void NetworkReceiveTask_main(void*);
 
 void NetworkTask::spawn()
 {
-    auto [_, first_thread] = MUST(Process::create_kernel_process("Network Task"sv, NetworkTask_main, nullptr));
-    network_task = first_thread;
+    MUST(Process::create_kernel_process("Network Task"sv, NetworkTask_main, nullptr));
 }
 
 bool NetworkTask::is_current()
 {
-    return Thread::current() == network_task;
+    if (!receive_tasks)
+        return false;
+    for (size_t i = 0; i < receive_task_count; ++i) {
+        if ((*receive_tasks)[i].thread == Thread::current())
+            return true;
+    }
+    return false;
+}
+
+static u8* allocate_packet_buffer(size_t buffer_size)
+{
+    auto region_or_error = MM.allocate_kernel_region(buffer_size, "Kernel Packet Buffer"sv, Memory::Region::Access::ReadWrite);
+    if (region_or_error.is_error())
+        TODO();
+    return region_or_error.release_value().leak_ptr()->vaddr().as_ptr();
 }
 
+// Handles one of the packets that are queued for the given task, returning false if there were none.
+static bool process_next_packet(size_t task_index, u8* buffer, size_t buffer_size)
+{
+    size_t packet_size = 0;
+    UnixDateTime packet_timestamp;
+    NetworkingManagement::the().for_each([&](auto& adapter) {
+        for (size_t queue = task_index; !packet_size && queue < adapter.receive_queue_count(); queue += receive_task_count) {
+            if (!adapter.has_queued_packets(queue))
+                continue;
+            packet_size = adapter.dequeue_packet(queue, buffer, buffer_size, packet_timestamp);
+            dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {} queue {} ({} bytes)", adapter.name(), queue, packet_size);
+        }
+    });
+    if (!packet_size)
+        return false;
+
+    if (packet_size < sizeof(EthernetFrameHeader)) {
+        dbgln("NetworkTask: Packet is too small to be an Ethernet packet! ({})", packet_size);
+        return true;
+    }
+    auto& eth = *(EthernetFrameHeader const*)buffer;
+    dbgln_if(ETHERNET_DEBUG, "NetworkTask: From {} to {}, ether_type={:#04x}, packet_size={}", eth.source().to_string(), eth.destination().to_string(), eth.ether_type(), packet_size);
+
+    switch (eth.ether_type()) {
+    case EtherType::ARP:
+        handle_arp(eth, packet_size);
+        break;
+    case EtherType::IPv4:
+        handle_ipv4(eth, packet_size, packet_timestamp);
+        break;
+    case EtherType::IPv6:
+        // ignore
+        break;
+    default:
+        dbgln_if(ETHERNET_DEBUG, "NetworkTask: Unknown ethernet type {:#04x}", eth.ether_type());
+    }
+    return true;
+}
+
+static constexpr size_t packet_buffer_size = 64 * KiB;
+
 void NetworkTask_main(void*)
 {
-    delayed_ack_sockets = new HashTable<NonnullRefPtr<TCPSocket>>;
+    delayed_ack_sockets = new MutexProtected<HashTable<NonnullRefPtr<TCPSocket>>>;
+    receive_tasks = new Array<ReceiveTask, NetworkAdapter::max_receive_queue_count>;
+    (*receive_tasks)[0].thread = Thread::current();
 
-    WaitQueue packet_wait_queue;
-    int pending_packets = 0;
+    size_t receive_queue_count = 1;
     NetworkingManagement::the().for_each([&](auto& adapter) {
         dmesgln("NetworkTask: {} network adapter found: hw={}", adapter.class_name(), adapter.mac_address().to_string());
 
@@ -65,69 +128,51 @@ void NetworkTask_main(void*)
             adapter.set_ipv4_netmask({ 255, 0, 0, 0 });
         }
 
-        adapter.on_receive = [&]() {
-            pending_packets++;
-            packet_wait_queue.wake_all();
-        };
+        receive_queue_count = max(receive_queue_count, adapter.receive_queue_count());
     });
 
-    auto dequeue_packet = [&pending_packets](u8* buffer, size_t buffer_size, UnixDateTime& packet_timestamp) -> size_t {
-        if (pending_packets == 0)
-            return 0;
-        size_t packet_size = 0;
-        NetworkingManagement::the().for_each([&](auto& adapter) {
-            if (packet_size || !adapter.has_queued_packets())
-                return;
-            packet_size = adapter.dequeue_packet(buffer, buffer_size, packet_timestamp);
-            pending_packets--;
-            dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {} ({} bytes)", adapter.name(), packet_size);
-        });
-        return packet_size;
-    };
-
-    size_t buffer_size = 64 * KiB;
-    auto region_or_error = MM.allocate_kernel_region(buffer_size, "Kernel Packet Buffer"sv, Memory::Region::Access::ReadWrite);
-    if (region_or_error.is_error())
-        TODO();
-    auto buffer_region = region_or_error.release_value();
-    auto buffer = (u8*)buffer_region->vaddr().get();
-    UnixDateTime packet_timestamp;
+    // There is no point in having more tasks than there are CPUs to run them on.
+    receive_task_count = min(receive_queue_count, Processor::count());
+    NetworkingManagement::the().for_each([&](auto& adapter) {
+        adapter.on_receive = [](size_t receive_queue) {
+            (*receive_tasks)[receive_queue % receive_task_count].packet_wait_queue.wake_all();
+        };
+    });
+    for (size_t i = 1; i < receive_task_count; ++i) {
+        auto name = MUST(KString::formatted("Network Task #{}", i));
+        MUST(Process::create_kernel_process(name->view(), NetworkReceiveTask_main, reinterpret_cast<void*>(i), 1u << i));
+    }
 
+    auto* buffer = allocate_packet_buffer(packet_buffer_size);
+    auto& task = (*receive_tasks)[0];
     while (!Process::current().is_dying()) {
         flush_delayed_tcp_acks();
         retransmit_tcp_packets();
-        size_t packet_size = dequeue_packet(buffer, buffer_size, packet_timestamp);
-        if (!packet_size) {
+        if (!process_next_packet(0, buffer, packet_buffer_size)) {
             auto timeout_time = Duration::from_milliseconds(500);
             auto timeout = Thread::BlockTimeout { false, &timeout_time };
-            [[maybe_unused]] auto result = packet_wait_queue.wait_on(timeout, "NetworkTask"sv);
-            continue;
-        }
-        if (packet_size < sizeof(EthernetFrameHeader)) {
-            dbgln("NetworkTask: Packet is too small to be an Ethernet packet! ({})", packet_size);
-            continue;
-        }
-        auto& eth = *(EthernetFrameHeader const*)buffer;
-        dbgln_if(ETHERNET_DEBUG, "NetworkTask: From {} to {}, ether_type={:#04x}, packet_size={}", eth.source().to_string(), eth.destination().to_string(), eth.ether_type(), packet_size);
-
-        switch (eth.ether_type()) {
-        case EtherType::ARP:
-            handle_arp(eth, packet_size);
-            break;
-        case EtherType::IPv4:
-            handle_ipv4(eth, packet_size, packet_timestamp);
-            break;
-        case EtherType::IPv6:
-            // ignore
-            break;
-        default:
-            dbgln_if(ETHERNET_DEBUG, "NetworkTask: Unknown ethernet type {:#04x}", eth.ether_type());
+            [[maybe_unused]] auto result = task.packet_wait_queue.wait_on(timeout, "NetworkTask"sv);
         }
     }
     Process::current().sys$exit(0);
     VERIFY_NOT_REACHED();
 }
 
+void NetworkReceiveTask_main(void* entry_data)
+{
+    auto task_index = reinterpret_cast<size_t>(entry_data);
+    auto& task = (*receive_tasks)[task_index];
+    task.thread = Thread::current();
+
+    auto* buffer = allocate_packet_buffer(packet_buffer_size);
+    while (!Process::current().is_dying()) {
+        if (!process_next_packet(task_index, buffer, packet_buffer_size))
+            task.packet_wait_queue.wait_forever("NetworkTask"sv);
+    }
+    Process::current().sys$exit(0);
+    VERIFY_NOT_REACHED();
+}
+
 void handle_arp(EthernetFrameHeader const& eth, size_t frame_size)
 {
     constexpr size_t minimum_arp_frame_size = sizeof(EthernetFrameHeader) + sizeof(ARPPacket);
@@ -308,13 +353,18 @@ void send_delayed_tcp_ack(TCPSocket& socket)
         return;
     }
 
-    delayed_ack_sockets->set(move(socket));
+    delayed_ack_sockets->with_exclusive([&](auto& sockets) { sockets.set(socket); });
 }
 
 void flush_delayed_tcp_acks()
 {
+    // The receive tasks add sockets while holding their locks, so we must not hold on to the set while we lock them.
+    auto sockets = delayed_ack_sockets->with_exclusive([](auto& sockets) { return move(sockets); });
+    if (sockets.is_empty())
+        return;
+
     Vector<NonnullRefPtr<TCPSocket>, 32> remaining_sockets;
-    for (auto& socket : *delayed_ack_sockets) {
+    for (auto& socket : sockets) {
         MutexLocker locker(socket->mutex());
         if (socket->should_delay_next_ack()) {
             MUST(remaining_sockets.try_append(*socket));
@@ -323,12 +373,13 @@ void flush_delayed_tcp_acks()
         [[maybe_unused]] auto result = socket->send_ack();
     }
 
-    if (remaining_sockets.size() != delayed_ack_sockets->size()) {
-        delayed_ack_sockets->clear();
-        if (remaining_sockets.size() > 0)
+    if (remaining_sockets.size() > 0) {
+        if (remaining_sockets.size() != sockets.size())
             dbgln("flush_delayed_tcp_acks: {} sockets remaining", remaining_sockets.size());
-        for (auto&& socket : remaining_sockets)
-            delayed_ack_sockets->set(move(socket));
+        delayed_ack_sockets->with_exclusive([&](auto& sockets) {
+            for (auto&& socket : remaining_sockets)
+                sockets.set(move(socket));
+        });
     }
 }
 
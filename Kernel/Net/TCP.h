@@ -111,6 +111,7 @@ public:
 
     u16 checksum() const { return m_checksum; }
     void set_checksum(u16 checksum) { m_checksum = checksum; }
+    static size_t checksum_offset() { return OFFSET_OF(TCPPacket, m_checksum); }
 
     u16 urgent() const { return m_urgent; }
     void set_urgent(u16 urgent) { m_urgent = urgent; }
@@ -224,7 +224,14 @@ ErrorOr<size_t> TCPSocket::protocol_send(UserOrKernelBuffer const& data, size_t
             return set_so_error(EAGAIN);
     }
 
-    data_length = min(data_length, mss);
+    size_t max_payload_size = mss;
+    if (routing_decision.adapter->supports_tcp_segmentation_offload()) {
+        // Let the adapter cut large writes into MSS-sized segments, but don't overrun the peer's receive window.
+        size_t max_offload_payload_size = NetworkAdapter::max_tcp_segmentation_offload_size - sizeof(IPv4Packet) - sizeof(TCPPacket);
+        max_payload_size = max(mss, min<size_t>(m_send_window_size, max_offload_payload_size));
+    }
+
+    data_length = min(data_length, max_payload_size);
     TRY(send_tcp_packet(TCPFlags::PSH | TCPFlags::ACK, &data, data_length, &routing_decision));
     return data_length;
 }
@@ -303,13 +310,27 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
     if ((options_size % 4) != 0)
         *next_option = to_underlying(TCPOptionKind::End);
 
-    tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    Optional<PacketOffload> offload;
+    if (routing_decision.adapter->supports_checksum_offload()) {
+        offload = PacketOffload {
+            .checksum_start = static_cast<u16>(ipv4_payload_offset),
+            .checksum_offset = static_cast<u16>(TCPPacket::checksum_offset()),
+        };
+        size_t const max_segment_payload_size = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - tcp_header_size;
+        if (payload_size > max_segment_payload_size) {
+            offload->tcp_segment_size = max_segment_payload_size;
+            offload->header_length = ipv4_payload_offset + tcp_header_size;
+        }
+        tcp_packet.set_checksum(compute_tcp_pseudo_header_checksum(local_address(), peer_address(), tcp_header_size + payload_size));
+    } else {
+        tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    }
 
     bool expect_ack { tcp_packet.has_syn() || payload_size > 0 };
     if (expect_ack) {
         bool append_failed { false };
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-            auto result = unacked_packets.packets.try_append({ m_sequence_number, packet, ipv4_payload_offset, *routing_decision.adapter });
+            auto result = unacked_packets.packets.try_append({ m_sequence_number, packet, ipv4_payload_offset, *routing_decision.adapter, offload });
             if (result.is_error()) {
                 dbgln("TCPSocket: Dropped outbound packet because try_append() failed");
                 append_failed = true;
@@ -324,7 +345,10 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
 
     m_packets_out++;
     m_bytes_out += buffer_size;
-    routing_decision.adapter->send_packet(packet->bytes());
+    if (offload.has_value())
+        routing_decision.adapter->send_packet(packet->bytes(), *offload);
+    else
+        routing_decision.adapter->send_packet(packet->bytes());
     if (!expect_ack)
         routing_decision.adapter->release_packet_buffer(*packet);
 
@@ -392,7 +416,7 @@ bool TCPSocket::should_delay_next_ack() const
     return true;
 }
 
-NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(IPv4Address const& source, IPv4Address const& destination, TCPPacket const& packet, u16 payload_size)
+u16 TCPSocket::compute_tcp_pseudo_header_checksum(IPv4Address const& source, IPv4Address const& destination, u16 tcp_length)
 {
     union PseudoHeader {
         struct [[gnu::packed]] {
@@ -406,11 +430,7 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(IPv4Address const& source, I
     };
     static_assert(sizeof(PseudoHeader) == 12);
 
-    Checked<u16> packet_size = packet.header_size();
-    packet_size += payload_size;
-    VERIFY(!packet_size.has_overflow());
-
-    PseudoHeader pseudo_header { .header = { source, destination, 0, (u8)IPv4Protocol::TCP, packet_size.value() } };
+    PseudoHeader pseudo_header { .header = { source, destination, 0, (u8)IPv4Protocol::TCP, tcp_length } };
 
     u32 checksum = 0;
     auto* raw_pseudo_header = pseudo_header.raw;
@@ -419,6 +439,16 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(IPv4Address const& source, I
         if (checksum > 0xffff)
             checksum = (checksum >> 16) + (checksum & 0xffff);
     }
+    return checksum;
+}
+
+NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(IPv4Address const& source, IPv4Address const& destination, TCPPacket const& packet, u16 payload_size)
+{
+    Checked<u16> packet_size = packet.header_size();
+    packet_size += payload_size;
+    VERIFY(!packet_size.has_overflow());
+
+    u32 checksum = compute_tcp_pseudo_header_checksum(source, destination, packet_size.value());
     auto* raw_packet = bit_cast<u16*>(&packet);
     for (size_t i = 0; i < packet.header_size() / sizeof(u16); ++i) {
         checksum += AK::convert_between_host_and_network_endian(raw_packet[i]);
@@ -733,12 +763,25 @@ void TCPSocket::retransmit_packets()
                 VERIFY_NOT_REACHED();
             }
 
+            if (packet.offload.has_value()) {
+                auto& adapter = *routing_decision.adapter;
+                if (!adapter.supports_checksum_offload() || (packet.offload->tcp_segment_size && !adapter.supports_tcp_segmentation_offload())) {
+                    // FIXME: Add support for this. This can happen if after a route change we ended up on an
+                    //        adapter that can't finish the checksum or segmentation of this packet for us.
+                    dbgln("TCPSocket({}) can't retransmit offloaded packet on {}", this, adapter.name());
+                    continue;
+                }
+            }
+
             auto packet_buffer = packet.buffer->bytes();
 
             routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
                 local_address(), routing_decision.next_hop, peer_address(),
                 IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
-            routing_decision.adapter->send_packet(packet_buffer);
+            if (packet.offload.has_value())
+                routing_decision.adapter->send_packet(packet_buffer, *packet.offload);
+            else
+                routing_decision.adapter->send_packet(packet_buffer);
             m_packets_out++;
             m_bytes_out += packet_buffer.size();
         }
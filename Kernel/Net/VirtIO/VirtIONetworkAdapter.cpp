@@ -5,7 +5,11 @@
  */
 
 #include <Kernel/Bus/PCI/IDs.h>
+#include <Kernel/Arch/Processor.h>
 #include <Kernel/Bus/VirtIO/Transport/PCIe/TransportLink.h>
+#include <Kernel/Net/EtherType.h>
+#include <Kernel/Net/EthernetFrameHeader.h>
+#include <Kernel/Net/IPv4.h>
 #include <Kernel/Net/NetworkingManagement.h>
 #include <Kernel/Net/VirtIO/VirtIONetworkAdapter.h>
 
@@ -69,6 +73,16 @@ struct [[gnu::packed]] VirtIONetConfig {
     LittleEndian<u32> supported_hash_types;
 };
 
+static constexpr u8 VIRTIO_NET_OK = 0;
+static constexpr u8 VIRTIO_NET_CTRL_MQ = 4;
+static constexpr u8 VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET = 0;
+
+struct [[gnu::packed]] VirtIONetCtrlMQ {
+    u8 command_class;
+    u8 command;
+    LittleEndian<u16> virtqueue_pairs;
+};
+
 struct [[gnu::packed]] VirtIONetHdr {
     u8 flags;
     u8 gso_type;
@@ -84,12 +98,15 @@ struct [[gnu::packed]] VirtIONetHdr {
 
 using namespace VirtIO;
 
-static constexpr u16 RECEIVEQ = 0;
-static constexpr u16 TRANSMITQ = 1;
+// The queues are laid out as receiveq1, transmitq1, ..., receiveqN, transmitqN, followed by the control queue.
+static constexpr u16 receive_queue_index(size_t pair) { return pair * 2; }
+static constexpr u16 transmit_queue_index(size_t pair) { return pair * 2 + 1; }
 
 static constexpr size_t MAX_RX_FRAME_SIZE = 1514; // Non-jumbo Ethernet frame limit.
-static constexpr size_t RX_BUFFER_SIZE = sizeof(VirtIONetHdr) * MAX_RX_FRAME_SIZE;
+static constexpr size_t RX_BUFFER_SIZE = sizeof(VirtIONetHdr) + MAX_RX_FRAME_SIZE;
 static constexpr u16 MAX_INFLIGHT_PACKETS = 128;
+// Large enough for a few TCP segmentation offloads to be in flight at once.
+static constexpr size_t TX_BUFFER_SIZE = 4 * (sizeof(VirtIONetHdr) + NetworkAdapter::max_tcp_segmentation_offload_size);
 
 UNMAP_AFTER_INIT ErrorOr<bool> VirtIONetworkAdapter::probe(PCI::DeviceIdentifier const& pci_device_identifier)
 {
@@ -115,9 +132,6 @@ UNMAP_AFTER_INIT VirtIONetworkAdapter::VirtIONetworkAdapter(StringView interface
 
 UNMAP_AFTER_INIT ErrorOr<void> VirtIONetworkAdapter::initialize(Badge<NetworkingManagement>)
 {
-    m_rx_buffers = TRY(Memory::RingBuffer::try_create("VirtIONetworkAdapter Rx buffer"sv, RX_BUFFER_SIZE * MAX_INFLIGHT_PACKETS));
-    m_tx_buffers = TRY(Memory::RingBuffer::try_create("VirtIONetworkAdapter Tx buffer"sv, RX_BUFFER_SIZE * MAX_INFLIGHT_PACKETS));
-
     return initialize_virtio_resources();
 }
 
@@ -127,6 +141,10 @@ UNMAP_AFTER_INIT ErrorOr<void> VirtIONetworkAdapter::initialize_virtio_resources
     TRY(Device::initialize_virtio_resources());
     m_device_config = TRY(transport_entity().get_config(VirtIO::ConfigurationType::Device));
 
+    // One queue pair per CPU lets the receive work of different flows happen in parallel.
+    u16 wanted_queue_pair_count = min(Processor::count(), NetworkAdapter::max_receive_queue_count);
+    u16 max_queue_pair_count = 1;
+
     TRY(negotiate_features([&](u64 supported_features) {
         u64 negotiated = 0;
         if (is_feature_set(supported_features, VIRTIO_NET_F_STATUS))
@@ -137,27 +155,104 @@ UNMAP_AFTER_INIT ErrorOr<void> VirtIONetworkAdapter::initialize_virtio_resources
             negotiated |= VIRTIO_NET_F_SPEED_DUPLEX;
         if (is_feature_set(supported_features, VIRTIO_NET_F_MTU))
             negotiated |= VIRTIO_NET_F_MTU;
+        // We never verify transport checksums of incoming packets, so the device may skip computing them.
+        if (is_feature_set(supported_features, VIRTIO_NET_F_GUEST_CSUM))
+            negotiated |= VIRTIO_NET_F_GUEST_CSUM;
+        if (is_feature_set(supported_features, VIRTIO_NET_F_CSUM)) {
+            negotiated |= VIRTIO_NET_F_CSUM;
+            // TSO requires the device to also handle partial checksums.
+            if (is_feature_set(supported_features, VIRTIO_NET_F_HOST_TSO4))
+                negotiated |= VIRTIO_NET_F_HOST_TSO4;
+        }
+        // Using more than one queue pair has to be requested through the control queue.
+        if (wanted_queue_pair_count > 1 && is_feature_set(supported_features, VIRTIO_NET_F_CTRL_VQ | VIRTIO_NET_F_MQ)) {
+            max_queue_pair_count = transport_entity().config_read16(*m_device_config, offsetof(VirtIONetConfig, max_virtqueue_pairs));
+            if (max_queue_pair_count > 1)
+                negotiated |= VIRTIO_NET_F_CTRL_VQ | VIRTIO_NET_F_MQ;
+        }
         return negotiated;
     }));
 
+    set_checksum_offload(is_feature_accepted(VIRTIO_NET_F_CSUM));
+    set_tcp_segmentation_offload(is_feature_accepted(VIRTIO_NET_F_HOST_TSO4));
+
     TRY(handle_device_config_change());
-    TRY(setup_queues(2)); // receive & transmit
+
+    u16 queue_pair_count = 1;
+    if (is_feature_accepted(VIRTIO_NET_F_MQ)) {
+        // The control queue comes after all of the queue pairs of the device, including the ones we don't use.
+        m_control_queue_index = receive_queue_index(max_queue_pair_count);
+        m_control_buffer = TRY(MM.allocate_dma_buffer_page("VirtIONetworkAdapter control buffer"sv, Memory::Region::Access::ReadWrite, m_control_buffer_page));
+        TRY(setup_queues(*m_control_queue_index + 1));
+    } else {
+        TRY(setup_queues(2)); // receive & transmit
+    }
 
     finish_init();
 
-    {
+    if (m_control_queue_index.has_value()) {
+        auto requested_queue_pair_count = min(wanted_queue_pair_count, max_queue_pair_count);
+        if (auto result = set_queue_pair_count(requested_queue_pair_count); result.is_error())
+            dmesgln("VirtIONetworkAdapter: Couldn't enable {} queue pairs, using only one: {}", requested_queue_pair_count, result.error());
+        else
+            queue_pair_count = requested_queue_pair_count;
+    }
+
+    TRY(m_queue_pairs.try_ensure_capacity(queue_pair_count));
+    for (u16 pair = 0; pair < queue_pair_count; ++pair) {
+        auto rx_buffers = TRY(Memory::RingBuffer::try_create("VirtIONetworkAdapter Rx buffer"sv, RX_BUFFER_SIZE * MAX_INFLIGHT_PACKETS));
+        auto tx_buffers = TRY(Memory::RingBuffer::try_create("VirtIONetworkAdapter Tx buffer"sv, TX_BUFFER_SIZE));
+        m_queue_pairs.unchecked_append({ move(rx_buffers), move(tx_buffers) });
+    }
+    set_receive_queue_count(queue_pair_count);
+
+    for (u16 pair = 0; pair < queue_pair_count; ++pair) {
         // Supply receive buffers.
-        auto& rx_queue = get_queue(RECEIVEQ);
+        auto& rx_buffers = *m_queue_pairs[pair].rx_buffers;
+        auto& rx_queue = get_queue(receive_queue_index(pair));
         SpinlockLocker queue_lock(rx_queue.lock());
         VirtIO::QueueChain chain(rx_queue);
-        while (m_rx_buffers->available_bytes() > RX_BUFFER_SIZE) {
+        while (rx_buffers.available_bytes() > RX_BUFFER_SIZE) {
             // We know that the RingBuffer will not wraparound in this loop. But it's still awkward.
-            auto buffer_start = MUST(m_rx_buffers->reserve_space(RX_BUFFER_SIZE));
+            auto buffer_start = MUST(rx_buffers.reserve_space(RX_BUFFER_SIZE));
             VERIFY(chain.add_buffer_to_chain(buffer_start, RX_BUFFER_SIZE, VirtIO::BufferType::DeviceWritable));
-            supply_chain_and_notify(RECEIVEQ, chain);
+            supply_chain_and_notify(receive_queue_index(pair), chain);
         }
     }
 
+    dmesgln("VirtIONetworkAdapter: Using {} queue pairs", queue_pair_count);
+    return {};
+}
+
+UNMAP_AFTER_INIT ErrorOr<void> VirtIONetworkAdapter::set_queue_pair_count(u16 count)
+{
+    // The command is followed by the status that the device writes back.
+    auto& command = *reinterpret_cast<VirtIONetCtrlMQ*>(m_control_buffer->vaddr().as_ptr());
+    command.command_class = VIRTIO_NET_CTRL_MQ;
+    command.command = VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET;
+    command.virtqueue_pairs = count;
+    auto& status = *m_control_buffer->vaddr().offset(sizeof(VirtIONetCtrlMQ)).as_ptr();
+    status = ~VIRTIO_NET_OK;
+    m_control_command_completed = false;
+
+    {
+        auto& queue = get_queue(*m_control_queue_index);
+        SpinlockLocker queue_lock(queue.lock());
+        VirtIO::QueueChain chain(queue);
+        VERIFY(chain.add_buffer_to_chain(m_control_buffer_page->paddr(), sizeof(VirtIONetCtrlMQ), VirtIO::BufferType::DeviceReadable));
+        VERIFY(chain.add_buffer_to_chain(m_control_buffer_page->paddr().offset(sizeof(VirtIONetCtrlMQ)), sizeof(status), VirtIO::BufferType::DeviceWritable));
+        supply_chain_and_notify(*m_control_queue_index, chain);
+    }
+
+    for (size_t attempt = 0; !m_control_command_completed && attempt < 10; ++attempt) {
+        auto timeout_time = Duration::from_milliseconds(100);
+        auto timeout = Thread::BlockTimeout { false, &timeout_time };
+        [[maybe_unused]] auto result = m_control_wait_queue.wait_on(timeout, "VirtIONetworkAdapter"sv);
+    }
+    if (!m_control_command_completed)
+        return ETIMEDOUT;
+    if (status != VIRTIO_NET_OK)
+        return EIO;
     return {};
 }
 
@@ -196,9 +291,30 @@ void VirtIONetworkAdapter::handle_queue_update(u16 queue_index)
 {
     dbgln_if(VIRTIO_DEBUG, "VirtIONetworkAdapter: handle_queue_update {}", queue_index);
 
-    if (queue_index == RECEIVEQ) {
+    if (queue_index == m_control_queue_index) {
+        auto& queue = get_queue(queue_index);
+        SpinlockLocker queue_lock(queue.lock());
+        size_t used;
+        VirtIO::QueueChain popped_chain = queue.pop_used_buffer_chain(used);
+        while (!popped_chain.is_empty()) {
+            popped_chain.release_buffer_slots_to_queue();
+            popped_chain = queue.pop_used_buffer_chain(used);
+        }
+        m_control_command_completed = true;
+        m_control_wait_queue.wake_all();
+        return;
+    }
+
+    auto pair = queue_index / 2;
+    if (pair >= m_queue_pairs.size()) {
+        dmesgln("VirtIONetworkAdapter: unexpected update for queue {}", queue_index);
+        return;
+    }
+
+    if (queue_index == receive_queue_index(pair)) {
         // FIXME: Disable interrupts while receiving as recommended by the spec.
-        auto& queue = get_queue(RECEIVEQ);
+        auto& rx_buffers = *m_queue_pairs[pair].rx_buffers;
+        auto& queue = get_queue(queue_index);
         SpinlockLocker queue_lock(queue.lock());
         size_t used;
         VirtIO::QueueChain popped_chain = queue.pop_used_buffer_chain(used);
@@ -206,30 +322,29 @@ void VirtIONetworkAdapter::handle_queue_update(u16 queue_index)
         while (!popped_chain.is_empty()) {
             VERIFY(popped_chain.length() == 1);
             popped_chain.for_each([&](PhysicalAddress addr, size_t length) {
-                size_t offset = addr.as_ptr() - m_rx_buffers->start_of_region().as_ptr();
-                auto* message = reinterpret_cast<VirtIONetHdr*>(m_rx_buffers->vaddr().offset(offset).as_ptr());
-                did_receive({ message->frame, length - sizeof(VirtIONetHdr) });
+                size_t offset = addr.as_ptr() - rx_buffers.start_of_region().as_ptr();
+                auto* message = reinterpret_cast<VirtIONetHdr*>(rx_buffers.vaddr().offset(offset).as_ptr());
+                did_receive({ message->frame, length - sizeof(VirtIONetHdr) }, pair);
             });
 
-            supply_chain_and_notify(RECEIVEQ, popped_chain);
+            supply_chain_and_notify(queue_index, popped_chain);
             popped_chain = queue.pop_used_buffer_chain(used);
         }
-    } else if (queue_index == TRANSMITQ) {
-        auto& queue = get_queue(TRANSMITQ);
+    } else {
+        auto& tx_buffers = *m_queue_pairs[pair].tx_buffers;
+        auto& queue = get_queue(queue_index);
         SpinlockLocker queue_lock(queue.lock());
-        SpinlockLocker ringbuffer_lock(m_tx_buffers->lock());
+        SpinlockLocker ringbuffer_lock(tx_buffers.lock());
 
         size_t used;
         VirtIO::QueueChain popped_chain = queue.pop_used_buffer_chain(used);
         do {
-            popped_chain.for_each([this](PhysicalAddress address, size_t length) {
-                m_tx_buffers->reclaim_space(address, length);
+            popped_chain.for_each([&](PhysicalAddress address, size_t length) {
+                tx_buffers.reclaim_space(address, length);
             });
             popped_chain.release_buffer_slots_to_queue();
             popped_chain = queue.pop_used_buffer_chain(used);
         } while (!popped_chain.is_empty());
-    } else {
-        dmesgln("VirtIONetworkAdapter: unexpected update for queue {}", queue_index);
     }
 }
 
@@ -256,23 +371,69 @@ void VirtIONetworkAdapter::send_raw(ReadonlyBytes payload)
 {
     dbgln_if(VIRTIO_DEBUG, "VirtIONetworkAdapter: send_raw length={}", payload.size());
 
-    auto& queue = get_queue(TRANSMITQ);
+    VirtIONetHdr hdr {};
+    transmit(hdr, payload);
+}
+
+void VirtIONetworkAdapter::send_raw_with_offload(ReadonlyBytes payload, PacketOffload const& offload)
+{
+    dbgln_if(VIRTIO_DEBUG, "VirtIONetworkAdapter: send_raw_with_offload length={} segment_size={}", payload.size(), offload.tcp_segment_size);
+
+    VirtIONetHdr hdr {};
+    hdr.flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+    hdr.csum_start = offload.checksum_start;
+    hdr.csum_offset = offload.checksum_offset;
+    if (offload.tcp_segment_size) {
+        hdr.gso_type = VIRTIO_NET_HDR_GSO_TCPV4;
+        hdr.gso_size = offload.tcp_segment_size;
+        hdr.hdr_len = offload.header_length;
+    }
+    transmit(hdr, payload);
+}
+
+// The device delivers the replies of a flow to the queue pair it was sent on, so all of its frames have to go out
+// on the same one.
+size_t VirtIONetworkAdapter::queue_pair_for_frame(ReadonlyBytes frame) const
+{
+    if (m_queue_pairs.size() == 1)
+        return 0;
+    if (frame.size() < sizeof(EthernetFrameHeader) + sizeof(IPv4Packet))
+        return 0;
+    auto const& eth = *reinterpret_cast<EthernetFrameHeader const*>(frame.data());
+    if (eth.ether_type() != EtherType::IPv4)
+        return 0;
+    auto const& ipv4 = *static_cast<IPv4Packet const*>(eth.payload());
+    u32 hash = pair_int_hash(ipv4.source().to_u32(), ipv4.destination().to_u32());
+    auto protocol = static_cast<IPv4Protocol>(ipv4.protocol());
+    if ((protocol == IPv4Protocol::TCP || protocol == IPv4Protocol::UDP) && frame.size() >= sizeof(EthernetFrameHeader) + sizeof(IPv4Packet) + sizeof(u32)) {
+        // Both protocols start with the source and destination ports.
+        u32 ports;
+        memcpy(&ports, ipv4.payload(), sizeof(ports));
+        hash = pair_int_hash(hash, ports);
+    }
+    return hash % m_queue_pairs.size();
+}
+
+void VirtIONetworkAdapter::transmit(VirtIONetHdr const& hdr, ReadonlyBytes payload)
+{
+    auto pair = queue_pair_for_frame(payload);
+    auto& tx_buffers = *m_queue_pairs[pair].tx_buffers;
+    auto& queue = get_queue(transmit_queue_index(pair));
     SpinlockLocker queue_lock(queue.lock());
     VirtIO::QueueChain chain(queue);
 
-    SpinlockLocker ringbuffer_lock(m_tx_buffers->lock());
-    if (m_tx_buffers->available_bytes() < sizeof(VirtIONetHdr) + payload.size()) {
+    SpinlockLocker ringbuffer_lock(tx_buffers.lock());
+    if (tx_buffers.available_bytes() < sizeof(VirtIONetHdr) + payload.size()) {
         // We can drop packets that don't fit to apply back pressure on eager senders.
         dmesgln("VirtIONetworkAdapter: not enough space in the buffer. Dropping packet");
         return;
     }
 
     // FIXME: Handle errors from pushing to the chain and rewind the RingBuffer.
-    VirtIONetHdr hdr {};
-    VERIFY(copy_data_to_chain(chain, *m_tx_buffers, reinterpret_cast<u8*>(&hdr), sizeof(hdr)));
-    VERIFY(copy_data_to_chain(chain, *m_tx_buffers, payload.data(), payload.size()));
+    VERIFY(copy_data_to_chain(chain, tx_buffers, reinterpret_cast<u8 const*>(&hdr), sizeof(hdr)));
+    VERIFY(copy_data_to_chain(chain, tx_buffers, payload.data(), payload.size()));
 
-    supply_chain_and_notify(TRANSMITQ, chain);
+    supply_chain_and_notify(transmit_queue_index(pair), chain);
 }
 
 }
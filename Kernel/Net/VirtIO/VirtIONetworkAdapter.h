@@ -6,12 +6,18 @@
 
 #pragma once
 
+#include <AK/Vector.h>
 #include <Kernel/Bus/VirtIO/Device.h>
 #include <Kernel/Memory/RingBuffer.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Tasks/WaitQueue.h>
 
 namespace Kernel {
 
+namespace VirtIO {
+struct VirtIONetHdr;
+}
+
 class VirtIONetworkAdapter
     : public VirtIO::Device
     , public NetworkAdapter {
@@ -42,6 +48,11 @@ private:
 
     // NetworkAdapter
     virtual void send_raw(ReadonlyBytes) override;
+    virtual void send_raw_with_offload(ReadonlyBytes, PacketOffload const&) override;
+
+    void transmit(VirtIO::VirtIONetHdr const&, ReadonlyBytes);
+    size_t queue_pair_for_frame(ReadonlyBytes) const;
+    ErrorOr<void> set_queue_pair_count(u16);
 
 private:
     VirtIO::Configuration const* m_device_config { nullptr };
@@ -52,8 +63,20 @@ private:
     i32 m_link_speed { LINKSPEED_INVALID };
     bool m_link_duplex { false };
 
-    OwnPtr<Memory::RingBuffer> m_rx_buffers;
-    OwnPtr<Memory::RingBuffer> m_tx_buffers;
+    // Each pair is a receive queue and a transmit queue. The device delivers the packets of a flow to the receive
+    // queue of the pair that the flow was last transmitted on.
+    struct QueuePair {
+        NonnullOwnPtr<Memory::RingBuffer> rx_buffers;
+        NonnullOwnPtr<Memory::RingBuffer> tx_buffers;
+    };
+    Vector<QueuePair> m_queue_pairs;
+
+    // Only set up if the device supports more than one queue pair.
+    Optional<u16> m_control_queue_index;
+    OwnPtr<Memory::Region> m_control_buffer;
+    RefPtr<Memory::PhysicalPage> m_control_buffer_page;
+    Atomic<bool> m_control_command_completed { false };
+    WaitQueue m_control_wait_queue;
 };
 
 }
@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NumericLimits.h>
+#include <Kernel/API/IORing.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Net/Socket.h>
+#include <Kernel/Tasks/IORingWorkQueue.h>
+#include <Kernel/Tasks/Process.h>
+
+namespace Kernel {
+
+// Submissions run by a worker get at most this much data at once. Like read() and write(), they may then complete
+// with less than was asked for.
+static constexpr size_t maximum_worker_transfer_size = 1 * MiB;
+
+// Whether running a submission right away could leave the calling thread waiting, and the rest of the ring with it.
+static bool may_block(IORingSubmission const& submission, OpenFileDescription& description)
+{
+    // Files may have to wait for the disk.
+    if (description.inode())
+        return true;
+
+    bool is_blocking = description.is_blocking();
+    if (submission.opcode == IORingOpcode::Send || submission.opcode == IORingOpcode::Recv)
+        is_blocking = is_blocking && (submission.flags & MSG_DONTWAIT) == 0;
+    if (!is_blocking)
+        return false;
+
+    switch (submission.opcode) {
+    case IORingOpcode::Read:
+    case IORingOpcode::Recv:
+    case IORingOpcode::Accept:
+        return !description.can_read();
+    default:
+        // Writes may have to wait for room halfway through.
+        return true;
+    }
+}
+
+// Runs a submission on the calling thread.
+ErrorOr<FlatPtr> Process::execute_io_ring_submission(IORingSubmission const& submission)
+{
+    if (submission.length > NumericLimits<ssize_t>::max())
+        return EINVAL;
+
+    Userspace<u8*> user_buffer(static_cast<FlatPtr>(submission.buffer));
+
+    switch (submission.opcode) {
+    case IORingOpcode::Nop:
+        return 0;
+    case IORingOpcode::Read:
+        if (submission.offset < 0)
+            return read_impl(submission.fd, user_buffer, submission.length);
+        return pread_impl(submission.fd, user_buffer, submission.length, submission.offset);
+    case IORingOpcode::Write: {
+        if (submission.length == 0)
+            return 0;
+        auto description = TRY(open_file_description(submission.fd));
+        if (!description->is_writable())
+            return EBADF;
+        if (submission.offset >= 0 && !description->file().is_seekable())
+            return EINVAL;
+        auto buffer = TRY(UserOrKernelBuffer::for_user_buffer(user_buffer, submission.length));
+        return do_write(*description, buffer, submission.length, submission.offset >= 0 ? submission.offset : Optional<off_t> {});
+    }
+    case IORingOpcode::Fsync: {
+        auto description = TRY(open_file_description(submission.fd));
+        TRY(description->sync());
+        return 0;
+    }
+    case IORingOpcode::Accept:
+        TRY(require_promise(Pledge::accept));
+        return accept_impl(submission.fd, {}, {}, submission.flags);
+    case IORingOpcode::Send: {
+        auto description = TRY(open_file_description(submission.fd));
+        if (!description->is_socket())
+            return ENOTSOCK;
+        if (description->socket()->is_shut_down_for_writing()) {
+            if ((submission.flags & MSG_NOSIGNAL) == 0)
+                Thread::current()->send_signal(SIGPIPE, &Process::current());
+            return EPIPE;
+        }
+        auto buffer = TRY(UserOrKernelBuffer::for_user_buffer(user_buffer, submission.length));
+        return do_send(*description, buffer, submission.length, submission.flags, {}, 0);
+    }
+    case IORingOpcode::Recv: {
+        auto description = TRY(open_file_description(submission.fd));
+        if (!description->is_socket())
+            return ENOTSOCK;
+        auto& socket = *description->socket();
+        if (socket.is_shut_down_for_reading())
+            return 0;
+        auto buffer = TRY(UserOrKernelBuffer::for_user_buffer(user_buffer, submission.length));
+        UnixDateTime timestamp {};
+        bool blocking = (submission.flags & MSG_DONTWAIT) ? false : description->is_blocking();
+        return TRY(socket.recvfrom(*description, buffer, submission.length, submission.flags, {}, {}, timestamp, blocking));
+    }
+    }
+    return EINVAL;
+}
+
+// Checks a submission that is about to be handed to a worker the way its system call would, and copies the data it
+// writes.
+ErrorOr<NonnullOwnPtr<IORingJob>> Process::create_io_ring_job(FlatPtr ring, IORingSubmission const& submission, NonnullRefPtr<OpenFileDescription> description)
+{
+    switch (submission.opcode) {
+    case IORingOpcode::Read:
+        if (!description->is_readable())
+            return EBADF;
+        if (description->is_directory())
+            return EISDIR;
+        if (submission.offset >= 0 && !description->file().is_seekable())
+            return EINVAL;
+        break;
+    case IORingOpcode::Write:
+        if (!description->is_writable())
+            return EBADF;
+        if (submission.offset >= 0 && !description->file().is_seekable())
+            return EINVAL;
+        break;
+    case IORingOpcode::Accept:
+        TRY(require_promise(Pledge::accept));
+        if (!description->is_socket())
+            return ENOTSOCK;
+        break;
+    case IORingOpcode::Send:
+        if (!description->is_socket())
+            return ENOTSOCK;
+        if (description->socket()->is_shut_down_for_writing()) {
+            if ((submission.flags & MSG_NOSIGNAL) == 0)
+                Thread::current()->send_signal(SIGPIPE, &Process::current());
+            return EPIPE;
+        }
+        break;
+    case IORingOpcode::Recv:
+        if (!description->is_socket())
+            return ENOTSOCK;
+        break;
+    case IORingOpcode::Fsync:
+    case IORingOpcode::Nop:
+        break;
+    }
+
+    auto job = TRY(adopt_nonnull_own_or_enomem(new (nothrow) IORingJob(ring, submission, move(description))));
+    size_t size = min<u64>(submission.length, maximum_worker_transfer_size);
+    switch (submission.opcode) {
+    case IORingOpcode::Read:
+    case IORingOpcode::Recv:
+        job->buffer = TRY(ByteBuffer::create_uninitialized(size));
+        break;
+    case IORingOpcode::Write:
+    case IORingOpcode::Send:
+        job->buffer = TRY(ByteBuffer::create_uninitialized(size));
+        TRY(copy_from_user(job->buffer.data(), Userspace<u8 const*>(static_cast<FlatPtr>(submission.buffer)), size));
+        break;
+    default:
+        break;
+    }
+    return job;
+}
+
+// Gives the process what a worker came up with.
+ErrorOr<FlatPtr> Process::finish_io_ring_job(IORingJob& job)
+{
+    if (job.result.is_error())
+        return job.result.release_error();
+    auto result = job.result.value();
+
+    switch (job.submission.opcode) {
+    case IORingOpcode::Read:
+    case IORingOpcode::Recv:
+        TRY(copy_to_user(Userspace<u8*>(static_cast<FlatPtr>(job.submission.buffer)), job.buffer.data(), result));
+        return result;
+    case IORingOpcode::Accept:
+        return install_accepted_socket(TRY(allocate_fd()), *job.accepted_socket, job.submission.flags);
+    default:
+        return result;
+    }
+}
+
+// Runs a submission right away if it can't block, and hands it to a worker otherwise. Returns nothing in the latter
+// case, the completion is posted once the worker is done.
+ErrorOr<Optional<FlatPtr>> Process::submit_io_ring_submission(FlatPtr ring, IORingSubmission const& submission)
+{
+    if (submission.length > NumericLimits<ssize_t>::max())
+        return EINVAL;
+    if (submission.opcode == IORingOpcode::Nop)
+        return Optional<FlatPtr> { 0 };
+
+    // Let the calling thread report bad descriptors, like any other error that doesn't need a worker.
+    auto description_or_error = open_file_description(submission.fd);
+    if (description_or_error.is_error() || !may_block(submission, *description_or_error.value()))
+        return Optional<FlatPtr> { TRY(execute_io_ring_submission(submission)) };
+
+    auto job = TRY(create_io_ring_job(ring, submission, description_or_error.release_value()));
+    auto work_queue = TRY(m_io_ring_work_queue.with([](auto& work_queue) -> ErrorOr<NonnullRefPtr<IORingWorkQueue>> {
+        if (!work_queue)
+            work_queue = TRY(IORingWorkQueue::try_create());
+        return *work_queue;
+    }));
+    TRY(work_queue->queue(move(job)));
+    return OptionalNone {};
+}
+
+ErrorOr<FlatPtr> Process::sys$io_ring_enter(Userspace<IORing*> user_ring, u32 to_submit, u32 min_complete)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    TRY(require_promise(Pledge::stdio));
+
+    auto ring = TRY(copy_typed_from_user(user_ring));
+    if (ring.entries == 0 || ring.entries > IO_RING_MAX_ENTRIES || !is_power_of_two(ring.entries))
+        return EINVAL;
+    if (ring.submission_tail - ring.submission_head > ring.entries)
+        return EINVAL;
+    if (min_complete > ring.entries)
+        return EINVAL;
+
+    auto* user_header = user_ring.unsafe_userspace_ptr();
+    auto* ring_base = reinterpret_cast<u8*>(user_header);
+    auto* submissions = reinterpret_cast<IORingSubmission*>(ring_base + io_ring_submissions_offset());
+    auto* completions = reinterpret_cast<IORingCompletion*>(ring_base + io_ring_completions_offset(ring.entries));
+    u32 const mask = ring.entries - 1;
+    auto const ring_id = user_ring.ptr();
+
+    auto in_flight_count = [&]() -> size_t {
+        return m_io_ring_work_queue.with([&](auto& work_queue) { return work_queue ? work_queue->in_flight_count(ring_id) : 0; });
+    };
+
+    // Publish progress after every entry, so userspace can reap completions even if a later one faults.
+    auto post_completion = [&](u64 user_data, ErrorOr<FlatPtr> const& result) -> ErrorOr<void> {
+        IORingCompletion completion {
+            .user_data = user_data,
+            .result = result.is_error() ? -static_cast<i64>(result.error().code()) : static_cast<i64>(result.value()),
+        };
+        TRY(copy_to_user(&completions[ring.completion_tail & mask], &completion));
+        ++ring.completion_tail;
+        TRY(copy_to_user(&user_header->completion_tail, &ring.completion_tail));
+        return {};
+    };
+
+    // Completions of the submissions that are in flight were accounted for when they were consumed, so there's always
+    // room for them.
+    auto post_finished_jobs = [&]() -> ErrorOr<void> {
+        auto work_queue = m_io_ring_work_queue.with([](auto& work_queue) { return work_queue; });
+        if (!work_queue)
+            return {};
+        while (auto job = work_queue->take_finished_job(ring_id))
+            TRY(post_completion(job->submission.user_data, finish_io_ring_job(*job)));
+        return {};
+    };
+
+    TRY(post_finished_jobs());
+
+    u32 submitted = 0;
+    while (submitted < to_submit && ring.submission_head != ring.submission_tail) {
+        // Never overwrite a completion that userspace has not reaped yet, nor one that a worker will post later.
+        auto is_completion_ring_full = [&] { return ring.completion_tail - ring.completion_head + in_flight_count() >= ring.entries; };
+        if (is_completion_ring_full()) {
+            TRY(copy_from_user(&ring.completion_head, &user_header->completion_head));
+            if (is_completion_ring_full()) {
+                if (submitted == 0 && min_complete == 0)
+                    return EBUSY;
+                break;
+            }
+        }
+
+        IORingSubmission submission;
+        TRY(copy_from_user(&submission, &submissions[ring.submission_head & mask]));
+
+        ++ring.submission_head;
+        ++submitted;
+        TRY(copy_to_user(&user_header->submission_head, &ring.submission_head));
+
+        auto result = submit_io_ring_submission(ring_id, submission);
+        if (result.is_error())
+            TRY(post_completion(submission.user_data, result.release_error()));
+        else if (result.value().has_value())
+            TRY(post_completion(submission.user_data, result.value().value()));
+    }
+
+    // Wait for the workers until there are enough completions to reap, or nothing left to wait for.
+    while (true) {
+        TRY(copy_from_user(&ring.completion_head, &user_header->completion_head));
+        if (ring.completion_tail - ring.completion_head >= min_complete || in_flight_count() == 0)
+            break;
+        auto work_queue = m_io_ring_work_queue.with([](auto& work_queue) { return work_queue; });
+        if (work_queue->wait_for_finished_job().was_interrupted()) {
+            if (submitted == 0)
+                return EINTR;
+            break;
+        }
+        TRY(post_finished_jobs());
+    }
+
+    return submitted;
+}
+
+}
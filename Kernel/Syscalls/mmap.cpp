@@ -229,6 +229,10 @@ ErrorOr<FlatPtr> Process::sys$mmap(Userspace<Syscall::SC_mmap_params const*> use
         vmobject = TRY(description->vmobject_for_mmap(*this, requested_range, used_offset, map_shared));
     }
 
+    // Unless told otherwise, place big mappings of memory that isn't file-backed such that they can be mapped with large pages.
+    if (!params.alignment && !vmobject->is_inode())
+        alignment = Memory::preferred_alignment_for_region_of_size(rounded_size);
+
     return address_space().with([&](auto& space) -> ErrorOr<FlatPtr> {
         // If MAP_FIXED is specified, existing mappings that intersect the requested range are removed.
         if (map_fixed)
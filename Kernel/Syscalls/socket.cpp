@@ -90,11 +90,13 @@ ErrorOr<FlatPtr> Process::sys$accept4(Userspace<Syscall::SC_accept4_params const
     TRY(require_promise(Pledge::accept));
     auto params = TRY(copy_typed_from_user(user_params));
 
-    int accepting_socket_fd = params.sockfd;
     Userspace<sockaddr*> user_address((FlatPtr)params.addr);
     Userspace<socklen_t*> user_address_size((FlatPtr)params.addrlen);
-    int flags = params.flags;
+    return accept_impl(params.sockfd, user_address, user_address_size, params.flags);
+}
 
+ErrorOr<FlatPtr> Process::accept_impl(int accepting_socket_fd, Userspace<sockaddr*> user_address, Userspace<socklen_t*> user_address_size, int flags)
+{
     socklen_t address_size = 0;
     if (user_address)
         TRY(copy_from_user(&address_size, static_ptr_cast<socklen_t const*>(user_address_size)));
@@ -131,7 +133,12 @@ ErrorOr<FlatPtr> Process::sys$accept4(Userspace<Syscall::SC_accept4_params const
         TRY(copy_to_user(user_address_size, &address_size));
     }
 
-    auto accepted_socket_description = TRY(OpenFileDescription::try_create(*accepted_socket));
+    return install_accepted_socket(move(fd_allocation), *accepted_socket, flags);
+}
+
+ErrorOr<FlatPtr> Process::install_accepted_socket(ScopedDescriptionAllocation fd_allocation, Socket& accepted_socket, int flags)
+{
+    auto accepted_socket_description = TRY(OpenFileDescription::try_create(accepted_socket));
 
     accepted_socket_description->set_readable(true);
     accepted_socket_description->set_writable(true);
@@ -147,7 +154,7 @@ ErrorOr<FlatPtr> Process::sys$accept4(Userspace<Syscall::SC_accept4_params const
     }));
 
     // NOTE: Moving this state to Completed is what causes connect() to unblock on the client side.
-    accepted_socket->set_setup_state(Socket::SetupState::Completed);
+    accepted_socket.set_setup_state(Socket::SetupState::Completed);
     return fd_allocation.fd;
 }
 
@@ -225,21 +232,26 @@ ErrorOr<FlatPtr> Process::sys$sendmsg(int sockfd, Userspace<const struct msghdr*
     }
 
     auto data_buffer = TRY(UserOrKernelBuffer::for_user_buffer((u8*)iovs[0].iov_base, iovs[0].iov_len));
+    return do_send(*description, data_buffer, iovs[0].iov_len, flags, user_addr, addr_length);
+}
 
+ErrorOr<FlatPtr> Process::do_send(OpenFileDescription& description, UserOrKernelBuffer const& data_buffer, size_t data_size, int flags, Userspace<sockaddr const*> user_addr, socklen_t addr_length)
+{
+    auto& socket = *description.socket();
     while (true) {
-        while (!description->can_write()) {
-            if (!description->is_blocking()) {
+        while (!description.can_write()) {
+            if (!description.is_blocking()) {
                 return EAGAIN;
             }
 
             auto unblock_flags = Thread::FileBlocker::BlockFlags::None;
-            if (Thread::current()->block<Thread::WriteBlocker>({}, *description, unblock_flags).was_interrupted()) {
+            if (Thread::current()->block<Thread::WriteBlocker>({}, description, unblock_flags).was_interrupted()) {
                 return EINTR;
             }
             // TODO: handle exceptions in unblock_flags
         }
 
-        auto bytes_sent_or_error = socket.sendto(*description, data_buffer, iovs[0].iov_len, flags, user_addr, addr_length);
+        auto bytes_sent_or_error = socket.sendto(description, data_buffer, data_size, flags, user_addr, addr_length);
         if (bytes_sent_or_error.is_error()) {
             if ((flags & MSG_NOSIGNAL) == 0 && bytes_sent_or_error.error().code() == EPIPE)
                 Thread::current()->send_signal(SIGPIPE, &Process::current());
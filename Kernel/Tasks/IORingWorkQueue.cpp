@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Tasks/IORingWorkQueue.h>
+#include <Kernel/Tasks/Process.h>
+
+namespace Kernel {
+
+// Each of them may be blocked on a descriptor of its own, so this is how many submissions of a process can wait at
+// the same time. The others wait for a worker to become available.
+static constexpr size_t maximum_worker_count = 16;
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+ErrorOr<NonnullRefPtr<IORingWorkQueue>> IORingWorkQueue::try_create()
+{
+    auto work_queue = TRY(adopt_nonnull_ref_or_enomem(new (nothrow) IORingWorkQueue));
+    TRY(work_queue->m_state.with([](auto& state) { return state.workers.try_ensure_capacity(maximum_worker_count); }));
+    return work_queue;
+}
+
+IORingWorkQueue::~IORingWorkQueue()
+{
+    JobList finished;
+    m_state.with([&](auto& state) {
+        VERIFY(state.pending.is_empty());
+        VERIFY(state.running.is_empty());
+        while (auto* job = state.finished.take_first())
+            finished.append(*job);
+    });
+    delete_jobs(finished);
+}
+
+void IORingWorkQueue::delete_jobs(JobList& jobs)
+{
+    while (auto* job = jobs.take_first())
+        delete job;
+}
+
+ErrorOr<void> IORingWorkQueue::queue(NonnullOwnPtr<IORingJob> job)
+{
+    auto needs_worker = TRY(m_state.with([&](auto& state) -> ErrorOr<bool> {
+        if (state.is_shutting_down)
+            return ESRCH;
+        state.pending.append(*job.leak_ptr());
+        // Every worker that isn't running a job already will pick up one of the pending ones.
+        auto available_worker_count = state.workers.size() - state.running.size_slow();
+        return state.workers.size() < maximum_worker_count && state.pending.size_slow() > available_worker_count;
+    }));
+
+    if (needs_worker) {
+        if (auto result = spawn_worker(); result.is_error()) {
+            // The workers we have will get to it eventually, unless there are none.
+            m_state.with([&](auto& state) {
+                if (!state.workers.is_empty())
+                    return;
+                while (auto* pending_job = state.pending.take_first()) {
+                    pending_job->result = Error::copy(result.error());
+                    state.finished.append(*pending_job);
+                }
+            });
+            m_finished_wait_queue.wake_all();
+        }
+    }
+
+    m_pending_wait_queue.wake_one();
+    return {};
+}
+
+OwnPtr<IORingJob> IORingWorkQueue::take_finished_job(FlatPtr ring)
+{
+    return m_state.with([&](auto& state) -> OwnPtr<IORingJob> {
+        for (auto& job : state.finished) {
+            if (job.ring == ring) {
+                state.finished.remove(job);
+                return adopt_own_if_nonnull(&job);
+            }
+        }
+        return nullptr;
+    });
+}
+
+size_t IORingWorkQueue::in_flight_count(FlatPtr ring) const
+{
+    return m_state.with([&](auto const& state) {
+        size_t count = 0;
+        for (auto const* list : { &state.pending, &state.running, &state.finished }) {
+            for (auto const& job : *list) {
+                if (job.ring == ring)
+                    ++count;
+            }
+        }
+        return count;
+    });
+}
+
+void IORingWorkQueue::shutdown()
+{
+    JobList jobs;
+    Vector<NonnullRefPtr<Thread>> workers;
+    m_state.with([&](auto& state) {
+        state.is_shutting_down = true;
+        while (auto* job = state.pending.take_first())
+            jobs.append(*job);
+        while (auto* job = state.finished.take_first())
+            jobs.append(*job);
+        workers = move(state.workers);
+    });
+    delete_jobs(jobs);
+
+    // This interrupts the workers that are blocked on a descriptor. They throw away their job and exit.
+    for (auto& worker : workers)
+        worker->set_should_die();
+    m_pending_wait_queue.wake_all();
+}
+
+ErrorOr<void> IORingWorkQueue::spawn_worker()
+{
+    // The worker holds on to the queue until it exits, which may be after the process died.
+    ref();
+    auto process_and_thread_or_error = Process::create_kernel_process("IORing Worker"sv, [this] {
+        run_worker();
+        Process::current().sys$exit(0);
+        VERIFY_NOT_REACHED();
+    });
+    if (process_and_thread_or_error.is_error()) {
+        unref();
+        return process_and_thread_or_error.release_error();
+    }
+
+    auto thread = move(process_and_thread_or_error.value().first_thread);
+    auto is_shutting_down = m_state.with([&](auto& state) {
+        if (!state.is_shutting_down)
+            state.workers.unchecked_append(thread);
+        return state.is_shutting_down;
+    });
+    if (is_shutting_down)
+        thread->set_should_die();
+    return {};
+}
+
+void IORingWorkQueue::run_worker()
+{
+    while (true) {
+        bool is_shutting_down = false;
+        auto* job = m_state.with([&](auto& state) -> IORingJob* {
+            is_shutting_down = state.is_shutting_down;
+            if (is_shutting_down)
+                return nullptr;
+            auto* job = state.pending.take_first();
+            if (job)
+                state.running.append(*job);
+            return job;
+        });
+        if (is_shutting_down)
+            break;
+        if (!job) {
+            m_pending_wait_queue.wait_forever();
+            continue;
+        }
+
+        job->result = execute(*job);
+
+        auto was_finished = m_state.with([&](auto& state) {
+            state.running.remove(*job);
+            if (state.is_shutting_down)
+                return false;
+            state.finished.append(*job);
+            return true;
+        });
+        if (was_finished)
+            m_finished_wait_queue.wake_all();
+        else
+            delete job;
+    }
+
+    // NOTE: This may delete the queue, so we must not touch it afterwards.
+    unref();
+}
+
+static ErrorOr<void> block_until_readable(OpenFileDescription& description)
+{
+    if (!description.is_blocking() || description.can_read())
+        return {};
+    auto unblock_flags = BlockFlags::None;
+    if (Thread::current()->block<Thread::ReadBlocker>({}, description, unblock_flags).was_interrupted())
+        return EINTR;
+    if (!has_flag(unblock_flags, BlockFlags::Read))
+        return EAGAIN;
+    return {};
+}
+
+static ErrorOr<void> block_until_writable(OpenFileDescription& description)
+{
+    while (!description.can_write()) {
+        if (!description.is_blocking())
+            return EAGAIN;
+        auto unblock_flags = BlockFlags::None;
+        if (Thread::current()->block<Thread::WriteBlocker>({}, description, unblock_flags).was_interrupted())
+            return EINTR;
+    }
+    return {};
+}
+
+// These do what the system calls do, except that we never send SIGPIPE: the process gets EPIPE in the completion.
+ErrorOr<size_t> IORingWorkQueue::execute(IORingJob& job)
+{
+    auto& description = *job.description;
+    auto const& submission = job.submission;
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(job.buffer.data());
+
+    switch (submission.opcode) {
+    case IORingOpcode::Read:
+        TRY(block_until_readable(description));
+        if (submission.offset < 0)
+            return description.read(buffer, job.buffer.size());
+        return description.read(buffer, submission.offset, job.buffer.size());
+    case IORingOpcode::Write: {
+        if (description.should_append() && description.file().is_seekable())
+            TRY(description.seek(0, SEEK_END));
+        size_t total_written = 0;
+        while (total_written < job.buffer.size()) {
+            if (auto result = block_until_writable(description); result.is_error()) {
+                if (total_written > 0)
+                    return total_written;
+                return result.release_error();
+            }
+            auto remaining = buffer.offset(total_written);
+            auto written_or_error = submission.offset >= 0
+                ? description.write(submission.offset + total_written, remaining, job.buffer.size() - total_written)
+                : description.write(remaining, job.buffer.size() - total_written);
+            if (written_or_error.is_error()) {
+                if (total_written > 0)
+                    return total_written;
+                if (written_or_error.error().code() == EAGAIN)
+                    continue;
+                return written_or_error.release_error();
+            }
+            total_written += written_or_error.value();
+        }
+        return total_written;
+    }
+    case IORingOpcode::Fsync:
+        TRY(description.sync());
+        return 0;
+    case IORingOpcode::Accept: {
+        auto& socket = *description.socket();
+        while (true) {
+            job.accepted_socket = socket.accept();
+            if (job.accepted_socket)
+                return 0;
+            if (!description.is_blocking())
+                return EAGAIN;
+            auto unblock_flags = BlockFlags::None;
+            if (Thread::current()->block<Thread::AcceptBlocker>({}, description, unblock_flags).was_interrupted())
+                return EINTR;
+        }
+    }
+    case IORingOpcode::Send: {
+        auto& socket = *description.socket();
+        while (true) {
+            TRY(block_until_writable(description));
+            auto sent = TRY(socket.sendto(description, buffer, job.buffer.size(), submission.flags | MSG_NOSIGNAL, {}, 0));
+            if (sent > 0)
+                return sent;
+        }
+    }
+    case IORingOpcode::Recv: {
+        auto& socket = *description.socket();
+        if (socket.is_shut_down_for_reading())
+            return 0;
+        UnixDateTime timestamp {};
+        bool blocking = (submission.flags & MSG_DONTWAIT) ? false : description.is_blocking();
+        return socket.recvfrom(description, buffer, job.buffer.size(), submission.flags, {}, {}, timestamp, blocking);
+    }
+    case IORingOpcode::Nop:
+        break;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+}
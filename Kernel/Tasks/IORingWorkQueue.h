@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/AtomicRefCounted.h>
+#include <AK/ByteBuffer.h>
+#include <AK/IntrusiveList.h>
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <Kernel/API/IORing.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Library/LockRefPtr.h>
+#include <Kernel/Locking/SpinlockProtected.h>
+#include <Kernel/Net/Socket.h>
+#include <Kernel/Tasks/WaitQueue.h>
+
+namespace Kernel {
+
+// A submission that is run by one of the workers.
+struct IORingJob {
+    IORingJob(FlatPtr ring, IORingSubmission const& submission, NonnullRefPtr<OpenFileDescription> description)
+        : ring(ring)
+        , submission(submission)
+        , description(move(description))
+    {
+    }
+
+    FlatPtr ring { 0 };
+    IORingSubmission submission;
+    NonnullRefPtr<OpenFileDescription> description;
+    // The data to write, or room for the data to read.
+    ByteBuffer buffer;
+    // Only installed in the process' file descriptor table when the completion is posted.
+    LockRefPtr<Socket> accepted_socket;
+    ErrorOr<size_t> result { static_cast<size_t>(0) };
+
+    IntrusiveListNode<IORingJob> list_node;
+};
+
+// Runs the I/O ring submissions of a process that could block on kernel threads of their own, so that a submission
+// waiting for a slow disk or an idle socket doesn't hold up the others. The workers never touch process memory: data
+// to write is copied in when a submission is queued, and read data is copied out when io_ring_enter() posts the
+// completion.
+class IORingWorkQueue final : public AtomicRefCounted<IORingWorkQueue> {
+public:
+    static ErrorOr<NonnullRefPtr<IORingWorkQueue>> try_create();
+    ~IORingWorkQueue();
+
+    ErrorOr<void> queue(NonnullOwnPtr<IORingJob>);
+    OwnPtr<IORingJob> take_finished_job(FlatPtr ring);
+    // Submissions to the ring that were queued, but whose completion has not been taken yet.
+    size_t in_flight_count(FlatPtr ring) const;
+
+    Thread::BlockResult wait_for_finished_job() { return m_finished_wait_queue.wait_on({}); }
+
+    // Called when the process dies. Interrupts the workers and throws away whatever they haven't finished.
+    void shutdown();
+
+private:
+    IORingWorkQueue() = default;
+
+    using JobList = IntrusiveList<&IORingJob::list_node>;
+
+    struct State {
+        JobList pending;
+        JobList running;
+        JobList finished;
+        Vector<NonnullRefPtr<Thread>> workers;
+        bool is_shutting_down { false };
+    };
+
+    ErrorOr<void> spawn_worker();
+    void run_worker();
+    static ErrorOr<size_t> execute(IORingJob&);
+    static void delete_jobs(JobList&);
+
+    SpinlockProtected<State, LockRank::None> m_state;
+    WaitQueue m_pending_wait_queue;
+    WaitQueue m_finished_wait_queue;
+};
+
+}
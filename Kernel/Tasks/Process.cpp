@@ -15,6 +15,7 @@
 #include <Kernel/Interrupts/InterruptDisabler.h>
 #include <Kernel/Security/Credentials.h>
 #include <Kernel/Tasks/Coredump.h>
+#include <Kernel/Tasks/IORingWorkQueue.h>
 #ifdef ENABLE_KERNEL_COVERAGE_COLLECTION
 #    include <Kernel/Devices/KCOVDevice.h>
 #endif
@@ -946,6 +947,10 @@ void Process::die()
     });
 
     kill_all_threads();
+
+    // The I/O ring workers may be blocked on a descriptor for a long time, or even forever.
+    if (auto work_queue = m_io_ring_work_queue.with([](auto& work_queue) { return move(work_queue); }))
+        work_queue->shutdown();
 #ifdef ENABLE_KERNEL_COVERAGE_COLLECTION
     KCOVDevice::free_process();
 #endif
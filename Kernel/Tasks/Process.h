@@ -15,6 +15,7 @@
 #include <AK/RefPtr.h>
 #include <AK/Userspace.h>
 #include <AK/Variant.h>
+#include <Kernel/API/IORing.h>
 #include <Kernel/API/POSIX/select.h>
 #include <Kernel/API/POSIX/sys/resource.h>
 #include <Kernel/API/Syscall.h>
@@ -415,6 +416,7 @@ public:
     ErrorOr<FlatPtr> sys$chown(Userspace<Syscall::SC_chown_params const*>);
     ErrorOr<FlatPtr> sys$fchown(int fd, UserID, GroupID);
     ErrorOr<FlatPtr> sys$fsync(int fd);
+    ErrorOr<FlatPtr> sys$io_ring_enter(Userspace<IORing*>, u32 to_submit, u32 min_complete);
     ErrorOr<FlatPtr> sys$socket(int domain, int type, int protocol);
     ErrorOr<FlatPtr> sys$bind(int sockfd, Userspace<sockaddr const*> addr, socklen_t);
     ErrorOr<FlatPtr> sys$listen(int sockfd, int backlog);
@@ -666,6 +668,7 @@ private:
 
     ErrorOr<void> do_exec(NonnullRefPtr<OpenFileDescription> main_program_description, Vector<NonnullOwnPtr<KString>> arguments, Vector<NonnullOwnPtr<KString>> environment, RefPtr<OpenFileDescription> interpreter_description, Thread*& new_main_thread, InterruptsState& previous_interrupts_state, Elf_Ehdr const& main_program_header, Optional<size_t> minimum_stack_size = {});
     ErrorOr<FlatPtr> do_write(OpenFileDescription&, UserOrKernelBuffer const&, size_t, Optional<off_t> = {});
+    ErrorOr<FlatPtr> do_send(OpenFileDescription&, UserOrKernelBuffer const&, size_t, int flags, Userspace<sockaddr const*>, socklen_t);
 
     ErrorOr<FlatPtr> do_statvfs(FileSystem const& path, Custody const*, statvfs* buf);
 
@@ -695,6 +698,11 @@ private:
     ErrorOr<FlatPtr> read_impl(int fd, Userspace<u8*> buffer, size_t size);
     ErrorOr<FlatPtr> pread_impl(int fd, Userspace<u8*>, size_t, off_t);
     ErrorOr<FlatPtr> readv_impl(int fd, Userspace<const struct iovec*> iov, int iov_count);
+    ErrorOr<FlatPtr> accept_impl(int sockfd, Userspace<sockaddr*> user_address, Userspace<socklen_t*> user_address_size, int flags);
+    ErrorOr<FlatPtr> execute_io_ring_submission(IORingSubmission const&);
+    ErrorOr<Optional<FlatPtr>> submit_io_ring_submission(FlatPtr ring, IORingSubmission const&);
+    ErrorOr<NonnullOwnPtr<IORingJob>> create_io_ring_job(FlatPtr ring, IORingSubmission const&, NonnullRefPtr<OpenFileDescription>);
+    ErrorOr<FlatPtr> finish_io_ring_job(IORingJob&);
 
 public:
     ErrorOr<void> traverse_as_directory(FileSystemID, Function<ErrorOr<void>(FileSystem::DirectoryEntryView const&)> callback) const;
@@ -898,6 +906,7 @@ public:
 
 private:
     ErrorOr<NonnullRefPtr<Custody>> custody_for_dirfd(int dirfd);
+    ErrorOr<FlatPtr> install_accepted_socket(ScopedDescriptionAllocation, Socket& accepted_socket, int flags);
 
     SpinlockProtected<Thread::ListInProcess, LockRank::None>& thread_list() { return m_thread_list; }
     SpinlockProtected<Thread::ListInProcess, LockRank::None> const& thread_list() const { return m_thread_list; }
@@ -947,6 +956,9 @@ private:
 
     SpinlockProtected<RefPtr<Timer>, LockRank::None> m_alarm_timer;
 
+    // Runs the submissions of the process' I/O rings that could block. Created along with the first of them.
+    SpinlockProtected<RefPtr<IORingWorkQueue>, LockRank::None> m_io_ring_work_queue;
+
     SpinlockProtected<UnveilData, LockRank::None> m_unveil_data;
     SpinlockProtected<UnveilData, LockRank::None> m_exec_unveil_data;
 
@@ -20,7 +20,7 @@ namespace Ladybird {
 
 ImageCodecPlugin::~ImageCodecPlugin() = default;
 
-Optional<Web::Platform::DecodedImage> ImageCodecPlugin::decode_image(ReadonlyBytes bytes)
+ImageDecoderClient::Client& ImageCodecPlugin::client()
 {
     if (!m_client) {
 #ifdef AK_OS_ANDROID
@@ -33,20 +33,51 @@ Optional<Web::Platform::DecodedImage> ImageCodecPlugin::decode_image(ReadonlyByt
             m_client = nullptr;
         };
     }
+    return *m_client;
+}
 
-    auto result_or_empty = m_client->decode_image(bytes);
-    if (!result_or_empty.has_value())
-        return {};
-    auto result = result_or_empty.release_value();
-
+static Web::Platform::DecodedImage to_web_decoded_image(ImageDecoderClient::DecodedImage image)
+{
     Web::Platform::DecodedImage decoded_image;
-    decoded_image.is_animated = result.is_animated;
-    decoded_image.loop_count = result.loop_count;
-    for (auto const& frame : result.frames) {
+    decoded_image.is_animated = image.is_animated;
+    decoded_image.loop_count = image.loop_count;
+    for (auto& frame : image.frames)
         decoded_image.frames.empend(move(frame.bitmap), frame.duration);
-    }
-
     return decoded_image;
 }
 
+Optional<Web::Platform::DecodedImage> ImageCodecPlugin::decode_image(ReadonlyBytes bytes)
+{
+    auto result = client().decode_image(bytes);
+    if (!result.has_value())
+        return {};
+    return to_web_decoded_image(result.release_value());
+}
+
+ErrorOr<i64> ImageCodecPlugin::start_decoding_image(ReadonlyBytes bytes, Function<void(Web::Platform::DecodedImage, u32 frame_count)> on_first_frame, Function<void(Optional<Web::Platform::DecodedImage>)> on_complete)
+{
+    return client().start_decoding_image(
+        bytes,
+        [on_first_frame = move(on_first_frame)](auto image, u32 frame_count) {
+            on_first_frame(to_web_decoded_image(move(image)), frame_count);
+        },
+        [on_complete = move(on_complete)](auto result) {
+            if (!result.has_value())
+                return on_complete({});
+            on_complete(to_web_decoded_image(result.release_value()));
+        });
+}
+
+void ImageCodecPlugin::set_image_visible(i64 image_id, bool is_visible)
+{
+    if (m_client)
+        m_client->set_image_visible(image_id, is_visible);
+}
+
+void ImageCodecPlugin::cancel_decoding(i64 image_id)
+{
+    if (m_client)
+        m_client->cancel_decoding(image_id);
+}
+
 }
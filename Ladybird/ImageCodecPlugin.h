@@ -19,7 +19,13 @@ public:
 
     virtual Optional<Web::Platform::DecodedImage> decode_image(ReadonlyBytes data) override;
 
+    virtual ErrorOr<i64> start_decoding_image(ReadonlyBytes, Function<void(Web::Platform::DecodedImage, u32 frame_count)> on_first_frame, Function<void(Optional<Web::Platform::DecodedImage>)> on_complete) override;
+    virtual void set_image_visible(i64 image_id, bool) override;
+    virtual void cancel_decoding(i64 image_id) override;
+
 private:
+    ImageDecoderClient::Client& client();
+
     RefPtr<ImageDecoderClient::Client> m_client;
 };
 
@@ -10,6 +10,7 @@
 #include <LibCore/ArgsParser.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/LocalServer.h>
+#include <LibCore/StandardPaths.h>
 #include <LibCore/System.h>
 #include <LibFileSystem/FileSystem.h>
 #include <LibIPC/SingleServer.h>
@@ -17,6 +18,7 @@
 #include <LibTLS/Certificate.h>
 #include <RequestServer/ConnectionFromClient.h>
 #include <RequestServer/GeminiProtocol.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/HttpProtocol.h>
 #include <RequestServer/HttpsProtocol.h>
 
@@ -54,6 +56,10 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     DefaultRootCACertificates::set_default_certificate_paths(certificates.span());
     [[maybe_unused]] auto& certs = DefaultRootCACertificates::the();
 
+    // Not being able to cache anything is no reason not to work at all.
+    if (auto result = RequestServer::HttpCache::initialize(LexicalPath::join(Core::StandardPaths::cache_directory(), "Ladybird"sv, "RequestServer"sv).string()); result.is_error())
+        dbgln("RequestServer: Failed to initialize the HTTP cache: {}", result.error());
+
     Core::EventLoop event_loop;
 
     [[maybe_unused]] auto gemini = make<RequestServer::GeminiProtocol>();
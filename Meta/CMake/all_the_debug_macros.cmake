@@ -69,6 +69,8 @@ set(HIGHLIGHT_FOCUSED_FRAME_DEBUG ON)
 set(HPET_COMPARATOR_DEBUG ON)
 set(HPET_DEBUG ON)
 set(HTML_SCRIPT_DEBUG ON)
+set(HTTP2_DEBUG ON)
+set(HTTP_CACHE_DEBUG ON)
 set(HTTPJOB_DEBUG ON)
 set(HUNKS_DEBUG ON)
 set(ICMP_DEBUG ON)
@@ -83,6 +85,7 @@ set(INTEL_HDA_DEBUG ON)
 set(INTERRUPT_DEBUG ON)
 set(IOAPIC_DEBUG ON)
 set(IO_DEBUG ON)
+set(IPC_DEBUG ON)
 set(IPV4_DEBUG ON)
 set(IPV4_SOCKET_DEBUG ON)
 set(IRQ_DEBUG ON)
@@ -209,6 +212,7 @@ set(WAITQUEUE_DEBUG ON)
 set(WASI_DEBUG ON)
 set(WASI_FINE_GRAINED_DEBUG ON)
 set(WASM_BINPARSER_DEBUG ON)
+set(WASM_JIT_DEBUG ON)
 set(WASM_TRACE_DEBUG ON)
 set(WASM_VALIDATOR_DEBUG ON)
 set(WEBDRIVER_DEBUG ON)
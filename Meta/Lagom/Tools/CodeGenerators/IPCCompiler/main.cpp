@@ -385,12 +385,12 @@ public:)~~~");
     message_generator.appendln(R"~~~(
     virtual bool valid() const override { return m_ipc_message_valid; }
 
-    virtual ErrorOr<IPC::MessageBuffer> encode() const override
+    virtual ErrorOr<IPC::MessageBuffer> encode(IPC::SharedBufferPool* buffer_pool) const override
     {
         VERIFY(valid());
 
         IPC::MessageBuffer buffer;
-        IPC::Encoder stream(buffer);
+        IPC::Encoder stream(buffer, buffer_pool);
         TRY(stream.encode(endpoint_magic()));
         TRY(stream.encode((int)MessageID::@message.pascal_name@));)~~~");
 
@@ -653,7 +653,7 @@ public:
     virtual u32 magic() const override { return @endpoint.magic@; }
     virtual ByteString name() const override { return "@endpoint.name@"; }
 
-    virtual ErrorOr<OwnPtr<IPC::MessageBuffer>> handle(const IPC::Message& message) override
+    virtual ErrorOr<OwnPtr<IPC::Message>> handle(const IPC::Message& message) override
     {
         switch (message.message_id()) {)~~~");
     for (auto const& message : endpoint.messages) {
@@ -681,15 +681,14 @@ public:
                     message_generator.appendln(R"~~~(
             [[maybe_unused]] auto& request = static_cast<const Messages::@endpoint.name@::@message.pascal_name@&>(message);
             @handler_name@(@arguments@);
-            auto response = Messages::@endpoint.name@::@message.response_type@ { };
-            return make<IPC::MessageBuffer>(TRY(response.encode()));)~~~");
+            return make<Messages::@endpoint.name@::@message.response_type@>();)~~~");
                 } else {
                     message_generator.appendln(R"~~~(
             [[maybe_unused]] auto& request = static_cast<const Messages::@endpoint.name@::@message.pascal_name@&>(message);
             auto response = @handler_name@(@arguments@);
             if (!response.valid())
                 return Error::from_string_literal("Failed to handle @endpoint.name@::@message.pascal_name@ message");
-            return make<IPC::MessageBuffer>(TRY(response.encode()));)~~~");
+            return make<Messages::@endpoint.name@::@message.response_type@>(move(response));)~~~");
                 }
             } else {
                 message_generator.appendln(R"~~~(
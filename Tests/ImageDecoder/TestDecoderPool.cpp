@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/ByteString.h>
+#include <ImageDecoder/DecoderPool.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/MappedFile.h>
+
+#ifdef AK_OS_SERENITY
+#    define TEST_INPUT(x) ("/usr/Tests/LibGfx/test-inputs/" x)
+#else
+#    define TEST_INPUT(x) ("../LibGfx/test-inputs/" x)
+#endif
+
+using ImageDecoder::DecoderPool;
+
+static Core::AnonymousBuffer encoded_data(ReadonlyBytes bytes)
+{
+    auto buffer = MUST(Core::AnonymousBuffer::create_with_size(bytes.size()));
+    memcpy(buffer.data<void>(), bytes.data(), bytes.size());
+    return buffer;
+}
+
+static Core::AnonymousBuffer test_input(StringView path, Optional<size_t> truncated_size = {})
+{
+    auto file = MUST(Core::MappedFile::map(path));
+    return encoded_data(file->bytes().trim(truncated_size.value_or(file->bytes().size())));
+}
+
+// Writes down what the callbacks of the jobs are told, in the order they're told it on the event loop.
+class Log {
+public:
+    NonnullRefPtr<DecoderPool::Job> create_job(ByteString name, Core::AnonymousBuffer data)
+    {
+        auto job = make_ref_counted<DecoderPool::Job>();
+        job->encoded_data = move(data);
+        job->on_start = [this, name](bool, u32, size_t frame_count) {
+            m_events.append(ByteString::formatted("{} started with {} frames", name, frame_count));
+        };
+        job->on_frame = [this, name](size_t index, NonnullRefPtr<Gfx::Bitmap>, u32) {
+            m_events.append(ByteString::formatted("{} frame {}", name, index));
+        };
+        job->on_finish = [this, name](bool success) {
+            m_events.append(ByteString::formatted("{} {}", name, success ? "finished"sv : "failed"sv));
+            ++m_finished_job_count;
+        };
+        return job;
+    }
+
+    // Jobs that have been canceled never finish, so they mustn't be counted here.
+    void run_until_finished(size_t job_count)
+    {
+        while (m_finished_job_count < job_count)
+            Core::EventLoop::current().pump();
+    }
+
+    Vector<ByteString> const& events() const { return m_events; }
+
+private:
+    Vector<ByteString> m_events;
+    size_t m_finished_job_count { 0 };
+};
+
+TEST_CASE(visible_images_go_first)
+{
+    Core::EventLoop event_loop;
+    DecoderPool pool(1);
+    Log log;
+
+    auto bitmap = test_input(TEST_INPUT("bmp/rgba32-1.bmp"sv));
+    auto first = log.create_job("first", bitmap);
+    auto second = log.create_job("second", bitmap);
+    auto third = log.create_job("third", bitmap);
+    pool.enqueue(first);
+    pool.enqueue(second);
+    pool.enqueue(third);
+
+    // Visibility counts when a job is taken from the queue, not when it's queued.
+    third->is_visible = true;
+
+    pool.start();
+    log.run_until_finished(3);
+
+    EXPECT_EQ(log.events(), (Vector<ByteString> {
+                                "third started with 1 frames",
+                                "third frame 0",
+                                "third finished",
+                                "first started with 1 frames",
+                                "first frame 0",
+                                "first finished",
+                                "second started with 1 frames",
+                                "second frame 0",
+                                "second finished",
+                            }));
+}
+
+TEST_CASE(canceled_jobs_are_not_decoded)
+{
+    Core::EventLoop event_loop;
+    DecoderPool pool(1);
+    Log log;
+
+    auto bitmap = test_input(TEST_INPUT("bmp/rgba32-1.bmp"sv));
+    auto canceled = log.create_job("canceled", bitmap);
+    auto other = log.create_job("other", bitmap);
+    pool.enqueue(canceled);
+    pool.enqueue(other);
+    pool.cancel(*canceled);
+
+    pool.start();
+    log.run_until_finished(1);
+
+    EXPECT_EQ(log.events(), (Vector<ByteString> { "other started with 1 frames", "other frame 0", "other finished" }));
+}
+
+TEST_CASE(canceled_jobs_stop_calling_back)
+{
+    Core::EventLoop event_loop;
+    DecoderPool pool(1);
+    Log log;
+
+    // The frames may well have been decoded by the time the job is canceled, but they mustn't be handed out anymore.
+    auto animation = log.create_job("animation", test_input(TEST_INPUT("download-animation.gif"sv)));
+    auto on_start = move(animation->on_start);
+    animation->on_start = [&, on_start = move(on_start)](bool is_animated, u32 loop_count, size_t frame_count) {
+        on_start(is_animated, loop_count, frame_count);
+        pool.cancel(*animation);
+    };
+    auto other = log.create_job("other", test_input(TEST_INPUT("bmp/rgba32-1.bmp"sv)));
+    pool.enqueue(animation);
+    pool.enqueue(other);
+
+    pool.start();
+    log.run_until_finished(1);
+
+    EXPECT_EQ(log.events().size(), 4u);
+    EXPECT(log.events()[0].starts_with("animation started with "sv));
+    EXPECT_EQ(log.events()[1], "other started with 1 frames"sv);
+}
+
+TEST_CASE(undecodable_images_fail)
+{
+    Core::EventLoop event_loop;
+    DecoderPool pool(1);
+    Log log;
+
+    pool.enqueue(log.create_job("garbage", encoded_data("This is not an image"sv.bytes())));
+    // The header is all there, but the pixels aren't.
+    pool.enqueue(log.create_job("truncated", test_input(TEST_INPUT("bmp/rgba32-1.bmp"sv), 1024)));
+    // None of this keeps the pool from decoding the next image.
+    pool.enqueue(log.create_job("valid", test_input(TEST_INPUT("bmp/rgba32-1.bmp"sv))));
+
+    pool.start();
+    log.run_until_finished(3);
+
+    EXPECT_EQ(log.events(), (Vector<ByteString> {
+                                "garbage failed",
+                                "truncated started with 1 frames",
+                                "truncated failed",
+                                "valid started with 1 frames",
+                                "valid frame 0",
+                                "valid finished",
+                            }));
+}
+
+TEST_CASE(destroying_the_pool_drops_queued_jobs)
+{
+    Core::EventLoop event_loop;
+    Log log;
+    {
+        DecoderPool pool(2);
+        pool.enqueue(log.create_job("queued", test_input(TEST_INPUT("bmp/rgba32-1.bmp"sv))));
+    }
+    {
+        DecoderPool pool(2);
+        pool.start();
+    }
+
+    event_loop.pump(Core::EventLoop::WaitMode::PollForEvents);
+    EXPECT(log.events().is_empty());
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibCore/EventLoop.h>
+#include <LibCore/Socket.h>
+#include <LibCore/System.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/ShareableBitmap.h>
+#include <LibImageDecoderClient/Client.h>
+#include <sys/socket.h>
+
+// Stands in for ImageDecoder, and tells the client whatever the test wants it to hear. Like the real one, it passes
+// file descriptors on a socket of their own.
+class FakeDecoder {
+public:
+    FakeDecoder()
+    {
+        int data_sockets[2];
+        int fd_passing_sockets[2];
+        MUST(Core::System::socketpair(AF_LOCAL, SOCK_STREAM, 0, data_sockets));
+        MUST(Core::System::socketpair(AF_LOCAL, SOCK_STREAM, 0, fd_passing_sockets));
+        m_socket = MUST(Core::LocalSocket::adopt_fd(data_sockets[0]));
+        m_fd_passing_socket = MUST(Core::LocalSocket::adopt_fd(fd_passing_sockets[0]));
+        m_client = adopt_ref(*new ImageDecoderClient::Client(MUST(Core::LocalSocket::adopt_fd(data_sockets[1]))));
+        m_client->set_fd_passing_socket(MUST(Core::LocalSocket::adopt_fd(fd_passing_sockets[1])));
+    }
+
+    ImageDecoderClient::Client& client() { return *m_client; }
+
+    void send(IPC::Message const& message)
+    {
+        auto buffer = MUST(message.encode(nullptr));
+        MUST(buffer.transfer_message(*m_fd_passing_socket, *m_socket));
+    }
+
+    void send_frame(i64 image_id, u32 index)
+    {
+        auto bitmap = MUST(Gfx::Bitmap::create_shareable(Gfx::BitmapFormat::BGRA8888, { 4, 4 }));
+        send(Messages::ImageDecoderClient::DidDecodeImageFrame(image_id, index, bitmap->to_shareable_bitmap(), 100));
+    }
+
+    void die() { m_socket->close(); }
+
+private:
+    OwnPtr<Core::LocalSocket> m_socket;
+    OwnPtr<Core::LocalSocket> m_fd_passing_socket;
+    RefPtr<ImageDecoderClient::Client> m_client;
+};
+
+static void run_until(Function<bool()> condition)
+{
+    while (!condition())
+        Core::EventLoop::current().pump();
+}
+
+static constexpr auto encoded_data = "We never look at this"sv;
+
+TEST_CASE(first_frame_arrives_before_the_others)
+{
+    Core::EventLoop event_loop;
+    FakeDecoder decoder;
+
+    Optional<ImageDecoderClient::DecodedImage> first_frame;
+    u32 first_frame_count = 0;
+    Optional<Optional<ImageDecoderClient::DecodedImage>> result;
+    auto image_id = MUST(decoder.client().start_decoding_image(
+        encoded_data.bytes(),
+        [&](auto image, u32 frame_count) {
+            first_frame = move(image);
+            first_frame_count = frame_count;
+        },
+        [&](auto image) { result = move(image); }));
+
+    decoder.send(Messages::ImageDecoderClient::DidStartDecodingImage(image_id, true, 0, 3));
+    decoder.send_frame(image_id, 0);
+    run_until([&] { return first_frame.has_value(); });
+
+    EXPECT_EQ(first_frame->frames.size(), 1u);
+    EXPECT_EQ(first_frame_count, 3u);
+    EXPECT(first_frame->is_animated);
+    EXPECT(!result.has_value());
+
+    decoder.send_frame(image_id, 1);
+    decoder.send_frame(image_id, 2);
+    run_until([&] { return result.has_value(); });
+
+    EXPECT(result->has_value());
+    EXPECT_EQ(result.value()->frames.size(), 3u);
+}
+
+TEST_CASE(single_frames_only_complete)
+{
+    Core::EventLoop event_loop;
+    FakeDecoder decoder;
+
+    bool got_first_frame = false;
+    Optional<Optional<ImageDecoderClient::DecodedImage>> result;
+    auto image_id = MUST(decoder.client().start_decoding_image(
+        encoded_data.bytes(),
+        [&](auto, u32) { got_first_frame = true; },
+        [&](auto image) { result = move(image); }));
+
+    decoder.send(Messages::ImageDecoderClient::DidStartDecodingImage(image_id, false, 0, 1));
+    decoder.send_frame(image_id, 0);
+    run_until([&] { return result.has_value(); });
+
+    EXPECT(!got_first_frame);
+    EXPECT(result->has_value());
+    EXPECT_EQ(result.value()->frames.size(), 1u);
+}
+
+TEST_CASE(images_fail_when_the_decoder_dies)
+{
+    Core::EventLoop event_loop;
+    FakeDecoder decoder;
+
+    bool got_first_frame = false;
+    Optional<Optional<ImageDecoderClient::DecodedImage>> result;
+    auto image_id = MUST(decoder.client().start_decoding_image(
+        encoded_data.bytes(),
+        [&](auto, u32) { got_first_frame = true; },
+        [&](auto image) { result = move(image); }));
+    bool decoder_died = false;
+    decoder.client().on_death = [&] { decoder_died = true; };
+
+    decoder.send(Messages::ImageDecoderClient::DidStartDecodingImage(image_id, true, 0, 3));
+    decoder.send_frame(image_id, 0);
+    run_until([&] { return got_first_frame; });
+
+    decoder.die();
+    run_until([&] { return decoder_died; });
+
+    EXPECT(result.has_value());
+    EXPECT(!result->has_value());
+}
@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <LibCore/System.h>
+#include <LibTest/TestCase.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+class TestRing {
+public:
+    explicit TestRing(u32 entries)
+        : m_size(io_ring_size(entries))
+    {
+        m_header = static_cast<IORing*>(MUST(Core::System::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0)));
+        m_header->entries = entries;
+    }
+
+    ~TestRing()
+    {
+        MUST(Core::System::munmap(m_header, m_size));
+    }
+
+    IORing& header() { return *m_header; }
+
+    bool submit(IORingSubmission const& submission)
+    {
+        auto tail = m_header->submission_tail;
+        if (tail - AK::atomic_load(&m_header->submission_head, AK::MemoryOrder::memory_order_acquire) >= m_header->entries)
+            return false;
+        submissions()[tail & mask()] = submission;
+        AK::atomic_store(&m_header->submission_tail, tail + 1, AK::MemoryOrder::memory_order_release);
+        return true;
+    }
+
+    bool reap(IORingCompletion& completion)
+    {
+        auto head = m_header->completion_head;
+        if (head == AK::atomic_load(&m_header->completion_tail, AK::MemoryOrder::memory_order_acquire))
+            return false;
+        completion = completions()[head & mask()];
+        AK::atomic_store(&m_header->completion_head, head + 1, AK::MemoryOrder::memory_order_release);
+        return true;
+    }
+
+    ErrorOr<u32> enter(u32 to_submit, u32 min_complete = 0)
+    {
+        return Core::System::io_ring_enter(*m_header, to_submit, min_complete);
+    }
+
+private:
+    u32 mask() const { return m_header->entries - 1; }
+    IORingSubmission* submissions() { return reinterpret_cast<IORingSubmission*>(reinterpret_cast<u8*>(m_header) + io_ring_submissions_offset()); }
+    IORingCompletion* completions() { return reinterpret_cast<IORingCompletion*>(reinterpret_cast<u8*>(m_header) + io_ring_completions_offset(m_header->entries)); }
+
+    IORing* m_header { nullptr };
+    size_t m_size { 0 };
+};
+
+static int create_file_with_pattern(size_t size)
+{
+    char pattern[] = "/tmp/io_ring.XXXXXX";
+    auto fd = MUST(Core::System::mkstemp(pattern));
+    MUST(Core::System::unlink({ pattern, sizeof(pattern) - 1 }));
+
+    Array<u8, 4096> block;
+    for (size_t offset = 0; offset < size; offset += block.size()) {
+        for (size_t i = 0; i < block.size(); ++i)
+            block[i] = static_cast<u8>((offset + i) * 31);
+        MUST(Core::System::write(fd, block.span().trim(size - offset)));
+    }
+    return fd;
+}
+
+TEST_CASE(invalid_rings)
+{
+    TestRing ring { 8 };
+
+    ring.header().entries = 3;
+    auto result = ring.enter(1);
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error().code(), EINVAL);
+
+    ring.header().entries = 8;
+    ring.header().submission_tail = 9;
+    result = ring.enter(1);
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error().code(), EINVAL);
+}
+
+TEST_CASE(nop_and_bad_descriptor)
+{
+    TestRing ring { 8 };
+
+    EXPECT(ring.submit({ .opcode = IORingOpcode::Nop, .user_data = 1 }));
+    EXPECT(ring.submit({ .opcode = IORingOpcode::Fsync, .fd = -1, .user_data = 2 }));
+    EXPECT_EQ(MUST(ring.enter(8)), 2u);
+
+    IORingCompletion completion;
+    EXPECT(ring.reap(completion));
+    EXPECT_EQ(completion.user_data, 1u);
+    EXPECT_EQ(completion.result, 0);
+
+    EXPECT(ring.reap(completion));
+    EXPECT_EQ(completion.user_data, 2u);
+    EXPECT_EQ(completion.result, -EBADF);
+
+    EXPECT(!ring.reap(completion));
+}
+
+TEST_CASE(completion_ring_backpressure)
+{
+    TestRing ring { 4 };
+
+    for (u64 i = 0; i < 4; ++i)
+        EXPECT(ring.submit({ .opcode = IORingOpcode::Nop, .user_data = i }));
+    EXPECT_EQ(MUST(ring.enter(4)), 4u);
+
+    // The completion ring is full, so nothing more may be consumed until userspace reaps.
+    EXPECT(ring.submit({ .opcode = IORingOpcode::Nop, .user_data = 4 }));
+    auto result = ring.enter(1);
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error().code(), EBUSY);
+
+    IORingCompletion completion;
+    EXPECT(ring.reap(completion));
+    EXPECT_EQ(MUST(ring.enter(1)), 1u);
+}
+
+TEST_CASE(socket_send_and_recv)
+{
+    int fds[2];
+    MUST(Core::System::socketpair(AF_LOCAL, SOCK_STREAM, 0, fds));
+
+    TestRing ring { 8 };
+    char const message[] = "hello ring";
+    char received[sizeof(message)] {};
+
+    EXPECT(ring.submit({ .opcode = IORingOpcode::Send, .fd = fds[0], .buffer = reinterpret_cast<FlatPtr>(message), .length = sizeof(message), .user_data = 1 }));
+    EXPECT(ring.submit({ .opcode = IORingOpcode::Recv, .fd = fds[1], .buffer = reinterpret_cast<FlatPtr>(received), .length = sizeof(received), .user_data = 2 }));
+    EXPECT_EQ(MUST(ring.enter(2, 2)), 2u);
+
+    // The receive may be run by a worker, in which case it completes after the send.
+    IORingCompletion first;
+    IORingCompletion second;
+    EXPECT(ring.reap(first));
+    EXPECT(ring.reap(second));
+    auto& send = first.user_data == 1 ? first : second;
+    auto& recv = first.user_data == 1 ? second : first;
+    EXPECT_EQ(send.user_data, 1u);
+    EXPECT_EQ(recv.user_data, 2u);
+    EXPECT_EQ(send.result, static_cast<i64>(sizeof(message)));
+    EXPECT_EQ(recv.result, static_cast<i64>(sizeof(message)));
+    EXPECT_EQ(StringView(received, sizeof(message) - 1), "hello ring"sv);
+
+    MUST(Core::System::close(fds[0]));
+    MUST(Core::System::close(fds[1]));
+}
+
+TEST_CASE(stress_positional_reads_and_writes)
+{
+    static constexpr size_t file_size = 1 * MiB;
+    static constexpr size_t block_size = 512;
+    static constexpr u32 entries = 64;
+
+    auto fd = create_file_with_pattern(file_size);
+    TestRing ring { entries };
+    Array<Array<u8, block_size>, entries> buffers;
+
+    // Read the whole file back in batches, in reverse block order.
+    size_t blocks = file_size / block_size;
+    size_t next_block = 0;
+    size_t completed = 0;
+    while (completed < blocks) {
+        u32 queued = 0;
+        while (next_block < blocks && queued < entries) {
+            auto block = blocks - next_block - 1;
+            IORingSubmission submission {
+                .opcode = IORingOpcode::Read,
+                .fd = fd,
+                .offset = static_cast<i64>(block * block_size),
+                .buffer = reinterpret_cast<FlatPtr>(buffers[queued].data()),
+                .length = block_size,
+                .user_data = (static_cast<u64>(queued) << 32) | block,
+            };
+            EXPECT(ring.submit(submission));
+            ++next_block;
+            ++queued;
+        }
+
+        EXPECT_EQ(MUST(ring.enter(queued, queued)), queued);
+
+        IORingCompletion completion;
+        while (ring.reap(completion)) {
+            EXPECT_EQ(completion.result, static_cast<i64>(block_size));
+            auto& buffer = buffers[completion.user_data >> 32];
+            auto block = completion.user_data & 0xffffffff;
+            for (size_t i = 0; i < block_size; ++i) {
+                if (buffer[i] != static_cast<u8>((block * block_size + i) * 31)) {
+                    FAIL("Read data mismatch");
+                    return;
+                }
+            }
+            ++completed;
+        }
+    }
+
+    // Overwrite every other block through the ring, then fsync once all of the writes have completed. Submissions
+    // that are run by workers may complete in any order, so the fsync has to go in a batch of its own.
+    Array<u8, block_size> zeroes {};
+    u32 queued = 0;
+    for (size_t block = 0; block < blocks && queued < entries; block += 2, ++queued)
+        EXPECT(ring.submit({ .opcode = IORingOpcode::Write, .fd = fd, .offset = static_cast<i64>(block * block_size), .buffer = reinterpret_cast<FlatPtr>(zeroes.data()), .length = block_size }));
+    EXPECT_EQ(MUST(ring.enter(queued, queued)), queued);
+    IORingCompletion completion;
+    while (ring.reap(completion))
+        EXPECT_EQ(completion.result, static_cast<i64>(block_size));
+
+    EXPECT(ring.submit({ .opcode = IORingOpcode::Fsync, .fd = fd }));
+    EXPECT_EQ(MUST(ring.enter(1, 1)), 1u);
+    EXPECT(ring.reap(completion));
+    EXPECT_EQ(completion.result, 0);
+
+    Array<u8, block_size> check;
+    EXPECT_EQ(pread(fd, check.data(), check.size(), 0), static_cast<ssize_t>(block_size));
+    EXPECT(check == zeroes);
+
+    MUST(Core::System::close(fd));
+}
+
+TEST_CASE(blocked_read_does_not_stall_the_ring)
+{
+    auto pipe_fds = MUST(Core::System::pipe2(0));
+    auto fd = create_file_with_pattern(4096);
+
+    TestRing ring { 8 };
+    Array<u8, 16> pipe_buffer;
+    Array<u8, 16> file_buffer;
+
+    // Nobody has written to the pipe yet, so the first read can only complete once we do.
+    EXPECT(ring.submit({ .opcode = IORingOpcode::Read, .fd = pipe_fds[0], .buffer = reinterpret_cast<FlatPtr>(pipe_buffer.data()), .length = pipe_buffer.size(), .user_data = 1 }));
+    EXPECT(ring.submit({ .opcode = IORingOpcode::Read, .fd = fd, .offset = 0, .buffer = reinterpret_cast<FlatPtr>(file_buffer.data()), .length = file_buffer.size(), .user_data = 2 }));
+    EXPECT_EQ(MUST(ring.enter(2, 1)), 2u);
+
+    IORingCompletion completion;
+    EXPECT(ring.reap(completion));
+    EXPECT_EQ(completion.user_data, 2u);
+    EXPECT_EQ(completion.result, static_cast<i64>(file_buffer.size()));
+    EXPECT(!ring.reap(completion));
+
+    EXPECT_EQ(MUST(Core::System::write(pipe_fds[1], "ping"sv.bytes())), 4u);
+    EXPECT_EQ(MUST(ring.enter(0, 1)), 0u);
+    EXPECT(ring.reap(completion));
+    EXPECT_EQ(completion.user_data, 1u);
+    EXPECT_EQ(completion.result, 4);
+    EXPECT_EQ(StringView { pipe_buffer.span().trim(4) }, "ping"sv);
+
+    MUST(Core::System::close(fd));
+    MUST(Core::System::close(pipe_fds[0]));
+    MUST(Core::System::close(pipe_fds[1]));
+}
+
+TEST_CASE(process_exits_with_submissions_in_flight)
+{
+    // The workers of a process that dies while they are blocked must be torn down along with it.
+    auto pid = MUST(Core::System::fork());
+    if (pid == 0) {
+        auto pipe_fds = MUST(Core::System::pipe2(0));
+        TestRing ring { 8 };
+        u8 byte = 0;
+        for (u64 i = 0; i < 4; ++i)
+            ring.submit({ .opcode = IORingOpcode::Read, .fd = pipe_fds[0], .buffer = reinterpret_cast<FlatPtr>(&byte), .length = 1, .user_data = i });
+        MUST(ring.enter(4));
+        _exit(0);
+    }
+    auto result = MUST(Core::System::waitpid(pid));
+    EXPECT(WIFEXITED(result.status));
+    EXPECT_EQ(WEXITSTATUS(result.status), 0);
+}
+
+static constexpr size_t benchmark_file_size = 8 * MiB;
+static constexpr size_t benchmark_block_size = 4096;
+
+BENCHMARK_CASE(blocking_reads)
+{
+    auto fd = create_file_with_pattern(benchmark_file_size);
+    Array<u8, benchmark_block_size> buffer;
+    for (size_t offset = 0; offset < benchmark_file_size; offset += benchmark_block_size)
+        EXPECT_EQ(pread(fd, buffer.data(), buffer.size(), offset), static_cast<ssize_t>(benchmark_block_size));
+    MUST(Core::System::close(fd));
+}
+
+BENCHMARK_CASE(io_ring_batched_reads)
+{
+    static constexpr u32 entries = 256;
+
+    auto fd = create_file_with_pattern(benchmark_file_size);
+    TestRing ring { entries };
+    Array<u8, benchmark_block_size> buffer;
+
+    size_t offset = 0;
+    while (offset < benchmark_file_size) {
+        u32 queued = 0;
+        for (; queued < entries && offset < benchmark_file_size; ++queued, offset += benchmark_block_size)
+            ring.submit({ .opcode = IORingOpcode::Read, .fd = fd, .offset = static_cast<i64>(offset), .buffer = reinterpret_cast<FlatPtr>(buffer.data()), .length = benchmark_block_size });
+        EXPECT_EQ(MUST(ring.enter(queued, queued)), queued);
+        IORingCompletion completion;
+        while (ring.reap(completion))
+            EXPECT_EQ(completion.result, static_cast<i64>(benchmark_block_size));
+    }
+
+    MUST(Core::System::close(fd));
+}
+
+// Each of these answers a request on its pipe after a short delay, like a slow peer or device would. Waiting for the
+// answers one at a time takes that delay for every pipe; with the ring, the waits overlap.
+static constexpr size_t responder_count = 16;
+static constexpr int responder_delay_ms = 5;
+static constexpr size_t responder_round_count = 10;
+
+struct Responder {
+    Array<int, 2> request_fds;
+    Array<int, 2> response_fds;
+    pthread_t thread;
+};
+
+static void* run_responder(void* argument)
+{
+    auto& responder = *static_cast<Responder*>(argument);
+    u8 byte = 0;
+    while (read(responder.request_fds[0], &byte, 1) == 1) {
+        usleep(responder_delay_ms * 1000);
+        if (write(responder.response_fds[1], &byte, 1) != 1)
+            break;
+    }
+    return nullptr;
+}
+
+static void start_responders(Array<Responder, responder_count>& responders)
+{
+    for (auto& responder : responders) {
+        responder.request_fds = MUST(Core::System::pipe2(0));
+        responder.response_fds = MUST(Core::System::pipe2(0));
+        EXPECT_EQ(pthread_create(&responder.thread, nullptr, run_responder, &responder), 0);
+    }
+}
+
+static void stop_responders(Array<Responder, responder_count>& responders)
+{
+    for (auto& responder : responders) {
+        MUST(Core::System::close(responder.request_fds[1]));
+        EXPECT_EQ(pthread_join(responder.thread, nullptr), 0);
+        MUST(Core::System::close(responder.request_fds[0]));
+        MUST(Core::System::close(responder.response_fds[0]));
+        MUST(Core::System::close(responder.response_fds[1]));
+    }
+}
+
+BENCHMARK_CASE(blocking_reads_from_slow_pipes)
+{
+    Array<Responder, responder_count> responders;
+    start_responders(responders);
+
+    u8 byte = 0;
+    for (size_t round = 0; round < responder_round_count; ++round) {
+        for (auto& responder : responders) {
+            MUST(Core::System::write(responder.request_fds[1], { &byte, 1 }));
+            EXPECT_EQ(MUST(Core::System::read(responder.response_fds[0], { &byte, 1 })), 1u);
+        }
+    }
+
+    stop_responders(responders);
+}
+
+BENCHMARK_CASE(io_ring_reads_from_slow_pipes)
+{
+    Array<Responder, responder_count> responders;
+    start_responders(responders);
+
+    TestRing ring { responder_count };
+    Array<u8, responder_count> bytes {};
+    for (size_t round = 0; round < responder_round_count; ++round) {
+        for (size_t i = 0; i < responder_count; ++i) {
+            MUST(Core::System::write(responders[i].request_fds[1], { &bytes[i], 1 }));
+            EXPECT(ring.submit({ .opcode = IORingOpcode::Read, .fd = responders[i].response_fds[0], .buffer = reinterpret_cast<FlatPtr>(&bytes[i]), .length = 1, .user_data = i }));
+        }
+        EXPECT_EQ(MUST(ring.enter(responder_count, responder_count)), responder_count);
+        IORingCompletion completion;
+        while (ring.reap(completion))
+            EXPECT_EQ(completion.result, 1);
+    }
+
+    stop_responders(responders);
+}
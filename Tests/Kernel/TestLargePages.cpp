@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/System.h>
+#include <LibTest/TestCase.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static constexpr size_t large_page_size = 2 * MiB;
+
+static u8 pattern_at(size_t offset)
+{
+    return static_cast<u8>((offset / PAGE_SIZE) * 7 + offset);
+}
+
+static u8* map_and_fill(size_t size)
+{
+    auto* data = static_cast<u8*>(MUST(Core::System::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0)));
+    for (size_t offset = 0; offset < size; ++offset)
+        data[offset] = pattern_at(offset);
+    return data;
+}
+
+static bool has_pattern(u8 const* data, size_t start, size_t end)
+{
+    for (size_t offset = start; offset < end; ++offset) {
+        if (data[offset] != pattern_at(offset))
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE(big_anonymous_mappings_are_large_page_aligned)
+{
+    auto* data = MUST(Core::System::mmap(nullptr, 4 * large_page_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0));
+    EXPECT_EQ(reinterpret_cast<FlatPtr>(data) % large_page_size, 0u);
+    MUST(Core::System::munmap(data, 4 * large_page_size));
+
+    // An explicit alignment is still honored.
+    data = MUST(Core::System::mmap(nullptr, 4 * large_page_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0, PAGE_SIZE));
+    MUST(Core::System::munmap(data, 4 * large_page_size));
+}
+
+TEST_CASE(partial_munmap_inside_large_page)
+{
+    static constexpr size_t size = 2 * large_page_size;
+    auto* data = map_and_fill(size);
+
+    // Punch a hole into the middle of the first large page; everything around it has to stay intact.
+    MUST(Core::System::munmap(data + large_page_size / 2, PAGE_SIZE));
+    EXPECT(has_pattern(data, 0, large_page_size / 2));
+    EXPECT(has_pattern(data, large_page_size / 2 + PAGE_SIZE, size));
+
+    // The remaining memory must still be writable.
+    data[0] = 0xaa;
+    data[size - 1] = 0xbb;
+    EXPECT_EQ(data[0], 0xaa);
+    EXPECT_EQ(data[size - 1], 0xbb);
+
+    MUST(Core::System::munmap(data, large_page_size / 2));
+    MUST(Core::System::munmap(data + large_page_size / 2 + PAGE_SIZE, size - large_page_size / 2 - PAGE_SIZE));
+}
+
+TEST_CASE(partial_mprotect_inside_large_page)
+{
+    static constexpr size_t size = 2 * large_page_size;
+    auto* data = map_and_fill(size);
+
+    EXPECT_EQ(mprotect(data + PAGE_SIZE, PAGE_SIZE, PROT_READ), 0);
+    EXPECT(has_pattern(data, 0, size));
+
+    // The pages around the read-only one must still be writable.
+    data[0] = 0xaa;
+    data[2 * PAGE_SIZE] = 0xbb;
+    EXPECT_EQ(data[0], 0xaa);
+    EXPECT_EQ(data[2 * PAGE_SIZE], 0xbb);
+
+    EXPECT_EQ(mprotect(data + PAGE_SIZE, PAGE_SIZE, PROT_READ | PROT_WRITE), 0);
+    data[PAGE_SIZE] = 0xcc;
+    EXPECT_EQ(data[PAGE_SIZE], 0xcc);
+
+    MUST(Core::System::munmap(data, size));
+}
+
+TEST_CASE(copy_on_write_inside_large_page)
+{
+    static constexpr size_t size = 2 * large_page_size;
+    auto* data = map_and_fill(size);
+
+    auto pid = MUST(Core::System::fork());
+    if (pid == 0) {
+        // The child scribbles over a single page, which must not be visible to the parent.
+        memset(data + PAGE_SIZE, 0, PAGE_SIZE);
+        _exit(has_pattern(data, 0, PAGE_SIZE) && has_pattern(data, 2 * PAGE_SIZE, size) ? 0 : 1);
+    }
+
+    auto result = MUST(Core::System::waitpid(pid));
+    EXPECT(WIFEXITED(result.status));
+    EXPECT_EQ(WEXITSTATUS(result.status), 0);
+    EXPECT(has_pattern(data, 0, size));
+
+    MUST(Core::System::munmap(data, size));
+}
+
+BENCHMARK_CASE(walk_1gib_buffer)
+{
+    static constexpr size_t size = 1 * GiB;
+    static constexpr size_t passes = 8;
+
+    auto data_or_error = Core::System::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (data_or_error.is_error()) {
+        warnln("Skipping benchmark, unable to map 1 GiB: {}", data_or_error.error());
+        return;
+    }
+    auto* data = static_cast<u8*>(data_or_error.release_value());
+
+    for (size_t offset = 0; offset < size; offset += PAGE_SIZE)
+        data[offset] = static_cast<u8>(offset / PAGE_SIZE);
+
+    // Touch one byte per page, so the walk is dominated by address translation rather than by memory bandwidth.
+    u64 sum = 0;
+    for (size_t pass = 0; pass < passes; ++pass) {
+        for (size_t offset = 0; offset < size; offset += PAGE_SIZE)
+            sum += data[offset];
+    }
+    EXPECT_NE(sum, 0u);
+
+    MUST(Core::System::munmap(data, size));
+}
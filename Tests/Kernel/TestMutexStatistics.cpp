@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <LibCore/File.h>
+#include <LibCore/System.h>
+#include <LibTest/TestCase.h>
+#include <pthread.h>
+#include <unistd.h>
+
+static JsonObject read_statistics()
+{
+    auto file = MUST(Core::File::open("/sys/kernel/mutexstat"sv, Core::File::OpenMode::Read));
+    auto file_contents = MUST(file->read_until_eof());
+    auto json = MUST(JsonValue::from_string(file_contents));
+    EXPECT(json.is_object());
+    return json.as_object();
+}
+
+// Statistics are only kept when booting with "mutex_stat".
+static bool statistics_are_enabled()
+{
+    if (read_statistics().get_bool("enabled"sv).value_or(false))
+        return true;
+    warnln("Mutex statistics are disabled, boot with mutex_stat to run this test");
+    return false;
+}
+
+static Optional<JsonObject> statistics_for(StringView name)
+{
+    Optional<JsonObject> result;
+    read_statistics().get_array("mutexes"sv)->for_each([&](auto& value) {
+        if (value.as_object().get_byte_string("name"sv).value_or({}) == name)
+            result = value.as_object();
+    });
+    return result;
+}
+
+static int create_temporary_file()
+{
+    char pattern[] = "/tmp/mutexstat.XXXXXX";
+    auto fd = MUST(Core::System::mkstemp(pattern));
+    MUST(Core::System::unlink({ pattern, sizeof(pattern) - 1 }));
+    return fd;
+}
+
+TEST_CASE(statistics_say_whether_holders_are_known)
+{
+    auto statistics = read_statistics();
+    EXPECT(statistics.get_bool("top_holders_available"sv).has_value());
+    auto holders_are_known = statistics.get_bool("top_holders_available"sv).value();
+    statistics.get_array("mutexes"sv)->for_each([&](auto& value) {
+        EXPECT_EQ(value.as_object().has_array("top_holders"sv), holders_are_known);
+    });
+}
+
+TEST_CASE(inode_lock_acquisitions_are_counted)
+{
+    if (!statistics_are_enabled())
+        return;
+
+    auto fd = create_temporary_file();
+    // Make sure the entry exists before taking the first snapshot.
+    MUST(Core::System::write(fd, "x"sv.bytes()));
+
+    auto before = statistics_for("Inode"sv);
+    EXPECT(before.has_value());
+
+    for (int i = 0; i < 100; ++i)
+        MUST(Core::System::write(fd, "x"sv.bytes()));
+
+    auto after = statistics_for("Inode"sv);
+    EXPECT(after.has_value());
+    EXPECT(after->get_u64("acquisitions"sv).value() >= before->get_u64("acquisitions"sv).value() + 100);
+
+    MUST(Core::System::close(fd));
+}
+
+static void* hammer_file(void* fd)
+{
+    u8 buffer[64] {};
+    for (int i = 0; i < 2000; ++i)
+        (void)pwrite(static_cast<int>(reinterpret_cast<FlatPtr>(fd)), buffer, sizeof(buffer), 0);
+    return nullptr;
+}
+
+TEST_CASE(contention_statistics_are_consistent)
+{
+    if (!statistics_are_enabled())
+        return;
+
+    static constexpr size_t thread_count = 4;
+
+    auto fd = create_temporary_file();
+    Array<pthread_t, thread_count> threads;
+    for (auto& thread : threads)
+        EXPECT_EQ(pthread_create(&thread, nullptr, hammer_file, reinterpret_cast<void*>(static_cast<FlatPtr>(fd))), 0);
+    for (auto& thread : threads)
+        EXPECT_EQ(pthread_join(thread, nullptr), 0);
+
+    // Whether the threads actually ran into each other depends on the machine, so only check that the numbers add up.
+    auto statistics = statistics_for("Inode"sv);
+    EXPECT(statistics.has_value());
+    auto acquisitions = statistics->get_u64("acquisitions"sv).value();
+    auto contended_acquisitions = statistics->get_u64("contended_acquisitions"sv).value();
+    auto spin_acquisitions = statistics->get_u64("spin_acquisitions"sv).value();
+    EXPECT(contended_acquisitions <= acquisitions);
+    EXPECT(spin_acquisitions <= contended_acquisitions);
+    EXPECT(statistics->get_u64("max_wait_time_ns"sv).value() <= statistics->get_u64("total_wait_time_ns"sv).value());
+
+    MUST(Core::System::close(fd));
+}
@@ -7,6 +7,7 @@
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Cipher/AES.h>
+#include <AK/Time.h>
 #include <LibTest/TestCase.h>
 #include <cstring>
 
@@ -454,3 +455,59 @@ TEST_CASE(test_AES_GCM_128bit_decrypt_multiple_blocks_with_aad)
     EXPECT(memcmp(result_pt, out.data(), out.size()) == 0);
     EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
 }
+
+// These report throughput for each mode, run them with LIBCRYPTO_NO_ACCELERATION=1 to compare against the portable code.
+static constexpr size_t benchmark_buffer_size = 4 * MiB;
+static constexpr size_t benchmark_iterations = 8;
+
+static void report_throughput(StringView mode, MonotonicTime start)
+{
+    auto elapsed_ms = max<i64>((MonotonicTime::now() - start).to_milliseconds(), 1);
+    auto bytes = static_cast<i64>(benchmark_buffer_size * benchmark_iterations);
+    outln("AES-128-{}: {} MiB/s", mode, (bytes * 1000 / elapsed_ms) / static_cast<i64>(MiB));
+}
+
+BENCHMARK_CASE(benchmark_AES_CBC_128bit_encrypt)
+{
+    Crypto::Cipher::AESCipher::CBCMode cipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Encryption);
+    auto in = ByteBuffer::create_zeroed(benchmark_buffer_size).release_value();
+    // CBC pads the message with a full block.
+    auto out = ByteBuffer::create_uninitialized(benchmark_buffer_size + Crypto::Cipher::AESCipher::block_size()).release_value();
+    auto iv = ByteBuffer::create_zeroed(Crypto::Cipher::AESCipher::block_size()).release_value();
+
+    auto start = MonotonicTime::now();
+    for (size_t i = 0; i < benchmark_iterations; ++i) {
+        auto out_span = out.bytes();
+        cipher.encrypt(in, out_span, iv);
+    }
+    report_throughput("CBC"sv, start);
+}
+
+BENCHMARK_CASE(benchmark_AES_CTR_128bit_encrypt)
+{
+    Crypto::Cipher::AESCipher::CTRMode cipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Encryption);
+    auto in = ByteBuffer::create_zeroed(benchmark_buffer_size).release_value();
+    auto out = ByteBuffer::create_uninitialized(benchmark_buffer_size).release_value();
+    auto iv = ByteBuffer::create_zeroed(Crypto::Cipher::AESCipher::block_size()).release_value();
+
+    auto start = MonotonicTime::now();
+    for (size_t i = 0; i < benchmark_iterations; ++i) {
+        auto out_span = out.bytes();
+        cipher.encrypt(in, out_span, iv);
+    }
+    report_throughput("CTR"sv, start);
+}
+
+BENCHMARK_CASE(benchmark_AES_GCM_128bit_encrypt)
+{
+    Crypto::Cipher::AESCipher::GCMMode cipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Encryption);
+    auto in = ByteBuffer::create_zeroed(benchmark_buffer_size).release_value();
+    auto out = ByteBuffer::create_uninitialized(benchmark_buffer_size).release_value();
+    auto iv = ByteBuffer::create_zeroed(Crypto::Cipher::AESCipher::block_size()).release_value();
+    auto tag = ByteBuffer::create_uninitialized(16).release_value();
+
+    auto start = MonotonicTime::now();
+    for (size_t i = 0; i < benchmark_iterations; ++i)
+        cipher.encrypt(in, out.bytes(), iv, {}, tag);
+    report_throughput("GCM"sv, start);
+}
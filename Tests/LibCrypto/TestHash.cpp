@@ -10,6 +10,7 @@
 #include <LibCrypto/Hash/MD5.h>
 #include <LibCrypto/Hash/SHA1.h>
 #include <LibCrypto/Hash/SHA2.h>
+#include <AK/Time.h>
 #include <LibTest/TestCase.h>
 #include <cstring>
 
@@ -208,6 +209,19 @@ TEST_CASE(test_SHA1_hash_split_into_blocks)
     EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
 }
 
+TEST_CASE(test_SHA1_hash_many_blocks)
+{
+    u8 result[] {
+        0xc5, 0x77, 0xf7, 0xa3, 0x76, 0x57, 0x05, 0x32, 0x75, 0xf3, 0xe3, 0xec, 0xc0, 0x6e, 0xc2, 0x2e, 0x6b, 0x90, 0x93, 0x66
+    };
+    auto hasher = Crypto::Hash::SHA1 {};
+    auto data = MUST(ByteBuffer::create_zeroed(1000));
+    hasher.update(data.bytes().trim(10));
+    hasher.update(data.bytes().slice(10));
+    auto digest = hasher.digest();
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
+}
+
 TEST_CASE(test_SHA256_name)
 {
     Crypto::Hash::SHA256 sha;
@@ -241,6 +255,75 @@ TEST_CASE(test_SHA256_hash_split_into_blocks)
     EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
 }
 
+TEST_CASE(test_SHA256_hash_many_blocks)
+{
+    // Long enough to go through the multi-block path, and not a multiple of the block size.
+    u8 result[] {
+        0x54, 0x1b, 0x3e, 0x9d, 0xaa, 0x09, 0xb2, 0x0b, 0xf8, 0x5f, 0xa2, 0x73, 0xe5, 0xcb, 0xd3, 0xe8, 0x01, 0x85, 0xaa, 0x4e, 0xc2, 0x98, 0xe7, 0x65, 0xdb, 0x87, 0x74, 0x2b, 0x70, 0x13, 0x8a, 0x53
+    };
+    auto digest = Crypto::Hash::SHA256::hash(MUST(ByteBuffer::create_zeroed(1000)));
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+}
+
+TEST_CASE(test_SHA256_hash_many)
+{
+    // Cover every way the padding can fall, and lanes that finish at different times.
+    auto data = MUST(ByteBuffer::create_uninitialized(300));
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = i * 7;
+
+    Vector<ReadonlyBytes> messages;
+    for (size_t length = 0; length <= data.size(); ++length)
+        messages.append(data.bytes().trim(length));
+
+    Vector<Crypto::Hash::SHA256::DigestType> digests;
+    digests.resize(messages.size());
+    Crypto::Hash::SHA256::hash_many(messages, digests);
+
+    for (size_t i = 0; i < messages.size(); ++i) {
+        auto expected = Crypto::Hash::SHA256::hash(messages[i].data(), messages[i].size());
+        EXPECT(memcmp(expected.data, digests[i].data, Crypto::Hash::SHA256::digest_size()) == 0);
+    }
+}
+
+// These report throughput, run them with LIBCRYPTO_NO_ACCELERATION=1 to compare against the portable code.
+static void report_throughput(StringView name, size_t bytes, MonotonicTime start)
+{
+    auto elapsed_ms = max<i64>((MonotonicTime::now() - start).to_milliseconds(), 1);
+    outln("{}: {} MiB/s", name, (static_cast<i64>(bytes) * 1000 / elapsed_ms) / static_cast<i64>(MiB));
+}
+
+BENCHMARK_CASE(benchmark_SHA1_hash)
+{
+    auto data = MUST(ByteBuffer::create_zeroed(16 * MiB));
+    auto start = MonotonicTime::now();
+    (void)Crypto::Hash::SHA1::hash(data);
+    report_throughput("SHA1"sv, data.size(), start);
+}
+
+BENCHMARK_CASE(benchmark_SHA256_hash)
+{
+    auto data = MUST(ByteBuffer::create_zeroed(16 * MiB));
+    auto start = MonotonicTime::now();
+    (void)Crypto::Hash::SHA256::hash(data);
+    report_throughput("SHA256"sv, data.size(), start);
+}
+
+BENCHMARK_CASE(benchmark_SHA256_hash_many)
+{
+    constexpr size_t message_size = 64;
+    auto data = MUST(ByteBuffer::create_zeroed(16 * MiB));
+    Vector<ReadonlyBytes> messages;
+    for (size_t offset = 0; offset < data.size(); offset += message_size)
+        messages.append(data.bytes().slice(offset, message_size));
+    Vector<Crypto::Hash::SHA256::DigestType> digests;
+    digests.resize(messages.size());
+
+    auto start = MonotonicTime::now();
+    Crypto::Hash::SHA256::hash_many(messages, digests);
+    report_throughput("SHA256 (many 64-byte messages)"sv, data.size(), start);
+}
+
 TEST_CASE(test_SHA384_name)
 {
     Crypto::Hash::SHA384 sha;
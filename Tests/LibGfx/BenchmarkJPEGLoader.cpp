@@ -17,10 +17,17 @@
 // FIXME: Enable formatting when the patch will be mainstream
 //        https://github.com/llvm/llvm-project/commit/fd86789962964a98157e8159c3d95cdc241942e3
 // clang-format off
+// Baseline images
 auto small_image = Core::File::open(TEST_INPUT("jpg/rgb24.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
-auto big_image = Core::File::open(TEST_INPUT("jpg/big_image.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
 auto rgb_image = Core::File::open(TEST_INPUT("jpg/rgb_components.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
 auto several_scans = Core::File::open(TEST_INPUT("jpg/several_scans.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
+auto grayscale_image = Core::File::open(TEST_INPUT("jpg/grayscale_mcu.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
+auto ycck_image = Core::File::open(TEST_INPUT("jpg/ycck-2111.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
+
+// Progressive images
+auto spectral_selection = Core::File::open(TEST_INPUT("jpg/spectral_selection.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
+auto successive_approximation = Core::File::open(TEST_INPUT("jpg/successive_approximation.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
+auto twelve_bits_progressive = Core::File::open(TEST_INPUT("jpg/12-bit-progressive.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
 // clang-format on
 
 BENCHMARK_CASE(small_image)
@@ -29,12 +36,6 @@ BENCHMARK_CASE(small_image)
     MUST(plugin_decoder->frame(0));
 }
 
-BENCHMARK_CASE(big_image)
-{
-    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(big_image));
-    MUST(plugin_decoder->frame(0));
-}
-
 BENCHMARK_CASE(rgb_image)
 {
     auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(rgb_image));
@@ -46,3 +47,33 @@ BENCHMARK_CASE(several_scans)
     auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(several_scans));
     MUST(plugin_decoder->frame(0));
 }
+
+BENCHMARK_CASE(grayscale_image)
+{
+    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(grayscale_image));
+    MUST(plugin_decoder->frame(0));
+}
+
+BENCHMARK_CASE(ycck_image)
+{
+    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(ycck_image));
+    MUST(plugin_decoder->cmyk_frame());
+}
+
+BENCHMARK_CASE(spectral_selection)
+{
+    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(spectral_selection));
+    MUST(plugin_decoder->frame(0));
+}
+
+BENCHMARK_CASE(successive_approximation)
+{
+    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(successive_approximation));
+    MUST(plugin_decoder->frame(0));
+}
+
+BENCHMARK_CASE(twelve_bits_progressive)
+{
+    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(twelve_bits_progressive));
+    MUST(plugin_decoder->frame(0));
+}
@@ -372,6 +372,23 @@ TEST_CASE(test_jpeg_sof2_spectral_selection)
     TRY_OR_FAIL(expect_single_frame_of_size(*plugin_decoder, { 592, 800 }));
 }
 
+TEST_CASE(test_jpeg_sof0_and_sof2_decode_identically)
+{
+    // These are the same image, once as a baseline JPEG and once as a progressive one.
+    auto baseline_file = TRY_OR_FAIL(Core::MappedFile::map(TEST_INPUT("jpg/several_scans.jpg"sv)));
+    auto baseline_decoder = TRY_OR_FAIL(Gfx::JPEGImageDecoderPlugin::create(baseline_file->bytes()));
+    auto baseline_frame = TRY_OR_FAIL(expect_single_frame_of_size(*baseline_decoder, { 592, 800 }));
+
+    auto progressive_file = TRY_OR_FAIL(Core::MappedFile::map(TEST_INPUT("jpg/spectral_selection.jpg"sv)));
+    auto progressive_decoder = TRY_OR_FAIL(Gfx::JPEGImageDecoderPlugin::create(progressive_file->bytes()));
+    auto progressive_frame = TRY_OR_FAIL(expect_single_frame_of_size(*progressive_decoder, { 592, 800 }));
+
+    for (int y = 0; y < 800; ++y) {
+        for (int x = 0; x < 592; ++x)
+            EXPECT_EQ(baseline_frame.image->get_pixel(x, y), progressive_frame.image->get_pixel(x, y));
+    }
+}
+
 TEST_CASE(test_jpeg_sof0_several_scans_odd_number_mcu)
 {
     auto file = TRY_OR_FAIL(Core::MappedFile::map(TEST_INPUT("jpg/several_scans_odd_number_mcu.jpg"sv)));
@@ -435,6 +452,59 @@ TEST_CASE(test_jpeg_grayscale_with_weird_mcu_and_reset_marker)
     TRY_OR_FAIL(expect_single_frame_of_size(*plugin_decoder, { 320, 240 }));
 }
 
+TEST_CASE(test_jpeg_grayscale_is_gray)
+{
+    auto file = TRY_OR_FAIL(Core::MappedFile::map(TEST_INPUT("jpg/grayscale_mcu.jpg"sv)));
+    auto plugin_decoder = TRY_OR_FAIL(Gfx::JPEGImageDecoderPlugin::create(file->bytes()));
+    auto frame = TRY_OR_FAIL(expect_single_frame_of_size(*plugin_decoder, { 320, 240 }));
+
+    for (int y = 0; y < 240; ++y) {
+        for (int x = 0; x < 320; ++x) {
+            auto pixel = frame.image->get_pixel(x, y);
+            EXPECT_EQ(pixel.red(), pixel.green());
+            EXPECT_EQ(pixel.red(), pixel.blue());
+        }
+    }
+}
+
+TEST_CASE(test_jpeg_restart_intervals_decode_identically_in_parallel)
+{
+    Array test_inputs = {
+        TEST_INPUT("jpg/odd-restart.jpg"sv),
+        TEST_INPUT("jpg/grayscale_mcu.jpg"sv)
+    };
+
+    for (auto test_input : test_inputs) {
+        auto file = TRY_OR_FAIL(Core::MappedFile::map(test_input));
+
+        auto plugin_decoder = TRY_OR_FAIL(Gfx::JPEGImageDecoderPlugin::create(file->bytes()));
+        auto frame = TRY_OR_FAIL(expect_single_frame(*plugin_decoder));
+
+        auto parallel_plugin_decoder = TRY_OR_FAIL(Gfx::JPEGImageDecoderPlugin::create_with_options(file->bytes(), { .maximum_thread_count = 4 }));
+        auto parallel_frame = TRY_OR_FAIL(expect_single_frame(*parallel_plugin_decoder));
+
+        EXPECT_EQ(frame.image->size(), parallel_frame.image->size());
+        for (int y = 0; y < frame.image->height(); ++y) {
+            for (int x = 0; x < frame.image->width(); ++x)
+                EXPECT_EQ(frame.image->get_pixel(x, y), parallel_frame.image->get_pixel(x, y));
+        }
+    }
+}
+
+TEST_CASE(test_jpeg_scaled_decoding)
+{
+    auto file = TRY_OR_FAIL(Core::MappedFile::map(TEST_INPUT("jpg/several_scans.jpg"sv)));
+    auto plugin_decoder = TRY_OR_FAIL(Gfx::JPEGImageDecoderPlugin::create(file->bytes()));
+    EXPECT_EQ(plugin_decoder->size(), Gfx::IntSize(592, 800));
+
+    // The image is decoded at the smallest of 1/8, 1/4 and 1/2 of its size that is still at least as large as asked for.
+    EXPECT_EQ(TRY_OR_FAIL(plugin_decoder->frame(0, Gfx::IntSize { 32, 32 })).image->size(), Gfx::IntSize(74, 100));
+    EXPECT_EQ(TRY_OR_FAIL(plugin_decoder->frame(0, Gfx::IntSize { 100, 100 })).image->size(), Gfx::IntSize(148, 200));
+    EXPECT_EQ(TRY_OR_FAIL(plugin_decoder->frame(0, Gfx::IntSize { 296, 400 })).image->size(), Gfx::IntSize(296, 400));
+    EXPECT_EQ(TRY_OR_FAIL(plugin_decoder->frame(0, Gfx::IntSize { 297, 400 })).image->size(), Gfx::IntSize(592, 800));
+    EXPECT_EQ(TRY_OR_FAIL(plugin_decoder->frame(0)).image->size(), Gfx::IntSize(592, 800));
+}
+
 TEST_CASE(test_jpeg_malformed_header)
 {
     Array test_inputs = {
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h> // import first, to prevent warning of VERIFY* redefinition
+
+#include <AK/MemoryStream.h>
+#include <AK/Queue.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/Socket.h>
+#include <LibCore/TCPServer.h>
+#include <LibCore/Timer.h>
+#include <LibHTTP/HPack.h>
+#include <LibHTTP/Http2Connection.h>
+#include <LibHTTP/Job.h>
+
+// A page with many small subresources, served with some latency. Over HTTP/1.1 only as many requests as there are
+// connections can be in flight at once, while HTTP/2 sends all of them on one connection right away.
+static constexpr size_t resource_count = 200;
+static constexpr size_t resource_size = 2 * KiB;
+static constexpr int response_delay_milliseconds = 10;
+static constexpr size_t http1_connection_count = 4;
+
+// Speaks HTTP/1.1, or HTTP/2 with prior knowledge if the client starts with the connection preface.
+class TestServerConnection {
+public:
+    explicit TestServerConnection(NonnullOwnPtr<Core::TCPSocket> socket)
+        : m_socket(move(socket))
+    {
+        MUST(m_socket->set_blocking(false));
+        m_socket->on_ready_to_read = [this] { read_from_socket(); };
+    }
+
+private:
+    static constexpr auto preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"sv;
+
+    void read_from_socket()
+    {
+        while (true) {
+            u8 buffer[16 * KiB];
+            auto result = m_socket->read_some({ buffer, sizeof(buffer) });
+            if (result.is_error() || result.value().is_empty())
+                break;
+            m_input.append(result.value());
+        }
+        if (m_socket->is_eof()) {
+            m_socket->on_ready_to_read = nullptr;
+            return;
+        }
+
+        if (!m_is_http2 && m_input.bytes().starts_with(preface.bytes())) {
+            m_is_http2 = true;
+            consume(preface.length());
+            // The client has to stay below the limit of 100 that RFC 9113 recommends.
+            u8 settings[] = { 0, 3, 0, 0, 0, 100 };
+            send_frame(0x4, 0, 0, { settings, sizeof(settings) });
+        }
+
+        if (m_is_http2)
+            process_http2_frames();
+        else
+            process_http1_requests();
+    }
+
+    void process_http1_requests()
+    {
+        while (true) {
+            auto request = StringView { m_input.bytes() };
+            auto end = request.find("\r\n\r\n"sv);
+            if (!end.has_value())
+                return;
+            consume(*end + 4);
+            respond_later([this] {
+                // A single write, so that Nagle's algorithm doesn't hold back the body.
+                auto response = MUST(ByteBuffer::copy(ByteString::formatted("HTTP/1.1 200 OK\r\nContent-Length: {}\r\n\r\n", resource_size).bytes()));
+                response.append(body());
+                MUST(m_socket->write_until_depleted(response));
+            });
+        }
+    }
+
+    void process_http2_frames()
+    {
+        while (m_input.size() >= 9) {
+            auto data = m_input.bytes();
+            size_t length = (data[0] << 16) | (data[1] << 8) | data[2];
+            if (data.size() < 9 + length)
+                return;
+            u8 type = data[3];
+            u8 flags = data[4];
+            u32 stream_id = ((data[5] & 0x7f) << 24) | (data[6] << 16) | (data[7] << 8) | data[8];
+            auto payload = MUST(ByteBuffer::copy(data.slice(9, length)));
+            consume(9 + length);
+
+            if (type == 0x4 && !(flags & 0x1)) {
+                send_frame(0x4, 0x1, 0, {});
+            } else if (type == 0x1) {
+                // The client's header blocks are small enough to fit into a single frame.
+                VERIFY(flags & 0x4);
+                auto headers = MUST(m_decoder.decode(payload));
+                VERIFY(headers.first_matching([](auto& header) { return header.name == ":path"sv; }).has_value());
+                respond_later([this, stream_id] {
+                    Vector<HTTP::HPack::Header> headers {
+                        { ":status", "200" },
+                        { "content-length", ByteString::number(resource_size) },
+                    };
+                    ByteBuffer response;
+                    append_frame(response, 0x1, 0x4, stream_id, MUST(m_encoder.encode(headers)));
+                    append_frame(response, 0x0, 0x1, stream_id, body());
+                    MUST(m_socket->write_until_depleted(response));
+                });
+            }
+        }
+    }
+
+    static void append_frame(ByteBuffer& buffer, u8 type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+    {
+        u8 header[9] = {
+            static_cast<u8>(payload.size() >> 16), static_cast<u8>(payload.size() >> 8), static_cast<u8>(payload.size()),
+            type, flags,
+            static_cast<u8>(stream_id >> 24), static_cast<u8>(stream_id >> 16), static_cast<u8>(stream_id >> 8), static_cast<u8>(stream_id)
+        };
+        buffer.append(header, sizeof(header));
+        buffer.append(payload);
+    }
+
+    void send_frame(u8 type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+    {
+        ByteBuffer frame;
+        append_frame(frame, type, flags, stream_id, payload);
+        MUST(m_socket->write_until_depleted(frame));
+    }
+
+    void respond_later(Function<void()> respond)
+    {
+        auto timer = MUST(Core::Timer::create_single_shot(response_delay_milliseconds, move(respond)));
+        timer->start();
+        m_pending_responses.append(move(timer));
+    }
+
+    void consume(size_t size)
+    {
+        m_input = MUST(m_input.slice(size, m_input.size() - size));
+    }
+
+    static ReadonlyBytes body()
+    {
+        static auto body = MUST(ByteBuffer::create_zeroed(resource_size));
+        return body;
+    }
+
+    NonnullOwnPtr<Core::TCPSocket> m_socket;
+    ByteBuffer m_input;
+    bool m_is_http2 { false };
+    HTTP::HPack::Decoder m_decoder;
+    HTTP::HPack::Encoder m_encoder;
+    Vector<NonnullRefPtr<Core::Timer>> m_pending_responses;
+};
+
+class TestServer {
+public:
+    TestServer()
+        : m_server(MUST(Core::TCPServer::try_create()))
+    {
+        MUST(m_server->listen({ 127, 0, 0, 1 }, 0));
+        m_server->on_ready_to_accept = [this] {
+            m_connections.append(make<TestServerConnection>(MUST(m_server->accept())));
+        };
+    }
+
+    u16 port() const { return m_server->local_port().value(); }
+    size_t connection_count() const { return m_connections.size(); }
+
+private:
+    NonnullRefPtr<Core::TCPServer> m_server;
+    Vector<NonnullOwnPtr<TestServerConnection>> m_connections;
+};
+
+static HTTP::HttpRequest request_for(u16 port, size_t index)
+{
+    HTTP::HttpRequest request;
+    request.set_url(URL(ByteString::formatted("http://127.0.0.1:{}/resource/{}", port, index)));
+    return request;
+}
+
+// Runs its requests one after another, like RequestServer does with the connections to a server.
+class Http1Connection {
+public:
+    Http1Connection(u16 port, Function<void()> on_request_finished)
+        : m_port(port)
+        , m_socket(MUST(Core::BufferedSocket<Core::TCPSocket>::create(MUST(Core::TCPSocket::connect("127.0.0.1", port)))))
+        , m_on_request_finished(move(on_request_finished))
+    {
+    }
+
+    void enqueue(size_t index) { m_requests.enqueue(index); }
+    size_t received_size() const { return m_output.used_buffer_size(); }
+
+    void start_next_request()
+    {
+        if (m_requests.is_empty())
+            return;
+        auto job = HTTP::Job::construct(request_for(m_port, m_requests.dequeue()), m_output);
+        job->on_finish = [this](bool success) {
+            EXPECT(success);
+            m_on_request_finished();
+            Core::deferred_invoke([this] { start_next_request(); });
+        };
+        job->start(*m_socket);
+        m_jobs.append(move(job));
+    }
+
+private:
+    u16 m_port { 0 };
+    NonnullOwnPtr<Core::BufferedSocket<Core::TCPSocket>> m_socket;
+    Function<void()> m_on_request_finished;
+    Queue<size_t> m_requests;
+    AllocatingMemoryStream m_output;
+    Vector<NonnullRefPtr<HTTP::Job>> m_jobs;
+};
+
+BENCHMARK_CASE(http2_one_connection)
+{
+    Core::EventLoop event_loop;
+    TestServer server;
+
+    auto socket = MUST(Core::TCPSocket::connect("127.0.0.1", server.port()));
+    MUST(socket->set_blocking(false));
+    auto connection = HTTP::Http2Connection::construct(move(socket));
+
+    size_t finished_count = 0;
+    size_t received_size = 0;
+    Vector<NonnullRefPtr<HTTP::Http2Stream>> streams;
+    for (size_t i = 0; i < resource_count; ++i) {
+        auto stream = connection->open_stream(request_for(server.port(), i));
+        stream->on_data_received = [&](ReadonlyBytes data) { received_size += data.size(); };
+        stream->on_finish = [&](bool success) {
+            EXPECT(success);
+            if (++finished_count == resource_count)
+                event_loop.quit(0);
+        };
+        streams.append(move(stream));
+    }
+    event_loop.exec();
+
+    EXPECT_EQ(received_size, resource_count * resource_size);
+    EXPECT_EQ(connection->streams_opened(), resource_count);
+    EXPECT_EQ(server.connection_count(), 1u);
+}
+
+BENCHMARK_CASE(http1_four_connections)
+{
+    Core::EventLoop event_loop;
+    TestServer server;
+
+    size_t finished_count = 0;
+    Vector<NonnullOwnPtr<Http1Connection>> connections;
+    for (size_t i = 0; i < http1_connection_count; ++i) {
+        connections.append(make<Http1Connection>(server.port(), [&] {
+            if (++finished_count == resource_count)
+                event_loop.quit(0);
+        }));
+    }
+    for (size_t i = 0; i < resource_count; ++i)
+        connections[i % http1_connection_count]->enqueue(i);
+    for (auto& connection : connections)
+        connection->start_next_request();
+    event_loop.exec();
+
+    size_t received_size = 0;
+    for (auto& connection : connections)
+        received_size += connection->received_size();
+    EXPECT_EQ(received_size, resource_count * resource_size);
+    EXPECT_EQ(server.connection_count(), http1_connection_count);
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Hex.h>
+#include <AK/StringBuilder.h>
+#include <LibHTTP/HPack.h>
+#include <LibTest/TestCase.h>
+
+using HTTP::HPack::Header;
+
+static ByteBuffer bytes_from_hex(StringView hex)
+{
+    return MUST(decode_hex(hex));
+}
+
+// https://www.rfc-editor.org/rfc/rfc7541#appendix-C.1
+TEST_CASE(integer_representation)
+{
+    ByteBuffer buffer;
+    TRY_OR_FAIL(HTTP::HPack::encode_integer(buffer, 0, 5, 10));
+    EXPECT_EQ(buffer, bytes_from_hex("0a"sv));
+
+    buffer.clear();
+    TRY_OR_FAIL(HTTP::HPack::encode_integer(buffer, 0xe0, 5, 1337));
+    EXPECT_EQ(buffer, bytes_from_hex("ff9a0a"sv));
+
+    ReadonlyBytes data = buffer;
+    EXPECT_EQ(TRY_OR_FAIL(HTTP::HPack::decode_integer(data, 5)), 1337u);
+    EXPECT(data.is_empty());
+
+    auto truncated = bytes_from_hex("ff9a"sv);
+    data = truncated;
+    EXPECT(HTTP::HPack::decode_integer(data, 5).is_error());
+
+    auto too_long = bytes_from_hex("ffffffffffffffff7f"sv);
+    data = too_long;
+    EXPECT(HTTP::HPack::decode_integer(data, 5).is_error());
+}
+
+TEST_CASE(huffman_code)
+{
+    ByteBuffer buffer;
+    TRY_OR_FAIL(HTTP::HPack::huffman_encode(buffer, "www.example.com"sv));
+    EXPECT_EQ(buffer, bytes_from_hex("f1e3c2e5f23a6ba0ab90f4ff"sv));
+    EXPECT_EQ(HTTP::HPack::huffman_encoded_length("www.example.com"sv), 12u);
+    EXPECT_EQ(TRY_OR_FAIL(HTTP::HPack::huffman_decode(buffer)), "www.example.com"sv);
+
+    StringBuilder builder;
+    for (int i = 0; i < 256; ++i)
+        builder.append(static_cast<char>(i));
+    auto all_bytes = builder.to_byte_string();
+    buffer.clear();
+    TRY_OR_FAIL(HTTP::HPack::huffman_encode(buffer, all_bytes));
+    EXPECT_EQ(TRY_OR_FAIL(HTTP::HPack::huffman_decode(buffer)), all_bytes);
+
+    // Padding longer than 7 bits.
+    EXPECT(HTTP::HPack::huffman_decode(bytes_from_hex("f1e3c2e5f23a6ba0ab90f4ffff"sv)).is_error());
+    // Padding that isn't a prefix of EOS.
+    EXPECT(HTTP::HPack::huffman_decode(bytes_from_hex("f1e3c2e5f23a6ba0ab90f4fe"sv)).is_error());
+    // EOS itself.
+    EXPECT(HTTP::HPack::huffman_decode(bytes_from_hex("fffffffc"sv)).is_error());
+}
+
+// https://www.rfc-editor.org/rfc/rfc7541#appendix-C.4
+TEST_CASE(request_examples_with_huffman_coding)
+{
+    Vector<Header> first_request {
+        { ":method", "GET" },
+        { ":scheme", "http" },
+        { ":path", "/" },
+        { ":authority", "www.example.com" },
+    };
+    auto second_request = first_request;
+    second_request.append({ "cache-control", "no-cache" });
+    Vector<Header> third_request {
+        { ":method", "GET" },
+        { ":scheme", "https" },
+        { ":path", "/index.html" },
+        { ":authority", "www.example.com" },
+        { "custom-key", "custom-value" },
+    };
+
+    auto first_block = bytes_from_hex("828684418cf1e3c2e5f23a6ba0ab90f4ff"sv);
+    auto second_block = bytes_from_hex("828684be5886a8eb10649cbf"sv);
+    auto third_block = bytes_from_hex("828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf"sv);
+
+    HTTP::HPack::Decoder decoder;
+    EXPECT_EQ(TRY_OR_FAIL(decoder.decode(first_block)), first_request);
+    EXPECT_EQ(decoder.table().size(), 57u);
+    EXPECT_EQ(TRY_OR_FAIL(decoder.decode(second_block)), second_request);
+    EXPECT_EQ(decoder.table().size(), 110u);
+    EXPECT_EQ(TRY_OR_FAIL(decoder.decode(third_block)), third_request);
+    EXPECT_EQ(decoder.table().size(), 164u);
+    EXPECT_EQ(decoder.table().at(0), (Header { "custom-key", "custom-value" }));
+
+    HTTP::HPack::Encoder encoder;
+    EXPECT_EQ(TRY_OR_FAIL(encoder.encode(first_request)), first_block);
+    EXPECT_EQ(TRY_OR_FAIL(encoder.encode(second_request)), second_block);
+    EXPECT_EQ(TRY_OR_FAIL(encoder.encode(third_request)), third_block);
+    EXPECT_EQ(encoder.table().size(), 164u);
+}
+
+// https://www.rfc-editor.org/rfc/rfc7541#appendix-C.6
+TEST_CASE(response_examples_with_eviction)
+{
+    HTTP::HPack::Decoder decoder { 256 };
+
+    auto headers = TRY_OR_FAIL(decoder.decode(bytes_from_hex("488264025885aec3771a4b6196d07abe941054d444a8200595040b8166e082a62d1bff6e919d29ad171863c78f0b97c8e9ae82ae43d3"sv)));
+    EXPECT_EQ(headers.size(), 4u);
+    EXPECT_EQ(headers[0], (Header { ":status", "302" }));
+    EXPECT_EQ(headers[3], (Header { "location", "https://www.example.com" }));
+    EXPECT_EQ(decoder.table().size(), 222u);
+
+    headers = TRY_OR_FAIL(decoder.decode(bytes_from_hex("4883640effc1c0bf"sv)));
+    EXPECT_EQ(headers[0], (Header { ":status", "307" }));
+    EXPECT_EQ(headers[2], (Header { "date", "Mon, 21 Oct 2013 20:13:21 GMT" }));
+    EXPECT_EQ(decoder.table().size(), 222u);
+
+    headers = TRY_OR_FAIL(decoder.decode(bytes_from_hex("88c16196d07abe941054d444a8200595040b8166e084a62d1bffc05a839bd9ab77ad94e7821dd7f2e6c7b335dfdfcd5b3960d5af27087f3672c1ab270fb5291f9587316065c003ed4ee5b1063d5007"sv)));
+    EXPECT_EQ(headers.size(), 6u);
+    EXPECT_EQ(headers[0], (Header { ":status", "200" }));
+    EXPECT_EQ(headers[5], (Header { "set-cookie", "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1" }));
+    EXPECT_EQ(decoder.table().entry_count(), 3u);
+    EXPECT_EQ(decoder.table().size(), 215u);
+}
+
+TEST_CASE(invalid_header_blocks)
+{
+    HTTP::HPack::Decoder decoder;
+    // Index 0.
+    EXPECT(decoder.decode(bytes_from_hex("80"sv)).is_error());
+    // Index past the end of the (empty) dynamic table.
+    EXPECT(decoder.decode(bytes_from_hex("be"sv)).is_error());
+    // A table size update after a header.
+    EXPECT(decoder.decode(bytes_from_hex("8220"sv)).is_error());
+    // A table size update beyond the limit.
+    EXPECT(decoder.decode(bytes_from_hex("3fe21f"sv)).is_error());
+    // A string that runs past the end of the block.
+    EXPECT(decoder.decode(bytes_from_hex("400a637573746f6d"sv)).is_error());
+}
+
+TEST_CASE(table_size_updates)
+{
+    HTTP::HPack::Encoder encoder;
+    HTTP::HPack::Decoder decoder;
+    Vector<Header> request {
+        { ":authority", "www.example.com" },
+        { "user-agent", "Ladybird" },
+    };
+    EXPECT_EQ(TRY_OR_FAIL(decoder.decode(TRY_OR_FAIL(encoder.encode(request)))), request);
+    EXPECT_EQ(decoder.table().entry_count(), 2u);
+
+    // Shrinking and growing the table before the next block has to signal the smallest size first.
+    encoder.set_max_table_size(0);
+    encoder.set_max_table_size(100);
+    auto block = TRY_OR_FAIL(encoder.encode(request));
+    EXPECT_EQ(block[0], 0x20);
+    EXPECT_EQ(TRY_OR_FAIL(decoder.decode(block)), request);
+    EXPECT_EQ(decoder.table().max_size(), 100u);
+    EXPECT_EQ(decoder.table().entry_count(), encoder.table().entry_count());
+
+    // Credentials are never indexed.
+    Vector<Header> authorized_request { { "authorization", "Basic Zm9vOmJhcg==" } };
+    block = TRY_OR_FAIL(encoder.encode(authorized_request));
+    EXPECT_EQ(block[0], 0x1f);
+    EXPECT_EQ(TRY_OR_FAIL(decoder.decode(block)), authorized_request);
+    EXPECT_EQ(TRY_OR_FAIL(encoder.encode(authorized_request)), block);
+}
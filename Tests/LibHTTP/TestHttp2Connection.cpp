@@ -0,0 +1,473 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h> // import first, to prevent warning of VERIFY* redefinition
+
+#include <LibCore/EventLoop.h>
+#include <LibCore/Socket.h>
+#include <LibHTTP/HPack.h>
+#include <LibHTTP/Http2Connection.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// These play the server's part frame by frame, over the other end of a socket pair.
+
+enum FrameType : u8 {
+    Data = 0x0,
+    Headers = 0x1,
+    RstStream = 0x3,
+    Settings = 0x4,
+    GoAway = 0x7,
+    WindowUpdate = 0x8,
+};
+
+enum FrameFlags : u8 {
+    EndStream = 0x1,
+    Ack = 0x1,
+    EndHeaders = 0x4,
+};
+
+enum SettingsParameter : u16 {
+    EnablePush = 0x2,
+    MaxConcurrentStreams = 0x3,
+    InitialWindowSize = 0x4,
+};
+
+struct Frame {
+    u8 type { 0 };
+    u8 flags { 0 };
+    u32 stream_id { 0 };
+    ByteBuffer payload;
+};
+
+static u32 read_u32(ReadonlyBytes bytes)
+{
+    return (static_cast<u32>(bytes[0]) << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+}
+
+static void append_u32(ByteBuffer& buffer, u32 value)
+{
+    u8 bytes[] = { static_cast<u8>(value >> 24), static_cast<u8>(value >> 16), static_cast<u8>(value >> 8), static_cast<u8>(value) };
+    buffer.append(bytes, sizeof(bytes));
+}
+
+class TestServer {
+public:
+    TestServer()
+    {
+        int fds[2];
+        VERIFY(socketpair(AF_LOCAL, SOCK_STREAM, 0, fds) == 0);
+        m_fd = fds[0];
+        auto socket = MUST(Core::LocalSocket::adopt_fd(fds[1]));
+        MUST(socket->set_blocking(false));
+        connection = HTTP::Http2Connection::construct(move(socket));
+
+        // The client starts with the preface, its SETTINGS and a bigger connection window.
+        static constexpr auto preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"sv;
+        receive_until([&] { return m_input.size() >= preface.length(); });
+        VERIFY(m_input.bytes().starts_with(preface.bytes()));
+        m_input = MUST(m_input.slice(preface.length(), m_input.size() - preface.length()));
+
+        auto settings = receive_frame();
+        VERIFY(settings.type == Settings && settings.stream_id == 0);
+        auto window_update = receive_frame();
+        VERIFY(window_update.type == WindowUpdate && window_update.stream_id == 0);
+    }
+
+    ~TestServer()
+    {
+        close(m_fd);
+    }
+
+    RefPtr<HTTP::Http2Connection> connection;
+
+    void send_frame(u8 type, u8 flags, u32 stream_id, ReadonlyBytes payload = {})
+    {
+        ByteBuffer frame;
+        u8 length[] = { static_cast<u8>(payload.size() >> 16), static_cast<u8>(payload.size() >> 8), static_cast<u8>(payload.size()) };
+        frame.append(length, sizeof(length));
+        frame.append(type);
+        frame.append(flags);
+        append_u32(frame, stream_id);
+        frame.append(payload);
+        VERIFY(write(m_fd, frame.data(), frame.size()) == static_cast<ssize_t>(frame.size()));
+        pump();
+    }
+
+    void send_settings(Vector<Array<u32, 2>> const& settings = {})
+    {
+        ByteBuffer payload;
+        for (auto& setting : settings) {
+            payload.append(static_cast<u8>(setting[0] >> 8));
+            payload.append(static_cast<u8>(setting[0]));
+            append_u32(payload, setting[1]);
+        }
+        send_frame(Settings, 0, 0, payload);
+        auto ack = receive_frame();
+        VERIFY(ack.type == Settings && ack.flags == Ack);
+    }
+
+    void send_response(u32 stream_id, StringView status, bool end_stream = true)
+    {
+        Vector<HTTP::HPack::Header> headers { { ":status", status } };
+        auto header_block = MUST(m_encoder.encode(headers));
+        send_frame(Headers, EndHeaders | (end_stream ? EndStream : 0), stream_id, header_block);
+    }
+
+    void send_rst_stream(u32 stream_id, u32 error_code)
+    {
+        ByteBuffer payload;
+        append_u32(payload, error_code);
+        send_frame(RstStream, 0, stream_id, payload);
+    }
+
+    void send_goaway(u32 last_stream_id, u32 error_code = 0)
+    {
+        ByteBuffer payload;
+        append_u32(payload, last_stream_id);
+        append_u32(payload, error_code);
+        send_frame(GoAway, 0, 0, payload);
+    }
+
+    void send_window_update(u32 stream_id, u32 increment)
+    {
+        ByteBuffer payload;
+        append_u32(payload, increment);
+        send_frame(WindowUpdate, 0, stream_id, payload);
+    }
+
+    Frame receive_frame()
+    {
+        receive_until([&] { return has_complete_frame(); });
+        auto data = m_input.bytes();
+        size_t length = (data[0] << 16) | (data[1] << 8) | data[2];
+        Frame frame { data[3], data[4], read_u32(data.slice(5)) & 0x7fffffff, MUST(ByteBuffer::copy(data.slice(9, length))) };
+        m_input = MUST(m_input.slice(9 + length, m_input.size() - 9 - length));
+        return frame;
+    }
+
+    // Receives the HEADERS of a request, and returns its path.
+    ByteString receive_request(u32 expected_stream_id)
+    {
+        auto frame = receive_frame();
+        EXPECT_EQ(frame.type, Headers);
+        EXPECT_EQ(frame.stream_id, expected_stream_id);
+        auto headers = MUST(m_decoder.decode(frame.payload));
+        auto path = headers.first_matching([](auto& header) { return header.name == ":path"sv; });
+        VERIFY(path.has_value());
+        return path->value;
+    }
+
+    bool has_received_anything()
+    {
+        pump();
+        return !m_input.is_empty();
+    }
+
+private:
+    bool has_complete_frame()
+    {
+        if (m_input.size() < 9)
+            return false;
+        size_t length = (m_input[0] << 16) | (m_input[1] << 8) | m_input[2];
+        return m_input.size() >= 9 + length;
+    }
+
+    void pump()
+    {
+        for (int i = 0; i < 5; ++i)
+            Core::EventLoop::current().pump(Core::EventLoop::WaitMode::PollForEvents);
+
+        while (true) {
+            u8 buffer[16 * KiB];
+            auto nread = recv(m_fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (nread <= 0)
+                break;
+            m_input.append(buffer, nread);
+        }
+    }
+
+    void receive_until(Function<bool()> condition)
+    {
+        for (int i = 0; i < 100 && !condition(); ++i)
+            pump();
+        VERIFY(condition());
+    }
+
+    int m_fd { -1 };
+    ByteBuffer m_input;
+    HTTP::HPack::Encoder m_encoder;
+    HTTP::HPack::Decoder m_decoder;
+};
+
+static HTTP::HttpRequest request_for(StringView path, ByteBuffer body = {})
+{
+    HTTP::HttpRequest request;
+    request.set_url(URL(ByteString::formatted("https://example.com{}", path)));
+    if (!body.is_empty()) {
+        request.set_method(HTTP::HttpRequest::Method::POST);
+        request.set_body(move(body));
+    }
+    return request;
+}
+
+struct StreamResult {
+    Optional<u32> status_code;
+    Optional<bool> success;
+    size_t received_size { 0 };
+};
+
+static NonnullRefPtr<HTTP::Http2Stream> open_stream(HTTP::Http2Connection& connection, StringView path, StreamResult& result, ByteBuffer body = {})
+{
+    auto stream = connection.open_stream(request_for(path, move(body)));
+    stream->on_headers_received = [&result](u32 status_code, auto const&) { result.status_code = status_code; };
+    stream->on_data_received = [&result](ReadonlyBytes data) { result.received_size += data.size(); };
+    stream->on_finish = [&result](bool success) { result.success = success; };
+    return stream;
+}
+
+TEST_CASE(settings)
+{
+    Core::EventLoop event_loop;
+    TestServer server;
+
+    // The server's SETTINGS limit how many requests can be in flight.
+    server.send_settings({ { MaxConcurrentStreams, 1 } });
+    StreamResult first_result, second_result;
+    auto first = open_stream(*server.connection, "/first"sv, first_result);
+    auto second = open_stream(*server.connection, "/second"sv, second_result);
+    EXPECT_EQ(server.receive_request(1), "/first"sv);
+    EXPECT(!server.has_received_anything());
+    EXPECT_EQ(server.connection->active_stream_count(), 1u);
+    EXPECT_EQ(server.connection->queued_stream_count(), 1u);
+
+    server.send_response(1, "200"sv);
+    EXPECT_EQ(first_result.status_code, 200u);
+    EXPECT_EQ(first_result.success, true);
+    EXPECT_EQ(server.receive_request(3), "/second"sv);
+
+    server.send_response(3, "204"sv);
+    EXPECT_EQ(second_result.success, true);
+}
+
+TEST_CASE(settings_that_enable_push)
+{
+    Core::EventLoop event_loop;
+    TestServer server;
+
+    StreamResult result;
+    auto stream = open_stream(*server.connection, "/"sv, result);
+    server.receive_request(1);
+
+    // We told the server that push is disabled, it can't turn it on for us.
+    u8 enable_push[] = { 0, EnablePush, 0, 0, 0, 1 };
+    server.send_frame(Settings, 0, 0, { enable_push, sizeof(enable_push) });
+    auto goaway = server.receive_frame();
+    EXPECT_EQ(goaway.type, GoAway);
+    EXPECT_EQ(read_u32(goaway.payload.bytes().slice(4)), to_underlying(HTTP::Http2ErrorCode::ProtocolError));
+    EXPECT_EQ(result.success, false);
+    EXPECT(!server.connection->can_open_streams());
+}
+
+TEST_CASE(rst_stream)
+{
+    Core::EventLoop event_loop;
+    TestServer server;
+    server.send_settings();
+
+    StreamResult first_result, second_result;
+    auto first = open_stream(*server.connection, "/first"sv, first_result);
+    auto second = open_stream(*server.connection, "/second"sv, second_result);
+    EXPECT_EQ(server.receive_request(1), "/first"sv);
+    EXPECT_EQ(server.receive_request(3), "/second"sv);
+
+    // Resetting one stream leaves the others alone.
+    server.send_rst_stream(1, to_underlying(HTTP::Http2ErrorCode::InternalError));
+    EXPECT_EQ(first_result.success, false);
+    EXPECT(!second_result.success.has_value());
+    EXPECT_EQ(server.connection->active_stream_count(), 1u);
+
+    // Cancelling a stream resets it, without calling back.
+    second->cancel();
+    auto rst_stream = server.receive_frame();
+    EXPECT_EQ(rst_stream.type, RstStream);
+    EXPECT_EQ(rst_stream.stream_id, 3u);
+    EXPECT_EQ(read_u32(rst_stream.payload), to_underlying(HTTP::Http2ErrorCode::Cancel));
+    EXPECT(!second_result.success.has_value());
+    EXPECT_EQ(server.connection->active_stream_count(), 0u);
+
+    // Frames for streams that were reset can still be on their way, and are ignored.
+    server.send_response(3, "200"sv);
+    EXPECT(server.connection->can_open_streams());
+}
+
+TEST_CASE(send_flow_control)
+{
+    Core::EventLoop event_loop;
+    TestServer server;
+    server.send_settings({ { InitialWindowSize, 10 } });
+
+    StreamResult result;
+    auto body = MUST(ByteBuffer::create_zeroed(25));
+    auto stream = open_stream(*server.connection, "/upload"sv, result, move(body));
+    server.receive_request(1);
+
+    // The body only goes out as far as the stream window allows.
+    auto data = server.receive_frame();
+    EXPECT_EQ(data.type, Data);
+    EXPECT_EQ(data.payload.size(), 10u);
+    EXPECT_EQ(data.flags & EndStream, 0);
+    EXPECT(!server.has_received_anything());
+
+    server.send_window_update(1, 5);
+    data = server.receive_frame();
+    EXPECT_EQ(data.payload.size(), 5u);
+    EXPECT(!server.has_received_anything());
+
+    // A bigger initial window grows the windows of open streams as well.
+    server.send_settings({ { InitialWindowSize, 20 } });
+    data = server.receive_frame();
+    EXPECT_EQ(data.payload.size(), 10u);
+    EXPECT_EQ(data.flags & EndStream, EndStream);
+
+    server.send_response(1, "201"sv);
+    EXPECT_EQ(result.status_code, 201u);
+    EXPECT_EQ(result.success, true);
+}
+
+TEST_CASE(window_overflow)
+{
+    Core::EventLoop event_loop;
+    TestServer server;
+    server.send_settings();
+
+    StreamResult result;
+    auto stream = open_stream(*server.connection, "/"sv, result);
+    server.receive_request(1);
+
+    // A stream window beyond 2^31-1 is a stream error...
+    server.send_window_update(1, 0x7fffffff);
+    auto rst_stream = server.receive_frame();
+    EXPECT_EQ(rst_stream.type, RstStream);
+    EXPECT_EQ(read_u32(rst_stream.payload), to_underlying(HTTP::Http2ErrorCode::FlowControlError));
+    EXPECT_EQ(result.success, false);
+
+    // ...while one for the connection window is a connection error.
+    server.send_window_update(0, 0x7fffffff);
+    auto goaway = server.receive_frame();
+    EXPECT_EQ(goaway.type, GoAway);
+    EXPECT_EQ(read_u32(goaway.payload.bytes().slice(4)), to_underlying(HTTP::Http2ErrorCode::FlowControlError));
+}
+
+TEST_CASE(receive_flow_control)
+{
+    Core::EventLoop event_loop;
+    TestServer server;
+    server.send_settings();
+
+    StreamResult result;
+    auto stream = open_stream(*server.connection, "/"sv, result);
+    server.receive_request(1);
+    server.send_response(1, "200"sv, false);
+
+    // Data the client has handed over to the stream isn't acknowledged until half of a window is used up.
+    auto chunk = MUST(ByteBuffer::create_zeroed(16 * KiB));
+    for (size_t i = 0; i < 127; ++i)
+        server.send_frame(Data, 0, 1, chunk);
+    EXPECT(!server.has_received_anything());
+
+    server.send_frame(Data, 0, 1, chunk);
+    auto window_update = server.receive_frame();
+    EXPECT_EQ(window_update.type, WindowUpdate);
+    EXPECT_EQ(window_update.stream_id, 1u);
+    EXPECT_EQ(read_u32(window_update.payload), 2u * MiB);
+
+    server.send_frame(Data, EndStream, 1, {});
+    EXPECT_EQ(result.received_size, 2u * MiB);
+    EXPECT_EQ(result.success, true);
+}
+
+TEST_CASE(goaway_retries_unprocessed_streams)
+{
+    Core::EventLoop event_loop;
+    TestServer server;
+    TestServer other_server;
+    server.connection->find_connection_for_retry = [&]() -> RefPtr<HTTP::Http2Connection> { return other_server.connection; };
+    server.send_settings({ { MaxConcurrentStreams, 2 } });
+    other_server.send_settings();
+
+    StreamResult first_result, second_result, third_result;
+    auto first = open_stream(*server.connection, "/first"sv, first_result);
+    auto second = open_stream(*server.connection, "/second"sv, second_result);
+    auto third = open_stream(*server.connection, "/third"sv, third_result);
+    server.receive_request(1);
+    server.receive_request(3);
+    EXPECT_EQ(server.connection->queued_stream_count(), 1u);
+
+    // The server only got to the first stream, the others move to the other connection, without failing.
+    server.send_goaway(1);
+    EXPECT(!server.connection->can_open_streams());
+    EXPECT(!second_result.success.has_value());
+    EXPECT(!third_result.success.has_value());
+    EXPECT_EQ(other_server.receive_request(1), "/second"sv);
+    EXPECT_EQ(other_server.receive_request(3), "/third"sv);
+
+    // The first stream completes on the connection that is going away, which then closes.
+    server.send_response(1, "200"sv);
+    EXPECT_EQ(first_result.success, true);
+    EXPECT_EQ(server.receive_frame().type, GoAway);
+
+    other_server.send_response(1, "200"sv);
+    other_server.send_response(3, "200"sv);
+    EXPECT_EQ(second_result.success, true);
+    EXPECT_EQ(third_result.success, true);
+}
+
+TEST_CASE(goaway_without_another_connection)
+{
+    Core::EventLoop event_loop;
+    TestServer server;
+    server.send_settings();
+
+    StreamResult first_result, second_result;
+    auto first = open_stream(*server.connection, "/first"sv, first_result);
+    auto second = open_stream(*server.connection, "/second"sv, second_result);
+    server.receive_request(1);
+    server.receive_request(3);
+
+    server.send_goaway(1);
+    EXPECT(!first_result.success.has_value());
+    EXPECT_EQ(second_result.success, false);
+
+    StreamResult late_result;
+    auto late = open_stream(*server.connection, "/late"sv, late_result);
+    server.send_response(1, "200"sv);
+    EXPECT_EQ(first_result.success, true);
+    EXPECT_EQ(late_result.success, false);
+}
+
+TEST_CASE(goaway_retries_only_once)
+{
+    Core::EventLoop event_loop;
+    TestServer server;
+    TestServer other_server;
+    TestServer third_server;
+    server.connection->find_connection_for_retry = [&]() -> RefPtr<HTTP::Http2Connection> { return other_server.connection; };
+    other_server.connection->find_connection_for_retry = [&]() -> RefPtr<HTTP::Http2Connection> { return third_server.connection; };
+    server.send_settings();
+    other_server.send_settings();
+    third_server.send_settings();
+
+    // A server that keeps refusing a request could otherwise keep it bouncing between connections forever.
+    StreamResult result;
+    auto stream = open_stream(*server.connection, "/"sv, result);
+    server.receive_request(1);
+    server.send_goaway(0);
+    other_server.receive_request(1);
+    other_server.send_goaway(0);
+    EXPECT_EQ(result.success, false);
+    EXPECT(!third_server.has_received_anything());
+}
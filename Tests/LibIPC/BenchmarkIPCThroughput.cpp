@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/MemoryStream.h>
+#include <LibCore/Socket.h>
+#include <LibCore/System.h>
+#include <LibIPC/Decoder.h>
+#include <LibIPC/Encoder.h>
+#include <LibIPC/SharedBufferPool.h>
+#include <LibThreading/Thread.h>
+#include <sys/socket.h>
+
+static constexpr size_t total_size = 512 * MiB;
+
+class Endpoint {
+public:
+    Endpoint(int data_socket, int fd_passing_socket)
+        : m_data_socket(MUST(Core::LocalSocket::adopt_fd(data_socket)))
+        , m_fd_passing_socket(MUST(Core::LocalSocket::adopt_fd(fd_passing_socket)))
+    {
+    }
+
+    void send(ByteBuffer const& payload)
+    {
+        IPC::MessageBuffer buffer;
+        IPC::Encoder encoder { buffer, &m_pool };
+        MUST(encoder.encode(payload));
+        MUST(buffer.transfer_message(*m_fd_passing_socket, *m_data_socket));
+    }
+
+    ByteBuffer receive()
+    {
+        auto size = MUST(m_data_socket->read_value<u32>());
+        if (m_message.size() < size)
+            m_message = MUST(ByteBuffer::create_uninitialized(size));
+
+        FixedMemoryStream stream { m_message.bytes().trim(size) };
+        MUST(m_data_socket->read_until_filled(m_message.bytes().trim(size)));
+        IPC::Decoder decoder { stream, *m_fd_passing_socket };
+        return MUST(decoder.decode<ByteBuffer>());
+    }
+
+private:
+    NonnullOwnPtr<Core::LocalSocket> m_data_socket;
+    NonnullOwnPtr<Core::LocalSocket> m_fd_passing_socket;
+    IPC::SharedBufferPool m_pool;
+    ByteBuffer m_message;
+};
+
+struct Sockets {
+    Sockets()
+    {
+        MUST(Core::System::socketpair(AF_LOCAL, SOCK_STREAM, 0, data));
+        MUST(Core::System::socketpair(AF_LOCAL, SOCK_STREAM, 0, fd_passing));
+    }
+
+    int data[2];
+    int fd_passing[2];
+};
+
+struct Endpoints {
+    Sockets sockets;
+    Endpoint client { sockets.data[0], sockets.fd_passing[0] };
+    Endpoint server { sockets.data[1], sockets.fd_passing[1] };
+};
+
+// Every payload is sent back by the peer, like the response to a synchronous message would be.
+static void send_round_trips(size_t payload_size)
+{
+    Endpoints endpoints;
+    auto& client = endpoints.client;
+    auto& server = endpoints.server;
+    auto round_trip_count = total_size / payload_size / 2;
+
+    auto server_thread = Threading::Thread::construct([&]() -> intptr_t {
+        for (size_t i = 0; i < round_trip_count; ++i)
+            server.send(server.receive());
+        return 0;
+    });
+    server_thread->start();
+
+    auto payload = MUST(ByteBuffer::create_zeroed(payload_size));
+    for (size_t i = 0; i < round_trip_count; ++i) {
+        payload[i % payload_size] = static_cast<u8>(i);
+        client.send(payload);
+        payload = client.receive();
+    }
+    MUST(server_thread->join());
+
+    EXPECT_EQ(payload.size(), payload_size);
+    EXPECT_EQ(payload[(round_trip_count - 1) % payload_size], static_cast<u8>(round_trip_count - 1));
+}
+
+BENCHMARK_CASE(round_trips_16_kib)
+{
+    send_round_trips(16 * KiB);
+}
+
+BENCHMARK_CASE(round_trips_256_kib)
+{
+    send_round_trips(256 * KiB);
+}
+
+BENCHMARK_CASE(round_trips_4_mib)
+{
+    send_round_trips(4 * MiB);
+}
+
+// The peer only receives, like with a stream of asynchronous messages.
+static void send_one_way(size_t payload_size)
+{
+    Endpoints endpoints;
+    auto& client = endpoints.client;
+    auto& server = endpoints.server;
+    auto message_count = total_size / payload_size;
+
+    auto server_thread = Threading::Thread::construct([&]() -> intptr_t {
+        for (size_t i = 0; i < message_count; ++i) {
+            auto payload = server.receive();
+            VERIFY(payload[i % payload_size] == static_cast<u8>(i));
+        }
+        return 0;
+    });
+    server_thread->start();
+
+    auto payload = MUST(ByteBuffer::create_zeroed(payload_size));
+    for (size_t i = 0; i < message_count; ++i) {
+        payload[i % payload_size] = static_cast<u8>(i);
+        client.send(payload);
+    }
+    MUST(server_thread->join());
+}
+
+BENCHMARK_CASE(one_way_16_kib)
+{
+    send_one_way(16 * KiB);
+}
+
+BENCHMARK_CASE(one_way_256_kib)
+{
+    send_one_way(256 * KiB);
+}
+
+BENCHMARK_CASE(one_way_4_mib)
+{
+    send_one_way(4 * MiB);
+}
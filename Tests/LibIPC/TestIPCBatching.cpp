@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/MemoryStream.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/Socket.h>
+#include <LibCore/System.h>
+#include <LibIPC/Connection.h>
+#include <LibIPC/Decoder.h>
+#include <LibIPC/Encoder.h>
+#include <LibIPC/Stub.h>
+#include <LibThreading/Thread.h>
+#include <sys/socket.h>
+
+// What the IPC compiler would generate for an endpoint with a single `ping(u32 value, ByteBuffer padding) =|` message.
+static constexpr u32 test_endpoint_magic = 0x7e57;
+static constexpr int ping_message_id = 1;
+
+class Ping final : public IPC::Message {
+public:
+    Ping(u32 value, ByteBuffer padding = {})
+        : m_value(value)
+        , m_padding(move(padding))
+    {
+    }
+
+    virtual u32 endpoint_magic() const override { return test_endpoint_magic; }
+    virtual int message_id() const override { return ping_message_id; }
+    virtual char const* message_name() const override { return "TestEndpoint::Ping"; }
+    virtual bool valid() const override { return true; }
+
+    virtual ErrorOr<IPC::MessageBuffer> encode(IPC::SharedBufferPool* buffer_pool) const override
+    {
+        IPC::MessageBuffer buffer;
+        IPC::Encoder encoder(buffer, buffer_pool);
+        TRY(encoder.encode(test_endpoint_magic));
+        TRY(encoder.encode(ping_message_id));
+        TRY(encoder.encode(m_value));
+        TRY(encoder.encode(m_padding));
+        return buffer;
+    }
+
+    u32 value() const { return m_value; }
+
+private:
+    u32 m_value { 0 };
+    ByteBuffer m_padding;
+};
+
+class TestEndpoint {
+public:
+    static u32 static_magic() { return test_endpoint_magic; }
+
+    static ErrorOr<NonnullOwnPtr<IPC::Message>> decode_message(ReadonlyBytes buffer, Core::LocalSocket& socket)
+    {
+        FixedMemoryStream stream { buffer };
+        IPC::Decoder decoder { stream, socket };
+        if (TRY(decoder.decode<u32>()) != test_endpoint_magic || TRY(decoder.decode<int>()) != ping_message_id)
+            return Error::from_string_literal("Not a ping");
+        auto value = TRY(decoder.decode<u32>());
+        auto padding = TRY(decoder.decode<ByteBuffer>());
+        return make<Ping>(value, move(padding));
+    }
+};
+
+class TestConnection final
+    : public IPC::Connection<TestEndpoint, TestEndpoint>
+    , public IPC::Stub {
+    C_OBJECT(TestConnection);
+
+public:
+    Vector<u32> const& received_values() const { return m_received_values; }
+
+private:
+    explicit TestConnection(NonnullOwnPtr<Core::LocalSocket> socket)
+        : IPC::Connection<TestEndpoint, TestEndpoint>(*this, move(socket))
+    {
+    }
+
+    virtual u32 magic() const override { return test_endpoint_magic; }
+    virtual ByteString name() const override { return "TestEndpoint"; }
+
+    virtual ErrorOr<OwnPtr<IPC::Message>> handle(IPC::Message const& message) override
+    {
+        m_received_values.append(static_cast<Ping const&>(message).value());
+        return nullptr;
+    }
+
+    Vector<u32> m_received_values;
+};
+
+struct ConnectedPair {
+    ConnectedPair()
+    {
+        int sockets[2];
+        MUST(Core::System::socketpair(AF_LOCAL, SOCK_STREAM, 0, sockets));
+        sender = TestConnection::construct(MUST(Core::LocalSocket::adopt_fd(sockets[0])));
+        receiver = TestConnection::construct(MUST(Core::LocalSocket::adopt_fd(sockets[1])));
+    }
+
+    RefPtr<TestConnection> sender;
+    RefPtr<TestConnection> receiver;
+};
+
+TEST_CASE(messages_are_sent_together)
+{
+    Core::EventLoop loop;
+    ConnectedPair connections;
+    auto& sender = connections.sender;
+    auto& receiver = connections.receiver;
+
+    Vector<u32> values;
+    for (u32 i = 0; i < 100; ++i) {
+        MUST(sender->post_message(Ping { i }));
+        values.append(i);
+    }
+    EXPECT_EQ(sender->statistics().messages_sent, 0u);
+
+    loop.spin_until([&] { return receiver->received_values().size() == values.size(); });
+    EXPECT_EQ(receiver->received_values(), values);
+
+    EXPECT_EQ(sender->statistics().messages_sent, 100u);
+    EXPECT_EQ(sender->statistics().send_syscalls, 1u);
+    EXPECT_EQ(receiver->statistics().messages_received, 100u);
+    // One read gets everything, the next one finds nothing left.
+    EXPECT_EQ(receiver->statistics().receive_syscalls, 2u);
+}
+
+TEST_CASE(flush_posted_messages)
+{
+    Core::EventLoop loop;
+    ConnectedPair connections;
+    auto& sender = connections.sender;
+    auto& receiver = connections.receiver;
+
+    MUST(sender->post_message(Ping { 1 }));
+    MUST(sender->post_message(Ping { 2 }));
+    MUST(sender->flush_posted_messages());
+    EXPECT_EQ(sender->statistics().messages_sent, 2u);
+    EXPECT_EQ(sender->statistics().send_syscalls, 1u);
+
+    // Nothing is left to be sent once the event loop gets to it.
+    loop.spin_until([&] { return receiver->received_values().size() == 2; });
+    EXPECT_EQ(sender->statistics().send_syscalls, 1u);
+}
+
+TEST_CASE(large_batches_are_sent_right_away)
+{
+    Core::EventLoop loop;
+    ConnectedPair connections;
+    auto& sender = connections.sender;
+    auto& receiver = connections.receiver;
+
+    // Not large enough to be passed in shared memory.
+    auto padding = MUST(ByteBuffer::create_zeroed(40 * KiB));
+    MUST(sender->post_message(Ping { 1, padding }));
+    EXPECT_EQ(sender->statistics().messages_sent, 0u);
+    MUST(sender->post_message(Ping { 2, padding }));
+    EXPECT_EQ(sender->statistics().messages_sent, 2u);
+
+    loop.spin_until([&] { return receiver->received_values().size() == 2; });
+    EXPECT_EQ(receiver->received_values(), (Vector<u32> { 1, 2 }));
+}
+
+TEST_CASE(posting_from_two_threads)
+{
+    Core::EventLoop loop;
+    ConnectedPair connections;
+    auto& sender = connections.sender;
+    auto& receiver = connections.receiver;
+
+    // The receiver only reads once we spin the event loop, so everything has to fit into the socket until then.
+    static constexpr u32 message_count = 100;
+    auto thread = Threading::Thread::construct([&]() -> intptr_t {
+        // There's no event loop on this thread to flush, so each message goes out right away.
+        for (u32 i = 0; i < message_count; ++i)
+            MUST(sender->post_message(Ping { message_count + i }));
+        return 0;
+    });
+    thread->start();
+    for (u32 i = 0; i < message_count; ++i)
+        MUST(sender->post_message(Ping { i }));
+    MUST(thread->join());
+    EXPECT_EQ(sender->statistics().messages_sent, message_count);
+
+    loop.spin_until([&] { return receiver->received_values().size() == 2 * message_count; });
+    EXPECT_EQ(sender->statistics().messages_sent, 2 * message_count);
+
+    // The messages of each thread arrive in the order they were posted.
+    u32 next_value_from_this_thread = 0;
+    u32 next_value_from_other_thread = message_count;
+    for (auto value : receiver->received_values()) {
+        auto& next_value = value < message_count ? next_value_from_this_thread : next_value_from_other_thread;
+        EXPECT_EQ(value, next_value);
+        next_value = value + 1;
+    }
+    EXPECT_EQ(next_value_from_this_thread, message_count);
+    EXPECT_EQ(next_value_from_other_thread, 2 * message_count);
+}
+
+TEST_CASE(shutdown_sends_posted_messages)
+{
+    Core::EventLoop loop;
+    ConnectedPair connections;
+    auto& sender = connections.sender;
+    auto& receiver = connections.receiver;
+
+    MUST(sender->post_message(Ping { 1 }));
+    sender->shutdown();
+    EXPECT_EQ(sender->statistics().messages_sent, 1u);
+
+    loop.spin_until([&] { return receiver->received_values().size() == 1; });
+    EXPECT_EQ(receiver->received_values(), (Vector<u32> { 1 }));
+}
+
+struct NeverRunningDeferredInvoker final : public IPC::DeferredInvoker {
+    virtual void schedule(Function<void()>) override { }
+};
+
+TEST_CASE(custom_deferred_invokers_dont_flush)
+{
+    Core::EventLoop loop;
+    ConnectedPair connections;
+    auto& sender = connections.sender;
+
+    // We can't rely on the invoker ever getting to the flush.
+    sender->set_deferred_invoker(make<NeverRunningDeferredInvoker>());
+    MUST(sender->post_message(Ping { 1 }));
+    EXPECT_EQ(sender->statistics().messages_sent, 1u);
+}
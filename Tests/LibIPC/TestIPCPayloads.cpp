@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/MemoryStream.h>
+#include <LibCore/Socket.h>
+#include <LibCore/System.h>
+#include <LibIPC/Decoder.h>
+#include <LibIPC/Encoder.h>
+#include <LibIPC/SharedBufferPool.h>
+#include <sys/socket.h>
+
+// Both ends of a connection, each with a pool for what it sends, and with file descriptors passed on a socket of their own.
+class Peers {
+public:
+    Peers()
+    {
+        int data_sockets[2];
+        int fd_passing_sockets[2];
+        MUST(Core::System::socketpair(AF_LOCAL, SOCK_STREAM, 0, data_sockets));
+        MUST(Core::System::socketpair(AF_LOCAL, SOCK_STREAM, 0, fd_passing_sockets));
+        for (size_t i = 0; i < 2; ++i) {
+            m_data_sockets[i] = MUST(Core::LocalSocket::adopt_fd(data_sockets[i]));
+            m_fd_passing_sockets[i] = MUST(Core::LocalSocket::adopt_fd(fd_passing_sockets[i]));
+        }
+    }
+
+    template<typename T>
+    ErrorOr<void> post(size_t from, T const& value)
+    {
+        IPC::MessageBuffer buffer;
+        IPC::Encoder encoder { buffer, &m_pools[from] };
+        TRY(encoder.encode(value));
+        TRY(buffer.transfer_message(*m_fd_passing_sockets[from], *m_data_sockets[from]));
+        return {};
+    }
+
+    template<typename T>
+    ErrorOr<T> receive(size_t to)
+    {
+        auto size = TRY(m_data_sockets[to]->read_value<u32>());
+        auto message = TRY(ByteBuffer::create_uninitialized(size));
+        TRY(m_data_sockets[to]->read_until_filled(message.bytes()));
+
+        FixedMemoryStream stream { message.bytes() };
+        IPC::Decoder decoder { stream, *m_fd_passing_sockets[to] };
+        auto result = TRY(decoder.decode<T>());
+        if (!stream.is_eof())
+            return Error::from_string_literal("Message was not fully decoded");
+        return result;
+    }
+
+    template<typename T>
+    ErrorOr<T> send(size_t from, T const& value)
+    {
+        TRY(post(from, value));
+        return receive<T>(1 - from);
+    }
+
+    IPC::SharedBufferPool& pool(size_t side) { return m_pools[side]; }
+
+private:
+    OwnPtr<Core::LocalSocket> m_data_sockets[2];
+    OwnPtr<Core::LocalSocket> m_fd_passing_sockets[2];
+    IPC::SharedBufferPool m_pools[2];
+};
+
+static ByteBuffer make_payload(size_t size, u8 seed)
+{
+    auto buffer = MUST(ByteBuffer::create_uninitialized(size));
+    for (size_t i = 0; i < size; ++i)
+        buffer[i] = static_cast<u8>(i * 31 + seed);
+    return buffer;
+}
+
+TEST_CASE(small_payloads_stay_in_the_message)
+{
+    Peers peers;
+    auto payload = make_payload(IPC::SharedBufferPool::minimum_payload_size - 1, 1);
+    EXPECT_EQ(MUST(peers.send(0, payload)), payload);
+    EXPECT_EQ(peers.pool(0).buffer_count(), 0u);
+}
+
+TEST_CASE(large_payloads)
+{
+    Peers peers;
+
+    auto byte_buffer = make_payload(IPC::SharedBufferPool::minimum_payload_size, 2);
+    EXPECT_EQ(MUST(peers.send(0, byte_buffer)), byte_buffer);
+
+    auto byte_string = ByteString::repeated('a', 300 * KiB);
+    EXPECT_EQ(MUST(peers.send(0, byte_string)), byte_string);
+
+    auto string = MUST(String::repeated(0x1F600, 100 * KiB));
+    EXPECT_EQ(MUST(peers.send(0, string)), string);
+
+    // Large payloads can be mixed with anything else.
+    Vector<ByteBuffer> buffers { make_payload(16, 3), make_payload(1 * MiB, 4), make_payload(100 * KiB, 5) };
+    EXPECT_EQ(MUST(peers.send(0, buffers)), buffers);
+}
+
+TEST_CASE(one_way_traffic_reuses_buffers)
+{
+    Peers peers;
+
+    for (u8 i = 0; i < 10; ++i) {
+        auto payload = make_payload(200 * KiB, i);
+        EXPECT_EQ(MUST(peers.send(0, payload)), payload);
+        EXPECT_EQ(peers.pool(0).buffer_count(), 1u);
+        EXPECT_EQ(peers.pool(0).free_buffer_count(), 1u);
+    }
+    EXPECT_EQ(peers.pool(1).buffer_count(), 0u);
+
+    // Smaller payloads fit into the same buffer, a larger one needs a new buffer.
+    auto smaller_payload = make_payload(100 * KiB, 10);
+    EXPECT_EQ(MUST(peers.send(0, smaller_payload)), smaller_payload);
+    EXPECT_EQ(peers.pool(0).buffer_count(), 1u);
+
+    auto larger_payload = make_payload(2 * MiB, 11);
+    EXPECT_EQ(MUST(peers.send(0, larger_payload)), larger_payload);
+    EXPECT_EQ(peers.pool(0).buffer_count(), 2u);
+}
+
+TEST_CASE(buffers_are_reused_only_once_released)
+{
+    Peers peers;
+
+    // None of these were read yet, so each one needs a buffer of its own.
+    Vector<ByteBuffer> payloads;
+    for (u8 i = 0; i < 6; ++i) {
+        payloads.append(make_payload(100 * KiB, i));
+        MUST(peers.post(0, payloads.last()));
+    }
+    // Beyond the size of the pool, buffers are only used once.
+    EXPECT_EQ(peers.pool(0).buffer_count(), 4u);
+    EXPECT_EQ(peers.pool(0).free_buffer_count(), 0u);
+
+    for (auto& payload : payloads)
+        EXPECT_EQ(MUST(peers.receive<ByteBuffer>(1)), payload);
+    EXPECT_EQ(peers.pool(0).free_buffer_count(), 4u);
+
+    auto payload = make_payload(100 * KiB, 6);
+    EXPECT_EQ(MUST(peers.send(0, payload)), payload);
+    EXPECT_EQ(peers.pool(0).buffer_count(), 4u);
+}
+
+TEST_CASE(both_directions)
+{
+    Peers peers;
+
+    auto request = make_payload(200 * KiB, 7);
+    EXPECT_EQ(MUST(peers.send(0, request)), request);
+    auto response = make_payload(150 * KiB, 8);
+    EXPECT_EQ(MUST(peers.send(1, response)), response);
+
+    // Each side sends its payloads in buffers of its own.
+    EXPECT_EQ(peers.pool(0).buffer_count(), 1u);
+    EXPECT_EQ(peers.pool(1).buffer_count(), 1u);
+}
@@ -1077,6 +1077,49 @@ TEST_CASE(optimizer_alternation)
     }
 }
 
+TEST_CASE(optimizer_required_literals)
+{
+    struct Test {
+        StringView pattern;
+        Vector<StringView> literals;
+        bool matches_start_with_literal;
+    };
+    Array tests {
+        Test { "foo.*bar"sv, { "foo"sv }, true },
+        Test { "ERROR|WARN"sv, { "WARN"sv, "ERROR"sv }, true },
+        Test { "(warning|error): request"sv, { ": request"sv }, false },
+        Test { "[0-9]+ms"sv, { "ms"sv }, false },
+        Test { "status 503"sv, { "status 503"sv }, true },
+        Test { "a|b*"sv, {}, false },
+        // Lookarounds can look outside of the match.
+        Test { "(?<=foo)bar"sv, {}, false },
+    };
+
+    for (auto& test : tests) {
+        Regex<ECMA262> re(test.pattern);
+        auto const& optimization_data = re.parser_result.optimization_data;
+        EXPECT_EQ(optimization_data.required_literals.size(), test.literals.size());
+        for (size_t i = 0; i < min(optimization_data.required_literals.size(), test.literals.size()); ++i)
+            EXPECT_EQ(optimization_data.required_literals[i], test.literals[i]);
+        EXPECT_EQ(optimization_data.matches_start_with_required_literal, test.matches_start_with_literal);
+    }
+
+    {
+        Regex<PosixExtended> re("ERROR|WARN", PosixFlags::Insensitive | PosixFlags::Global);
+        auto result = re.match("info: ok\nwarn: slow\nError: broken"sv);
+        EXPECT_EQ(result.count, 2u);
+        EXPECT_EQ(result.matches[0].view.string_view(), "warn"sv);
+        EXPECT_EQ(result.matches[1].view.string_view(), "Error"sv);
+    }
+    {
+        Regex<PosixExtended> re("[0-9]+ms", PosixFlags::Global);
+        auto result = re.match("took 12ms, then 345ms"sv);
+        EXPECT_EQ(result.count, 2u);
+        EXPECT_EQ(result.matches[0].view.string_view(), "12ms"sv);
+        EXPECT_EQ(result.matches[1].view.string_view(), "345ms"sv);
+    }
+}
+
 TEST_CASE(posix_basic_dollar_is_end_anchor)
 {
     // Ensure that a dollar sign at the end only matches the end of the line.
@@ -1196,3 +1239,51 @@ TEST_CASE(mismatching_brackets)
         EXPECT_EQ(re.parser_result.error, regex::Error::MismatchingBracket);
     }
 }
+
+TEST_CASE(lazy_dfa_finds_the_same_match_as_the_vm)
+{
+    // Alternatives and quantifiers keep their priority, so the leftmost-first match is found.
+    Tuple<StringView, StringView, StringView> patterns[] = {
+        { "abc|abd|ab"sv, "zzabdzz"sv, "abd"sv },
+        { "ab|abc"sv, "abc"sv, "ab"sv },
+        { "a+?b*"sv, "aaabb"sv, "a"sv },
+        { "(?:a|ab)(?:c|bcd)"sv, "abcd"sv, "abcd"sv },
+        { "\\bfoo\\w*"sv, "afoo foobar"sv, "foobar"sv },
+        { "^b.*$"sv, "a\nbcd\ne"sv, "bcd"sv },
+    };
+
+    for (auto& pattern : patterns) {
+        Regex<ECMA262> re(pattern.get<0>(), ECMAScriptFlags::Multiline);
+        auto result = re.match(pattern.get<1>());
+        EXPECT_EQ(result.success, true);
+        if (result.success)
+            EXPECT_EQ(result.matches.first().view.string_view(), pattern.get<2>());
+    }
+}
+
+TEST_CASE(lazy_dfa_leaves_capture_groups_to_the_vm)
+{
+    Regex<ECMA262> re("(a|ab)(c|bcd)(d*)", ECMAScriptFlags::Global);
+    auto result = re.match("xabcdx abcx"sv);
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.count, 2u);
+    EXPECT_EQ(result.capture_group_matches[0][0].view.string_view(), "a"sv);
+    EXPECT_EQ(result.capture_group_matches[0][1].view.string_view(), "bcd"sv);
+    EXPECT_EQ(result.capture_group_matches[1][0].view.string_view(), "ab"sv);
+    EXPECT_EQ(result.capture_group_matches[1][1].view.string_view(), "c"sv);
+}
+
+TEST_CASE(pathological_patterns_fail_quickly)
+{
+    Array patterns {
+        "(?:a|a)*b"sv,
+        "(a*)*b"sv,
+        "(?:a+)+$"sv,
+    };
+    auto input = ByteString::formatted("{}c", ByteString::repeated('a', 100));
+    for (auto& pattern : patterns) {
+        Regex<ECMA262> re(pattern);
+        EXPECT_EQ(re.match(input).success, false);
+        EXPECT_EQ(re.search(input).success, false);
+    }
+}
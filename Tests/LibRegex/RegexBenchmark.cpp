@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h> // import first, to prevent warning of VERIFY* redefinition
+
+#include <AK/ByteString.h>
+#include <AK/StringBuilder.h>
+#include <LibRegex/Regex.h>
+
+static ByteString const& log_lines()
+{
+    static ByteString lines = [] {
+        StringBuilder builder;
+        for (size_t i = 0; i < 100'000; ++i) {
+            if (i % 1000 == 999)
+                builder.appendff("[{:08}] error: request {} failed with status 503\n", i, i);
+            else
+                builder.appendff("[{:08}] info: request {} took {}ms\n", i, i, i % 97);
+        }
+        return builder.to_byte_string();
+    }();
+    return lines;
+}
+
+static Vector<RegexStringView> const& log_line_views()
+{
+    static Vector<RegexStringView> views = [] {
+        Vector<RegexStringView> views;
+        for (auto line : log_lines().split_view('\n'))
+            views.append(line);
+        return views;
+    }();
+    return views;
+}
+
+// Pathological patterns, these take exponential time in a backtracking matcher.
+
+BENCHMARK_CASE(nested_star_no_match)
+{
+    Regex<ECMA262> re("(a*)*b");
+    auto result = re.match(ByteString::repeated('a', 10'000));
+    EXPECT_EQ(result.success, false);
+}
+
+BENCHMARK_CASE(ambiguous_alternation_no_match)
+{
+    Regex<ECMA262> re("(?:a|a)*b");
+    auto result = re.match(ByteString::repeated('a', 10'000));
+    EXPECT_EQ(result.success, false);
+}
+
+BENCHMARK_CASE(nested_plus_anchored_no_match)
+{
+    Regex<ECMA262> re("(?:a+)+$");
+    auto result = re.match(ByteString::formatted("{}b", ByteString::repeated('a', 10'000)));
+    EXPECT_EQ(result.success, false);
+}
+
+BENCHMARK_CASE(nested_plus_search)
+{
+    Regex<PosixExtended> re("(a|aa)+c");
+    auto result = re.search(ByteString::repeated('a', 10'000));
+    EXPECT_EQ(result.success, false);
+}
+
+// grep-style searches through many lines.
+
+BENCHMARK_CASE(grep_literal_lines)
+{
+    Regex<PosixExtended> re("status 503");
+    size_t count = 0;
+    for (auto& line : log_line_views()) {
+        if (re.match(line, PosixFlags::Global).success)
+            ++count;
+    }
+    EXPECT_EQ(count, 100u);
+}
+
+BENCHMARK_CASE(grep_character_classes_lines)
+{
+    Regex<PosixExtended> re("error: [a-z]+ [0-9]+ failed");
+    size_t count = 0;
+    for (auto& line : log_line_views()) {
+        if (re.match(line, PosixFlags::Global).success)
+            ++count;
+    }
+    EXPECT_EQ(count, 100u);
+}
+
+BENCHMARK_CASE(grep_alternation_lines)
+{
+    Regex<PosixExtended> re("(warning|error|fatal): request");
+    size_t count = 0;
+    for (auto& line : log_line_views()) {
+        if (re.match(line, PosixFlags::Global).success)
+            ++count;
+    }
+    EXPECT_EQ(count, 100u);
+}
+
+BENCHMARK_CASE(grep_required_literal_lines)
+{
+    Regex<PosixExtended> re("request [0-9]+ failed with status 5[0-9][0-9]");
+    size_t count = 0;
+    for (auto& line : log_line_views()) {
+        if (re.match(line, PosixFlags::Global).success)
+            ++count;
+    }
+    EXPECT_EQ(count, 100u);
+}
+
+BENCHMARK_CASE(grep_case_insensitive_alternation_lines)
+{
+    Regex<PosixExtended> re("fatal|panic|ERROR", PosixFlags::Insensitive);
+    size_t count = 0;
+    for (auto& line : log_line_views()) {
+        if (re.match(line, PosixFlags::Global).success)
+            ++count;
+    }
+    EXPECT_EQ(count, 100u);
+}
+
+BENCHMARK_CASE(search_whole_file)
+{
+    Regex<PosixExtended> re("took [0-9]+ms");
+    auto result = re.search(log_lines());
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.count, 99'900u);
+}
+
+BENCHMARK_CASE(search_whole_file_with_captures)
+{
+    Regex<ECMA262> re("request ([0-9]+) failed", ECMAScriptFlags::Global);
+    auto result = re.match(log_lines());
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.count, 100u);
+    EXPECT_EQ(result.capture_group_matches.first().first().view.to_byte_string(), "999"sv);
+}
+
+// Backreferences always need the backtracking VM.
+
+BENCHMARK_CASE(search_whole_file_with_backreference)
+{
+    Regex<ECMA262> re("request (\\d+) took \\1ms", ECMAScriptFlags::Global);
+    auto result = re.match(log_lines());
+    EXPECT_EQ(result.success, true);
+}
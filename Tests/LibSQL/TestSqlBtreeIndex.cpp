@@ -123,6 +123,7 @@ constexpr static u32 pointers[] = {
 NonnullRefPtr<SQL::BTree> setup_btree(SQL::Serializer&);
 void insert_and_get_to_and_from_btree(int);
 void insert_into_and_scan_btree(int);
+void remove_from_btree(int);
 
 NonnullRefPtr<SQL::BTree> setup_btree(SQL::Serializer& serializer)
 {
@@ -223,6 +224,66 @@ void insert_into_and_scan_btree(int num_keys)
     }
 }
 
+void remove_from_btree(int num_keys)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto heap = MUST(SQL::Heap::create("/tmp/test.db"));
+        TRY_OR_FAIL(heap->open());
+        SQL::Serializer serializer(heap);
+        auto btree = setup_btree(serializer);
+
+        for (auto ix = 0; ix < num_keys; ix++) {
+            SQL::Key k(btree->descriptor());
+            k[0] = keys[ix];
+            k.set_block_index(pointers[ix]);
+            btree->insert(k);
+        }
+
+        // Remove every other key.
+        for (auto ix = 0; ix < num_keys; ix += 2) {
+            SQL::Key k(btree->descriptor());
+            k[0] = keys[ix];
+            EXPECT(btree->remove(k));
+            EXPECT(!btree->remove(k));
+        }
+    }
+
+    {
+        auto heap = MUST(SQL::Heap::create("/tmp/test.db"));
+        TRY_OR_FAIL(heap->open());
+        SQL::Serializer serializer(heap);
+        auto btree = setup_btree(serializer);
+
+        for (auto ix = 0; ix < num_keys; ix++) {
+            SQL::Key k(btree->descriptor());
+            k[0] = keys[ix];
+            auto pointer_opt = btree->get(k);
+            EXPECT_EQ(pointer_opt.has_value(), ix % 2 == 1);
+            if (pointer_opt.has_value())
+                EXPECT_EQ(pointer_opt.value(), pointers[ix]);
+        }
+
+        int count = 0;
+        SQL::Tuple prev;
+        for (auto iter = btree->begin(); !iter.is_end(); iter++, count++) {
+            auto key = (*iter);
+            if (prev.size())
+                EXPECT(prev < key);
+            prev = key;
+        }
+        EXPECT_EQ(count, num_keys / 2);
+
+        // Removing the remaining keys leaves an empty tree.
+        for (auto ix = 1; ix < num_keys; ix += 2) {
+            SQL::Key k(btree->descriptor());
+            k[0] = keys[ix];
+            EXPECT(btree->remove(k));
+        }
+        EXPECT(btree->begin().is_end());
+    }
+}
+
 TEST_CASE(btree_one_key)
 {
     insert_and_get_to_and_from_btree(1);
@@ -317,3 +378,51 @@ TEST_CASE(btree_scan_50_keys)
 {
     insert_into_and_scan_btree(50);
 }
+
+TEST_CASE(btree_remove_one_key)
+{
+    remove_from_btree(1);
+}
+
+TEST_CASE(btree_remove_10_keys)
+{
+    remove_from_btree(10);
+}
+
+TEST_CASE(btree_remove_50_keys)
+{
+    remove_from_btree(50);
+}
+
+TEST_CASE(btree_lower_bound)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    auto heap = MUST(SQL::Heap::create("/tmp/test.db"));
+    TRY_OR_FAIL(heap->open());
+    SQL::Serializer serializer(heap);
+    auto btree = setup_btree(serializer);
+
+    for (auto ix = 0; ix < 50; ix++) {
+        SQL::Key k(btree->descriptor());
+        k[0] = keys[ix];
+        k.set_block_index(pointers[ix]);
+        btree->insert(k);
+    }
+
+    for (auto value = 0; value <= 100; value++) {
+        SQL::Key k(btree->descriptor());
+        k[0] = value;
+
+        // The keys are unique integers between 1 and 98.
+        Optional<int> expected;
+        for (auto key : keys) {
+            if (key >= value && (!expected.has_value() || key < *expected))
+                expected = key;
+        }
+
+        auto iter = btree->lower_bound(k);
+        EXPECT_EQ(iter.is_end(), !expected.has_value());
+        if (!iter.is_end() && expected.has_value())
+            EXPECT_EQ((*iter)[0].to_int<i32>(), *expected);
+    }
+}
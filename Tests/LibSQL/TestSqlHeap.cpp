@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Random.h>
 #include <AK/ScopeGuard.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/System.h>
@@ -192,3 +193,112 @@ TEST_CASE(heap_free_storage)
     auto new_heap_size = MUST(heap->file_size_in_bytes());
     EXPECT(new_heap_size <= heap_size);
 }
+
+static constexpr size_t small_buffer_pool_capacity = 4;
+
+static NonnullRefPtr<SQL::Heap> create_heap_with_small_buffer_pool()
+{
+    auto heap = MUST(SQL::Heap::create(db_path, small_buffer_pool_capacity));
+    MUST(heap->open());
+    return heap;
+}
+
+static ByteString storage_contents(size_t storage)
+{
+    return ByteString::formatted("Storage #{} {}", storage, ByteString::repeated('x', storage % SQL::Block::DATA_SIZE));
+}
+
+TEST_CASE(heap_buffer_pool_evicts_dirty_blocks)
+{
+    ScopeGuard guard([]() { MUST(Core::System::unlink(db_path)); });
+    auto heap = create_heap_with_small_buffer_pool();
+
+    // Write many more blocks than fit in the buffer pool, without flushing
+    Vector<SQL::Block::Index> storage_block_ids;
+    for (size_t storage = 0; storage < 64; ++storage) {
+        auto storage_block_id = heap->request_new_block_index();
+        TRY_OR_FAIL(heap->write_storage(storage_block_id, storage_contents(storage).bytes()));
+        storage_block_ids.append(storage_block_id);
+    }
+    EXPECT(heap->buffer_pool_statistics().evictions > 0);
+    EXPECT(heap->buffer_pool_statistics().write_backs > 0);
+
+    // Read back in a different order
+    for (size_t storage = storage_block_ids.size(); storage > 0; --storage) {
+        auto stored = TRY_OR_FAIL(heap->read_storage(storage_block_ids[storage - 1]));
+        EXPECT_EQ(stored.bytes(), storage_contents(storage - 1).bytes());
+    }
+}
+
+TEST_CASE(heap_buffer_pool_survives_reopening_file)
+{
+    ScopeGuard guard([]() { MUST(Core::System::unlink(db_path)); });
+
+    Vector<SQL::Block::Index> storage_block_ids;
+    {
+        auto heap = create_heap_with_small_buffer_pool();
+        for (size_t storage = 0; storage < 32; ++storage) {
+            auto storage_block_id = heap->request_new_block_index();
+            TRY_OR_FAIL(heap->write_storage(storage_block_id, storage_contents(storage).bytes()));
+            storage_block_ids.append(storage_block_id);
+        }
+
+        // Overwrite some of the blocks that were already written back to the file
+        for (size_t storage = 0; storage < 32; storage += 3)
+            TRY_OR_FAIL(heap->write_storage(storage_block_ids[storage], storage_contents(storage + 100).bytes()));
+        MUST(heap->flush());
+    }
+
+    auto heap = create_heap_with_small_buffer_pool();
+    for (size_t storage = 0; storage < 32; ++storage) {
+        auto expected = storage_contents(storage % 3 == 0 ? storage + 100 : storage);
+        auto stored = TRY_OR_FAIL(heap->read_storage(storage_block_ids[storage]));
+        EXPECT_EQ(stored.bytes(), expected.bytes());
+    }
+}
+
+TEST_CASE(heap_buffer_pool_hits)
+{
+    ScopeGuard guard([]() { MUST(Core::System::unlink(db_path)); });
+    auto heap = create_heap_with_small_buffer_pool();
+
+    auto storage_block_id = heap->request_new_block_index();
+    TRY_OR_FAIL(heap->write_storage(storage_block_id, "Hello, friends!"sv.bytes()));
+    MUST(heap->flush());
+
+    auto statistics_before = heap->buffer_pool_statistics();
+    (void)TRY_OR_FAIL(heap->read_storage(storage_block_id));
+    (void)TRY_OR_FAIL(heap->read_storage(storage_block_id));
+
+    auto const& statistics_after = heap->buffer_pool_statistics();
+    EXPECT_EQ(statistics_after.hits - statistics_before.hits, 2u);
+    EXPECT_EQ(statistics_after.misses, statistics_before.misses);
+}
+
+BENCHMARK_CASE(heap_random_reads_larger_than_buffer_pool)
+{
+    static constexpr size_t buffer_pool_capacity = 64;
+    static constexpr size_t storage_count = 16 * buffer_pool_capacity;
+
+    ScopeGuard guard([]() { MUST(Core::System::unlink(db_path)); });
+    auto heap = MUST(SQL::Heap::create(db_path, buffer_pool_capacity));
+    MUST(heap->open());
+
+    Vector<SQL::Block::Index> storage_block_ids;
+    for (size_t storage = 0; storage < storage_count; ++storage) {
+        auto storage_block_id = heap->request_new_block_index();
+        TRY_OR_FAIL(heap->write_storage(storage_block_id, storage_contents(storage).bytes()));
+        storage_block_ids.append(storage_block_id);
+    }
+    MUST(heap->flush());
+
+    // Reads are skewed towards the first blocks, the way B-tree roots and small tables are read more often.
+    for (size_t read = 0; read < 100'000; ++read) {
+        auto storage = get_random_uniform(storage_count);
+        if (read % 2 == 0)
+            storage %= buffer_pool_capacity / 2;
+
+        auto stored = TRY_OR_FAIL(heap->read_storage(storage_block_ids[storage]));
+        EXPECT_EQ(stored.size(), storage_contents(storage).length());
+    }
+}
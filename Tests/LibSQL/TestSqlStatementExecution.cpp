@@ -9,6 +9,7 @@
 
 #include <AK/QuickSort.h>
 #include <AK/ScopeGuard.h>
+#include <LibSQL/AST/Operator.h>
 #include <LibSQL/AST/Parser.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Result.h>
@@ -1060,4 +1061,346 @@ TEST_CASE(update_all_rows)
     }
 }
 
+TEST_CASE(create_index)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = MUST(SQL::Database::create(db_name));
+    MUST(database->open());
+    create_table(database);
+
+    auto result = try_execute(database, "CREATE INDEX TestIndex ON TestTable (IntColumn);");
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.release_error().error(), SQL::SQLErrorCode::TableDoesNotExist);
+
+    result = try_execute(database, "CREATE INDEX TestSchema.TestIndex ON TestTable (NoSuchColumn);");
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.release_error().error(), SQL::SQLErrorCode::ColumnDoesNotExist);
+
+    auto create_result = execute(database, "CREATE INDEX TestSchema.TestIndex ON TestTable (IntColumn);");
+    EXPECT_EQ(create_result.command(), SQL::SQLCommand::Create);
+
+    result = try_execute(database, "CREATE INDEX TestSchema.TestIndex ON TestTable (TextColumn);");
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.release_error().error(), SQL::SQLErrorCode::IndexExists);
+    execute(database, "CREATE INDEX IF NOT EXISTS TestSchema.TestIndex ON TestTable (TextColumn);");
+
+    auto index = MUST(database->get_index("TESTSCHEMA", "TESTINDEX"));
+    EXPECT_EQ(index->size(), 1u);
+    EXPECT_EQ(index->key_definition()[0]->name(), "INTCOLUMN");
+}
+
+TEST_CASE(select_through_index)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    {
+        auto database = MUST(SQL::Database::create(db_name));
+        MUST(database->open());
+        create_table(database);
+
+        // Create the index on a table with rows in it, then add more rows.
+        for (auto count = 0; count < 50; count += 2)
+            execute(database, ByteString::formatted("INSERT INTO TestSchema.TestTable VALUES ( 'T{}', {} );", count, count));
+        execute(database, "CREATE INDEX TestSchema.TestIndex ON TestTable (IntColumn);");
+        for (auto count = 49; count > 0; count -= 2)
+            execute(database, ByteString::formatted("INSERT INTO TestSchema.TestTable VALUES ( 'T{}', {} );", count, count));
+
+        auto result = execute(database, "SELECT TextColumn FROM TestSchema.TestTable WHERE IntColumn = 17;");
+        EXPECT_EQ(result.size(), 1u);
+        EXPECT_EQ(result[0].row[0].to_byte_string(), "T17");
+
+        result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE (20 <= IntColumn) AND (IntColumn < 30) ORDER BY IntColumn;");
+        EXPECT_EQ(result.size(), 10u);
+        for (auto i = 0u; i < result.size(); ++i)
+            EXPECT_EQ(result[i].row[0], 20 + i);
+
+        result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn > 45;");
+        EXPECT_EQ(result.size(), 4u);
+
+        result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn = ?;", placeholders(42));
+        EXPECT_EQ(result.size(), 1u);
+        EXPECT_EQ(result[0].row[0], 42);
+    }
+    {
+        auto database = MUST(SQL::Database::create(db_name));
+        MUST(database->open());
+
+        auto result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable ORDER BY IntColumn;");
+        EXPECT_EQ(result.size(), 50u);
+        for (auto i = 0u; i < result.size(); ++i)
+            EXPECT_EQ(result[i].row[0], i);
+
+        result = execute(database, "SELECT TextColumn FROM TestSchema.TestTable WHERE IntColumn = 33;");
+        EXPECT_EQ(result.size(), 1u);
+        EXPECT_EQ(result[0].row[0].to_byte_string(), "T33");
+    }
+}
+
+TEST_CASE(index_is_maintained_on_update_and_delete)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = MUST(SQL::Database::create(db_name));
+    MUST(database->open());
+    create_table(database);
+
+    execute(database, "CREATE INDEX TestSchema.TestIndex ON TestTable (IntColumn);");
+    for (auto count = 0; count < 20; ++count)
+        execute(database, ByteString::formatted("INSERT INTO TestSchema.TestTable VALUES ( 'T{}', {} );", count, count));
+
+    execute(database, "UPDATE TestSchema.TestTable SET IntColumn=100 WHERE IntColumn < 5;");
+    execute(database, "DELETE FROM TestSchema.TestTable WHERE (IntColumn >= 15) AND (IntColumn < 100);");
+
+    auto result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn < 5;");
+    EXPECT(result.is_empty());
+
+    result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn = 100;");
+    EXPECT_EQ(result.size(), 5u);
+
+    result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn >= 0 ORDER BY IntColumn;");
+    EXPECT_EQ(result.size(), 15u);
+    for (auto i = 0u; i < 10; ++i)
+        EXPECT_EQ(result[i].row[0], 5 + i);
+    for (auto i = 10u; i < result.size(); ++i)
+        EXPECT_EQ(result[i].row[0], 100);
+
+    execute(database, "DELETE FROM TestSchema.TestTable;");
+    result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn >= 0;");
+    EXPECT(result.is_empty());
+}
+
+TEST_CASE(unique_index)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = MUST(SQL::Database::create(db_name));
+    MUST(database->open());
+    create_table(database);
+
+    execute(database, "INSERT INTO TestSchema.TestTable VALUES ( 'T1', 1 ), ( 'T2', 1 );");
+
+    auto result = try_execute(database, "CREATE UNIQUE INDEX TestSchema.TestIndex ON TestTable (IntColumn);");
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.release_error().error(), SQL::SQLErrorCode::UniqueConstraintViolated);
+    EXPECT(database->get_index("TESTSCHEMA", "TESTINDEX").is_error());
+
+    execute(database, "CREATE UNIQUE INDEX TestSchema.TestIndex ON TestTable (TextColumn);");
+
+    result = try_execute(database, "INSERT INTO TestSchema.TestTable VALUES ( 'T1', 3 );");
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.release_error().error(), SQL::SQLErrorCode::UniqueConstraintViolated);
+
+    result = try_execute(database, "UPDATE TestSchema.TestTable SET TextColumn='T1' WHERE TextColumn = 'T2';");
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.release_error().error(), SQL::SQLErrorCode::UniqueConstraintViolated);
+
+    // Updating a row without changing its unique column is fine.
+    execute(database, "UPDATE TestSchema.TestTable SET IntColumn=2 WHERE TextColumn = 'T2';");
+
+    auto select_result = execute(database, "SELECT TextColumn, IntColumn FROM TestSchema.TestTable ORDER BY TextColumn;");
+    EXPECT_EQ(select_result.size(), 2u);
+    EXPECT_EQ(select_result[0].row[0].to_byte_string(), "T1");
+    EXPECT_EQ(select_result[0].row[1], 1);
+    EXPECT_EQ(select_result[1].row[0].to_byte_string(), "T2");
+    EXPECT_EQ(select_result[1].row[1], 2);
+}
+
+TEST_CASE(drop_index)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = MUST(SQL::Database::create(db_name));
+    MUST(database->open());
+    create_table(database);
+
+    execute(database, "CREATE INDEX TestSchema.TestIndex ON TestTable (IntColumn);");
+    execute(database, "INSERT INTO TestSchema.TestTable VALUES ( 'T1', 1 );");
+
+    auto result = execute(database, "DROP INDEX TestSchema.TestIndex;");
+    EXPECT_EQ(result.command(), SQL::SQLCommand::Drop);
+    EXPECT(database->get_index("TESTSCHEMA", "TESTINDEX").is_error());
+
+    auto drop_result = try_execute(database, "DROP INDEX TestSchema.TestIndex;");
+    EXPECT(drop_result.is_error());
+    EXPECT_EQ(drop_result.release_error().error(), SQL::SQLErrorCode::IndexDoesNotExist);
+    execute(database, "DROP INDEX IF EXISTS TestSchema.TestIndex;");
+
+    result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn = 1;");
+    EXPECT_EQ(result.size(), 1u);
+
+    // The name can be used again once the index is gone.
+    execute(database, "CREATE INDEX TestSchema.TestIndex ON TestTable (IntColumn);");
+    result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn = 1;");
+    EXPECT_EQ(result.size(), 1u);
+}
+
+TEST_CASE(explain)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = MUST(SQL::Database::create(db_name));
+    MUST(database->open());
+    create_table(database);
+
+    auto explain = [&](StringView sql) {
+        auto result = execute(database, sql);
+        EXPECT_EQ(result.command(), SQL::SQLCommand::Explain);
+
+        Vector<ByteString> lines;
+        for (auto const& row : result)
+            lines.append(row.row[0].to_byte_string());
+        return ByteString::join('\n', lines);
+    };
+
+    EXPECT_EQ(explain("EXPLAIN SELECT * FROM TestSchema.TestTable WHERE IntColumn = 1;"sv), "SCAN TESTTABLE");
+
+    execute(database, "CREATE INDEX TestSchema.IntIndex ON TestTable (IntColumn);");
+    execute(database, "CREATE UNIQUE INDEX TestSchema.TextIndex ON TestTable (TextColumn, IntColumn);");
+
+    EXPECT_EQ(explain("EXPLAIN SELECT * FROM TestSchema.TestTable;"sv), "SCAN TESTTABLE");
+    EXPECT_EQ(explain("EXPLAIN SELECT * FROM TestSchema.TestTable WHERE IntColumn = 1;"sv), "SEARCH TESTTABLE USING INDEX INTINDEX (INTCOLUMN=?)");
+    EXPECT_EQ(explain("EXPLAIN QUERY PLAN SELECT * FROM TestSchema.TestTable WHERE (IntColumn > 1) AND (IntColumn <= 5);"sv), "SEARCH TESTTABLE USING INDEX INTINDEX (INTCOLUMN>? AND INTCOLUMN<=?)");
+    EXPECT_EQ(explain("EXPLAIN SELECT * FROM TestSchema.TestTable WHERE (TextColumn = 'T') AND (IntColumn = 1);"sv), "SEARCH TESTTABLE USING INDEX TEXTINDEX (TEXTCOLUMN=? AND INTCOLUMN=?)");
+    EXPECT_EQ(explain("EXPLAIN SELECT * FROM TestSchema.TestTable WHERE TextColumn = 'T' ORDER BY IntColumn;"sv), "SEARCH TESTTABLE USING INDEX TEXTINDEX (TEXTCOLUMN=?)");
+    EXPECT_EQ(explain("EXPLAIN SELECT * FROM TestSchema.TestTable ORDER BY IntColumn;"sv), "SCAN TESTTABLE USING INDEX INTINDEX");
+    EXPECT_EQ(explain("EXPLAIN SELECT * FROM TestSchema.TestTable ORDER BY IntColumn DESC;"sv), "SCAN TESTTABLE\nUSE TEMP B-TREE FOR ORDER BY");
+    EXPECT_EQ(explain("EXPLAIN SELECT * FROM TestSchema.TestTable WHERE (IntColumn = 1) OR (IntColumn = 2);"sv), "SCAN TESTTABLE");
+    EXPECT_EQ(explain("EXPLAIN UPDATE TestSchema.TestTable SET IntColumn = 2 WHERE IntColumn < 1;"sv), "SEARCH TESTTABLE USING INDEX INTINDEX (INTCOLUMN<?)");
+    EXPECT_EQ(explain("EXPLAIN DELETE FROM TestSchema.TestTable WHERE TextColumn = 'T';"sv), "SEARCH TESTTABLE USING INDEX TEXTINDEX (TEXTCOLUMN=?)");
+
+    auto result = try_execute(database, "EXPLAIN INSERT INTO TestSchema.TestTable VALUES ( 'T', 1 );");
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.release_error().error(), SQL::SQLErrorCode::NotYetImplemented);
+}
+
+
+TEST_CASE(join_tables)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = MUST(SQL::Database::create(db_name));
+    MUST(database->open());
+    create_two_tables(database);
+    execute(database,
+        "INSERT INTO TestSchema.TestTable1 ( TextColumn1, IntColumn ) VALUES "
+        "( 'A', 1 ), ( 'B', 2 ), ( 'C', 2 ), ( 'D', 5 ), ( 'E', 3 );");
+    execute(database,
+        "INSERT INTO TestSchema.TestTable2 ( TextColumn2, IntColumn ) VALUES "
+        "( 'V', 4 ), ( 'W', 6 ), ( 'X', 2 ), ( 'Y', 2 ), ( 'Z', 3 );");
+
+    auto select_joined = [&](StringView where_clause) {
+        auto result = execute(database,
+            ByteString::formatted("SELECT TextColumn1, TextColumn2 FROM TestSchema.TestTable1, TestSchema.TestTable2 WHERE {} ORDER BY TextColumn1, TextColumn2;", where_clause));
+
+        Vector<ByteString> rows;
+        for (auto const& row : result)
+            rows.append(ByteString::formatted("{}{}", row.row[0].to_byte_string(), row.row[1].to_byte_string()));
+        return ByteString::join(',', rows);
+    };
+
+    auto check_results = [&]() {
+        EXPECT_EQ(select_joined("TestTable1.IntColumn = TestTable2.IntColumn"sv), "BX,BY,CX,CY,EZ");
+        EXPECT_EQ(select_joined("TestTable2.IntColumn = TestTable1.IntColumn"sv), "BX,BY,CX,CY,EZ");
+        EXPECT_EQ(select_joined("(TestTable1.IntColumn = TestTable2.IntColumn) AND (TextColumn2 != 'Y')"sv), "BX,CX,EZ");
+        EXPECT_EQ(select_joined("(TextColumn1 = 'C') AND (TestTable1.IntColumn = TestTable2.IntColumn)"sv), "CX,CY");
+        EXPECT_EQ(select_joined("(TestTable1.IntColumn = TestTable2.IntColumn) AND ((TextColumn1 = 'B') OR (TextColumn2 = 'Z'))"sv), "BX,BY,EZ");
+        EXPECT_EQ(select_joined("(TestTable1.IntColumn < TestTable2.IntColumn) AND (TextColumn2 = 'Z')"sv), "AZ,BZ,CZ");
+    };
+
+    check_results();
+
+    execute(database, "CREATE INDEX TestSchema.IntIndex2 ON TestTable2 (IntColumn);");
+    check_results();
+
+    execute(database, "CREATE INDEX TestSchema.TextIndex1 ON TestTable1 (TextColumn1);");
+    check_results();
+}
+
+TEST_CASE(explain_join)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = MUST(SQL::Database::create(db_name));
+    MUST(database->open());
+    create_two_tables(database);
+
+    auto explain = [&](StringView sql) {
+        auto result = execute(database, sql);
+
+        Vector<ByteString> lines;
+        for (auto const& row : result)
+            lines.append(row.row[0].to_byte_string());
+        return ByteString::join('\n', lines);
+    };
+
+    EXPECT_EQ(explain("EXPLAIN SELECT * FROM TestSchema.TestTable1, TestSchema.TestTable2;"sv), "SCAN TESTTABLE1\nSCAN TESTTABLE2");
+    EXPECT_EQ(explain("EXPLAIN SELECT * FROM TestSchema.TestTable1, TestSchema.TestTable2 WHERE TestTable1.IntColumn = TestTable2.IntColumn;"sv),
+        "SCAN TESTTABLE1\nSCAN TESTTABLE2\nUSE HASH TABLE FOR JOIN OF TESTTABLE2 (INTCOLUMN=?)");
+
+    execute(database, "CREATE INDEX TestSchema.IntIndex2 ON TestTable2 (IntColumn);");
+    execute(database, "CREATE INDEX TestSchema.TextIndex1 ON TestTable1 (TextColumn1);");
+
+    EXPECT_EQ(explain("EXPLAIN SELECT * FROM TestSchema.TestTable1, TestSchema.TestTable2 WHERE TestTable1.IntColumn = TestTable2.IntColumn;"sv),
+        "SCAN TESTTABLE1\nSEARCH TESTTABLE2 USING INDEX INTINDEX2 (INTCOLUMN=?)");
+    EXPECT_EQ(explain("EXPLAIN SELECT * FROM TestSchema.TestTable1, TestSchema.TestTable2 WHERE (TestTable1.IntColumn = TestTable2.IntColumn) AND (TextColumn1 = 'A');"sv),
+        "SEARCH TESTTABLE1 USING INDEX TEXTINDEX1 (TEXTCOLUMN1=?)\nSEARCH TESTTABLE2 USING INDEX INTINDEX2 (INTCOLUMN=?)");
+
+    // The index can't be used for both the join and for evaluating the WHERE clause.
+    EXPECT_EQ(explain("EXPLAIN SELECT * FROM TestSchema.TestTable1, TestSchema.TestTable2 WHERE (TestTable1.IntColumn = TestTable2.IntColumn) AND (TestTable2.IntColumn > 2);"sv),
+        "SCAN TESTTABLE1\nSEARCH TESTTABLE2 USING INDEX INTINDEX2 (INTCOLUMN>?)\nUSE HASH TABLE FOR JOIN OF TESTTABLE2 (INTCOLUMN=?)");
+}
+
+
+TEST_CASE(limit_stops_reading_rows)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = MUST(SQL::Database::create(db_name));
+    MUST(database->open());
+    create_table(database);
+
+    // Rows are read starting with the most recently inserted one, so the row dividing by zero is read last.
+    for (auto count = 0; count < 10; count++)
+        execute(database, ByteString::formatted("INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Test_{}', {} );", count, count));
+
+    auto result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE (10 / IntColumn) > 0 LIMIT 3;");
+    EXPECT_EQ(result.size(), 3u);
+
+    auto failed_result = try_execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE (10 / IntColumn) > 0;");
+    EXPECT(failed_result.is_error());
+}
+
+TEST_CASE(select_with_cursor)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = MUST(SQL::Database::create(db_name));
+    MUST(database->open());
+    create_table(database);
+
+    for (auto count = 0; count < 50; count++)
+        execute(database, ByteString::formatted("INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Test_{}', {} );", count, count));
+
+    auto open_cursor = [&](StringView sql) {
+        auto parser = SQL::AST::Parser(SQL::AST::Lexer(sql));
+        auto statement = parser.next_statement();
+        EXPECT(!parser.has_errors());
+        EXPECT(is<SQL::AST::Select>(*statement));
+
+        auto select = static_ptr_cast<SQL::AST::Select const>(statement);
+        return MUST(SQL::AST::Cursor::create(database, move(select), placeholders(20)));
+    };
+
+    auto cursor = open_cursor("SELECT TextColumn, IntColumn FROM TestSchema.TestTable WHERE IntColumn >= ? ORDER BY IntColumn;"sv);
+    EXPECT_EQ(cursor->column_names().size(), 2u);
+    EXPECT_EQ(cursor->column_names()[0], "TEXTCOLUMN");
+
+    for (auto count = 20; count < 50; count++) {
+        auto row = MUST(cursor->next());
+        EXPECT(row.has_value());
+        EXPECT_EQ(row->size(), 2u);
+        EXPECT_EQ((*row)[0].to_byte_string(), ByteString::formatted("Test_{}", count));
+        EXPECT_EQ((*row)[1].to_int<i32>(), count);
+    }
+
+    EXPECT(!MUST(cursor->next()).has_value());
+    EXPECT(!MUST(cursor->next()).has_value());
+
+    cursor = open_cursor("SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn < ? LIMIT 5 OFFSET 10;"sv);
+    for (auto count = 0; count < 5; count++)
+        EXPECT(MUST(cursor->next()).has_value());
+    EXPECT(!MUST(cursor->next()).has_value());
+}
+
 }
@@ -277,6 +277,62 @@ TEST_CASE(drop_table)
     validate("DROP TABLE IF EXISTS test;"sv, {}, "TEST"sv, false);
 }
 
+TEST_CASE(create_index)
+{
+    EXPECT(parse("CREATE INDEX"sv).is_error());
+    EXPECT(parse("CREATE INDEX test"sv).is_error());
+    EXPECT(parse("CREATE INDEX test ON"sv).is_error());
+    EXPECT(parse("CREATE INDEX test ON table_name"sv).is_error());
+    EXPECT(parse("CREATE INDEX test ON table_name ()"sv).is_error());
+    EXPECT(parse("CREATE INDEX test ON table_name (column_name)"sv).is_error());
+    EXPECT(parse("CREATE INDEX test ON table_name (column_name DESC);"sv).is_error());
+    EXPECT(parse("CREATE UNIQUE test ON table_name (column_name);"sv).is_error());
+    EXPECT(parse("CREATE INDEX IF test ON table_name (column_name);"sv).is_error());
+
+    auto validate = [](StringView sql, StringView expected_schema, StringView expected_index, StringView expected_table, Vector<StringView> expected_columns, bool expected_is_unique = false, bool expected_is_error_if_index_exists = true) {
+        auto statement = TRY_OR_FAIL(parse(sql));
+        EXPECT(is<SQL::AST::CreateIndex>(*statement));
+
+        const auto& index = static_cast<const SQL::AST::CreateIndex&>(*statement);
+        EXPECT_EQ(index.schema_name(), expected_schema);
+        EXPECT_EQ(index.index_name(), expected_index);
+        EXPECT_EQ(index.table_name(), expected_table);
+        EXPECT_EQ(index.is_unique(), expected_is_unique);
+        EXPECT_EQ(index.is_error_if_index_exists(), expected_is_error_if_index_exists);
+
+        const auto& columns = index.column_names();
+        EXPECT_EQ(columns.size(), expected_columns.size());
+        for (size_t i = 0; i < columns.size(); ++i)
+            EXPECT_EQ(columns[i], expected_columns[i]);
+    };
+
+    validate("CREATE INDEX test ON table_name (column_name);"sv, {}, "TEST"sv, "TABLE_NAME"sv, { "COLUMN_NAME"sv });
+    validate("CREATE INDEX schema_name.test ON table_name (column1, column2 ASC);"sv, "SCHEMA_NAME"sv, "TEST"sv, "TABLE_NAME"sv, { "COLUMN1"sv, "COLUMN2"sv });
+    validate("CREATE UNIQUE INDEX test ON table_name (column_name);"sv, {}, "TEST"sv, "TABLE_NAME"sv, { "COLUMN_NAME"sv }, true);
+    validate("CREATE INDEX IF NOT EXISTS test ON table_name (column_name);"sv, {}, "TEST"sv, "TABLE_NAME"sv, { "COLUMN_NAME"sv }, false, false);
+}
+
+TEST_CASE(drop_index)
+{
+    EXPECT(parse("DROP INDEX"sv).is_error());
+    EXPECT(parse("DROP INDEX test"sv).is_error());
+    EXPECT(parse("DROP INDEX IF test;"sv).is_error());
+
+    auto validate = [](StringView sql, StringView expected_schema, StringView expected_index, bool expected_is_error_if_index_does_not_exist = true) {
+        auto statement = TRY_OR_FAIL(parse(sql));
+        EXPECT(is<SQL::AST::DropIndex>(*statement));
+
+        const auto& index = static_cast<const SQL::AST::DropIndex&>(*statement);
+        EXPECT_EQ(index.schema_name(), expected_schema);
+        EXPECT_EQ(index.index_name(), expected_index);
+        EXPECT_EQ(index.is_error_if_index_does_not_exist(), expected_is_error_if_index_does_not_exist);
+    };
+
+    validate("DROP INDEX test;"sv, {}, "TEST"sv);
+    validate("DROP INDEX schema_name.test;"sv, "SCHEMA_NAME"sv, "TEST"sv);
+    validate("DROP INDEX IF EXISTS test;"sv, {}, "TEST"sv, false);
+}
+
 TEST_CASE(insert)
 {
     EXPECT(parse("INSERT"sv).is_error());
@@ -783,3 +839,22 @@ TEST_CASE(describe_table)
     validate("DESCRIBE TABLE TableName;"sv, {}, "TABLENAME"sv);
     validate("DESCRIBE TABLE SchemaName.TableName;"sv, "SCHEMANAME"sv, "TABLENAME"sv);
 }
+
+TEST_CASE(explain)
+{
+    EXPECT(parse("EXPLAIN"sv).is_error());
+    EXPECT(parse("EXPLAIN;"sv).is_error());
+    EXPECT(parse("EXPLAIN QUERY SELECT * FROM table_name;"sv).is_error());
+    EXPECT(parse("EXPLAIN SELECT * FROM table_name"sv).is_error());
+
+    auto validate = [](StringView sql) {
+        auto statement = TRY_OR_FAIL(parse(sql));
+        EXPECT(is<SQL::AST::Explain>(*statement));
+
+        const auto& explain = static_cast<const SQL::AST::Explain&>(*statement);
+        EXPECT(is<SQL::AST::Select>(*explain.statement()));
+    };
+
+    validate("EXPLAIN SELECT * FROM table_name;"sv);
+    validate("EXPLAIN QUERY PLAN SELECT * FROM table_name WHERE column_name = 1;"sv);
+}
@@ -8,6 +8,7 @@
 #include <unistd.h>
 
 #include <AK/Time.h>
+#include <LibSQL/Key.h>
 #include <LibSQL/Meta.h>
 #include <LibSQL/Row.h>
 #include <LibSQL/Tuple.h>
@@ -715,6 +716,45 @@ TEST_CASE(compare_tuples)
     EXPECT(tuple3 > tuple1);
 }
 
+TEST_CASE(compare_tuples_with_nulls)
+{
+    NonnullRefPtr<SQL::TupleDescriptor> descriptor = adopt_ref(*new SQL::TupleDescriptor);
+    descriptor->append({ "schema", "table", "col1", SQL::SQLType::Integer, SQL::Order::Ascending });
+    descriptor->append({ "schema", "table", "col2", SQL::SQLType::Integer, SQL::Order::Ascending });
+
+    SQL::Tuple tuple1(descriptor);
+    tuple1["col2"] = 42;
+
+    SQL::Tuple tuple2(descriptor);
+    tuple2["col2"] = 12;
+
+    // Two NULLs can't be ordered, so the next column doesn't get a say either.
+    EXPECT(!(tuple1 < tuple2));
+    EXPECT(!(tuple2 < tuple1));
+    EXPECT(!(tuple1 <= tuple2));
+    EXPECT(!(tuple1 >= tuple2));
+    EXPECT(tuple1 != tuple2);
+    EXPECT(!(tuple1 == tuple1));
+
+    // Tuple::compare() keeps the ordering of Value::compare() though, where a NULL is less than another NULL.
+    EXPECT(tuple1.compare(tuple2) < 0);
+    EXPECT(tuple2.compare(tuple1) < 0);
+
+    SQL::Key key1(descriptor);
+    key1["col2"] = 42;
+
+    SQL::Key key2(descriptor);
+    key2["col2"] = 12;
+
+    SQL::Key key3(descriptor);
+    key3["col2"] = 42;
+
+    // Keys need a total order, so equal NULLs let the next column decide.
+    EXPECT(key2 < key1);
+    EXPECT(key1 > key2);
+    EXPECT(key1 == key3);
+}
+
 TEST_CASE(add)
 {
     {
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Hex.h>
+#include <LibCrypto/Hash/HKDF.h>
+#include <LibTLS/TLSv13.h>
+#include <LibTest/TestCase.h>
+
+using namespace TLS;
+using HKDF = Crypto::Hash::HKDF<Crypto::Hash::Manager>;
+using GCM = Crypto::Cipher::AESCipher::GCMMode;
+
+static constexpr auto sha256 = Crypto::Hash::HashKind::SHA256;
+
+static ByteBuffer bytes(StringView hex)
+{
+    return MUST(decode_hex(hex));
+}
+
+static void expect_bytes(ReadonlyBytes actual, StringView expected_hex)
+{
+    auto expected = bytes(expected_hex);
+    EXPECT_EQ(actual, expected.bytes());
+}
+
+// The values below are from the "Simple 1-RTT Handshake" trace.
+// https://www.rfc-editor.org/rfc/rfc8448#section-3
+TEST_CASE(rfc8448_key_schedule)
+{
+    auto empty_hash = bytes("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"sv);
+    auto zeros = MUST(ByteBuffer::create_zeroed(32));
+
+    auto early_secret = TRY_OR_FAIL(HKDF::extract({}, zeros, sha256));
+    expect_bytes(early_secret, "33ad0a1c607ec03b09e6cd9893680ce210adf300aa1f2660e1b22e10f170f92a"sv);
+
+    auto derived = TRY_OR_FAIL(TLS13::derive_secret(sha256, early_secret, "derived"sv, empty_hash));
+    expect_bytes(derived, "6f2615a108c702c5678f54fc9dbab69716c076189c48250cebeac3576c3611ba"sv);
+
+    auto shared_secret = bytes("8bd4054fb55b9d63fdfbacf9f04b9f0d35e6d63f537563efd46272900f89492d"sv);
+    auto handshake_secret = TRY_OR_FAIL(HKDF::extract(derived, shared_secret, sha256));
+    expect_bytes(handshake_secret, "1dc826e93606aa6fdc0aadc12f741b01046aa6b99f691ed221a9f0ca043fbeac"sv);
+
+    // The hash of the ClientHello and the ServerHello.
+    auto transcript_hash = bytes("860c06edc07858ee8e78f0e7428c58edd6b43f2ca3e6e95f02ed063cf0e1cad8"sv);
+    auto client_handshake_traffic_secret = TRY_OR_FAIL(TLS13::derive_secret(sha256, handshake_secret, "c hs traffic"sv, transcript_hash));
+    expect_bytes(client_handshake_traffic_secret, "b3eddb126e067f35a780b3abf45e2d8f3b1a950738f52e9600746a0e27a55a21"sv);
+    auto server_handshake_traffic_secret = TRY_OR_FAIL(TLS13::derive_secret(sha256, handshake_secret, "s hs traffic"sv, transcript_hash));
+    expect_bytes(server_handshake_traffic_secret, "b67b7d690cc16c4e75e54213cb2d37b4e9c912bcded9105d42befd59d391ad38"sv);
+
+    auto master_secret = TRY_OR_FAIL(HKDF::extract(TRY_OR_FAIL(TLS13::derive_secret(sha256, handshake_secret, "derived"sv, empty_hash)), zeros, sha256));
+    expect_bytes(master_secret, "18df06843d13a08bf2a449844c5f8a478001bc4d4c627984d5a41da8d0402919"sv);
+
+    expect_bytes(MUST(TLS13::expand_label(sha256, server_handshake_traffic_secret, "key"sv, {}, 16)), "3fce516009c21727d0f2e4e86ee403bc"sv);
+    expect_bytes(MUST(TLS13::expand_label(sha256, server_handshake_traffic_secret, "iv"sv, {}, 12)), "5d313eb2671276ee13000b30"sv);
+    expect_bytes(MUST(TLS13::expand_label(sha256, client_handshake_traffic_secret, "key"sv, {}, 16)), "dbfaa693d1762c5b666af5d950258d01"sv);
+    expect_bytes(MUST(TLS13::expand_label(sha256, client_handshake_traffic_secret, "iv"sv, {}, 12)), "5bd3c71b836e0b76bb73265f"sv);
+    expect_bytes(MUST(TLS13::expand_label(sha256, server_handshake_traffic_secret, "finished"sv, {}, 32)), "008d3b66f816ea559f96b537e885c31fc068bf492c652f01f288a1d8cdc19fc8"sv);
+}
+
+// The client Finished message of the same trace, protected with the client handshake traffic key.
+static constexpr auto client_finished_plaintext = "1603030024"
+                                                  "14000020a8ec436d677634ae525ac1fcebe11a039ec17694fac6e98527b642f2edd5ce61"sv;
+static constexpr auto client_finished_ciphertext = "1703030035"
+                                                   "75ec4dc238cce60b298044a71e219c56cc77b0517fe9b93c7a4bfc44d87f38f80338ac98fc46deb384bd1caeacab6867d726c40546"sv;
+static constexpr auto client_handshake_key = "dbfaa693d1762c5b666af5d950258d01"sv;
+static constexpr auto client_handshake_iv = "5bd3c71b836e0b76bb73265f"sv;
+
+TEST_CASE(rfc8448_record_protection)
+{
+    GCM cipher(bytes(client_handshake_key), 128, Crypto::Cipher::Intent::Encryption, Crypto::Cipher::PaddingMode::RFC5246);
+    auto record = TRY_OR_FAIL(TLS13::protect_record(cipher, bytes(client_handshake_iv), 0, bytes(client_finished_plaintext)));
+    expect_bytes(record, client_finished_ciphertext);
+
+    // The sequence number goes into the nonce.
+    auto next_record = TRY_OR_FAIL(TLS13::protect_record(cipher, bytes(client_handshake_iv), 1, bytes(client_finished_plaintext)));
+    EXPECT_NE(next_record.bytes(), record.bytes());
+}
+
+TEST_CASE(rfc8448_record_unprotection)
+{
+    GCM cipher(bytes(client_handshake_key), 128, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::RFC5246);
+    auto record = bytes(client_finished_ciphertext);
+    auto header = record.bytes().slice(0, 5);
+    auto ciphertext = record.bytes().slice(5);
+
+    ByteBuffer plaintext;
+    ContentType type;
+    EXPECT_EQ(TLS13::unprotect_record(cipher, bytes(client_handshake_iv), 0, header, ciphertext, plaintext, type), TLS::Error::NoError);
+    EXPECT_EQ(type, ContentType::HANDSHAKE);
+    expect_bytes(plaintext, client_finished_plaintext.substring_view(10));
+
+    // Any other sequence number, a changed header or a changed ciphertext fail the integrity check.
+    EXPECT_EQ(TLS13::unprotect_record(cipher, bytes(client_handshake_iv), 1, header, ciphertext, plaintext, type), TLS::Error::IntegrityCheckFailed);
+    auto changed_header = bytes("1703030036"sv);
+    EXPECT_EQ(TLS13::unprotect_record(cipher, bytes(client_handshake_iv), 0, changed_header, ciphertext, plaintext, type), TLS::Error::IntegrityCheckFailed);
+    record[10] ^= 1;
+    EXPECT_EQ(TLS13::unprotect_record(cipher, bytes(client_handshake_iv), 0, header, ciphertext, plaintext, type), TLS::Error::IntegrityCheckFailed);
+}
+
+TEST_CASE(record_padding)
+{
+    GCM encryption(bytes(client_handshake_key), 128, Crypto::Cipher::Intent::Encryption, Crypto::Cipher::PaddingMode::RFC5246);
+    GCM decryption(bytes(client_handshake_key), 128, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::RFC5246);
+
+    // Zeros after the content type are padding, a record of only zeros has no content type at all.
+    // protect_record() appends the type of the plaintext record, so a record of type zero ends up with one zero of padding.
+    auto padded = TRY_OR_FAIL(TLS13::protect_record(encryption, bytes(client_handshake_iv), 0, bytes("000303000401020317"sv)));
+    ByteBuffer plaintext;
+    ContentType type;
+    EXPECT_EQ(TLS13::unprotect_record(decryption, bytes(client_handshake_iv), 0, padded.bytes().slice(0, 5), padded.bytes().slice(5), plaintext, type), TLS::Error::NoError);
+    EXPECT_EQ(type, ContentType::APPLICATION_DATA);
+    expect_bytes(plaintext, "010203"sv);
+
+    auto empty = TRY_OR_FAIL(TLS13::protect_record(encryption, bytes(client_handshake_iv), 0, bytes("00030300020000"sv)));
+    EXPECT_EQ(TLS13::unprotect_record(decryption, bytes(client_handshake_iv), 0, empty.bytes().slice(0, 5), empty.bytes().slice(5), plaintext, type), TLS::Error::UnexpectedMessage);
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.4.1
+TEST_CASE(hello_retry_request_transcript_hash)
+{
+    auto client_hello = bytes("010000080303636c69656e74"sv);
+    auto hello_retry_request = bytes("020000080303736572766572"sv);
+
+    // Hash(message_hash || 00 00 Hash.length || Hash(ClientHello1) || HelloRetryRequest)
+    auto expect_transcript_hash = [&](Crypto::Hash::HashKind kind, StringView expected) {
+        Crypto::Hash::Manager transcript(kind);
+        transcript.update(client_hello);
+        TLS13::replace_client_hello_with_message_hash(transcript);
+        transcript.update(hello_retry_request);
+        auto digest = transcript.digest();
+        expect_bytes({ digest.immutable_data(), transcript.digest_size() }, expected);
+    };
+    expect_transcript_hash(Crypto::Hash::HashKind::SHA256, "c8814e8a8d84a36fabb7c0f92be4a49ae9dc34224af82cac4120b150daf4770b"sv);
+    expect_transcript_hash(Crypto::Hash::HashKind::SHA384, "06f0133a7f17b4479204f78e7083cb81d9f27d984d44fa7fdabee7924462c0f3682d09766c3c4822d73703926587fed2"sv);
+}
+
+// A 1024-bit key, so the encoded message is one bit shorter than the modulus and its top bit is masked.
+// The signature uses SHA-256 for the hash and MGF1 and a 32 byte salt, as TLS 1.3 requires.
+static Crypto::PK::RSAPublicKey<Crypto::UnsignedBigInteger> pss_public_key()
+{
+    auto modulus = MUST(Crypto::UnsignedBigInteger::from_base(16,
+        "cf9451856c678f8ad5788b80ef3eb38de91cb031efab7c4a35fadecb4fa573ecf8398be80fba122a31bdd40ef8a9b9f998183f9825a5d78e750c2a7bc364ca48"
+        "672b26db202900e187cf60eb26063b42c1f41f3583a34ea0b0357571bd6065ea69312cd20b6ecdbd8e991c7b31ab1d7a2b35897bd49260337f61fc01632e79df"sv));
+    return { modulus, 65537 };
+}
+
+static constexpr auto pss_message = "TLS 1.3, server CertificateVerify"sv;
+static constexpr auto pss_signature = "19a1fa5c1ef123402f2781dacfe1983f5e97dac367d3aa9b6093ca3126b02fd3a68d6fbef896cedfffcc7f7c802dc8c7788600c170dec01f3c268a185e1be0c2"
+                                      "293a816cf514dcd4d83a9c8d5aa672b245d3e3ac7c8020e3bbf23d4b841f95e3a16b918ad24c5e9abbc4e23e8d60e0f6c92960f03a1ac8a55c846eacde790ada"sv;
+
+TEST_CASE(rsa_pss_verify)
+{
+    auto public_key = pss_public_key();
+    EXPECT(TLS13::verify_rsa_pss_signature(SignatureAlgorithm::RSA_PSS_RSAE_SHA256, public_key, pss_message.bytes(), bytes(pss_signature)));
+}
+
+TEST_CASE(rsa_pss_verify_rejects_bad_signatures)
+{
+    auto public_key = pss_public_key();
+    auto signature = bytes(pss_signature);
+
+    EXPECT(!TLS13::verify_rsa_pss_signature(SignatureAlgorithm::RSA_PSS_RSAE_SHA256, public_key, "TLS 1.3, client CertificateVerify"sv.bytes(), signature));
+    EXPECT(!TLS13::verify_rsa_pss_signature(SignatureAlgorithm::RSA_PSS_RSAE_SHA384, public_key, pss_message.bytes(), signature));
+    EXPECT(!TLS13::verify_rsa_pss_signature(SignatureAlgorithm::RSA, public_key, pss_message.bytes(), signature));
+
+    auto changed_signature = bytes(pss_signature);
+    changed_signature.bytes()[64] ^= 0x80;
+    EXPECT(!TLS13::verify_rsa_pss_signature(SignatureAlgorithm::RSA_PSS_RSAE_SHA256, public_key, pss_message.bytes(), changed_signature));
+
+    // A signature that isn't smaller than the modulus is invalid, even if it would reduce to a valid one.
+    auto modulus_sized = MUST(ByteBuffer::create_uninitialized(128));
+    public_key.modulus().export_data(modulus_sized);
+    EXPECT(!TLS13::verify_rsa_pss_signature(SignatureAlgorithm::RSA_PSS_RSAE_SHA256, public_key, pss_message.bytes(), modulus_sized));
+}
@@ -5,9 +5,12 @@
  */
 
 #include <AK/MemoryStream.h>
+#include <LibJIT/Assembler.h>
 #include <LibTest/JavaScriptTestRunner.h>
 #include <LibWasm/AbstractMachine/BytecodeInterpreter.h>
+#include <LibWasm/AbstractMachine/Configuration.h>
 #include <LibWasm/Types.h>
+#include <stdlib.h>
 #include <string.h>
 
 TEST_ROOT("Userland/Libraries/LibWasm/Tests");
@@ -46,7 +49,9 @@ public:
     explicit WebAssemblyModule(JS::Object& prototype)
         : JS::Object(ConstructWithPrototypeTag::Tag, prototype)
     {
-        m_machine.enable_instruction_count_limit();
+        // Native code doesn't count instructions, so with a limit LIBWASM_JIT would have no effect.
+        if (!getenv("LIBWASM_JIT"))
+            m_machine.enable_instruction_count_limit();
     }
 
     static Wasm::AbstractMachine& machine() { return m_machine; }
@@ -77,6 +82,13 @@ public:
 private:
     JS_DECLARE_NATIVE_FUNCTION(get_export);
     JS_DECLARE_NATIVE_FUNCTION(wasm_invoke);
+    JS_DECLARE_NATIVE_FUNCTION(wasm_invoke_compiled);
+
+    enum class UseJIT {
+        No,
+        Yes,
+    };
+    static JS::ThrowCompletionOr<JS::Value> invoke(JS::VM&, UseJIT);
 
     static HashMap<Wasm::Linker::Name, Wasm::ExternValue> const& spec_test_namespace()
     {
@@ -97,11 +109,13 @@ private:
 
     static HashMap<Wasm::Linker::Name, Wasm::ExternValue> s_spec_test_namespace;
     static Wasm::AbstractMachine m_machine;
+    static StackInfo s_stack_info;
     Optional<Wasm::Module> m_module;
     OwnPtr<Wasm::ModuleInstance> m_module_instance;
 };
 
 Wasm::AbstractMachine WebAssemblyModule::m_machine;
+StackInfo WebAssemblyModule::s_stack_info;
 HashMap<Wasm::Linker::Name, Wasm::ExternValue> WebAssemblyModule::s_spec_test_namespace;
 
 TESTJS_GLOBAL_FUNCTION(parse_webassembly_module, parseWebAssemblyModule)
@@ -135,6 +149,15 @@ TESTJS_GLOBAL_FUNCTION(parse_webassembly_module, parseWebAssemblyModule)
     return JS::Value(TRY(WebAssemblyModule::create(realm, result.release_value(), imports)));
 }
 
+TESTJS_GLOBAL_FUNCTION(is_wasm_jit_supported, isWasmJITSupported)
+{
+#ifdef JIT_ARCH_SUPPORTED
+    return JS::Value(true);
+#else
+    return JS::Value(false);
+#endif
+}
+
 TESTJS_GLOBAL_FUNCTION(compare_typed_arrays, compareTypedArrays)
 {
     auto lhs = TRY(vm.argument(0).to_object(vm));
@@ -153,6 +176,7 @@ void WebAssemblyModule::initialize(JS::Realm& realm)
     Base::initialize(realm);
     define_native_function(realm, "getExport", get_export, 1, JS::default_attributes);
     define_native_function(realm, "invoke", wasm_invoke, 1, JS::default_attributes);
+    define_native_function(realm, "invokeCompiled", wasm_invoke_compiled, 1, JS::default_attributes);
 }
 
 JS_DEFINE_NATIVE_FUNCTION(WebAssemblyModule::get_export)
@@ -187,6 +211,17 @@ JS_DEFINE_NATIVE_FUNCTION(WebAssemblyModule::get_export)
 }
 
 JS_DEFINE_NATIVE_FUNCTION(WebAssemblyModule::wasm_invoke)
+{
+    return invoke(vm, UseJIT::No);
+}
+
+// Like invoke(), but runs the function as native code, and throws if the JIT can't compile it.
+JS_DEFINE_NATIVE_FUNCTION(WebAssemblyModule::wasm_invoke_compiled)
+{
+    return invoke(vm, UseJIT::Yes);
+}
+
+JS::ThrowCompletionOr<JS::Value> WebAssemblyModule::invoke(JS::VM& vm, UseJIT use_jit)
 {
     auto address = static_cast<unsigned long>(TRY(vm.argument(0).to_double(vm)));
     Wasm::FunctionAddress function_address { address };
@@ -256,7 +291,22 @@ JS_DEFINE_NATIVE_FUNCTION(WebAssemblyModule::wasm_invoke)
         }
     }
 
-    auto result = WebAssemblyModule::machine().invoke(function_address, arguments);
+    auto result = TRY([&]() -> JS::ThrowCompletionOr<Wasm::Result> {
+        if (use_jit == UseJIT::No)
+            return WebAssemblyModule::machine().invoke(function_address, move(arguments));
+
+        auto* wasm_function = function_instance->get_pointer<Wasm::WasmFunction>();
+        if (!wasm_function)
+            return vm.throw_completion<JS::TypeError>("Only Wasm functions can be compiled"sv);
+
+        Wasm::Configuration configuration { WebAssemblyModule::machine().store() };
+        configuration.enable_jit();
+        if (!wasm_function->native_function(configuration))
+            return vm.throw_completion<JS::TypeError>("The JIT could not compile this function"sv);
+
+        Wasm::BytecodeInterpreter interpreter(s_stack_info);
+        return configuration.call(interpreter, function_address, move(arguments));
+    }());
     if (result.is_trap())
         return vm.throw_completion<JS::TypeError>(TRY_OR_THROW_OOM(vm, String::formatted("Execution trapped: {}", result.trap().reason)));
 
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <LookupServer/LookupCache.h>
+
+using namespace LookupServer;
+
+static CacheKey key(StringView name)
+{
+    return { Name { name }, RecordType::A };
+}
+
+static Answer answer(StringView name, u32 ttl)
+{
+    return { Name { name }, RecordType::A, RecordClass::IN, ttl, ByteString { "\x7f\x00\x00\x01"sv }, false };
+}
+
+TEST_CASE(lru_eviction)
+{
+    auto now = MonotonicTime::now();
+    LookupCache cache { 2 };
+    cache.put(key("a.example"sv), { answer("a.example"sv, 60) }, now);
+    cache.put(key("b.example"sv), { answer("b.example"sv, 60) }, now);
+
+    // Using a.example makes b.example the least recently used entry.
+    EXPECT(cache.lookup(key("a.example"sv), now).has_value());
+    cache.put(key("c.example"sv), { answer("c.example"sv, 60) }, now);
+
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.statistics().evictions, 1u);
+    EXPECT(cache.lookup(key("a.example"sv), now).has_value());
+    EXPECT(!cache.lookup(key("b.example"sv), now).has_value());
+    EXPECT(cache.lookup(key("c.example"sv), now).has_value());
+
+    // Replacing an entry doesn't evict anything.
+    cache.put(key("c.example"sv), { answer("c.example"sv, 30) }, now);
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.statistics().evictions, 1u);
+}
+
+TEST_CASE(ttl_expiry)
+{
+    auto now = MonotonicTime::now();
+    LookupCache cache { 16 };
+
+    // The entry lives as long as its shortest-lived answer.
+    cache.put(key("example.com"sv), { answer("example.com"sv, 300), answer("example.com"sv, 60) }, now);
+
+    auto hit = cache.lookup(key("example.com"sv), now + Duration::from_seconds(20));
+    VERIFY(hit.has_value());
+    EXPECT_EQ(hit->answers.size(), 2u);
+    // Clients get the time that is left, not what the nameserver said.
+    for (auto& answer : hit->answers)
+        EXPECT_EQ(answer.ttl(), 40u);
+
+    EXPECT(cache.lookup(key("example.com"sv), now + Duration::from_seconds(59)).has_value());
+    EXPECT(!cache.lookup(key("example.com"sv), now + Duration::from_seconds(60)).has_value());
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.statistics().hits, 2u);
+    EXPECT_EQ(cache.statistics().misses, 1u);
+
+    // Nothing with a TTL of zero is kept at all.
+    cache.put(key("zero.example"sv), { answer("zero.example"sv, 0) }, now);
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST_CASE(negative_ttl_capping)
+{
+    auto now = MonotonicTime::now();
+    LookupCache cache { 16 };
+    static constexpr i64 three_hours = 3 * 3600;
+
+    cache.put_negative(key("nxdomain.example"sv), 86400, now);
+    auto hit = cache.lookup(key("nxdomain.example"sv), now + Duration::from_seconds(three_hours - 1));
+    VERIFY(hit.has_value());
+    EXPECT(hit->answers.is_empty());
+    EXPECT_EQ(cache.statistics().negative_hits, 1u);
+    EXPECT(!cache.lookup(key("nxdomain.example"sv), now + Duration::from_seconds(three_hours)).has_value());
+
+    // Shorter negative TTLs are kept as they are.
+    cache.put_negative(key("nodata.example"sv), 60, now);
+    EXPECT(cache.lookup(key("nodata.example"sv), now + Duration::from_seconds(59)).has_value());
+    EXPECT(!cache.lookup(key("nodata.example"sv), now + Duration::from_seconds(60)).has_value());
+}
+
+TEST_CASE(refresh_ahead)
+{
+    auto now = MonotonicTime::now();
+    LookupCache cache { 16 };
+    auto refreshes_after = [&](i64 seconds) {
+        auto hit = cache.lookup(key("popular.example"sv), now + Duration::from_seconds(seconds));
+        VERIFY(hit.has_value());
+        return hit->should_refresh;
+    };
+
+    cache.put(key("popular.example"sv), { answer("popular.example"sv, 100) }, now);
+
+    // Not while there's plenty of time left, however popular the entry is.
+    EXPECT(!refreshes_after(10));
+    EXPECT(!refreshes_after(20));
+    EXPECT(!refreshes_after(30));
+
+    // Once less than a tenth of the TTL is left, the next hit asks for a refresh, but only that one.
+    EXPECT(refreshes_after(91));
+    EXPECT(!refreshes_after(92));
+    EXPECT(!refreshes_after(93));
+
+    // If the refresh didn't work out, the next hit tries again.
+    cache.did_fail_to_refresh(key("popular.example"sv));
+    EXPECT(refreshes_after(94));
+
+    // A refreshed entry starts counting its hits from scratch.
+    cache.put(key("popular.example"sv), { answer("popular.example"sv, 100) }, now);
+    EXPECT(!refreshes_after(95));
+    EXPECT(refreshes_after(96));
+}
+
+TEST_CASE(refresh_ahead_needs_minimum_hits)
+{
+    auto now = MonotonicTime::now();
+    LookupCache cache { 16 };
+
+    // An entry that nobody asked for until it was almost expired isn't worth fetching again.
+    cache.put(key("rare.example"sv), { answer("rare.example"sv, 100) }, now);
+    auto hit = cache.lookup(key("rare.example"sv), now + Duration::from_seconds(95));
+    VERIFY(hit.has_value());
+    EXPECT(!hit->should_refresh);
+
+    // Neither are entries with very short TTLs, or negative ones.
+    cache.put(key("short.example"sv), { answer("short.example"sv, 5) }, now);
+    cache.put_negative(key("nxdomain.example"sv), 100, now);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT(!cache.lookup(key("short.example"sv), now + Duration::from_milliseconds(4900)).value().should_refresh);
+        EXPECT(!cache.lookup(key("nxdomain.example"sv), now + Duration::from_seconds(95)).value().should_refresh);
+    }
+}
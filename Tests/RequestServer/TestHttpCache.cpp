@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/MemoryStream.h>
+#include <AK/URL.h>
+#include <LibTest/TestCase.h>
+#include <RequestServer/HttpCache.h>
+#include <time.h>
+
+using namespace RequestServer;
+
+static HttpCache& cache()
+{
+    if (!HttpCache::the())
+        MUST(HttpCache::initialize("/tmp/TestHttpCache"));
+    return *HttpCache::the();
+}
+
+static ByteString http_date(UnixDateTime time)
+{
+    auto seconds = static_cast<time_t>(time.seconds_since_epoch());
+    struct tm tm;
+    gmtime_r(&seconds, &tm);
+    char buffer[64];
+    auto length = strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return ByteString { buffer, length };
+}
+
+// Runs a response through a CacheEntryWriter like HttpRequest does, and returns what the cache stored for it.
+static OwnPtr<CacheEntry> store_response(StringView url, u32 status_code, HeaderMap const& response_headers, HeaderMap const& request_headers = {})
+{
+    cache().remove_entry(url);
+
+    AllocatingMemoryStream client_stream;
+    auto writer = CacheEntryWriter::create(cache(), url, request_headers, client_stream);
+    VERIFY(writer);
+    writer->did_receive_headers(status_code, response_headers);
+    MUST(writer->write_until_depleted("Well hello friends!"sv.bytes()));
+    writer->did_finish(true, status_code, response_headers);
+    writer = nullptr;
+
+    return cache().open_entry(url, request_headers);
+}
+
+static UnixDateTime seconds_from_now(i64 seconds)
+{
+    return UnixDateTime::now() + Duration::from_seconds(seconds);
+}
+
+TEST_CASE(max_age)
+{
+    auto entry = store_response("http://example.com/max-age"sv, 200, { { "Cache-Control", "max-age=60" } });
+    VERIFY(entry);
+    EXPECT_EQ(entry->body(), "Well hello friends!"sv.bytes());
+    EXPECT(entry->is_fresh_for({}, seconds_from_now(0)));
+    EXPECT(entry->is_fresh_for({}, seconds_from_now(30)));
+    EXPECT(!entry->is_fresh_for({}, seconds_from_now(90)));
+}
+
+TEST_CASE(max_age_zero)
+{
+    auto entry = store_response("http://example.com/max-age-zero"sv, 200, { { "Cache-Control", "max-age=0" }, { "ETag", "\"abc\"" } });
+    VERIFY(entry);
+    EXPECT(!entry->is_fresh_for({}, seconds_from_now(0)));
+    EXPECT(entry->can_be_revalidated());
+
+    HashMap<ByteString, ByteString> revalidation_headers;
+    entry->add_revalidation_headers(revalidation_headers);
+    EXPECT_EQ(revalidation_headers.get("If-None-Match"sv), "\"abc\""sv);
+}
+
+TEST_CASE(no_store)
+{
+    EXPECT(!store_response("http://example.com/no-store"sv, 200, { { "Cache-Control", "max-age=60, no-store" } }));
+    EXPECT(!store_response("http://example.com/no-store-request"sv, 200, { { "Cache-Control", "max-age=60" } }, { { "Cache-Control", "no-store" } }));
+    EXPECT(!HttpCache::is_cacheable_request("GET"sv, { { "Cache-Control", "no-store" } }));
+    EXPECT(HttpCache::is_cacheable_request("GET"sv, {}));
+    EXPECT(!HttpCache::is_cacheable_request("POST"sv, {}));
+}
+
+TEST_CASE(no_cache)
+{
+    auto entry = store_response("http://example.com/no-cache"sv, 200, { { "Cache-Control", "no-cache, max-age=60" } });
+    VERIFY(entry);
+    EXPECT(!entry->is_fresh_for({}, seconds_from_now(0)));
+
+    entry = store_response("http://example.com/pragma"sv, 200, { { "Pragma", "no-cache" }, { "Last-Modified", http_date(seconds_from_now(-3600)) } });
+    VERIFY(entry);
+    EXPECT(!entry->is_fresh_for({}, seconds_from_now(0)));
+}
+
+// This is a private cache, so `private` responses are fine to keep.
+TEST_CASE(private_responses)
+{
+    auto entry = store_response("http://example.com/private"sv, 200, { { "Cache-Control", "private, max-age=60" } });
+    VERIFY(entry);
+    EXPECT(entry->is_fresh_for({}, seconds_from_now(0)));
+}
+
+// A stale entry is never served without revalidating it, so `must-revalidate` needs no special handling.
+TEST_CASE(must_revalidate)
+{
+    auto entry = store_response("http://example.com/must-revalidate"sv, 200, { { "Cache-Control", "max-age=60, must-revalidate" }, { "Last-Modified", http_date(seconds_from_now(-3600)) } });
+    VERIFY(entry);
+    EXPECT(entry->is_fresh_for({}, seconds_from_now(30)));
+    EXPECT(!entry->is_fresh_for({}, seconds_from_now(90)));
+    EXPECT(entry->can_be_revalidated());
+}
+
+TEST_CASE(request_cache_control)
+{
+    auto entry = store_response("http://example.com/request-cache-control"sv, 200, { { "Cache-Control", "max-age=600" } });
+    VERIFY(entry);
+    EXPECT(entry->is_fresh_for({}, seconds_from_now(60)));
+    EXPECT(!entry->is_fresh_for({ { "Cache-Control", "max-age=30" } }, seconds_from_now(60)));
+    EXPECT(!entry->is_fresh_for({ { "Cache-Control", "no-cache" } }, seconds_from_now(0)));
+}
+
+TEST_CASE(current_age)
+{
+    // The response already spent 80 seconds in other caches.
+    auto entry = store_response("http://example.com/age"sv, 200, { { "Cache-Control", "max-age=100" }, { "Age", "80" } });
+    VERIFY(entry);
+    EXPECT(entry->is_fresh_for({}, seconds_from_now(5)));
+    EXPECT(!entry->is_fresh_for({}, seconds_from_now(30)));
+
+    auto age = entry->response_headers_for_client(seconds_from_now(10)).get("Age"sv).value_or({}).to_number<i64>();
+    VERIFY(age.has_value());
+    EXPECT(*age >= 89 && *age <= 91);
+
+    // A Date header in the past makes the response older than its Age header says.
+    entry = store_response("http://example.com/date"sv, 200, { { "Cache-Control", "max-age=100" }, { "Date", http_date(seconds_from_now(-90)) } });
+    VERIFY(entry);
+    EXPECT(entry->is_fresh_for({}, seconds_from_now(0)));
+    EXPECT(!entry->is_fresh_for({}, seconds_from_now(20)));
+}
+
+TEST_CASE(expires)
+{
+    auto now = UnixDateTime::now();
+    auto entry = store_response("http://example.com/expires"sv, 200, { { "Date", http_date(now) }, { "Expires", http_date(now + Duration::from_seconds(60)) } });
+    VERIFY(entry);
+    EXPECT(entry->is_fresh_for({}, seconds_from_now(30)));
+    EXPECT(!entry->is_fresh_for({}, seconds_from_now(90)));
+
+    // max-age wins over Expires.
+    entry = store_response("http://example.com/expires-and-max-age"sv, 200, { { "Cache-Control", "max-age=600" }, { "Expires", http_date(now + Duration::from_seconds(60)) } });
+    VERIFY(entry);
+    EXPECT(entry->is_fresh_for({}, seconds_from_now(90)));
+
+    // An invalid date means the response has already expired.
+    entry = store_response("http://example.com/expires-invalid"sv, 200, { { "Expires", "0" } });
+    VERIFY(entry);
+    EXPECT(!entry->is_fresh_for({}, seconds_from_now(0)));
+}
+
+TEST_CASE(heuristic_freshness)
+{
+    auto now = UnixDateTime::now();
+    static constexpr i64 day = 24 * 60 * 60;
+
+    // Modified ten days ago, so it's good for a tenth of that.
+    auto entry = store_response("http://example.com/heuristic"sv, 200, { { "Date", http_date(now) }, { "Last-Modified", http_date(now - Duration::from_seconds(10 * day)) } });
+    VERIFY(entry);
+    EXPECT(entry->is_fresh_for({}, seconds_from_now(12 * 60 * 60)));
+    EXPECT(!entry->is_fresh_for({}, seconds_from_now(2 * day)));
+
+    // But never for more than a week.
+    entry = store_response("http://example.com/heuristic-capped"sv, 200, { { "Date", http_date(now) }, { "Last-Modified", http_date(now - Duration::from_seconds(1000 * day)) } });
+    VERIFY(entry);
+    EXPECT(entry->is_fresh_for({}, seconds_from_now(6 * day)));
+    EXPECT(!entry->is_fresh_for({}, seconds_from_now(8 * day)));
+
+    // Without any freshness information, a response has to be revalidated every time.
+    entry = store_response("http://example.com/no-freshness"sv, 200, { { "ETag", "\"abc\"" } });
+    VERIFY(entry);
+    EXPECT(!entry->is_fresh_for({}, seconds_from_now(0)));
+    EXPECT(entry->can_be_revalidated());
+}
+
+TEST_CASE(storable_status_codes)
+{
+    HeaderMap response_headers { { "Cache-Control", "max-age=60" } };
+    EXPECT(store_response("http://example.com/200"sv, 200, response_headers));
+    EXPECT(store_response("http://example.com/404"sv, 404, response_headers));
+    EXPECT(store_response("http://example.com/301"sv, 301, response_headers));
+    EXPECT(!store_response("http://example.com/206"sv, 206, response_headers));
+    EXPECT(!store_response("http://example.com/302"sv, 302, response_headers));
+    EXPECT(!store_response("http://example.com/500"sv, 500, response_headers));
+}
+
+TEST_CASE(vary)
+{
+    auto url = "http://example.com/vary"sv;
+    auto entry = store_response(url, 200, { { "Cache-Control", "max-age=60" }, { "Vary", "Accept-Language, Accept-Encoding" } }, { { "Accept-Language", "en" } });
+    VERIFY(entry);
+
+    EXPECT(cache().open_entry(url, { { "accept-language", "en" } }));
+    // A header that was missing from the original request has to be missing from this one as well.
+    EXPECT(!cache().open_entry(url, { { "Accept-Language", "en" }, { "Accept-Encoding", "gzip" } }));
+    EXPECT(!cache().open_entry(url, { { "Accept-Language", "de" } }));
+    EXPECT(!cache().open_entry(url, {}));
+
+    EXPECT(!store_response("http://example.com/vary-star"sv, 200, { { "Cache-Control", "max-age=60" }, { "Vary", "*" } }));
+}
@@ -19,10 +19,12 @@
 #include <LibAudio/Queue.h>
 #include <LibAudio/Sample.h>
 #include <LibIPC/Connection.h>
+#include <LibThreading/Mutex.h>
 #include <LibThreading/Thread.h>
 #include <sched.h>
 #include <time.h>
 
+// The connection's socket is still handled by the GUI thread's event loop, so functions are scheduled from both threads.
 struct AudioLoopDeferredInvoker final : public IPC::DeferredInvoker {
     static constexpr size_t INLINE_FUNCTIONS = 4;
 
@@ -30,19 +32,27 @@ struct AudioLoopDeferredInvoker final : public IPC::DeferredInvoker {
 
     virtual void schedule(Function<void()> function) override
     {
+        Threading::MutexLocker locker(mutex);
         deferred_functions.append(move(function));
     }
 
     void run_functions()
     {
-        if (deferred_functions.size() > INLINE_FUNCTIONS)
+        Vector<Function<void()>, INLINE_FUNCTIONS> functions;
+        {
+            Threading::MutexLocker locker(mutex);
+            functions = move(deferred_functions);
+        }
+
+        if (functions.size() > INLINE_FUNCTIONS)
             dbgln("Warning: Audio loop has more than {} deferred functions, audio might glitch!", INLINE_FUNCTIONS);
-        while (!deferred_functions.is_empty()) {
-            auto function = deferred_functions.take_last();
+        while (!functions.is_empty()) {
+            auto function = functions.take_last();
             function();
         }
     }
 
+    Threading::Mutex mutex;
     Vector<Function<void()>, INLINE_FUNCTIONS> deferred_functions;
 };
 
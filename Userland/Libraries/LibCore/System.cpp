@@ -372,6 +372,12 @@ ErrorOr<void> profiling_free_buffer(pid_t pid)
     int rc = ::profiling_free_buffer(pid);
     HANDLE_SYSCALL_RETURN_VALUE("profiling_free_buffer", rc, {});
 }
+
+ErrorOr<u32> io_ring_enter(IORing& ring, u32 to_submit, u32 min_complete)
+{
+    int rc = syscall(SC_io_ring_enter, &ring, to_submit, min_complete);
+    HANDLE_SYSCALL_RETURN_VALUE("io_ring_enter", rc, static_cast<u32>(rc));
+}
 #endif
 
 #if !defined(AK_OS_BSD_GENERIC) && !defined(AK_OS_ANDROID)
@@ -32,6 +32,7 @@
 #include <utime.h>
 
 #ifdef AK_OS_SERENITY
+#    include <Kernel/API/IORing.h>
 #    include <Kernel/API/Jail.h>
 #endif
 
@@ -69,6 +70,7 @@ ErrorOr<void> disown(pid_t pid);
 ErrorOr<void> profiling_enable(pid_t, u64 event_mask);
 ErrorOr<void> profiling_disable(pid_t);
 ErrorOr<void> profiling_free_buffer(pid_t);
+ErrorOr<u32> io_ring_enter(IORing&, u32 to_submit, u32 min_complete = 0);
 #else
 inline ErrorOr<void> unveil(StringView, StringView)
 {
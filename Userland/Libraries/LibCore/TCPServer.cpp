@@ -40,7 +40,7 @@ TCPServer::~TCPServer()
     MUST(Core::System::close(m_fd));
 }
 
-ErrorOr<void> TCPServer::listen(IPv4Address const& address, u16 port, AllowAddressReuse allow_address_reuse)
+ErrorOr<void> TCPServer::listen(IPv4Address const& address, u16 port, AllowAddressReuse allow_address_reuse, int backlog)
 {
     if (m_listening)
         return Error::from_errno(EADDRINUSE);
@@ -54,7 +54,7 @@ ErrorOr<void> TCPServer::listen(IPv4Address const& address, u16 port, AllowAddre
     }
 
     TRY(Core::System::bind(m_fd, (sockaddr const*)&in, sizeof(in)));
-    TRY(Core::System::listen(m_fd, 5));
+    TRY(Core::System::listen(m_fd, backlog));
     m_listening = true;
 
     m_notifier = Notifier::construct(m_fd, Notifier::Type::Read, this);
@@ -86,7 +86,7 @@ ErrorOr<NonnullOwnPtr<TCPSocket>> TCPServer::accept()
     int accepted_fd = TRY(Core::System::accept(m_fd, (sockaddr*)&in, &in_size));
 #endif
 
-    auto socket = TRY(TCPSocket::adopt_fd(accepted_fd));
+    auto socket = TRY(TCPSocket::adopt_fd(accepted_fd, Socket::PreventSIGPIPE::Yes));
 
 #if defined(AK_OS_MACOS) || defined(AK_OS_HAIKU)
     // FIXME: Ideally, we should let the caller decide whether it wants the
@@ -25,7 +25,7 @@ public:
     };
 
     bool is_listening() const { return m_listening; }
-    ErrorOr<void> listen(IPv4Address const& address, u16 port, AllowAddressReuse = AllowAddressReuse::No);
+    ErrorOr<void> listen(IPv4Address const& address, u16 port, AllowAddressReuse = AllowAddressReuse::No, int backlog = 5);
     ErrorOr<void> set_blocking(bool blocking);
 
     ErrorOr<NonnullOwnPtr<TCPSocket>> accept();
@@ -33,6 +33,8 @@ public:
     Optional<IPv4Address> local_address() const;
     Optional<u16> local_port() const;
 
+    int fd() const { return m_fd; }
+
     Function<void()> on_ready_to_accept;
 
 private:
@@ -8,6 +8,7 @@
 #include <AK/Debug.h>
 #include <AK/Types.h>
 #include <LibCrypto/Authentication/GHash.h>
+#include <LibCrypto/CPUFeatures.h>
 
 namespace {
 
@@ -84,9 +85,7 @@ GHash::TagType GHash::process(ReadonlyBytes aad, ReadonlyBytes cipher)
     return digest;
 }
 
-/// Galois Field multiplication using <x^127 + x^7 + x^2 + x + 1>.
-/// Note that x, y, and z are strictly BE.
-void galois_multiply(u32 (&z)[4], const u32 (&_x)[4], const u32 (&_y)[4])
+static void galois_multiply_portable(u32 (&z)[4], const u32 (&_x)[4], const u32 (&_y)[4])
 {
     u32 x[4] { _x[0], _x[1], _x[2], _x[3] };
     u32 y[4] { _y[0], _y[1], _y[2], _y[3] };
@@ -115,4 +114,58 @@ void galois_multiply(u32 (&z)[4], const u32 (&_x)[4], const u32 (&_y)[4])
     }
 }
 
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+// These match the vector types of the PCLMULQDQ builtin.
+using u64x2 = long long __attribute__((vector_size(16)));
+using u32x4 = u32 __attribute__((vector_size(16)));
+
+// See "Intel Carry-Less Multiplication Instruction and its Usage for Computing the GCM Mode", Algorithm 1 and 5.
+// The operands are 128-bit integers in GHASH bit order (i.e. x[0] most significant), so the product is bit-reflected,
+// which the 1-bit left shift before the reduction makes up for.
+[[gnu::target("pclmul")]] static void galois_multiply_with_pclmul(u32 (&z)[4], const u32 (&x)[4], const u32 (&y)[4])
+{
+    u64x2 a { static_cast<long long>((static_cast<u64>(x[2]) << 32) | x[3]), static_cast<long long>((static_cast<u64>(x[0]) << 32) | x[1]) };
+    u64x2 b { static_cast<long long>((static_cast<u64>(y[2]) << 32) | y[3]), static_cast<long long>((static_cast<u64>(y[0]) << 32) | y[1]) };
+
+    // 256-bit carry-less product, low half in `low` and high half in `high`.
+    u64x2 low = __builtin_ia32_pclmulqdq128(a, b, 0x00);
+    u64x2 middle = __builtin_ia32_pclmulqdq128(a, b, 0x10) ^ __builtin_ia32_pclmulqdq128(a, b, 0x01);
+    u64x2 high = __builtin_ia32_pclmulqdq128(a, b, 0x11);
+    low ^= u64x2 { 0, middle[0] };
+    high ^= u64x2 { middle[1], 0 };
+
+    // Shift the product left by one bit.
+    auto low_words = reinterpret_cast<u32x4>(low);
+    auto high_words = reinterpret_cast<u32x4>(high);
+    auto low_carry = low_words >> 31;
+    auto high_carry = high_words >> 31;
+    low_words <<= 1;
+    high_words <<= 1;
+    high_words |= u32x4 { low_carry[3], high_carry[0], high_carry[1], high_carry[2] };
+    low_words |= u32x4 { 0, low_carry[0], low_carry[1], low_carry[2] };
+
+    // Reduce modulo x^128 + x^7 + x^2 + x + 1.
+    auto first = (low_words << 31) ^ (low_words << 30) ^ (low_words << 25);
+    low_words ^= u32x4 { 0, 0, 0, first[0] };
+    auto second = (low_words >> 1) ^ (low_words >> 2) ^ (low_words >> 7) ^ u32x4 { first[1], first[2], first[3], 0 };
+    auto result = high_words ^ low_words ^ second;
+
+    z[0] = result[3];
+    z[1] = result[2];
+    z[2] = result[1];
+    z[3] = result[0];
+}
+#endif
+
+/// Galois Field multiplication using <x^127 + x^7 + x^2 + x + 1>.
+/// Note that x, y, and z are strictly BE.
+void galois_multiply(u32 (&z)[4], const u32 (&x)[4], const u32 (&y)[4])
+{
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+    if (CPUFeatures::the().has_pclmul)
+        return galois_multiply_with_pclmul(z, x, y);
+#endif
+    galois_multiply_portable(z, x, y);
+}
+
 }
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Types.h>
+#include <LibCrypto/CPUFeatures.h>
+#include <stdlib.h>
+
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+#    include <cpuid.h>
+#endif
+
+namespace Crypto {
+
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+// cpuid[eax = 1].ecx
+static constexpr u32 cpuid_1_ecx_bit_pclmulqdq = 1 << 1;
+static constexpr u32 cpuid_1_ecx_bit_ssse3 = 1 << 9;
+static constexpr u32 cpuid_1_ecx_bit_sse4_1 = 1 << 19;
+static constexpr u32 cpuid_1_ecx_bit_aes = 1 << 25;
+static constexpr u32 cpuid_1_ecx_bit_osxsave = 1 << 27;
+
+// cpuid[eax = 7, ecx = 0].ebx
+static constexpr u32 cpuid_7_ebx_bit_avx2 = 1 << 5;
+static constexpr u32 cpuid_7_ebx_bit_sha = 1 << 29;
+
+// The OS has to save the upper halves of the ymm registers as well, otherwise AVX can't be used at all.
+static bool os_saves_avx_state()
+{
+    u32 eax, edx;
+    asm volatile("xgetbv"
+                 : "=a"(eax), "=d"(edx)
+                 : "c"(0));
+    return (eax & 0b110) == 0b110;
+}
+#endif
+
+static CPUFeatures detect_cpu_features()
+{
+    CPUFeatures features;
+    if (getenv("LIBCRYPTO_NO_ACCELERATION"))
+        return features;
+
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+    u32 eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return features;
+    features.has_aes_ni = ecx & cpuid_1_ecx_bit_aes;
+    features.has_pclmul = ecx & cpuid_1_ecx_bit_pclmulqdq;
+
+    bool has_ssse3_and_sse4_1 = (ecx & cpuid_1_ecx_bit_ssse3) && (ecx & cpuid_1_ecx_bit_sse4_1);
+    bool has_avx_state = (ecx & cpuid_1_ecx_bit_osxsave) && os_saves_avx_state();
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return features;
+    features.has_sha_ni = has_ssse3_and_sse4_1 && (ebx & cpuid_7_ebx_bit_sha);
+    features.has_avx2 = has_avx_state && (ebx & cpuid_7_ebx_bit_avx2);
+#endif
+
+    return features;
+}
+
+CPUFeatures const& CPUFeatures::the()
+{
+    static CPUFeatures const s_features = detect_cpu_features();
+    return s_features;
+}
+
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Platform.h>
+
+// The kernel can't use vector registers freely, so it always takes the portable paths.
+#if ARCH(X86_64) && !defined(KERNEL)
+#    define CRYPTO_HAS_X86_64_ACCELERATION 1
+#endif
+
+namespace Crypto {
+
+struct CPUFeatures {
+    bool has_aes_ni { false };
+    bool has_pclmul { false };
+    // Also implies SSSE3 and SSE4.1, which every CPU with the SHA extensions has and all the shuffles need.
+    bool has_sha_ni { false };
+    bool has_avx2 { false };
+
+    // Detected once per process. Setting LIBCRYPTO_NO_ACCELERATION in the environment turns everything off, which is
+    // mostly useful for comparing against the portable implementations.
+    static CPUFeatures const& the();
+};
+
+}
@@ -4,9 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteReader.h>
 #include <AK/StringBuilder.h>
 #include <LibCrypto/Cipher/AES.h>
-#include <LibCrypto/Cipher/AESTables.h>
 
 namespace Crypto::Cipher {
 
@@ -41,124 +41,278 @@ ByteString AESCipherKey::to_byte_string() const
 }
 #endif
 
-void AESCipherKey::expand_encrypt_key(ReadonlyBytes user_key, size_t bits)
+static constexpr u32 rotate_left(u32 word, unsigned bits)
 {
-    u32* round_key;
-    u32 temp;
-    size_t i { 0 };
+    return (word << bits) | (word >> (32 - bits));
+}
 
-    VERIFY(!user_key.is_null());
-    VERIFY(is_valid_key_size(bits));
-    VERIFY(user_key.size() == bits / 8);
+// The portable implementation is bitsliced, so that neither its memory accesses nor its timing depend on the key or
+// the data: the state is spread over eight words that each hold one bit of every byte, and the S-box is a boolean
+// circuit instead of a table. This follows the constant-time AES of BearSSL by Thomas Pornin, which works on two
+// blocks at once. The block cipher interface only ever gives us one block, so half of every word goes unused.
+namespace Bitsliced {
 
-    round_key = round_keys();
+// The circuit of Boyar and Peralta, "A new combinational logic minimization technique with applications to
+// cryptology" (https://eprint.iacr.org/2009/191). x0 is the most significant bit of the byte, and x7 the least.
+static void substitute_bytes(u32* q)
+{
+    u32 x0 = q[7];
+    u32 x1 = q[6];
+    u32 x2 = q[5];
+    u32 x3 = q[4];
+    u32 x4 = q[3];
+    u32 x5 = q[2];
+    u32 x6 = q[1];
+    u32 x7 = q[0];
+
+    // Top linear transformation.
+    u32 y14 = x3 ^ x5;
+    u32 y13 = x0 ^ x6;
+    u32 y9 = x0 ^ x3;
+    u32 y8 = x0 ^ x5;
+    u32 t0 = x1 ^ x2;
+    u32 y1 = t0 ^ x7;
+    u32 y4 = y1 ^ x3;
+    u32 y12 = y13 ^ y14;
+    u32 y2 = y1 ^ x0;
+    u32 y5 = y1 ^ x6;
+    u32 y3 = y5 ^ y8;
+    u32 t1 = x4 ^ y12;
+    u32 y15 = t1 ^ x5;
+    u32 y20 = t1 ^ x1;
+    u32 y6 = y15 ^ x7;
+    u32 y10 = y15 ^ t0;
+    u32 y11 = y20 ^ y9;
+    u32 y7 = x7 ^ y11;
+    u32 y17 = y10 ^ y11;
+    u32 y19 = y10 ^ y8;
+    u32 y16 = t0 ^ y11;
+    u32 y21 = y13 ^ y16;
+    u32 y18 = x0 ^ y16;
+
+    // Non-linear section.
+    u32 t2 = y12 & y15;
+    u32 t3 = y3 & y6;
+    u32 t4 = t3 ^ t2;
+    u32 t5 = y4 & x7;
+    u32 t6 = t5 ^ t2;
+    u32 t7 = y13 & y16;
+    u32 t8 = y5 & y1;
+    u32 t9 = t8 ^ t7;
+    u32 t10 = y2 & y7;
+    u32 t11 = t10 ^ t7;
+    u32 t12 = y9 & y11;
+    u32 t13 = y14 & y17;
+    u32 t14 = t13 ^ t12;
+    u32 t15 = y8 & y10;
+    u32 t16 = t15 ^ t12;
+    u32 t17 = t4 ^ t14;
+    u32 t18 = t6 ^ t16;
+    u32 t19 = t9 ^ t14;
+    u32 t20 = t11 ^ t16;
+    u32 t21 = t17 ^ y20;
+    u32 t22 = t18 ^ y19;
+    u32 t23 = t19 ^ y21;
+    u32 t24 = t20 ^ y18;
+
+    u32 t25 = t21 ^ t22;
+    u32 t26 = t21 & t23;
+    u32 t27 = t24 ^ t26;
+    u32 t28 = t25 & t27;
+    u32 t29 = t28 ^ t22;
+    u32 t30 = t23 ^ t24;
+    u32 t31 = t22 ^ t26;
+    u32 t32 = t31 & t30;
+    u32 t33 = t32 ^ t24;
+    u32 t34 = t23 ^ t33;
+    u32 t35 = t27 ^ t33;
+    u32 t36 = t24 & t35;
+    u32 t37 = t36 ^ t34;
+    u32 t38 = t27 ^ t36;
+    u32 t39 = t29 & t38;
+    u32 t40 = t25 ^ t39;
+
+    u32 t41 = t40 ^ t37;
+    u32 t42 = t29 ^ t33;
+    u32 t43 = t29 ^ t40;
+    u32 t44 = t33 ^ t37;
+    u32 t45 = t42 ^ t41;
+    u32 z0 = t44 & y15;
+    u32 z1 = t37 & y6;
+    u32 z2 = t33 & x7;
+    u32 z3 = t43 & y16;
+    u32 z4 = t40 & y1;
+    u32 z5 = t29 & y7;
+    u32 z6 = t42 & y11;
+    u32 z7 = t45 & y17;
+    u32 z8 = t41 & y10;
+    u32 z9 = t44 & y12;
+    u32 z10 = t37 & y3;
+    u32 z11 = t33 & y4;
+    u32 z12 = t43 & y13;
+    u32 z13 = t40 & y5;
+    u32 z14 = t29 & y2;
+    u32 z15 = t42 & y9;
+    u32 z16 = t45 & y14;
+    u32 z17 = t41 & y8;
+
+    // Bottom linear transformation.
+    u32 t46 = z15 ^ z16;
+    u32 t47 = z10 ^ z11;
+    u32 t48 = z5 ^ z13;
+    u32 t49 = z9 ^ z10;
+    u32 t50 = z2 ^ z12;
+    u32 t51 = z2 ^ z5;
+    u32 t52 = z7 ^ z8;
+    u32 t53 = z0 ^ z3;
+    u32 t54 = z6 ^ z7;
+    u32 t55 = z16 ^ z17;
+    u32 t56 = z12 ^ t48;
+    u32 t57 = t50 ^ t53;
+    u32 t58 = z4 ^ t46;
+    u32 t59 = z3 ^ t54;
+    u32 t60 = t46 ^ t57;
+    u32 t61 = z14 ^ t57;
+    u32 t62 = t52 ^ t58;
+    u32 t63 = t49 ^ t58;
+    u32 t64 = z4 ^ t59;
+    u32 t65 = t61 ^ t62;
+    u32 t66 = z1 ^ t63;
+    u32 s0 = t59 ^ t63;
+    u32 s6 = t56 ^ ~t62;
+    u32 s7 = t48 ^ ~t60;
+    u32 t67 = t64 ^ t65;
+    u32 s3 = t53 ^ t66;
+    u32 s4 = t51 ^ t66;
+    u32 s5 = t47 ^ t65;
+    u32 s1 = t64 ^ ~s3;
+    u32 s2 = t55 ^ ~t67;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
 
-    if (bits == 128) {
-        m_rounds = 10;
-    } else if (bits == 192) {
-        m_rounds = 12;
-    } else {
-        m_rounds = 14;
-    }
+// The S-box is S(x) = A(I(x)) ^ 0x63, where I() is the inversion in GF(2^8) and A() an affine transformation. As I()
+// is its own inverse, the inverse S-box is B(S(B(x ^ 0x63)) ^ 0x63), with B() being the inverse of A().
+static void inverse_affine_transformation(u32* q)
+{
+    u32 q0 = ~q[0];
+    u32 q1 = ~q[1];
+    u32 q2 = q[2];
+    u32 q3 = q[3];
+    u32 q4 = q[4];
+    u32 q5 = ~q[5];
+    u32 q6 = ~q[6];
+    u32 q7 = q[7];
+    q[7] = q1 ^ q4 ^ q6;
+    q[6] = q0 ^ q3 ^ q5;
+    q[5] = q7 ^ q2 ^ q4;
+    q[4] = q6 ^ q1 ^ q3;
+    q[3] = q5 ^ q0 ^ q2;
+    q[2] = q4 ^ q7 ^ q1;
+    q[1] = q3 ^ q6 ^ q0;
+    q[0] = q2 ^ q5 ^ q7;
+}
 
-    round_key[0] = get_key(user_key.data());
-    round_key[1] = get_key(user_key.data() + 4);
-    round_key[2] = get_key(user_key.data() + 8);
-    round_key[3] = get_key(user_key.data() + 12);
-    if (bits == 128) {
-        for (;;) {
-            temp = round_key[3];
-            // clang-format off
-            round_key[4] = round_key[0] ^
-                    (AESTables::Encode2[(temp >> 16) & 0xff] & 0xff000000) ^
-                    (AESTables::Encode3[(temp >>  8) & 0xff] & 0x00ff0000) ^
-                    (AESTables::Encode0[(temp      ) & 0xff] & 0x0000ff00) ^
-                    (AESTables::Encode1[(temp >> 24)       ] & 0x000000ff) ^ AESTables::RCON[i];
-            // clang-format on
-            round_key[5] = round_key[1] ^ round_key[4];
-            round_key[6] = round_key[2] ^ round_key[5];
-            round_key[7] = round_key[3] ^ round_key[6];
-            ++i;
-            if (i == 10)
-                break;
-            round_key += 4;
-        }
-        return;
-    }
+static void inverse_substitute_bytes(u32* q)
+{
+    inverse_affine_transformation(q);
+    substitute_bytes(q);
+    inverse_affine_transformation(q);
+}
 
-    round_key[4] = get_key(user_key.data() + 16);
-    round_key[5] = get_key(user_key.data() + 20);
-    if (bits == 192) {
-        for (;;) {
-            temp = round_key[5];
-            // clang-format off
-            round_key[6] = round_key[0] ^
-                    (AESTables::Encode2[(temp >> 16) & 0xff] & 0xff000000) ^
-                    (AESTables::Encode3[(temp >>  8) & 0xff] & 0x00ff0000) ^
-                    (AESTables::Encode0[(temp      ) & 0xff] & 0x0000ff00) ^
-                    (AESTables::Encode1[(temp >> 24)       ] & 0x000000ff) ^ AESTables::RCON[i];
-            // clang-format on
-            round_key[7] = round_key[1] ^ round_key[6];
-            round_key[8] = round_key[2] ^ round_key[7];
-            round_key[9] = round_key[3] ^ round_key[8];
-
-            ++i;
-            if (i == 8)
-                break;
-
-            round_key[10] = round_key[4] ^ round_key[9];
-            round_key[11] = round_key[5] ^ round_key[10];
-
-            round_key += 6;
-        }
-        return;
-    }
+// Converts between eight words holding two blocks, and eight words that each hold one bit of every byte of them. The
+// conversion is its own inverse.
+static void orthogonalize(u32* q)
+{
+    auto swap = [](u32& x, u32& y, u32 low_mask, u32 high_mask, unsigned shift) {
+        u32 a = x;
+        u32 b = y;
+        x = (a & low_mask) | ((b & low_mask) << shift);
+        y = ((a & high_mask) >> shift) | (b & high_mask);
+    };
+
+    for (size_t i = 0; i < 8; i += 2)
+        swap(q[i], q[i + 1], 0x55555555, 0xaaaaaaaa, 1);
+    for (size_t i : { 0u, 1u, 4u, 5u })
+        swap(q[i], q[i + 2], 0x33333333, 0xcccccccc, 2);
+    for (size_t i = 0; i < 4; ++i)
+        swap(q[i], q[i + 4], 0x0f0f0f0f, 0xf0f0f0f0, 4);
+}
 
-    round_key[6] = get_key(user_key.data() + 24);
-    round_key[7] = get_key(user_key.data() + 28);
-    if (true) { // bits == 256
-        for (;;) {
-            temp = round_key[7];
-            // clang-format off
-            round_key[8] = round_key[0] ^
-                    (AESTables::Encode2[(temp >> 16) & 0xff] & 0xff000000) ^
-                    (AESTables::Encode3[(temp >>  8) & 0xff] & 0x00ff0000) ^
-                    (AESTables::Encode0[(temp      ) & 0xff] & 0x0000ff00) ^
-                    (AESTables::Encode1[(temp >> 24)       ] & 0x000000ff) ^ AESTables::RCON[i];
-            // clang-format on
-            round_key[9] = round_key[1] ^ round_key[8];
-            round_key[10] = round_key[2] ^ round_key[9];
-            round_key[11] = round_key[3] ^ round_key[10];
-
-            ++i;
-            if (i == 7)
-                break;
-
-            temp = round_key[11];
-            // clang-format off
-            round_key[12] = round_key[4] ^
-                    (AESTables::Encode2[(temp >> 24)       ] & 0xff000000) ^
-                    (AESTables::Encode3[(temp >> 16) & 0xff] & 0x00ff0000) ^
-                    (AESTables::Encode0[(temp >>  8) & 0xff] & 0x0000ff00) ^
-                    (AESTables::Encode1[(temp      ) & 0xff] & 0x000000ff) ;
-            // clang-format on
-            round_key[13] = round_key[5] ^ round_key[12];
-            round_key[14] = round_key[6] ^ round_key[13];
-            round_key[15] = round_key[7] ^ round_key[14];
-
-            round_key += 8;
-        }
-        return;
+static u32 substitute_word(u32 word)
+{
+    u32 q[8];
+    for (auto& bits : q)
+        bits = word;
+    orthogonalize(q);
+    substitute_bytes(q);
+    orthogonalize(q);
+    return q[0];
+}
+
+}
+
+// Multiplies every byte of the word by x in GF(2^8), without branching on the high bits.
+static constexpr u32 multiply_bytes_by_x(u32 word)
+{
+    return ((word & 0x7f7f7f7f) << 1) ^ (((word >> 7) & 0x01010101) * 0x1b);
+}
+
+static constexpr u32 inverse_mix_column(u32 column)
+{
+    auto times_2 = multiply_bytes_by_x(column);
+    auto times_4 = multiply_bytes_by_x(times_2);
+    auto times_8 = multiply_bytes_by_x(times_4);
+    auto times_9 = times_8 ^ column;
+    auto times_11 = times_9 ^ times_2;
+    auto times_13 = times_9 ^ times_4;
+    auto times_14 = times_8 ^ times_4 ^ times_2;
+    return times_14 ^ rotate_left(times_11, 8) ^ rotate_left(times_13, 16) ^ rotate_left(times_9, 24);
+}
+
+static constexpr u32 round_constants[] = {
+    0x01000000, 0x02000000, 0x04000000, 0x08000000, 0x10000000,
+    0x20000000, 0x40000000, 0x80000000, 0x1b000000, 0x36000000
+};
+
+void AESCipherKey::expand_encrypt_key(ReadonlyBytes user_key, size_t bits)
+{
+    VERIFY(!user_key.is_null());
+    VERIFY(is_valid_key_size(bits));
+    VERIFY(user_key.size() == bits / 8);
+
+    size_t key_words = bits / 32;
+    m_rounds = key_words + 6;
+
+    // FIPS 197, 5.2 Key Expansion.
+    auto* round_key = round_keys();
+    for (size_t i = 0; i < key_words; ++i)
+        round_key[i] = get_key(user_key.offset_pointer(i * 4));
+    for (size_t i = key_words; i < (m_rounds + 1) * 4; ++i) {
+        auto temp = round_key[i - 1];
+        if (i % key_words == 0)
+            temp = Bitsliced::substitute_word(rotate_left(temp, 8)) ^ round_constants[i / key_words - 1];
+        else if (key_words > 6 && i % key_words == 4)
+            temp = Bitsliced::substitute_word(temp);
+        round_key[i] = round_key[i - key_words] ^ temp;
     }
+
+    update_bitsliced_round_keys();
+    update_hardware_round_keys();
 }
 
 void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
 {
-    u32* round_key;
-
     expand_encrypt_key(user_key, bits);
 
-    round_key = round_keys();
+    auto* round_key = round_keys();
 
     // reorder round keys
     for (size_t i = 0, j = 4 * rounds(); i < j; i += 4, j -= 4) {
@@ -169,209 +323,209 @@ void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
     }
 
     // apply inverse mix-column to middle rounds
-    for (size_t i = 1; i < rounds(); ++i) {
-        round_key += 4;
-        // clang-format off
-        round_key[0] =
-                AESTables::Decode0[AESTables::Encode1[(round_key[0] >> 24)       ] & 0xff] ^
-                AESTables::Decode1[AESTables::Encode1[(round_key[0] >> 16) & 0xff] & 0xff] ^
-                AESTables::Decode2[AESTables::Encode1[(round_key[0] >>  8) & 0xff] & 0xff] ^
-                AESTables::Decode3[AESTables::Encode1[(round_key[0]      ) & 0xff] & 0xff] ;
-        round_key[1] =
-                AESTables::Decode0[AESTables::Encode1[(round_key[1] >> 24)       ] & 0xff] ^
-                AESTables::Decode1[AESTables::Encode1[(round_key[1] >> 16) & 0xff] & 0xff] ^
-                AESTables::Decode2[AESTables::Encode1[(round_key[1] >>  8) & 0xff] & 0xff] ^
-                AESTables::Decode3[AESTables::Encode1[(round_key[1]      ) & 0xff] & 0xff] ;
-        round_key[2] =
-                AESTables::Decode0[AESTables::Encode1[(round_key[2] >> 24)       ] & 0xff] ^
-                AESTables::Decode1[AESTables::Encode1[(round_key[2] >> 16) & 0xff] & 0xff] ^
-                AESTables::Decode2[AESTables::Encode1[(round_key[2] >>  8) & 0xff] & 0xff] ^
-                AESTables::Decode3[AESTables::Encode1[(round_key[2]      ) & 0xff] & 0xff] ;
-        round_key[3] =
-                AESTables::Decode0[AESTables::Encode1[(round_key[3] >> 24)       ] & 0xff] ^
-                AESTables::Decode1[AESTables::Encode1[(round_key[3] >> 16) & 0xff] & 0xff] ^
-                AESTables::Decode2[AESTables::Encode1[(round_key[3] >>  8) & 0xff] & 0xff] ^
-                AESTables::Decode3[AESTables::Encode1[(round_key[3]      ) & 0xff] & 0xff] ;
-        // clang-format on
+    for (size_t i = 4; i < rounds() * 4; ++i)
+        round_key[i] = inverse_mix_column(round_key[i]);
+
+    update_hardware_round_keys();
+}
+
+void AESCipherKey::update_bitsliced_round_keys()
+{
+    // Both halves of the state get the same round key. The bitsliced decryption applies the inverse MixColumns to the
+    // state instead of the round keys, so it uses this schedule as well.
+    auto const* keys = round_keys();
+    for (size_t round = 0; round <= rounds(); ++round) {
+        auto* q = m_bitsliced_round_keys + round * 8;
+        // The bitsliced code reads the columns as little-endian words, ours are big-endian.
+        for (size_t i = 0; i < 4; ++i)
+            q[i * 2] = q[i * 2 + 1] = __builtin_bswap32(keys[round * 4 + i]);
+        Bitsliced::orthogonalize(q);
     }
 }
 
-void AESCipher::encrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
+void AESCipherKey::update_hardware_round_keys()
 {
-    u32 s0, s1, s2, s3, t0, t1, t2, t3;
-    size_t r { 0 };
-
-    auto const& dec_key = key();
-    auto const* round_keys = dec_key.round_keys();
-
-    s0 = get_key(in.bytes().offset_pointer(0)) ^ round_keys[0];
-    s1 = get_key(in.bytes().offset_pointer(4)) ^ round_keys[1];
-    s2 = get_key(in.bytes().offset_pointer(8)) ^ round_keys[2];
-    s3 = get_key(in.bytes().offset_pointer(12)) ^ round_keys[3];
-
-    r = dec_key.rounds() >> 1;
-
-    // apply the first |r - 1| rounds
-    for (;;) {
-        // clang-format off
-        t0 = AESTables::Encode0[(s0 >> 24)       ] ^
-             AESTables::Encode1[(s1 >> 16) & 0xff] ^
-             AESTables::Encode2[(s2 >>  8) & 0xff] ^
-             AESTables::Encode3[(s3      ) & 0xff] ^ round_keys[4];
-        t1 = AESTables::Encode0[(s1 >> 24)       ] ^
-             AESTables::Encode1[(s2 >> 16) & 0xff] ^
-             AESTables::Encode2[(s3 >>  8) & 0xff] ^
-             AESTables::Encode3[(s0      ) & 0xff] ^ round_keys[5];
-        t2 = AESTables::Encode0[(s2 >> 24)       ] ^
-             AESTables::Encode1[(s3 >> 16) & 0xff] ^
-             AESTables::Encode2[(s0 >>  8) & 0xff] ^
-             AESTables::Encode3[(s1      ) & 0xff] ^ round_keys[6];
-        t3 = AESTables::Encode0[(s3 >> 24)       ] ^
-             AESTables::Encode1[(s0 >> 16) & 0xff] ^
-             AESTables::Encode2[(s1 >>  8) & 0xff] ^
-             AESTables::Encode3[(s2      ) & 0xff] ^ round_keys[7];
-        // clang-format on
-
-        round_keys += 8;
-        --r;
-        if (r == 0)
-            break;
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+    m_has_hardware_round_keys = CPUFeatures::the().has_aes_ni;
+    if (!m_has_hardware_round_keys)
+        return;
+
+    // Both key schedules are already in the order AES-NI expects, the decryption one is the "equivalent inverse cipher"
+    // schedule that aesdec is built for. Only the byte order of the words differs.
+    auto const* keys = round_keys();
+    for (size_t i = 0; i < (rounds() + 1) * 4; ++i)
+        ByteReader::store(m_hardware_round_keys + i * 4, AK::convert_between_host_and_big_endian(keys[i]));
+#endif
+}
+
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+// This matches the vector type of the AES-NI builtins.
+using HardwareBlock = long long __attribute__((vector_size(16)));
+
+[[gnu::target("aes")]] static void encrypt_block_with_aes_ni(u8 const* round_keys, size_t rounds, u8 const* in, u8* out)
+{
+    auto const* keys = reinterpret_cast<HardwareBlock const*>(round_keys);
+
+    HardwareBlock state;
+    __builtin_memcpy(&state, in, sizeof(state));
+    state ^= keys[0];
+    for (size_t i = 1; i < rounds; ++i)
+        state = __builtin_ia32_aesenc128(state, keys[i]);
+    state = __builtin_ia32_aesenclast128(state, keys[rounds]);
+    __builtin_memcpy(out, &state, sizeof(state));
+}
+
+[[gnu::target("aes")]] static void decrypt_block_with_aes_ni(u8 const* round_keys, size_t rounds, u8 const* in, u8* out)
+{
+    auto const* keys = reinterpret_cast<HardwareBlock const*>(round_keys);
+
+    HardwareBlock state;
+    __builtin_memcpy(&state, in, sizeof(state));
+    state ^= keys[0];
+    for (size_t i = 1; i < rounds; ++i)
+        state = __builtin_ia32_aesdec128(state, keys[i]);
+    state = __builtin_ia32_aesdeclast128(state, keys[rounds]);
+    __builtin_memcpy(out, &state, sizeof(state));
+}
+#endif
+
+namespace Bitsliced {
+
+static void add_round_key(u32* q, u32 const* round_key)
+{
+    for (size_t i = 0; i < 8; ++i)
+        q[i] ^= round_key[i];
+}
 
-        // clang-format off
-        s0 = AESTables::Encode0[(t0 >> 24)       ] ^
-             AESTables::Encode1[(t1 >> 16) & 0xff] ^
-             AESTables::Encode2[(t2 >>  8) & 0xff] ^
-             AESTables::Encode3[(t3      ) & 0xff] ^ round_keys[0];
-        s1 = AESTables::Encode0[(t1 >> 24)       ] ^
-             AESTables::Encode1[(t2 >> 16) & 0xff] ^
-             AESTables::Encode2[(t3 >>  8) & 0xff] ^
-             AESTables::Encode3[(t0      ) & 0xff] ^ round_keys[1];
-        s2 = AESTables::Encode0[(t2 >> 24)       ] ^
-             AESTables::Encode1[(t3 >> 16) & 0xff] ^
-             AESTables::Encode2[(t0 >>  8) & 0xff] ^
-             AESTables::Encode3[(t1      ) & 0xff] ^ round_keys[2];
-        s3 = AESTables::Encode0[(t3 >> 24)       ] ^
-             AESTables::Encode1[(t0 >> 16) & 0xff] ^
-             AESTables::Encode2[(t1 >>  8) & 0xff] ^
-             AESTables::Encode3[(t2      ) & 0xff] ^ round_keys[3];
-        // clang-format on
+static void shift_rows(u32* q)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        u32 x = q[i];
+        q[i] = (x & 0x000000ff)
+            | ((x & 0x0000fc00) >> 2) | ((x & 0x00000300) << 6)
+            | ((x & 0x00f00000) >> 4) | ((x & 0x000f0000) << 4)
+            | ((x & 0xc0000000) >> 6) | ((x & 0x3f000000) << 2);
     }
+}
 
-    // apply the last round and put the encrypted data into out
-    // clang-format off
-    s0 = (AESTables::Encode2[(t0 >> 24)       ] & 0xff000000) ^
-         (AESTables::Encode3[(t1 >> 16) & 0xff] & 0x00ff0000) ^
-         (AESTables::Encode0[(t2 >>  8) & 0xff] & 0x0000ff00) ^
-         (AESTables::Encode1[(t3      ) & 0xff] & 0x000000ff) ^ round_keys[0];
-    out.put(0, s0);
-
-    s1 = (AESTables::Encode2[(t1 >> 24)       ] & 0xff000000) ^
-         (AESTables::Encode3[(t2 >> 16) & 0xff] & 0x00ff0000) ^
-         (AESTables::Encode0[(t3 >>  8) & 0xff] & 0x0000ff00) ^
-         (AESTables::Encode1[(t0      ) & 0xff] & 0x000000ff) ^ round_keys[1];
-    out.put(4, s1);
-
-    s2 = (AESTables::Encode2[(t2 >> 24)       ] & 0xff000000) ^
-         (AESTables::Encode3[(t3 >> 16) & 0xff] & 0x00ff0000) ^
-         (AESTables::Encode0[(t0 >>  8) & 0xff] & 0x0000ff00) ^
-         (AESTables::Encode1[(t1      ) & 0xff] & 0x000000ff) ^ round_keys[2];
-    out.put(8, s2);
-
-    s3 = (AESTables::Encode2[(t3 >> 24)       ] & 0xff000000) ^
-         (AESTables::Encode3[(t0 >> 16) & 0xff] & 0x00ff0000) ^
-         (AESTables::Encode0[(t1 >>  8) & 0xff] & 0x0000ff00) ^
-         (AESTables::Encode1[(t2      ) & 0xff] & 0x000000ff) ^ round_keys[3];
-    out.put(12, s3);
-    // clang-format on
+static void inverse_shift_rows(u32* q)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        u32 x = q[i];
+        q[i] = (x & 0x000000ff)
+            | ((x & 0x00003f00) << 2) | ((x & 0x0000c000) >> 6)
+            | ((x & 0x000f0000) << 4) | ((x & 0x00f00000) >> 4)
+            | ((x & 0x03000000) << 6) | ((x & 0xfc000000) >> 2);
+    }
 }
 
-void AESCipher::decrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
+static void mix_columns(u32* q)
 {
-    u32 s0, s1, s2, s3, t0, t1, t2, t3;
-    size_t r { 0 };
-
-    auto const& dec_key = key();
-    auto const* round_keys = dec_key.round_keys();
-
-    s0 = get_key(in.bytes().offset_pointer(0)) ^ round_keys[0];
-    s1 = get_key(in.bytes().offset_pointer(4)) ^ round_keys[1];
-    s2 = get_key(in.bytes().offset_pointer(8)) ^ round_keys[2];
-    s3 = get_key(in.bytes().offset_pointer(12)) ^ round_keys[3];
-
-    r = dec_key.rounds() >> 1;
-
-    // apply the first |r - 1| rounds
-    for (;;) {
-        // clang-format off
-        t0 = AESTables::Decode0[(s0 >> 24)       ] ^
-             AESTables::Decode1[(s3 >> 16) & 0xff] ^
-             AESTables::Decode2[(s2 >>  8) & 0xff] ^
-             AESTables::Decode3[(s1      ) & 0xff] ^ round_keys[4];
-        t1 = AESTables::Decode0[(s1 >> 24)       ] ^
-             AESTables::Decode1[(s0 >> 16) & 0xff] ^
-             AESTables::Decode2[(s3 >>  8) & 0xff] ^
-             AESTables::Decode3[(s2      ) & 0xff] ^ round_keys[5];
-        t2 = AESTables::Decode0[(s2 >> 24)       ] ^
-             AESTables::Decode1[(s1 >> 16) & 0xff] ^
-             AESTables::Decode2[(s0 >>  8) & 0xff] ^
-             AESTables::Decode3[(s3      ) & 0xff] ^ round_keys[6];
-        t3 = AESTables::Decode0[(s3 >> 24)       ] ^
-             AESTables::Decode1[(s2 >> 16) & 0xff] ^
-             AESTables::Decode2[(s1 >>  8) & 0xff] ^
-             AESTables::Decode3[(s0      ) & 0xff] ^ round_keys[7];
-        // clang-format on
-
-        round_keys += 8;
-        --r;
-        if (r == 0)
-            break;
+    u32 q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3], q4 = q[4], q5 = q[5], q6 = q[6], q7 = q[7];
+    u32 r0 = rotate_left(q0, 24), r1 = rotate_left(q1, 24), r2 = rotate_left(q2, 24), r3 = rotate_left(q3, 24);
+    u32 r4 = rotate_left(q4, 24), r5 = rotate_left(q5, 24), r6 = rotate_left(q6, 24), r7 = rotate_left(q7, 24);
+
+    q[0] = q7 ^ r7 ^ r0 ^ rotate_left(q0 ^ r0, 16);
+    q[1] = q0 ^ r0 ^ q7 ^ r7 ^ r1 ^ rotate_left(q1 ^ r1, 16);
+    q[2] = q1 ^ r1 ^ r2 ^ rotate_left(q2 ^ r2, 16);
+    q[3] = q2 ^ r2 ^ q7 ^ r7 ^ r3 ^ rotate_left(q3 ^ r3, 16);
+    q[4] = q3 ^ r3 ^ q7 ^ r7 ^ r4 ^ rotate_left(q4 ^ r4, 16);
+    q[5] = q4 ^ r4 ^ r5 ^ rotate_left(q5 ^ r5, 16);
+    q[6] = q5 ^ r5 ^ r6 ^ rotate_left(q6 ^ r6, 16);
+    q[7] = q6 ^ r6 ^ r7 ^ rotate_left(q7 ^ r7, 16);
+}
+
+static void inverse_mix_columns(u32* q)
+{
+    u32 q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3], q4 = q[4], q5 = q[5], q6 = q[6], q7 = q[7];
+    u32 r0 = rotate_left(q0, 24), r1 = rotate_left(q1, 24), r2 = rotate_left(q2, 24), r3 = rotate_left(q3, 24);
+    u32 r4 = rotate_left(q4, 24), r5 = rotate_left(q5, 24), r6 = rotate_left(q6, 24), r7 = rotate_left(q7, 24);
+
+    q[0] = q5 ^ q6 ^ q7 ^ r0 ^ r5 ^ r7 ^ rotate_left(q0 ^ q5 ^ q6 ^ r0 ^ r5, 16);
+    q[1] = q0 ^ q5 ^ r0 ^ r1 ^ r5 ^ r6 ^ r7 ^ rotate_left(q1 ^ q5 ^ q7 ^ r1 ^ r5 ^ r6, 16);
+    q[2] = q0 ^ q1 ^ q6 ^ r1 ^ r2 ^ r6 ^ r7 ^ rotate_left(q0 ^ q2 ^ q6 ^ r2 ^ r6 ^ r7, 16);
+    q[3] = q0 ^ q1 ^ q2 ^ q5 ^ q6 ^ r0 ^ r2 ^ r3 ^ r5 ^ rotate_left(q0 ^ q1 ^ q3 ^ q5 ^ q6 ^ q7 ^ r0 ^ r3 ^ r5 ^ r7, 16);
+    q[4] = q1 ^ q2 ^ q3 ^ q5 ^ r1 ^ r3 ^ r4 ^ r5 ^ r6 ^ r7 ^ rotate_left(q1 ^ q2 ^ q4 ^ q5 ^ q7 ^ r1 ^ r4 ^ r5 ^ r6, 16);
+    q[5] = q2 ^ q3 ^ q4 ^ q6 ^ r2 ^ r4 ^ r5 ^ r6 ^ r7 ^ rotate_left(q2 ^ q3 ^ q5 ^ q6 ^ r2 ^ r5 ^ r6 ^ r7, 16);
+    q[6] = q3 ^ q4 ^ q5 ^ q7 ^ r3 ^ r5 ^ r6 ^ r7 ^ rotate_left(q3 ^ q4 ^ q6 ^ q7 ^ r3 ^ r6 ^ r7, 16);
+    q[7] = q4 ^ q5 ^ q6 ^ r4 ^ r6 ^ r7 ^ rotate_left(q4 ^ q5 ^ q7 ^ r4 ^ r7, 16);
+}
+
+// The block goes into the even words, the odd ones are the unused second block.
+static void load_block(u8 const* in, u32* q)
+{
+    for (size_t i = 0; i < 4; ++i) {
+        q[i * 2] = AK::convert_between_host_and_little_endian(ByteReader::load32(in + i * 4));
+        q[i * 2 + 1] = 0;
+    }
+    orthogonalize(q);
+}
+
+static void store_block(u32* q, u8* out)
+{
+    orthogonalize(q);
+    for (size_t i = 0; i < 4; ++i)
+        ByteReader::store(out + i * 4, AK::convert_between_host_and_little_endian(q[i * 2]));
+}
+
+static void encrypt(u32 const* round_keys, size_t rounds, u8 const* in, u8* out)
+{
+    u32 q[8];
+    load_block(in, q);
+    add_round_key(q, round_keys);
+    for (size_t round = 1; round < rounds; ++round) {
+        substitute_bytes(q);
+        shift_rows(q);
+        mix_columns(q);
+        add_round_key(q, round_keys + round * 8);
+    }
+    substitute_bytes(q);
+    shift_rows(q);
+    add_round_key(q, round_keys + rounds * 8);
+    store_block(q, out);
+}
+
+static void decrypt(u32 const* round_keys, size_t rounds, u8 const* in, u8* out)
+{
+    u32 q[8];
+    load_block(in, q);
+    add_round_key(q, round_keys + rounds * 8);
+    for (size_t round = rounds - 1; round > 0; --round) {
+        inverse_shift_rows(q);
+        inverse_substitute_bytes(q);
+        add_round_key(q, round_keys + round * 8);
+        inverse_mix_columns(q);
+    }
+    inverse_shift_rows(q);
+    inverse_substitute_bytes(q);
+    add_round_key(q, round_keys);
+    store_block(q, out);
+}
+
+}
 
-        // clang-format off
-        s0 = AESTables::Decode0[(t0 >> 24)       ] ^
-             AESTables::Decode1[(t3 >> 16) & 0xff] ^
-             AESTables::Decode2[(t2 >>  8) & 0xff] ^
-             AESTables::Decode3[(t1      ) & 0xff] ^ round_keys[0];
-        s1 = AESTables::Decode0[(t1 >> 24)       ] ^
-             AESTables::Decode1[(t0 >> 16) & 0xff] ^
-             AESTables::Decode2[(t3 >>  8) & 0xff] ^
-             AESTables::Decode3[(t2      ) & 0xff] ^ round_keys[1];
-        s2 = AESTables::Decode0[(t2 >> 24)       ] ^
-             AESTables::Decode1[(t1 >> 16) & 0xff] ^
-             AESTables::Decode2[(t0 >>  8) & 0xff] ^
-             AESTables::Decode3[(t3      ) & 0xff] ^ round_keys[2];
-        s3 = AESTables::Decode0[(t3 >> 24)       ] ^
-             AESTables::Decode1[(t2 >> 16) & 0xff] ^
-             AESTables::Decode2[(t1 >>  8) & 0xff] ^
-             AESTables::Decode3[(t0      ) & 0xff] ^ round_keys[3];
-        // clang-format on
+void AESCipher::encrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
+{
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+    if (auto const* hardware_round_keys = key().hardware_round_keys()) {
+        encrypt_block_with_aes_ni(hardware_round_keys, key().rounds(), in.bytes().data(), out.bytes().data());
+        return;
     }
+#endif
+
+    Bitsliced::encrypt(key().bitsliced_round_keys(), key().rounds(), in.bytes().data(), out.bytes().data());
+}
+
+void AESCipher::decrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
+{
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+    if (auto const* hardware_round_keys = key().hardware_round_keys()) {
+        decrypt_block_with_aes_ni(hardware_round_keys, key().rounds(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
 
-    // apply the last round and put the decrypted data into out
-    // clang-format off
-    s0 = ((u32)AESTables::Decode4[(t0 >> 24)       ] << 24) ^
-         ((u32)AESTables::Decode4[(t3 >> 16) & 0xff] << 16) ^
-         ((u32)AESTables::Decode4[(t2 >>  8) & 0xff] <<  8) ^
-         ((u32)AESTables::Decode4[(t1      ) & 0xff]      ) ^ round_keys[0];
-    out.put(0, s0);
-
-    s1 = ((u32)AESTables::Decode4[(t1 >> 24)       ] << 24) ^
-         ((u32)AESTables::Decode4[(t0 >> 16) & 0xff] << 16) ^
-         ((u32)AESTables::Decode4[(t3 >>  8) & 0xff] <<  8) ^
-         ((u32)AESTables::Decode4[(t2      ) & 0xff]      ) ^ round_keys[1];
-    out.put(4, s1);
-
-    s2 = ((u32)AESTables::Decode4[(t2 >> 24)       ] << 24) ^
-         ((u32)AESTables::Decode4[(t1 >> 16) & 0xff] << 16) ^
-         ((u32)AESTables::Decode4[(t0 >>  8) & 0xff] <<  8) ^
-         ((u32)AESTables::Decode4[(t3      ) & 0xff]      ) ^ round_keys[2];
-    out.put(8, s2);
-
-    s3 = ((u32)AESTables::Decode4[(t3 >> 24)       ] << 24) ^
-         ((u32)AESTables::Decode4[(t2 >> 16) & 0xff] << 16) ^
-         ((u32)AESTables::Decode4[(t1 >>  8) & 0xff] <<  8) ^
-         ((u32)AESTables::Decode4[(t0      ) & 0xff]      ) ^ round_keys[3];
-    out.put(12, s3);
-    // clang-format on
+    Bitsliced::decrypt(key().bitsliced_round_keys(), key().rounds(), in.bytes().data(), out.bytes().data());
 }
 
 void AESCipherBlock::overwrite(ReadonlyBytes bytes)
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <AK/Vector.h>
+#include <LibCrypto/CPUFeatures.h>
 #include <LibCrypto/Cipher/Cipher.h>
 #include <LibCrypto/Cipher/Mode/CBC.h>
 #include <LibCrypto/Cipher/Mode/CTR.h>
@@ -86,6 +87,14 @@ struct AESCipherKey : public CipherKey {
     size_t rounds() const { return m_rounds; }
     size_t length() const { return m_bits / 8; }
 
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+    // The same round keys as bytes, which is what AES-NI wants. Null if the CPU doesn't support AES-NI.
+    u8 const* hardware_round_keys() const { return m_has_hardware_round_keys ? m_hardware_round_keys : nullptr; }
+#endif
+
+    // The encryption round keys in the layout of the bitsliced implementation, for both intents.
+    u32 const* bitsliced_round_keys() const { return m_bitsliced_round_keys; }
+
 protected:
     u32* round_keys()
     {
@@ -93,8 +102,16 @@ protected:
     }
 
 private:
+    void update_bitsliced_round_keys();
+    void update_hardware_round_keys();
+
     static constexpr size_t MAX_ROUND_COUNT = 14;
     u32 m_rd_keys[(MAX_ROUND_COUNT + 1) * 4] { 0 };
+    u32 m_bitsliced_round_keys[(MAX_ROUND_COUNT + 1) * 8] { 0 };
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+    alignas(16) u8 m_hardware_round_keys[(MAX_ROUND_COUNT + 1) * 16] { 0 };
+    bool m_has_hardware_round_keys { false };
+#endif
     size_t m_rounds;
     size_t m_bits;
 };
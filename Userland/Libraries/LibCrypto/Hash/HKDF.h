@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <LibCrypto/Authentication/HMAC.h>
+
+namespace Crypto::Hash {
+
+// https://www.rfc-editor.org/rfc/rfc5869
+template<typename HashT>
+class HKDF {
+public:
+    using PRF = Authentication::HMAC<HashT>;
+
+    // https://www.rfc-editor.org/rfc/rfc5869#section-2.2
+    template<typename... Args>
+    static ErrorOr<ByteBuffer> extract(ReadonlyBytes salt, ReadonlyBytes input_key_material, Args... args)
+    {
+        // Note: An empty salt is the same as a string of HashLen zeros, as HMAC pads the key with zeros anyway.
+        PRF prf(salt, args...);
+        auto digest = prf.process(input_key_material);
+        return ByteBuffer::copy(digest.immutable_data(), prf.digest_size());
+    }
+
+    // https://www.rfc-editor.org/rfc/rfc5869#section-2.3
+    template<typename... Args>
+    static ErrorOr<ByteBuffer> expand(ReadonlyBytes pseudorandom_key, ReadonlyBytes info, size_t output_length, Args... args)
+    {
+        PRF prf(pseudorandom_key, args...);
+        size_t hash_length = prf.digest_size();
+
+        if (output_length > 255 * hash_length)
+            return Error::from_string_view("HKDF output too long"sv);
+
+        // T(0) = empty string
+        // T(i) = HMAC-Hash(PRK, T(i - 1) | info | i)
+        auto output = TRY(ByteBuffer::create_uninitialized(output_length));
+        ReadonlyBytes previous_block;
+        u8 counter = 1;
+        for (size_t offset = 0; offset < output_length; offset += hash_length, ++counter) {
+            prf.update(previous_block);
+            prf.update(info);
+            prf.update(&counter, 1);
+            auto block = prf.digest();
+
+            auto size = min(hash_length, output_length - offset);
+            output.overwrite(offset, block.immutable_data(), size);
+            previous_block = output.bytes().slice(offset, size);
+        }
+        return output;
+    }
+};
+
+}
@@ -157,6 +157,16 @@ public:
             m_algorithm = Empty {};
             break;
         }
+
+        // Anything that was buffered before we knew which hash to use belongs at the start of the message.
+        if (!m_pre_init_buffer.is_empty()) {
+            m_algorithm.visit(
+                [&](Empty&) {},
+                [&](auto& hash) {
+                    hash.update(m_pre_init_buffer);
+                    m_pre_init_buffer.clear();
+                });
+        }
     }
 
     virtual void update(u8 const* data, size_t length) override
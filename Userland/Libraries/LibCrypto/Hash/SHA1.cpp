@@ -8,8 +8,13 @@
 #include <AK/Endian.h>
 #include <AK/Memory.h>
 #include <AK/Types.h>
+#include <LibCrypto/CPUFeatures.h>
 #include <LibCrypto/Hash/SHA1.h>
 
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+#    include <AK/SIMD.h>
+#endif
+
 namespace Crypto::Hash {
 
 static constexpr auto ROTATE_LEFT(u32 value, size_t bits)
@@ -67,20 +72,101 @@ inline void SHA1::transform(u8 const* data)
     secure_zero(blocks, 16 * sizeof(u32));
 }
 
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+using AK::SIMD::i32x4;
+using AK::SIMD::u8x16;
+
+// See "Intel SHA Extensions: New Instructions Supporting the Secure Hash Algorithm on Intel Architecture Processors".
+// The instructions keep a, b, c and d in one register with a in the highest lane, and e in the highest lane of another.
+[[gnu::target("sha,ssse3,sse4.1")]] static void transform_with_sha_ni(u32 (&state)[5], u8 const* data, size_t block_count)
+{
+    auto load_words = [](u8 const* data) {
+        u8x16 bytes;
+        __builtin_memcpy(&bytes, data, sizeof(bytes));
+        return (i32x4)__builtin_shufflevector(bytes, bytes, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    };
+    auto four_rounds = [](i32x4 abcd, i32x4 e, size_t group) {
+        switch (group / 5) {
+        case 0:
+            return __builtin_ia32_sha1rnds4(abcd, e, 0);
+        case 1:
+            return __builtin_ia32_sha1rnds4(abcd, e, 1);
+        case 2:
+            return __builtin_ia32_sha1rnds4(abcd, e, 2);
+        default:
+            return __builtin_ia32_sha1rnds4(abcd, e, 3);
+        }
+    };
+
+    i32x4 abcd { (i32)state[3], (i32)state[2], (i32)state[1], (i32)state[0] };
+    i32x4 e { 0, 0, 0, (i32)state[4] };
+
+    for (size_t block = 0; block < block_count; ++block, data += 64) {
+        auto saved_abcd = abcd;
+        auto saved_e = e;
+
+        // w[i % 4] holds the message words for the ith group of four rounds.
+        i32x4 w[4];
+        i32x4 previous_abcd = abcd;
+#pragma GCC unroll 20
+        for (size_t group = 0; group < 20; ++group) {
+            if (group < 4)
+                w[group] = load_words(data + group * 16);
+            else
+                w[group % 4] = __builtin_ia32_sha1msg2(__builtin_ia32_sha1msg1(w[group % 4], w[(group + 1) % 4]) ^ w[(group + 2) % 4], w[(group + 3) % 4]);
+
+            auto e_plus_words = group == 0 ? e + w[0] : __builtin_ia32_sha1nexte(previous_abcd, w[group % 4]);
+            previous_abcd = abcd;
+            abcd = four_rounds(abcd, e_plus_words, group);
+        }
+
+        e = __builtin_ia32_sha1nexte(previous_abcd, saved_e);
+        abcd += saved_abcd;
+    }
+
+    state[0] = abcd[3];
+    state[1] = abcd[2];
+    state[2] = abcd[1];
+    state[3] = abcd[0];
+    state[4] = e[3];
+}
+#endif
+
+void SHA1::transform_blocks(u8 const* data, size_t block_count)
+{
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+    if (CPUFeatures::the().has_sha_ni)
+        return transform_with_sha_ni(m_state, data, block_count);
+#endif
+    for (size_t i = 0; i < block_count; ++i)
+        transform(data + i * BlockSize);
+}
+
 void SHA1::update(u8 const* message, size_t length)
 {
-    while (length > 0) {
+    if (m_data_length > 0) {
         size_t copy_bytes = AK::min(length, BlockSize - m_data_length);
         __builtin_memcpy(m_data_buffer + m_data_length, message, copy_bytes);
         message += copy_bytes;
         length -= copy_bytes;
         m_data_length += copy_bytes;
-        if (m_data_length == BlockSize) {
-            transform(m_data_buffer);
-            m_bit_length += BlockSize * 8;
-            m_data_length = 0;
-        }
+        if (m_data_length < BlockSize)
+            return;
+        transform_blocks(m_data_buffer, 1);
+        m_bit_length += BlockSize * 8;
+        m_data_length = 0;
+    }
+
+    // Whole blocks are hashed straight from the message, only the rest is buffered.
+    if (auto block_count = length / BlockSize; block_count > 0) {
+        transform_blocks(message, block_count);
+        m_bit_length += block_count * BlockSize * 8;
+        message += block_count * BlockSize;
+        length -= block_count * BlockSize;
     }
+
+    __builtin_memcpy(m_data_buffer, message, length);
+    m_data_length = length;
 }
 
 SHA1::DigestType SHA1::digest()
@@ -111,7 +197,7 @@ SHA1::DigestType SHA1::peek()
         m_data_buffer[i++] = 0x80;
         while (i < BlockSize)
             m_data_buffer[i++] = 0x00;
-        transform(m_data_buffer);
+        transform_blocks(m_data_buffer, 1);
 
         // Then start another block with BlockSize - 8 bytes of zeros
         __builtin_memset(m_data_buffer, 0, FinalBlockDataSize);
@@ -128,7 +214,7 @@ SHA1::DigestType SHA1::peek()
     m_data_buffer[BlockSize - 7] = m_bit_length >> 48;
     m_data_buffer[BlockSize - 8] = m_bit_length >> 56;
 
-    transform(m_data_buffer);
+    transform_blocks(m_data_buffer, 1);
 
     for (i = 0; i < 4; ++i) {
         digest.data[i + 0] = (m_state[0] >> (24 - i * 8)) & 0x000000ff;
@@ -6,8 +6,16 @@
  */
 
 #include <AK/Types.h>
+#include <LibCrypto/CPUFeatures.h>
 #include <LibCrypto/Hash/SHA2.h>
 
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+#    include <AK/ByteReader.h>
+#    include <AK/Endian.h>
+#    include <AK/NumericLimits.h>
+#    include <AK/SIMD.h>
+#endif
+
 namespace Crypto::Hash {
 constexpr static auto ROTRIGHT(u32 a, size_t b) { return (a >> b) | (a << (32 - b)); }
 constexpr static auto CH(u32 x, u32 y, u32 z) { return (x & y) ^ (z & ~x); }
@@ -82,12 +90,226 @@ void update_buffer(u8* buffer, u8 const* input, size_t length, size_t& data_leng
     }
 }
 
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+using AK::SIMD::i32x4;
+using AK::SIMD::u32x8;
+using AK::SIMD::u8x16;
+
+// See "Intel SHA Extensions: New Instructions Supporting the Secure Hash Algorithm on Intel Architecture Processors".
+// sha256rnds2 wants the state as (a, b, e, f) and (c, d, g, h), each with the first word in the highest lane.
+[[gnu::target("sha,ssse3,sse4.1")]] static void transform_with_sha_ni(u32 (&state)[8], u8 const* data, size_t block_count)
+{
+    auto load_words = [](u8 const* data) {
+        u8x16 bytes;
+        __builtin_memcpy(&bytes, data, sizeof(bytes));
+        return (i32x4)__builtin_shufflevector(bytes, bytes, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    };
+
+    i32x4 abcd;
+    i32x4 efgh;
+    __builtin_memcpy(&abcd, &state[0], sizeof(abcd));
+    __builtin_memcpy(&efgh, &state[4], sizeof(efgh));
+    auto abef = __builtin_shufflevector(abcd, efgh, 5, 4, 1, 0);
+    auto cdgh = __builtin_shufflevector(abcd, efgh, 7, 6, 3, 2);
+
+    for (size_t block = 0; block < block_count; ++block, data += 64) {
+        auto saved_abef = abef;
+        auto saved_cdgh = cdgh;
+
+        // w[i % 4] holds the message words for the ith group of four rounds.
+        i32x4 w[4];
+#pragma GCC unroll 16
+        for (size_t group = 0; group < 16; ++group) {
+            if (group < 4) {
+                w[group] = load_words(data + group * 16);
+            } else {
+                auto words_7_to_4_back = __builtin_shufflevector(w[(group + 2) % 4], w[(group + 3) % 4], 1, 2, 3, 4);
+                w[group % 4] = __builtin_ia32_sha256msg2(__builtin_ia32_sha256msg1(w[group % 4], w[(group + 1) % 4]) + words_7_to_4_back, w[(group + 3) % 4]);
+            }
+
+            i32x4 constants;
+            __builtin_memcpy(&constants, &SHA256Constants::RoundConstants[group * 4], sizeof(constants));
+            auto words = w[group % 4] + constants;
+            cdgh = __builtin_ia32_sha256rnds2(cdgh, abef, words);
+            abef = __builtin_ia32_sha256rnds2(abef, cdgh, __builtin_shufflevector(words, words, 2, 3, 0, 0));
+        }
+
+        abef += saved_abef;
+        cdgh += saved_cdgh;
+    }
+
+    abcd = __builtin_shufflevector(abef, cdgh, 3, 2, 7, 6);
+    efgh = __builtin_shufflevector(abef, cdgh, 1, 0, 5, 4);
+    __builtin_memcpy(&state[0], &abcd, sizeof(abcd));
+    __builtin_memcpy(&state[4], &efgh, sizeof(efgh));
+}
+
+[[gnu::target("avx2")]] ALWAYS_INLINE static u32x8 rotate_right(u32x8 value, u32 bits)
+{
+    return (value >> bits) | (value << (32 - bits));
+}
+
+// Runs one block of each of eight messages through SHA-256, with one message per vector lane.
+// Lanes that are not set in `active_lanes` keep their state, their block pointer is never read.
+[[gnu::target("avx2")]] static void transform_eight_lanes_with_avx2(u32x8 (&state)[8], u8 const* const (&blocks)[8], u32x8 active_lanes)
+{
+    u32x8 w[16];
+    for (size_t i = 0; i < 16; ++i) {
+        u32 words[8];
+        for (size_t lane = 0; lane < 8; ++lane)
+            words[lane] = blocks[lane] ? AK::convert_between_host_and_big_endian(ByteReader::load32(blocks[lane] + i * 4)) : 0;
+        __builtin_memcpy(&w[i], words, sizeof(w[i]));
+    }
+
+    auto a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (size_t i = 0; i < 64; ++i) {
+        if (i >= 16) {
+            auto w15 = w[(i - 15) % 16];
+            auto w2 = w[(i - 2) % 16];
+            auto sign0 = rotate_right(w15, 7) ^ rotate_right(w15, 18) ^ (w15 >> 3);
+            auto sign1 = rotate_right(w2, 17) ^ rotate_right(w2, 19) ^ (w2 >> 10);
+            w[i % 16] += sign0 + w[(i - 7) % 16] + sign1;
+        }
+
+        auto temp0 = h + (rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25)) + ((e & f) ^ (g & ~e)) + SHA256Constants::RoundConstants[i] + w[i % 16];
+        auto temp1 = (rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp0;
+        d = c;
+        c = b;
+        b = a;
+        a = temp0 + temp1;
+    }
+
+    state[0] += a & active_lanes;
+    state[1] += b & active_lanes;
+    state[2] += c & active_lanes;
+    state[3] += d & active_lanes;
+    state[4] += e & active_lanes;
+    state[5] += f & active_lanes;
+    state[6] += g & active_lanes;
+    state[7] += h & active_lanes;
+}
+
+[[gnu::target("avx2")]] static void hash_many_with_avx2(ReadonlySpan<ReadonlyBytes> messages, Span<SHA256::DigestType> digests)
+{
+    constexpr size_t block_size = SHA256::block_size();
+
+    // The padding ends up in at most two blocks after the last whole block of the message.
+    struct Lane {
+        u8 const* data { nullptr };
+        size_t whole_block_count { 0 };
+        size_t block_count { 0 };
+        u8 tail[2 * block_size];
+
+        u8 const* block(size_t index) const
+        {
+            if (index < whole_block_count)
+                return data + index * block_size;
+            return tail + (index - whole_block_count) * block_size;
+        }
+    };
+
+    for (size_t first = 0; first < messages.size(); first += 8) {
+        Lane lanes[8];
+        size_t lane_count = min<size_t>(8, messages.size() - first);
+        size_t max_block_count = 0;
+
+        for (size_t i = 0; i < lane_count; ++i) {
+            auto message = messages[first + i];
+            auto& lane = lanes[i];
+            lane.data = message.data();
+            lane.whole_block_count = message.size() / block_size;
+
+            auto remaining = message.size() % block_size;
+            auto tail_size = remaining < block_size - 8 ? block_size : 2 * block_size;
+            __builtin_memset(lane.tail, 0, tail_size);
+            if (remaining > 0)
+                __builtin_memcpy(lane.tail, message.data() + lane.whole_block_count * block_size, remaining);
+            lane.tail[remaining] = 0x80;
+            auto bit_length = AK::convert_between_host_and_big_endian(static_cast<u64>(message.size()) * 8);
+            __builtin_memcpy(lane.tail + tail_size - 8, &bit_length, sizeof(bit_length));
+
+            lane.block_count = lane.whole_block_count + tail_size / block_size;
+            max_block_count = max(max_block_count, lane.block_count);
+        }
+
+        u32x8 state[8];
+        for (size_t i = 0; i < 8; ++i)
+            state[i] = u32x8 {} + SHA256Constants::InitializationHashes[i];
+
+        for (size_t block = 0; block < max_block_count; ++block) {
+            u8 const* blocks[8] {};
+            u32 active_lanes[8] {};
+            for (size_t i = 0; i < lane_count; ++i) {
+                if (block < lanes[i].block_count) {
+                    blocks[i] = lanes[i].block(block);
+                    active_lanes[i] = NumericLimits<u32>::max();
+                }
+            }
+            u32x8 active_lanes_mask;
+            __builtin_memcpy(&active_lanes_mask, active_lanes, sizeof(active_lanes_mask));
+            transform_eight_lanes_with_avx2(state, blocks, active_lanes_mask);
+        }
+
+        for (size_t i = 0; i < lane_count; ++i) {
+            for (size_t word = 0; word < 8; ++word)
+                ByteReader::store(digests[first + i].data + word * 4, AK::convert_between_host_and_big_endian(state[word][i]));
+        }
+    }
+}
+#endif
+
+void SHA256::transform_blocks(u8 const* data, size_t block_count)
+{
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+    if (CPUFeatures::the().has_sha_ni)
+        return transform_with_sha_ni(m_state, data, block_count);
+#endif
+    for (size_t i = 0; i < block_count; ++i)
+        transform(data + i * BlockSize);
+}
+
+void SHA256::hash_many(ReadonlySpan<ReadonlyBytes> messages, Span<DigestType> digests)
+{
+    VERIFY(digests.size() >= messages.size());
+
+#ifdef CRYPTO_HAS_X86_64_ACCELERATION
+    if (CPUFeatures::the().has_avx2)
+        return hash_many_with_avx2(messages, digests);
+#endif
+    for (size_t i = 0; i < messages.size(); ++i)
+        digests[i] = hash(messages[i].data(), messages[i].size());
+}
+
 void SHA256::update(u8 const* message, size_t length)
 {
-    update_buffer<BlockSize>(m_data_buffer, message, length, m_data_length, [&]() {
-        transform(m_data_buffer);
+    if (m_data_length > 0) {
+        size_t copy_bytes = AK::min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, copy_bytes);
+        message += copy_bytes;
+        length -= copy_bytes;
+        m_data_length += copy_bytes;
+        if (m_data_length < BlockSize)
+            return;
+        transform_blocks(m_data_buffer, 1);
         m_bit_length += BlockSize * 8;
-    });
+        m_data_length = 0;
+    }
+
+    // Whole blocks are hashed straight from the message, only the rest is buffered.
+    if (auto block_count = length / BlockSize; block_count > 0) {
+        transform_blocks(message, block_count);
+        m_bit_length += block_count * BlockSize * 8;
+        message += block_count * BlockSize;
+        length -= block_count * BlockSize;
+    }
+
+    __builtin_memcpy(m_data_buffer, message, length);
+    m_data_length = length;
 }
 
 SHA256::DigestType SHA256::digest()
@@ -111,7 +333,7 @@ SHA256::DigestType SHA256::peek()
         m_data_buffer[i++] = 0x80;
         while (i < BlockSize)
             m_data_buffer[i++] = 0x00;
-        transform(m_data_buffer);
+        transform_blocks(m_data_buffer, 1);
 
         // Then start another block with BlockSize - 8 bytes of zeros
         __builtin_memset(m_data_buffer, 0, FinalBlockDataSize);
@@ -128,7 +350,7 @@ SHA256::DigestType SHA256::peek()
     m_data_buffer[BlockSize - 7] = m_bit_length >> 48;
     m_data_buffer[BlockSize - 8] = m_bit_length >> 56;
 
-    transform(m_data_buffer);
+    transform_blocks(m_data_buffer, 1);
 
     // SHA uses big-endian and we assume little-endian
     // FIXME: looks like a thing for AK::NetworkOrdered,
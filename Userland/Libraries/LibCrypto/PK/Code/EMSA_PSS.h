@@ -77,40 +77,49 @@ public:
         for (size_t i = 0; i < DB.size(); ++i)
             DB_data[i] ^= DB_mask[i];
 
-        auto count = (8 - (em_length * 8 - em_bits));
-        DB_data[0] &= (0xff >> count) << count;
+        DB_data[0] &= 0xff >> (em_length * 8 - em_bits);
 
         out.overwrite(0, DB.data(), DB.size());
         out.overwrite(DB.size(), hash.data, hash_fn.DigestSize);
         out[DB.size() + hash_fn.DigestSize] = 0xbc;
     }
 
+    // https://www.rfc-editor.org/rfc/rfc8017#section-9.1.2
     virtual VerificationConsistency verify(ReadonlyBytes msg, ReadonlyBytes emsg, size_t em_bits) override
     {
         auto& hash_fn = this->hasher();
         hash_fn.update(msg);
         auto message_hash = hash_fn.digest();
 
-        if (emsg.size() < HashFunction::DigestSize + SaltLength + 2)
+        // The encoded message may have been handed to us with the leading zero octets of the RSA output still attached.
+        auto em_length = (em_bits + 7) / 8;
+        if (emsg.size() < em_length)
+            return VerificationConsistency::Inconsistent;
+        for (size_t i = 0; i < emsg.size() - em_length; ++i) {
+            if (emsg[i])
+                return VerificationConsistency::Inconsistent;
+        }
+        emsg = emsg.slice(emsg.size() - em_length);
+
+        if (em_length < HashFunction::DigestSize + SaltLength + 2)
             return VerificationConsistency::Inconsistent;
 
-        if (emsg[emsg.size() - 1] != 0xbc)
+        if (emsg[em_length - 1] != 0xbc)
             return VerificationConsistency::Inconsistent;
 
-        auto mask_length = emsg.size() - HashFunction::DigestSize - 1;
+        auto mask_length = em_length - HashFunction::DigestSize - 1;
         auto masked_DB = emsg.slice(0, mask_length);
         auto H = emsg.slice(mask_length, HashFunction::DigestSize);
 
-        auto length_to_check = 8 * emsg.size() - em_bits;
-        auto octet = masked_DB[0];
-        for (size_t i = 0; i < length_to_check; ++i)
-            if ((octet >> (8 - i)) & 0x01)
-                return VerificationConsistency::Inconsistent;
+        // The leftmost 8 * emLen - emBits bits of the leftmost octet in maskedDB must all be zero.
+        auto unused_bits = 8 * em_length - em_bits;
+        u8 unused_bits_mask = ~(0xff >> unused_bits);
+        if (masked_DB[0] & unused_bits_mask)
+            return VerificationConsistency::Inconsistent;
 
         Vector<u8, 256> DB_mask;
         DB_mask.resize(mask_length);
-        Bytes DB_mask_buffer { DB_mask };
-        MGF1(H, mask_length, DB_mask_buffer);
+        MGF1(H, mask_length, DB_mask.span());
 
         Vector<u8, 256> DB;
         DB.resize(mask_length);
@@ -118,15 +127,15 @@ public:
         for (size_t i = 0; i < mask_length; ++i)
             DB[i] = masked_DB[i] ^ DB_mask[i];
 
-        DB[0] &= 0xff >> (8 - length_to_check);
+        DB[0] &= ~unused_bits_mask;
 
-        auto check_octets = emsg.size() - HashFunction::DigestSize - SaltLength - 2;
+        auto check_octets = em_length - HashFunction::DigestSize - SaltLength - 2;
         for (size_t i = 0; i < check_octets; ++i) {
             if (DB[i])
                 return VerificationConsistency::Inconsistent;
         }
 
-        if (DB[check_octets + 1] != 0x01)
+        if (DB[check_octets] != 0x01)
             return VerificationConsistency::Inconsistent;
 
         auto* salt = DB.span().offset(mask_length - SaltLength);
@@ -140,25 +149,26 @@ public:
         hash_fn.update(m_prime_buffer);
         auto H_prime = hash_fn.digest();
 
-        if (!timing_safe_compare(message_hash.data, H_prime.data, HashFunction::DigestSize))
+        if (!timing_safe_compare(H.data(), H_prime.data, HashFunction::DigestSize))
             return VerificationConsistency::Inconsistent;
 
         return VerificationConsistency::Consistent;
     }
 
+    // https://www.rfc-editor.org/rfc/rfc8017#appendix-B.2.1
     void MGF1(ReadonlyBytes seed, size_t length, Bytes out)
     {
         auto& hash_fn = this->hasher();
-        ByteBuffer T;
-        for (size_t counter = 0; counter < length / HashFunction::DigestSize - 1; ++counter) {
+        size_t offset = 0;
+        for (u32 counter = 0; offset < length; ++counter) {
+            u8 counter_bytes[4] = { (u8)(counter >> 24), (u8)(counter >> 16), (u8)(counter >> 8), (u8)counter };
             hash_fn.update(seed);
-            hash_fn.update((u8*)&counter, 4);
-            if (auto result = T.try_append(hash_fn.digest().data, HashFunction::DigestSize); result.is_error()) {
-                dbgln("EMSA_PSS: MGF1 digest failed: {}", result.error());
-                return;
-            }
+            hash_fn.update(counter_bytes, 4);
+            auto digest = hash_fn.digest();
+            auto size = min(length - offset, HashFunction::DigestSize);
+            out.overwrite(offset, digest.data, size);
+            offset += size;
         }
-        out.overwrite(0, T.data(), length);
     }
 
 private:
@@ -116,8 +116,9 @@ ErrorOr<Packet> Packet::from_raw_packet(ReadonlyBytes bytes)
     packet.m_query_or_response = header.is_response();
     packet.m_code = header.response_code();
 
-    // FIXME: Should we parse further in this case?
-    if (packet.code() != Code::NOERROR)
+    // NXDOMAIN responses are still parsed, since their authority section says for how long the name doesn't exist.
+    // FIXME: Should we parse further for other codes?
+    if (packet.code() != Code::NOERROR && packet.code() != Code::NXDOMAIN)
         return packet;
 
     size_t offset = sizeof(PacketHeader);
@@ -140,7 +141,7 @@ ErrorOr<Packet> Packet::from_raw_packet(ReadonlyBytes bytes)
         dbgln_if(LOOKUPSERVER_DEBUG, "Question #{}: name=_{}_, type={}, class={}", i, question.name(), question.record_type(), question.class_code());
     }
 
-    for (u16 i = 0; i < header.answer_count(); ++i) {
+    auto parse_record = [&](char const* section, u16 index) -> ErrorOr<Answer> {
         auto name = TRY(Name::parse(bytes, offset));
         if (offset >= bytes.size() || bytes.size() - offset < sizeof(DNSRecordWithoutName))
             return Error::from_string_literal("Unexpected EOF when parsing DNS packet");
@@ -162,6 +163,8 @@ ErrorOr<Packet> Packet::from_raw_packet(ReadonlyBytes bytes)
             // Fall through
         case RecordType::A:
             // Fall through
+        case RecordType::SOA:
+            // Fall through
         case RecordType::TXT:
             // Fall through
         case RecordType::AAAA:
@@ -174,12 +177,18 @@ ErrorOr<Packet> Packet::from_raw_packet(ReadonlyBytes bytes)
             dbgln("data=(unimplemented record type {})", (u16)record.type());
         }
 
-        dbgln_if(LOOKUPSERVER_DEBUG, "Answer   #{}: name=_{}_, type={}, ttl={}, length={}, data=_{}_", i, name, record.type(), record.ttl(), record.data_length(), data);
+        dbgln_if(LOOKUPSERVER_DEBUG, "{} #{}: name=_{}_, type={}, ttl={}, length={}, data=_{}_", section, index, name, record.type(), record.ttl(), record.data_length(), data);
         u16 class_code = record.record_class() & ~MDNS_CACHE_FLUSH;
         bool mdns_cache_flush = record.record_class() & MDNS_CACHE_FLUSH;
-        packet.m_answers.empend(name, (RecordType)record.type(), (RecordClass)class_code, record.ttl(), data, mdns_cache_flush);
         offset += record.data_length();
-    }
+        return Answer { name, (RecordType)record.type(), (RecordClass)class_code, record.ttl(), data, mdns_cache_flush };
+    };
+
+    for (u16 i = 0; i < header.answer_count(); ++i)
+        packet.m_answers.append(TRY(parse_record("Answer   ", i)));
+
+    for (u16 i = 0; i < header.authority_count(); ++i)
+        packet.m_authorities.append(TRY(parse_record("Authority", i)));
 
     return packet;
 }
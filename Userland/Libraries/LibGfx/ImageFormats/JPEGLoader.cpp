@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/Debug.h>
 #include <AK/Endian.h>
 #include <AK/Error.h>
@@ -13,6 +14,7 @@
 #include <AK/Math.h>
 #include <AK/MemoryStream.h>
 #include <AK/NumericLimits.h>
+#include <AK/SIMD.h>
 #include <AK/String.h>
 #include <AK/Try.h>
 #include <AK/Vector.h>
@@ -20,6 +22,9 @@
 #include <LibGfx/ImageFormats/JPEGShared.h>
 #include <LibGfx/ImageFormats/TIFFLoader.h>
 #include <LibGfx/ImageFormats/TIFFMetadata.h>
+#include <LibThreading/Thread.h>
+
+#pragma GCC diagnostic ignored "-Wpsabi"
 
 namespace Gfx {
 
@@ -232,6 +237,54 @@ public:
         return m_saved_marker;
     }
 
+    // Reads the entropy-coded data of a scan, up to the marker that ends it, and splits it at the restart markers.
+    // Each restart interval is followed by an EOI marker, for a HuffmanStream reading it to know where it ends.
+    ErrorOr<Vector<ByteBuffer>> read_restart_intervals()
+    {
+        VERIFY(!m_saved_marker.has_value());
+
+        Vector<ByteBuffer> intervals;
+        TRY(intervals.try_empend());
+        while (true) {
+            if (m_byte_offset == m_current_size)
+                TRY(refill_buffer());
+
+            auto const available = m_buffer.span().slice(m_byte_offset, m_current_size - m_byte_offset);
+            auto const* next_ff = static_cast<u8 const*>(memchr(available.data(), 0xFF, available.size()));
+            auto const data_size = next_ff ? next_ff - available.data() : available.size();
+            TRY(intervals.last().try_append(available.data(), data_size));
+            m_byte_offset += data_size;
+            if (!next_ff)
+                continue;
+
+            TRY(read_u8());
+            u8 next_byte = TRY(read_u8());
+            // B.1.1.2 - Markers: Any marker may optionally be preceded by any number of fill bytes.
+            while (next_byte == 0xFF)
+                next_byte = TRY(read_u8());
+
+            // This is a stuffed 0xFF, and part of the data.
+            if (next_byte == 0x00) {
+                TRY(intervals.last().try_append(0xFF));
+                TRY(intervals.last().try_append(0x00));
+                continue;
+            }
+
+            // Ends the interval the way the end of the image would.
+            TRY(intervals.last().try_append(0xFF));
+            TRY(intervals.last().try_append(JPEG_EOI & 0xFF));
+
+            Marker const marker = 0xFF00 | next_byte;
+            if (marker >= JPEG_RST0 && marker <= JPEG_RST7) {
+                TRY(intervals.try_empend());
+                continue;
+            }
+
+            m_saved_marker = marker;
+            return intervals;
+        }
+    }
+
     u64 byte_offset() const
     {
         return m_offset_from_start + m_byte_offset;
@@ -471,6 +524,8 @@ struct JPEGLoadingContext {
     HashMap<u8, HuffmanTable> ac_tables;
     Array<i16, 4> previous_dc_values {};
     MacroblockMeta mblock_meta;
+    // Width and height of a block once decoded, less than 8 when decoding the image at 1/2, 1/4 or 1/8 of its size.
+    u32 block_size { 8 };
     JPEGStream stream;
     JPEGDecoderOptions options;
 
@@ -482,7 +537,7 @@ struct JPEGLoadingContext {
     Optional<ByteBuffer> icc_data;
 };
 
-static inline auto* get_component(Macroblock& block, unsigned component)
+static inline auto* get_component(auto& block, unsigned component)
 {
     switch (component) {
     case 0:
@@ -843,6 +898,125 @@ static ErrorOr<void> decode_huffman_stream(JPEGLoadingContext& context, Vector<M
     return {};
 }
 
+static u32 mcus_per_row(JPEGLoadingContext const& context)
+{
+    return context.mblock_meta.hpadded_count / context.sampling_factors.horizontal;
+}
+
+static u32 mcu_count(JPEGLoadingContext const& context)
+{
+    return mcus_per_row(context) * ceil_div(context.mblock_meta.vcount, static_cast<u32>(context.sampling_factors.vertical));
+}
+
+static u32 restart_interval_count(JPEGLoadingContext const& context)
+{
+    return ceil_div(mcu_count(context), static_cast<u32>(context.dc_restart_interval));
+}
+
+static bool can_decode_restart_intervals_in_parallel(JPEGLoadingContext const& context)
+{
+    // Only when the scan has all the components are its MCUs numbered like those of the frame (non-interleaved scans
+    // of images with subsampled components have more of them).
+    // FIXME: Progressive scans could be decoded like this too.
+    return context.options.maximum_thread_count > 1
+        && context.dc_restart_interval > 0
+        && !is_progressive(context.frame.type)
+        && context.current_scan->components.size() == context.components.size()
+        && restart_interval_count(context) > 1;
+}
+
+// Gives a context the state to decode a restart interval with, only the frame and scan information being taken from
+// the main one. That's a new one the first time around, the next intervals reuse it.
+static ErrorOr<void> prepare_restart_interval_context(JPEGLoadingContext const& context, OwnPtr<JPEGLoadingContext>& interval_context, ReadonlyBytes data)
+{
+    auto stream = TRY(JPEGStream::create(TRY(try_make<FixedMemoryStream>(data))));
+    if (!interval_context) {
+        interval_context = TRY(try_make<JPEGLoadingContext>(move(stream), context.options));
+        interval_context->frame = context.frame;
+        interval_context->sampling_factors = context.sampling_factors;
+        interval_context->mblock_meta = context.mblock_meta;
+        interval_context->dc_restart_interval = context.dc_restart_interval;
+        interval_context->dc_tables = context.dc_tables;
+        interval_context->ac_tables = context.ac_tables;
+    } else {
+        interval_context->stream = move(stream);
+    }
+
+    Scan scan { HuffmanStream { interval_context->stream } };
+    scan.components = context.current_scan->components;
+    scan.spectral_selection_start = context.current_scan->spectral_selection_start;
+    scan.spectral_selection_end = context.current_scan->spectral_selection_end;
+    scan.successive_approximation_high = context.current_scan->successive_approximation_high;
+    scan.successive_approximation_low = context.current_scan->successive_approximation_low;
+    interval_context->current_scan = move(scan);
+
+    // E.2.4 Control procedure for decoding a restart interval
+    interval_context->previous_dc_values = {};
+    return {};
+}
+
+static ErrorOr<void> decode_restart_interval(JPEGLoadingContext& interval_context, Vector<Macroblock>& macroblocks, u32 interval_index)
+{
+    u32 const first_mcu = interval_index * interval_context.dc_restart_interval;
+    u32 const end_mcu = min(first_mcu + interval_context.dc_restart_interval, mcu_count(interval_context));
+
+    for (u32 mcu = first_mcu; mcu < end_mcu; ++mcu) {
+        u32 const vcursor = mcu / mcus_per_row(interval_context) * interval_context.sampling_factors.vertical;
+        u32 const hcursor = mcu % mcus_per_row(interval_context) * interval_context.sampling_factors.horizontal;
+        if (auto result = build_macroblocks<JPEGDecodingMode::Sequential>(interval_context, macroblocks, hcursor, vcursor); result.is_error()) {
+            dbgln_if(JPEG_DEBUG, "Failed to build Macroblock {}: {}", mcu, result.error());
+            return result.release_error();
+        }
+    }
+    return {};
+}
+
+// Restart intervals don't depend on each other, the DC predictions start over in each of them. So we decode them on
+// several threads, each thread taking the next interval that nobody took yet.
+static ErrorOr<void> decode_restart_intervals_in_parallel(JPEGLoadingContext& context, Vector<Macroblock>& macroblocks)
+{
+    auto const intervals = TRY(context.stream.read_restart_intervals());
+    // Broken images can be missing some intervals, these blocks are left empty like the other decoding path does.
+    auto const interval_count = min<size_t>(intervals.size(), restart_interval_count(context));
+    auto const thread_count = min(context.options.maximum_thread_count, interval_count);
+
+    Vector<OwnPtr<JPEGLoadingContext>> interval_contexts;
+    TRY(interval_contexts.try_resize(thread_count));
+    Vector<ErrorOr<void>> results;
+    TRY(results.try_resize(thread_count));
+    Atomic<size_t> next_interval { 0 };
+
+    auto decode_intervals = [&](size_t thread_index) -> ErrorOr<void> {
+        for (auto i = next_interval++; i < interval_count; i = next_interval++) {
+            auto& interval_context = interval_contexts[thread_index];
+            TRY(prepare_restart_interval_context(context, interval_context, intervals[i]));
+            TRY(decode_restart_interval(*interval_context, macroblocks, i));
+        }
+        return {};
+    };
+
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    for (size_t i = 1; i < thread_count; ++i) {
+        // If we can't have another thread, the ones we have will decode the remaining intervals.
+        auto thread_or_error = Threading::Thread::try_create([&, i] {
+            results[i] = decode_intervals(i);
+            return 0;
+        },
+            "JPEG decoder"sv);
+        if (thread_or_error.is_error() || threads.try_append(thread_or_error.value()).is_error())
+            break;
+        threads.last()->start();
+    }
+
+    results[0] = decode_intervals(0);
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    for (auto& result : results)
+        TRY(result);
+    return {};
+}
+
 static bool is_frame_marker(Marker const marker)
 {
     // B.1.1.3 - Marker assignments
@@ -1397,37 +1571,32 @@ static ErrorOr<void> skip_segment(JPEGStream& stream)
     return {};
 }
 
-static ErrorOr<void> dequantize(JPEGLoadingContext& context, Vector<Macroblock>& macroblocks)
-{
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.sampling_factors.vertical) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.sampling_factors.horizontal) {
-            for (u32 i = 0; i < context.components.size(); i++) {
-                auto const& component = context.components[i];
+using AK::SIMD::f32x8;
+using AK::SIMD::i16x8;
+using AK::SIMD::i32x8;
+using AK::SIMD::u32x8;
 
-                if (!context.quantization_tables[component.quantization_table_id].has_value()) {
-                    dbgln_if(JPEG_DEBUG, "Unknown quantization table id: {}!", component.quantization_table_id);
-                    return Error::from_string_literal("Unknown quantization table id");
-                }
-
-                auto const& table = context.quantization_tables[component.quantization_table_id].value();
+// A quantization table, one row of the block per vector, with the scale factors of the AAN inverse DCT folded in.
+using DequantizationTable = Array<f32x8, 8>;
 
-                for (u32 vfactor_i = 0; vfactor_i < component.sampling_factors.vertical; vfactor_i++) {
-                    for (u32 hfactor_i = 0; hfactor_i < component.sampling_factors.horizontal; hfactor_i++) {
-                        u32 macroblock_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                        Macroblock& block = macroblocks[macroblock_index];
-                        auto* block_component = get_component(block, i);
-                        for (u32 k = 0; k < 64; k++)
-                            block_component[k] *= table[k];
-                    }
-                }
-            }
-        }
-    }
-
-    return {};
+static DequantizationTable make_dequantization_table(Array<u16, 64> const& quantization_table)
+{
+    Array<float, 8> scale_factors;
+    scale_factors[0] = AK::cos(0.0f / 16.0f * AK::Pi<float>) / AK::sqrt(8.0f);
+    for (u32 i = 1; i < 8; ++i)
+        scale_factors[i] = AK::cos(i / 16.0f * AK::Pi<float>) / 2.0f;
+
+    // Both passes of the inverse DCT scale their input, so each coefficient gets the factors of its row and its column.
+    DequantizationTable table;
+    for (u32 row = 0; row < 8; ++row) {
+        for (u32 column = 0; column < 8; ++column)
+            table[row][column] = quantization_table[row * 8 + column] * scale_factors[row] * scale_factors[column];
+    }
+    return table;
 }
 
-static void inverse_dct_8x8(i16* block_component)
+// One dimensional AAN inverse DCT of eight lines at once, v[i] holds the scaled i-th coefficient of each of them.
+static ALWAYS_INLINE void inverse_dct_8(f32x8 (&v)[8])
 {
     static float const m0 = 2.0f * AK::cos(1.0f / 16.0f * 2.0f * AK::Pi<float>);
     static float const m1 = 2.0f * AK::cos(2.0f / 16.0f * 2.0f * AK::Pi<float>);
@@ -1435,153 +1604,179 @@ static void inverse_dct_8x8(i16* block_component)
     static float const m5 = 2.0f * AK::cos(3.0f / 16.0f * 2.0f * AK::Pi<float>);
     static float const m2 = m0 - m5;
     static float const m4 = m0 + m5;
-    static float const s0 = AK::cos(0.0f / 16.0f * AK::Pi<float>) / AK::sqrt(8.0f);
-    static float const s1 = AK::cos(1.0f / 16.0f * AK::Pi<float>) / 2.0f;
-    static float const s2 = AK::cos(2.0f / 16.0f * AK::Pi<float>) / 2.0f;
-    static float const s3 = AK::cos(3.0f / 16.0f * AK::Pi<float>) / 2.0f;
-    static float const s4 = AK::cos(4.0f / 16.0f * AK::Pi<float>) / 2.0f;
-    static float const s5 = AK::cos(5.0f / 16.0f * AK::Pi<float>) / 2.0f;
-    static float const s6 = AK::cos(6.0f / 16.0f * AK::Pi<float>) / 2.0f;
-    static float const s7 = AK::cos(7.0f / 16.0f * AK::Pi<float>) / 2.0f;
-
-    for (u32 k = 0; k < 8; ++k) {
-        float const g0 = block_component[0 * 8 + k] * s0;
-        float const g1 = block_component[4 * 8 + k] * s4;
-        float const g2 = block_component[2 * 8 + k] * s2;
-        float const g3 = block_component[6 * 8 + k] * s6;
-        float const g4 = block_component[5 * 8 + k] * s5;
-        float const g5 = block_component[1 * 8 + k] * s1;
-        float const g6 = block_component[7 * 8 + k] * s7;
-        float const g7 = block_component[3 * 8 + k] * s3;
-
-        float const f0 = g0;
-        float const f1 = g1;
-        float const f2 = g2;
-        float const f3 = g3;
-        float const f4 = g4 - g7;
-        float const f5 = g5 + g6;
-        float const f6 = g5 - g6;
-        float const f7 = g4 + g7;
-
-        float const e0 = f0;
-        float const e1 = f1;
-        float const e2 = f2 - f3;
-        float const e3 = f2 + f3;
-        float const e4 = f4;
-        float const e5 = f5 - f7;
-        float const e6 = f6;
-        float const e7 = f5 + f7;
-        float const e8 = f4 + f6;
-
-        float const d0 = e0;
-        float const d1 = e1;
-        float const d2 = e2 * m1;
-        float const d3 = e3;
-        float const d4 = e4 * m2;
-        float const d5 = e5 * m3;
-        float const d6 = e6 * m4;
-        float const d7 = e7;
-        float const d8 = e8 * m5;
-
-        float const c0 = d0 + d1;
-        float const c1 = d0 - d1;
-        float const c2 = d2 - d3;
-        float const c3 = d3;
-        float const c4 = d4 + d8;
-        float const c5 = d5 + d7;
-        float const c6 = d6 - d8;
-        float const c7 = d7;
-        float const c8 = c5 - c6;
-
-        float const b0 = c0 + c3;
-        float const b1 = c1 + c2;
-        float const b2 = c1 - c2;
-        float const b3 = c0 - c3;
-        float const b4 = c4 - c8;
-        float const b5 = c8;
-        float const b6 = c6 - c7;
-        float const b7 = c7;
-
-        block_component[0 * 8 + k] = b0 + b7;
-        block_component[1 * 8 + k] = b1 + b6;
-        block_component[2 * 8 + k] = b2 + b5;
-        block_component[3 * 8 + k] = b3 + b4;
-        block_component[4 * 8 + k] = b3 - b4;
-        block_component[5 * 8 + k] = b2 - b5;
-        block_component[6 * 8 + k] = b1 - b6;
-        block_component[7 * 8 + k] = b0 - b7;
-    }
-    for (u32 l = 0; l < 8; ++l) {
-        float const g0 = block_component[l * 8 + 0] * s0;
-        float const g1 = block_component[l * 8 + 4] * s4;
-        float const g2 = block_component[l * 8 + 2] * s2;
-        float const g3 = block_component[l * 8 + 6] * s6;
-        float const g4 = block_component[l * 8 + 5] * s5;
-        float const g5 = block_component[l * 8 + 1] * s1;
-        float const g6 = block_component[l * 8 + 7] * s7;
-        float const g7 = block_component[l * 8 + 3] * s3;
-
-        float const f0 = g0;
-        float const f1 = g1;
-        float const f2 = g2;
-        float const f3 = g3;
-        float const f4 = g4 - g7;
-        float const f5 = g5 + g6;
-        float const f6 = g5 - g6;
-        float const f7 = g4 + g7;
-
-        float const e0 = f0;
-        float const e1 = f1;
-        float const e2 = f2 - f3;
-        float const e3 = f2 + f3;
-        float const e4 = f4;
-        float const e5 = f5 - f7;
-        float const e6 = f6;
-        float const e7 = f5 + f7;
-        float const e8 = f4 + f6;
-
-        float const d0 = e0;
-        float const d1 = e1;
-        float const d2 = e2 * m1;
-        float const d3 = e3;
-        float const d4 = e4 * m2;
-        float const d5 = e5 * m3;
-        float const d6 = e6 * m4;
-        float const d7 = e7;
-        float const d8 = e8 * m5;
-
-        float const c0 = d0 + d1;
-        float const c1 = d0 - d1;
-        float const c2 = d2 - d3;
-        float const c3 = d3;
-        float const c4 = d4 + d8;
-        float const c5 = d5 + d7;
-        float const c6 = d6 - d8;
-        float const c7 = d7;
-        float const c8 = c5 - c6;
-
-        float const b0 = c0 + c3;
-        float const b1 = c1 + c2;
-        float const b2 = c1 - c2;
-        float const b3 = c0 - c3;
-        float const b4 = c4 - c8;
-        float const b5 = c8;
-        float const b6 = c6 - c7;
-        float const b7 = c7;
-
-        block_component[l * 8 + 0] = b0 + b7;
-        block_component[l * 8 + 1] = b1 + b6;
-        block_component[l * 8 + 2] = b2 + b5;
-        block_component[l * 8 + 3] = b3 + b4;
-        block_component[l * 8 + 4] = b3 - b4;
-        block_component[l * 8 + 5] = b2 - b5;
-        block_component[l * 8 + 6] = b1 - b6;
-        block_component[l * 8 + 7] = b0 - b7;
-    }
-}
-
-static void inverse_dct(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
+
+    auto const g0 = v[0];
+    auto const g1 = v[4];
+    auto const g2 = v[2];
+    auto const g3 = v[6];
+    auto const g4 = v[5];
+    auto const g5 = v[1];
+    auto const g6 = v[7];
+    auto const g7 = v[3];
+
+    auto const f0 = g0;
+    auto const f1 = g1;
+    auto const f2 = g2;
+    auto const f3 = g3;
+    auto const f4 = g4 - g7;
+    auto const f5 = g5 + g6;
+    auto const f6 = g5 - g6;
+    auto const f7 = g4 + g7;
+
+    auto const e0 = f0;
+    auto const e1 = f1;
+    auto const e2 = f2 - f3;
+    auto const e3 = f2 + f3;
+    auto const e4 = f4;
+    auto const e5 = f5 - f7;
+    auto const e6 = f6;
+    auto const e7 = f5 + f7;
+    auto const e8 = f4 + f6;
+
+    auto const d0 = e0;
+    auto const d1 = e1;
+    auto const d2 = e2 * m1;
+    auto const d3 = e3;
+    auto const d4 = e4 * m2;
+    auto const d5 = e5 * m3;
+    auto const d6 = e6 * m4;
+    auto const d7 = e7;
+    auto const d8 = e8 * m5;
+
+    auto const c0 = d0 + d1;
+    auto const c1 = d0 - d1;
+    auto const c2 = d2 - d3;
+    auto const c3 = d3;
+    auto const c4 = d4 + d8;
+    auto const c5 = d5 + d7;
+    auto const c6 = d6 - d8;
+    auto const c7 = d7;
+    auto const c8 = c5 - c6;
+
+    auto const b0 = c0 + c3;
+    auto const b1 = c1 + c2;
+    auto const b2 = c1 - c2;
+    auto const b3 = c0 - c3;
+    auto const b4 = c4 - c8;
+    auto const b5 = c8;
+    auto const b6 = c6 - c7;
+    auto const b7 = c7;
+
+    v[0] = b0 + b7;
+    v[1] = b1 + b6;
+    v[2] = b2 + b5;
+    v[3] = b3 + b4;
+    v[4] = b3 - b4;
+    v[5] = b2 - b5;
+    v[6] = b1 - b6;
+    v[7] = b0 - b7;
+}
+
+static ALWAYS_INLINE void transpose(f32x8 (&v)[8])
+{
+    f32x8 transposed[8];
+    for (u32 i = 0; i < 8; ++i) {
+        for (u32 j = 0; j < 8; ++j)
+            transposed[i][j] = v[j][i];
+    }
+    for (u32 i = 0; i < 8; ++i)
+        v[i] = transposed[i];
+}
+
+static ALWAYS_INLINE void dequantize_and_inverse_dct_8x8(i16* block_component, DequantizationTable const& table, float level_shift, float max_value, int precision_shift)
+{
+    f32x8 lines[8];
+    for (u32 row = 0; row < 8; ++row) {
+        i16x8 coefficients;
+        __builtin_memcpy(&coefficients, block_component + row * 8, sizeof(coefficients));
+        lines[row] = __builtin_convertvector(coefficients, f32x8) * table[row];
+    }
+
+    // With a row in each vector, the first pass goes down all eight columns at once. The second one does the same for
+    // the rows after transposing the block.
+    inverse_dct_8(lines);
+    transpose(lines);
+    inverse_dct_8(lines);
+    transpose(lines);
+
+    // F.2.1.5 - Inverse DCT (IDCT)
+    for (u32 row = 0; row < 8; ++row) {
+        auto samples = lines[row] + (level_shift + 0.5f);
+        samples = samples < 0.0f ? 0.0f : (samples > max_value ? max_value : samples);
+        auto const rounded_samples = __builtin_convertvector(__builtin_convertvector(samples, i32x8) >> precision_shift, i16x8);
+        __builtin_memcpy(block_component + row * 8, &rounded_samples, sizeof(rounded_samples));
+    }
+}
+
+// The samples of the M-point inverse DCT, normalized like the 8-point one, basis[x][u] being the weight of the u-th
+// coefficient for the x-th sample.
+using ScaledInverseDCTBasis = Array<Array<float, 4>, 4>;
+
+static ScaledInverseDCTBasis make_scaled_inverse_dct_basis(u32 block_size)
+{
+    ScaledInverseDCTBasis basis {};
+    for (u32 x = 0; x < block_size; ++x) {
+        for (u32 u = 0; u < block_size; ++u) {
+            float const normalization = u == 0 ? 1.0f / AK::sqrt(2.0f) : 1.0f;
+            basis[x][u] = normalization / 2.0f * AK::cos((2 * x + 1) * u * AK::Pi<float> / (2 * block_size));
+        }
+    }
+    return basis;
+}
+
+// The lowest M x M coefficients of a block put through an M-point inverse DCT give the block scaled down to M x M
+// samples, which are written to the top left corner of the block. The other coefficients are left alone.
+static void dequantize_and_scaled_inverse_dct(i16* block_component, Array<u16, 64> const& quantization_table, ScaledInverseDCTBasis const& basis, u32 block_size, float level_shift, float max_value, int precision_shift)
+{
+    float coefficients[4][4];
+    for (u32 v = 0; v < block_size; ++v) {
+        for (u32 u = 0; u < block_size; ++u)
+            coefficients[v][u] = block_component[v * 8 + u] * quantization_table[v * 8 + u];
+    }
+
+    float columns[4][4];
+    for (u32 y = 0; y < block_size; ++y) {
+        for (u32 u = 0; u < block_size; ++u) {
+            float sum = 0;
+            for (u32 v = 0; v < block_size; ++v)
+                sum += basis[y][v] * coefficients[v][u];
+            columns[y][u] = sum;
+        }
+    }
+
+    // F.2.1.5 - Inverse DCT (IDCT)
+    for (u32 y = 0; y < block_size; ++y) {
+        for (u32 x = 0; x < block_size; ++x) {
+            float sample = level_shift + 0.5f;
+            for (u32 u = 0; u < block_size; ++u)
+                sample += basis[x][u] * columns[y][u];
+            block_component[y * 8 + x] = static_cast<i16>(clamp(sample, 0.0f, max_value)) >> precision_shift;
+        }
+    }
+}
+
+static ErrorOr<void> dequantize_and_inverse_dct(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
 {
+    Array<Array<u16, 64> const*, 4> quantization_tables {};
+    Array<DequantizationTable, 4> tables;
+    for (u32 i = 0; i < context.components.size(); i++) {
+        auto const& component = context.components[i];
+        if (!context.quantization_tables[component.quantization_table_id].has_value()) {
+            dbgln_if(JPEG_DEBUG, "Unknown quantization table id: {}!", component.quantization_table_id);
+            return Error::from_string_literal("Unknown quantization table id");
+        }
+        quantization_tables[i] = &context.quantization_tables[component.quantization_table_id].value();
+        if (context.block_size == 8)
+            tables[i] = make_dequantization_table(*quantization_tables[i]);
+    }
+    auto const scaled_basis = context.block_size < 8 ? make_scaled_inverse_dct_basis(context.block_size) : ScaledInverseDCTBasis {};
+
+    float const level_shift = 1 << (context.frame.precision - 1);
+    float const max_value = (1 << context.frame.precision) - 1;
+    // FIXME: This just truncates 12 bits samples to 8 bits, it's an easy way to support (read hack)
+    //        12 bits JPEGs without rewriting all color transformations.
+    int const precision_shift = context.frame.precision - 8;
+
     for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.sampling_factors.vertical) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.sampling_factors.horizontal) {
             for (u32 component_i = 0; component_i < context.components.size(); component_i++) {
@@ -1591,42 +1786,17 @@ static void inverse_dct(JPEGLoadingContext const& context, Vector<Macroblock>& m
                         u32 macroblock_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
                         Macroblock& block = macroblocks[macroblock_index];
                         auto* block_component = get_component(block, component_i);
-                        inverse_dct_8x8(block_component);
+                        if (context.block_size == 8)
+                            dequantize_and_inverse_dct_8x8(block_component, tables[component_i], level_shift, max_value, precision_shift);
+                        else
+                            dequantize_and_scaled_inverse_dct(block_component, *quantization_tables[component_i], scaled_basis, context.block_size, level_shift, max_value, precision_shift);
                     }
                 }
             }
         }
     }
 
-    // F.2.1.5 - Inverse DCT (IDCT)
-    auto const level_shift = 1 << (context.frame.precision - 1);
-    auto const max_value = (1 << context.frame.precision) - 1;
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.sampling_factors.vertical) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.sampling_factors.horizontal) {
-            for (u8 vfactor_i = 0; vfactor_i < context.sampling_factors.vertical; ++vfactor_i) {
-                for (u8 hfactor_i = 0; hfactor_i < context.sampling_factors.horizontal; ++hfactor_i) {
-                    u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
-                    for (u8 i = 0; i < 8; ++i) {
-                        for (u8 j = 0; j < 8; ++j) {
-
-                            // FIXME: This just truncate all coefficients, it's an easy way to support (read hack)
-                            //        12 bits JPEGs without rewriting all color transformations.
-                            auto const clamp_to_8_bits = [&](u16 color) -> u8 {
-                                if (context.frame.precision == 8)
-                                    return static_cast<u8>(color);
-                                return static_cast<u8>(color >> 4);
-                            };
-
-                            macroblocks[mb_index].r[i * 8 + j] = clamp_to_8_bits(clamp(macroblocks[mb_index].r[i * 8 + j] + level_shift, 0, max_value));
-                            macroblocks[mb_index].g[i * 8 + j] = clamp_to_8_bits(clamp(macroblocks[mb_index].g[i * 8 + j] + level_shift, 0, max_value));
-                            macroblocks[mb_index].b[i * 8 + j] = clamp_to_8_bits(clamp(macroblocks[mb_index].b[i * 8 + j] + level_shift, 0, max_value));
-                            macroblocks[mb_index].k[i * 8 + j] = clamp_to_8_bits(clamp(macroblocks[mb_index].k[i * 8 + j] + level_shift, 0, max_value));
-                        }
-                    }
-                }
-            }
-        }
-    }
+    return {};
 }
 
 static void undo_subsampling(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
@@ -1673,22 +1843,37 @@ static void undo_subsampling(JPEGLoadingContext const& context, Vector<Macrobloc
     }
 }
 
+// Conversion from YCbCr to RGB isn't specified in the first JPEG specification but in the JFIF extension:
+// See: https://www.itu.int/rec/dologin_pub.asp?lang=f&id=T-REC-T.871-201105-I!!PDF-E&type=items
+// 7 - Conversion to and from RGB
+// This works in place, like the components of a Macroblock, y becomes r, cb becomes g and cr becomes b.
+static ALWAYS_INLINE void ycbcr_to_rgb(i16x8& y, i16x8& cb, i16x8& cr)
+{
+    auto const luma = __builtin_convertvector(y, f32x8);
+    auto const blue_difference = __builtin_convertvector(cb, f32x8) - 128.0f;
+    auto const red_difference = __builtin_convertvector(cr, f32x8) - 128.0f;
+
+    auto const clamp_to_8_bits = [](f32x8 const& color) {
+        auto const integer_color = __builtin_convertvector(color, i32x8);
+        return __builtin_convertvector(integer_color < 0 ? 0 : (integer_color > 255 ? 255 : integer_color), i16x8);
+    };
+    y = clamp_to_8_bits(luma + 1.402f * red_difference);
+    cb = clamp_to_8_bits(luma - 0.3441f * blue_difference - 0.7141f * red_difference);
+    cr = clamp_to_8_bits(luma + 1.772f * blue_difference);
+}
+
 static void ycbcr_to_rgb(Vector<Macroblock>& macroblocks)
 {
-    // Conversion from YCbCr to RGB isn't specified in the first JPEG specification but in the JFIF extension:
-    // See: https://www.itu.int/rec/dologin_pub.asp?lang=f&id=T-REC-T.871-201105-I!!PDF-E&type=items
-    // 7 - Conversion to and from RGB
     for (auto& macroblock : macroblocks) {
-        auto* y = macroblock.y;
-        auto* cb = macroblock.cb;
-        auto* cr = macroblock.cr;
-        for (u8 i = 0; i < 64; ++i) {
-            int r = y[i] + 1.402f * (cr[i] - 128);
-            int g = y[i] - 0.3441f * (cb[i] - 128) - 0.7141f * (cr[i] - 128);
-            int b = y[i] + 1.772f * (cb[i] - 128);
-            y[i] = clamp(r, 0, 255);
-            cb[i] = clamp(g, 0, 255);
-            cr[i] = clamp(b, 0, 255);
+        for (u8 i = 0; i < 64; i += 8) {
+            i16x8 y, cb, cr;
+            __builtin_memcpy(&y, macroblock.y + i, sizeof(y));
+            __builtin_memcpy(&cb, macroblock.cb + i, sizeof(cb));
+            __builtin_memcpy(&cr, macroblock.cr + i, sizeof(cr));
+            ycbcr_to_rgb(y, cb, cr);
+            __builtin_memcpy(macroblock.r + i, &y, sizeof(y));
+            __builtin_memcpy(macroblock.g + i, &cb, sizeof(cb));
+            __builtin_memcpy(macroblock.b + i, &cr, sizeof(cr));
         }
     }
 }
@@ -1733,65 +1918,151 @@ static void ycck_to_cmyk(Vector<Macroblock>& macroblocks)
 }
 
 static ErrorOr<void> handle_color_transform(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
+{
+    // Only images with four components go through here, compose_bitmap() converts the other ones as it goes.
+    VERIFY(context.components.size() == 4);
+
+    // No App14 segment is present, assuming CMYK (Nothing to do here).
+    if (!context.color_transform.has_value())
+        return {};
+
+    // https://www.itu.int/rec/dologin_pub.asp?lang=e&id=T-REC-T.872-201206-I!!PDF-E&type=items
+    // 6.5.3 - APP14 marker segment for colour encoding
+    switch (*context.color_transform) {
+    case ColorTransform::CmykOrRgb:
+        break;
+    case ColorTransform::YCbCr:
+        ycbcr_to_rgb(macroblocks);
+        break;
+    case ColorTransform::YCCK:
+        ycck_to_cmyk(macroblocks);
+        break;
+    }
+
+    return {};
+}
+
+enum class PixelConversion {
+    Grayscale,
+    RGB,
+    YCbCr,
+};
+
+static ErrorOr<PixelConversion> pixel_conversion(JPEGLoadingContext const& context)
 {
     // Note: This is non-standard but some encoder still add the App14 segment for grayscale images.
     //       So let's ignore the color transform value if we only have one component.
-    if (context.color_transform.has_value() && context.components.size() != 1) {
-        // https://www.itu.int/rec/dologin_pub.asp?lang=e&id=T-REC-T.872-201206-I!!PDF-E&type=items
-        // 6.5.3 - APP14 marker segment for colour encoding
-
-        switch (*context.color_transform) {
-        case ColorTransform::CmykOrRgb:
-            if (context.components.size() == 4) {
-                // Nothing to do here.
-            } else if (context.components.size() == 3) {
-                // Note: components.size() == 3 means that we have an RGB image, so no color transformation is needed.
-            } else {
-                return Error::from_string_literal("Wrong number of components for CMYK or RGB, aborting.");
-            }
-            break;
-        case ColorTransform::YCbCr:
-            ycbcr_to_rgb(macroblocks);
-            break;
-        case ColorTransform::YCCK:
-            ycck_to_cmyk(macroblocks);
-            break;
-        }
+    if (context.components.size() == 1)
+        return PixelConversion::Grayscale;
 
-        return {};
+    VERIFY(context.components.size() == 3);
+
+    // No App14 segment is present, assuming 3 components means YCbCr.
+    if (!context.color_transform.has_value())
+        return PixelConversion::YCbCr;
+
+    // https://www.itu.int/rec/dologin_pub.asp?lang=e&id=T-REC-T.872-201206-I!!PDF-E&type=items
+    // 6.5.3 - APP14 marker segment for colour encoding
+    switch (*context.color_transform) {
+    case ColorTransform::CmykOrRgb:
+        return PixelConversion::RGB;
+    case ColorTransform::YCbCr:
+        return PixelConversion::YCbCr;
+    case ColorTransform::YCCK:
+        return Error::from_string_literal("Wrong number of components for YCCK, aborting.");
     }
+    VERIFY_NOT_REACHED();
+}
 
-    // No App14 segment is present, assuming :
-    //      - 1 components means grayscale
-    //      - 3 components means YCbCr
-    //      - 4 components means CMYK (Nothing to do here).
-    if (context.components.size() == 3)
-        ycbcr_to_rgb(macroblocks);
+static IntSize decoded_size(JPEGLoadingContext const& context)
+{
+    return {
+        static_cast<int>(ceil_div(context.frame.width * context.block_size, 8u)),
+        static_cast<int>(ceil_div(context.frame.height * context.block_size, 8u)),
+    };
+}
 
-    if (context.components.size() == 1) {
-        // With Cb and Cr being equal to zero, this function assign the Y
-        // value (luminosity) to R, G and B. Providing a proper conversion
-        // from grayscale to RGB.
-        ycbcr_to_rgb(macroblocks);
+// Returns the sample of a component for the pixel at (x, y) of the decoded image. Subsampled components are stretched
+// over the whole MCU, see A.2 Order of source image data encoding.
+static ALWAYS_INLINE i16 const* sample_at(JPEGLoadingContext const& context, Vector<Macroblock> const& macroblocks, u32 component_i, u32 x, u32 y)
+{
+    // read_start_of_frame() made sure that these are whole numbers, as the sampling factors are 1 or 2 they are too.
+    auto const& component = context.components[component_i];
+    u32 const horizontal_ratio = context.sampling_factors.horizontal / component.sampling_factors.horizontal;
+    u32 const vertical_ratio = context.sampling_factors.vertical / component.sampling_factors.vertical;
+
+    u32 const block_size = context.block_size;
+    u32 const mcu_width = context.sampling_factors.horizontal * block_size;
+    u32 const mcu_height = context.sampling_factors.vertical * block_size;
+    u32 const hcursor = x / mcu_width * context.sampling_factors.horizontal;
+    u32 const vcursor = y / mcu_height * context.sampling_factors.vertical;
+
+    u32 const component_x = x % mcu_width / horizontal_ratio;
+    u32 const component_y = y % mcu_height / vertical_ratio;
+    auto const& block = macroblocks[(vcursor + component_y / block_size) * context.mblock_meta.hpadded_count + hcursor + component_x / block_size];
+    return get_component(block, component_i) + (component_y % block_size) * 8 + component_x % block_size;
+}
+
+// Returns the samples of a component for the eight pixels starting at (x, y), x being a multiple of 8.
+static ALWAYS_INLINE i16x8 load_samples(JPEGLoadingContext const& context, Vector<Macroblock> const& macroblocks, u32 component_i, u32 x, u32 y)
+{
+    if (context.block_size == 8) {
+        // These pixels are all in the same block.
+        auto const* samples = sample_at(context, macroblocks, component_i, x, y);
+        if (context.sampling_factors.horizontal == context.components[component_i].sampling_factors.horizontal) {
+            i16x8 line;
+            __builtin_memcpy(&line, samples, sizeof(line));
+            return line;
+        }
+        return i16x8 { samples[0], samples[0], samples[1], samples[1], samples[2], samples[2], samples[3], samples[3] };
     }
 
-    return {};
+    u32 const width = decoded_size(context).width();
+    i16x8 line;
+    for (u32 i = 0; i < 8; ++i)
+        line[i] = *sample_at(context, macroblocks, component_i, min(x + i, width - 1), y);
+    return line;
 }
 
 static ErrorOr<void> compose_bitmap(JPEGLoadingContext& context, Vector<Macroblock> const& macroblocks)
 {
-    context.bitmap = TRY(Bitmap::create(BitmapFormat::BGRx8888, { context.frame.width, context.frame.height }));
+    auto const conversion = TRY(pixel_conversion(context));
+    auto const size = decoded_size(context);
+    context.bitmap = TRY(Bitmap::create(BitmapFormat::BGRx8888, size));
+
+    // Chroma upsampling, color conversion and packing are all done here, eight pixels at a time, so that the image
+    // isn't walked over once for each of them.
+    for (int y = 0; y < size.height(); ++y) {
+        auto* scanline = context.bitmap->scanline(y);
+        for (int x = 0; x < size.width(); x += 8) {
+            auto const samples = [&](u32 component_i) {
+                return load_samples(context, macroblocks, component_i, x, y);
+            };
+
+            i16x8 r, g, b;
+            switch (conversion) {
+            case PixelConversion::Grayscale:
+                r = g = b = samples(0);
+                break;
+            case PixelConversion::RGB:
+                r = samples(0);
+                g = samples(1);
+                b = samples(2);
+                break;
+            case PixelConversion::YCbCr:
+                r = samples(0);
+                g = samples(1);
+                b = samples(2);
+                ycbcr_to_rgb(r, g, b);
+                break;
+            }
 
-    for (u32 y = context.frame.height - 1; y < context.frame.height; y--) {
-        u32 const block_row = y / 8;
-        u32 const pixel_row = y % 8;
-        for (u32 x = 0; x < context.frame.width; x++) {
-            u32 const block_column = x / 8;
-            auto& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
-            u32 const pixel_column = x % 8;
-            u32 const pixel_index = pixel_row * 8 + pixel_column;
-            Color const color { (u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index] };
-            context.bitmap->set_pixel(x, y, color);
+            auto const pixels = 0xff000000u
+                | __builtin_convertvector(r, u32x8) << 16
+                | __builtin_convertvector(g, u32x8) << 8
+                | __builtin_convertvector(b, u32x8);
+            auto const pixel_count = min(8, size.width() - x);
+            __builtin_memcpy(scanline + x, &pixels, pixel_count * sizeof(ARGB32));
         }
     }
 
@@ -1951,7 +2222,10 @@ static ErrorOr<Vector<Macroblock>> construct_macroblocks(JPEGLoadingContext& con
             TRY(handle_miscellaneous_or_table(context.stream, context, marker));
         } else if (marker == JPEG_SOS) {
             TRY(read_start_of_scan(context.stream, context));
-            TRY(decode_huffman_stream(context, macroblocks));
+            if (can_decode_restart_intervals_in_parallel(context))
+                TRY(decode_restart_intervals_in_parallel(context, macroblocks));
+            else
+                TRY(decode_huffman_stream(context, macroblocks));
         } else if (marker == JPEG_EOI) {
             return macroblocks;
         } else {
@@ -1966,19 +2240,20 @@ static ErrorOr<Vector<Macroblock>> construct_macroblocks(JPEGLoadingContext& con
 static ErrorOr<void> decode_jpeg(JPEGLoadingContext& context)
 {
     auto macroblocks = TRY(construct_macroblocks(context));
-    TRY(dequantize(context, macroblocks));
-    inverse_dct(context, macroblocks);
-    undo_subsampling(context, macroblocks);
-    TRY(handle_color_transform(context, macroblocks));
-    if (context.components.size() == 4)
+    TRY(dequantize_and_inverse_dct(context, macroblocks));
+    if (context.components.size() == 4) {
+        undo_subsampling(context, macroblocks);
+        TRY(handle_color_transform(context, macroblocks));
         TRY(compose_cmyk_bitmap(context, macroblocks));
-    else
+    } else {
         TRY(compose_bitmap(context, macroblocks));
+    }
     return {};
 }
 
-JPEGImageDecoderPlugin::JPEGImageDecoderPlugin(NonnullOwnPtr<JPEGLoadingContext> context)
-    : m_context(move(context))
+JPEGImageDecoderPlugin::JPEGImageDecoderPlugin(ReadonlyBytes data, NonnullOwnPtr<JPEGLoadingContext> context)
+    : m_data(data)
+    , m_context(move(context))
 {
 }
 
@@ -2002,16 +2277,37 @@ ErrorOr<NonnullOwnPtr<ImageDecoderPlugin>> JPEGImageDecoderPlugin::create(Readon
     return create_with_options(data, {});
 }
 
-ErrorOr<NonnullOwnPtr<ImageDecoderPlugin>> JPEGImageDecoderPlugin::create_with_options(ReadonlyBytes data, JPEGDecoderOptions options)
+static ErrorOr<NonnullOwnPtr<JPEGLoadingContext>> create_context(ReadonlyBytes data, JPEGDecoderOptions options)
 {
     auto stream = TRY(try_make<FixedMemoryStream>(data));
     auto context = TRY(JPEGLoadingContext::create(move(stream), options));
-    auto plugin = TRY(adopt_nonnull_own_or_enomem(new (nothrow) JPEGImageDecoderPlugin(move(context))));
-    TRY(decode_header(*plugin->m_context));
-    return plugin;
+    TRY(decode_header(*context));
+    return context;
 }
 
-ErrorOr<ImageFrameDescriptor> JPEGImageDecoderPlugin::frame(size_t index, Optional<IntSize>)
+ErrorOr<NonnullOwnPtr<ImageDecoderPlugin>> JPEGImageDecoderPlugin::create_with_options(ReadonlyBytes data, JPEGDecoderOptions options)
+{
+    auto context = TRY(create_context(data, options));
+    return TRY(adopt_nonnull_own_or_enomem(new (nothrow) JPEGImageDecoderPlugin(data, move(context))));
+}
+
+// Decoding an image at 1/2, 1/4 or 1/8 of its size is a lot cheaper than decoding all of it, so we go for the smallest
+// of these that is still at least as large as the size we were asked for.
+static u32 block_size_for_ideal_size(JPEGLoadingContext const& context, Optional<IntSize> ideal_size)
+{
+    // FIXME: Also decode CMYK images at smaller sizes.
+    if (!ideal_size.has_value() || context.components.size() == 4)
+        return 8;
+
+    for (u32 block_size = 1; block_size < 8; block_size *= 2) {
+        if (ceil_div(context.frame.width * block_size, 8u) >= static_cast<u32>(max(ideal_size->width(), 0))
+            && ceil_div(context.frame.height * block_size, 8u) >= static_cast<u32>(max(ideal_size->height(), 0)))
+            return block_size;
+    }
+    return 8;
+}
+
+ErrorOr<ImageFrameDescriptor> JPEGImageDecoderPlugin::frame(size_t index, Optional<IntSize> ideal_size)
 {
     if (index > 0)
         return Error::from_string_literal("JPEGImageDecoderPlugin: Invalid frame index");
@@ -2019,7 +2315,14 @@ ErrorOr<ImageFrameDescriptor> JPEGImageDecoderPlugin::frame(size_t index, Option
     if (m_context->state == JPEGLoadingContext::State::Error)
         return Error::from_string_literal("JPEGImageDecoderPlugin: Decoding failed");
 
+    auto const block_size = block_size_for_ideal_size(*m_context, ideal_size);
+    if (m_context->state == JPEGLoadingContext::State::BitmapDecoded && m_context->block_size < block_size) {
+        // The coefficients are gone once the image is decoded, so getting it at a larger size means starting over.
+        m_context = TRY(create_context(m_data, m_context->options));
+    }
+
     if (m_context->state < JPEGLoadingContext::State::BitmapDecoded) {
+        m_context->block_size = block_size;
         if (auto result = decode_jpeg(*m_context); result.is_error()) {
             m_context->state = JPEGLoadingContext::State::Error;
             return result.release_error();
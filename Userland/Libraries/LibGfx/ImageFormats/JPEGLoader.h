@@ -25,6 +25,10 @@ struct JPEGDecoderOptions {
         PDF,
     };
     CMYK cmyk { CMYK::Normal };
+
+    // Baseline images with restart markers can be decoded on several threads at once. This is off by default, as the
+    // process has to be allowed to create threads.
+    size_t maximum_thread_count { 1 };
 };
 
 class JPEGImageDecoderPlugin : public ImageDecoderPlugin {
@@ -46,8 +50,9 @@ public:
     virtual ErrorOr<NonnullRefPtr<CMYKBitmap>> cmyk_frame() override;
 
 private:
-    JPEGImageDecoderPlugin(NonnullOwnPtr<JPEGLoadingContext>);
+    JPEGImageDecoderPlugin(ReadonlyBytes, NonnullOwnPtr<JPEGLoadingContext>);
 
+    ReadonlyBytes m_data;
     NonnullOwnPtr<JPEGLoadingContext> m_context;
 };
 
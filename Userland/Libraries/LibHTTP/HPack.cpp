@@ -0,0 +1,459 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/StringBuilder.h>
+#include <LibHTTP/HPack.h>
+
+namespace HTTP::HPack {
+
+struct StaticTableEntry {
+    StringView name;
+    StringView value;
+};
+
+// https://www.rfc-editor.org/rfc/rfc7541#appendix-A
+static constexpr StaticTableEntry static_table[] = {
+    { ":authority"sv, ""sv },
+    { ":method"sv, "GET"sv },
+    { ":method"sv, "POST"sv },
+    { ":path"sv, "/"sv },
+    { ":path"sv, "/index.html"sv },
+    { ":scheme"sv, "http"sv },
+    { ":scheme"sv, "https"sv },
+    { ":status"sv, "200"sv },
+    { ":status"sv, "204"sv },
+    { ":status"sv, "206"sv },
+    { ":status"sv, "304"sv },
+    { ":status"sv, "400"sv },
+    { ":status"sv, "404"sv },
+    { ":status"sv, "500"sv },
+    { "accept-charset"sv, ""sv },
+    { "accept-encoding"sv, "gzip, deflate"sv },
+    { "accept-language"sv, ""sv },
+    { "accept-ranges"sv, ""sv },
+    { "accept"sv, ""sv },
+    { "access-control-allow-origin"sv, ""sv },
+    { "age"sv, ""sv },
+    { "allow"sv, ""sv },
+    { "authorization"sv, ""sv },
+    { "cache-control"sv, ""sv },
+    { "content-disposition"sv, ""sv },
+    { "content-encoding"sv, ""sv },
+    { "content-language"sv, ""sv },
+    { "content-length"sv, ""sv },
+    { "content-location"sv, ""sv },
+    { "content-range"sv, ""sv },
+    { "content-type"sv, ""sv },
+    { "cookie"sv, ""sv },
+    { "date"sv, ""sv },
+    { "etag"sv, ""sv },
+    { "expect"sv, ""sv },
+    { "expires"sv, ""sv },
+    { "from"sv, ""sv },
+    { "host"sv, ""sv },
+    { "if-match"sv, ""sv },
+    { "if-modified-since"sv, ""sv },
+    { "if-none-match"sv, ""sv },
+    { "if-range"sv, ""sv },
+    { "if-unmodified-since"sv, ""sv },
+    { "last-modified"sv, ""sv },
+    { "link"sv, ""sv },
+    { "location"sv, ""sv },
+    { "max-forwards"sv, ""sv },
+    { "proxy-authenticate"sv, ""sv },
+    { "proxy-authorization"sv, ""sv },
+    { "range"sv, ""sv },
+    { "referer"sv, ""sv },
+    { "refresh"sv, ""sv },
+    { "retry-after"sv, ""sv },
+    { "server"sv, ""sv },
+    { "set-cookie"sv, ""sv },
+    { "strict-transport-security"sv, ""sv },
+    { "transfer-encoding"sv, ""sv },
+    { "user-agent"sv, ""sv },
+    { "vary"sv, ""sv },
+    { "via"sv, ""sv },
+    { "www-authenticate"sv, ""sv },
+};
+
+static constexpr size_t first_dynamic_table_index = array_size(static_table) + 1;
+
+struct HuffmanCode {
+    u32 code;
+    u8 length;
+};
+
+// https://www.rfc-editor.org/rfc/rfc7541#appendix-B, the last entry is EOS.
+static constexpr HuffmanCode huffman_codes[] = {
+    { 0x1ff8, 13 }, { 0x7fffd8, 23 }, { 0xfffffe2, 28 }, { 0xfffffe3, 28 }, { 0xfffffe4, 28 }, { 0xfffffe5, 28 }, { 0xfffffe6, 28 }, { 0xfffffe7, 28 },
+    { 0xfffffe8, 28 }, { 0xffffea, 24 }, { 0x3ffffffc, 30 }, { 0xfffffe9, 28 }, { 0xfffffea, 28 }, { 0x3ffffffd, 30 }, { 0xfffffeb, 28 }, { 0xfffffec, 28 },
+    { 0xfffffed, 28 }, { 0xfffffee, 28 }, { 0xfffffef, 28 }, { 0xffffff0, 28 }, { 0xffffff1, 28 }, { 0xffffff2, 28 }, { 0x3ffffffe, 30 }, { 0xffffff3, 28 },
+    { 0xffffff4, 28 }, { 0xffffff5, 28 }, { 0xffffff6, 28 }, { 0xffffff7, 28 }, { 0xffffff8, 28 }, { 0xffffff9, 28 }, { 0xffffffa, 28 }, { 0xffffffb, 28 },
+    { 0x14, 6 }, { 0x3f8, 10 }, { 0x3f9, 10 }, { 0xffa, 12 }, { 0x1ff9, 13 }, { 0x15, 6 }, { 0xf8, 8 }, { 0x7fa, 11 },
+    { 0x3fa, 10 }, { 0x3fb, 10 }, { 0xf9, 8 }, { 0x7fb, 11 }, { 0xfa, 8 }, { 0x16, 6 }, { 0x17, 6 }, { 0x18, 6 },
+    { 0x0, 5 }, { 0x1, 5 }, { 0x2, 5 }, { 0x19, 6 }, { 0x1a, 6 }, { 0x1b, 6 }, { 0x1c, 6 }, { 0x1d, 6 },
+    { 0x1e, 6 }, { 0x1f, 6 }, { 0x5c, 7 }, { 0xfb, 8 }, { 0x7ffc, 15 }, { 0x20, 6 }, { 0xffb, 12 }, { 0x3fc, 10 },
+    { 0x1ffa, 13 }, { 0x21, 6 }, { 0x5d, 7 }, { 0x5e, 7 }, { 0x5f, 7 }, { 0x60, 7 }, { 0x61, 7 }, { 0x62, 7 },
+    { 0x63, 7 }, { 0x64, 7 }, { 0x65, 7 }, { 0x66, 7 }, { 0x67, 7 }, { 0x68, 7 }, { 0x69, 7 }, { 0x6a, 7 },
+    { 0x6b, 7 }, { 0x6c, 7 }, { 0x6d, 7 }, { 0x6e, 7 }, { 0x6f, 7 }, { 0x70, 7 }, { 0x71, 7 }, { 0x72, 7 },
+    { 0xfc, 8 }, { 0x73, 7 }, { 0xfd, 8 }, { 0x1ffb, 13 }, { 0x7fff0, 19 }, { 0x1ffc, 13 }, { 0x3ffc, 14 }, { 0x22, 6 },
+    { 0x7ffd, 15 }, { 0x3, 5 }, { 0x23, 6 }, { 0x4, 5 }, { 0x24, 6 }, { 0x5, 5 }, { 0x25, 6 }, { 0x26, 6 },
+    { 0x27, 6 }, { 0x6, 5 }, { 0x74, 7 }, { 0x75, 7 }, { 0x28, 6 }, { 0x29, 6 }, { 0x2a, 6 }, { 0x7, 5 },
+    { 0x2b, 6 }, { 0x76, 7 }, { 0x2c, 6 }, { 0x8, 5 }, { 0x9, 5 }, { 0x2d, 6 }, { 0x77, 7 }, { 0x78, 7 },
+    { 0x79, 7 }, { 0x7a, 7 }, { 0x7b, 7 }, { 0x7ffe, 15 }, { 0x7fc, 11 }, { 0x3ffd, 14 }, { 0x1ffd, 13 }, { 0xffffffc, 28 },
+    { 0xfffe6, 20 }, { 0x3fffd2, 22 }, { 0xfffe7, 20 }, { 0xfffe8, 20 }, { 0x3fffd3, 22 }, { 0x3fffd4, 22 }, { 0x3fffd5, 22 }, { 0x7fffd9, 23 },
+    { 0x3fffd6, 22 }, { 0x7fffda, 23 }, { 0x7fffdb, 23 }, { 0x7fffdc, 23 }, { 0x7fffdd, 23 }, { 0x7fffde, 23 }, { 0xffffeb, 24 }, { 0x7fffdf, 23 },
+    { 0xffffec, 24 }, { 0xffffed, 24 }, { 0x3fffd7, 22 }, { 0x7fffe0, 23 }, { 0xffffee, 24 }, { 0x7fffe1, 23 }, { 0x7fffe2, 23 }, { 0x7fffe3, 23 },
+    { 0x7fffe4, 23 }, { 0x1fffdc, 21 }, { 0x3fffd8, 22 }, { 0x7fffe5, 23 }, { 0x3fffd9, 22 }, { 0x7fffe6, 23 }, { 0x7fffe7, 23 }, { 0xffffef, 24 },
+    { 0x3fffda, 22 }, { 0x1fffdd, 21 }, { 0xfffe9, 20 }, { 0x3fffdb, 22 }, { 0x3fffdc, 22 }, { 0x7fffe8, 23 }, { 0x7fffe9, 23 }, { 0x1fffde, 21 },
+    { 0x7fffea, 23 }, { 0x3fffdd, 22 }, { 0x3fffde, 22 }, { 0xfffff0, 24 }, { 0x1fffdf, 21 }, { 0x3fffdf, 22 }, { 0x7fffeb, 23 }, { 0x7fffec, 23 },
+    { 0x1fffe0, 21 }, { 0x1fffe1, 21 }, { 0x3fffe0, 22 }, { 0x1fffe2, 21 }, { 0x7fffed, 23 }, { 0x3fffe1, 22 }, { 0x7fffee, 23 }, { 0x7fffef, 23 },
+    { 0xfffea, 20 }, { 0x3fffe2, 22 }, { 0x3fffe3, 22 }, { 0x3fffe4, 22 }, { 0x7ffff0, 23 }, { 0x3fffe5, 22 }, { 0x3fffe6, 22 }, { 0x7ffff1, 23 },
+    { 0x3ffffe0, 26 }, { 0x3ffffe1, 26 }, { 0xfffeb, 20 }, { 0x7fff1, 19 }, { 0x3fffe7, 22 }, { 0x7ffff2, 23 }, { 0x3fffe8, 22 }, { 0x1ffffec, 25 },
+    { 0x3ffffe2, 26 }, { 0x3ffffe3, 26 }, { 0x3ffffe4, 26 }, { 0x7ffffde, 27 }, { 0x7ffffdf, 27 }, { 0x3ffffe5, 26 }, { 0xfffff1, 24 }, { 0x1ffffed, 25 },
+    { 0x7fff2, 19 }, { 0x1fffe3, 21 }, { 0x3ffffe6, 26 }, { 0x7ffffe0, 27 }, { 0x7ffffe1, 27 }, { 0x3ffffe7, 26 }, { 0x7ffffe2, 27 }, { 0xfffff2, 24 },
+    { 0x1fffe4, 21 }, { 0x1fffe5, 21 }, { 0x3ffffe8, 26 }, { 0x3ffffe9, 26 }, { 0xffffffd, 28 }, { 0x7ffffe3, 27 }, { 0x7ffffe4, 27 }, { 0x7ffffe5, 27 },
+    { 0xfffec, 20 }, { 0xfffff3, 24 }, { 0xfffed, 20 }, { 0x1fffe6, 21 }, { 0x3fffe9, 22 }, { 0x1fffe7, 21 }, { 0x1fffe8, 21 }, { 0x7ffff3, 23 },
+    { 0x3fffea, 22 }, { 0x3fffeb, 22 }, { 0x1ffffee, 25 }, { 0x1ffffef, 25 }, { 0xfffff4, 24 }, { 0xfffff5, 24 }, { 0x3ffffea, 26 }, { 0x7ffff4, 23 },
+    { 0x3ffffeb, 26 }, { 0x7ffffe6, 27 }, { 0x3ffffec, 26 }, { 0x3ffffed, 26 }, { 0x7ffffe7, 27 }, { 0x7ffffe8, 27 }, { 0x7ffffe9, 27 }, { 0x7ffffea, 27 },
+    { 0x7ffffeb, 27 }, { 0xffffffe, 28 }, { 0x7ffffec, 27 }, { 0x7ffffed, 27 }, { 0x7ffffee, 27 }, { 0x7ffffef, 27 }, { 0x7fffff0, 27 }, { 0x3ffffee, 26 },
+    { 0x3fffffff, 30 },
+};
+
+static constexpr u16 huffman_end_of_string = 256;
+static constexpr u8 huffman_maximum_code_length = 30;
+
+// The code is canonical, so the codes of each length are consecutive numbers, assigned in the order of the symbols.
+struct HuffmanDecodingTable {
+    u32 first_code[huffman_maximum_code_length + 1] {};
+    u16 first_symbol_index[huffman_maximum_code_length + 1] {};
+    u16 code_count[huffman_maximum_code_length + 1] {};
+    u16 symbols[array_size(huffman_codes)] {};
+};
+
+static constexpr HuffmanDecodingTable huffman_decoding_table = [] {
+    HuffmanDecodingTable table;
+    u16 index = 0;
+    for (u8 length = 1; length <= huffman_maximum_code_length; ++length) {
+        table.first_symbol_index[length] = index;
+        for (u16 symbol = 0; symbol < array_size(huffman_codes); ++symbol) {
+            if (huffman_codes[symbol].length != length)
+                continue;
+            if (table.code_count[length]++ == 0)
+                table.first_code[length] = huffman_codes[symbol].code;
+            table.symbols[index++] = symbol;
+        }
+    }
+    return table;
+}();
+
+void DynamicTable::set_max_size(size_t max_size)
+{
+    m_max_size = max_size;
+    evict_down_to(max_size);
+}
+
+void DynamicTable::add(Header header)
+{
+    // An entry larger than the table empties it, and is not added, see RFC 7541, 4.4.
+    auto size = entry_size(header);
+    if (size > m_max_size) {
+        evict_down_to(0);
+        return;
+    }
+    evict_down_to(m_max_size - size);
+    m_entries.append(move(header));
+    m_size += size;
+}
+
+void DynamicTable::evict_down_to(size_t size)
+{
+    size_t evicted_count = 0;
+    while (m_size > size) {
+        m_size -= entry_size(m_entries[evicted_count]);
+        ++evicted_count;
+    }
+    m_entries.remove(0, evicted_count);
+}
+
+// https://www.rfc-editor.org/rfc/rfc7541#section-5.1
+ErrorOr<void> encode_integer(ByteBuffer& buffer, u8 first_byte_flags, u8 prefix_bits, u64 value)
+{
+    u8 prefix_max = (1 << prefix_bits) - 1;
+    if (value < prefix_max)
+        return buffer.try_append(static_cast<u8>(first_byte_flags | value));
+
+    TRY(buffer.try_append(static_cast<u8>(first_byte_flags | prefix_max)));
+    value -= prefix_max;
+    while (value >= 128) {
+        TRY(buffer.try_append(static_cast<u8>((value & 0x7f) | 0x80)));
+        value >>= 7;
+    }
+    return buffer.try_append(static_cast<u8>(value));
+}
+
+ErrorOr<u64> decode_integer(ReadonlyBytes& data, u8 prefix_bits)
+{
+    if (data.is_empty())
+        return Error::from_string_literal("HPACK: Truncated integer");
+
+    u8 prefix_max = (1 << prefix_bits) - 1;
+    u64 value = data[0] & prefix_max;
+    data = data.slice(1);
+    if (value < prefix_max)
+        return value;
+
+    for (u8 shift = 0;; shift += 7) {
+        if (data.is_empty())
+            return Error::from_string_literal("HPACK: Truncated integer");
+        // Nothing we decode comes anywhere near this, so anything longer is an attempt to overflow.
+        if (shift > 28)
+            return Error::from_string_literal("HPACK: Integer too large");
+        u8 byte = data[0];
+        data = data.slice(1);
+        value += static_cast<u64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+}
+
+// https://www.rfc-editor.org/rfc/rfc7541#section-5.2
+ErrorOr<void> encode_string(ByteBuffer& buffer, StringView string)
+{
+    auto huffman_length = huffman_encoded_length(string);
+    if (huffman_length < string.length()) {
+        TRY(encode_integer(buffer, 0x80, 7, huffman_length));
+        return huffman_encode(buffer, string);
+    }
+    TRY(encode_integer(buffer, 0, 7, string.length()));
+    return buffer.try_append(string.bytes());
+}
+
+ErrorOr<ByteString> decode_string(ReadonlyBytes& data)
+{
+    if (data.is_empty())
+        return Error::from_string_literal("HPACK: Truncated string");
+
+    bool is_huffman_encoded = data[0] & 0x80;
+    auto length = TRY(decode_integer(data, 7));
+    if (length > data.size())
+        return Error::from_string_literal("HPACK: Truncated string");
+
+    auto bytes = data.slice(0, length);
+    data = data.slice(length);
+    if (is_huffman_encoded)
+        return huffman_decode(bytes);
+    return ByteString { bytes };
+}
+
+size_t huffman_encoded_length(StringView string)
+{
+    size_t bit_count = 0;
+    for (auto byte : string.bytes())
+        bit_count += huffman_codes[byte].length;
+    return ceil_div(bit_count, static_cast<size_t>(8));
+}
+
+ErrorOr<void> huffman_encode(ByteBuffer& buffer, StringView string)
+{
+    u64 bits = 0;
+    u8 bit_count = 0;
+    for (auto byte : string.bytes()) {
+        auto const& code = huffman_codes[byte];
+        bits = (bits << code.length) | code.code;
+        bit_count += code.length;
+        while (bit_count >= 8) {
+            bit_count -= 8;
+            TRY(buffer.try_append(static_cast<u8>(bits >> bit_count)));
+        }
+        bits &= (1ull << bit_count) - 1;
+    }
+
+    // The padding is the most significant bits of EOS, which are all ones.
+    if (bit_count > 0)
+        TRY(buffer.try_append(static_cast<u8>((bits << (8 - bit_count)) | ((1u << (8 - bit_count)) - 1))));
+    return {};
+}
+
+ErrorOr<ByteString> huffman_decode(ReadonlyBytes data)
+{
+    auto const& table = huffman_decoding_table;
+
+    StringBuilder builder;
+    u32 code = 0;
+    u8 code_length = 0;
+    for (auto byte : data) {
+        for (int bit = 7; bit >= 0; --bit) {
+            code = (code << 1) | ((byte >> bit) & 1);
+            ++code_length;
+
+            auto count = table.code_count[code_length];
+            if (count == 0 || code < table.first_code[code_length] || code - table.first_code[code_length] >= count)
+                continue;
+
+            auto symbol = table.symbols[table.first_symbol_index[code_length] + code - table.first_code[code_length]];
+            if (symbol == huffman_end_of_string)
+                return Error::from_string_literal("HPACK: Huffman-encoded string contains EOS");
+            TRY(builder.try_append(static_cast<char>(symbol)));
+            code = 0;
+            code_length = 0;
+        }
+    }
+
+    // Padding must be shorter than a byte, and consist of the most significant bits of EOS.
+    if (code_length > 7 || code != (1u << code_length) - 1)
+        return Error::from_string_literal("HPACK: Invalid padding in Huffman-encoded string");
+    return builder.to_byte_string();
+}
+
+ErrorOr<Header> Decoder::header_at(size_t index) const
+{
+    if (index == 0)
+        return Error::from_string_literal("HPACK: Index 0 is not valid");
+    if (index < first_dynamic_table_index) {
+        auto const& entry = static_table[index - 1];
+        return Header { entry.name, entry.value };
+    }
+    if (index - first_dynamic_table_index >= m_table.entry_count())
+        return Error::from_string_literal("HPACK: Index past the end of the dynamic table");
+    return m_table.at(index - first_dynamic_table_index);
+}
+
+// https://www.rfc-editor.org/rfc/rfc7541#section-6
+ErrorOr<Vector<Header>> Decoder::decode(ReadonlyBytes data)
+{
+    Vector<Header> headers;
+
+    auto decode_literal = [&](u8 prefix_bits) -> ErrorOr<Header> {
+        auto name_index = TRY(decode_integer(data, prefix_bits));
+        auto name = name_index != 0 ? TRY(header_at(name_index)).name : TRY(decode_string(data));
+        auto value = TRY(decode_string(data));
+        return Header { move(name), move(value) };
+    };
+
+    // Table size updates have to come first in a header block, see RFC 7541, 4.2.
+    bool may_update_table_size = true;
+    while (!data.is_empty()) {
+        u8 first_byte = data[0];
+        if (first_byte & 0x80) {
+            // Indexed Header Field Representation
+            TRY(headers.try_append(TRY(header_at(TRY(decode_integer(data, 7))))));
+        } else if (first_byte & 0x40) {
+            // Literal Header Field with Incremental Indexing
+            auto header = TRY(decode_literal(6));
+            m_table.add(header);
+            TRY(headers.try_append(move(header)));
+        } else if (first_byte & 0x20) {
+            // Dynamic Table Size Update
+            if (!may_update_table_size)
+                return Error::from_string_literal("HPACK: Dynamic table size update after the first header");
+            auto size = TRY(decode_integer(data, 5));
+            if (size > m_max_table_size_limit)
+                return Error::from_string_literal("HPACK: Dynamic table size update exceeds the limit");
+            m_table.set_max_size(size);
+            continue;
+        } else {
+            // Literal Header Field without Indexing, and Literal Header Field Never Indexed
+            TRY(headers.try_append(TRY(decode_literal(4))));
+        }
+        may_update_table_size = false;
+    }
+    return headers;
+}
+
+void Encoder::set_max_table_size(size_t max_size)
+{
+    max_size = min(max_size, default_table_size);
+    if (max_size == m_table.max_size())
+        return;
+    m_table.set_max_size(max_size);
+    m_smallest_pending_table_size = min(max_size, m_smallest_pending_table_size.value_or(max_size));
+}
+
+enum class Indexing {
+    Incremental,
+    None,
+    Never,
+};
+
+static Indexing indexing_for(Header const& header, DynamicTable const& table)
+{
+    // Values that are easy to guess would be revealed by the compression ratio if they were indexed, see RFC 7541, 7.1.
+    if (header.name.is_one_of("authorization"sv, "proxy-authorization"sv))
+        return Indexing::Never;
+    if (header.name == "cookie"sv && header.value.length() < 20)
+        return Indexing::Never;
+
+    // These change from request to request, and would only push more useful entries out of the table.
+    if (header.name.is_one_of(":path"sv, "content-length"sv, "if-modified-since"sv, "if-none-match"sv))
+        return Indexing::None;
+    if (DynamicTable::entry_size(header) > table.max_size() * 3 / 4)
+        return Indexing::None;
+
+    return Indexing::Incremental;
+}
+
+ErrorOr<ByteBuffer> Encoder::encode(ReadonlySpan<Header> headers)
+{
+    ByteBuffer buffer;
+
+    // https://www.rfc-editor.org/rfc/rfc7541#section-4.2
+    if (m_smallest_pending_table_size.has_value()) {
+        if (*m_smallest_pending_table_size < m_table.max_size())
+            TRY(encode_integer(buffer, 0x20, 5, *m_smallest_pending_table_size));
+        TRY(encode_integer(buffer, 0x20, 5, m_table.max_size()));
+        m_smallest_pending_table_size.clear();
+    }
+
+    for (auto const& header : headers) {
+        size_t name_index = 0;
+        size_t header_index = 0;
+        for (size_t i = 0; i < array_size(static_table) && header_index == 0; ++i) {
+            if (static_table[i].name != header.name)
+                continue;
+            if (name_index == 0)
+                name_index = i + 1;
+            if (static_table[i].value == header.value)
+                header_index = i + 1;
+        }
+        for (size_t i = 0; i < m_table.entry_count() && header_index == 0; ++i) {
+            auto const& entry = m_table.at(i);
+            if (entry.name != header.name)
+                continue;
+            if (name_index == 0)
+                name_index = first_dynamic_table_index + i;
+            if (entry.value == header.value)
+                header_index = first_dynamic_table_index + i;
+        }
+
+        auto indexing = indexing_for(header, m_table);
+        if (header_index != 0 && indexing != Indexing::Never) {
+            TRY(encode_integer(buffer, 0x80, 7, header_index));
+            continue;
+        }
+
+        switch (indexing) {
+        case Indexing::Incremental:
+            TRY(encode_integer(buffer, 0x40, 6, name_index));
+            break;
+        case Indexing::None:
+            TRY(encode_integer(buffer, 0x00, 4, name_index));
+            break;
+        case Indexing::Never:
+            TRY(encode_integer(buffer, 0x10, 4, name_index));
+            break;
+        }
+        if (name_index == 0)
+            TRY(encode_string(buffer, header.name));
+        TRY(encode_string(buffer, header.value));
+
+        if (indexing == Indexing::Incremental)
+            m_table.add(header);
+    }
+    return buffer;
+}
+
+}
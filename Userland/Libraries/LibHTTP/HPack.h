@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/ByteString.h>
+#include <AK/Error.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
+
+// HPACK, the header compression format of HTTP/2.
+// https://www.rfc-editor.org/rfc/rfc7541
+namespace HTTP::HPack {
+
+struct Header {
+    ByteString name;
+    ByteString value;
+
+    bool operator==(Header const&) const = default;
+};
+
+constexpr size_t default_table_size = 4096;
+
+// https://www.rfc-editor.org/rfc/rfc7541#section-2.3.2
+class DynamicTable {
+public:
+    explicit DynamicTable(size_t max_size)
+        : m_max_size(max_size)
+    {
+    }
+
+    // Index 0 is the most recently added entry.
+    Header const& at(size_t index) const { return m_entries[m_entries.size() - index - 1]; }
+    size_t entry_count() const { return m_entries.size(); }
+
+    size_t size() const { return m_size; }
+    size_t max_size() const { return m_max_size; }
+    void set_max_size(size_t);
+
+    void add(Header);
+
+    // https://www.rfc-editor.org/rfc/rfc7541#section-4.1
+    static size_t entry_size(Header const& header) { return header.name.length() + header.value.length() + 32; }
+
+private:
+    void evict_down_to(size_t);
+
+    // Oldest first, so that adding an entry doesn't move all the others.
+    Vector<Header> m_entries;
+    size_t m_size { 0 };
+    size_t m_max_size { 0 };
+};
+
+class Decoder {
+public:
+    explicit Decoder(size_t max_table_size = default_table_size)
+        : m_table(max_table_size)
+        , m_max_table_size_limit(max_table_size)
+    {
+    }
+
+    // Decodes a complete header block. Any error is fatal for the connection, as the dynamic table may be out of sync.
+    ErrorOr<Vector<Header>> decode(ReadonlyBytes);
+
+    DynamicTable const& table() const { return m_table; }
+
+private:
+    ErrorOr<Header> header_at(size_t index) const;
+
+    DynamicTable m_table;
+    size_t m_max_table_size_limit { 0 };
+};
+
+class Encoder {
+public:
+    explicit Encoder(size_t max_table_size = default_table_size)
+        : m_table(max_table_size)
+    {
+    }
+
+    // Header names have to be lowercase already.
+    ErrorOr<ByteBuffer> encode(ReadonlySpan<Header>);
+
+    // Called with the decoder's limit, i.e. the SETTINGS_HEADER_TABLE_SIZE of the peer. The table never grows beyond
+    // the default size though, as there is little to gain from that for a client.
+    void set_max_table_size(size_t);
+
+    DynamicTable const& table() const { return m_table; }
+
+private:
+    DynamicTable m_table;
+    Optional<size_t> m_smallest_pending_table_size;
+};
+
+ErrorOr<void> encode_integer(ByteBuffer&, u8 first_byte_flags, u8 prefix_bits, u64 value);
+ErrorOr<u64> decode_integer(ReadonlyBytes&, u8 prefix_bits);
+ErrorOr<void> encode_string(ByteBuffer&, StringView);
+ErrorOr<ByteString> decode_string(ReadonlyBytes&);
+
+// https://www.rfc-editor.org/rfc/rfc7541#section-5.2
+size_t huffman_encoded_length(StringView);
+ErrorOr<void> huffman_encode(ByteBuffer&, StringView);
+ErrorOr<ByteString> huffman_decode(ReadonlyBytes);
+
+}
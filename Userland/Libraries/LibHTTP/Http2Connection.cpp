@@ -0,0 +1,884 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Endian.h>
+#include <LibCore/Event.h>
+#include <LibHTTP/Http2Connection.h>
+#include <LibTLS/TLSv12.h>
+
+namespace HTTP {
+
+static constexpr auto connection_preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"sv;
+
+// Until the server's SETTINGS arrive we don't know its limit, but it shouldn't be lower than this, see RFC 9113, 5.1.2.
+static constexpr u32 assumed_max_concurrent_streams = 100;
+
+static u32 read_u32(ReadonlyBytes bytes)
+{
+    return (static_cast<u32>(bytes[0]) << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+}
+
+static void write_u32(Bytes bytes, u32 value)
+{
+    bytes[0] = value >> 24;
+    bytes[1] = value >> 16;
+    bytes[2] = value >> 8;
+    bytes[3] = value;
+}
+
+// https://www.rfc-editor.org/rfc/rfc9113#section-6.1
+static ErrorOr<ReadonlyBytes, Http2ErrorCode> remove_padding(ReadonlyBytes payload, bool is_padded)
+{
+    if (!is_padded)
+        return payload;
+    if (payload.is_empty() || payload[0] >= payload.size())
+        return Http2ErrorCode::ProtocolError;
+    return payload.slice(1, payload.size() - 1 - payload[0]);
+}
+
+Http2Stream::Http2Stream(Http2Connection& connection, HttpRequest request)
+    : m_connection(connection.make_weak_ptr<Http2Connection>())
+    , m_request(move(request))
+{
+}
+
+void Http2Stream::cancel()
+{
+    on_headers_received = nullptr;
+    on_trailers_received = nullptr;
+    on_data_received = nullptr;
+    on_finish = nullptr;
+
+    if (m_state == State::Closed)
+        return;
+    if (auto connection = m_connection.strong_ref())
+        connection->reset_stream(*this, Http2ErrorCode::Cancel);
+    else
+        m_state = State::Closed;
+}
+
+Http2Connection::Http2Connection(NonnullOwnPtr<Core::Socket> socket)
+    : m_socket(move(socket))
+{
+    m_socket->on_ready_to_read = [this] { read_from_socket(); };
+
+    // TLS sockets don't become readable when the server closes the connection, they tell us separately.
+    if (is<TLS::TLSv12>(*m_socket)) {
+        auto& tls_socket = static_cast<TLS::TLSv12&>(*m_socket);
+        tls_socket.on_tls_finished = [this] { did_close(); };
+        tls_socket.on_tls_error = [this](auto) { did_close(); };
+    }
+
+    send_connection_preface();
+
+    // The server's SETTINGS may have arrived along with the end of the TLS handshake, before anyone was listening.
+    deferred_invoke([this] { read_from_socket(); });
+}
+
+Http2Connection::~Http2Connection()
+{
+    m_socket->on_ready_to_read = nullptr;
+    if (is<TLS::TLSv12>(*m_socket)) {
+        auto& tls_socket = static_cast<TLS::TLSv12&>(*m_socket);
+        tls_socket.on_tls_finished = nullptr;
+        tls_socket.on_tls_error = nullptr;
+    }
+}
+
+// https://www.rfc-editor.org/rfc/rfc9113#section-3.4
+void Http2Connection::send_connection_preface()
+{
+    m_send_buffer.append(connection_preface.bytes());
+
+    u8 settings[12];
+    auto append_setting = [&](size_t index, SettingsParameter parameter, u32 value) {
+        settings[index * 6] = to_underlying(parameter) >> 8;
+        settings[index * 6 + 1] = to_underlying(parameter);
+        write_u32({ settings + index * 6 + 2, 4 }, value);
+    };
+    append_setting(0, SettingsParameter::EnablePush, 0);
+    append_setting(1, SettingsParameter::InitialWindowSize, local_stream_window_size);
+    send_frame(FrameType::Settings, 0, 0, { settings, sizeof(settings) });
+
+    // The connection window can only be changed with a WINDOW_UPDATE.
+    send_window_update(0, local_connection_window_size - default_window_size);
+}
+
+NonnullRefPtr<Http2Stream> Http2Connection::open_stream(HttpRequest request)
+{
+    auto stream = adopt_ref(*new Http2Stream(*this, move(request)));
+    if (!can_open_streams()) {
+        stream->m_state = Http2Stream::State::Closed;
+        deferred_invoke([stream] {
+            if (stream->on_finish)
+                stream->on_finish(false);
+        });
+        return stream;
+    }
+
+    enqueue_stream(stream);
+    return stream;
+}
+
+void Http2Connection::adopt_stream(NonnullRefPtr<Http2Stream> stream)
+{
+    stream->m_connection = make_weak_ptr<Http2Connection>();
+    stream->m_id = 0;
+    stream->m_state = Http2Stream::State::Queued;
+    stream->m_has_received_final_headers = false;
+    stream->m_body_bytes_sent = 0;
+    stream->m_unacknowledged_received_bytes = 0;
+
+    if (!can_open_streams()) {
+        stream->m_state = Http2Stream::State::Closed;
+        deferred_invoke([stream] {
+            if (stream->on_finish)
+                stream->on_finish(false);
+        });
+        return;
+    }
+
+    enqueue_stream(move(stream));
+}
+
+void Http2Connection::enqueue_stream(NonnullRefPtr<Http2Stream> stream)
+{
+    m_queued_streams.enqueue(move(stream));
+    start_queued_streams();
+    update_idle_timer();
+}
+
+void Http2Connection::start_queued_streams()
+{
+    auto max_concurrent_streams = m_has_received_settings ? m_remote_settings.max_concurrent_streams : assumed_max_concurrent_streams;
+    while (!m_is_closed && !m_queued_streams.is_empty() && m_streams.size() < max_concurrent_streams && m_next_stream_id <= maximum_stream_id) {
+        auto stream = m_queued_streams.dequeue();
+        // Streams that were cancelled while waiting stay in the queue until now.
+        if (stream->m_state != Http2Stream::State::Queued)
+            continue;
+        start_stream(*stream);
+    }
+}
+
+// https://www.rfc-editor.org/rfc/rfc9113#section-8.3.1
+void Http2Connection::start_stream(Http2Stream& stream)
+{
+    stream.m_id = m_next_stream_id;
+    m_next_stream_id += 2;
+    ++m_streams_opened;
+    stream.m_send_window = m_remote_settings.initial_window_size;
+    stream.m_receive_window = local_stream_window_size;
+    m_streams.set(stream.m_id, stream);
+
+    auto const& request = stream.m_request;
+    auto const& url = request.url();
+
+    StringBuilder path_builder;
+    path_builder.append(URL::percent_encode(url.serialize_path(), URL::PercentEncodeSet::EncodeURI));
+    if (url.query().has_value())
+        path_builder.appendff("?{}", *url.query());
+
+    auto authority = url.serialized_host().release_value_but_fixme_should_propagate_errors().to_byte_string();
+    if (url.port().has_value())
+        authority = ByteString::formatted("{}:{}", authority, *url.port());
+
+    Vector<HPack::Header> headers;
+    headers.append({ ":method", request.method_name() });
+    headers.append({ ":scheme", url.scheme().to_byte_string() });
+    headers.append({ ":authority", move(authority) });
+    headers.append({ ":path", path_builder.to_byte_string() });
+
+    bool has_content_length = false;
+    for (auto const& header : request.headers()) {
+        auto name = header.name.to_lowercase();
+        // Connection-specific headers are not allowed in HTTP/2, see RFC 9113, 8.2.2.
+        if (name.is_one_of("connection"sv, "keep-alive"sv, "proxy-connection"sv, "transfer-encoding"sv, "upgrade"sv, "host"sv))
+            continue;
+        if (name == "te"sv && !header.value.equals_ignoring_ascii_case("trailers"sv))
+            continue;
+        if (name == "content-length"sv)
+            has_content_length = true;
+        headers.append({ move(name), header.value });
+    }
+
+    bool has_body = !request.body().is_empty();
+    if (!has_content_length && (has_body || request.method() == HttpRequest::Method::POST))
+        headers.append({ "content-length", ByteString::number(request.body().size()) });
+
+    auto header_block_or_error = m_encoder.encode(headers);
+    if (header_block_or_error.is_error()) {
+        dbgln("Http2Connection: Failed to encode the request headers: {}", header_block_or_error.error());
+        // The encoder state can't be trusted anymore.
+        return close(Http2ErrorCode::InternalError);
+    }
+    auto encoded_headers = header_block_or_error.release_value();
+    auto header_block = encoded_headers.bytes();
+
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Starting stream {} for {}", stream.m_id, url);
+
+    // Header blocks larger than a frame continue in CONTINUATION frames, see RFC 9113, 6.10.
+    u8 flags = has_body ? 0 : EndStream;
+    auto frame_type = FrameType::Headers;
+    do {
+        auto fragment = header_block.slice(0, min(header_block.size(), m_remote_settings.max_frame_size));
+        header_block = header_block.slice(fragment.size());
+        if (header_block.is_empty())
+            flags |= EndHeaders;
+        send_frame(frame_type, flags, stream.m_id, fragment);
+        frame_type = FrameType::Continuation;
+        flags = 0;
+    } while (!header_block.is_empty());
+
+    stream.m_state = has_body ? Http2Stream::State::Open : Http2Stream::State::HalfClosedLocal;
+    send_request_body(stream);
+}
+
+void Http2Connection::send_request_body(Http2Stream& stream)
+{
+    if (stream.m_state != Http2Stream::State::Open)
+        return;
+
+    auto body = stream.m_request.body().bytes();
+    while (stream.m_body_bytes_sent < body.size()) {
+        auto window = min(m_send_window, stream.m_send_window);
+        if (window <= 0)
+            return;
+
+        auto size = min(min(static_cast<size_t>(window), static_cast<size_t>(m_remote_settings.max_frame_size)), body.size() - stream.m_body_bytes_sent);
+        bool is_last = stream.m_body_bytes_sent + size == body.size();
+        send_frame(FrameType::Data, is_last ? EndStream : 0, stream.m_id, body.slice(stream.m_body_bytes_sent, size));
+
+        stream.m_body_bytes_sent += size;
+        stream.m_send_window -= size;
+        m_send_window -= size;
+    }
+    stream.m_state = Http2Stream::State::HalfClosedLocal;
+}
+
+// https://www.rfc-editor.org/rfc/rfc9113#section-4.1
+void Http2Connection::send_frame(FrameType type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (m_is_closed)
+        return;
+
+    u8 header[frame_header_size];
+    header[0] = payload.size() >> 16;
+    header[1] = payload.size() >> 8;
+    header[2] = payload.size();
+    header[3] = to_underlying(type);
+    header[4] = flags;
+    write_u32({ header + 5, 4 }, stream_id);
+    m_send_buffer.append(header, sizeof(header));
+    m_send_buffer.append(payload);
+
+    // Everything sent while handling one batch of frames goes out together, which saves a lot of TLS records.
+    if (!m_has_scheduled_flush) {
+        m_has_scheduled_flush = true;
+        deferred_invoke([this] { flush(); });
+    }
+}
+
+void Http2Connection::send_window_update(u32 stream_id, u32 increment)
+{
+    u8 payload[4];
+    write_u32({ payload, 4 }, increment);
+    send_frame(FrameType::WindowUpdate, 0, stream_id, { payload, 4 });
+}
+
+void Http2Connection::send_rst_stream(u32 stream_id, Http2ErrorCode error_code)
+{
+    u8 payload[4];
+    write_u32({ payload, 4 }, to_underlying(error_code));
+    send_frame(FrameType::RstStream, 0, stream_id, { payload, 4 });
+}
+
+void Http2Connection::flush()
+{
+    m_has_scheduled_flush = false;
+    if (m_is_closed || m_send_buffer.is_empty())
+        return;
+
+    auto result = m_socket->write_until_depleted(m_send_buffer);
+    m_send_buffer.clear();
+    if (result.is_error()) {
+        dbgln("Http2Connection: Failed to write to the socket: {}", result.error());
+        did_close();
+    }
+}
+
+void Http2Connection::read_from_socket()
+{
+    // The callbacks of finished streams may drop the last reference to the connection.
+    NonnullRefPtr protect = *this;
+
+    while (!m_is_closed) {
+        u8 buffer[16 * KiB];
+        auto result = m_socket->read_some({ buffer, sizeof(buffer) });
+        if (result.is_error()) {
+            if (result.error().is_errno() && result.error().code() == EINTR)
+                continue;
+            if (result.error().is_errno() && result.error().code() == EAGAIN)
+                break;
+            dbgln("Http2Connection: Failed to read from the socket: {}", result.error());
+            return did_close();
+        }
+        if (result.value().is_empty())
+            break;
+        m_receive_buffer.append(result.value());
+    }
+
+    process_received_frames();
+
+    if (!m_is_closed && m_socket->is_eof()) {
+        dbgln_if(HTTP2_DEBUG, "Http2Connection: The server closed the connection");
+        did_close();
+    }
+}
+
+void Http2Connection::process_received_frames()
+{
+    size_t offset = 0;
+    while (!m_is_closed) {
+        auto data = m_receive_buffer.bytes().slice(offset);
+        if (data.size() < frame_header_size)
+            break;
+
+        // We never allow frames larger than the default.
+        u32 length = (data[0] << 16) | (data[1] << 8) | data[2];
+        if (length > default_max_frame_size)
+            return close(Http2ErrorCode::FrameSizeError);
+        if (data.size() < frame_header_size + length)
+            break;
+
+        Frame frame {
+            .type = static_cast<FrameType>(data[3]),
+            .flags = data[4],
+            .stream_id = read_u32(data.slice(5)) & maximum_stream_id,
+            .payload = data.slice(frame_header_size, length),
+        };
+        offset += frame_header_size + length;
+
+        dbgln_if(HTTP2_DEBUG, "Http2Connection: Received frame of type {} with flags {:#x} and length {} for stream {}", to_underlying(frame.type), frame.flags, length, frame.stream_id);
+        if (auto result = handle_frame(frame); result.is_error()) {
+            dbgln("Http2Connection: Connection error {} in a frame of type {}", to_underlying(result.error()), to_underlying(frame.type));
+            return close(result.error());
+        }
+    }
+
+    if (m_is_closed || offset == 0)
+        return;
+    auto remaining = m_receive_buffer.size() - offset;
+    if (remaining > 0)
+        memmove(m_receive_buffer.data(), m_receive_buffer.data() + offset, remaining);
+    m_receive_buffer.resize(remaining);
+}
+
+ErrorOr<void, Http2ErrorCode> Http2Connection::handle_frame(Frame const& frame)
+{
+    // The server's connection preface is a SETTINGS frame, see RFC 9113, 3.4.
+    if (!m_has_received_settings && frame.type != FrameType::Settings)
+        return Http2ErrorCode::ProtocolError;
+
+    // Nothing may come between the frames of a header block, see RFC 9113, 6.2.
+    if (m_header_block.has_value() && frame.type != FrameType::Continuation)
+        return Http2ErrorCode::ProtocolError;
+
+    switch (frame.type) {
+    case FrameType::Data:
+        return handle_data_frame(frame);
+    case FrameType::Headers:
+        return handle_headers_frame(frame);
+    case FrameType::Priority:
+        // We don't do anything with priorities the server might want us to use.
+        return {};
+    case FrameType::RstStream:
+        return handle_rst_stream_frame(frame);
+    case FrameType::Settings:
+        return handle_settings_frame(frame);
+    case FrameType::PushPromise:
+        // We disabled server push in our SETTINGS.
+        return Http2ErrorCode::ProtocolError;
+    case FrameType::Ping:
+        return handle_ping_frame(frame);
+    case FrameType::GoAway:
+        return handle_goaway_frame(frame);
+    case FrameType::WindowUpdate:
+        return handle_window_update_frame(frame);
+    case FrameType::Continuation:
+        return handle_continuation_frame(frame);
+    }
+
+    // Frames of unknown types are ignored, see RFC 9113, 4.1.
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc9113#section-6.1
+ErrorOr<void, Http2ErrorCode> Http2Connection::handle_data_frame(Frame const& frame)
+{
+    if (frame.stream_id == 0 || frame.stream_id >= m_next_stream_id)
+        return Http2ErrorCode::ProtocolError;
+
+    // All of the payload counts against the flow control windows, including the padding.
+    auto length = frame.payload.size();
+    if (static_cast<i64>(length) > m_receive_window)
+        return Http2ErrorCode::FlowControlError;
+    m_receive_window -= length;
+
+    auto data = TRY(remove_padding(frame.payload, frame.flags & Padded));
+
+    auto it = m_streams.find(frame.stream_id);
+    if (it == m_streams.end()) {
+        // Frames for streams we reset can still be on their way.
+        did_receive_data(nullptr, length);
+        return {};
+    }
+
+    NonnullRefPtr stream = it->value;
+    if (static_cast<i64>(length) > stream->m_receive_window) {
+        did_receive_data(nullptr, length);
+        reset_stream(*stream, Http2ErrorCode::FlowControlError);
+        return {};
+    }
+    stream->m_receive_window -= length;
+    did_receive_data(stream.ptr(), length);
+
+    if (!stream->m_has_received_final_headers) {
+        reset_stream(*stream, Http2ErrorCode::ProtocolError);
+        return {};
+    }
+
+    if (!data.is_empty() && stream->on_data_received)
+        stream->on_data_received(data);
+
+    if ((frame.flags & EndStream) && stream->m_state != Http2Stream::State::Closed)
+        did_receive_end_of_stream(*stream);
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc9113#section-6.2
+ErrorOr<void, Http2ErrorCode> Http2Connection::handle_headers_frame(Frame const& frame)
+{
+    if (frame.stream_id == 0)
+        return Http2ErrorCode::ProtocolError;
+
+    auto payload = TRY(remove_padding(frame.payload, frame.flags & Padded));
+    if (frame.flags & Priority) {
+        if (payload.size() < 5)
+            return Http2ErrorCode::FrameSizeError;
+        payload = payload.slice(5);
+    }
+
+    auto data = ByteBuffer::copy(payload);
+    if (data.is_error())
+        return Http2ErrorCode::InternalError;
+    m_header_block = HeaderBlock { frame.stream_id, (frame.flags & EndStream) != 0, data.release_value() };
+
+    if (frame.flags & EndHeaders)
+        return handle_header_block();
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc9113#section-6.10
+ErrorOr<void, Http2ErrorCode> Http2Connection::handle_continuation_frame(Frame const& frame)
+{
+    if (!m_header_block.has_value() || m_header_block->stream_id != frame.stream_id)
+        return Http2ErrorCode::ProtocolError;
+
+    if (m_header_block->data.size() + frame.payload.size() > maximum_header_block_size)
+        return Http2ErrorCode::EnhanceYourCalm;
+    if (m_header_block->data.try_append(frame.payload).is_error())
+        return Http2ErrorCode::InternalError;
+
+    if (frame.flags & EndHeaders)
+        return handle_header_block();
+    return {};
+}
+
+ErrorOr<void, Http2ErrorCode> Http2Connection::handle_header_block()
+{
+    auto block = m_header_block.release_value();
+
+    // Header blocks have to be decoded even for streams we don't care about anymore, to keep the dynamic table in sync.
+    auto headers_or_error = m_decoder.decode(block.data);
+    if (headers_or_error.is_error()) {
+        dbgln("Http2Connection: Failed to decode a header block: {}", headers_or_error.error());
+        return Http2ErrorCode::CompressionError;
+    }
+    auto headers = headers_or_error.release_value();
+
+    auto it = m_streams.find(block.stream_id);
+    if (it == m_streams.end()) {
+        // Only we open streams, as server push is disabled.
+        if (block.stream_id % 2 == 0 || block.stream_id >= m_next_stream_id)
+            return Http2ErrorCode::ProtocolError;
+        return {};
+    }
+    NonnullRefPtr stream = it->value;
+
+    // https://www.rfc-editor.org/rfc/rfc9113#section-8.3.2
+    Optional<u32> status_code;
+    Vector<HPack::Header> regular_headers;
+    bool is_malformed = false;
+    for (auto& header : headers) {
+        if (!header.name.starts_with(':')) {
+            regular_headers.append(move(header));
+            continue;
+        }
+        // Pseudo-headers come first, and responses have exactly one of them.
+        if (header.name != ":status"sv || status_code.has_value() || !regular_headers.is_empty() || stream->m_has_received_final_headers) {
+            is_malformed = true;
+            break;
+        }
+        status_code = header.value.to_number<u32>();
+        if (!status_code.has_value() || *status_code < 100 || *status_code > 999)
+            is_malformed = true;
+    }
+
+    if (!stream->m_has_received_final_headers) {
+        if (is_malformed || !status_code.has_value()) {
+            reset_stream(*stream, Http2ErrorCode::ProtocolError);
+            return {};
+        }
+        // Informational responses are followed by the final one, see RFC 9113, 8.1.
+        if (*status_code < 200) {
+            if (block.ends_stream)
+                reset_stream(*stream, Http2ErrorCode::ProtocolError);
+            return {};
+        }
+        stream->m_has_received_final_headers = true;
+        if (stream->on_headers_received)
+            stream->on_headers_received(*status_code, regular_headers);
+    } else {
+        // A second header block carries the trailers, which have to end the stream.
+        if (is_malformed || !block.ends_stream) {
+            reset_stream(*stream, Http2ErrorCode::ProtocolError);
+            return {};
+        }
+        if (stream->on_trailers_received)
+            stream->on_trailers_received(regular_headers);
+    }
+
+    if (block.ends_stream && stream->m_state != Http2Stream::State::Closed)
+        did_receive_end_of_stream(*stream);
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc9113#section-6.4
+ErrorOr<void, Http2ErrorCode> Http2Connection::handle_rst_stream_frame(Frame const& frame)
+{
+    if (frame.stream_id == 0 || frame.stream_id >= m_next_stream_id)
+        return Http2ErrorCode::ProtocolError;
+    if (frame.payload.size() != 4)
+        return Http2ErrorCode::FrameSizeError;
+
+    auto it = m_streams.find(frame.stream_id);
+    if (it == m_streams.end())
+        return {};
+
+    NonnullRefPtr stream = it->value;
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Server reset stream {} with error {}", frame.stream_id, read_u32(frame.payload));
+    finish_stream(*stream, false);
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc9113#section-6.5
+ErrorOr<void, Http2ErrorCode> Http2Connection::handle_settings_frame(Frame const& frame)
+{
+    if (frame.stream_id != 0)
+        return Http2ErrorCode::ProtocolError;
+
+    if (frame.flags & Ack) {
+        if (!frame.payload.is_empty())
+            return Http2ErrorCode::FrameSizeError;
+        return {};
+    }
+
+    if (frame.payload.size() % 6 != 0)
+        return Http2ErrorCode::FrameSizeError;
+
+    for (size_t offset = 0; offset < frame.payload.size(); offset += 6) {
+        auto parameter = static_cast<SettingsParameter>((frame.payload[offset] << 8) | frame.payload[offset + 1]);
+        auto value = read_u32(frame.payload.slice(offset + 2));
+        dbgln_if(HTTP2_DEBUG, "Http2Connection: Server setting {} = {}", to_underlying(parameter), value);
+
+        switch (parameter) {
+        case SettingsParameter::HeaderTableSize:
+            m_encoder.set_max_table_size(value);
+            break;
+        case SettingsParameter::EnablePush:
+            // Servers can't push anything to us, see RFC 9113, 6.5.2.
+            if (value != 0)
+                return Http2ErrorCode::ProtocolError;
+            break;
+        case SettingsParameter::MaxConcurrentStreams:
+            m_remote_settings.max_concurrent_streams = value;
+            break;
+        case SettingsParameter::InitialWindowSize: {
+            if (value > maximum_window_size)
+                return Http2ErrorCode::FlowControlError;
+            // The change applies to the windows of all open streams, see RFC 9113, 6.9.2.
+            i64 delta = static_cast<i64>(value) - m_remote_settings.initial_window_size;
+            for (auto& it : m_streams) {
+                it.value->m_send_window += delta;
+                if (it.value->m_send_window > maximum_window_size)
+                    return Http2ErrorCode::FlowControlError;
+            }
+            m_remote_settings.initial_window_size = value;
+            break;
+        }
+        case SettingsParameter::MaxFrameSize:
+            if (value < default_max_frame_size || value > 0xffffff)
+                return Http2ErrorCode::ProtocolError;
+            m_remote_settings.max_frame_size = value;
+            break;
+        case SettingsParameter::MaxHeaderListSize:
+        default:
+            break;
+        }
+    }
+
+    m_has_received_settings = true;
+    send_frame(FrameType::Settings, Ack, 0, {});
+
+    start_queued_streams();
+    for (auto& it : m_streams)
+        send_request_body(*it.value);
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc9113#section-6.7
+ErrorOr<void, Http2ErrorCode> Http2Connection::handle_ping_frame(Frame const& frame)
+{
+    if (frame.stream_id != 0)
+        return Http2ErrorCode::ProtocolError;
+    if (frame.payload.size() != 8)
+        return Http2ErrorCode::FrameSizeError;
+
+    if (!(frame.flags & Ack))
+        send_frame(FrameType::Ping, Ack, 0, frame.payload);
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc9113#section-6.8
+ErrorOr<void, Http2ErrorCode> Http2Connection::handle_goaway_frame(Frame const& frame)
+{
+    if (frame.stream_id != 0)
+        return Http2ErrorCode::ProtocolError;
+    if (frame.payload.size() < 8)
+        return Http2ErrorCode::FrameSizeError;
+
+    auto last_stream_id = read_u32(frame.payload) & maximum_stream_id;
+    auto error_code = read_u32(frame.payload.slice(4));
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Server is going away after stream {} with error {}", last_stream_id, error_code);
+    m_is_going_away = true;
+
+    // Streams after the last one were not processed at all, and can be safely retried elsewhere, as can the ones we
+    // haven't started yet.
+    Vector<NonnullRefPtr<Http2Stream>> unprocessed_streams;
+    for (auto& it : m_streams) {
+        if (it.key > last_stream_id)
+            unprocessed_streams.append(it.value);
+    }
+    for (auto& stream : unprocessed_streams)
+        m_streams.remove(stream->m_id);
+    while (!m_queued_streams.is_empty()) {
+        auto stream = m_queued_streams.dequeue();
+        // Streams that were cancelled while waiting stay in the queue until now.
+        if (stream->m_state == Http2Stream::State::Queued)
+            unprocessed_streams.append(move(stream));
+    }
+
+    RefPtr<Http2Connection> retry_connection;
+    if (!unprocessed_streams.is_empty() && find_connection_for_retry)
+        retry_connection = find_connection_for_retry();
+    if (retry_connection == this || (retry_connection && !retry_connection->can_open_streams()))
+        retry_connection = nullptr;
+
+    for (auto& stream : unprocessed_streams) {
+        if (retry_connection && !stream->m_was_retried) {
+            dbgln_if(HTTP2_DEBUG, "Http2Connection: Retrying stream {} on connection {}", stream->m_id, retry_connection.ptr());
+            stream->m_was_retried = true;
+            retry_connection->adopt_stream(stream);
+            continue;
+        }
+        finish_stream(*stream, false);
+    }
+
+    if (m_streams.is_empty())
+        close();
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc9113#section-6.9
+ErrorOr<void, Http2ErrorCode> Http2Connection::handle_window_update_frame(Frame const& frame)
+{
+    if (frame.payload.size() != 4)
+        return Http2ErrorCode::FrameSizeError;
+
+    auto increment = read_u32(frame.payload) & maximum_window_size;
+    if (frame.stream_id == 0) {
+        if (increment == 0)
+            return Http2ErrorCode::ProtocolError;
+        m_send_window += increment;
+        if (m_send_window > maximum_window_size)
+            return Http2ErrorCode::FlowControlError;
+        for (auto& it : m_streams)
+            send_request_body(*it.value);
+        return {};
+    }
+
+    auto it = m_streams.find(frame.stream_id);
+    if (it == m_streams.end())
+        return {};
+
+    NonnullRefPtr stream = it->value;
+    if (increment == 0) {
+        reset_stream(*stream, Http2ErrorCode::ProtocolError);
+        return {};
+    }
+    stream->m_send_window += increment;
+    if (stream->m_send_window > maximum_window_size) {
+        reset_stream(*stream, Http2ErrorCode::FlowControlError);
+        return {};
+    }
+    send_request_body(*stream);
+    return {};
+}
+
+// The data is handed to the stream right away, so the windows open up again as soon as it arrives. Updates are only
+// sent once half of a window is used up, to keep their number down.
+void Http2Connection::did_receive_data(Http2Stream* stream, size_t flow_controlled_length)
+{
+    m_unacknowledged_received_bytes += flow_controlled_length;
+    if (m_unacknowledged_received_bytes >= local_connection_window_size / 2) {
+        send_window_update(0, m_unacknowledged_received_bytes);
+        m_receive_window += m_unacknowledged_received_bytes;
+        m_unacknowledged_received_bytes = 0;
+    }
+
+    if (!stream)
+        return;
+    stream->m_unacknowledged_received_bytes += flow_controlled_length;
+    if (stream->m_unacknowledged_received_bytes >= local_stream_window_size / 2) {
+        send_window_update(stream->m_id, stream->m_unacknowledged_received_bytes);
+        stream->m_receive_window += stream->m_unacknowledged_received_bytes;
+        stream->m_unacknowledged_received_bytes = 0;
+    }
+}
+
+void Http2Connection::did_receive_end_of_stream(Http2Stream& stream)
+{
+    // A server may respond before it has seen the whole request, which we then stop sending, see RFC 9113, 8.1.
+    if (stream.m_state == Http2Stream::State::Open)
+        send_rst_stream(stream.m_id, Http2ErrorCode::Cancel);
+    finish_stream(stream, true);
+}
+
+void Http2Connection::reset_stream(Http2Stream& stream, Http2ErrorCode error_code)
+{
+    if (stream.m_state != Http2Stream::State::Queued && stream.m_state != Http2Stream::State::Closed)
+        send_rst_stream(stream.m_id, error_code);
+    finish_stream(stream, false);
+}
+
+void Http2Connection::finish_stream(Http2Stream& stream, bool success)
+{
+    if (stream.m_state == Http2Stream::State::Closed)
+        return;
+
+    NonnullRefPtr protect = stream;
+    bool was_started = stream.m_state != Http2Stream::State::Queued;
+    stream.m_state = Http2Stream::State::Closed;
+    if (was_started)
+        remove_stream(stream);
+
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Stream {} finished, success={}", stream.m_id, success);
+    if (stream.on_finish)
+        stream.on_finish(success);
+}
+
+void Http2Connection::remove_stream(Http2Stream& stream)
+{
+    m_streams.remove(stream.m_id);
+    if (m_is_closed)
+        return;
+
+    if (m_is_going_away && m_streams.is_empty())
+        return close();
+
+    start_queued_streams();
+    update_idle_timer();
+}
+
+void Http2Connection::set_idle_timeout(int milliseconds)
+{
+    m_idle_timeout_milliseconds = milliseconds;
+    update_idle_timer();
+}
+
+void Http2Connection::update_idle_timer()
+{
+    if (m_idle_timeout_milliseconds == 0 || m_is_closed)
+        return;
+
+    bool is_idle = m_streams.is_empty() && m_queued_streams.is_empty();
+    if (is_idle && !has_timer())
+        start_timer(m_idle_timeout_milliseconds);
+    else if (!is_idle && has_timer())
+        stop_timer();
+}
+
+void Http2Connection::timer_event(Core::TimerEvent& event)
+{
+    event.accept();
+    stop_timer();
+    if (m_streams.is_empty() && m_queued_streams.is_empty()) {
+        dbgln_if(HTTP2_DEBUG, "Http2Connection: Closing idle connection");
+        close();
+    }
+}
+
+void Http2Connection::close(Http2ErrorCode error_code)
+{
+    if (m_is_closed)
+        return;
+
+    // We never accept streams from the server, so the last one we processed is always 0.
+    u8 payload[8];
+    write_u32({ payload, 4 }, 0);
+    write_u32({ payload + 4, 4 }, to_underlying(error_code));
+    send_frame(FrameType::GoAway, 0, 0, { payload, sizeof(payload) });
+    flush();
+
+    did_close();
+}
+
+void Http2Connection::did_close()
+{
+    if (m_is_closed)
+        return;
+
+    NonnullRefPtr protect = *this;
+    m_is_closed = true;
+    if (has_timer())
+        stop_timer();
+    m_socket->on_ready_to_read = nullptr;
+    m_socket->close();
+
+    Vector<NonnullRefPtr<Http2Stream>> streams;
+    for (auto& it : m_streams)
+        streams.append(it.value);
+    while (!m_queued_streams.is_empty())
+        streams.append(m_queued_streams.dequeue());
+    for (auto& stream : streams)
+        finish_stream(*stream, false);
+
+    if (on_close)
+        on_close();
+}
+
+}
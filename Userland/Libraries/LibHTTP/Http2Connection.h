@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Queue.h>
+#include <AK/RefCounted.h>
+#include <AK/WeakPtr.h>
+#include <LibCore/EventReceiver.h>
+#include <LibCore/Socket.h>
+#include <LibHTTP/HPack.h>
+#include <LibHTTP/HttpRequest.h>
+
+// HTTP/2, as a client.
+// https://www.rfc-editor.org/rfc/rfc9113
+namespace HTTP {
+
+class Http2Connection;
+
+// https://www.rfc-editor.org/rfc/rfc9113#section-7
+enum class Http2ErrorCode : u32 {
+    NoError = 0x0,
+    ProtocolError = 0x1,
+    InternalError = 0x2,
+    FlowControlError = 0x3,
+    SettingsTimeout = 0x4,
+    StreamClosed = 0x5,
+    FrameSizeError = 0x6,
+    RefusedStream = 0x7,
+    Cancel = 0x8,
+    CompressionError = 0x9,
+    ConnectError = 0xa,
+    EnhanceYourCalm = 0xb,
+    InadequateSecurity = 0xc,
+    Http11Required = 0xd,
+};
+
+// One request and its response. Streams are handed out by Http2Connection::open_stream(), and stay queued until the
+// server allows another concurrent stream.
+class Http2Stream : public RefCounted<Http2Stream> {
+public:
+    // Called once, for the final (non-1xx) response.
+    Function<void(u32 status_code, Vector<HPack::Header> const&)> on_headers_received;
+    Function<void(Vector<HPack::Header> const&)> on_trailers_received;
+    Function<void(ReadonlyBytes)> on_data_received;
+    // Called once the whole response has arrived, or the stream failed.
+    Function<void(bool success)> on_finish;
+
+    u32 id() const { return m_id; }
+    bool is_finished() const { return m_state == State::Closed; }
+
+    // Resets the stream, without calling any of the callbacks.
+    void cancel();
+
+private:
+    friend class Http2Connection;
+
+    // https://www.rfc-editor.org/rfc/rfc9113#section-5.1
+    enum class State {
+        Queued,
+        Open,
+        HalfClosedLocal,
+        Closed,
+    };
+
+    Http2Stream(Http2Connection&, HttpRequest);
+
+    WeakPtr<Http2Connection> m_connection;
+    HttpRequest m_request;
+    u32 m_id { 0 };
+    State m_state { State::Queued };
+    bool m_has_received_final_headers { false };
+    bool m_was_retried { false };
+
+    // The rest of the request body waits for the flow control windows to open up.
+    size_t m_body_bytes_sent { 0 };
+
+    i64 m_send_window { 0 };
+    i64 m_receive_window { 0 };
+    size_t m_unacknowledged_received_bytes { 0 };
+};
+
+class Http2Connection final : public Core::EventReceiver {
+    C_OBJECT(Http2Connection)
+public:
+    // Created with an already connected, non-blocking socket. For TLS connections, it must have negotiated "h2" through
+    // ALPN, otherwise the server has to be known to speak HTTP/2 (RFC 9113, 3.3).
+    virtual ~Http2Connection() override;
+
+    NonnullRefPtr<Http2Stream> open_stream(HttpRequest);
+
+    // Takes over a stream that another connection couldn't complete, keeping its callbacks.
+    void adopt_stream(NonnullRefPtr<Http2Stream>);
+
+    // Whether new streams can be opened, i.e. the connection is still alive and the server isn't shutting it down.
+    bool can_open_streams() const { return !m_is_closed && !m_is_going_away && m_next_stream_id <= maximum_stream_id; }
+
+    size_t active_stream_count() const { return m_streams.size(); }
+    size_t queued_stream_count() const { return m_queued_streams.size(); }
+    size_t streams_opened() const { return m_streams_opened; }
+
+    // Closes the connection after it had no streams for the given time. Disabled by default.
+    void set_idle_timeout(int milliseconds);
+
+    // Sends a GOAWAY and closes the socket, failing all streams.
+    void close(Http2ErrorCode = Http2ErrorCode::NoError);
+
+    Function<void()> on_close;
+
+    // Called when a GOAWAY says that the server never processed some of our streams, to find another connection to
+    // retry them on (RFC 9113, 8.7). They fail if there is none, and are only retried once.
+    Function<RefPtr<Http2Connection>()> find_connection_for_retry;
+
+private:
+    friend class Http2Stream;
+
+    // https://www.rfc-editor.org/rfc/rfc9113#section-6
+    enum class FrameType : u8 {
+        Data = 0x0,
+        Headers = 0x1,
+        Priority = 0x2,
+        RstStream = 0x3,
+        Settings = 0x4,
+        PushPromise = 0x5,
+        Ping = 0x6,
+        GoAway = 0x7,
+        WindowUpdate = 0x8,
+        Continuation = 0x9,
+    };
+
+    enum FrameFlags : u8 {
+        EndStream = 0x1,
+        Ack = 0x1,
+        EndHeaders = 0x4,
+        Padded = 0x8,
+        Priority = 0x20,
+    };
+
+    // https://www.rfc-editor.org/rfc/rfc9113#section-6.5.2
+    enum class SettingsParameter : u16 {
+        HeaderTableSize = 0x1,
+        EnablePush = 0x2,
+        MaxConcurrentStreams = 0x3,
+        InitialWindowSize = 0x4,
+        MaxFrameSize = 0x5,
+        MaxHeaderListSize = 0x6,
+    };
+
+    struct Settings {
+        u32 max_concurrent_streams { NumericLimits<u32>::max() };
+        u32 initial_window_size { default_window_size };
+        u32 max_frame_size { default_max_frame_size };
+    };
+
+    struct Frame {
+        FrameType type;
+        u8 flags;
+        u32 stream_id;
+        ReadonlyBytes payload;
+    };
+
+    static constexpr u32 default_window_size = 65535;
+    static constexpr u32 maximum_window_size = 0x7fffffff;
+    static constexpr u32 default_max_frame_size = 16384;
+    static constexpr u32 maximum_stream_id = 0x7fffffff;
+    static constexpr size_t frame_header_size = 9;
+
+    // We advertise much bigger windows than the default, so that a single stream can keep a fast connection busy.
+    static constexpr u32 local_stream_window_size = 4 * MiB;
+    static constexpr u32 local_connection_window_size = 16 * MiB;
+    static constexpr size_t maximum_header_block_size = 256 * KiB;
+
+    explicit Http2Connection(NonnullOwnPtr<Core::Socket>);
+
+    virtual void timer_event(Core::TimerEvent&) override;
+
+    void send_connection_preface();
+    void enqueue_stream(NonnullRefPtr<Http2Stream>);
+    void start_queued_streams();
+    void start_stream(Http2Stream&);
+    void send_request_body(Http2Stream&);
+    void send_frame(FrameType, u8 flags, u32 stream_id, ReadonlyBytes payload);
+    void send_window_update(u32 stream_id, u32 increment);
+    void send_rst_stream(u32 stream_id, Http2ErrorCode);
+    void flush();
+
+    void read_from_socket();
+    void process_received_frames();
+    ErrorOr<void, Http2ErrorCode> handle_frame(Frame const&);
+    ErrorOr<void, Http2ErrorCode> handle_data_frame(Frame const&);
+    ErrorOr<void, Http2ErrorCode> handle_headers_frame(Frame const&);
+    ErrorOr<void, Http2ErrorCode> handle_continuation_frame(Frame const&);
+    ErrorOr<void, Http2ErrorCode> handle_header_block();
+    ErrorOr<void, Http2ErrorCode> handle_rst_stream_frame(Frame const&);
+    ErrorOr<void, Http2ErrorCode> handle_settings_frame(Frame const&);
+    ErrorOr<void, Http2ErrorCode> handle_ping_frame(Frame const&);
+    ErrorOr<void, Http2ErrorCode> handle_goaway_frame(Frame const&);
+    ErrorOr<void, Http2ErrorCode> handle_window_update_frame(Frame const&);
+
+    void did_receive_data(Http2Stream*, size_t flow_controlled_length);
+    void did_receive_end_of_stream(Http2Stream&);
+    void reset_stream(Http2Stream&, Http2ErrorCode);
+    void finish_stream(Http2Stream&, bool success);
+    void remove_stream(Http2Stream&);
+    void update_idle_timer();
+    void did_close();
+
+    NonnullOwnPtr<Core::Socket> m_socket;
+    HPack::Encoder m_encoder;
+    HPack::Decoder m_decoder;
+
+    Settings m_remote_settings;
+    bool m_has_received_settings { false };
+
+    HashMap<u32, NonnullRefPtr<Http2Stream>> m_streams;
+    Queue<NonnullRefPtr<Http2Stream>> m_queued_streams;
+    u32 m_next_stream_id { 1 };
+    size_t m_streams_opened { 0 };
+
+    i64 m_send_window { default_window_size };
+    i64 m_receive_window { local_connection_window_size };
+    size_t m_unacknowledged_received_bytes { 0 };
+
+    ByteBuffer m_receive_buffer;
+    ByteBuffer m_send_buffer;
+    bool m_has_scheduled_flush { false };
+
+    // A HEADERS frame without END_HEADERS has to be followed by CONTINUATION frames for the same stream, and nothing else.
+    struct HeaderBlock {
+        u32 stream_id { 0 };
+        bool ends_stream { false };
+        ByteBuffer data;
+    };
+    Optional<HeaderBlock> m_header_block;
+
+    int m_idle_timeout_milliseconds { 0 };
+    bool m_is_going_away { false };
+    bool m_is_closed { false };
+};
+
+}
@@ -153,7 +153,14 @@ ErrorOr<HttpRequest, HttpRequest::ParseError> HttpRequest::from_raw_request(Read
             if (peek(0) == '\r' && peek(1) == '\n') {
                 consume();
                 consume();
-                commit_and_advance_to(protocol, State::InHeaderName);
+                // A request without any headers ends right after the request line.
+                auto next_state = State::InHeaderName;
+                if (peek(0) == '\r' && peek(1) == '\n') {
+                    consume();
+                    consume();
+                    next_state = State::InBody;
+                }
+                commit_and_advance_to(protocol, next_state);
                 break;
             }
             buffer.append(consume());
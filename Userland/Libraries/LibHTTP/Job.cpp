@@ -96,6 +96,12 @@ Job::Job(HttpRequest&& request, Stream& output_stream)
 {
 }
 
+Job::~Job()
+{
+    if (m_http2_stream)
+        m_http2_stream->cancel();
+}
+
 void Job::start(Core::BufferedSocketBase& socket)
 {
     VERIFY(!m_socket);
@@ -107,8 +113,50 @@ void Job::start(Core::BufferedSocketBase& socket)
     });
 }
 
+void Job::start(Http2Connection& connection)
+{
+    VERIFY(!m_socket && !m_http2_stream);
+    dbgln_if(HTTPJOB_DEBUG, "Starting {} on an HTTP/2 connection", url());
+
+    m_http2_stream = connection.open_stream(m_request);
+    m_http2_stream->on_headers_received = [this](u32 status_code, auto const& headers) {
+        m_code = status_code;
+        for (auto const& header : headers)
+            add_received_header(header.name, header.value);
+        did_receive_all_headers();
+        m_state = State::InBody;
+    };
+    m_http2_stream->on_trailers_received = [this](auto const& headers) {
+        for (auto const& header : headers)
+            add_received_header(header.name, header.value);
+    };
+    m_http2_stream->on_data_received = [this](ReadonlyBytes data) {
+        auto buffer = ByteBuffer::copy(data);
+        if (buffer.is_error()) {
+            m_http2_stream->cancel();
+            return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
+        }
+        m_received_buffers.append(make<ReceivedBuffer>(buffer.release_value()));
+        m_buffered_size += data.size();
+        m_received_size += data.size();
+        flush_received_buffers();
+
+        deferred_invoke([this] { did_progress(m_content_length, m_received_size); });
+    };
+    m_http2_stream->on_finish = [this](bool success) {
+        if (!success)
+            return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
+        finish_up();
+    };
+}
+
 void Job::shutdown(ShutdownMode mode)
 {
+    if (m_http2_stream) {
+        // The connection is shared with other jobs, so it stays open either way.
+        m_http2_stream->cancel();
+        return;
+    }
     if (!m_socket)
         return;
     if (mode == ShutdownMode::CloseSocket) {
@@ -173,6 +221,45 @@ void Job::register_on_ready_to_read(Function<void()> callback)
     };
 }
 
+void Job::add_received_header(StringView name, ByteString value)
+{
+    if (name.equals_ignoring_ascii_case("Set-Cookie"sv)) {
+        dbgln_if(JOB_DEBUG, "Job: Received Set-Cookie header: '{}'", value);
+        m_set_cookie_headers.append(move(value));
+        return;
+    }
+
+    if (name.equals_ignoring_ascii_case("Content-Encoding"sv)) {
+        // Assume that any content-encoding means that we can't decode it as a stream :(
+        dbgln_if(JOB_DEBUG, "Content-Encoding {} detected, cannot stream output :(", value);
+        m_can_stream_response = false;
+    } else if (name.equals_ignoring_ascii_case("Content-Length"sv)) {
+        auto length = value.to_number<u64>();
+        if (length.has_value())
+            m_content_length = length.value();
+    }
+    dbgln_if(JOB_DEBUG, "Job: [{}] = '{}'", name, value);
+
+    if (auto existing_value = m_headers.get(name); existing_value.has_value()) {
+        StringBuilder builder;
+        builder.append(existing_value.value());
+        builder.append(',');
+        builder.append(value);
+        m_headers.set(name, builder.to_byte_string());
+    } else {
+        m_headers.set(name, move(value));
+    }
+}
+
+void Job::did_receive_all_headers()
+{
+    if (!on_headers_received)
+        return;
+    if (!m_set_cookie_headers.is_empty())
+        m_headers.set("Set-Cookie", JsonArray { m_set_cookie_headers }.to_byte_string());
+    on_headers_received(m_headers, m_code > 0 ? m_code : Optional<u32> {});
+}
+
 ErrorOr<ByteString> Job::read_line(size_t size)
 {
     auto buffer = TRY(ByteBuffer::create_uninitialized(size));
@@ -302,11 +389,7 @@ void Job::on_socket_connected()
                 if (m_state == State::Trailers) {
                     return finish_up();
                 }
-                if (on_headers_received) {
-                    if (!m_set_cookie_headers.is_empty())
-                        m_headers.set("Set-Cookie", JsonArray { m_set_cookie_headers }.to_byte_string());
-                    on_headers_received(m_headers, m_code > 0 ? m_code : Optional<u32> {});
-                }
+                did_receive_all_headers();
                 m_state = State::InBody;
 
                 // We've reached the end of the headers, there's a possibility that the server
@@ -321,6 +404,9 @@ void Job::on_socket_connected()
                 // As the HTTP spec explicitly prohibits presence of Content-Length when the response code is 204.
                 if (m_code == 204)
                     return finish_up();
+                // Likewise, a 304 (Not Modified) never has a body, whatever its headers say.
+                if (m_code == 304)
+                    return finish_up();
 
                 break;
             }
@@ -347,34 +433,7 @@ void Job::on_socket_connected()
                 return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
             }
             auto value = line.substring(name.length() + 2, line.length() - name.length() - 2);
-            if (name.equals_ignoring_ascii_case("Set-Cookie"sv)) {
-                dbgln_if(JOB_DEBUG, "Job: Received Set-Cookie header: '{}'", value);
-                m_set_cookie_headers.append(move(value));
-
-                auto can_read_without_blocking = m_socket->can_read_without_blocking();
-                if (can_read_without_blocking.is_error())
-                    return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
-                if (!can_read_without_blocking.value())
-                    return;
-            } else if (auto existing_value = m_headers.get(name); existing_value.has_value()) {
-                StringBuilder builder;
-                builder.append(existing_value.value());
-                builder.append(',');
-                builder.append(value);
-                m_headers.set(name, builder.to_byte_string());
-            } else {
-                m_headers.set(name, value);
-            }
-            if (name.equals_ignoring_ascii_case("Content-Encoding"sv)) {
-                // Assume that any content-encoding means that we can't decode it as a stream :(
-                dbgln_if(JOB_DEBUG, "Content-Encoding {} detected, cannot stream output :(", value);
-                m_can_stream_response = false;
-            } else if (name.equals_ignoring_ascii_case("Content-Length"sv)) {
-                auto length = value.to_number<u64>();
-                if (length.has_value())
-                    m_content_length = length.value();
-            }
-            dbgln_if(JOB_DEBUG, "Job: [{}] = '{}'", name, value);
+            add_received_header(name, move(value));
 
             auto can_read_without_blocking = m_socket->can_read_without_blocking();
             if (can_read_without_blocking.is_error())
@@ -10,6 +10,7 @@
 #include <AK/Optional.h>
 #include <LibCore/NetworkJob.h>
 #include <LibCore/Socket.h>
+#include <LibHTTP/Http2Connection.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 
@@ -20,11 +21,15 @@ class Job : public Core::NetworkJob {
 
 public:
     explicit Job(HttpRequest&&, Stream&);
-    virtual ~Job() override = default;
+    virtual ~Job() override;
 
     virtual void start(Core::BufferedSocketBase&) override;
     virtual void shutdown(ShutdownMode) override;
 
+    // Sends the request as a new stream on the connection, instead of on a socket of its own.
+    void start(Http2Connection&);
+    bool uses_http2() const { return m_http2_stream; }
+
     Core::Socket const* socket() const { return m_socket; }
     URL url() const { return m_request.url(); }
 
@@ -36,6 +41,8 @@ protected:
     void on_socket_connected();
     void flush_received_buffers();
     void register_on_ready_to_read(Function<void()>);
+    void add_received_header(StringView name, ByteString value);
+    void did_receive_all_headers();
     ErrorOr<ByteString> read_line(size_t);
     ErrorOr<ByteBuffer> receive(size_t);
     void timer_event(Core::TimerEvent&) override;
@@ -51,6 +58,7 @@ protected:
     HttpRequest m_request;
     State m_state { State::InStatus };
     Core::BufferedSocketBase* m_socket { nullptr };
+    RefPtr<Http2Stream> m_http2_stream;
     bool m_legacy_connection { false };
     int m_code { -1 };
     HashMap<ByteString, ByteString, CaseInsensitiveStringTraits> m_headers;
@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Debug.h>
 #include <LibCore/System.h>
 #include <LibIPC/Connection.h>
 #include <LibIPC/Stub.h>
@@ -22,17 +23,39 @@ struct CoreEventLoopDeferredInvoker final : public DeferredInvoker {
 };
 
 ConnectionBase::ConnectionBase(IPC::Stub& local_stub, NonnullOwnPtr<Core::LocalSocket> socket, u32 local_endpoint_magic)
-    : m_local_stub(local_stub)
+    : m_owner_thread(pthread_self())
+    , m_local_stub(local_stub)
     , m_socket(move(socket))
     , m_local_endpoint_magic(local_endpoint_magic)
     , m_deferred_invoker(make<CoreEventLoopDeferredInvoker>())
 {
     m_responsiveness_timer = Core::Timer::create_single_shot(3000, [this] { may_have_become_unresponsive(); }).release_value_but_fixme_should_propagate_errors();
+
+    if constexpr (IPC_DEBUG) {
+        m_statistics_timer = Core::Timer::create_repeating(1000, [this, last_statistics = Statistics {}]() mutable {
+            if (m_statistics.messages_sent == last_statistics.messages_sent && m_statistics.messages_received == last_statistics.messages_received)
+                return;
+            dbgln("{} ({:p}): Sent {} messages in {} syscalls, received {} messages in {} syscalls in the last second", m_local_stub.name(), this,
+                m_statistics.messages_sent - last_statistics.messages_sent,
+                m_statistics.send_syscalls - last_statistics.send_syscalls,
+                m_statistics.messages_received - last_statistics.messages_received,
+                m_statistics.receive_syscalls - last_statistics.receive_syscalls);
+            last_statistics = m_statistics;
+        }).release_value_but_fixme_should_propagate_errors();
+        m_statistics_timer->start();
+    }
+}
+
+ConnectionBase::~ConnectionBase()
+{
+    // Messages that were posted right before the connection went away should still make it to the peer.
+    (void)flush_posted_messages();
 }
 
 void ConnectionBase::set_deferred_invoker(NonnullOwnPtr<DeferredInvoker> deferred_invoker)
 {
     m_deferred_invoker = move(deferred_invoker);
+    m_has_custom_deferred_invoker = true;
 }
 
 void ConnectionBase::set_fd_passing_socket(NonnullOwnPtr<Core::LocalSocket> socket)
@@ -49,28 +72,89 @@ Core::LocalSocket& ConnectionBase::fd_passing_socket()
 
 ErrorOr<void> ConnectionBase::post_message(Message const& message)
 {
-    return post_message(TRY(message.encode()));
+    Threading::MutexLocker locker(m_send_mutex);
+    return post_message(TRY(message.encode(&m_buffer_pool)));
 }
 
 ErrorOr<void> ConnectionBase::post_message(MessageBuffer buffer)
 {
+    Threading::MutexLocker locker(m_send_mutex);
+
     // NOTE: If this connection is being shut down, but has not yet been destroyed,
     //       the socket will be closed. Don't try to send more messages.
     if (!m_socket->is_open())
         return Error::from_string_literal("Trying to post_message during IPC shutdown");
 
-    if (auto result = buffer.transfer_message(fd_passing_socket(), *m_socket); result.is_error()) {
-        shutdown_with_error(result.error());
+    m_posted_messages_size += buffer.data_size();
+    TRY(m_posted_messages.try_append(move(buffer)));
+
+    // Larger batches wouldn't fit into the socket at once anyway.
+    static constexpr size_t maximum_batch_size = 64 * KiB;
+    if (m_posted_messages_size >= maximum_batch_size || !can_defer_flush())
+        return flush_posted_messages();
+
+    if (m_posted_messages.size() == 1) {
+        m_deferred_invoker->schedule([strong_this = NonnullRefPtr(*this)] {
+            // Errors shut the connection down, there is nothing else to do about them here.
+            (void)strong_this->flush_posted_messages();
+        });
+    }
+    return {};
+}
+
+bool ConnectionBase::can_defer_flush() const
+{
+    // The deferred flush runs on the event loop of the thread that schedules it, if there is one. We can't tell when, or
+    // on which thread, a custom deferred invoker runs, so those don't get to flush either.
+    return is_on_owner_thread() && !m_has_custom_deferred_invoker && Core::EventLoop::is_running();
+}
+
+ErrorOr<void> ConnectionBase::flush_posted_messages()
+{
+    Threading::MutexLocker locker(m_send_mutex);
+    if (m_posted_messages.is_empty())
+        return {};
+
+    if (!m_socket->is_open()) {
+        m_posted_messages.clear();
+        m_posted_messages_size = 0;
+        return Error::from_string_literal("Trying to flush_posted_messages during IPC shutdown");
+    }
+
+    if (auto result = send_posted_messages(); result.is_error()) {
+        // Other threads leave shutting down to the owner, which notices the broken connection once it reads from it.
+        if (is_on_owner_thread())
+            shutdown_with_error(result.error());
         return result.release_error();
     }
 
-    m_responsiveness_timer->start();
+    if (is_on_owner_thread())
+        m_responsiveness_timer->start();
+    return {};
+}
+
+ErrorOr<void> ConnectionBase::send_posted_messages()
+{
+    VERIFY(m_socket->is_open());
+
+    auto messages = move(m_posted_messages);
+    m_posted_messages_size = 0;
+    auto syscall_count = TRY(MessageBuffer::transfer_messages(messages, fd_passing_socket(), *m_socket));
+
+    m_statistics.messages_sent += messages.size();
+    m_statistics.send_syscalls += syscall_count;
     return {};
 }
 
 void ConnectionBase::shutdown()
 {
-    m_socket->close();
+    {
+        Threading::MutexLocker locker(m_send_mutex);
+        // Messages that were posted right before shutting down should still make it to the peer.
+        if (m_socket->is_open() && !m_posted_messages.is_empty())
+            (void)send_posted_messages();
+        m_socket->close();
+    }
     die();
 }
 
@@ -98,6 +182,9 @@ void ConnectionBase::handle_messages()
             }
         }
     }
+
+    // The peer may be waiting for one of the responses.
+    (void)flush_posted_messages();
 }
 
 void ConnectionBase::wait_for_socket_to_become_readable()
@@ -121,8 +208,6 @@ ErrorOr<Vector<u8>> ConnectionBase::read_as_much_as_possible_from_socket_without
         m_unprocessed_bytes.clear();
     }
 
-    u8 buffer[4096];
-
     bool should_shut_down = false;
     auto schedule_shutdown = [this, &should_shut_down]() {
         should_shut_down = true;
@@ -131,9 +216,15 @@ ErrorOr<Vector<u8>> ConnectionBase::read_as_much_as_possible_from_socket_without
         });
     };
 
+    // Read straight into the end of the buffer, so that everything the peer sent can be parsed in one go.
+    static constexpr size_t read_size = 64 * KiB;
     while (m_socket->is_open()) {
-        auto maybe_bytes_read = m_socket->read_without_waiting({ buffer, 4096 });
+        auto size_before_read = bytes.size();
+        TRY(bytes.try_resize(size_before_read + read_size));
+        auto maybe_bytes_read = m_socket->read_without_waiting(bytes.span().slice(size_before_read));
+        ++m_statistics.receive_syscalls;
         if (maybe_bytes_read.is_error()) {
+            bytes.shrink(size_before_read, true);
             auto error = maybe_bytes_read.release_error();
             if (error.is_syscall() && error.code() == EAGAIN) {
                 break;
@@ -150,12 +241,11 @@ ErrorOr<Vector<u8>> ConnectionBase::read_as_much_as_possible_from_socket_without
         }
 
         auto bytes_read = maybe_bytes_read.release_value();
+        bytes.shrink(size_before_read + bytes_read.size(), true);
         if (bytes_read.is_empty()) {
             schedule_shutdown();
             break;
         }
-
-        bytes.append(bytes_read.data(), bytes_read.size());
     }
 
     if (!bytes.is_empty()) {
@@ -197,6 +287,10 @@ ErrorOr<void> ConnectionBase::drain_messages_from_peer()
 
 OwnPtr<IPC::Message> ConnectionBase::wait_for_specific_endpoint_message_impl(u32 endpoint_magic, int message_id)
 {
+    // The peer can't respond to what it hasn't received yet.
+    if (flush_posted_messages().is_error())
+        return {};
+
     for (;;) {
         // Double check we don't already have the event waiting for us.
         // Otherwise we might end up blocked for a while for no reason.
@@ -16,7 +16,10 @@
 #include <LibCore/Timer.h>
 #include <LibIPC/Forward.h>
 #include <LibIPC/Message.h>
+#include <LibIPC/SharedBufferPool.h>
+#include <LibThreading/Mutex.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <sys/socket.h>
@@ -36,14 +39,26 @@ class ConnectionBase : public Core::EventReceiver {
     C_OBJECT_ABSTRACT(ConnectionBase);
 
 public:
-    virtual ~ConnectionBase() override = default;
+    virtual ~ConnectionBase() override;
 
     void set_fd_passing_socket(NonnullOwnPtr<Core::LocalSocket>);
     void set_deferred_invoker(NonnullOwnPtr<DeferredInvoker>);
     DeferredInvoker& deferred_invoker() { return *m_deferred_invoker; }
 
     bool is_open() const { return m_socket->is_open(); }
+
+    // Messages are sent together once the event loop gets to it, or before waiting for a synchronous response.
+    // Messages posted from other threads, or without an event loop, are sent right away.
     ErrorOr<void> post_message(Message const&);
+    ErrorOr<void> flush_posted_messages();
+
+    struct Statistics {
+        u64 messages_sent { 0 };
+        u64 send_syscalls { 0 };
+        u64 messages_received { 0 };
+        u64 receive_syscalls { 0 };
+    };
+    Statistics const& statistics() const { return m_statistics; }
 
     void shutdown();
     virtual void die() { }
@@ -67,6 +82,25 @@ protected:
     ErrorOr<void> post_message(MessageBuffer);
     void handle_messages();
 
+    bool is_on_owner_thread() const { return pthread_equal(pthread_self(), m_owner_thread); }
+    bool can_defer_flush() const;
+    ErrorOr<void> send_posted_messages();
+
+    // Guards everything needed to send, since any thread may post messages.
+    Threading::Mutex m_send_mutex;
+    // The thread that created the connection, and whose event loop handles it.
+    pthread_t m_owner_thread;
+    bool m_has_custom_deferred_invoker { false };
+
+    // Buffers for our large payloads, which the peer releases again once it has read them.
+    SharedBufferPool m_buffer_pool;
+
+    Vector<MessageBuffer> m_posted_messages;
+    size_t m_posted_messages_size { 0 };
+
+    Statistics m_statistics;
+    RefPtr<Core::Timer> m_statistics_timer;
+
     IPC::Stub& m_local_stub;
 
     NonnullOwnPtr<Core::LocalSocket> m_socket;
@@ -141,12 +175,14 @@ protected:
             auto local_message = LocalEndpoint::decode_message(remaining_bytes, fd_passing_socket());
             if (!local_message.is_error()) {
                 m_unprocessed_messages.append(local_message.release_value());
+                ++m_statistics.messages_received;
                 continue;
             }
 
             auto peer_message = PeerEndpoint::decode_message(remaining_bytes, fd_passing_socket());
             if (!peer_message.is_error()) {
                 m_unprocessed_messages.append(peer_message.release_value());
+                ++m_statistics.messages_received;
                 continue;
             }
 
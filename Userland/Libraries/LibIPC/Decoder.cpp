@@ -23,11 +23,23 @@ ErrorOr<size_t> Decoder::decode_size()
     return static_cast<size_t>(TRY(decode<u32>()));
 }
 
+ErrorOr<Core::AnonymousBuffer> Decoder::receive_shared_buffer(size_t payload_size)
+{
+    auto buffer_size = TRY(decode_size());
+    if (buffer_size < SharedBufferPool::header_size + payload_size)
+        return Error::from_string_literal("Shared buffer is smaller than its payload");
+
+    auto anon_file = TRY(decode<IPC::File>());
+    return Core::AnonymousBuffer::create_from_anon_fd(anon_file.take_fd(), buffer_size);
+}
+
 template<>
 ErrorOr<String> decode(Decoder& decoder)
 {
     auto length = TRY(decoder.decode_size());
-    return String::from_stream(decoder.stream(), length);
+    return decoder.decode_payload(length, [&](Stream& stream) {
+        return String::from_stream(stream, length);
+    });
 }
 
 template<>
@@ -39,13 +51,12 @@ ErrorOr<ByteString> decode(Decoder& decoder)
     if (length == 0)
         return ByteString::empty();
 
-    char* text_buffer = nullptr;
-    auto text_impl = StringImpl::create_uninitialized(length, text_buffer);
-
-    Bytes bytes { text_buffer, length };
-    TRY(decoder.decode_into(bytes));
-
-    return ByteString { *text_impl };
+    return decoder.decode_payload(length, [&](Stream& stream) -> ErrorOr<ByteString> {
+        char* text_buffer = nullptr;
+        auto text_impl = StringImpl::create_uninitialized(length, text_buffer);
+        TRY(stream.read_until_filled({ text_buffer, length }));
+        return ByteString { *text_impl };
+    });
 }
 
 template<>
@@ -55,11 +66,11 @@ ErrorOr<ByteBuffer> decode(Decoder& decoder)
     if (length == 0)
         return ByteBuffer {};
 
-    auto buffer = TRY(ByteBuffer::create_uninitialized(length));
-    auto bytes = buffer.bytes();
-
-    TRY(decoder.decode_into(bytes));
-    return buffer;
+    return decoder.decode_payload(length, [&](Stream& stream) -> ErrorOr<ByteBuffer> {
+        auto buffer = TRY(ByteBuffer::create_uninitialized(length));
+        TRY(stream.read_until_filled(buffer.bytes()));
+        return buffer;
+    });
 }
 
 template<>
@@ -10,6 +10,7 @@
 #include <AK/ByteString.h>
 #include <AK/Concepts.h>
 #include <AK/Forward.h>
+#include <AK/MemoryStream.h>
 #include <AK/NumericLimits.h>
 #include <AK/StdLibExtras.h>
 #include <AK/String.h>
@@ -22,6 +23,7 @@
 #include <LibIPC/File.h>
 #include <LibIPC/Forward.h>
 #include <LibIPC/Message.h>
+#include <LibIPC/SharedBufferPool.h>
 
 namespace IPC {
 
@@ -58,10 +60,26 @@ public:
 
     ErrorOr<size_t> decode_size();
 
+    // Calls the callback with a stream of a payload that was put there with Encoder::append_payload().
+    template<typename Callback>
+    auto decode_payload(size_t size, Callback callback) -> decltype(callback(declval<Stream&>()))
+    {
+        if (!SharedBufferPool::should_share(size))
+            return callback(m_stream);
+
+        auto buffer = TRY(receive_shared_buffer(size));
+        FixedMemoryStream stream { SharedBufferPool::payload_of(buffer, size) };
+        auto result = callback(stream);
+        SharedBufferPool::release(buffer);
+        return result;
+    }
+
     Stream& stream() { return m_stream; }
     Core::LocalSocket& socket() { return m_socket; }
 
 private:
+    ErrorOr<Core::AnonymousBuffer> receive_shared_buffer(size_t payload_size);
+
     Stream& m_stream;
     Core::LocalSocket& m_socket;
 };
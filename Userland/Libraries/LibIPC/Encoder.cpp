@@ -21,6 +21,7 @@
 #include <LibCore/System.h>
 #include <LibIPC/Encoder.h>
 #include <LibIPC/File.h>
+#include <LibIPC/SharedBufferPool.h>
 
 namespace IPC {
 
@@ -31,6 +32,19 @@ ErrorOr<void> Encoder::encode_size(size_t size)
     return encode(static_cast<u32>(size));
 }
 
+ErrorOr<void> Encoder::append_payload(ReadonlyBytes payload)
+{
+    if (!SharedBufferPool::should_share(payload.size()))
+        return append(payload.data(), payload.size());
+
+    auto buffer = m_buffer_pool ? TRY(m_buffer_pool->take(payload.size())) : TRY(SharedBufferPool::create_buffer(payload.size()));
+    payload.copy_to(SharedBufferPool::payload_of(buffer, payload.size()));
+
+    // The peer releases the buffer back into our pool once it has read the payload.
+    TRY(encode_size(buffer.size()));
+    return encode(IPC::File { buffer.fd() });
+}
+
 template<>
 ErrorOr<void> encode(Encoder& encoder, float const& value)
 {
@@ -48,7 +62,7 @@ ErrorOr<void> encode(Encoder& encoder, String const& value)
 {
     auto bytes = value.bytes();
     TRY(encoder.encode_size(bytes.size()));
-    TRY(encoder.append(bytes.data(), bytes.size()));
+    TRY(encoder.append_payload(bytes));
     return {};
 }
 
@@ -60,7 +74,7 @@ ErrorOr<void> encode(Encoder& encoder, StringView const& value)
         return encoder.encode(NumericLimits<u32>::max());
 
     TRY(encoder.encode_size(value.length()));
-    TRY(encoder.append(reinterpret_cast<u8 const*>(value.characters_without_null_termination()), value.length()));
+    TRY(encoder.append_payload(value.bytes()));
     return {};
 }
 
@@ -74,7 +88,7 @@ template<>
 ErrorOr<void> encode(Encoder& encoder, ByteBuffer const& value)
 {
     TRY(encoder.encode_size(value.size()));
-    TRY(encoder.append(value.data(), value.size()));
+    TRY(encoder.append_payload(value.bytes()));
     return {};
 }
 
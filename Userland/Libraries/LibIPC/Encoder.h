@@ -27,8 +27,9 @@ ErrorOr<void> encode(Encoder&, T const&)
 
 class Encoder {
 public:
-    explicit Encoder(MessageBuffer& buffer)
+    explicit Encoder(MessageBuffer& buffer, SharedBufferPool* buffer_pool = nullptr)
         : m_buffer(buffer)
+        , m_buffer_pool(buffer_pool)
     {
     }
 
@@ -47,6 +48,9 @@ public:
         return {};
     }
 
+    // Large payloads are passed in shared memory, so the decoder has to know the payload size beforehand.
+    ErrorOr<void> append_payload(ReadonlyBytes);
+
     ErrorOr<void> append_file_descriptor(int fd)
     {
         TRY(m_buffer.append_file_descriptor(fd));
@@ -57,6 +61,7 @@ public:
 
 private:
     MessageBuffer& m_buffer;
+    SharedBufferPool* m_buffer_pool { nullptr };
 };
 
 template<Arithmetic T>
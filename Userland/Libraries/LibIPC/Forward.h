@@ -15,6 +15,7 @@ class Encoder;
 class Message;
 class MessageBuffer;
 class File;
+class SharedBufferPool;
 class Stub;
 
 template<typename T>
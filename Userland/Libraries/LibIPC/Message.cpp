@@ -39,19 +39,45 @@ ErrorOr<void> MessageBuffer::append_file_descriptor(int fd)
 
 ErrorOr<void> MessageBuffer::transfer_message(Core::LocalSocket& fd_passing_socket, Core::LocalSocket& data_socket)
 {
-    Checked<MessageSizeType> checked_message_size { m_data.size() };
-    checked_message_size -= sizeof(MessageSizeType);
+    TRY(transfer_messages({ this, 1 }, fd_passing_socket, data_socket));
+    return {};
+}
+
+ErrorOr<size_t> MessageBuffer::transfer_messages(Span<MessageBuffer> messages, Core::LocalSocket& fd_passing_socket, Core::LocalSocket& data_socket)
+{
+    size_t total_size = 0;
+    for (auto& message : messages) {
+        Checked<MessageSizeType> checked_message_size { message.m_data.size() };
+        checked_message_size -= sizeof(MessageSizeType);
+
+        if (checked_message_size.has_overflow())
+            return Error::from_string_literal("Message is too large for IPC encoding");
 
-    if (checked_message_size.has_overflow())
-        return Error::from_string_literal("Message is too large for IPC encoding");
+        auto message_size = checked_message_size.value();
+        message.m_data.span().overwrite(0, reinterpret_cast<u8 const*>(&message_size), sizeof(message_size));
+        total_size += message.m_data.size();
+    }
 
-    auto message_size = checked_message_size.value();
-    m_data.span().overwrite(0, reinterpret_cast<u8 const*>(&message_size), sizeof(message_size));
+    size_t syscalls_done = 0;
+    for (auto& message : messages) {
+        for (auto const& fd : message.m_fds) {
+            TRY(fd_passing_socket.send_fd(fd->value()));
+            ++syscalls_done;
+        }
+    }
 
-    for (auto const& fd : m_fds)
-        TRY(fd_passing_socket.send_fd(fd->value()));
+    // The peer reads everything that's there at once, so a batch should arrive in one piece.
+    Vector<u8, 1024> batch_data;
+    ReadonlyBytes bytes_to_write;
+    if (messages.size() == 1) {
+        bytes_to_write = messages[0].m_data.span();
+    } else {
+        TRY(batch_data.try_ensure_capacity(total_size));
+        for (auto& message : messages)
+            batch_data.unchecked_append(message.m_data.data(), message.m_data.size());
+        bytes_to_write = batch_data.span();
+    }
 
-    ReadonlyBytes bytes_to_write { m_data.span() };
     size_t writes_done = 0;
 
     while (!bytes_to_write.is_empty()) {
@@ -84,10 +110,10 @@ ErrorOr<void> MessageBuffer::transfer_message(Core::LocalSocket& fd_passing_sock
     }
 
     if (writes_done > 1) {
-        dbgln("LibIPC::transfer_message FIXME Warning, needed {} writes needed to send message of size {}B, this is pretty bad, as it spins on the EventLoop", writes_done, m_data.size());
+        dbgln("LibIPC::transfer_message FIXME Warning, needed {} writes needed to send {} message(s) of size {}B, this is pretty bad, as it spins on the EventLoop", writes_done, messages.size(), total_size);
     }
 
-    return {};
+    return syscalls_done + writes_done;
 }
 
 }
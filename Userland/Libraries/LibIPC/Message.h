@@ -12,6 +12,7 @@
 #include <AK/RefPtr.h>
 #include <AK/Vector.h>
 #include <LibCore/Forward.h>
+#include <LibIPC/Forward.h>
 #include <unistd.h>
 
 namespace IPC {
@@ -46,6 +47,11 @@ public:
 
     ErrorOr<void> transfer_message(Core::LocalSocket& fd_passing_socket, Core::LocalSocket& data_socket);
 
+    // Writes all the messages to the socket at once, and returns how many syscalls that took.
+    static ErrorOr<size_t> transfer_messages(Span<MessageBuffer>, Core::LocalSocket& fd_passing_socket, Core::LocalSocket& data_socket);
+
+    size_t data_size() const { return m_data.size(); }
+
 private:
     Vector<u8, 1024> m_data;
     Vector<NonnullRefPtr<AutoCloseFileDescriptor>, 1> m_fds;
@@ -66,7 +72,8 @@ public:
     virtual int message_id() const = 0;
     virtual char const* message_name() const = 0;
     virtual bool valid() const = 0;
-    virtual ErrorOr<MessageBuffer> encode() const = 0;
+    // Large payloads are put in buffers from the pool, if there is one.
+    virtual ErrorOr<MessageBuffer> encode(SharedBufferPool*) const = 0;
 
 protected:
     Message() = default;
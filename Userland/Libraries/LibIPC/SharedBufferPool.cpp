@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <LibIPC/SharedBufferPool.h>
+
+namespace IPC {
+
+enum class BufferState : u32 {
+    Free,
+    InFlight,
+};
+
+static u32* state_of(Core::AnonymousBuffer& buffer)
+{
+    return buffer.data<u32>();
+}
+
+static bool is_free(Core::AnonymousBuffer const& buffer)
+{
+    // Pairs with the release in release(), the peer has to be done reading before we write the next payload.
+    return AK::atomic_load(buffer.data<u32>(), AK::memory_order_acquire) == to_underlying(BufferState::Free);
+}
+
+ErrorOr<Core::AnonymousBuffer> SharedBufferPool::create_buffer(size_t payload_size)
+{
+    // Payloads of similar size should be able to share buffers.
+    auto buffer = TRY(Core::AnonymousBuffer::create_with_size(header_size + round_up_to_power_of_two(payload_size, minimum_payload_size)));
+    AK::atomic_store(state_of(buffer), to_underlying(BufferState::InFlight), AK::memory_order_relaxed);
+    return buffer;
+}
+
+Bytes SharedBufferPool::payload_of(Core::AnonymousBuffer& buffer, size_t payload_size)
+{
+    VERIFY(buffer.size() >= header_size + payload_size);
+    return { buffer.data<u8>() + header_size, payload_size };
+}
+
+void SharedBufferPool::release(Core::AnonymousBuffer& buffer)
+{
+    AK::atomic_store(state_of(buffer), to_underlying(BufferState::Free), AK::memory_order_release);
+}
+
+ErrorOr<Core::AnonymousBuffer> SharedBufferPool::take(size_t payload_size)
+{
+    Optional<size_t> best_index;
+    Optional<size_t> smallest_free_index;
+    for (size_t i = 0; i < m_buffers.size(); ++i) {
+        if (!is_free(m_buffers[i]))
+            continue;
+        if (!smallest_free_index.has_value() || m_buffers[i].size() < m_buffers[*smallest_free_index].size())
+            smallest_free_index = i;
+        if (m_buffers[i].size() < header_size + payload_size)
+            continue;
+        if (!best_index.has_value() || m_buffers[i].size() < m_buffers[*best_index].size())
+            best_index = i;
+    }
+    if (best_index.has_value()) {
+        AK::atomic_store(state_of(m_buffers[*best_index]), to_underlying(BufferState::InFlight), AK::memory_order_relaxed);
+        return m_buffers[*best_index];
+    }
+
+    auto buffer = TRY(create_buffer(payload_size));
+    if (buffer.size() > maximum_buffer_size)
+        return buffer;
+
+    if (m_buffers.size() < maximum_buffer_count) {
+        TRY(m_buffers.try_append(buffer));
+        return buffer;
+    }
+
+    // Once full, a free buffer that is too small for this payload makes room for this one. Buffers that the peer still
+    // has are kept, since they will be free again soon.
+    if (smallest_free_index.has_value())
+        m_buffers[*smallest_free_index] = buffer;
+    return buffer;
+}
+
+size_t SharedBufferPool::free_buffer_count() const
+{
+    size_t count = 0;
+    for (auto& buffer : m_buffers) {
+        if (is_free(buffer))
+            ++count;
+    }
+    return count;
+}
+
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Noncopyable.h>
+#include <AK/Vector.h>
+#include <LibCore/AnonymousBuffer.h>
+
+namespace IPC {
+
+// Large payloads are handed to the peer in shared memory, instead of being copied through the socket.
+// The sender keeps the buffers it created, and the peer marks each one as free again in its header once it has read
+// the payload. That way the buffers get reused however the messages flow, and don't have to be created (and faulted
+// in) for every message.
+class SharedBufferPool {
+    AK_MAKE_NONCOPYABLE(SharedBufferPool);
+    AK_MAKE_NONMOVABLE(SharedBufferPool);
+
+public:
+    // Anything smaller is cheaper to copy through the socket.
+    static constexpr size_t minimum_payload_size = 64 * KiB;
+    // The payload follows the header on its own cache line, so the peer's write to the header doesn't share it.
+    static constexpr size_t header_size = 64;
+
+    static bool should_share(size_t payload_size) { return payload_size >= minimum_payload_size; }
+
+    // A buffer that isn't part of any pool, and is never reused.
+    static ErrorOr<Core::AnonymousBuffer> create_buffer(size_t payload_size);
+    static Bytes payload_of(Core::AnonymousBuffer&, size_t payload_size);
+    // Called by the receiver once it's done with the payload, after which the sender may reuse the buffer.
+    static void release(Core::AnonymousBuffer&);
+
+    SharedBufferPool() = default;
+
+    // Returns a buffer that is free to be sent to the peer. It stays in the pool, until the peer releases it.
+    ErrorOr<Core::AnonymousBuffer> take(size_t payload_size);
+
+    size_t buffer_count() const { return m_buffers.size(); }
+    size_t free_buffer_count() const;
+
+private:
+    static constexpr size_t maximum_buffer_count = 4;
+    static constexpr size_t maximum_buffer_size = 16 * MiB;
+
+    Vector<Core::AnonymousBuffer, maximum_buffer_count> m_buffers;
+};
+
+}
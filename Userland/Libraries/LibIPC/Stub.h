@@ -23,7 +23,8 @@ public:
 
     virtual u32 magic() const = 0;
     virtual ByteString name() const = 0;
-    virtual ErrorOr<OwnPtr<MessageBuffer>> handle(Message const&) = 0;
+    // Returns the response to synchronous messages.
+    virtual ErrorOr<OwnPtr<Message>> handle(Message const&) = 0;
 
 protected:
     Stub() = default;
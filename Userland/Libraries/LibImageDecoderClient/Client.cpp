@@ -16,6 +16,10 @@ Client::Client(NonnullOwnPtr<Core::LocalSocket> socket)
 
 void Client::die()
 {
+    auto pending_decodes = move(m_pending_decodes);
+    for (auto& it : pending_decodes)
+        it.value.on_complete({});
+
     if (on_death)
         on_death();
 }
@@ -59,4 +63,81 @@ Optional<DecodedImage> Client::decode_image(ReadonlyBytes encoded_data, Optional
     return image;
 }
 
+ErrorOr<i64> Client::start_decoding_image(ReadonlyBytes encoded_data, Function<void(DecodedImage, u32 frame_count)> on_first_frame, Function<void(Optional<DecodedImage>)> on_complete, Optional<Gfx::IntSize> ideal_size, Optional<ByteString> mime_type)
+{
+    if (encoded_data.is_empty())
+        return Error::from_string_literal("No image data to decode");
+
+    auto encoded_buffer = TRY(Core::AnonymousBuffer::create_with_size(encoded_data.size()));
+    memcpy(encoded_buffer.data<void>(), encoded_data.data(), encoded_data.size());
+
+    auto image_id = m_next_image_id++;
+    TRY(post_message(Messages::ImageDecoderServer::StartDecodingImage(image_id, move(encoded_buffer), ideal_size, move(mime_type))));
+
+    PendingDecode pending_decode;
+    pending_decode.on_first_frame = move(on_first_frame);
+    pending_decode.on_complete = move(on_complete);
+    m_pending_decodes.set(image_id, move(pending_decode));
+    return image_id;
+}
+
+void Client::set_image_visible(i64 image_id, bool is_visible)
+{
+    if (m_pending_decodes.contains(image_id))
+        async_set_image_visible(image_id, is_visible);
+}
+
+void Client::cancel_decoding(i64 image_id)
+{
+    if (m_pending_decodes.remove(image_id))
+        async_cancel_decoding(image_id);
+}
+
+void Client::did_start_decoding_image(i64 image_id, bool is_animated, u32 loop_count, u32 frame_count)
+{
+    auto it = m_pending_decodes.find(image_id);
+    if (it == m_pending_decodes.end())
+        return;
+
+    auto& image = it->value.image;
+    image.is_animated = is_animated;
+    image.loop_count = loop_count;
+    it->value.frame_count = frame_count;
+}
+
+// Frames are sent one by one as soon as they're decoded, in order, so the image is complete once the last of them has
+// arrived.
+void Client::did_decode_image_frame(i64 image_id, u32 frame_index, Gfx::ShareableBitmap const& bitmap, u32 duration)
+{
+    auto it = m_pending_decodes.find(image_id);
+    if (it == m_pending_decodes.end())
+        return;
+
+    auto& pending_decode = it->value;
+    if (!bitmap.is_valid() || frame_index != pending_decode.image.frames.size() || frame_index >= pending_decode.frame_count) {
+        async_cancel_decoding(image_id);
+        return did_fail_to_decode_image(image_id);
+    }
+
+    pending_decode.image.frames.empend(*bitmap.bitmap(), duration);
+    if (pending_decode.image.frames.size() == pending_decode.frame_count) {
+        auto finished_decode = m_pending_decodes.take(image_id).release_value();
+        finished_decode.on_complete(move(finished_decode.image));
+        return;
+    }
+
+    // The first frame can already be shown while the others are still being decoded. The callback may cancel the
+    // decode, which takes pending_decode with it, so it only gets a copy of the image.
+    if (frame_index == 0 && pending_decode.on_first_frame) {
+        auto on_first_frame = move(pending_decode.on_first_frame);
+        on_first_frame(pending_decode.image, pending_decode.frame_count);
+    }
+}
+
+void Client::did_fail_to_decode_image(i64 image_id)
+{
+    if (auto pending_decode = m_pending_decodes.take(image_id); pending_decode.has_value())
+        pending_decode->on_complete({});
+}
+
 }
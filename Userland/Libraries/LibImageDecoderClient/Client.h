@@ -34,10 +34,32 @@ public:
 
     Optional<DecodedImage> decode_image(ReadonlyBytes, Optional<Gfx::IntSize> ideal_size = {}, Optional<ByteString> mime_type = {});
 
+    // Decodes the image on one of the decoder's threads, and hands it to on_complete once all of its frames have
+    // arrived (or nothing, if it couldn't be decoded). Images with more than one frame are also handed to
+    // on_first_frame as soon as their first frame is there, along with how many frames they have in total.
+    ErrorOr<i64> start_decoding_image(ReadonlyBytes, Function<void(DecodedImage, u32 frame_count)> on_first_frame, Function<void(Optional<DecodedImage>)> on_complete, Optional<Gfx::IntSize> ideal_size = {}, Optional<ByteString> mime_type = {});
+    // Images that are visible are decoded before the ones that aren't.
+    void set_image_visible(i64 image_id, bool);
+    // on_complete isn't called for the image anymore.
+    void cancel_decoding(i64 image_id);
+
     Function<void()> on_death;
 
 private:
     virtual void die() override;
+
+    virtual void did_start_decoding_image(i64 image_id, bool is_animated, u32 loop_count, u32 frame_count) override;
+    virtual void did_decode_image_frame(i64 image_id, u32 frame_index, Gfx::ShareableBitmap const&, u32 duration) override;
+    virtual void did_fail_to_decode_image(i64 image_id) override;
+
+    struct PendingDecode {
+        DecodedImage image;
+        u32 frame_count { 0 };
+        Function<void(DecodedImage, u32 frame_count)> on_first_frame;
+        Function<void(Optional<DecodedImage>)> on_complete;
+    };
+    HashMap<i64, PendingDecode> m_pending_decodes;
+    i64 m_next_image_id { 0 };
 };
 
 }
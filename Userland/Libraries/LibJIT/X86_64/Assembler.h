@@ -303,15 +303,21 @@ struct X86_64Assembler {
         emit8(rex.raw);
     }
 
-    void shift_right(Operand dst, Operand count)
+    void shift_right(Operand dst, Optional<Operand> count)
     {
         VERIFY(dst.type == Operand::Type::Reg);
-        VERIFY(count.type == Operand::Type::Imm);
-        VERIFY(count.fits_in_u8());
-        emit_rex_for_slash(dst, REX_W::Yes);
-        emit8(0xc1);
-        emit_modrm_slash(5, dst);
-        emit8(count.offset_or_immediate);
+        if (count.has_value()) {
+            VERIFY(count->type == Operand::Type::Imm);
+            VERIFY(count->fits_in_u8());
+            emit_rex_for_slash(dst, REX_W::Yes);
+            emit8(0xc1);
+            emit_modrm_slash(5, dst);
+            emit8(count->offset_or_immediate);
+        } else {
+            emit_rex_for_slash(dst, REX_W::Yes);
+            emit8(0xd3);
+            emit_modrm_slash(5, dst);
+        }
     }
 
     void mov(Operand dst, Operand src, Patchable patchable = Patchable::No)
@@ -383,11 +389,31 @@ struct X86_64Assembler {
         SignExtend,
     };
 
+    // Byte registers 4 to 7 mean AH, CH, DH and BH unless there is a REX prefix, then they mean SPL, BPL, SIL and DIL.
+    static bool needs_rex_for_byte_register(Operand operand)
+    {
+        return operand.type == Operand::Type::Reg && to_underlying(operand.reg) >= 4 && to_underlying(operand.reg) < 8;
+    }
+
     void mov8(Operand dst, Operand src, Extension extension = Extension::ZeroExtend)
     {
-        VERIFY(dst.type == Operand::Type::Reg && src.type == Operand::Type::Mem64BaseAndOffset);
+        if (dst.type == Operand::Type::Mem64BaseAndOffset && src.type == Operand::Type::Reg) {
+            // mov r/m8, r8
+            if (needs_rex_for_byte_register(src) && to_underlying(dst.reg) < 8)
+                emit8(REX { .B = 0, .X = 0, .R = 0, .W = 0 }.raw);
+            else
+                emit_rex_for_mr(dst, src, REX_W::No);
+            emit8(0x88);
+            emit_modrm_mr(dst, src);
+            return;
+        }
+
+        VERIFY(dst.type == Operand::Type::Reg && src.is_register_or_memory());
         // mov[sz]x r32, r/m8
-        emit_rex_for_rm(dst, src, REX_W::No);
+        if (needs_rex_for_byte_register(src) && to_underlying(dst.reg) < 8)
+            emit8(REX { .B = 0, .X = 0, .R = 0, .W = 0 }.raw);
+        else
+            emit_rex_for_rm(dst, src, REX_W::No);
         emit8(0x0f);
         emit8(extension == Extension::ZeroExtend ? 0xb6 : 0xbe);
         emit_modrm_rm(dst, src);
@@ -395,6 +421,15 @@ struct X86_64Assembler {
 
     void mov16(Operand dst, Operand src, Extension extension = Extension::ZeroExtend)
     {
+        if (dst.type == Operand::Type::Mem64BaseAndOffset && src.type == Operand::Type::Reg) {
+            // mov r/m16, r16
+            emit8(0x66);
+            emit_rex_for_mr(dst, src, REX_W::No);
+            emit8(0x89);
+            emit_modrm_mr(dst, src);
+            return;
+        }
+
         VERIFY(dst.type == Operand::Type::Reg && src.is_register_or_memory());
         // mov[sz]x r32, r/m16
         emit_rex_for_rm(dst, src, REX_W::No);
@@ -405,6 +440,14 @@ struct X86_64Assembler {
 
     void mov32(Operand dst, Operand src, Extension extension = Extension::ZeroExtend)
     {
+        if (dst.type == Operand::Type::Mem64BaseAndOffset && src.type == Operand::Type::Reg) {
+            // mov r/m32, r32
+            emit_rex_for_mr(dst, src, REX_W::No);
+            emit8(0x89);
+            emit_modrm_mr(dst, src);
+            return;
+        }
+
         VERIFY(dst.type == Operand::Type::Reg && src.is_register_or_memory());
         if (extension == Extension::ZeroExtend) {
             // mov r32, r/m32
@@ -543,6 +586,32 @@ struct X86_64Assembler {
         }
     }
 
+    void cmp32(Operand lhs, Operand rhs)
+    {
+        if (lhs.type == Operand::Type::Reg && rhs.type == Operand::Type::Imm && rhs.offset_or_immediate == 0) {
+            // test lhs, lhs
+            emit_rex_for_mr(lhs, lhs, REX_W::No);
+            emit8(0x85);
+            emit_modrm_mr(lhs, lhs);
+        } else if (lhs.is_register_or_memory() && rhs.type == Operand::Type::Reg) {
+            emit_rex_for_mr(lhs, rhs, REX_W::No);
+            emit8(0x39);
+            emit_modrm_mr(lhs, rhs);
+        } else if (lhs.is_register_or_memory() && rhs.type == Operand::Type::Imm && rhs.fits_in_i8()) {
+            emit_rex_for_slash(lhs, REX_W::No);
+            emit8(0x83);
+            emit_modrm_slash(7, lhs);
+            emit8(rhs.offset_or_immediate);
+        } else if (lhs.is_register_or_memory() && rhs.type == Operand::Type::Imm && rhs.fits_in_i32()) {
+            emit_rex_for_slash(lhs, REX_W::No);
+            emit8(0x81);
+            emit_modrm_slash(7, lhs);
+            emit32(rhs.offset_or_immediate);
+        } else {
+            VERIFY_NOT_REACHED();
+        }
+    }
+
     void test(Operand lhs, Operand rhs)
     {
         if (lhs.is_register_or_memory() && rhs.type == Operand::Type::Reg) {
@@ -640,6 +709,69 @@ struct X86_64Assembler {
         }
     }
 
+    void bitwise_and32(Operand dst, Operand src)
+    {
+        if (dst.is_register_or_memory() && src.type == Operand::Type::Reg) {
+            emit_rex_for_mr(dst, src, REX_W::No);
+            emit8(0x21);
+            emit_modrm_mr(dst, src);
+        } else if (dst.type == Operand::Type::Reg && src.type == Operand::Type::Imm && src.fits_in_i8()) {
+            emit_rex_for_slash(dst, REX_W::No);
+            emit8(0x83);
+            emit_modrm_slash(4, dst);
+            emit8(src.offset_or_immediate);
+        } else if (dst.type == Operand::Type::Reg && src.type == Operand::Type::Imm && src.fits_in_i32()) {
+            emit_rex_for_slash(dst, REX_W::No);
+            emit8(0x81);
+            emit_modrm_slash(4, dst);
+            emit32(src.offset_or_immediate);
+        } else {
+            VERIFY_NOT_REACHED();
+        }
+    }
+
+    void bitwise_or32(Operand dst, Operand src)
+    {
+        if (dst.is_register_or_memory() && src.type == Operand::Type::Reg) {
+            emit_rex_for_mr(dst, src, REX_W::No);
+            emit8(0x09);
+            emit_modrm_mr(dst, src);
+        } else if (dst.type == Operand::Type::Reg && src.type == Operand::Type::Imm && src.fits_in_i8()) {
+            emit_rex_for_slash(dst, REX_W::No);
+            emit8(0x83);
+            emit_modrm_slash(1, dst);
+            emit8(src.offset_or_immediate);
+        } else if (dst.type == Operand::Type::Reg && src.type == Operand::Type::Imm && src.fits_in_i32()) {
+            emit_rex_for_slash(dst, REX_W::No);
+            emit8(0x81);
+            emit_modrm_slash(1, dst);
+            emit32(src.offset_or_immediate);
+        } else {
+            VERIFY_NOT_REACHED();
+        }
+    }
+
+    void bitwise_xor(Operand dst, Operand src)
+    {
+        if (dst.is_register_or_memory() && src.type == Operand::Type::Reg) {
+            emit_rex_for_mr(dst, src, REX_W::Yes);
+            emit8(0x31);
+            emit_modrm_mr(dst, src);
+        } else if (dst.type == Operand::Type::Reg && src.type == Operand::Type::Imm && src.fits_in_i8()) {
+            emit_rex_for_slash(dst, REX_W::Yes);
+            emit8(0x83);
+            emit_modrm_slash(6, dst);
+            emit8(src.offset_or_immediate);
+        } else if (dst.type == Operand::Type::Reg && src.type == Operand::Type::Imm && src.fits_in_i32()) {
+            emit_rex_for_slash(dst, REX_W::Yes);
+            emit8(0x81);
+            emit_modrm_slash(6, dst);
+            emit32(src.offset_or_immediate);
+        } else {
+            VERIFY_NOT_REACHED();
+        }
+    }
+
     void bitwise_xor32(Operand dst, Operand src)
     {
         if (dst.is_register_or_memory() && src.type == Operand::Type::Reg) {
@@ -668,11 +800,63 @@ struct X86_64Assembler {
             emit8(0x0f);
             emit8(0x59);
             emit_modrm_rm(dest, src);
+        } else if (dest.type == Operand::Type::Reg && src.is_register_or_memory()) {
+            // imul dest, src (64-bit)
+            emit_rex_for_rm(dest, src, REX_W::Yes);
+            emit8(0x0f);
+            emit8(0xaf);
+            emit_modrm_rm(dest, src);
         } else {
             VERIFY_NOT_REACHED();
         }
     }
 
+    // cdq
+    void sign_extend_eax_into_edx()
+    {
+        emit8(0x99);
+    }
+
+    // cqo
+    void sign_extend_rax_into_rdx()
+    {
+        emit8(0x48);
+        emit8(0x99);
+    }
+
+    // The divide instructions divide EDX:EAX (or RDX:RAX) by the divisor, leaving the quotient in EAX and the remainder in EDX.
+    void signed_divide32(Operand divisor)
+    {
+        VERIFY(divisor.is_register_or_memory());
+        emit_rex_for_slash(divisor, REX_W::No);
+        emit8(0xf7);
+        emit_modrm_slash(7, divisor);
+    }
+
+    void unsigned_divide32(Operand divisor)
+    {
+        VERIFY(divisor.is_register_or_memory());
+        emit_rex_for_slash(divisor, REX_W::No);
+        emit8(0xf7);
+        emit_modrm_slash(6, divisor);
+    }
+
+    void signed_divide(Operand divisor)
+    {
+        VERIFY(divisor.is_register_or_memory());
+        emit_rex_for_slash(divisor, REX_W::Yes);
+        emit8(0xf7);
+        emit_modrm_slash(7, divisor);
+    }
+
+    void unsigned_divide(Operand divisor)
+    {
+        VERIFY(divisor.is_register_or_memory());
+        emit_rex_for_slash(divisor, REX_W::Yes);
+        emit8(0xf7);
+        emit_modrm_slash(6, divisor);
+    }
+
     void mul32(Operand dest, Operand src, Optional<Label&> overflow_label)
     {
         // imul32 dest, src (32-bit signed)
@@ -760,6 +944,28 @@ struct X86_64Assembler {
         }
     }
 
+    void rotate(u8 slash, REX_W W, Operand dest, Optional<Operand> count)
+    {
+        VERIFY(dest.type == Operand::Type::Reg);
+        if (count.has_value()) {
+            VERIFY(count->type == Operand::Type::Imm);
+            VERIFY(count->fits_in_u8());
+            emit_rex_for_slash(dest, W);
+            emit8(0xc1);
+            emit_modrm_slash(slash, dest);
+            emit8(count->offset_or_immediate);
+        } else {
+            emit_rex_for_slash(dest, W);
+            emit8(0xd3);
+            emit_modrm_slash(slash, dest);
+        }
+    }
+
+    void rotate_left(Operand dest, Optional<Operand> count) { rotate(0, REX_W::Yes, dest, count); }
+    void rotate_left32(Operand dest, Optional<Operand> count) { rotate(0, REX_W::No, dest, count); }
+    void rotate_right(Operand dest, Optional<Operand> count) { rotate(1, REX_W::Yes, dest, count); }
+    void rotate_right32(Operand dest, Optional<Operand> count) { rotate(1, REX_W::No, dest, count); }
+
     void arithmetic_right_shift(Operand dest, Optional<Operand> count)
     {
         VERIFY(dest.type == Operand::Type::Reg);
@@ -0,0 +1,451 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "RegexDFA.h"
+#include "RegexByteCode.h"
+#include <AK/CharacterTypes.h>
+#include <AK/HashFunctions.h>
+
+namespace regex {
+
+unsigned LazyDFA::StateKeyTraits::hash(StateKey const& key)
+{
+    auto hash = pair_int_hash(to_underlying(key.context), key.unanchored);
+    for (auto node : key.nodes)
+        hash = pair_int_hash(hash, node);
+    return hash;
+}
+
+// Runs a single opcode of the VM on a tiny input, to find out how it behaves for a given byte or context.
+static ExecutionResult execute_opcode(ByteCode const& bytecode, size_t instruction_position, AllOptions options, StringView view, size_t position, MatchState& state)
+{
+    MatchInput input;
+    input.view = view;
+    input.regex_options = options;
+
+    state.instruction_position = instruction_position;
+    state.string_position = position;
+    state.string_position_in_code_units = position;
+
+    auto& opcode = bytecode.get_opcode(state);
+    return opcode.execute(input, state);
+}
+
+OwnPtr<LazyDFA> LazyDFA::try_create(ByteCode const& bytecode, AllOptions options)
+{
+    auto dfa = adopt_own(*new LazyDFA(options));
+    if (!dfa->lower(bytecode))
+        return nullptr;
+    return dfa;
+}
+
+u32 LazyDFA::node_for(size_t instruction_position, Vector<size_t>& work_list)
+{
+    if (auto index = m_node_indices.get(instruction_position); index.has_value())
+        return *index;
+
+    u32 index = m_nodes.size();
+    m_nodes.append({});
+    m_node_indices.set(instruction_position, index);
+    work_list.append(instruction_position);
+    return index;
+}
+
+bool LazyDFA::lower(ByteCode const& bytecode)
+{
+    Vector<size_t> work_list;
+    node_for(0, work_list);
+
+    auto set_node = [&](u32 index, Node::Type type, u32 next, u32 alternative = 0, u32 table = 0) {
+        m_nodes[index] = { type, next, alternative, table };
+    };
+
+    auto add_byte_set = [&](Array<bool, 256> const& set) -> u32 {
+        m_byte_sets.append(set);
+        return m_byte_sets.size() - 1;
+    };
+
+    while (!work_list.is_empty()) {
+        if (m_nodes.size() > max_node_count)
+            return false;
+
+        auto instruction_position = work_list.take_last();
+        auto index = m_node_indices.get(instruction_position).value();
+
+        if (instruction_position >= bytecode.size()) {
+            set_node(index, Node::Type::Match, 0);
+            continue;
+        }
+
+        MatchState state;
+        state.instruction_position = instruction_position;
+        auto const& opcode = bytecode.get_opcode(state);
+        auto next_position = instruction_position + opcode.size();
+
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Compare: {
+            auto const& compare = static_cast<OpCode_Compare const&>(opcode);
+
+            // Strings are the only comparisons that consume more than one byte, so they're only supported on their own.
+            bool has_string = false;
+            size_t offset = instruction_position + 3;
+            for (size_t i = 0; i < compare.arguments_count(); ++i) {
+                switch (static_cast<CharacterCompareType>(bytecode.at(offset++))) {
+                case CharacterCompareType::Reference:
+                    return false;
+                case CharacterCompareType::String:
+                    has_string = true;
+                    offset += bytecode.at(offset) + 1;
+                    break;
+                case CharacterCompareType::LookupTable:
+                    offset += bytecode.at(offset) + 1;
+                    break;
+                case CharacterCompareType::Char:
+                case CharacterCompareType::CharClass:
+                case CharacterCompareType::CharRange:
+                case CharacterCompareType::Property:
+                case CharacterCompareType::GeneralCategory:
+                case CharacterCompareType::Script:
+                case CharacterCompareType::ScriptExtension:
+                    ++offset;
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            if (has_string) {
+                if (compare.arguments_count() != 1)
+                    return false;
+
+                auto length = bytecode.at(instruction_position + 4);
+                if (length == 0) {
+                    set_node(index, Node::Type::Jump, node_for(next_position, work_list));
+                    break;
+                }
+
+                Vector<u32> chain;
+                chain.append(index);
+                for (size_t i = 1; i < length; ++i) {
+                    chain.append(m_nodes.size());
+                    m_nodes.append({});
+                }
+                auto end = node_for(next_position, work_list);
+
+                auto insensitive = m_options.has_flag_set(AllFlags::Insensitive);
+                for (size_t i = 0; i < length; ++i) {
+                    auto code_unit = bytecode.at(instruction_position + 5 + i);
+                    Array<bool, 256> set {};
+                    if (code_unit < 256) {
+                        set[code_unit] = true;
+                        if (insensitive) {
+                            set[to_ascii_lowercase(code_unit)] = true;
+                            set[to_ascii_uppercase(code_unit)] = true;
+                        }
+                    }
+                    set_node(chain[i], Node::Type::Consume, i + 1 < length ? chain[i + 1] : end, 0, add_byte_set(set));
+                }
+                break;
+            }
+
+            Array<bool, 256> set {};
+            for (u32 byte = 0; byte < 256; ++byte) {
+                char character = static_cast<char>(byte);
+                MatchState compare_state;
+                auto result = execute_opcode(bytecode, instruction_position, m_options, { &character, 1 }, 0, compare_state);
+                set[byte] = result == ExecutionResult::Continue && compare_state.string_position == 1;
+            }
+            set_node(index, Node::Type::Consume, node_for(next_position, work_list), 0, add_byte_set(set));
+            break;
+        }
+        case OpCodeId::CheckBegin:
+        case OpCodeId::CheckEnd:
+        case OpCodeId::CheckBoundary: {
+            static constexpr Array<char, context_count> representatives { 0, '\n', 'a', ' ' };
+
+            Array<Array<bool, symbol_count>, context_count> table {};
+            for (size_t context = 0; context < context_count; ++context) {
+                for (u32 symbol = 0; symbol < symbol_count; ++symbol) {
+                    Array<char, 2> characters {};
+                    size_t length = 0;
+                    if (context != to_underlying(Context::StartOfInput))
+                        characters[length++] = representatives[context];
+                    auto position = length;
+                    if (symbol != end_of_input)
+                        characters[length++] = static_cast<char>(symbol);
+
+                    MatchState assertion_state;
+                    auto result = execute_opcode(bytecode, instruction_position, m_options, { characters.data(), length }, position, assertion_state);
+                    table[context][symbol] = result == ExecutionResult::Continue;
+                }
+            }
+
+            m_assertion_tables.append(table);
+            set_node(index, Node::Type::Assert, node_for(next_position, work_list), 0, m_assertion_tables.size() - 1);
+            break;
+        }
+        case OpCodeId::Jump: {
+            auto target = next_position + static_cast<OpCode_Jump const&>(opcode).offset();
+            set_node(index, Node::Type::Jump, node_for(target, work_list));
+            break;
+        }
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkReplaceJump: {
+            auto target = next_position + static_cast<OpCode_ForkJump const&>(opcode).offset();
+            auto high_priority = node_for(target, work_list);
+            set_node(index, Node::Type::Fork, high_priority, node_for(next_position, work_list));
+            break;
+        }
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceStay: {
+            auto target = next_position + static_cast<OpCode_ForkStay const&>(opcode).offset();
+            auto high_priority = node_for(next_position, work_list);
+            set_node(index, Node::Type::Fork, high_priority, node_for(target, work_list));
+            break;
+        }
+        case OpCodeId::JumpNonEmpty: {
+            // The VM only takes the jump if the loop body consumed something. Taking it after an empty iteration only
+            // leads back to nodes that were already visited in the same step, so it's always taken here.
+            auto const& jump = static_cast<OpCode_JumpNonEmpty const&>(opcode);
+            auto target = next_position + jump.offset();
+            switch (jump.form()) {
+            case OpCodeId::Jump:
+                set_node(index, Node::Type::Jump, node_for(target, work_list));
+                break;
+            case OpCodeId::ForkJump:
+            case OpCodeId::ForkReplaceJump: {
+                auto high_priority = node_for(target, work_list);
+                set_node(index, Node::Type::Fork, high_priority, node_for(next_position, work_list));
+                break;
+            }
+            case OpCodeId::ForkStay:
+            case OpCodeId::ForkReplaceStay: {
+                auto high_priority = node_for(next_position, work_list);
+                set_node(index, Node::Type::Fork, high_priority, node_for(target, work_list));
+                break;
+            }
+            default:
+                return false;
+            }
+            break;
+        }
+        case OpCodeId::Checkpoint:
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::ClearCaptureGroup:
+            set_node(index, Node::Type::Jump, node_for(next_position, work_list));
+            break;
+        case OpCodeId::Exit:
+            // Exit only succeeds past the end of the bytecode.
+            set_node(index, Node::Type::Consume, 0, 0, add_byte_set({}));
+            break;
+        case OpCodeId::Save:
+        case OpCodeId::Restore:
+        case OpCodeId::GoBack:
+        case OpCodeId::FailForks:
+        case OpCodeId::Repeat:
+        case OpCodeId::ResetRepeat:
+            return false;
+        }
+    }
+
+    m_visited.resize(m_nodes.size());
+    m_queued.resize(m_nodes.size());
+    return true;
+}
+
+LazyDFA::Context LazyDFA::context_of(u8 byte)
+{
+    if (byte == '\n' || byte == '\r')
+        return Context::LineTerminator;
+    if (is_ascii_alphanumeric(byte) || byte == '_')
+        return Context::WordCharacter;
+    return Context::Other;
+}
+
+LazyDFA::Context LazyDFA::context_before(StringView input, size_t position)
+{
+    if (position == 0)
+        return Context::StartOfInput;
+    return context_of(input[position - 1]);
+}
+
+Optional<u32> LazyDFA::state_for(StateKey&& key)
+{
+    if (auto index = m_state_indices.get(key); index.has_value())
+        return *index;
+
+    if (m_states.size() >= max_state_count)
+        return {};
+
+    u32 index = m_states.size();
+    State state { key, {} };
+    state.transitions.fill(unknown_transition);
+    m_states.append(move(state));
+    m_state_indices.set(move(key), index);
+    return index;
+}
+
+Optional<u32> LazyDFA::initial_state(Context context, bool unanchored)
+{
+    auto& initial_state = m_initial_states[to_underlying(context) + (unanchored ? context_count : 0)];
+    if (!initial_state.has_value()) {
+        // Unanchored states start a new thread at every position, so they don't need the start node in their list.
+        StateKey key { {}, context, unanchored };
+        if (!unanchored)
+            key.nodes.append(0);
+        initial_state = state_for(move(key));
+    }
+    return initial_state;
+}
+
+Optional<u32> LazyDFA::step(u32 state_index, u32 symbol)
+{
+    if (auto transition = m_states[state_index].transitions[symbol]; transition != unknown_transition)
+        return transition;
+
+    if (++m_generation == 0) {
+        m_visited.clear_with_capacity();
+        m_visited.resize(m_nodes.size());
+        m_queued.clear_with_capacity();
+        m_queued.resize(m_nodes.size());
+        m_generation = 1;
+    }
+
+    auto const& key = m_states[state_index].key;
+    auto context = to_underlying(key.context);
+
+    Vector<u32> next_nodes;
+    Vector<u32, 16> stack;
+
+    // Follows a thread through all nodes that don't consume anything, in the order of their priority. Returns true if
+    // it reaches the end of the pattern, in which case all threads with a lower priority are dropped.
+    auto follow = [&](u32 start) {
+        stack.clear_with_capacity();
+        stack.append(start);
+
+        while (!stack.is_empty()) {
+            auto index = stack.take_last();
+            if (m_visited[index] == m_generation)
+                continue;
+            m_visited[index] = m_generation;
+
+            auto const& node = m_nodes[index];
+            switch (node.type) {
+            case Node::Type::Match:
+                return true;
+            case Node::Type::Consume:
+                if (symbol != end_of_input && m_byte_sets[node.table][symbol] && m_queued[node.next] != m_generation) {
+                    m_queued[node.next] = m_generation;
+                    next_nodes.append(node.next);
+                }
+                break;
+            case Node::Type::Assert:
+                if (m_assertion_tables[node.table][context][symbol])
+                    stack.append(node.next);
+                break;
+            case Node::Type::Jump:
+                stack.append(node.next);
+                break;
+            case Node::Type::Fork:
+                stack.append(node.alternative);
+                stack.append(node.next);
+                break;
+            }
+        }
+        return false;
+    };
+
+    bool matched = false;
+    for (auto node : key.nodes) {
+        if (follow(node)) {
+            matched = true;
+            break;
+        }
+    }
+    if (!matched && key.unanchored)
+        matched = follow(0);
+
+    u32 next_state = state_index;
+    if (symbol != end_of_input) {
+        auto maybe_next_state = state_for({ move(next_nodes), context_of(symbol), key.unanchored });
+        if (!maybe_next_state.has_value())
+            return {};
+        next_state = *maybe_next_state;
+    }
+
+    u32 transition = (next_state << 1) | (matched ? 1 : 0);
+    m_states[state_index].transitions[symbol] = transition;
+    return transition;
+}
+
+void LazyDFA::give_up()
+{
+    m_states.clear();
+    m_state_indices.clear();
+    m_initial_states.fill({});
+    ++m_times_given_up;
+}
+
+LazyDFA::Result LazyDFA::find_match_end(StringView input, size_t start, size_t& match_end)
+{
+    auto state = initial_state(context_before(input, start), false);
+    if (!state.has_value()) {
+        give_up();
+        return Result::GaveUp;
+    }
+
+    Optional<size_t> end;
+    for (size_t position = start; position <= input.length(); ++position) {
+        auto symbol = position < input.length() ? static_cast<u8>(input[position]) : end_of_input;
+        auto transition = step(*state, symbol);
+        if (!transition.has_value()) {
+            give_up();
+            return Result::GaveUp;
+        }
+
+        if (*transition & 1)
+            end = position;
+
+        state = *transition >> 1;
+        if (m_states[*state].key.nodes.is_empty())
+            break;
+    }
+
+    if (!end.has_value())
+        return Result::NoMatch;
+
+    match_end = *end;
+    return Result::Match;
+}
+
+LazyDFA::Result LazyDFA::search(StringView input, size_t start)
+{
+    auto state = initial_state(context_before(input, start), true);
+    if (!state.has_value()) {
+        give_up();
+        return Result::GaveUp;
+    }
+
+    for (size_t position = start; position <= input.length(); ++position) {
+        auto symbol = position < input.length() ? static_cast<u8>(input[position]) : end_of_input;
+        auto transition = step(*state, symbol);
+        if (!transition.has_value()) {
+            give_up();
+            return Result::GaveUp;
+        }
+
+        if (*transition & 1)
+            return Result::Match;
+
+        state = *transition >> 1;
+    }
+
+    return Result::NoMatch;
+}
+
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Forward.h"
+#include "RegexOptions.h"
+
+#include <AK/Array.h>
+#include <AK/HashMap.h>
+#include <AK/NumericLimits.h>
+#include <AK/OwnPtr.h>
+#include <AK/StringView.h>
+#include <AK/Traits.h>
+#include <AK/Vector.h>
+
+namespace regex {
+
+/**
+ * A LazyDFA matches a pattern against byte strings without backtracking.
+ *
+ * The bytecode is first turned into an NFA whose nodes either consume a
+ * byte, check an assertion, fork or jump. A DFA state is the list of NFA
+ * nodes that are alive after consuming some input, ordered by the priority
+ * the backtracking VM would try them in. Threads with a lower priority than
+ * one that reached the end of the pattern are dropped, so the DFA finds the
+ * same match as the VM, only without capture groups.
+ *
+ * States and their transitions are only built when the input reaches them,
+ * and are kept for later matches. If too many states are needed, the cache
+ * is thrown away and the caller has to fall back to the VM.
+ *
+ * Patterns that need state beyond the current position in the bytecode,
+ * i.e. backreferences, lookarounds and counted repetitions, are not
+ * supported.
+ */
+class LazyDFA {
+public:
+    static OwnPtr<LazyDFA> try_create(ByteCode const&, AllOptions);
+
+    enum class Result {
+        NoMatch,
+        Match,
+        GaveUp,
+    };
+
+    // Finds the end of the match starting at `start`, which is the match the VM would find.
+    Result find_match_end(StringView input, size_t start, size_t& match_end);
+
+    // Checks whether any match starts at or after `start`.
+    Result search(StringView input, size_t start);
+
+    AllOptions options() const { return m_options; }
+    bool should_fall_back_to_vm() const { return m_times_given_up >= max_times_given_up; }
+
+private:
+    static constexpr size_t max_node_count = 4096;
+    static constexpr size_t max_state_count = 1024;
+    static constexpr size_t max_times_given_up = 4;
+
+    static constexpr u32 end_of_input = 256;
+    static constexpr size_t symbol_count = 257;
+    static constexpr u32 unknown_transition = NumericLimits<u32>::max();
+
+    // The kind of byte preceding a position, which is all that assertions need to know about the past.
+    enum class Context : u8 {
+        StartOfInput,
+        LineTerminator,
+        WordCharacter,
+        Other,
+    };
+    static constexpr size_t context_count = 4;
+
+    struct Node {
+        enum class Type : u8 {
+            Match,
+            Consume,
+            Assert,
+            Jump,
+            Fork,
+        };
+
+        Type type { Type::Match };
+        u32 next { 0 };
+        u32 alternative { 0 };
+        u32 table { 0 };
+    };
+
+    struct StateKey {
+        Vector<u32> nodes;
+        Context context { Context::StartOfInput };
+        bool unanchored { false };
+
+        bool operator==(StateKey const&) const = default;
+    };
+
+    struct StateKeyTraits : public DefaultTraits<StateKey> {
+        static unsigned hash(StateKey const&);
+    };
+
+    struct State {
+        StateKey key;
+        // Each transition holds the index of the next state, shifted left by one, with the lowest bit set if a match
+        // ends right before the symbol.
+        Array<u32, symbol_count> transitions;
+    };
+
+    explicit LazyDFA(AllOptions options)
+        : m_options(options)
+    {
+    }
+
+    bool lower(ByteCode const&);
+    u32 node_for(size_t instruction_position, Vector<size_t>& work_list);
+
+    static Context context_of(u8);
+    static Context context_before(StringView input, size_t position);
+
+    Optional<u32> state_for(StateKey&&);
+    Optional<u32> step(u32 state_index, u32 symbol);
+    Optional<u32> initial_state(Context, bool unanchored);
+    void give_up();
+
+    AllOptions m_options;
+
+    Vector<Node> m_nodes;
+    Vector<Array<bool, 256>> m_byte_sets;
+    Vector<Array<Array<bool, symbol_count>, context_count>> m_assertion_tables;
+    HashMap<size_t, u32> m_node_indices;
+
+    Vector<State> m_states;
+    HashMap<StateKey, u32, StateKeyTraits> m_state_indices;
+    Array<Optional<u32>, 2 * context_count> m_initial_states;
+    Vector<u32> m_visited;
+    Vector<u32> m_queued;
+    u32 m_generation { 0 };
+    size_t m_times_given_up { 0 };
+};
+
+}
@@ -21,6 +21,29 @@ namespace regex {
 static RegexDebug s_regex_dbg(stderr);
 #endif
 
+template<typename OptimizationData>
+static Optional<size_t> find_required_literal(StringView haystack, size_t start, OptimizationData const& optimization_data, bool insensitive)
+{
+    auto const& literals = optimization_data.required_literals;
+    if (literals.size() == 1 && !insensitive)
+        return haystack.find(literals.first(), start);
+
+    // Only look closer at bytes that one of the literals starts with.
+    auto const& first_bytes = optimization_data.required_literal_first_bytes;
+    auto case_sensitivity = insensitive ? CaseSensitivity::CaseInsensitive : CaseSensitivity::CaseSensitive;
+    for (size_t i = start; i < haystack.length(); ++i) {
+        if (!first_bytes[static_cast<u8>(haystack[i])])
+            continue;
+
+        auto rest = haystack.substring_view(i);
+        for (auto const& literal : literals) {
+            if (rest.starts_with(literal, case_sensitivity))
+                return i;
+        }
+    }
+    return {};
+}
+
 template<class Parser>
 regex::Parser::Result Regex<Parser>::parse_pattern(StringView pattern, typename ParserTraits<Parser>::OptionsType regex_options)
 {
@@ -184,6 +207,14 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
         continue_search = false;
 
     auto single_match_only = input.regex_options.has_flag_set(AllFlags::SingleMatch);
+    auto needs_capture_groups = (m_pattern->parser_result.capture_groups_count > 0 || m_pattern->parser_result.named_capture_groups_count > 0)
+        && !input.regex_options.has_flag_set(AllFlags::SkipSubExprResults);
+
+    auto const& optimization_data = m_pattern->parser_result.optimization_data;
+    auto insensitive = input.regex_options.has_flag_set(AllFlags::Insensitive);
+    // The first byte table only covers the case-insensitive variants if the pattern itself was case-insensitive.
+    auto has_required_literals = !optimization_data.required_literals.is_empty()
+        && insensitive == m_pattern->parser_result.options.has_flag_set(AllFlags::Insensitive);
 
     for (auto const& view : views) {
         if (lines_to_skip != 0) {
@@ -200,6 +231,12 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
         state.string_position_in_code_units = view_index;
         bool succeeded = false;
 
+        auto* dfa = lazy_dfa(input);
+        bool match_may_follow = false;
+
+        auto use_required_literals = has_required_literals && view.is_string_view() && !view.unicode();
+        Optional<size_t> next_required_literal;
+
         if (view_index == view_length && m_pattern->parser_result.match_length_minimum == 0) {
             // Run the code until it tries to consume something.
             // This allows non-consuming code to run on empty strings, for instance
@@ -245,6 +282,20 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             if (match_length_minimum && match_length_minimum > view_length - view_index)
                 break;
 
+            if (use_required_literals) {
+                if (!next_required_literal.has_value() || *next_required_literal < view_index) {
+                    next_required_literal = find_required_literal(view.string_view(), view_index, optimization_data, insensitive);
+                    // Any match from here on would have to contain one of the literals.
+                    if (!next_required_literal.has_value())
+                        break;
+                }
+                if (optimization_data.matches_start_with_required_literal && *next_required_literal > view_index) {
+                    if (!continue_search)
+                        break;
+                    view_index = *next_required_literal;
+                }
+            }
+
             input.column = match_count;
             input.match_index = match_count;
 
@@ -253,9 +304,44 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             state.instruction_position = 0;
             state.repetition_marks.clear();
 
-            auto success = execute(input, state, operations);
+            if (dfa && continue_search && !match_may_follow) {
+                // Don't bother trying every position if no match starts anywhere in the rest of the view.
+                auto result = dfa->search(view.string_view(), view_index);
+                if (result == LazyDFA::Result::NoMatch)
+                    break;
+                if (result == LazyDFA::Result::GaveUp)
+                    dfa = nullptr;
+                match_may_follow = true;
+            }
+
+            bool success = false;
+            if (dfa) {
+                size_t match_end = 0;
+                switch (dfa->find_match_end(view.string_view(), view_index, match_end)) {
+                case LazyDFA::Result::NoMatch:
+                    break;
+                case LazyDFA::Result::Match:
+                    if (needs_capture_groups) {
+                        // Only the VM knows where the capture groups are, but at least it only runs where a match starts.
+                        success = execute(input, state, operations);
+                    } else {
+                        state.string_position = match_end;
+                        state.string_position_in_code_units = match_end;
+                        success = true;
+                    }
+                    break;
+                case LazyDFA::Result::GaveUp:
+                    dfa = nullptr;
+                    success = execute(input, state, operations);
+                    break;
+                }
+            } else {
+                success = execute(input, state, operations);
+            }
+
             if (success) {
                 succeeded = true;
+                match_may_follow = false;
 
                 if (input.regex_options.has_flag_set(AllFlags::MatchNotEndOfLine) && state.string_position == input.view.length()) {
                     if (!continue_search)
@@ -335,6 +421,28 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
     return result;
 }
 
+template<class Parser>
+LazyDFA* Matcher<Parser>::lazy_dfa(MatchInput const& input) const
+{
+    // The DFA works on bytes, so it can't be used on UTF-16 or Unicode input.
+    if (!input.view.is_string_view() || input.view.unicode())
+        return nullptr;
+    if (m_lazy_dfa_unsupported || m_pattern->parser_result.optimization_data.pure_substring_search.has_value())
+        return nullptr;
+
+    if (!m_lazy_dfa || m_lazy_dfa->options().value() != input.regex_options.value()) {
+        m_lazy_dfa = LazyDFA::try_create(m_pattern->parser_result.bytecode, input.regex_options);
+        if (!m_lazy_dfa) {
+            m_lazy_dfa_unsupported = true;
+            return nullptr;
+        }
+    }
+
+    if (m_lazy_dfa->should_fall_back_to_vm())
+        return nullptr;
+    return m_lazy_dfa.ptr();
+}
+
 template<typename T>
 class BumpAllocatedLinkedList {
 public:
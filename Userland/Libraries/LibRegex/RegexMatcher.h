@@ -7,6 +7,7 @@
 #pragma once
 
 #include "RegexByteCode.h"
+#include "RegexDFA.h"
 #include "RegexMatch.h"
 #include "RegexOptions.h"
 #include "RegexParser.h"
@@ -74,9 +75,14 @@ public:
 
 private:
     bool execute(MatchInput const& input, MatchState& state, size_t& operations) const;
+    LazyDFA* lazy_dfa(MatchInput const&) const;
 
     Regex<Parser> const* m_pattern;
     typename ParserTraits<Parser>::OptionsType const m_regex_options;
+
+    // Built on first use, for patterns that don't need the backtracking VM.
+    mutable OwnPtr<LazyDFA> m_lazy_dfa;
+    mutable bool m_lazy_dfa_unsupported { false };
 };
 
 template<class Parser>
@@ -232,6 +238,7 @@ private:
     void run_optimization_passes();
     void attempt_rewrite_loops_as_atomic_groups(BasicBlockList const&);
     bool attempt_rewrite_entire_match_as_substring_search(BasicBlockList const&);
+    void attempt_to_find_required_literals();
 };
 
 // free standing functions for match, search and has_match
@@ -6,6 +6,7 @@
 
 #include <AK/Debug.h>
 #include <AK/Function.h>
+#include <AK/HashMap.h>
 #include <AK/Queue.h>
 #include <AK/QuickSort.h>
 #include <AK/RedBlackTree.h>
@@ -29,14 +30,18 @@ void Regex<Parser>::run_optimization_passes()
     parser_result.bytecode.flatten();
 
     auto blocks = split_basic_blocks(parser_result.bytecode);
-    if (attempt_rewrite_entire_match_as_substring_search(blocks))
+    if (attempt_rewrite_entire_match_as_substring_search(blocks)) {
+        attempt_to_find_required_literals();
         return;
+    }
 
     // Rewrite fork loops as atomic groups
     // e.g. a*b -> (ATOMIC a*)b
     attempt_rewrite_loops_as_atomic_groups(blocks);
 
     parser_result.bytecode.flatten();
+
+    attempt_to_find_required_literals();
 }
 
 template<typename Parser>
@@ -572,6 +577,243 @@ bool Regex<Parser>::attempt_rewrite_entire_match_as_substring_search(BasicBlockL
     return true;
 }
 
+template<typename Parser>
+void Regex<Parser>::attempt_to_find_required_literals()
+{
+    // Look for a set of literal strings such that every path through the bytecode matches one of them, e.g.
+    //     foo.*bar    -> { "foo" } (or { "bar" })
+    //     ERROR|WARN  -> { "ERROR", "WARN" }
+    // The matcher can then skip ahead to wherever one of them occurs, instead of trying every position.
+    static constexpr size_t max_required_literal_count = 8;
+
+    auto& bytecode = parser_result.bytecode;
+    auto bytecode_size = bytecode.size();
+
+    struct Instruction {
+        size_t position;
+        size_t next_position;
+        Vector<size_t, 2> successors;
+        bool consumes { false };
+        bool is_jump_target { false };
+        Optional<ByteString> literal;
+    };
+    Vector<Instruction> instructions;
+    HashMap<size_t, size_t> instruction_indices;
+
+    // Only ASCII literals are used, so they mean the same thing in every encoding and case-insensitive matching
+    // doesn't need Unicode case folding.
+    auto literal_of = [&](size_t position) -> Optional<ByteString> {
+        if (bytecode.at(position + 1) != 1)
+            return {};
+
+        auto type = static_cast<CharacterCompareType>(bytecode.at(position + 3));
+        if (type == CharacterCompareType::Char) {
+            auto value = bytecode.at(position + 4);
+            if (value > 0x7f)
+                return {};
+            return ByteString::repeated(static_cast<char>(value), 1);
+        }
+        if (type == CharacterCompareType::String) {
+            auto length = bytecode.at(position + 4);
+            if (length == 0)
+                return {};
+            StringBuilder builder;
+            for (size_t i = 0; i < length; ++i) {
+                auto value = bytecode.at(position + 5 + i);
+                if (value > 0x7f)
+                    return {};
+                builder.append(static_cast<char>(value));
+            }
+            return builder.to_byte_string();
+        }
+        return {};
+    };
+
+    MatchState state;
+    while (state.instruction_position < bytecode_size) {
+        auto& opcode = bytecode.get_opcode(state);
+        auto position = state.instruction_position;
+        auto next_position = position + opcode.size();
+
+        Instruction instruction { position, next_position, {}, false, false, {} };
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Compare:
+            instruction.consumes = true;
+            instruction.literal = literal_of(position);
+            instruction.successors.append(next_position);
+            break;
+        case OpCodeId::Jump:
+            instruction.successors.append(next_position + static_cast<OpCode_Jump const&>(opcode).offset());
+            break;
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkReplaceJump:
+            instruction.successors.append(next_position + static_cast<OpCode_ForkJump const&>(opcode).offset());
+            instruction.successors.append(next_position);
+            break;
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceStay:
+            instruction.successors.append(next_position + static_cast<OpCode_ForkStay const&>(opcode).offset());
+            instruction.successors.append(next_position);
+            break;
+        case OpCodeId::JumpNonEmpty:
+            instruction.successors.append(next_position + static_cast<OpCode_JumpNonEmpty const&>(opcode).offset());
+            instruction.successors.append(next_position);
+            break;
+        case OpCodeId::Repeat:
+            instruction.successors.append(position - static_cast<OpCode_Repeat const&>(opcode).offset());
+            instruction.successors.append(next_position);
+            break;
+        case OpCodeId::Exit:
+            break;
+        case OpCodeId::Save:
+        case OpCodeId::Restore:
+        case OpCodeId::GoBack:
+            // Lookarounds can match input outside of the match itself.
+            return;
+        default:
+            instruction.successors.append(next_position);
+            break;
+        }
+
+        instruction_indices.set(position, instructions.size());
+        instructions.append(move(instruction));
+        state.instruction_position = next_position;
+    }
+
+    for (auto const& instruction : instructions) {
+        for (auto successor : instruction.successors) {
+            if (successor == instruction.next_position)
+                continue;
+            if (auto index = instruction_indices.get(successor); index.has_value())
+                instructions[*index].is_jump_target = true;
+        }
+    }
+
+    // A run of literal compares that can only be entered at its start always matches all of them in a row.
+    struct Run {
+        size_t start;
+        ByteString literal;
+    };
+    Vector<Run> runs;
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        if (!instructions[i].literal.has_value())
+            continue;
+
+        StringBuilder builder;
+        builder.append(*instructions[i].literal);
+        auto start = i;
+        while (i + 1 < instructions.size() && instructions[i + 1].literal.has_value() && !instructions[i + 1].is_jump_target)
+            builder.append(*instructions[++i].literal);
+        runs.append({ start, builder.to_byte_string() });
+    }
+
+    if (runs.is_empty())
+        return;
+
+    Vector<bool> blocked;
+    blocked.resize(instructions.size());
+    Vector<bool> visited;
+    Vector<size_t> work_list;
+
+    // Walks the bytecode without passing through a blocked instruction, returns false if `should_stop` is ever true.
+    auto walk = [&](auto should_stop) {
+        visited.clear_with_capacity();
+        visited.resize(instructions.size());
+        work_list.clear_with_capacity();
+        work_list.append(0);
+        while (!work_list.is_empty()) {
+            auto position = work_list.take_last();
+            auto index = instruction_indices.get(position);
+            if (!index.has_value()) {
+                // This is the end of the bytecode.
+                if (should_stop(nullptr))
+                    return false;
+                continue;
+            }
+            if (visited[*index] || blocked[*index])
+                continue;
+            visited[*index] = true;
+            if (should_stop(&instructions[*index]))
+                return false;
+            work_list.extend(instructions[*index].successors);
+        }
+        return true;
+    };
+
+    auto every_match_passes_through_blocked_runs = [&] {
+        return walk([](Instruction const* instruction) { return instruction == nullptr; });
+    };
+    auto every_match_starts_with_blocked_runs = [&] {
+        return walk([](Instruction const* instruction) { return instruction == nullptr || instruction->consumes; });
+    };
+
+    Optional<size_t> best_run;
+    bool best_run_is_prefix = false;
+    for (size_t i = 0; i < runs.size(); ++i) {
+        blocked[runs[i].start] = true;
+        if (every_match_passes_through_blocked_runs()) {
+            auto is_prefix = every_match_starts_with_blocked_runs();
+            auto length = runs[i].literal.length();
+            if (!best_run.has_value() || length > runs[*best_run].literal.length() || (length == runs[*best_run].literal.length() && is_prefix && !best_run_is_prefix)) {
+                best_run = i;
+                best_run_is_prefix = is_prefix;
+            }
+        }
+        blocked[runs[i].start] = false;
+    }
+
+    Vector<size_t> chosen_runs;
+    if (best_run.has_value()) {
+        chosen_runs.append(*best_run);
+    } else {
+        // No single literal is required, see if a few of them together are. Try dropping the shortest ones first.
+        for (auto& run : runs)
+            blocked[run.start] = true;
+        if (!every_match_passes_through_blocked_runs())
+            return;
+
+        Vector<size_t> run_order;
+        for (size_t i = 0; i < runs.size(); ++i)
+            run_order.append(i);
+        quick_sort(run_order, [&](auto a, auto b) { return runs[a].literal.length() < runs[b].literal.length(); });
+
+        for (auto i : run_order) {
+            blocked[runs[i].start] = false;
+            if (!every_match_passes_through_blocked_runs())
+                blocked[runs[i].start] = true;
+        }
+
+        for (size_t i = 0; i < runs.size(); ++i) {
+            if (blocked[runs[i].start])
+                chosen_runs.append(i);
+        }
+        if (chosen_runs.size() > max_required_literal_count)
+            return;
+    }
+
+    for (auto& run : runs)
+        blocked[run.start] = false;
+    for (auto i : chosen_runs)
+        blocked[runs[i].start] = true;
+
+    auto& optimization_data = parser_result.optimization_data;
+    optimization_data.matches_start_with_required_literal = every_match_starts_with_blocked_runs();
+
+    auto insensitive = parser_result.options.has_flag_set(AllFlags::Insensitive);
+    for (auto i : chosen_runs) {
+        auto const& literal = runs[i].literal;
+        auto first_byte = static_cast<u8>(literal[0]);
+        optimization_data.required_literal_first_bytes[first_byte] = true;
+        if (insensitive) {
+            optimization_data.required_literal_first_bytes[to_ascii_lowercase(first_byte)] = true;
+            optimization_data.required_literal_first_bytes[to_ascii_uppercase(first_byte)] = true;
+        }
+        optimization_data.required_literals.append(literal);
+    }
+
+    dbgln_if(REGEX_DEBUG, "Required literals: {} (prefix: {})", optimization_data.required_literals, optimization_data.matches_start_with_required_literal);
+}
+
 template<typename Parser>
 void Regex<Parser>::attempt_rewrite_loops_as_atomic_groups(BasicBlockList const& basic_blocks)
 {
@@ -11,6 +11,7 @@
 #include "RegexLexer.h"
 #include "RegexOptions.h"
 
+#include <AK/Array.h>
 #include <AK/Forward.h>
 #include <AK/StringBuilder.h>
 #include <AK/Types.h>
@@ -58,6 +59,12 @@ public:
 
         struct {
             Optional<ByteString> pure_substring_search;
+
+            // Every match contains one of these literals, so input that contains none of them can be skipped.
+            Vector<ByteString> required_literals;
+            // Every match also starts with one of the required literals.
+            bool matches_start_with_required_literal { false };
+            Array<bool, 256> required_literal_first_bytes {};
         } optimization_data {};
     };
 
@@ -765,6 +765,12 @@ public:
     {
         return Result { SQLCommand::Unknown, SQLErrorCode::NotYetImplemented };
     }
+
+    // Describes how the statement accesses its tables. This is what EXPLAIN shows.
+    virtual ResultOr<Vector<ByteString>> query_plan(ExecutionContext&) const
+    {
+        return Result { SQLCommand::Explain, SQLErrorCode::NotYetImplemented, "EXPLAIN is only supported for SELECT, UPDATE, and DELETE statements"sv };
+    }
 };
 
 class ErrorStatement final : public Statement {
@@ -831,6 +837,36 @@ private:
     bool m_is_error_if_table_exists;
 };
 
+class CreateIndex : public Statement {
+public:
+    CreateIndex(ByteString schema_name, ByteString index_name, ByteString table_name, Vector<ByteString> column_names, bool is_unique, bool is_error_if_index_exists)
+        : m_schema_name(move(schema_name))
+        , m_index_name(move(index_name))
+        , m_table_name(move(table_name))
+        , m_column_names(move(column_names))
+        , m_is_unique(is_unique)
+        , m_is_error_if_index_exists(is_error_if_index_exists)
+    {
+    }
+
+    ByteString const& schema_name() const { return m_schema_name; }
+    ByteString const& index_name() const { return m_index_name; }
+    ByteString const& table_name() const { return m_table_name; }
+    Vector<ByteString> const& column_names() const { return m_column_names; }
+    bool is_unique() const { return m_is_unique; }
+    bool is_error_if_index_exists() const { return m_is_error_if_index_exists; }
+
+    ResultOr<ResultSet> execute(ExecutionContext&) const override;
+
+private:
+    ByteString m_schema_name;
+    ByteString m_index_name;
+    ByteString m_table_name;
+    Vector<ByteString> m_column_names;
+    bool m_is_unique;
+    bool m_is_error_if_index_exists;
+};
+
 class AlterTable : public Statement {
 public:
     ByteString const& schema_name() const { return m_schema_name; }
@@ -926,6 +962,27 @@ private:
     bool m_is_error_if_table_does_not_exist;
 };
 
+class DropIndex : public Statement {
+public:
+    DropIndex(ByteString schema_name, ByteString index_name, bool is_error_if_index_does_not_exist)
+        : m_schema_name(move(schema_name))
+        , m_index_name(move(index_name))
+        , m_is_error_if_index_does_not_exist(is_error_if_index_does_not_exist)
+    {
+    }
+
+    ByteString const& schema_name() const { return m_schema_name; }
+    ByteString const& index_name() const { return m_index_name; }
+    bool is_error_if_index_does_not_exist() const { return m_is_error_if_index_does_not_exist; }
+
+    ResultOr<ResultSet> execute(ExecutionContext&) const override;
+
+private:
+    ByteString m_schema_name;
+    ByteString m_index_name;
+    bool m_is_error_if_index_does_not_exist;
+};
+
 enum class ConflictResolution {
     Abort,
     Fail,
@@ -1023,6 +1080,7 @@ public:
     RefPtr<ReturningClause> const& returning_clause() const { return m_returning_clause; }
 
     virtual ResultOr<ResultSet> execute(ExecutionContext&) const override;
+    virtual ResultOr<Vector<ByteString>> query_plan(ExecutionContext&) const override;
 
 private:
     RefPtr<CommonTableExpressionList> m_common_table_expression_list;
@@ -1050,6 +1108,7 @@ public:
     RefPtr<ReturningClause> const& returning_clause() const { return m_returning_clause; }
 
     virtual ResultOr<ResultSet> execute(ExecutionContext&) const override;
+    virtual ResultOr<Vector<ByteString>> query_plan(ExecutionContext&) const override;
 
 private:
     RefPtr<CommonTableExpressionList> m_common_table_expression_list;
@@ -1081,6 +1140,10 @@ public:
     Vector<NonnullRefPtr<OrderingTerm>> const& ordering_term_list() const { return m_ordering_term_list; }
     RefPtr<LimitClause> const& limit_clause() const { return m_limit_clause; }
     ResultOr<ResultSet> execute(ExecutionContext&) const override;
+    ResultOr<Vector<ByteString>> query_plan(ExecutionContext&) const override;
+
+    // Builds the operators producing the rows of the result set one at a time.
+    ResultOr<NonnullOwnPtr<Operator>> create_operator(ExecutionContext&, Vector<ByteString>& column_names) const;
 
 private:
     RefPtr<CommonTableExpressionList> m_common_table_expression_list;
@@ -1107,4 +1170,18 @@ private:
     NonnullRefPtr<QualifiedTableName> m_qualified_table_name;
 };
 
+class Explain : public Statement {
+public:
+    explicit Explain(NonnullRefPtr<Statement> statement)
+        : m_statement(move(statement))
+    {
+    }
+
+    NonnullRefPtr<Statement> const& statement() const { return m_statement; }
+    ResultOr<ResultSet> execute(ExecutionContext&) const override;
+
+private:
+    NonnullRefPtr<Statement> m_statement;
+};
+
 }
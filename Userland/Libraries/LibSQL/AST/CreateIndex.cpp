@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Meta.h>
+
+namespace SQL::AST {
+
+ResultOr<ResultSet> CreateIndex::execute(ExecutionContext& context) const
+{
+    auto table_def = TRY(context.database->get_table(m_schema_name, m_table_name));
+    auto index_def = TRY(IndexDef::create(table_def.ptr(), m_index_name, m_is_unique));
+
+    for (auto const& column_name : m_column_names) {
+        auto column = table_def->columns().first_matching([&](auto const& column) { return column->name() == column_name; });
+        if (!column.has_value())
+            return Result { SQLCommand::Create, SQLErrorCode::ColumnDoesNotExist, column_name };
+
+        index_def->append_column(column_name, (*column)->type());
+    }
+
+    if (auto result = context.database->add_index(*index_def); result.is_error()) {
+        if (result.error().error() != SQLErrorCode::IndexExists || m_is_error_if_index_exists)
+            return result.release_error();
+    }
+
+    return ResultSet { SQLCommand::Create };
+}
+
+}
@@ -5,21 +5,29 @@
  */
 
 #include <LibSQL/AST/AST.h>
+#include <LibSQL/AST/QueryPlan.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Meta.h>
 #include <LibSQL/Row.h>
 
 namespace SQL::AST {
 
+ResultOr<Vector<ByteString>> Delete::query_plan(ExecutionContext& context) const
+{
+    auto plan = TRY(TableAccessPlan::create(context, m_qualified_table_name, where_clause()));
+
+    Vector<ByteString> lines;
+    TRY(lines.try_append(plan.to_byte_string()));
+    return lines;
+}
+
 ResultOr<ResultSet> Delete::execute(ExecutionContext& context) const
 {
-    auto const& schema_name = m_qualified_table_name->schema_name();
-    auto const& table_name = m_qualified_table_name->table_name();
-    auto table_def = TRY(context.database->get_table(schema_name, table_name));
+    auto plan = TRY(TableAccessPlan::create(context, m_qualified_table_name, where_clause()));
 
     ResultSet result { SQLCommand::Delete };
 
-    for (auto& table_row : TRY(context.database->select_all(*table_def))) {
+    for (auto& table_row : TRY(plan.fetch_rows(*context.database))) {
         context.current_row = &table_row;
 
         if (auto const& where_clause = this->where_clause()) {
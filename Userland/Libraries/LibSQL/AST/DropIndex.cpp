@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Meta.h>
+
+namespace SQL::AST {
+
+ResultOr<ResultSet> DropIndex::execute(ExecutionContext& context) const
+{
+    auto index_def = context.database->get_index(m_schema_name, m_index_name);
+    if (index_def.is_error()) {
+        if (index_def.error().error() != SQLErrorCode::IndexDoesNotExist || m_is_error_if_index_does_not_exist)
+            return index_def.release_error();
+        return ResultSet { SQLCommand::Drop };
+    }
+
+    TRY(context.database->remove_index(*index_def.value()));
+    return ResultSet { SQLCommand::Drop };
+}
+
+}
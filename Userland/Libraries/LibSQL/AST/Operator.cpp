@@ -0,0 +1,324 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/AST/Operator.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/Row.h>
+
+namespace SQL::AST {
+
+static ResultOr<bool> row_matches(ExecutionContext& context, Tuple& row, Vector<NonnullRefPtr<Expression const>> const& filters)
+{
+    context.current_row = &row;
+
+    for (auto const& filter : filters) {
+        auto result = TRY(filter->evaluate(context)).to_bool();
+        if (!result.has_value() || !result.value())
+            return false;
+    }
+
+    return true;
+}
+
+static ResultOr<Value> evaluate_column(ExecutionContext& context, Tuple& row, ColumnNameExpression const& column)
+{
+    context.current_row = &row;
+    return column.evaluate(context);
+}
+
+// Rows read from storage don't know which table they belong to, so qualified column names wouldn't
+// resolve against them.
+static Tuple with_descriptor(NonnullRefPtr<TupleDescriptor> const& descriptor, Tuple const& row)
+{
+    Tuple tuple(descriptor);
+    tuple.clear();
+    tuple.extend(row);
+    return tuple;
+}
+
+static Tuple join_rows(NonnullRefPtr<TupleDescriptor> const& descriptor, Tuple const& outer_row, Tuple const& inner_row)
+{
+    Tuple tuple(descriptor);
+    tuple.clear();
+    tuple.extend(outer_row);
+    tuple.extend(inner_row);
+    return tuple;
+}
+
+static ResultOr<Vector<Tuple>> read_all_rows(ExecutionContext& context, Operator& input)
+{
+    Vector<Tuple> rows;
+    while (true) {
+        auto row = TRY(input.next(context));
+        if (!row.has_value())
+            return rows;
+        TRY(rows.try_append(row.release_value()));
+    }
+}
+
+ResultOr<Optional<Tuple>> SingleRow::next(ExecutionContext&)
+{
+    if (m_done)
+        return Optional<Tuple> {};
+
+    m_done = true;
+    return Tuple {};
+}
+
+TableScan::TableScan(TableAccessPlan plan)
+    : m_plan(move(plan))
+    , m_descriptor(m_plan.table().to_tuple_descriptor())
+{
+}
+
+ResultOr<Optional<Tuple>> TableScan::next(ExecutionContext& context)
+{
+    if (!m_cursor.has_value())
+        m_cursor = TRY(m_plan.open(*context.database));
+
+    auto row = TRY(m_cursor->next());
+    if (!row.has_value())
+        return Optional<Tuple> {};
+
+    return with_descriptor(m_descriptor, *row);
+}
+
+Filter::Filter(NonnullOwnPtr<Operator> input, Vector<NonnullRefPtr<Expression const>> filters)
+    : m_input(move(input))
+    , m_filters(move(filters))
+{
+}
+
+ResultOr<Optional<Tuple>> Filter::next(ExecutionContext& context)
+{
+    while (true) {
+        auto row = TRY(m_input->next(context));
+        if (!row.has_value() || TRY(row_matches(context, *row, m_filters)))
+            return row;
+    }
+}
+
+NestedLoopJoin::NestedLoopJoin(NonnullOwnPtr<Operator> outer, NonnullOwnPtr<Operator> inner, NonnullRefPtr<TupleDescriptor> descriptor)
+    : m_outer(move(outer))
+    , m_inner(move(inner))
+    , m_descriptor(move(descriptor))
+{
+}
+
+ResultOr<Optional<Tuple>> NestedLoopJoin::next(ExecutionContext& context)
+{
+    if (!m_inner_rows.has_value())
+        m_inner_rows = TRY(read_all_rows(context, *m_inner));
+    if (m_inner_rows->is_empty())
+        return Optional<Tuple> {};
+
+    if (!m_outer_row.has_value() || m_next_inner_row == m_inner_rows->size()) {
+        m_outer_row = TRY(m_outer->next(context));
+        if (!m_outer_row.has_value())
+            return Optional<Tuple> {};
+        m_next_inner_row = 0;
+    }
+
+    return join_rows(m_descriptor, *m_outer_row, m_inner_rows->at(m_next_inner_row++));
+}
+
+HashJoin::HashJoin(NonnullOwnPtr<Operator> outer, NonnullOwnPtr<Operator> inner, NonnullRefPtr<ColumnNameExpression const> outer_column, NonnullRefPtr<ColumnNameExpression const> inner_column, NonnullRefPtr<TupleDescriptor> descriptor)
+    : m_outer(move(outer))
+    , m_inner(move(inner))
+    , m_outer_column(move(outer_column))
+    , m_inner_column(move(inner_column))
+    , m_descriptor(move(descriptor))
+{
+}
+
+ResultOr<void> HashJoin::build_hash_table(ExecutionContext& context)
+{
+    m_inner_rows = TRY(read_all_rows(context, *m_inner));
+
+    for (size_t ix = 0; ix < m_inner_rows.size(); ix++) {
+        auto value = TRY(evaluate_column(context, m_inner_rows[ix], m_inner_column));
+
+        // NULL is never equal to anything.
+        if (value.is_null())
+            continue;
+
+        TRY(m_hash_table.ensure(value.hash()).try_append(ix));
+    }
+
+    m_built = true;
+    return {};
+}
+
+ResultOr<Optional<Tuple>> HashJoin::next(ExecutionContext& context)
+{
+    if (!m_built)
+        TRY(build_hash_table(context));
+
+    while (true) {
+        if (m_candidates && m_next_candidate < m_candidates->size())
+            return join_rows(m_descriptor, *m_outer_row, m_inner_rows[m_candidates->at(m_next_candidate++)]);
+
+        m_outer_row = TRY(m_outer->next(context));
+        if (!m_outer_row.has_value())
+            return Optional<Tuple> {};
+
+        m_candidates = nullptr;
+        m_next_candidate = 0;
+
+        auto value = TRY(evaluate_column(context, *m_outer_row, m_outer_column));
+        if (value.is_null())
+            continue;
+
+        if (auto it = m_hash_table.find(value.hash()); it != m_hash_table.end())
+            m_candidates = &it->value;
+    }
+}
+
+IndexJoin::IndexJoin(NonnullOwnPtr<Operator> outer, NonnullRefPtr<TableDef> table, NonnullRefPtr<IndexDef> index, NonnullRefPtr<ColumnNameExpression const> outer_column, Vector<NonnullRefPtr<Expression const>> inner_filters, NonnullRefPtr<TupleDescriptor> descriptor)
+    : m_outer(move(outer))
+    , m_table(move(table))
+    , m_index(move(index))
+    , m_outer_column(move(outer_column))
+    , m_inner_filters(move(inner_filters))
+    , m_table_descriptor(m_table->to_tuple_descriptor())
+    , m_descriptor(move(descriptor))
+{
+}
+
+ResultOr<Optional<Tuple>> IndexJoin::next(ExecutionContext& context)
+{
+    while (true) {
+        if (m_cursor.has_value()) {
+            while (true) {
+                auto row = TRY(m_cursor->next());
+                if (!row.has_value())
+                    break;
+
+                auto inner_row = with_descriptor(m_table_descriptor, *row);
+                if (TRY(row_matches(context, inner_row, m_inner_filters)))
+                    return join_rows(m_descriptor, *m_outer_row, inner_row);
+            }
+
+            m_cursor.clear();
+        }
+
+        m_outer_row = TRY(m_outer->next(context));
+        if (!m_outer_row.has_value())
+            return Optional<Tuple> {};
+
+        auto value = TRY(evaluate_column(context, *m_outer_row, m_outer_column));
+        if (value.is_null())
+            continue;
+
+        Vector<Value> prefix;
+        TRY(prefix.try_append(move(value)));
+        m_cursor = TRY(context.database->scan_index(m_table, m_index, move(prefix), {}, {}));
+    }
+}
+
+Sort::Sort(NonnullOwnPtr<Operator> input, Vector<NonnullRefPtr<OrderingTerm>> ordering_terms)
+    : m_input(move(input))
+    , m_ordering_terms(move(ordering_terms))
+{
+}
+
+ResultOr<Optional<Tuple>> Sort::next(ExecutionContext& context)
+{
+    if (!m_rows.has_value()) {
+        m_rows = ResultSet { SQLCommand::Select };
+
+        auto sort_descriptor = adopt_ref(*new TupleDescriptor);
+        for (auto const& term : m_ordering_terms)
+            sort_descriptor->append(TupleElementDescriptor { .order = term->order() });
+
+        while (true) {
+            auto row = TRY(m_input->next(context));
+            if (!row.has_value())
+                break;
+
+            Tuple sort_key(sort_descriptor);
+            sort_key.clear();
+
+            context.current_row = &row.value();
+            for (auto const& term : m_ordering_terms)
+                sort_key.append(TRY(term->expression()->evaluate(context)));
+
+            m_rows->insert_row(*row, sort_key);
+        }
+    }
+
+    if (m_next_row == m_rows->size())
+        return Optional<Tuple> {};
+
+    return move(m_rows->at(m_next_row++).row);
+}
+
+Limit::Limit(NonnullOwnPtr<Operator> input, size_t offset, size_t limit)
+    : m_input(move(input))
+    , m_offset(offset)
+    , m_limit(limit)
+{
+}
+
+ResultOr<Optional<Tuple>> Limit::next(ExecutionContext& context)
+{
+    for (; m_offset > 0; --m_offset) {
+        if (!TRY(m_input->next(context)).has_value())
+            return Optional<Tuple> {};
+    }
+
+    if (m_produced == m_limit)
+        return Optional<Tuple> {};
+
+    auto row = TRY(m_input->next(context));
+    if (row.has_value())
+        ++m_produced;
+    return row;
+}
+
+Project::Project(NonnullOwnPtr<Operator> input, Vector<NonnullRefPtr<ResultColumn const>> columns)
+    : m_input(move(input))
+    , m_columns(move(columns))
+    , m_descriptor(adopt_ref(*new TupleDescriptor))
+{
+}
+
+ResultOr<Optional<Tuple>> Project::next(ExecutionContext& context)
+{
+    auto row = TRY(m_input->next(context));
+    if (!row.has_value())
+        return Optional<Tuple> {};
+
+    context.current_row = &row.value();
+
+    Tuple result(m_descriptor);
+    result.clear();
+    for (auto const& column : m_columns)
+        result.append(TRY(column->expression()->evaluate(context)));
+
+    return result;
+}
+
+Cursor::Cursor(NonnullRefPtr<Database> database, NonnullRefPtr<Select const> statement, Vector<Value> placeholder_values)
+    : m_statement(move(statement))
+    , m_placeholder_values(move(placeholder_values))
+    , m_context { move(database), m_statement.ptr(), m_placeholder_values.span(), nullptr }
+{
+}
+
+ResultOr<NonnullOwnPtr<Cursor>> Cursor::create(NonnullRefPtr<Database> database, NonnullRefPtr<Select const> statement, Vector<Value> placeholder_values)
+{
+    auto cursor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) Cursor(move(database), move(statement), move(placeholder_values))));
+    cursor->m_root = TRY(cursor->m_statement->create_operator(cursor->m_context, cursor->m_column_names));
+    return cursor;
+}
+
+ResultOr<Optional<Tuple>> Cursor::next()
+{
+    return m_root->next(m_context);
+}
+
+}
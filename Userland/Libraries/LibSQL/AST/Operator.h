@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteString.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/AST/QueryPlan.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Forward.h>
+#include <LibSQL/Result.h>
+#include <LibSQL/ResultSet.h>
+#include <LibSQL/Tuple.h>
+
+namespace SQL::AST {
+
+/**
+ * Operators produce the rows of a SELECT statement one at a time. Every
+ * operator pulls the rows it needs from its input operators, so rows are
+ * only read from the database as far as the consumer of the result asks
+ * for them. Only sorting and the inner side of joins need all of their
+ * input rows at once.
+ */
+class Operator {
+public:
+    virtual ~Operator() = default;
+
+    // Returns the next row, or an empty Optional once all rows have been produced.
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) = 0;
+};
+
+// Produces a single row without any columns, for SELECT statements that don't read any table.
+class SingleRow final : public Operator {
+public:
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    bool m_done { false };
+};
+
+// Produces the rows of a table, read according to a TableAccessPlan.
+class TableScan final : public Operator {
+public:
+    explicit TableScan(TableAccessPlan);
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    TableAccessPlan m_plan;
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+    Optional<RowCursor> m_cursor;
+};
+
+// Produces the rows of its input for which all filter expressions evaluate to true.
+class Filter final : public Operator {
+public:
+    Filter(NonnullOwnPtr<Operator> input, Vector<NonnullRefPtr<Expression const>> filters);
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    Vector<NonnullRefPtr<Expression const>> m_filters;
+};
+
+// Combines every row of the outer input with every row of the inner input.
+class NestedLoopJoin final : public Operator {
+public:
+    NestedLoopJoin(NonnullOwnPtr<Operator> outer, NonnullOwnPtr<Operator> inner, NonnullRefPtr<TupleDescriptor> descriptor);
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_outer;
+    NonnullOwnPtr<Operator> m_inner;
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+
+    Optional<Vector<Tuple>> m_inner_rows;
+    Optional<Tuple> m_outer_row;
+    size_t m_next_inner_row { 0 };
+};
+
+// Combines the rows of the outer and inner input for which the given columns hash to the same value.
+// The rows still have to be filtered by the join condition itself.
+class HashJoin final : public Operator {
+public:
+    HashJoin(NonnullOwnPtr<Operator> outer, NonnullOwnPtr<Operator> inner, NonnullRefPtr<ColumnNameExpression const> outer_column, NonnullRefPtr<ColumnNameExpression const> inner_column, NonnullRefPtr<TupleDescriptor> descriptor);
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    ResultOr<void> build_hash_table(ExecutionContext&);
+
+    NonnullOwnPtr<Operator> m_outer;
+    NonnullOwnPtr<Operator> m_inner;
+    NonnullRefPtr<ColumnNameExpression const> m_outer_column;
+    NonnullRefPtr<ColumnNameExpression const> m_inner_column;
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+
+    bool m_built { false };
+    Vector<Tuple> m_inner_rows;
+    HashMap<u32, Vector<size_t>> m_hash_table;
+
+    Optional<Tuple> m_outer_row;
+    Vector<size_t> const* m_candidates { nullptr };
+    size_t m_next_candidate { 0 };
+};
+
+// Combines every row of the outer input with the rows of a table found by looking up the value of
+// a column of the outer row in an index of the table.
+class IndexJoin final : public Operator {
+public:
+    IndexJoin(NonnullOwnPtr<Operator> outer, NonnullRefPtr<TableDef>, NonnullRefPtr<IndexDef>, NonnullRefPtr<ColumnNameExpression const> outer_column, Vector<NonnullRefPtr<Expression const>> inner_filters, NonnullRefPtr<TupleDescriptor> descriptor);
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_outer;
+    NonnullRefPtr<TableDef> m_table;
+    NonnullRefPtr<IndexDef> m_index;
+    NonnullRefPtr<ColumnNameExpression const> m_outer_column;
+    Vector<NonnullRefPtr<Expression const>> m_inner_filters;
+    NonnullRefPtr<TupleDescriptor> m_table_descriptor;
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+
+    Optional<Tuple> m_outer_row;
+    Optional<RowCursor> m_cursor;
+};
+
+// Produces the rows of its input ordered by the ORDER BY clause.
+class Sort final : public Operator {
+public:
+    Sort(NonnullOwnPtr<Operator> input, Vector<NonnullRefPtr<OrderingTerm>> ordering_terms);
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    Vector<NonnullRefPtr<OrderingTerm>> m_ordering_terms;
+
+    Optional<ResultSet> m_rows;
+    size_t m_next_row { 0 };
+};
+
+// Skips the first rows of its input, and stops reading it once enough rows have been produced.
+class Limit final : public Operator {
+public:
+    Limit(NonnullOwnPtr<Operator> input, size_t offset, size_t limit);
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    size_t m_offset { 0 };
+    size_t m_limit { 0 };
+    size_t m_produced { 0 };
+};
+
+// Evaluates the result columns of a SELECT statement on the rows of its input.
+class Project final : public Operator {
+public:
+    Project(NonnullOwnPtr<Operator> input, Vector<NonnullRefPtr<ResultColumn const>> columns);
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    Vector<NonnullRefPtr<ResultColumn const>> m_columns;
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+};
+
+/**
+ * A Cursor executes a SELECT statement and hands out its result rows as
+ * they are requested, instead of collecting all of them in a ResultSet.
+ */
+class Cursor {
+public:
+    static ResultOr<NonnullOwnPtr<Cursor>> create(NonnullRefPtr<Database>, NonnullRefPtr<Select const>, Vector<Value> placeholder_values);
+
+    Vector<ByteString> const& column_names() const { return m_column_names; }
+
+    // Returns the next result row, or an empty Optional once all rows have been produced.
+    ResultOr<Optional<Tuple>> next();
+
+private:
+    Cursor(NonnullRefPtr<Database>, NonnullRefPtr<Select const>, Vector<Value> placeholder_values);
+
+    NonnullRefPtr<Select const> m_statement;
+    Vector<Value> m_placeholder_values;
+    ExecutionContext m_context;
+
+    OwnPtr<Operator> m_root;
+    Vector<ByteString> m_column_names;
+};
+
+}
@@ -41,14 +41,22 @@ NonnullRefPtr<Statement> Parser::parse_statement()
         consume();
         if (match(TokenType::Schema))
             return parse_create_schema_statement();
+        else if (match(TokenType::Unique) || match(TokenType::Index))
+            return parse_create_index_statement();
         else
             return parse_create_table_statement();
     case TokenType::Alter:
         return parse_alter_table_statement();
     case TokenType::Drop:
-        return parse_drop_table_statement();
+        consume();
+        if (match(TokenType::Index))
+            return parse_drop_index_statement();
+        else
+            return parse_drop_table_statement();
     case TokenType::Describe:
         return parse_describe_table_statement();
+    case TokenType::Explain:
+        return parse_explain_statement();
     case TokenType::Insert:
         return parse_insert_statement({});
     case TokenType::Update:
@@ -58,7 +66,7 @@ NonnullRefPtr<Statement> Parser::parse_statement()
     case TokenType::Select:
         return parse_select_statement({});
     default:
-        expected("CREATE, ALTER, DROP, DESCRIBE, INSERT, UPDATE, DELETE, or SELECT"sv);
+        expected("CREATE, ALTER, DROP, DESCRIBE, EXPLAIN, INSERT, UPDATE, DELETE, or SELECT"sv);
         return create_ast_node<ErrorStatement>();
     }
 }
@@ -129,6 +137,42 @@ NonnullRefPtr<CreateTable> Parser::parse_create_table_statement()
     return create_ast_node<CreateTable>(move(schema_name), move(table_name), move(column_definitions), is_temporary, is_error_if_table_exists);
 }
 
+NonnullRefPtr<CreateIndex> Parser::parse_create_index_statement()
+{
+    // https://sqlite.org/lang_createindex.html
+
+    bool is_unique = consume_if(TokenType::Unique);
+    consume(TokenType::Index);
+
+    bool is_error_if_index_exists = true;
+    if (consume_if(TokenType::If)) {
+        consume(TokenType::Not);
+        consume(TokenType::Exists);
+        is_error_if_index_exists = false;
+    }
+
+    ByteString schema_name;
+    ByteString index_name;
+    parse_schema_and_table_name(schema_name, index_name);
+
+    consume(TokenType::On);
+    ByteString table_name = consume(TokenType::Identifier).value();
+
+    Vector<ByteString> column_names;
+    parse_comma_separated_list(true, [&]() {
+        column_names.append(consume(TokenType::Identifier).value());
+
+        // FIXME: Support descending indexes.
+        consume_if(TokenType::Asc);
+        if (consume_if(TokenType::Desc))
+            syntax_error("Descending index columns are not supported");
+    });
+
+    // FIXME: Parse partial indexes, i.e. "WHERE expr".
+
+    return create_ast_node<CreateIndex>(move(schema_name), move(index_name), move(table_name), move(column_names), is_unique, is_error_if_index_exists);
+}
+
 NonnullRefPtr<AlterTable> Parser::parse_alter_table_statement()
 {
     // https://sqlite.org/lang_altertable.html
@@ -168,7 +212,6 @@ NonnullRefPtr<AlterTable> Parser::parse_alter_table_statement()
 NonnullRefPtr<DropTable> Parser::parse_drop_table_statement()
 {
     // https://sqlite.org/lang_droptable.html
-    consume(TokenType::Drop);
     consume(TokenType::Table);
 
     bool is_error_if_table_does_not_exist = true;
@@ -184,6 +227,24 @@ NonnullRefPtr<DropTable> Parser::parse_drop_table_statement()
     return create_ast_node<DropTable>(move(schema_name), move(table_name), is_error_if_table_does_not_exist);
 }
 
+NonnullRefPtr<DropIndex> Parser::parse_drop_index_statement()
+{
+    // https://sqlite.org/lang_dropindex.html
+    consume(TokenType::Index);
+
+    bool is_error_if_index_does_not_exist = true;
+    if (consume_if(TokenType::If)) {
+        consume(TokenType::Exists);
+        is_error_if_index_does_not_exist = false;
+    }
+
+    ByteString schema_name;
+    ByteString index_name;
+    parse_schema_and_table_name(schema_name, index_name);
+
+    return create_ast_node<DropIndex>(move(schema_name), move(index_name), is_error_if_index_does_not_exist);
+}
+
 NonnullRefPtr<DescribeTable> Parser::parse_describe_table_statement()
 {
     consume(TokenType::Describe);
@@ -194,6 +255,18 @@ NonnullRefPtr<DescribeTable> Parser::parse_describe_table_statement()
     return create_ast_node<DescribeTable>(move(table_name));
 }
 
+NonnullRefPtr<Explain> Parser::parse_explain_statement()
+{
+    // https://sqlite.org/lang_explain.html
+    consume(TokenType::Explain);
+
+    // EXPLAIN always shows the query plan, so "QUERY PLAN" is optional.
+    if (consume_if(TokenType::Query))
+        consume(TokenType::Plan);
+
+    return create_ast_node<Explain>(parse_statement());
+}
+
 NonnullRefPtr<Insert> Parser::parse_insert_statement(RefPtr<CommonTableExpressionList> common_table_expression_list)
 {
     // https://sqlite.org/lang_insert.html
@@ -0,0 +1,614 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/QuickSort.h>
+#include <AK/ScopeGuard.h>
+#include <AK/StdLibExtras.h>
+#include <AK/StringBuilder.h>
+#include <LibSQL/AST/Operator.h>
+#include <LibSQL/AST/QueryPlan.h>
+#include <LibSQL/Row.h>
+
+namespace SQL::AST {
+
+namespace {
+
+enum class Comparison {
+    Equals,
+    LessThan,
+    LessThanEquals,
+    GreaterThan,
+    GreaterThanEquals,
+};
+
+// A conjunct of the WHERE clause comparing a column of the planned table to a constant.
+struct ColumnConstraint {
+    ByteString column_name;
+    Comparison comparison;
+    Value value;
+};
+
+}
+
+static Optional<Comparison> comparison_for(BinaryOperator type, bool column_is_rhs)
+{
+    switch (type) {
+    case BinaryOperator::Equals:
+        return Comparison::Equals;
+    case BinaryOperator::LessThan:
+        return column_is_rhs ? Comparison::GreaterThan : Comparison::LessThan;
+    case BinaryOperator::LessThanEquals:
+        return column_is_rhs ? Comparison::GreaterThanEquals : Comparison::LessThanEquals;
+    case BinaryOperator::GreaterThan:
+        return column_is_rhs ? Comparison::LessThan : Comparison::GreaterThan;
+    case BinaryOperator::GreaterThanEquals:
+        return column_is_rhs ? Comparison::LessThanEquals : Comparison::GreaterThanEquals;
+    default:
+        return {};
+    }
+}
+
+static StringView comparison_symbol(Comparison comparison)
+{
+    switch (comparison) {
+    case Comparison::Equals:
+        return "="sv;
+    case Comparison::LessThan:
+        return "<"sv;
+    case Comparison::LessThanEquals:
+        return "<="sv;
+    case Comparison::GreaterThan:
+        return ">"sv;
+    case Comparison::GreaterThanEquals:
+        return ">="sv;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+static bool is_constant(Expression const& expression)
+{
+    if (is<NumericLiteral>(expression) || is<StringLiteral>(expression) || is<BooleanLiteral>(expression) || is<Placeholder>(expression))
+        return true;
+    if (is<UnaryOperatorExpression>(expression))
+        return is_constant(*static_cast<UnaryOperatorExpression const&>(expression).expression());
+    return false;
+}
+
+static bool is_numeric(SQLType type)
+{
+    return type == SQLType::Integer || type == SQLType::Float;
+}
+
+// Value::compare() converts the right-hand side to the type of the left-hand side, so the outcome
+// of a comparison between a column and a constant of another type depends on the side the column
+// is on. Only use constants that compare equal to their value converted to the type of the column
+// either way around, so that searching the index with the converted value finds exactly the rows
+// the WHERE clause would match.
+static Optional<Value> convert_to_column_type(Value const& value, SQLType column_type)
+{
+    if (value.is_null())
+        return {};
+    if (value.type() != column_type && !(is_numeric(value.type()) && is_numeric(column_type)))
+        return {};
+
+    Optional<Value> converted;
+    switch (column_type) {
+    case SQLType::Text:
+        converted = Value { value.to_byte_string() };
+        break;
+    case SQLType::Integer:
+        if (auto integer = value.to_int<i64>(); integer.has_value())
+            converted = Value { *integer };
+        break;
+    case SQLType::Float:
+        if (auto floating_point = value.to_double(); floating_point.has_value())
+            converted = Value { *floating_point };
+        break;
+    case SQLType::Boolean:
+        if (auto boolean = value.to_bool(); boolean.has_value())
+            converted = Value { *boolean };
+        break;
+    default:
+        break;
+    }
+
+    if (!converted.has_value() || value.compare(*converted) != 0 || converted->compare(value) != 0)
+        return {};
+    return converted;
+}
+
+static ResultOr<void> collect_constraints(ExecutionContext& context, Expression const& expression, TableDef const& table, TableAccessPlan::ColumnFilter const& column_filter, Vector<ColumnConstraint>& constraints)
+{
+    // The parser doesn't know about operator precedence, so conjuncts like "(a = 1) AND (b > 2)" have
+    // to be wrapped in parentheses. A single parenthesized expression evaluates to the truth value
+    // of that expression.
+    if (is<ChainedExpression>(expression)) {
+        auto const& expressions = static_cast<ChainedExpression const&>(expression).expressions();
+        if (expressions.size() == 1)
+            return collect_constraints(context, *expressions.first(), table, column_filter, constraints);
+        return {};
+    }
+
+    if (!is<BinaryOperatorExpression>(expression))
+        return {};
+
+    auto const& binary_expression = static_cast<BinaryOperatorExpression const&>(expression);
+    if (binary_expression.type() == BinaryOperator::And) {
+        TRY(collect_constraints(context, *binary_expression.lhs(), table, column_filter, constraints));
+        TRY(collect_constraints(context, *binary_expression.rhs(), table, column_filter, constraints));
+        return {};
+    }
+
+    bool column_is_rhs = is<ColumnNameExpression>(*binary_expression.rhs());
+    auto const& column_expression = column_is_rhs ? *binary_expression.rhs() : *binary_expression.lhs();
+    auto const& value_expression = column_is_rhs ? *binary_expression.lhs() : *binary_expression.rhs();
+    if (!is<ColumnNameExpression>(column_expression) || !is_constant(value_expression))
+        return {};
+
+    auto comparison = comparison_for(binary_expression.type(), column_is_rhs);
+    if (!comparison.has_value())
+        return {};
+
+    auto const& column = static_cast<ColumnNameExpression const&>(column_expression);
+    if (!column_filter(column))
+        return {};
+
+    auto column_def = table.columns().first_matching([&](auto const& column_def) { return column_def->name() == column.column_name(); });
+    if (!column_def.has_value())
+        return {};
+
+    auto* current_row = exchange(context.current_row, nullptr);
+    ScopeGuard restore_current_row = [&] { context.current_row = current_row; };
+
+    auto value = convert_to_column_type(TRY(value_expression.evaluate(context)), (*column_def)->type());
+    if (!value.has_value())
+        return {};
+
+    TRY(constraints.try_append({ column.column_name(), *comparison, value.release_value() }));
+    return {};
+}
+
+static bool index_provides_ordering(IndexDef const& index, size_t prefix_size, Vector<NonnullRefPtr<OrderingTerm>> const& ordering_terms, TableAccessPlan::ColumnFilter const& column_filter)
+{
+    if (ordering_terms.is_empty())
+        return false;
+
+    auto const& key_parts = index.key_definition();
+    auto is_fixed_by_prefix = [&](StringView column_name) {
+        for (size_t ix = 0; ix < prefix_size; ix++) {
+            if (key_parts[ix]->name() == column_name)
+                return true;
+        }
+        return false;
+    };
+
+    // Indexes are ascending and sort NULL first, which is what ORDER BY does by default.
+    auto next_key_part = prefix_size;
+    for (auto const& term : ordering_terms) {
+        if (term->order() != Order::Ascending || term->nulls() != Nulls::First || !term->collation_name().is_empty())
+            return false;
+        if (!is<ColumnNameExpression>(*term->expression()))
+            return false;
+
+        auto const& column = static_cast<ColumnNameExpression const&>(*term->expression());
+        if (!column_filter(column))
+            return false;
+
+        // Columns that are constrained to a single value don't affect the order.
+        if (is_fixed_by_prefix(column.column_name()))
+            continue;
+
+        if (next_key_part >= key_parts.size() || key_parts[next_key_part]->name() != column.column_name())
+            return false;
+        ++next_key_part;
+    }
+
+    return true;
+}
+
+ResultOr<TableAccessPlan> TableAccessPlan::create(ExecutionContext& context, NonnullRefPtr<TableDef> table, Expression const* where_clause, Vector<NonnullRefPtr<OrderingTerm>> const& ordering_terms, ColumnFilter const& column_filter)
+{
+    TableAccessPlan plan { table };
+    if (table->indexes().is_empty())
+        return plan;
+
+    Vector<ColumnConstraint> constraints;
+    if (where_clause)
+        TRY(collect_constraints(context, *where_clause, *table, column_filter, constraints));
+
+    auto find_constraint = [&](StringView column_name, auto predicate) -> ColumnConstraint const* {
+        for (auto const& constraint : constraints) {
+            if (constraint.column_name == column_name && predicate(constraint.comparison))
+                return &constraint;
+        }
+        return nullptr;
+    };
+
+    size_t best_score = 0;
+
+    for (auto const& index : table->indexes()) {
+        TableAccessPlan candidate { table, index };
+        auto const& key_parts = index->key_definition();
+
+        for (auto const& key_part : key_parts) {
+            auto const* constraint = find_constraint(key_part->name(), [](auto comparison) { return comparison == Comparison::Equals; });
+            if (!constraint)
+                break;
+            TRY(candidate.m_prefix.try_append(constraint->value));
+        }
+
+        if (candidate.m_prefix.size() < key_parts.size()) {
+            auto const& column_name = key_parts[candidate.m_prefix.size()]->name();
+
+            // If there are several bounds on the same side, any of them will do. The WHERE clause
+            // is applied to all rows read through the index anyway.
+            if (auto const* lower = find_constraint(column_name, [](auto comparison) { return comparison == Comparison::GreaterThan || comparison == Comparison::GreaterThanEquals; }))
+                candidate.m_lower_bound = IndexBound { lower->value, lower->comparison == Comparison::GreaterThanEquals };
+            if (auto const* upper = find_constraint(column_name, [](auto comparison) { return comparison == Comparison::LessThan || comparison == Comparison::LessThanEquals; }))
+                candidate.m_upper_bound = IndexBound { upper->value, upper->comparison == Comparison::LessThanEquals };
+        }
+
+        candidate.m_provides_ordering = index_provides_ordering(*index, candidate.m_prefix.size(), ordering_terms, column_filter);
+
+        // Prefer equality over ranges, and ranges over just avoiding the sort. A lookup of a single
+        // row through a unique index beats everything.
+        size_t score = candidate.m_prefix.size() * 8;
+        if (index->unique() && candidate.m_prefix.size() == key_parts.size())
+            score += 64;
+        if (candidate.m_lower_bound.has_value())
+            score += 2;
+        if (candidate.m_upper_bound.has_value())
+            score += 2;
+        if (candidate.m_provides_ordering)
+            score += 1;
+
+        if (score > best_score) {
+            best_score = score;
+            plan = move(candidate);
+        }
+    }
+
+    return plan;
+}
+
+ResultOr<TableAccessPlan> TableAccessPlan::create(ExecutionContext& context, QualifiedTableName const& qualified_table_name, Expression const* where_clause)
+{
+    auto table = TRY(context.database->get_table(qualified_table_name.schema_name(), qualified_table_name.table_name()));
+
+    ColumnFilter column_filter = [&](ColumnNameExpression const& column) {
+        return column.table_name().is_empty() || column.table_name() == table->name();
+    };
+
+    return create(context, table, where_clause, {}, column_filter);
+}
+
+ErrorOr<RowCursor> TableAccessPlan::open(Database& database) const
+{
+    if (!m_index)
+        return database.scan(*m_table);
+    return database.scan_index(*m_table, *m_index, m_prefix, m_lower_bound, m_upper_bound);
+}
+
+ResultOr<Vector<Row>> TableAccessPlan::fetch_rows(Database& database) const
+{
+    if (!m_index)
+        return TRY(database.select_all(*m_table));
+    return TRY(database.select_by_index(*m_table, *m_index, m_prefix, m_lower_bound, m_upper_bound));
+}
+
+ByteString TableAccessPlan::to_byte_string() const
+{
+    // This mimics the output of SQLite's EXPLAIN QUERY PLAN.
+    StringBuilder builder;
+
+    if (!m_index) {
+        builder.appendff("SCAN {}", m_table->name());
+        return builder.to_byte_string();
+    }
+
+    if (m_prefix.is_empty() && !m_lower_bound.has_value() && !m_upper_bound.has_value()) {
+        builder.appendff("SCAN {} USING INDEX {}", m_table->name(), m_index->name());
+        return builder.to_byte_string();
+    }
+
+    builder.appendff("SEARCH {} USING INDEX {} (", m_table->name(), m_index->name());
+
+    auto const& key_parts = m_index->key_definition();
+    Vector<ByteString> conditions;
+    for (size_t ix = 0; ix < m_prefix.size(); ix++)
+        conditions.append(ByteString::formatted("{}=?", key_parts[ix]->name()));
+    if (m_lower_bound.has_value())
+        conditions.append(ByteString::formatted("{}{}?", key_parts[m_prefix.size()]->name(), comparison_symbol(m_lower_bound->inclusive ? Comparison::GreaterThanEquals : Comparison::GreaterThan)));
+    if (m_upper_bound.has_value())
+        conditions.append(ByteString::formatted("{}{}?", key_parts[m_prefix.size()]->name(), comparison_symbol(m_upper_bound->inclusive ? Comparison::LessThanEquals : Comparison::LessThan)));
+
+    builder.join(" AND "sv, conditions);
+    builder.append(')');
+    return builder.to_byte_string();
+}
+
+// Resolves the table a column belongs to, the same way ColumnNameExpression::evaluate() does on a
+// row combining all tables.
+static Optional<size_t> table_of_column(Vector<NonnullRefPtr<TableDef>> const& tables, ColumnNameExpression const& column)
+{
+    Optional<size_t> table_index;
+
+    for (size_t ix = 0; ix < tables.size(); ix++) {
+        auto const& table = *tables[ix];
+        if (!column.table_name().is_empty() && column.table_name() != table.name())
+            continue;
+        if (!table.columns().first_matching([&](auto const& column_def) { return column_def->name() == column.column_name(); }).has_value())
+            continue;
+        if (table_index.has_value())
+            return {};
+        table_index = ix;
+    }
+
+    return table_index;
+}
+
+// Collects the tables referred to by an expression. Returns false if the expression is of a kind
+// that may refer to tables in ways this doesn't understand, such as sub-selects.
+static bool collect_referenced_tables(Vector<NonnullRefPtr<TableDef>> const& tables, Expression const& expression, Vector<size_t>& referenced_tables)
+{
+    if (is<NumericLiteral>(expression) || is<StringLiteral>(expression) || is<BlobLiteral>(expression) || is<BooleanLiteral>(expression) || is<NullLiteral>(expression) || is<Placeholder>(expression))
+        return true;
+
+    if (is<ColumnNameExpression>(expression)) {
+        auto table_index = table_of_column(tables, static_cast<ColumnNameExpression const&>(expression));
+        if (!table_index.has_value())
+            return false;
+        if (!referenced_tables.contains_slow(*table_index))
+            referenced_tables.append(*table_index);
+        return true;
+    }
+
+    if (is<ChainedExpression>(expression)) {
+        for (auto const& element : static_cast<ChainedExpression const&>(expression).expressions()) {
+            if (!collect_referenced_tables(tables, *element, referenced_tables))
+                return false;
+        }
+        return true;
+    }
+
+    if (is<InSelectionExpression>(expression) || is<InTableExpression>(expression))
+        return false;
+
+    if (is<InChainedExpression>(expression)) {
+        auto const& in_expression = static_cast<InChainedExpression const&>(expression);
+        return collect_referenced_tables(tables, *in_expression.expression(), referenced_tables)
+            && collect_referenced_tables(tables, *in_expression.expression_chain(), referenced_tables);
+    }
+
+    if (is<NestedExpression>(expression))
+        return collect_referenced_tables(tables, *static_cast<NestedExpression const&>(expression).expression(), referenced_tables);
+
+    if (is<NestedDoubleExpression>(expression)) {
+        auto const& nested_expression = static_cast<NestedDoubleExpression const&>(expression);
+        return collect_referenced_tables(tables, *nested_expression.lhs(), referenced_tables)
+            && collect_referenced_tables(tables, *nested_expression.rhs(), referenced_tables);
+    }
+
+    return false;
+}
+
+static void split_conjunction(Expression const& expression, Vector<NonnullRefPtr<Expression const>>& terms)
+{
+    if (is<ChainedExpression>(expression)) {
+        auto const& expressions = static_cast<ChainedExpression const&>(expression).expressions();
+        if (expressions.size() == 1) {
+            split_conjunction(*expressions.first(), terms);
+            return;
+        }
+    }
+
+    if (is<BinaryOperatorExpression>(expression)) {
+        auto const& binary_expression = static_cast<BinaryOperatorExpression const&>(expression);
+        if (binary_expression.type() == BinaryOperator::And) {
+            split_conjunction(*binary_expression.lhs(), terms);
+            split_conjunction(*binary_expression.rhs(), terms);
+            return;
+        }
+    }
+
+    terms.append(expression);
+}
+
+static SQLType column_type(TableDef const& table, ColumnNameExpression const& column)
+{
+    auto column_def = table.columns().first_matching([&](auto const& column_def) { return column_def->name() == column.column_name(); });
+    VERIFY(column_def.has_value());
+    return (*column_def)->type();
+}
+
+ResultOr<JoinPlan> JoinPlan::create(ExecutionContext& context, Select const& select)
+{
+    Vector<NonnullRefPtr<TableDef>> tables;
+
+    for (auto const& table_descriptor : select.table_or_subquery_list()) {
+        if (!table_descriptor->is_table())
+            return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented"sv };
+
+        TRY(tables.try_append(TRY(context.database->get_table(table_descriptor->schema_name(), table_descriptor->table_name()))));
+    }
+
+    JoinPlan plan;
+    TRY(plan.m_steps.try_ensure_capacity(tables.size()));
+
+    // The order in which rows are read only matters if they are not combined with rows of other tables.
+    Vector<NonnullRefPtr<OrderingTerm>> no_ordering_terms;
+    auto const& ordering_terms = tables.size() == 1 ? select.ordering_term_list() : no_ordering_terms;
+
+    for (size_t ix = 0; ix < tables.size(); ix++) {
+        TableAccessPlan::ColumnFilter column_filter = [&](ColumnNameExpression const& column) {
+            return table_of_column(tables, column) == ix;
+        };
+
+        auto access = TRY(TableAccessPlan::create(context, tables[ix], select.where_clause(), ordering_terms, column_filter));
+        plan.m_steps.unchecked_append(JoinStep { move(access) });
+    }
+
+    if (!select.where_clause())
+        return plan;
+
+    Vector<NonnullRefPtr<Expression const>> terms;
+    split_conjunction(*select.where_clause(), terms);
+
+    for (auto const& term : terms) {
+        Vector<size_t> referenced_tables;
+        if (plan.m_steps.is_empty() || !collect_referenced_tables(tables, term, referenced_tables) || referenced_tables.is_empty()) {
+            // Apply anything we can't reason about once all tables have been joined.
+            if (plan.m_steps.is_empty())
+                TRY(plan.m_remaining_filters.try_append(term));
+            else
+                TRY(plan.m_steps.last().join_filters.try_append(term));
+            continue;
+        }
+
+        if (referenced_tables.size() == 1) {
+            TRY(plan.m_steps[referenced_tables.first()].table_filters.try_append(term));
+            continue;
+        }
+
+        quick_sort(referenced_tables);
+        auto& step = plan.m_steps[referenced_tables.last()];
+        TRY(step.join_filters.try_append(term));
+
+        // Look for "inner.column = outer.column", where the inner table is the one joined by this step.
+        if (referenced_tables.size() != 2 || step.inner_column || !is<BinaryOperatorExpression>(*term))
+            continue;
+
+        auto const& binary_expression = static_cast<BinaryOperatorExpression const&>(*term);
+        if (binary_expression.type() != BinaryOperator::Equals || !is<ColumnNameExpression>(*binary_expression.lhs()) || !is<ColumnNameExpression>(*binary_expression.rhs()))
+            continue;
+
+        auto const* inner_column = static_cast<ColumnNameExpression const*>(binary_expression.lhs().ptr());
+        auto const* outer_column = static_cast<ColumnNameExpression const*>(binary_expression.rhs().ptr());
+        if (table_of_column(tables, *inner_column) != referenced_tables.last())
+            swap(inner_column, outer_column);
+
+        // Value::compare() converts between types, which hashing can't mirror. Floating point values
+        // are compared with a tolerance, and can't be hashed at all.
+        auto inner_type = column_type(step.access.table(), *inner_column);
+        auto outer_type = column_type(*tables[referenced_tables.first()], *outer_column);
+        if (inner_type != outer_type || inner_type == SQLType::Float)
+            continue;
+
+        step.inner_column = inner_column;
+        step.outer_column = outer_column;
+        step.strategy = JoinStrategy::HashJoin;
+
+        // An index can only be used for the lookup if it isn't already used to evaluate the WHERE clause.
+        if (step.access.is_search())
+            continue;
+
+        for (auto const& index : step.access.table().indexes()) {
+            if (index->key_definition().first()->name() == inner_column->column_name()) {
+                step.join_index = index;
+                step.strategy = JoinStrategy::IndexLookup;
+                break;
+            }
+        }
+    }
+
+    // The first table isn't joined with anything.
+    if (!plan.m_steps.is_empty() && plan.m_steps.first().inner_column) {
+        auto& first_step = plan.m_steps.first();
+        first_step.inner_column = nullptr;
+        first_step.outer_column = nullptr;
+        first_step.join_index = nullptr;
+        first_step.strategy = JoinStrategy::NestedLoop;
+    }
+
+    return plan;
+}
+
+ResultOr<NonnullOwnPtr<Operator>> JoinPlan::create_operator() const
+{
+    OwnPtr<Operator> root;
+    auto descriptor = adopt_ref(*new TupleDescriptor);
+
+    auto add_filter = [&](NonnullOwnPtr<Operator> input, Vector<NonnullRefPtr<Expression const>> const& filters) -> ResultOr<NonnullOwnPtr<Operator>> {
+        if (filters.is_empty())
+            return input;
+        return TRY(try_make<Filter>(move(input), filters));
+    };
+
+    for (auto const& step : m_steps) {
+        auto& table = step.access.table();
+
+        // Tables without columns don't contribute anything to the rows, except for their filters.
+        if (table.num_columns() == 0) {
+            if (root && !step.join_filters.is_empty())
+                root = TRY(add_filter(root.release_nonnull(), step.join_filters));
+            continue;
+        }
+
+        auto joined_descriptor = adopt_ref(*new TupleDescriptor);
+        joined_descriptor->extend(*descriptor);
+        joined_descriptor->extend(*table.to_tuple_descriptor());
+
+        if (!root) {
+            auto scan = TRY(add_filter(TRY(try_make<TableScan>(step.access)), step.table_filters));
+            root = TRY(add_filter(move(scan), step.join_filters));
+            descriptor = move(joined_descriptor);
+            continue;
+        }
+
+        auto outer = root.release_nonnull();
+        NonnullOwnPtr<Operator> join = TRY([&]() -> ResultOr<NonnullOwnPtr<Operator>> {
+            switch (step.strategy) {
+            case JoinStrategy::NestedLoop: {
+                auto inner = TRY(add_filter(TRY(try_make<TableScan>(step.access)), step.table_filters));
+                return TRY(try_make<NestedLoopJoin>(move(outer), move(inner), joined_descriptor));
+            }
+            case JoinStrategy::HashJoin: {
+                auto inner = TRY(add_filter(TRY(try_make<TableScan>(step.access)), step.table_filters));
+                return TRY(try_make<HashJoin>(move(outer), move(inner), *step.outer_column, *step.inner_column, joined_descriptor));
+            }
+            case JoinStrategy::IndexLookup:
+                return TRY(try_make<IndexJoin>(move(outer), table, *step.join_index, *step.outer_column, step.table_filters, joined_descriptor));
+            }
+            VERIFY_NOT_REACHED();
+        }());
+
+        // The join conditions themselves are among the join filters, so hash collisions and value
+        // conversions are dealt with here.
+        root = TRY(add_filter(move(join), step.join_filters));
+        descriptor = move(joined_descriptor);
+    }
+
+    if (!root)
+        root = TRY(try_make<SingleRow>());
+
+    return add_filter(root.release_nonnull(), m_remaining_filters);
+}
+
+Vector<ByteString> JoinPlan::to_byte_strings() const
+{
+    Vector<ByteString> lines;
+
+    for (auto const& step : m_steps) {
+        auto const& table_name = step.access.table().name();
+
+        switch (step.strategy) {
+        case JoinStrategy::NestedLoop:
+            lines.append(step.access.to_byte_string());
+            break;
+        case JoinStrategy::HashJoin:
+            lines.append(step.access.to_byte_string());
+            lines.append(ByteString::formatted("USE HASH TABLE FOR JOIN OF {} ({}=?)", table_name, step.inner_column->column_name()));
+            break;
+        case JoinStrategy::IndexLookup:
+            lines.append(ByteString::formatted("SEARCH {} USING INDEX {} ({}=?)", table_name, step.join_index->name(), step.inner_column->column_name()));
+            break;
+        }
+    }
+
+    return lines;
+}
+
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteString.h>
+#include <AK/Function.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/RefPtr.h>
+#include <AK/Vector.h>
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Forward.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/Row.h>
+#include <LibSQL/Tuple.h>
+
+namespace SQL::AST {
+
+/**
+ * A TableAccessPlan describes how the rows of a single table are read for a
+ * statement: either by scanning the whole table, or through one of the
+ * indexes defined on it. An index is used when the WHERE clause constrains
+ * its leading columns to constant values or ranges, or when it produces the
+ * rows in the order requested by the ORDER BY clause.
+ *
+ * The plan only narrows down the rows read from the table. Callers still
+ * have to apply the WHERE clause to every row produced by the plan.
+ */
+class TableAccessPlan {
+public:
+    // Decides whether a column referenced in the WHERE or ORDER BY clause belongs to the planned table.
+    using ColumnFilter = Function<bool(ColumnNameExpression const&)>;
+
+    static ResultOr<TableAccessPlan> create(ExecutionContext&, NonnullRefPtr<TableDef>, Expression const* where_clause, Vector<NonnullRefPtr<OrderingTerm>> const& ordering_terms, ColumnFilter const&);
+
+    // Plans the access to the only table of a statement, e.g. an UPDATE or a DELETE.
+    static ResultOr<TableAccessPlan> create(ExecutionContext&, QualifiedTableName const&, Expression const* where_clause);
+
+    TableDef& table() const { return *m_table; }
+    RefPtr<IndexDef> const& index() const { return m_index; }
+    bool provides_ordering() const { return m_provides_ordering; }
+    bool is_search() const { return !m_prefix.is_empty() || m_lower_bound.has_value() || m_upper_bound.has_value(); }
+
+    ErrorOr<RowCursor> open(Database&) const;
+    ResultOr<Vector<Row>> fetch_rows(Database&) const;
+    ByteString to_byte_string() const;
+
+private:
+    explicit TableAccessPlan(NonnullRefPtr<TableDef> table, RefPtr<IndexDef> index = nullptr)
+        : m_table(move(table))
+        , m_index(move(index))
+    {
+    }
+
+    NonnullRefPtr<TableDef> m_table;
+    RefPtr<IndexDef> m_index;
+    Vector<Value> m_prefix;
+    Optional<IndexBound> m_lower_bound;
+    Optional<IndexBound> m_upper_bound;
+    bool m_provides_ordering { false };
+};
+
+/**
+ * A JoinPlan describes how the rows of all tables in the FROM clause of a
+ * SELECT statement are combined, and evaluates the WHERE clause on them.
+ *
+ * The WHERE clause is split into its AND-ed terms. Terms that only refer to
+ * a single table are applied to the rows of that table before they are
+ * joined with anything else. Terms referring to several tables are applied
+ * as soon as the last of those tables has been joined.
+ *
+ * Each table after the first one is joined with the rows produced so far
+ * in one of three ways:
+ *  - If an equality term compares one of its columns with a column of an
+ *    earlier table, and an index on the table starts with that column, the
+ *    matching rows are looked up in the index for every row produced so far.
+ *  - If there is such a term but no suitable index, the rows of the table
+ *    are put into a hash table keyed by the column.
+ *  - Otherwise, every row produced so far is combined with every row of the
+ *    table.
+ */
+class JoinPlan {
+public:
+    static ResultOr<JoinPlan> create(ExecutionContext&, Select const&);
+
+    bool provides_ordering() const { return m_steps.size() == 1 && m_steps.first().access.provides_ordering(); }
+
+    // Builds the operators producing the rows of all tables combined that satisfy the WHERE clause.
+    ResultOr<NonnullOwnPtr<Operator>> create_operator() const;
+    Vector<ByteString> to_byte_strings() const;
+
+private:
+    enum class JoinStrategy {
+        NestedLoop,
+        HashJoin,
+        IndexLookup,
+    };
+
+    struct JoinStep {
+        explicit JoinStep(TableAccessPlan access)
+            : access(move(access))
+        {
+        }
+
+        TableAccessPlan access;
+        JoinStrategy strategy { JoinStrategy::NestedLoop };
+
+        // For hash joins and index lookups, the column of this table that has to be equal to a column of an earlier table.
+        RefPtr<ColumnNameExpression const> inner_column;
+        RefPtr<ColumnNameExpression const> outer_column;
+        RefPtr<IndexDef> join_index;
+
+        // Terms of the WHERE clause applied to the rows of this table alone, and to the rows after joining this table.
+        Vector<NonnullRefPtr<Expression const>> table_filters;
+        Vector<NonnullRefPtr<Expression const>> join_filters;
+    };
+
+    JoinPlan() = default;
+
+    Vector<JoinStep> m_steps;
+    Vector<NonnullRefPtr<Expression const>> m_remaining_filters;
+};
+
+}
@@ -6,6 +6,8 @@
 
 #include <AK/NumericLimits.h>
 #include <LibSQL/AST/AST.h>
+#include <LibSQL/AST/Operator.h>
+#include <LibSQL/AST/QueryPlan.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Meta.h>
 #include <LibSQL/Row.h>
@@ -37,10 +39,20 @@ static ByteString result_column_name(ResultColumn const& column, size_t column_i
     return fallback_column_name();
 }
 
-ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
+ResultOr<Vector<ByteString>> Select::query_plan(ExecutionContext& context) const
+{
+    auto plan = TRY(JoinPlan::create(context, *this));
+    auto lines = plan.to_byte_strings();
+
+    if (!m_ordering_term_list.is_empty() && !plan.provides_ordering())
+        TRY(lines.try_append("USE TEMP B-TREE FOR ORDER BY"sv));
+
+    return lines;
+}
+
+ResultOr<NonnullOwnPtr<Operator>> Select::create_operator(ExecutionContext& context, Vector<ByteString>& column_names) const
 {
     Vector<NonnullRefPtr<ResultColumn const>> columns;
-    Vector<ByteString> column_names;
 
     auto const& result_column_list = this->result_column_list();
     VERIFY(!result_column_list.is_empty());
@@ -83,72 +95,12 @@ ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
         }
     }
 
-    ResultSet result { SQLCommand::Select, move(column_names) };
+    auto plan = TRY(JoinPlan::create(context, *this));
+    auto root = TRY(plan.create_operator());
 
-    auto descriptor = adopt_ref(*new TupleDescriptor);
-    Tuple tuple(descriptor);
-    Vector<Tuple> rows;
-    descriptor->empend("__unity__"sv);
-    tuple.append(Value { true });
-    rows.append(tuple);
-
-    for (auto& table_descriptor : table_or_subquery_list()) {
-        if (!table_descriptor->is_table())
-            return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented"sv };
-
-        auto table_def = TRY(context.database->get_table(table_descriptor->schema_name(), table_descriptor->table_name()));
-        if (table_def->num_columns() == 0)
-            continue;
-
-        auto old_descriptor_size = descriptor->size();
-        descriptor->extend(table_def->to_tuple_descriptor());
-
-        while (!rows.is_empty() && (rows.first().size() == old_descriptor_size)) {
-            auto cartesian_row = rows.take_first();
-            auto table_rows = TRY(context.database->select_all(*table_def));
-
-            for (auto& table_row : table_rows) {
-                auto new_row = cartesian_row;
-                new_row.extend(table_row);
-                rows.append(new_row);
-            }
-        }
-    }
-
-    bool has_ordering { false };
-    auto sort_descriptor = adopt_ref(*new TupleDescriptor);
-    for (auto& term : m_ordering_term_list) {
-        sort_descriptor->append(TupleElementDescriptor { .order = term->order() });
-        has_ordering = true;
-    }
-    Tuple sort_key(sort_descriptor);
-
-    for (auto& row : rows) {
-        context.current_row = &row;
-
-        if (where_clause()) {
-            auto where_result = TRY(where_clause()->evaluate(context)).to_bool();
-            if (!where_result.has_value() || !where_result.value())
-                continue;
-        }
-
-        tuple.clear();
-
-        for (auto& col : columns) {
-            auto value = TRY(col->expression()->evaluate(context));
-            tuple.append(value);
-        }
-
-        if (has_ordering) {
-            sort_key.clear();
-            for (auto& term : m_ordering_term_list) {
-                auto value = TRY(term->expression()->evaluate(context));
-                sort_key.append(value);
-            }
-        }
-
-        result.insert_row(tuple, sort_key);
-    }
+    // If the rows were read through an index in the requested order, there is no need to sort them again.
+    if (!m_ordering_term_list.is_empty() && !plan.provides_ordering())
+        root = TRY(try_make<Sort>(move(root), m_ordering_term_list));
 
     if (m_limit_clause != nullptr) {
         size_t limit_value = NumericLimits<size_t>::max();
@@ -174,10 +126,25 @@ ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
             }
         }
 
-        result.limit(offset_value, limit_value);
+        // Rows are only read from the tables until enough of them have been produced.
+        root = TRY(try_make<Limit>(move(root), offset_value, limit_value));
     }
 
-    return result;
+    return TRY(try_make<Project>(move(root), move(columns)));
+}
+
+ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
+{
+    Vector<ByteString> column_names;
+    auto root = TRY(create_operator(context, column_names));
+
+    ResultSet result { SQLCommand::Select, move(column_names) };
+    while (true) {
+        auto row = TRY(root->next(context));
+        if (!row.has_value())
+            return result;
+        result.insert_row(*row, Tuple {});
+    }
 }
 
 }
@@ -80,6 +80,81 @@ bool BTree::update_key_pointer(Key const& key)
     return m_root->update_key_pointer(key);
 }
 
+bool BTree::remove(Key const& key)
+{
+    if (!m_root)
+        initialize_root();
+
+    size_t index = 0;
+    auto* node = m_root->node_containing(key, index);
+    if (!node)
+        return false;
+
+    if (node->is_leaf()) {
+        node->m_entries.remove(index);
+        node->m_down.take_last();
+    } else {
+        // Replace the entry with its in-order predecessor, which always lives in a leaf, and
+        // remove that one from its leaf instead.
+        auto* leaf = node->down_node(index);
+        while (!leaf->is_leaf())
+            leaf = leaf->down_node(leaf->size());
+        node->m_entries[index] = leaf->m_entries.take_last();
+        leaf->m_down.take_last();
+        serializer().serialize_and_write(*node);
+        node = leaf;
+    }
+
+    serializer().serialize_and_write(*node);
+    rebalance_after_remove(node);
+    return true;
+}
+
+void BTree::clear()
+{
+    if (!m_root) {
+        if (!block_index())
+            return;
+        initialize_root();
+    }
+    m_root->free_subtree();
+    m_root = nullptr;
+    set_block_index(0);
+}
+
+void BTree::rebalance_after_remove(TreeNode* node)
+{
+    // Nodes are only rebalanced once they run empty. Anything else would require knowing
+    // how full a node is, which depends on the serialized length of its keys.
+    while (node->size() == 0 && node->up()) {
+        auto* parent = node->up();
+        auto child_index = parent->index_of_child(*node);
+        if (parent->borrow_for_empty_child(child_index))
+            return;
+        parent->merge_empty_child(child_index);
+        node = parent;
+    }
+
+    if (node != m_root.ptr() || node->size() != 0 || node->is_leaf())
+        return;
+
+    // The root lost its last entry. Its only child becomes the new root.
+    auto* child = node->down_node(0);
+    auto new_root = move(node->m_down[0].m_node);
+    child->m_up = nullptr;
+    free_node(*m_root);
+    m_root = move(new_root);
+    set_block_index(m_root->block_index());
+    if (on_new_root)
+        on_new_root();
+}
+
+void BTree::free_node(TreeNode const& node)
+{
+    if (node.block_index() && serializer().has_block(node.block_index()))
+        serializer().heap().free_storage(node.block_index()).release_value_but_fixme_should_propagate_errors();
+}
+
 Optional<u32> BTree::get(Key& key)
 {
     if (!m_root)
@@ -103,6 +178,27 @@ BTreeIterator BTree::find(Key const& key)
     return end();
 }
 
+BTreeIterator BTree::lower_bound(Key const& key)
+{
+    if (!m_root)
+        initialize_root();
+
+    // The first entry not less than the key is either the first such entry in a node, or it
+    // lives in the subtree to the left of that entry.
+    auto result = end();
+    for (auto* node = m_root.ptr(); node;) {
+        auto ix = 0u;
+        while (ix < node->size() && (*node)[ix].compare(key) < 0)
+            ix++;
+        if (ix < node->size())
+            result = BTreeIterator(node, (int)ix);
+        if (node->is_leaf())
+            break;
+        node = node->down_node(ix);
+    }
+    return result;
+}
+
 void BTree::list_tree()
 {
     if (!m_root)
@@ -46,6 +46,7 @@ private:
     TreeNode* m_owner;
     Block::Index m_block_index { 0 };
     OwnPtr<TreeNode> m_node { nullptr };
+    friend BTree;
     friend TreeNode;
 };
 
@@ -69,6 +70,7 @@ public:
     bool insert(Key const&);
     bool update_key_pointer(Key const&);
     TreeNode* node_for(Key const&);
+    TreeNode* node_containing(Key const&, size_t&);
     Optional<u32> get(Key&);
     void deserialize(Serializer&);
     void serialize(Serializer&) const;
@@ -79,6 +81,11 @@ private:
     bool insert_in_leaf(Key const&);
     void just_insert(Key const&, TreeNode* = nullptr);
     void split();
+    size_t index_of_child(TreeNode const&) const;
+    void adopt_down_pointer(size_t, DownPointer&);
+    bool borrow_for_empty_child(size_t);
+    void merge_empty_child(size_t);
+    void free_subtree();
     void list_node(int);
 
     BTree& m_tree;
@@ -99,8 +106,11 @@ public:
     Block::Index root() const { return m_root ? m_root->block_index() : 0; }
     bool insert(Key const&);
     bool update_key_pointer(Key const&);
+    bool remove(Key const&);
+    void clear();
     Optional<u32> get(Key&);
     BTreeIterator find(Key const& key);
+    BTreeIterator lower_bound(Key const& key);
     BTreeIterator begin();
     static BTreeIterator end();
     void list_tree();
@@ -111,6 +121,8 @@ private:
     BTree(Serializer&, NonnullRefPtr<TupleDescriptor> const&, bool unique, Block::Index);
     void initialize_root();
     TreeNode* new_root();
+    void rebalance_after_remove(TreeNode*);
+    void free_node(TreeNode const&);
     OwnPtr<TreeNode> m_root { nullptr };
 
     friend BTreeIterator;
@@ -15,9 +15,9 @@
 
 namespace SQL {
 
-ErrorOr<NonnullRefPtr<Database>> Database::create(ByteString name)
+ErrorOr<NonnullRefPtr<Database>> Database::create(ByteString name, size_t buffer_pool_capacity)
 {
-    auto heap = TRY(Heap::create(move(name)));
+    auto heap = TRY(Heap::create(move(name), buffer_pool_capacity));
     return adopt_nonnull_ref_or_enomem(new (nothrow) Database(move(heap)));
 }
 
@@ -47,6 +47,11 @@ ResultOr<void> Database::open()
         m_heap->set_table_columns_root(m_table_columns->root());
     };
 
+    m_indexes = TRY(BTree::create(m_serializer, IndexDef::index_def()->to_tuple_descriptor(), m_heap->indexes_root()));
+    m_indexes->on_new_root = [&]() {
+        m_heap->set_indexes_root(m_indexes->root());
+    };
+
     m_open = true;
 
     auto ensure_schema_exists = [&](auto schema_name) -> ResultOr<NonnullRefPtr<SchemaDef>> {
@@ -172,16 +177,180 @@ ResultOr<NonnullRefPtr<TableDef>> Database::get_table(ByteString const& schema,
     for (auto it = m_table_columns->find(column_key); !it.is_end() && ((*it)["table_hash"].to_int<u32>() == table_hash); ++it)
         table_def->append_column(*it);
 
+    auto index_key = IndexDef::make_key(*table_def);
+    for (auto it = m_indexes->find(index_key); !it.is_end() && ((*it)["table_hash"].to_int<u32>() == table_hash); ++it) {
+        auto index_def = TRY(IndexDef::create(table_def.ptr(), (*it)["index_name"].to_byte_string(), (*it)["unique"].to_int<u32>() == 1u, (*it).block_index()));
+
+        // The key parts of an index are stored along with the table columns, keyed by the index hash.
+        auto index_hash = index_def->hash();
+        auto key_part_key = IndexDef::make_column_key(*index_def);
+        for (auto part = m_table_columns->find(key_part_key); !part.is_end() && ((*part)["table_hash"].to_int<u32>() == index_hash); ++part)
+            index_def->append_column(*part);
+
+        table_def->append_index(index_def);
+    }
+
     return table_def;
 }
 
+ResultOr<void> Database::add_index(IndexDef& index)
+{
+    VERIFY(is_open());
+
+    auto table = m_table_cache.get(index.parent()->key().hash());
+    VERIFY(table.has_value());
+
+    // Like in SQLite, index names are unique within a schema, not only within a table.
+    if (auto result = get_index((*table)->parent()->name(), index.name()); !result.is_error())
+        return Result { SQLCommand::Unknown, SQLErrorCode::IndexExists, index.name() };
+    else if (result.error().error() != SQLErrorCode::IndexDoesNotExist)
+        return result.release_error();
+
+    if (!m_indexes->insert(index.key()))
+        return Result { SQLCommand::Unknown, SQLErrorCode::IndexExists, index.name() };
+
+    for (auto& part : index.key_definition()) {
+        if (!m_table_columns->insert(part->key()))
+            VERIFY_NOT_REACHED();
+    }
+
+    (*table)->append_index(index);
+
+    auto tree = TRY(index_tree(index));
+    for (auto& row : TRY(select_all(**table))) {
+        if (auto result = check_unique_constraints(row); result.is_error()) {
+            TRY(remove_index(index));
+            return result.release_error();
+        }
+        VERIFY(tree->insert(TRY(index_key(index, row))));
+    }
+
+    return {};
+}
+
+ResultOr<void> Database::remove_index(IndexDef& index)
+{
+    VERIFY(is_open());
+
+    auto table = m_table_cache.get(index.parent()->key().hash());
+    VERIFY(table.has_value());
+
+    TRY(index_tree(index))->clear();
+    m_index_cache.remove(index.hash());
+
+    if (!m_indexes->remove(index.key()))
+        return Result { SQLCommand::Unknown, SQLErrorCode::IndexDoesNotExist, index.name() };
+
+    for (auto& part : index.key_definition()) {
+        if (!m_table_columns->remove(part->key()))
+            VERIFY_NOT_REACHED();
+    }
+
+    (*table)->remove_index(index);
+    return {};
+}
+
+ResultOr<NonnullRefPtr<IndexDef>> Database::get_index(ByteString const& schema, ByteString const& name)
+{
+    VERIFY(is_open());
+
+    auto schema_name = schema;
+    if (schema.is_empty())
+        schema_name = "default"sv;
+
+    auto schema_def = TRY(get_schema(schema_name));
+    auto schema_hash = schema_def->hash();
+
+    auto table_key = TableDef::make_key(*schema_def);
+    for (auto it = m_tables->find(table_key); !it.is_end() && ((*it)["schema_hash"].to_int<u32>() == schema_hash); ++it) {
+        auto table_def = TRY(get_table(schema_name, (*it)["table_name"].to_byte_string()));
+        if (auto index_def = table_def->index(name))
+            return index_def.release_nonnull();
+    }
+
+    return Result { SQLCommand::Unknown, SQLErrorCode::IndexDoesNotExist, ByteString::formatted("{}.{}", schema_name, name) };
+}
+
+ErrorOr<NonnullRefPtr<BTree>> Database::index_tree(IndexDef& index)
+{
+    auto index_hash = index.hash();
+    if (auto it = m_index_cache.find(index_hash); it != m_index_cache.end())
+        return it->value;
+
+    // Every entry carries the block index of its row as the last key part. That keeps the
+    // keys unique even if the indexed columns aren't, and lets us remove the entry of one
+    // particular row.
+    auto descriptor = index.to_tuple_descriptor();
+    descriptor->append({ "", "", "$row", SQLType::Integer, Order::Ascending });
+
+    auto tree = TRY(BTree::create(m_serializer, descriptor, index.block_index()));
+    tree->on_new_root = [this, tree = tree.ptr(), index = NonnullRefPtr<IndexDef> { index }]() {
+        index->set_block_index(tree->root());
+        VERIFY(m_indexes->update_key_pointer(index->key()));
+    };
+
+    TRY(m_index_cache.try_set(index_hash, tree));
+    return tree;
+}
+
+ErrorOr<Key> Database::index_key(IndexDef& index, Row const& row)
+{
+    Key key(TRY(index_tree(index))->descriptor());
+    for (size_t ix = 0; ix < index.size(); ix++)
+        key[ix] = row[index.key_definition()[ix]->name()];
+    key[index.size()] = row.block_index();
+    key.set_block_index(row.block_index());
+    return key;
+}
+
+ResultOr<void> Database::check_unique_constraints(Row const& row)
+{
+    for (auto& index : row.table().indexes()) {
+        if (!index->unique())
+            continue;
+
+        auto key = TRY(index_key(*index, row));
+
+        // NULL values never conflict with each other.
+        bool has_null_part = false;
+        for (size_t ix = 0; ix < index->size(); ix++)
+            has_null_part |= key[ix].is_null();
+        if (has_null_part)
+            continue;
+
+        // Leaving the row pointer empty matches the entries of all rows with the same values.
+        key[index->size()] = Value {};
+        auto it = TRY(index_tree(*index))->find(key);
+        if (!it.is_end() && (*it).block_index() != row.block_index())
+            return Result { SQLCommand::Unknown, SQLErrorCode::UniqueConstraintViolated, index->name() };
+    }
+    return {};
+}
+
+ErrorOr<void> Database::insert_into_indexes(Row const& row)
+{
+    for (auto& index : row.table().indexes())
+        VERIFY(TRY(index_tree(*index))->insert(TRY(index_key(*index, row))));
+    return {};
+}
+
+ErrorOr<void> Database::remove_from_indexes(Row const& row)
+{
+    for (auto& index : row.table().indexes())
+        VERIFY(TRY(index_tree(*index))->remove(TRY(index_key(*index, row))));
+    return {};
+}
+
 ErrorOr<Vector<Row>> Database::select_all(TableDef& table)
 {
-    VERIFY(m_table_cache.get(table.key().hash()).has_value());
+    auto cursor = scan(table);
     Vector<Row> ret;
-    for (auto block_index = table.block_index(); block_index; block_index = ret.last().next_block_index())
-        ret.append(m_serializer.deserialize_block<Row>(block_index, table, block_index));
-    return ret;
+    while (true) {
+        auto row = TRY(cursor.next());
+        if (!row.has_value())
+            return ret;
+        TRY(ret.try_append(row.release_value()));
+    }
 }
 
 ErrorOr<Vector<Row>> Database::match(TableDef& table, Key const& key)
@@ -200,16 +369,119 @@ ErrorOr<Vector<Row>> Database::match(TableDef& table, Key const& key)
     return ret;
 }
 
-ErrorOr<void> Database::insert(Row& row)
+ErrorOr<Vector<Row>> Database::select_by_index(TableDef& table, IndexDef& index, Vector<Value> const& prefix, Optional<IndexBound> const& lower_bound, Optional<IndexBound> const& upper_bound)
+{
+    auto cursor = TRY(scan_index(table, index, prefix, lower_bound, upper_bound));
+    Vector<Row> ret;
+    while (true) {
+        auto row = TRY(cursor.next());
+        if (!row.has_value())
+            return ret;
+        TRY(ret.try_append(row.release_value()));
+    }
+}
+
+RowCursor Database::scan(TableDef& table)
+{
+    VERIFY(m_table_cache.get(table.key().hash()).has_value());
+
+    RowCursor cursor { *this, table };
+    cursor.m_next_block_index = table.block_index();
+    return cursor;
+}
+
+ErrorOr<RowCursor> Database::scan_index(TableDef& table, IndexDef& index, Vector<Value> prefix, Optional<IndexBound> lower_bound, Optional<IndexBound> upper_bound)
+{
+    VERIFY(m_table_cache.get(table.key().hash()).has_value());
+    VERIFY(prefix.size() < index.size() || (prefix.size() == index.size() && !lower_bound.has_value() && !upper_bound.has_value()));
+
+    auto tree = TRY(index_tree(index));
+
+    Key probe(tree->descriptor());
+    for (size_t ix = 0; ix < prefix.size(); ix++)
+        probe[ix] = prefix[ix];
+    if (lower_bound.has_value())
+        probe[prefix.size()] = lower_bound->value;
+
+    RowCursor cursor { *this, table };
+    cursor.m_index = index;
+
+    // NULL sorts before everything else, so a probe with trailing NULLs finds the first entry
+    // matching the prefix and lower bound.
+    cursor.m_iterator = (prefix.is_empty() && !lower_bound.has_value()) ? tree->begin() : tree->lower_bound(probe);
+    cursor.m_prefix = move(prefix);
+    cursor.m_lower_bound = move(lower_bound);
+    cursor.m_upper_bound = move(upper_bound);
+    return cursor;
+}
+
+RowCursor::RowCursor(NonnullRefPtr<Database> database, NonnullRefPtr<TableDef> table)
+    : m_database(move(database))
+    , m_table(move(table))
+{
+}
+
+ErrorOr<Optional<Row>> RowCursor::next()
+{
+    auto read_row = [&](Block::Index block_index) {
+        return m_database->m_serializer.deserialize_block<Row>(block_index, m_table, block_index);
+    };
+
+    if (!m_index) {
+        if (m_next_block_index == 0)
+            return Optional<Row> {};
+
+        auto row = read_row(m_next_block_index);
+        m_next_block_index = row.next_block_index();
+        return row;
+    }
+
+    auto& it = *m_iterator;
+    auto bound_column = m_prefix.size();
+
+    for (; !it.is_end(); ++it) {
+        auto const& key = *it;
+
+        bool matches_prefix = true;
+        for (size_t ix = 0; ix < m_prefix.size() && matches_prefix; ix++)
+            matches_prefix = key[ix].compare(m_prefix[ix]) == 0;
+        if (!matches_prefix)
+            break;
+
+        if (bound_column < m_index->size()) {
+            auto const& value = key[bound_column];
+            if (m_lower_bound.has_value() && !m_lower_bound->inclusive && value.compare(m_lower_bound->value) == 0)
+                continue;
+            if (m_upper_bound.has_value()) {
+                auto compared = value.compare(m_upper_bound->value);
+                if (compared > 0 || (compared == 0 && !m_upper_bound->inclusive))
+                    break;
+            }
+        }
+
+        auto row = read_row(key.block_index());
+        ++it;
+        return row;
+    }
+
+    // Don't look at the index again once the end of the range has been reached.
+    it = BTree::end();
+    return Optional<Row> {};
+}
+
+ResultOr<void> Database::insert(Row& row)
 {
     VERIFY(m_table_cache.get(row.table().key().hash()).has_value());
-    // TODO: implement table constraints such as unique, foreign key, etc.
+    // TODO: implement table constraints such as foreign key, etc.
+
+    // The row doesn't have a block yet, so anything found by the uniqueness check is a conflict.
+    row.set_block_index(0);
+    TRY(check_unique_constraints(row));
 
     row.set_block_index(m_heap->request_new_block_index());
     row.set_next_block_index(row.table().block_index());
-    TRY(update(row));
-
-    // TODO update indexes defined on table.
+    write_row(row);
+    TRY(insert_into_indexes(row));
 
     auto table_key = row.table().key();
     table_key.set_block_index(row.block_index());
@@ -223,6 +495,11 @@ ErrorOr<void> Database::remove(Row& row)
     auto& table = row.table();
     VERIFY(m_table_cache.get(table.key().hash()).has_value());
 
+    // Rows read through an index are not removed in storage order, so the link to the next row
+    // may have changed since this row was read.
+    row.set_next_block_index(m_serializer.deserialize_block<Row>(row.block_index(), table, row.block_index()).next_block_index());
+
+    TRY(remove_from_indexes(row));
     TRY(m_heap->free_storage(row.block_index()));
 
     if (table.block_index() == row.block_index()) {
@@ -239,7 +516,7 @@ ErrorOr<void> Database::remove(Row& row)
 
         if (current.next_block_index() == row.block_index()) {
             current.set_next_block_index(row.next_block_index());
-            TRY(update(current));
+            write_row(current);
             break;
         }
 
@@ -249,16 +526,39 @@ ErrorOr<void> Database::remove(Row& row)
     return {};
 }
 
-ErrorOr<void> Database::update(Row& tuple)
+ResultOr<void> Database::update(Row& row)
 {
-    VERIFY(m_table_cache.get(tuple.table().key().hash()).has_value());
-    // TODO: implement table constraints such as unique, foreign key, etc.
+    auto& table = row.table();
+    VERIFY(m_table_cache.get(table.key().hash()).has_value());
+    // TODO: implement table constraints such as foreign key, etc.
 
-    m_serializer.reset();
-    m_serializer.serialize_and_write<Tuple>(tuple);
+    if (table.indexes().is_empty()) {
+        write_row(row);
+        return {};
+    }
+
+    TRY(check_unique_constraints(row));
 
-    // TODO update indexes defined on table.
+    auto old_row = m_serializer.deserialize_block<Row>(row.block_index(), table, row.block_index());
+    write_row(row);
+
+    for (auto& index : table.indexes()) {
+        auto old_key = TRY(index_key(*index, old_row));
+        auto new_key = TRY(index_key(*index, row));
+        if (old_key == new_key)
+            continue;
+
+        auto tree = TRY(index_tree(*index));
+        VERIFY(tree->remove(old_key));
+        VERIFY(tree->insert(new_key));
+    }
     return {};
 }
 
+void Database::write_row(Row& row)
+{
+    m_serializer.reset();
+    m_serializer.serialize_and_write<Tuple>(row);
+}
+
 }
@@ -10,6 +10,7 @@
 #include <AK/ByteString.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/RefPtr.h>
+#include <LibSQL/BTree.h>
 #include <LibSQL/Forward.h>
 #include <LibSQL/Heap.h>
 #include <LibSQL/Meta.h>
@@ -18,6 +19,39 @@
 
 namespace SQL {
 
+struct IndexBound {
+    Value value;
+    bool inclusive { true };
+};
+
+/**
+ * A RowCursor reads the rows of a table one at a time, either in storage
+ * order or in the order of one of the table's indexes. Rows are only read
+ * from the heap once they are requested.
+ *
+ * The table must not be modified while the cursor is in use.
+ */
+class RowCursor {
+public:
+    // Returns the next row, or an empty Optional once all rows have been read.
+    ErrorOr<Optional<Row>> next();
+
+private:
+    friend Database;
+
+    RowCursor(NonnullRefPtr<Database>, NonnullRefPtr<TableDef>);
+
+    NonnullRefPtr<Database> m_database;
+    NonnullRefPtr<TableDef> m_table;
+    Block::Index m_next_block_index { 0 };
+
+    RefPtr<IndexDef> m_index;
+    Optional<BTreeIterator> m_iterator;
+    Vector<Value> m_prefix;
+    Optional<IndexBound> m_lower_bound;
+    Optional<IndexBound> m_upper_bound;
+};
+
 /**
  * A Database object logically connects a Heap with the SQL data we want
  * to store in it. It has BTree pointers for B-Trees holding the definitions
@@ -25,7 +59,7 @@ namespace SQL {
  */
 class Database : public RefCounted<Database> {
 public:
-    static ErrorOr<NonnullRefPtr<Database>> create(ByteString);
+    static ErrorOr<NonnullRefPtr<Database>> create(ByteString, size_t buffer_pool_capacity = Heap::DEFAULT_BUFFER_POOL_CAPACITY);
     ~Database();
 
     ResultOr<void> open();
@@ -41,24 +75,49 @@ public:
     static Key get_table_key(ByteString const&, ByteString const&);
     ResultOr<NonnullRefPtr<TableDef>> get_table(ByteString const&, ByteString const&);
 
+    ResultOr<void> add_index(IndexDef&);
+    ResultOr<void> remove_index(IndexDef&);
+    ResultOr<NonnullRefPtr<IndexDef>> get_index(ByteString const&, ByteString const&);
+
     ErrorOr<Vector<Row>> select_all(TableDef&);
     ErrorOr<Vector<Row>> match(TableDef&, Key const&);
-    ErrorOr<void> insert(Row&);
+
+    // Returns the rows of the table in index order. The leading columns of the index have to
+    // be equal to the values in the prefix, and the column following them has to lie within
+    // the given bounds.
+    ErrorOr<Vector<Row>> select_by_index(TableDef&, IndexDef&, Vector<Value> const& prefix, Optional<IndexBound> const& lower_bound, Optional<IndexBound> const& upper_bound);
+
+    // Like select_all() and select_by_index(), but the rows are read as they are requested.
+    RowCursor scan(TableDef&);
+    ErrorOr<RowCursor> scan_index(TableDef&, IndexDef&, Vector<Value> prefix, Optional<IndexBound> lower_bound, Optional<IndexBound> upper_bound);
+
+    ResultOr<void> insert(Row&);
     ErrorOr<void> remove(Row&);
-    ErrorOr<void> update(Row&);
+    ResultOr<void> update(Row&);
 
 private:
+    friend RowCursor;
+
     explicit Database(NonnullRefPtr<Heap>);
 
+    ErrorOr<NonnullRefPtr<BTree>> index_tree(IndexDef&);
+    ErrorOr<Key> index_key(IndexDef&, Row const&);
+    ResultOr<void> check_unique_constraints(Row const&);
+    ErrorOr<void> insert_into_indexes(Row const&);
+    ErrorOr<void> remove_from_indexes(Row const&);
+    void write_row(Row&);
+
     bool m_open { false };
     NonnullRefPtr<Heap> m_heap;
     Serializer m_serializer;
     RefPtr<BTree> m_schemas;
     RefPtr<BTree> m_tables;
     RefPtr<BTree> m_table_columns;
+    RefPtr<BTree> m_indexes;
 
     HashMap<u32, NonnullRefPtr<SchemaDef>> m_schema_cache;
     HashMap<u32, NonnullRefPtr<TableDef>> m_table_cache;
+    HashMap<u32, NonnullRefPtr<BTree>> m_index_cache;
 };
 
 }
@@ -21,6 +21,7 @@ class Relation;
 class Result;
 class ResultSet;
 class Row;
+class RowCursor;
 class SchemaDef;
 class Serializer;
 class TableDef;
@@ -46,13 +47,17 @@ class ColumnDefinition;
 class ColumnNameExpression;
 class CommonTableExpression;
 class CommonTableExpressionList;
+class CreateIndex;
 class CreateTable;
+class Cursor;
 class Delete;
 class DropColumn;
+class DropIndex;
 class DropTable;
 class ErrorExpression;
 class ErrorStatement;
 class ExistsExpression;
+class Explain;
 class Expression;
 class GroupByClause;
 class InChainedExpression;
@@ -62,6 +67,7 @@ class InTableExpression;
 class InvertibleNestedDoubleExpression;
 class InvertibleNestedExpression;
 class IsExpression;
+class JoinPlan;
 class Lexer;
 class LimitClause;
 class MatchExpression;
@@ -70,6 +76,7 @@ class NestedExpression;
 class NullExpression;
 class NullLiteral;
 class NumericLiteral;
+class Operator;
 class OrderingTerm;
 class Parser;
 class QualifiedTableName;
@@ -81,6 +88,7 @@ class Select;
 class SignedNumber;
 class Statement;
 class StringLiteral;
+class TableAccessPlan;
 class TableOrSubquery;
 class Token;
 class TypeName;
@@ -8,25 +8,29 @@
 #include <AK/ByteString.h>
 #include <AK/Format.h>
 #include <AK/QuickSort.h>
+#include <AK/ScopeGuard.h>
 #include <LibCore/System.h>
 #include <LibSQL/Heap.h>
 #include <sys/stat.h>
 
 namespace SQL {
 
-ErrorOr<NonnullRefPtr<Heap>> Heap::create(ByteString file_name)
+ErrorOr<NonnullRefPtr<Heap>> Heap::create(ByteString file_name, size_t buffer_pool_capacity)
 {
-    return adopt_nonnull_ref_or_enomem(new (nothrow) Heap(move(file_name)));
+    return adopt_nonnull_ref_or_enomem(new (nothrow) Heap(move(file_name), buffer_pool_capacity));
 }
 
-Heap::Heap(ByteString file_name)
+Heap::Heap(ByteString file_name, size_t buffer_pool_capacity)
     : m_name(move(file_name))
+    , m_buffer_pool_capacity(buffer_pool_capacity)
 {
+    // Reading and writing a chain of blocks may pin a few frames at the same time.
+    VERIFY(m_buffer_pool_capacity >= 4);
 }
 
 Heap::~Heap()
 {
-    if (m_file && !m_write_ahead_log.is_empty()) {
+    if (m_file && m_frames.first_matching([](auto const& frame) { return frame.dirty; }).has_value()) {
         if (auto maybe_error = flush(); maybe_error.is_error())
             warnln("~Heap({}): {}", name(), maybe_error.error());
     }
@@ -71,6 +75,9 @@ ErrorOr<void> Heap::open()
     if (m_version != VERSION) {
         dbgln_if(SQL_DEBUG, "Heap file {} opened has incompatible version {}. Deleting for version {}.", name(), m_version, VERSION);
         m_file = nullptr;
+        m_frames.clear();
+        m_frame_indices.clear();
+        m_clock_hand = 0;
 
         TRY(Core::System::unlink(name()));
         return open();
@@ -97,7 +104,7 @@ ErrorOr<size_t> Heap::file_size_in_bytes() const
 
 bool Heap::has_block(Block::Index index) const
 {
-    return (index <= m_highest_block_written || m_write_ahead_log.contains(index))
+    return (index <= m_highest_block_written || m_frame_indices.contains(index))
         && !m_free_block_indices.contains_slow(index);
 }
 
@@ -172,28 +179,99 @@ ErrorOr<void> Heap::write_storage(Block::Index index, ReadonlyBytes data)
     return {};
 }
 
-ErrorOr<ByteBuffer> Heap::read_raw_block(Block::Index index)
+ErrorOr<Heap::Frame*> Heap::find_unused_frame()
+{
+    if (m_frames.size() < m_buffer_pool_capacity) {
+        // Pinned frames are referred to by pointer, so the frames must never move.
+        TRY(m_frames.try_ensure_capacity(m_buffer_pool_capacity));
+        TRY(m_frames.try_append({}));
+        auto& frame = m_frames.last();
+        frame.data = TRY(ByteBuffer::create_uninitialized(Block::SIZE));
+        return &frame;
+    }
+
+    // Every frame is passed at most twice: once to clear its referenced bit, and once to pick it.
+    for (size_t step = 0; step < 2 * m_frames.size(); ++step) {
+        auto& frame = m_frames[m_clock_hand];
+        m_clock_hand = (m_clock_hand + 1) % m_frames.size();
+
+        if (frame.pin_count > 0)
+            continue;
+        if (frame.referenced) {
+            frame.referenced = false;
+            continue;
+        }
+
+        if (frame.dirty) {
+            TRY(write_raw_block(frame.block_index, frame.data));
+            frame.dirty = false;
+            ++m_buffer_pool_statistics.write_backs;
+        }
+
+        // A frame whose block failed to be read was never registered.
+        auto frame_index = static_cast<size_t>(&frame - m_frames.data());
+        if (m_frame_indices.get(frame.block_index) == frame_index) {
+            m_frame_indices.remove(frame.block_index);
+            ++m_buffer_pool_statistics.evictions;
+        }
+        return &frame;
+    }
+
+    return Error::from_string_literal("Heap::find_unused_frame(): all frames of the buffer pool are pinned");
+}
+
+ErrorOr<Heap::Frame*> Heap::pin_frame(Block::Index index, bool read_from_file)
 {
     VERIFY(m_file);
-    VERIFY(index < m_next_block);
 
-    if (auto wal_entry = m_write_ahead_log.get(index); wal_entry.has_value())
-        return wal_entry.value();
+    if (auto frame_index = m_frame_indices.get(index); frame_index.has_value()) {
+        auto& frame = m_frames[*frame_index];
+        ++frame.pin_count;
+        frame.referenced = true;
+        ++m_buffer_pool_statistics.hits;
+        return &frame;
+    }
 
-    TRY(m_file->seek(index * Block::SIZE, SeekMode::SetPosition));
-    auto buffer = TRY(ByteBuffer::create_uninitialized(Block::SIZE));
-    TRY(m_file->read_until_filled(buffer));
-    return buffer;
+    ++m_buffer_pool_statistics.misses;
+    auto* frame = TRY(find_unused_frame());
+
+    if (read_from_file) {
+        TRY(m_file->seek(index * Block::SIZE, SeekMode::SetPosition));
+        TRY(m_file->read_until_filled(frame->data));
+    }
+
+    frame->block_index = index;
+    frame->pin_count = 1;
+    frame->dirty = false;
+    frame->referenced = true;
+    TRY(m_frame_indices.try_set(index, frame - m_frames.data()));
+    return frame;
+}
+
+void Heap::unpin_frame(Frame& frame)
+{
+    VERIFY(frame.pin_count > 0);
+    --frame.pin_count;
+}
+
+ErrorOr<ByteBuffer> Heap::read_raw_block(Block::Index index)
+{
+    auto* frame = TRY(pin_frame(index));
+    ScopeGuard unpin = [&] { unpin_frame(*frame); };
+
+    return ByteBuffer::copy(frame->data);
 }
 
 ErrorOr<Block> Heap::read_block(Block::Index index)
 {
     dbgln_if(SQL_DEBUG, "{}({})", __FUNCTION__, index);
 
-    auto buffer = TRY(read_raw_block(index));
-    auto size_in_bytes = *reinterpret_cast<u32*>(buffer.offset_pointer(0));
-    auto next_block = *reinterpret_cast<Block::Index*>(buffer.offset_pointer(sizeof(u32)));
-    auto data = TRY(buffer.slice(Block::HEADER_SIZE, Block::DATA_SIZE));
+    auto* frame = TRY(pin_frame(index));
+    ScopeGuard unpin = [&] { unpin_frame(*frame); };
+
+    auto size_in_bytes = *reinterpret_cast<u32*>(frame->data.offset_pointer(0));
+    auto next_block = *reinterpret_cast<Block::Index*>(frame->data.offset_pointer(sizeof(u32)));
+    auto data = TRY(frame->data.slice(Block::HEADER_SIZE, Block::DATA_SIZE));
 
     return Block { index, size_in_bytes, next_block, move(data) };
 }
@@ -214,13 +292,17 @@ ErrorOr<void> Heap::write_raw_block(Block::Index index, ReadonlyBytes data)
     return {};
 }
 
-ErrorOr<void> Heap::write_raw_block_to_wal(Block::Index index, ByteBuffer&& data)
+ErrorOr<void> Heap::write_raw_block_to_buffer_pool(Block::Index index, ReadonlyBytes data)
 {
     dbgln_if(SQL_DEBUG, "{}({})", __FUNCTION__, index);
     VERIFY(index < m_next_block);
     VERIFY(data.size() == Block::SIZE);
 
-    TRY(m_write_ahead_log.try_set(index, move(data)));
+    // The block is overwritten completely, so there is no need to read it first.
+    auto* frame = TRY(pin_frame(index, false));
+    data.copy_to(frame->data);
+    frame->dirty = true;
+    unpin_frame(*frame);
 
     return {};
 }
@@ -236,13 +318,13 @@ ErrorOr<void> Heap::write_block(Block const& block)
     auto size_in_bytes = block.size_in_bytes();
     auto next_block = block.next_block();
 
-    auto heap_data = TRY(ByteBuffer::create_zeroed(Block::SIZE));
-    heap_data.overwrite(0, &size_in_bytes, sizeof(size_in_bytes));
-    heap_data.overwrite(sizeof(size_in_bytes), &next_block, sizeof(next_block));
+    Array<u8, Block::SIZE> heap_data {};
+    heap_data.span().overwrite(0, &size_in_bytes, sizeof(size_in_bytes));
+    heap_data.span().overwrite(sizeof(size_in_bytes), &next_block, sizeof(next_block));
 
-    block.data().bytes().copy_to(heap_data.bytes().slice(Block::HEADER_SIZE));
+    block.data().bytes().copy_to(heap_data.span().slice(Block::HEADER_SIZE));
 
-    return write_raw_block_to_wal(block.index(), move(heap_data));
+    return write_raw_block_to_buffer_pool(block.index(), heap_data);
 }
 
 ErrorOr<void> Heap::free_storage(Block::Index index)
@@ -267,8 +349,8 @@ ErrorOr<void> Heap::free_block(Block const& block)
     VERIFY(has_block(index));
 
     // Zero out freed blocks to facilitate a free block scan upon opening the database later
-    auto zeroed_data = TRY(ByteBuffer::create_zeroed(Block::SIZE));
-    TRY(write_raw_block_to_wal(index, move(zeroed_data)));
+    Array<u8, Block::SIZE> zeroed_data {};
+    TRY(write_raw_block_to_buffer_pool(index, zeroed_data));
 
     return m_free_block_indices.try_append(index);
 }
@@ -276,15 +358,21 @@ ErrorOr<void> Heap::free_block(Block const& block)
 ErrorOr<void> Heap::flush()
 {
     VERIFY(m_file);
-    auto indices = m_write_ahead_log.keys();
-    quick_sort(indices);
-    for (auto index : indices) {
-        dbgln_if(SQL_DEBUG, "Flushing block {}", index);
-        auto& data = m_write_ahead_log.get(index).value();
-        TRY(write_raw_block(index, data));
+
+    // Write the blocks in file order, so that the file grows sequentially.
+    Vector<Frame*> dirty_frames;
+    for (auto& frame : m_frames) {
+        if (frame.dirty)
+            TRY(dirty_frames.try_append(&frame));
+    }
+    quick_sort(dirty_frames, [](auto const* a, auto const* b) { return a->block_index < b->block_index; });
+
+    for (auto* frame : dirty_frames) {
+        dbgln_if(SQL_DEBUG, "Flushing block {}", frame->block_index);
+        TRY(write_raw_block(frame->block_index, frame->data));
+        frame->dirty = false;
     }
-    m_write_ahead_log.clear();
-    dbgln_if(SQL_DEBUG, "WAL flushed; new number of blocks = {}", m_highest_block_written);
+    dbgln_if(SQL_DEBUG, "Buffer pool flushed; new number of blocks = {}", m_highest_block_written);
     return {};
 }
 
@@ -293,7 +381,8 @@ constexpr static auto VERSION_OFFSET = FILE_ID.length();
 constexpr static auto SCHEMAS_ROOT_OFFSET = VERSION_OFFSET + sizeof(u32);
 constexpr static auto TABLES_ROOT_OFFSET = SCHEMAS_ROOT_OFFSET + sizeof(u32);
 constexpr static auto TABLE_COLUMNS_ROOT_OFFSET = TABLES_ROOT_OFFSET + sizeof(u32);
-constexpr static auto USER_VALUES_OFFSET = TABLE_COLUMNS_ROOT_OFFSET + sizeof(u32);
+constexpr static auto INDEXES_ROOT_OFFSET = TABLE_COLUMNS_ROOT_OFFSET + sizeof(u32);
+constexpr static auto USER_VALUES_OFFSET = INDEXES_ROOT_OFFSET + sizeof(u32);
 
 ErrorOr<void> Heap::read_zero_block()
 {
@@ -319,6 +408,9 @@ ErrorOr<void> Heap::read_zero_block()
     memcpy(&m_table_columns_root, block.offset_pointer(TABLE_COLUMNS_ROOT_OFFSET), sizeof(u32));
     dbgln_if(SQL_DEBUG, "Table columns root node: {}", m_table_columns_root);
 
+    memcpy(&m_indexes_root, block.offset_pointer(INDEXES_ROOT_OFFSET), sizeof(u32));
+    dbgln_if(SQL_DEBUG, "Indexes root node: {}", m_indexes_root);
+
     memcpy(m_user_values.data(), block.offset_pointer(USER_VALUES_OFFSET), m_user_values.size() * sizeof(u32));
     for (auto ix = 0u; ix < m_user_values.size(); ix++) {
         if (m_user_values[ix])
@@ -334,6 +426,7 @@ ErrorOr<void> Heap::update_zero_block()
     dbgln_if(SQL_DEBUG, "Schemas root node: {}", m_schemas_root);
     dbgln_if(SQL_DEBUG, "Tables root node: {}", m_tables_root);
     dbgln_if(SQL_DEBUG, "Table Columns root node: {}", m_table_columns_root);
+    dbgln_if(SQL_DEBUG, "Indexes root node: {}", m_indexes_root);
     for (auto ix = 0u; ix < m_user_values.size(); ix++) {
         if (m_user_values[ix] > 0)
             dbgln_if(SQL_DEBUG, "User value {}: {}", ix, m_user_values[ix]);
@@ -346,9 +439,10 @@ ErrorOr<void> Heap::update_zero_block()
     buffer_bytes.overwrite(SCHEMAS_ROOT_OFFSET, &m_schemas_root, sizeof(u32));
     buffer_bytes.overwrite(TABLES_ROOT_OFFSET, &m_tables_root, sizeof(u32));
     buffer_bytes.overwrite(TABLE_COLUMNS_ROOT_OFFSET, &m_table_columns_root, sizeof(u32));
+    buffer_bytes.overwrite(INDEXES_ROOT_OFFSET, &m_indexes_root, sizeof(u32));
     buffer_bytes.overwrite(USER_VALUES_OFFSET, m_user_values.data(), m_user_values.size() * sizeof(u32));
 
-    return write_raw_block_to_wal(0, move(buffer));
+    return write_raw_block_to_buffer_pool(0, buffer);
 }
 
 ErrorOr<void> Heap::initialize_zero_block()
@@ -357,6 +451,7 @@ ErrorOr<void> Heap::initialize_zero_block()
     m_schemas_root = 0;
     m_tables_root = 0;
     m_table_columns_root = 0;
+    m_indexes_root = 0;
     m_next_block = 1;
     m_highest_block_written = 0;
     for (auto& user : m_user_values)
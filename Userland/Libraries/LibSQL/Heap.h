@@ -63,12 +63,27 @@ private:
  *
  * A Heap can be thought of the backing storage of a single database. It's
  * assumed that a single SQL database is backed by a single Heap.
+ *
+ * Blocks are read and written through a buffer pool holding a fixed number
+ * of blocks in memory. Blocks that are written are kept in the pool until
+ * flush() is called, or until their frame is needed for another block, in
+ * which case they are written to the file early. Frames to reuse are picked
+ * by the clock algorithm, which approximates evicting the least recently
+ * used block.
  */
 class Heap : public RefCounted<Heap> {
 public:
-    static constexpr u32 VERSION = 5;
+    static constexpr u32 VERSION = 6;
+    static constexpr size_t DEFAULT_BUFFER_POOL_CAPACITY = 2048;
+
+    struct BufferPoolStatistics {
+        size_t hits { 0 };
+        size_t misses { 0 };
+        size_t evictions { 0 };
+        size_t write_backs { 0 };
+    };
 
-    static ErrorOr<NonnullRefPtr<Heap>> create(ByteString);
+    static ErrorOr<NonnullRefPtr<Heap>> create(ByteString, size_t buffer_pool_capacity = DEFAULT_BUFFER_POOL_CAPACITY);
     virtual ~Heap();
 
     ByteString const& name() const { return m_name; }
@@ -102,6 +117,15 @@ public:
         m_table_columns_root = root;
         update_zero_block().release_value_but_fixme_should_propagate_errors();
     }
+
+    Block::Index indexes_root() const { return m_indexes_root; }
+
+    void set_indexes_root(Block::Index root)
+    {
+        m_indexes_root = root;
+        update_zero_block().release_value_but_fixme_should_propagate_errors();
+    }
+
     u32 version() const { return m_version; }
 
     u32 user_value(size_t index) const
@@ -121,12 +145,29 @@ public:
 
     ErrorOr<void> flush();
 
+    size_t buffer_pool_capacity() const { return m_buffer_pool_capacity; }
+    BufferPoolStatistics const& buffer_pool_statistics() const { return m_buffer_pool_statistics; }
+
 private:
-    explicit Heap(ByteString);
+    // A slot in the buffer pool, holding the contents of a single block.
+    struct Frame {
+        Block::Index block_index { 0 };
+        ByteBuffer data;
+        u32 pin_count { 0 };
+        bool dirty { false };
+        bool referenced { false };
+    };
+
+    Heap(ByteString, size_t buffer_pool_capacity);
 
     ErrorOr<ByteBuffer> read_raw_block(Block::Index);
     ErrorOr<void> write_raw_block(Block::Index, ReadonlyBytes);
-    ErrorOr<void> write_raw_block_to_wal(Block::Index, ByteBuffer&&);
+    ErrorOr<void> write_raw_block_to_buffer_pool(Block::Index, ReadonlyBytes);
+
+    // Pinned frames stay in the buffer pool until they are unpinned again.
+    ErrorOr<Frame*> pin_frame(Block::Index, bool read_from_file = true);
+    void unpin_frame(Frame&);
+    ErrorOr<Frame*> find_unused_frame();
 
     ErrorOr<Block> read_block(Block::Index);
     ErrorOr<void> write_block(Block const&);
@@ -144,9 +185,15 @@ private:
     Block::Index m_schemas_root { 0 };
     Block::Index m_tables_root { 0 };
     Block::Index m_table_columns_root { 0 };
+    Block::Index m_indexes_root { 0 };
     u32 m_version { VERSION };
     Array<u32, 16> m_user_values { 0 };
-    HashMap<Block::Index, ByteBuffer> m_write_ahead_log;
+
+    size_t m_buffer_pool_capacity { DEFAULT_BUFFER_POOL_CAPACITY };
+    Vector<Frame> m_frames;
+    HashMap<Block::Index, size_t> m_frame_indices;
+    size_t m_clock_hand { 0 };
+    BufferPoolStatistics m_buffer_pool_statistics;
     Vector<Block::Index> m_free_block_indices;
 };
 
@@ -22,6 +22,17 @@ public:
     Key(RefPtr<IndexDef>, Serializer&);
     RefPtr<IndexDef> index() const { return m_index; }
 
+    // Value::compare() considers NULL to be less than anything, including another NULL. The keys
+    // of an index need a total order though, so unlike Tuple::compare() this treats two NULLs as equal.
+    [[nodiscard]] int compare(Key const& other) const { return Tuple::compare(other, NullComparison::NullsAreEqual).value(); }
+
+    bool operator<(Key const& other) const { return compare(other) < 0; }
+    bool operator<=(Key const& other) const { return compare(other) <= 0; }
+    bool operator==(Key const& other) const { return compare(other) == 0; }
+    bool operator!=(Key const& other) const { return compare(other) != 0; }
+    bool operator>(Key const& other) const { return compare(other) > 0; }
+    bool operator>=(Key const& other) const { return compare(other) >= 0; }
+
 private:
     RefPtr<IndexDef> m_index { nullptr };
 };
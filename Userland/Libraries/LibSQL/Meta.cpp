@@ -134,6 +134,14 @@ void IndexDef::append_column(ByteString name, SQLType sql_type, Order sort_order
     m_key_definition.append(part);
 }
 
+void IndexDef::append_column(Key const& column)
+{
+    auto column_type = column["column_type"].to_int<UnderlyingType<SQLType>>();
+    VERIFY(column_type.has_value());
+
+    append_column(column["column_name"].to_byte_string(), static_cast<SQLType>(*column_type));
+}
+
 NonnullRefPtr<TupleDescriptor> IndexDef::to_tuple_descriptor() const
 {
     NonnullRefPtr<TupleDescriptor> ret = adopt_ref(*new TupleDescriptor);
@@ -149,6 +157,7 @@ Key IndexDef::key() const
     key["table_hash"] = parent()->key().hash();
     key["index_name"] = name();
     key["unique"] = unique() ? 1 : 0;
+    key.set_block_index(block_index());
     return key;
 }
 
@@ -159,6 +168,13 @@ Key IndexDef::make_key(TableDef const& table_def)
     return key;
 }
 
+Key IndexDef::make_column_key(IndexDef const& index_def)
+{
+    Key key(ColumnDef::index_def());
+    key["table_hash"] = index_def.key().hash();
+    return key;
+}
+
 NonnullRefPtr<IndexDef> IndexDef::index_def()
 {
     NonnullRefPtr<IndexDef> s_index_def = IndexDef::create("$index", true, 0).release_value_but_fixme_should_propagate_errors();
@@ -214,6 +230,25 @@ void TableDef::append_column(Key const& column)
     append_column(column["column_name"].to_byte_string(), static_cast<SQLType>(*column_type));
 }
 
+RefPtr<IndexDef> TableDef::index(StringView name) const
+{
+    for (auto& index : m_indexes) {
+        if (index->name() == name)
+            return index;
+    }
+    return nullptr;
+}
+
+void TableDef::append_index(NonnullRefPtr<IndexDef> index)
+{
+    m_indexes.append(move(index));
+}
+
+void TableDef::remove_index(IndexDef const& index)
+{
+    m_indexes.remove_first_matching([&](auto const& entry) { return entry.ptr() == &index; });
+}
+
 Key TableDef::make_key(SchemaDef const& schema_def)
 {
     return TableDef::make_key(schema_def.key());
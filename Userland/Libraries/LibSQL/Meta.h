@@ -114,10 +114,12 @@ public:
     bool unique() const { return m_unique; }
     [[nodiscard]] size_t size() const { return m_key_definition.size(); }
     void append_column(ByteString, SQLType, Order = Order::Ascending);
+    void append_column(Key const&);
     Key key() const override;
     [[nodiscard]] NonnullRefPtr<TupleDescriptor> to_tuple_descriptor() const;
     static NonnullRefPtr<IndexDef> index_def();
     static Key make_key(TableDef const& table_def);
+    static Key make_column_key(IndexDef const& index_def);
 
 private:
     IndexDef(TableDef*, ByteString, bool unique, u32 pointer);
@@ -139,6 +141,9 @@ public:
     size_t num_indexes() { return m_indexes.size(); }
     Vector<NonnullRefPtr<ColumnDef>> const& columns() const { return m_columns; }
     Vector<NonnullRefPtr<IndexDef>> const& indexes() const { return m_indexes; }
+    RefPtr<IndexDef> index(StringView name) const;
+    void append_index(NonnullRefPtr<IndexDef>);
+    void remove_index(IndexDef const&);
     [[nodiscard]] NonnullRefPtr<TupleDescriptor> to_tuple_descriptor() const;
 
     static NonnullRefPtr<IndexDef> index_def();
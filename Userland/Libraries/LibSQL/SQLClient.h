@@ -73,7 +73,7 @@ private:
 
     virtual void execution_success(u64 statement_id, u64 execution_id, Vector<ByteString> const& column_names, bool has_results, size_t created, size_t updated, size_t deleted) override;
     virtual void execution_error(u64 statement_id, u64 execution_id, SQLErrorCode const& code, ByteString const& message) override;
-    virtual void next_result(u64 statement_id, u64 execution_id, Vector<SQL::Value> const&) override;
+    virtual void next_results(u64 statement_id, u64 execution_id, Vector<Vector<SQL::Value>> const&) override;
     virtual void results_exhausted(u64 statement_id, u64 execution_id, size_t total_rows) override;
 };
 
@@ -120,6 +120,9 @@ void TreeNode::deserialize(Serializer& serializer)
         dbgln_if(SQL_DEBUG, "Right {}", right);
         VERIFY((right == 0) == m_is_leaf);
         m_down.empend(this, right);
+    } else {
+        // An empty node is a leaf root, either fresh or one that had all its entries removed.
+        m_down.empend(this, 0u);
     }
 }
 
@@ -222,6 +225,26 @@ TreeNode* TreeNode::node_for(Key const& key)
     return down_node(size())->node_for(key);
 }
 
+TreeNode* TreeNode::node_containing(Key const& key, size_t& index)
+{
+    auto* node = this;
+    while (true) {
+        size_t ix = 0;
+        for (; ix < node->size(); ix++) {
+            auto ret = key.compare((*node)[ix]);
+            if (ret == 0) {
+                index = ix;
+                return node;
+            }
+            if (ret < 0)
+                break;
+        }
+        if (node->is_leaf())
+            return nullptr;
+        node = node->down_node(ix);
+    }
+}
+
 Optional<u32> TreeNode::get(Key& key)
 {
     dump_if(SQL_DEBUG, ByteString::formatted("get({})", key.to_byte_string()));
@@ -247,8 +270,10 @@ Optional<u32> TreeNode::get(Key& key)
         }
     }
     if (m_entries.is_empty()) {
-        dbgln_if(SQL_DEBUG, "[#{}] {} Empty node??", block_index(), key.to_byte_string());
-        VERIFY_NOT_REACHED();
+        // Only the root can be empty, if all keys were removed from the tree.
+        dbgln_if(SQL_DEBUG, "[#{}] {} Empty node", block_index(), key.to_byte_string());
+        VERIFY(is_leaf() && !m_up);
+        return {};
     }
     if (is_leaf()) {
         dbgln_if(SQL_DEBUG, "[#{}] {} > {} -> 0",
@@ -316,7 +341,7 @@ void TreeNode::split()
         if (down.m_node != nullptr)
             down.m_node->m_up = new_node;
         new_node->m_entries.append(entry);
-        new_node->m_down.append(move(down));
+        new_node->m_down.append(DownPointer(new_node, down));
     }
 
     // Move the median key in the node one level up. Its right node will
@@ -331,6 +356,95 @@ void TreeNode::split()
     m_up->just_insert(median, new_node);
 }
 
+size_t TreeNode::index_of_child(TreeNode const& child) const
+{
+    for (size_t ix = 0; ix <= size(); ix++) {
+        if (m_down[ix].block_index() == child.block_index())
+            return ix;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+void TreeNode::adopt_down_pointer(size_t index, DownPointer& down)
+{
+    m_down.insert(index, DownPointer(this, down));
+    if (auto* node = m_down[index].m_node.ptr())
+        node->m_up = this;
+}
+
+bool TreeNode::borrow_for_empty_child(size_t child_index)
+{
+    auto* child = down_node(child_index);
+    VERIFY(child->size() == 0);
+
+    // Rotate the separator down into the empty child, and the nearest entry of a sibling up
+    // into the separator's place. Only possible if the sibling doesn't run empty itself.
+    if (child_index > 0) {
+        auto* left = down_node(child_index - 1);
+        if (left->size() > 1) {
+            child->m_entries.append(m_entries[child_index - 1]);
+            auto down = left->m_down.take_last();
+            child->adopt_down_pointer(0, down);
+            m_entries[child_index - 1] = left->m_entries.take_last();
+
+            tree().serializer().serialize_and_write(*left);
+            tree().serializer().serialize_and_write(*child);
+            tree().serializer().serialize_and_write(*this);
+            return true;
+        }
+    }
+
+    if (child_index < size()) {
+        auto* right = down_node(child_index + 1);
+        if (right->size() > 1) {
+            child->m_entries.append(m_entries[child_index]);
+            auto down = right->m_down.take_first();
+            child->adopt_down_pointer(child->m_down.size(), down);
+            m_entries[child_index] = right->m_entries.take_first();
+
+            tree().serializer().serialize_and_write(*right);
+            tree().serializer().serialize_and_write(*child);
+            tree().serializer().serialize_and_write(*this);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TreeNode::merge_empty_child(size_t child_index)
+{
+    auto* child = down_node(child_index);
+    VERIFY(child->size() == 0);
+
+    // The siblings have a single entry each, so merging the separator and the empty child's
+    // remaining down pointer into one of them can't overflow it.
+    if (child_index > 0) {
+        auto* left = down_node(child_index - 1);
+        left->m_entries.append(m_entries.take(child_index - 1));
+        left->adopt_down_pointer(left->m_down.size(), child->m_down[0]);
+        tree().serializer().serialize_and_write(*left);
+    } else {
+        auto* right = down_node(child_index + 1);
+        right->m_entries.prepend(m_entries.take(child_index));
+        right->adopt_down_pointer(0, child->m_down[0]);
+        tree().serializer().serialize_and_write(*right);
+    }
+
+    tree().free_node(*child);
+    m_down.remove(child_index);
+    tree().serializer().serialize_and_write(*this);
+}
+
+void TreeNode::free_subtree()
+{
+    if (!is_leaf()) {
+        for (size_t ix = 0; ix <= size(); ix++)
+            down_node(ix)->free_subtree();
+    }
+    tree().free_node(*this);
+}
+
 void TreeNode::dump_if(int flag, ByteString&& msg)
 {
     if (!flag)
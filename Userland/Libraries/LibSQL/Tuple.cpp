@@ -159,10 +159,21 @@ void Tuple::copy_from(Tuple const& other)
 }
 
 int Tuple::compare(Tuple const& other) const
+{
+    return compare(other, NullComparison::NullIsLess).value();
+}
+
+Optional<int> Tuple::compare(Tuple const& other, NullComparison null_comparison) const
 {
     auto num_values = min(m_data.size(), other.m_data.size());
     VERIFY(num_values > 0);
     for (auto ix = 0u; ix < num_values; ix++) {
+        if (m_data[ix].is_null() && other.m_data[ix].is_null()) {
+            if (null_comparison == NullComparison::NullsAreEqual)
+                continue;
+            if (null_comparison == NullComparison::NullsAreUnordered)
+                return {};
+        }
         auto ret = m_data[ix].compare(other.m_data[ix]);
         if (ret != 0) {
             if ((ix < m_descriptor->size()) && (*m_descriptor)[ix].order == Order::Descending)
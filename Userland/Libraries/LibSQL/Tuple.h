@@ -37,12 +37,13 @@ public:
     [[nodiscard]] ByteString to_byte_string() const;
     explicit operator ByteString() const { return to_byte_string(); }
 
-    bool operator<(Tuple const& other) const { return compare(other) < 0; }
-    bool operator<=(Tuple const& other) const { return compare(other) <= 0; }
-    bool operator==(Tuple const& other) const { return compare(other) == 0; }
-    bool operator!=(Tuple const& other) const { return compare(other) != 0; }
-    bool operator>(Tuple const& other) const { return compare(other) > 0; }
-    bool operator>=(Tuple const& other) const { return compare(other) >= 0; }
+    // Like in SQL, two tuples whose first differing part is NULL on both sides are neither equal nor ordered.
+    bool operator<(Tuple const& other) const { return compare(other, NullComparison::NullsAreUnordered).value_or(0) < 0; }
+    bool operator<=(Tuple const& other) const { return compare(other, NullComparison::NullsAreUnordered).value_or(1) <= 0; }
+    bool operator==(Tuple const& other) const { return compare(other, NullComparison::NullsAreUnordered).value_or(1) == 0; }
+    bool operator!=(Tuple const& other) const { return compare(other, NullComparison::NullsAreUnordered).value_or(1) != 0; }
+    bool operator>(Tuple const& other) const { return compare(other, NullComparison::NullsAreUnordered).value_or(0) > 0; }
+    bool operator>=(Tuple const& other) const { return compare(other, NullComparison::NullsAreUnordered).value_or(-1) >= 0; }
 
     [[nodiscard]] bool is_null() const { return m_data.is_empty(); }
     [[nodiscard]] bool has(ByteString const& name) const { return index_of(name).has_value(); }
@@ -69,6 +70,13 @@ public:
     [[nodiscard]] Vector<Value> take_data() { return move(m_data); }
 
 protected:
+    enum class NullComparison {
+        NullIsLess,
+        NullsAreEqual,
+        NullsAreUnordered,
+    };
+    [[nodiscard]] Optional<int> compare(Tuple const&, NullComparison) const;
+
     [[nodiscard]] Optional<size_t> index_of(StringView) const;
     void copy_from(Tuple const&);
     virtual void serialize(Serializer&) const;
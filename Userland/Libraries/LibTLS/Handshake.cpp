@@ -18,7 +18,9 @@ namespace TLS {
 
 ByteBuffer TLSv12::build_hello()
 {
-    fill_with_random(m_context.local_random);
+    // The ClientHello after a HelloRetryRequest keeps the same random.
+    if (!m_context.tls13.did_receive_hello_retry_request)
+        fill_with_random(m_context.local_random);
 
     auto packet_version = (u16)m_context.options.version;
     auto version = (u16)m_context.options.version;
@@ -39,27 +41,21 @@ ByteBuffer TLSv12::build_hello()
     if (m_context.session_id_size)
         builder.append(m_context.session_id, m_context.session_id_size);
 
-    size_t extension_length = 0;
     size_t alpn_length = 0;
-    size_t alpn_negotiated_length = 0;
-
-    // ALPN
-    if (!m_context.negotiated_alpn.is_empty()) {
-        alpn_negotiated_length = m_context.negotiated_alpn.length();
-        alpn_length = alpn_negotiated_length + 1;
-        extension_length += alpn_length + 6;
-    } else if (m_context.alpn.size()) {
-        for (auto& alpn : m_context.alpn) {
-            size_t length = alpn.length();
-            alpn_length += length + 1;
-        }
-        if (alpn_length)
-            extension_length += alpn_length + 6;
+    for (auto& alpn : m_context.alpn) {
+        VERIFY(!alpn.is_empty() && alpn.length() <= 255);
+        alpn_length += alpn.length() + 1;
     }
 
     // Ciphers
-    builder.append((u16)(m_context.options.usable_cipher_suites.size() * sizeof(u16)));
-    for (auto suite : m_context.options.usable_cipher_suites)
+    bool offer_tls_1_3 = supports_version(ProtocolVersion::VERSION_1_3);
+    Vector<CipherSuite, 16> cipher_suites;
+    for (auto suite : m_context.options.usable_cipher_suites) {
+        if (offer_tls_1_3 || !is_tls13_cipher_suite(suite))
+            cipher_suites.append(suite);
+    }
+    builder.append((u16)(cipher_suites.size() * sizeof(u16)));
+    for (auto suite : cipher_suites)
         builder.append((u16)suite);
 
     // we don't like compression
@@ -77,20 +73,9 @@ ByteBuffer TLSv12::build_hello()
     bool supports_elliptic_curves = elliptic_curves_length && supported_ec_point_formats_length;
     bool enable_extended_master_secret = m_context.options.enable_extended_master_secret;
 
-    // signature_algorithms: 2b extension ID, 2b extension length, 2b vector length, 2xN signatures and hashes
-    extension_length += 2 + 2 + 2 + 2 * m_context.options.supported_signature_algorithms.size();
-
-    if (sni_length)
-        extension_length += sni_length + 9;
-
-    // Only send elliptic_curves and ec_point_formats extensions if both are supported
-    if (supports_elliptic_curves)
-        extension_length += 6 + elliptic_curves_length + 5 + supported_ec_point_formats_length;
-
-    if (enable_extended_master_secret)
-        extension_length += 4;
-
-    builder.append((u16)extension_length);
+    // extensions length (for later)
+    auto extensions_length_position = builder.length();
+    builder.append((u16)0);
 
     if (sni_length) {
         // SNI extension
@@ -141,20 +126,33 @@ ByteBuffer TLSv12::build_hello()
     }
 
     if (alpn_length) {
-        // TODO
-        VERIFY_NOT_REACHED();
+        // application_layer_protocol_negotiation extension
+        builder.append((u16)ExtensionType::APPLICATION_LAYER_PROTOCOL_NEGOTIATION);
+        builder.append((u16)(alpn_length + 2));
+        builder.append((u16)alpn_length);
+        for (auto& alpn : m_context.alpn) {
+            builder.append((u8)alpn.length());
+            builder.append(alpn.bytes());
+        }
     }
 
+    // The TLS 1.3 extensions go last, as pre_shared_key has to be the very last one.
+    if (offer_tls_1_3)
+        build_tls13_hello_extensions(builder);
+
+    builder.set_u16(extensions_length_position, builder.length() - extensions_length_position - 2);
+
     // set the "length" field of the packet
-    size_t remaining = builder.length() - start_length;
     size_t payload_position = 6;
-    builder.set(payload_position, remaining / 0x10000);
-    remaining %= 0x10000;
-    builder.set(payload_position + 1, remaining / 0x100);
-    remaining %= 0x100;
-    builder.set(payload_position + 2, remaining);
+    builder.set_u24(payload_position, builder.length() - start_length);
 
     auto packet = builder.build();
+    if (m_context.tls13.did_offer_pre_shared_key) {
+        if (auto result = write_tls13_pre_shared_key_binder(packet); result.is_error()) {
+            dbgln("Failed to compute the pre-shared key binder: {}", result.error());
+            VERIFY_NOT_REACHED();
+        }
+    }
     update_packet(packet);
 
     return packet;
@@ -228,7 +226,15 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
 
     // TODO: Compare Hashes
     dbgln_if(TLS_DEBUG, "FIXME: handle_handshake_finished :: Check message validity");
+    did_complete_handshake();
+
+    return index + size;
+}
+
+void TLSv12::did_complete_handshake()
+{
     m_context.connection_status = ConnectionStatus::Established;
+    m_context.handshake_duration = MonotonicTime::now() - m_context.handshake_start_time;
 
     if (m_handshake_timeout_timer) {
         // Disable the handshake timeout timer as handshake has been established.
@@ -239,8 +245,81 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
 
     if (on_connected)
         on_connected();
+}
 
-    return index + size;
+void TLSv12::send_alert_for_error(Error error)
+{
+    switch (error) {
+    case Error::UnexpectedMessage: {
+        auto packet = build_alert(true, (u8)AlertDescription::UNEXPECTED_MESSAGE);
+        write_packet(packet);
+        break;
+    }
+    case Error::CompressionNotSupported: {
+        auto packet = build_alert(true, (u8)AlertDescription::DECOMPRESSION_FAILURE_RESERVED);
+        write_packet(packet);
+        break;
+    }
+    case Error::BrokenPacket: {
+        auto packet = build_alert(true, (u8)AlertDescription::DECODE_ERROR);
+        write_packet(packet);
+        break;
+    }
+    case Error::NotVerified: {
+        auto packet = build_alert(true, (u8)AlertDescription::BAD_RECORD_MAC);
+        write_packet(packet);
+        break;
+    }
+    case Error::BadCertificate: {
+        auto packet = build_alert(true, (u8)AlertDescription::BAD_CERTIFICATE);
+        write_packet(packet);
+        break;
+    }
+    case Error::UnsupportedCertificate: {
+        auto packet = build_alert(true, (u8)AlertDescription::UNSUPPORTED_CERTIFICATE);
+        write_packet(packet);
+        break;
+    }
+    case Error::NoCommonCipher: {
+        auto packet = build_alert(true, (u8)AlertDescription::INSUFFICIENT_SECURITY);
+        write_packet(packet);
+        break;
+    }
+    case Error::NotUnderstood:
+    case Error::OutOfMemory: {
+        auto packet = build_alert(true, (u8)AlertDescription::INTERNAL_ERROR);
+        write_packet(packet);
+        break;
+    }
+    case Error::NoRenegotiation: {
+        auto packet = build_alert(true, (u8)AlertDescription::NO_RENEGOTIATION_RESERVED);
+        write_packet(packet);
+        break;
+    }
+    case Error::DecryptionFailed: {
+        auto packet = build_alert(true, (u8)AlertDescription::DECRYPTION_FAILED_RESERVED);
+        write_packet(packet);
+        break;
+    }
+    case Error::NotSafe: {
+        auto packet = build_alert(true, (u8)AlertDescription::DECRYPT_ERROR);
+        write_packet(packet);
+        break;
+    }
+    case Error::IllegalParameter: {
+        auto packet = build_alert(true, (u8)AlertDescription::ILLEGAL_PARAMETER);
+        write_packet(packet);
+        break;
+    }
+    case Error::NeedMoreData:
+        // Ignore this, as it's not an "error"
+        dbgln_if(TLS_DEBUG, "More data needed");
+        break;
+    default:
+        dbgln("Unknown TLS::Error with value {}", (i8)error);
+        VERIFY_NOT_REACHED();
+        break;
+    }
 }
 
 ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
@@ -430,76 +509,19 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
             update_hash(buffer.slice(0, payload_size + 1), 0);
         }
 
+        // With TLS 1.3, the handshake keys depend on the transcript up to and including the ServerHello.
+        if (type == HandshakeType::SERVER_HELLO && payload_res >= 0 && m_context.tls13.is_negotiated) {
+            // Nothing may follow the ServerHello in the same record, as the keys change right after it.
+            if (buffer_length != payload_size + 1)
+                payload_res = (i8)Error::UnexpectedMessage;
+            else
+                payload_res = finish_tls13_server_hello();
+        }
+
         // if something went wrong, send an alert about it
         if (payload_res < 0) {
-            switch ((Error)payload_res) {
-            case Error::UnexpectedMessage: {
-                auto packet = build_alert(true, (u8)AlertDescription::UNEXPECTED_MESSAGE);
-                write_packet(packet);
-                break;
-            }
-            case Error::CompressionNotSupported: {
-                auto packet = build_alert(true, (u8)AlertDescription::DECOMPRESSION_FAILURE_RESERVED);
-                write_packet(packet);
-                break;
-            }
-            case Error::BrokenPacket: {
-                auto packet = build_alert(true, (u8)AlertDescription::DECODE_ERROR);
-                write_packet(packet);
-                break;
-            }
-            case Error::NotVerified: {
-                auto packet = build_alert(true, (u8)AlertDescription::BAD_RECORD_MAC);
-                write_packet(packet);
-                break;
-            }
-            case Error::BadCertificate: {
-                auto packet = build_alert(true, (u8)AlertDescription::BAD_CERTIFICATE);
-                write_packet(packet);
-                break;
-            }
-            case Error::UnsupportedCertificate: {
-                auto packet = build_alert(true, (u8)AlertDescription::UNSUPPORTED_CERTIFICATE);
-                write_packet(packet);
-                break;
-            }
-            case Error::NoCommonCipher: {
-                auto packet = build_alert(true, (u8)AlertDescription::INSUFFICIENT_SECURITY);
-                write_packet(packet);
-                break;
-            }
-            case Error::NotUnderstood:
-            case Error::OutOfMemory: {
-                auto packet = build_alert(true, (u8)AlertDescription::INTERNAL_ERROR);
-                write_packet(packet);
-                break;
-            }
-            case Error::NoRenegotiation: {
-                auto packet = build_alert(true, (u8)AlertDescription::NO_RENEGOTIATION_RESERVED);
-                write_packet(packet);
-                break;
-            }
-            case Error::DecryptionFailed: {
-                auto packet = build_alert(true, (u8)AlertDescription::DECRYPTION_FAILED_RESERVED);
-                write_packet(packet);
-                break;
-            }
-            case Error::NotSafe: {
-                auto packet = build_alert(true, (u8)AlertDescription::DECRYPT_ERROR);
-                write_packet(packet);
-                break;
-            }
-            case Error::NeedMoreData:
-                // Ignore this, as it's not an "error"
-                dbgln_if(TLS_DEBUG, "More data needed");
-                break;
-            default:
-                dbgln("Unknown TLS::Error with value {}", payload_res);
-                VERIFY_NOT_REACHED();
-                break;
-            }
-            if (payload_res < 0)
-                return payload_res;
+            send_alert_for_error((Error)payload_res);
+            return payload_res;
         }
         switch (write_packets) {
         case WritePacketStage::Initial:
@@ -7,6 +7,7 @@
 
 #include <AK/Debug.h>
 #include <AK/Endian.h>
+#include <AK/GenericShorthands.h>
 #include <AK/Random.h>
 
 #include <LibCore/Timer.h>
@@ -25,7 +26,8 @@ namespace TLS {
 ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& write_packets)
 {
     write_packets = WritePacketStage::Initial;
-    if (m_context.connection_status != ConnectionStatus::Disconnected && m_context.connection_status != ConnectionStatus::Renegotiating) {
+    bool is_after_hello_retry_request = m_context.tls13.did_receive_hello_retry_request && m_context.tls13.state == TLS13HandshakeState::WaitServerHello;
+    if (m_context.connection_status != ConnectionStatus::Disconnected && m_context.connection_status != ConnectionStatus::Renegotiating && !is_after_hello_retry_request) {
         dbgln("unexpected hello message");
         return (i8)Error::UnexpectedMessage;
     }
@@ -85,11 +87,15 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         dbgln("No supported cipher could be agreed upon");
         return (i8)Error::NoCommonCipher;
     }
+    // The ServerHello after a HelloRetryRequest has to stick to the cipher suite it selected.
+    if (is_after_hello_retry_request && cipher != m_context.cipher)
+        return (i8)Error::IllegalParameter;
     m_context.cipher = cipher;
     dbgln_if(TLS_DEBUG, "Cipher: {}", enum_to_string(cipher));
 
     // Simplification: We only support handshake hash functions via HMAC
-    m_context.handshake_hash.initialize(hmac_hash());
+    if (m_context.handshake_hash.kind() == Crypto::Hash::HashKind::None)
+        m_context.handshake_hash.initialize(hmac_hash());
 
     // Compression method
     if (buffer.size() - res < 1)
@@ -105,6 +111,9 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         write_packets = WritePacketStage::ServerHandshake;
     }
 
+    // Only a supported_versions extension can make this a TLS 1.3 ServerHello.
+    m_context.tls13.is_negotiated = false;
+
     // Presence of extensions is determined by availability of bytes after compression_method
     if (buffer.size() - res >= 2) {
         auto extensions_bytes_total = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res += 2)));
@@ -151,27 +160,18 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
                 dbgln("SNI host_name: {}", m_context.extensions.SNI);
             }
         } else if (extension_type == ExtensionType::APPLICATION_LAYER_PROTOCOL_NEGOTIATION && m_context.alpn.size()) {
-            if (buffer.size() - res > 2) {
-                auto alpn_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
-                if (alpn_length && alpn_length <= extension_length - 2) {
-                    u8 const* alpn = buffer.offset_pointer(res + 2);
-                    size_t alpn_position = 0;
-                    while (alpn_position < alpn_length) {
-                        u8 alpn_size = alpn[alpn_position++];
-                        if (alpn_size + alpn_position >= extension_length)
-                            break;
-                        ByteString alpn_str { (char const*)alpn + alpn_position, alpn_length };
-                        if (alpn_size && m_context.alpn.contains_slow(alpn_str)) {
-                            m_context.negotiated_alpn = alpn_str;
-                            dbgln("negotiated alpn: {}", alpn_str);
-                            break;
-                        }
-                        alpn_position += alpn_length;
-                        if (!m_context.is_server) // server hello must contain one ALPN
-                            break;
-                    }
-                }
-            }
+            // The server picks exactly one of the protocols we offered, see RFC 7301, 3.1.
+            if (buffer.size() - res < extension_length)
+                return (i8)Error::NeedMoreData;
+            auto data = buffer.slice(res, extension_length);
+            if (data.size() < 3 || AK::convert_between_host_and_network_endian(ByteReader::load16(data.data())) != data.size() - 2 || data[2] != data.size() - 3)
+                return (i8)Error::BrokenPacket;
+            StringView protocol { data.slice(3) };
+            auto it = m_context.alpn.find_if([&](auto& offered) { return offered == protocol; });
+            if (it.is_end())
+                return (i8)Error::IllegalParameter;
+            m_context.negotiated_alpn = *it;
+            dbgln_if(TLS_DEBUG, "negotiated alpn: {}", *it);
             res += extension_length;
         } else if (extension_type == ExtensionType::SIGNATURE_ALGORITHMS) {
             dbgln("supported signatures: ");
@@ -191,12 +191,46 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         } else if (extension_type == ExtensionType::EXTENDED_MASTER_SECRET) {
             m_context.extensions.extended_master_secret = true;
             res += extension_length;
+        } else if (first_is_one_of(extension_type, ExtensionType::SUPPORTED_VERSIONS, ExtensionType::KEY_SHARE, ExtensionType::PRE_SHARED_KEY, ExtensionType::COOKIE)) {
+            auto result = handle_tls13_server_hello_extension(extension_type, buffer.slice(res, extension_length));
+            if (result < 0)
+                return result;
+            res += extension_length;
         } else {
             dbgln("Encountered unknown extension {} with length {}", enum_to_string(extension_type), extension_length);
             res += extension_length;
         }
     }
 
+    if (m_context.tls13.is_negotiated) {
+        if (!is_tls13_cipher_suite(m_context.cipher)) {
+            dbgln("TLS 1.3 was negotiated with a TLS 1.2 cipher suite");
+            return (i8)Error::IllegalParameter;
+        }
+        if (is_hello_retry_request()) {
+            if (auto result = handle_tls13_hello_retry_request(); result < 0)
+                return result;
+            return res;
+        }
+        m_context.tls13.state = TLS13HandshakeState::WaitEncryptedExtensions;
+        return res;
+    }
+
+    if (m_context.tls13.did_receive_hello_retry_request || m_context.tls13.did_resume_session || is_hello_retry_request() || is_tls13_cipher_suite(m_context.cipher)) {
+        dbgln("TLS 1.3 parameters in a TLS 1.2 ServerHello");
+        return (i8)Error::IllegalParameter;
+    }
+
+    // RFC 8446 section 4.1.3: A TLS 1.3 client has to reject a TLS 1.2 ServerHello that signals a downgrade.
+    if (supports_version(ProtocolVersion::VERSION_1_3)) {
+        constexpr auto downgrade_sentinel = "DOWNGRD"sv;
+        auto random_tail = ReadonlyBytes { m_context.remote_random, sizeof(m_context.remote_random) }.slice(24);
+        if (random_tail.slice(0, 7) == downgrade_sentinel.bytes() && random_tail[7] <= 1) {
+            dbgln("Server signalled a downgrade from TLS 1.3");
+            return (i8)Error::IllegalParameter;
+        }
+    }
+
     return res;
 }
 
@@ -365,7 +399,9 @@ ssize_t TLSv12::verify_rsa_server_key_exchange(ReadonlyBytes server_key_info_buf
 {
     auto signature_hash = signature_buffer[0];
     auto signature_algorithm = static_cast<SignatureAlgorithm>(signature_buffer[1]);
-    if (signature_algorithm != SignatureAlgorithm::RSA) {
+    bool is_rsa_pss = signature_hash == (u8)HashAlgorithm::INTRINSIC
+        && first_is_one_of(signature_algorithm, SignatureAlgorithm::RSA_PSS_RSAE_SHA256, SignatureAlgorithm::RSA_PSS_RSAE_SHA384, SignatureAlgorithm::RSA_PSS_RSAE_SHA512);
+    if (signature_algorithm != SignatureAlgorithm::RSA && !is_rsa_pss) {
         dbgln("verify_rsa_server_key_exchange failed: Signature algorithm is not RSA, instead {}", enum_to_string(signature_algorithm));
         return (i8)Error::NotUnderstood;
     }
@@ -401,6 +437,14 @@ ssize_t TLSv12::verify_rsa_server_key_exchange(ReadonlyBytes server_key_info_buf
     message.overwrite(32, m_context.remote_random, 32);
     message.overwrite(64, server_key_info_buffer.data(), server_key_info_buffer.size());
 
+    if (is_rsa_pss) {
+        if (!verify_rsa_pss_signature(signature_algorithm, message, signature)) {
+            dbgln("verify_rsa_server_key_exchange failed: Verification of RSA-PSS signature failed");
+            return (i8)Error::NotSafe;
+        }
+        return 0;
+    }
+
     Crypto::Hash::HashKind hash_kind;
     switch ((HashAlgorithm)signature_hash) {
     case HashAlgorithm::SHA1:
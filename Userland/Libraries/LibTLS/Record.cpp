@@ -76,7 +76,9 @@ void TLSv12::update_packet(ByteBuffer& packet)
                 update_hash(packet.bytes(), header_size);
             }
         }
-        if (m_context.cipher_spec_set && m_context.crypto.created) {
+        if (m_context.tls13.has_local_keys) {
+            tls13_protect_record(packet);
+        } else if (m_context.cipher_spec_set && m_context.crypto.created) {
             size_t length = packet.size() - header_size;
             size_t block_size = 0;
             size_t padding = 0;
@@ -345,8 +347,22 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
     auto plain = buffer.slice(buffer_position, buffer.size() - buffer_position);
 
     ByteBuffer decrypted;
+    bool is_tls13_protected = false;
 
-    if (m_context.cipher_spec_set && type != ContentType::CHANGE_CIPHER_SPEC) {
+    if (m_context.tls13.has_remote_keys && type != ContentType::CHANGE_CIPHER_SPEC) {
+        // TLS 1.3 protected records all claim to be application data, the real type is part of the encrypted content.
+        if (type != ContentType::APPLICATION_DATA) {
+            dbgln("unexpected unprotected {} record", enum_to_string(type));
+            auto packet = build_alert(true, (u8)AlertDescription::UNEXPECTED_MESSAGE);
+            write_packet(packet);
+            return (i8)Error::UnexpectedMessage;
+        }
+        if (auto result = tls13_unprotect_record(buffer.slice(0, header_size), buffer.slice(header_size, length), decrypted, type); result < 0)
+            return result;
+        plain = decrypted;
+        length = decrypted.size();
+        is_tls13_protected = true;
+    } else if (m_context.cipher_spec_set && type != ContentType::CHANGE_CIPHER_SPEC) {
         if constexpr (TLS_DEBUG) {
             dbgln("Encrypted: ");
             print_buffer(buffer.slice(header_size, length));
@@ -486,7 +502,9 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
             return (i8)return_value;
         }
     }
-    m_context.remote_sequence_number++;
+    // The TLS 1.3 compatibility change_cipher_spec records are not protected and don't count.
+    if (!m_context.tls13.is_negotiated || type != ContentType::CHANGE_CIPHER_SPEC)
+        m_context.remote_sequence_number++;
 
     switch (type) {
     case ContentType::APPLICATION_DATA:
@@ -509,10 +527,22 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
         break;
     case ContentType::HANDSHAKE:
         dbgln_if(TLS_DEBUG, "tls handshake message");
-        payload_res = handle_handshake_payload(plain);
+        if (m_context.tls13.has_remote_keys)
+            payload_res = handle_tls13_handshake_payload(plain);
+        else
+            payload_res = handle_handshake_payload(plain);
         break;
     case ContentType::CHANGE_CIPHER_SPEC:
-        if (m_context.connection_status != ConnectionStatus::KeyExchange) {
+        if (m_context.tls13.is_negotiated) {
+            // A TLS 1.3 server may send a single change_cipher_spec during the handshake for middlebox compatibility,
+            // it is to be ignored. See RFC 8446, section 5.
+            if (is_tls13_protected || length != 1 || plain[0] != 1 || m_context.connection_status == ConnectionStatus::Established) {
+                dbgln("unexpected change cipher message");
+                auto packet = build_alert(true, (u8)AlertDescription::UNEXPECTED_MESSAGE);
+                write_packet(packet);
+                payload_res = (i8)Error::UnexpectedMessage;
+            }
+        } else if (m_context.connection_status != ConnectionStatus::KeyExchange) {
             dbgln("unexpected change cipher message");
             auto packet = build_alert(true, (u8)AlertDescription::UNEXPECTED_MESSAGE);
             write_packet(packet);
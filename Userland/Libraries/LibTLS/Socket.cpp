@@ -123,6 +123,7 @@ void TLSv12::setup_connection()
                     m_handshake_timeout_timer->restart(m_max_wait_time_for_handshake_in_seconds * 1000);
                 }
             }).release_value_but_fixme_should_propagate_errors();
+        m_context.handshake_start_time = MonotonicTime::now();
         auto packet = build_hello();
         write_packet(packet);
         write_into_socket();
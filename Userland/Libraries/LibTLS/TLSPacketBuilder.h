@@ -54,6 +54,11 @@ public:
 
         append(buf, 3);
     }
+    inline void append_u32(u32 value)
+    {
+        value = AK::convert_between_host_and_network_endian(value);
+        append((u8 const*)&value, sizeof(value));
+    }
     inline void append(u8 const* data, size_t bytes)
     {
         if (bytes == 0)
@@ -80,6 +85,17 @@ public:
         VERIFY(offset < m_current_length);
         m_packet_data[offset] = value;
     }
+    inline void set_u16(size_t offset, u16 value)
+    {
+        set(offset, (u8)(value >> 8));
+        set(offset + 1, (u8)value);
+    }
+    inline void set_u24(size_t offset, u32 value)
+    {
+        set(offset, (u8)(value >> 16));
+        set(offset + 1, (u8)(value >> 8));
+        set(offset + 2, (u8)value);
+    }
     size_t length() const { return m_current_length; }
 
 private:
@@ -9,6 +9,7 @@
 #include "Certificate.h"
 #include <AK/IPv4Address.h>
 #include <AK/Queue.h>
+#include <AK/Time.h>
 #include <AK/WeakPtr.h>
 #include <LibCore/Notifier.h>
 #include <LibCore/Socket.h>
@@ -63,6 +64,7 @@ enum class Error : i8 {
     NeedMoreData = -21,
     TimedOut = -22,
     OutOfMemory = -23,
+    IllegalParameter = -24,
 };
 
 enum class WritePacketStage {
@@ -80,6 +82,17 @@ enum class ConnectionStatus {
     Established,
 };
 
+// The client states of RFC 8446, Appendix A.1.
+enum class TLS13HandshakeState {
+    WaitServerHello,
+    WaitEncryptedExtensions,
+    WaitCertificateOrCertificateRequest,
+    WaitCertificate,
+    WaitCertificateVerify,
+    WaitFinished,
+    Connected,
+};
+
 enum ClientVerificationStaus {
     Verified,
     VerificationNeeded,
@@ -95,7 +108,11 @@ enum ClientVerificationStaus {
 // the preferred order.
 //
 // https://wiki.mozilla.org/Security/Server_Side_TLS
+//
+// TLS 1.3 cipher suites only name the AEAD and the hash, the key exchange is negotiated separately.
 #define ENUMERATE_CIPHERS(C)                                                                                                                                      \
+    C(true, CipherSuite::TLS_AES_128_GCM_SHA256, KeyExchangeAlgorithm::Invalid, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 12, true)                     \
+    C(true, CipherSuite::TLS_AES_256_GCM_SHA384, KeyExchangeAlgorithm::Invalid, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 12, true)                     \
     C(true, CipherSuite::TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::ECDHE_ECDSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true) \
     C(true, CipherSuite::TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)     \
     C(true, CipherSuite::TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::ECDHE_ECDSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true) \
@@ -139,6 +156,25 @@ constexpr CipherAlgorithm get_cipher_algorithm(CipherSuite suite)
     }
 }
 
+constexpr bool is_tls13_cipher_suite(CipherSuite suite)
+{
+    return suite == CipherSuite::TLS_AES_128_GCM_SHA256 || suite == CipherSuite::TLS_AES_256_GCM_SHA384;
+}
+
+// A ticket from a TLS 1.3 NewSessionTicket message, which lets a later connection to the same server skip the
+// certificate exchange and resume with the pre-shared key derived from this connection (RFC 8446, section 4.6.1).
+// Tickets should only be used once.
+struct SessionTicket {
+    ByteBuffer ticket;
+    ByteBuffer pre_shared_key;
+    CipherSuite cipher_suite { CipherSuite::TLS_NULL_WITH_NULL_NULL };
+    u32 ticket_age_add { 0 };
+    MonotonicTime issue_time { MonotonicTime::now_coarse() };
+    Duration lifetime;
+
+    bool is_expired() const { return MonotonicTime::now_coarse() - issue_time >= lifetime; }
+};
+
 struct Options {
     static Vector<CipherSuite> default_usable_cipher_suites()
     {
@@ -170,7 +206,11 @@ struct Options {
     }
 
     OPTION_WITH_DEFAULTS(ProtocolVersion, version, ProtocolVersion::VERSION_1_2)
+    OPTION_WITH_DEFAULTS(bool, enable_tls_1_3, true)
     OPTION_WITH_DEFAULTS(Vector<SignatureAndHashAlgorithm>, supported_signature_algorithms,
+        { HashAlgorithm::INTRINSIC, SignatureAlgorithm::RSA_PSS_RSAE_SHA256 },
+        { HashAlgorithm::INTRINSIC, SignatureAlgorithm::RSA_PSS_RSAE_SHA384 },
+        { HashAlgorithm::INTRINSIC, SignatureAlgorithm::RSA_PSS_RSAE_SHA512 },
         { HashAlgorithm::SHA512, SignatureAlgorithm::RSA },
         { HashAlgorithm::SHA384, SignatureAlgorithm::RSA },
         { HashAlgorithm::SHA256, SignatureAlgorithm::RSA },
@@ -194,6 +234,12 @@ struct Options {
     OPTION_WITH_DEFAULTS(Function<void()>, finish_callback, [] {})
     OPTION_WITH_DEFAULTS(Function<Vector<Certificate>()>, certificate_provider, [] { return Vector<Certificate> {}; })
     OPTION_WITH_DEFAULTS(bool, enable_extended_master_secret, true)
+    // A ticket from an earlier TLS 1.3 connection to the same server to resume with, if the server agrees.
+    OPTION_WITH_DEFAULTS(Optional<SessionTicket>, session_ticket, )
+    // Called for each ticket the server sends over a TLS 1.3 connection.
+    OPTION_WITH_DEFAULTS(Function<void(SessionTicket)>, session_ticket_handler, [](auto) {})
+    // Application protocols to offer with ALPN, most preferred first. The one the server picks is available as alpn().
+    OPTION_WITH_DEFAULTS(Vector<ByteString>, alpn_protocols, )
 
 #undef OPTION_WITH_DEFAULTS
 };
@@ -315,6 +361,43 @@ struct Context {
     } server_diffie_hellman_params;
 
     OwnPtr<Crypto::Curves::EllipticCurve> server_key_exchange_curve;
+
+    MonotonicTime handshake_start_time { MonotonicTime::now() };
+    Optional<Duration> handshake_duration;
+
+    // State of a TLS 1.3 handshake, see RFC 8446. The client offers TLS 1.3 first, and all of this is only used if the
+    // server agrees to it.
+    struct {
+        bool is_negotiated { false };
+        TLS13HandshakeState state { TLS13HandshakeState::WaitServerHello };
+
+        SupportedGroup key_share_group { SupportedGroup::X25519 };
+        ByteBuffer key_share_private_key;
+        ByteBuffer server_key_share;
+        bool did_receive_hello_retry_request { false };
+        ByteBuffer cookie;
+
+        bool did_offer_pre_shared_key { false };
+        bool did_resume_session { false };
+
+        ByteBuffer client_handshake_traffic_secret;
+        ByteBuffer server_handshake_traffic_secret;
+        ByteBuffer client_application_traffic_secret;
+        ByteBuffer server_application_traffic_secret;
+        ByteBuffer master_secret;
+        ByteBuffer resumption_master_secret;
+
+        u8 local_iv[12];
+        u8 remote_iv[12];
+        bool has_local_keys { false };
+        bool has_remote_keys { false };
+
+        // Handshake messages may be split across records.
+        ByteBuffer handshake_message_buffer;
+
+        bool did_receive_certificate_request { false };
+        ByteBuffer certificate_request_context;
+    } tls13;
 };
 
 class TLSv12 final : public Core::Socket {
@@ -379,6 +462,11 @@ public:
 
     StringView alpn() const { return m_context.negotiated_alpn; }
 
+    ProtocolVersion negotiated_version() const { return m_context.tls13.is_negotiated ? ProtocolVersion::VERSION_1_3 : ProtocolVersion::VERSION_1_2; }
+    bool did_resume_session() const { return m_context.tls13.did_resume_session; }
+    // How long it took from sending the ClientHello until the connection was established.
+    Optional<Duration> handshake_duration() const { return m_context.handshake_duration; }
+
     bool supports_cipher(CipherSuite suite) const
     {
         switch (suite) {
@@ -394,7 +482,7 @@ public:
 
     bool supports_version(ProtocolVersion v) const
     {
-        return v == ProtocolVersion::VERSION_1_2;
+        return v == ProtocolVersion::VERSION_1_2 || (v == ProtocolVersion::VERSION_1_3 && m_context.options.enable_tls_1_3);
     }
 
     void alert(AlertLevel, AlertDescription);
@@ -449,9 +537,40 @@ private:
     ssize_t handle_handshake_payload(ReadonlyBytes);
     ssize_t handle_message(ReadonlyBytes);
 
+    void send_alert_for_error(Error);
+    void did_complete_handshake();
+
+    // TLS 1.3, see TLSv13.cpp.
+    void build_tls13_hello_extensions(PacketBuilder&);
+    ErrorOr<void> write_tls13_pre_shared_key_binder(ByteBuffer& client_hello);
+    bool is_hello_retry_request() const;
+    ssize_t handle_tls13_server_hello_extension(ExtensionType, ReadonlyBytes);
+    ssize_t handle_tls13_hello_retry_request();
+    ssize_t finish_tls13_server_hello();
+    ssize_t handle_tls13_handshake_payload(ReadonlyBytes);
+    ssize_t handle_tls13_handshake_message(HandshakeType, ReadonlyBytes message);
+    ssize_t handle_tls13_encrypted_extensions(ReadonlyBytes);
+    ssize_t handle_tls13_certificate_request(ReadonlyBytes);
+    ssize_t handle_tls13_certificate(ReadonlyBytes);
+    ssize_t handle_tls13_certificate_verify(ReadonlyBytes);
+    ssize_t handle_tls13_finished(ReadonlyBytes message);
+    ssize_t handle_tls13_new_session_ticket(ReadonlyBytes);
+    ssize_t handle_tls13_key_update(ReadonlyBytes);
+    ByteBuffer build_tls13_certificate();
+    ByteBuffer build_tls13_finished();
+    ByteBuffer build_tls13_key_update(bool update_requested);
+
+    ErrorOr<ByteBuffer> tls13_transcript_hash() const;
+    ErrorOr<void> tls13_derive_handshake_secrets();
+    ErrorOr<void> tls13_derive_application_secrets();
+    ErrorOr<void> tls13_set_traffic_keys(ReadonlyBytes traffic_secret, bool local);
+    void tls13_protect_record(ByteBuffer& packet);
+    ssize_t tls13_unprotect_record(ReadonlyBytes header, ReadonlyBytes ciphertext, ByteBuffer& plaintext, ContentType& inner_type);
+
     void pseudorandom_function(Bytes output, ReadonlyBytes secret, u8 const* label, size_t label_length, ReadonlyBytes seed, ReadonlyBytes seed_b);
 
     ssize_t verify_rsa_server_key_exchange(ReadonlyBytes server_key_info_buffer, ReadonlyBytes signature_buffer);
+    bool verify_rsa_pss_signature(SignatureAlgorithm, ReadonlyBytes message, ReadonlyBytes signature) const;
     ssize_t verify_ecdsa_server_key_exchange(ReadonlyBytes server_key_info_buffer, ReadonlyBytes signature_buffer);
 
     size_t key_length() const
@@ -0,0 +1,1029 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Endian.h>
+#include <AK/GenericShorthands.h>
+#include <AK/Memory.h>
+#include <LibCore/Timer.h>
+#include <LibCrypto/BigInt/UnsignedBigInteger.h>
+#include <LibCrypto/Curves/SECPxxxr1.h>
+#include <LibCrypto/Curves/X25519.h>
+#include <LibCrypto/Curves/X448.h>
+#include <LibCrypto/Hash/HKDF.h>
+#include <LibCrypto/Hash/SHA2.h>
+#include <LibCrypto/NumberTheory/ModularFunctions.h>
+#include <LibCrypto/PK/Code/EMSA_PSS.h>
+#include <LibTLS/TLSv12.h>
+#include <LibTLS/TLSv13.h>
+
+namespace TLS {
+
+using HKDF = Crypto::Hash::HKDF<Crypto::Hash::Manager>;
+
+// The random of a HelloRetryRequest, which is the SHA-256 of "HelloRetryRequest", see RFC 8446, section 4.1.3.
+static constexpr u8 hello_retry_request_random[32] = {
+    0xcf, 0x21, 0xad, 0x74, 0xe5, 0x9a, 0x61, 0x11, 0xbe, 0x1d, 0x8c, 0x02, 0x1e, 0x65, 0xb8, 0x91,
+    0xc2, 0xa2, 0x11, 0x16, 0x7a, 0xbb, 0x8c, 0x5e, 0x07, 0x9e, 0x09, 0xe2, 0xc8, 0xa8, 0x33, 0x9c
+};
+
+// Tickets may not be used for longer than seven days, see RFC 8446, section 4.6.1.
+static constexpr u32 maximum_ticket_lifetime_in_seconds = 7 * 24 * 60 * 60;
+
+static size_t hash_length_for(Crypto::Hash::HashKind kind)
+{
+    return Crypto::Hash::Manager(kind).digest_size();
+}
+
+static ErrorOr<ByteBuffer> hash_of(Crypto::Hash::HashKind kind, ReadonlyBytes data)
+{
+    Crypto::Hash::Manager hash(kind);
+    hash.update(data);
+    auto digest = hash.digest();
+    return ByteBuffer::copy(digest.immutable_data(), hash.digest_size());
+}
+
+static OwnPtr<Crypto::Curves::EllipticCurve> make_key_share_curve(SupportedGroup group)
+{
+    switch (group) {
+    case SupportedGroup::X25519:
+        return make<Crypto::Curves::X25519>();
+    case SupportedGroup::X448:
+        return make<Crypto::Curves::X448>();
+    case SupportedGroup::SECP256R1:
+        return make<Crypto::Curves::SECP256r1>();
+    case SupportedGroup::SECP384R1:
+        return make<Crypto::Curves::SECP384r1>();
+    default:
+        return nullptr;
+    }
+}
+
+// The per-record nonce is the IV XORed with the record sequence number, see RFC 8446, section 5.3.
+// Our GCM implementation takes a 16 byte IV, with the block counter in the last four bytes.
+static void compute_record_nonce(Bytes nonce, ReadonlyBytes iv, u64 sequence_number)
+{
+    VERIFY(nonce.size() == 16 && iv.size() == 12);
+    memcpy(nonce.data(), iv.data(), 12);
+    for (size_t i = 0; i < 8; ++i)
+        nonce[4 + i] ^= (u8)(sequence_number >> (56 - 8 * i));
+    memset(nonce.offset(12), 0, 4);
+}
+
+namespace TLS13 {
+
+Crypto::Hash::HashKind hash_kind_for_cipher_suite(CipherSuite suite)
+{
+    return suite == CipherSuite::TLS_AES_256_GCM_SHA384 ? Crypto::Hash::HashKind::SHA384 : Crypto::Hash::HashKind::SHA256;
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-7.1
+ErrorOr<ByteBuffer> expand_label(Crypto::Hash::HashKind kind, ReadonlyBytes secret, StringView label, ReadonlyBytes context, size_t length)
+{
+    // struct {
+    //     uint16 length = Length;
+    //     opaque label<7..255> = "tls13 " + Label;
+    //     opaque context<0..255> = Context;
+    // } HkdfLabel;
+    constexpr auto label_prefix = "tls13 "sv;
+    ByteBuffer hkdf_label;
+    TRY(hkdf_label.try_append((u8)(length >> 8)));
+    TRY(hkdf_label.try_append((u8)length));
+    TRY(hkdf_label.try_append((u8)(label_prefix.length() + label.length())));
+    TRY(hkdf_label.try_append(label_prefix.bytes()));
+    TRY(hkdf_label.try_append(label.bytes()));
+    TRY(hkdf_label.try_append((u8)context.size()));
+    TRY(hkdf_label.try_append(context));
+
+    return HKDF::expand(secret, hkdf_label, length, kind);
+}
+
+ErrorOr<ByteBuffer> derive_secret(Crypto::Hash::HashKind kind, ReadonlyBytes secret, StringView label, ReadonlyBytes transcript_hash)
+{
+    return expand_label(kind, secret, label, transcript_hash, hash_length_for(kind));
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.4.4
+ErrorOr<ByteBuffer> finished_verify_data(Crypto::Hash::HashKind kind, ReadonlyBytes base_key, ReadonlyBytes transcript_hash)
+{
+    auto finished_key = TRY(expand_label(kind, base_key, "finished"sv, {}, hash_length_for(kind)));
+    Crypto::Authentication::HMAC<Crypto::Hash::Manager> hmac(finished_key.bytes(), kind);
+    auto digest = hmac.process(transcript_hash);
+    return ByteBuffer::copy(digest.immutable_data(), hmac.digest_size());
+}
+
+void replace_client_hello_with_message_hash(Crypto::Hash::Manager& transcript)
+{
+    auto client_hello_hash = transcript.digest();
+    auto hash_length = transcript.digest_size();
+    u8 message_hash_header[4] = { (u8)HandshakeType::MESSAGE_HASH, 0, 0, (u8)hash_length };
+    transcript.update(message_hash_header, sizeof(message_hash_header));
+    transcript.update(client_hello_hash.immutable_data(), hash_length);
+}
+
+ErrorOr<ByteBuffer> protect_record(Crypto::Cipher::AESCipher::GCMMode& cipher, ReadonlyBytes iv, u64 sequence_number, ReadonlyBytes packet)
+{
+    constexpr size_t header_size = 5;
+    constexpr size_t tag_size = 16;
+    VERIFY(packet.size() >= header_size);
+
+    // TLSInnerPlaintext is the content followed by its real type, we don't add any padding.
+    auto inner_length = packet.size() - header_size + 1;
+    auto inner_plaintext = TRY(ByteBuffer::create_uninitialized(inner_length));
+    inner_plaintext.overwrite(0, packet.offset(header_size), inner_length - 1);
+    inner_plaintext[inner_length - 1] = packet[0];
+
+    // The outer header claims to be TLS 1.2 application data, and is the additional data of the AEAD.
+    auto record = TRY(ByteBuffer::create_uninitialized(header_size + inner_length + tag_size));
+    record[0] = (u8)ContentType::APPLICATION_DATA;
+    ByteReader::store(record.offset_pointer(1), AK::convert_between_host_and_network_endian((u16)ProtocolVersion::VERSION_1_2));
+    ByteReader::store(record.offset_pointer(3), AK::convert_between_host_and_network_endian((u16)(inner_length + tag_size)));
+
+    u8 nonce[16];
+    compute_record_nonce({ nonce, sizeof(nonce) }, iv, sequence_number);
+
+    cipher.encrypt(
+        inner_plaintext,
+        record.bytes().slice(header_size, inner_length),
+        { nonce, sizeof(nonce) },
+        record.bytes().slice(0, header_size),
+        record.bytes().slice(header_size + inner_length, tag_size));
+
+    return record;
+}
+
+Error unprotect_record(Crypto::Cipher::AESCipher::GCMMode& cipher, ReadonlyBytes iv, u64 sequence_number, ReadonlyBytes header, ReadonlyBytes ciphertext, ByteBuffer& plaintext, ContentType& inner_type)
+{
+    constexpr size_t tag_size = 16;
+    if (ciphertext.size() <= tag_size)
+        return Error::BrokenPacket;
+
+    auto plaintext_result = ByteBuffer::create_uninitialized(ciphertext.size() - tag_size);
+    if (plaintext_result.is_error())
+        return Error::OutOfMemory;
+    plaintext = plaintext_result.release_value();
+
+    u8 nonce[16];
+    compute_record_nonce({ nonce, sizeof(nonce) }, iv, sequence_number);
+
+    auto consistency = cipher.decrypt(
+        ciphertext.slice(0, plaintext.size()),
+        plaintext,
+        { nonce, sizeof(nonce) },
+        header,
+        ciphertext.slice(plaintext.size()));
+    if (consistency != Crypto::VerificationConsistency::Consistent)
+        return Error::IntegrityCheckFailed;
+
+    // The real content type is the last non-zero byte, anything after it is padding.
+    auto length = plaintext.size();
+    while (length > 0 && plaintext[length - 1] == 0)
+        --length;
+    if (length == 0)
+        return Error::UnexpectedMessage;
+    inner_type = static_cast<ContentType>(plaintext[length - 1]);
+    plaintext.trim(length - 1, false);
+    return Error::NoError;
+}
+
+bool verify_rsa_pss_signature(SignatureAlgorithm algorithm, Crypto::PK::RSAPublicKey<Crypto::UnsignedBigInteger> const& public_key, ReadonlyBytes message, ReadonlyBytes signature)
+{
+    auto const& modulus = public_key.modulus();
+    auto signature_integer = Crypto::UnsignedBigInteger::import_data(signature.data(), signature.size());
+    if (!(signature_integer < modulus))
+        return false;
+
+    auto encoded_message_integer = Crypto::NumberTheory::ModularPower(signature_integer, public_key.public_exponent(), modulus);
+    auto encoded_message_result = ByteBuffer::create_uninitialized(encoded_message_integer.trimmed_length() * sizeof(u32));
+    if (encoded_message_result.is_error())
+        return false;
+    auto encoded_message = encoded_message_result.release_value();
+    encoded_message_integer.export_data(encoded_message);
+
+    // The salt is as long as the hash, see RFC 8446, section 4.2.3.
+    auto encoded_message_bits = modulus.one_based_index_of_highest_set_bit() - 1;
+    Crypto::VerificationConsistency consistency;
+    switch (algorithm) {
+    case SignatureAlgorithm::RSA_PSS_RSAE_SHA256:
+        consistency = Crypto::PK::EMSA_PSS<Crypto::Hash::SHA256, Crypto::Hash::SHA256::DigestSize>().verify(message, encoded_message, encoded_message_bits);
+        break;
+    case SignatureAlgorithm::RSA_PSS_RSAE_SHA384:
+        consistency = Crypto::PK::EMSA_PSS<Crypto::Hash::SHA384, Crypto::Hash::SHA384::DigestSize>().verify(message, encoded_message, encoded_message_bits);
+        break;
+    case SignatureAlgorithm::RSA_PSS_RSAE_SHA512:
+        consistency = Crypto::PK::EMSA_PSS<Crypto::Hash::SHA512, Crypto::Hash::SHA512::DigestSize>().verify(message, encoded_message, encoded_message_bits);
+        break;
+    default:
+        return false;
+    }
+    return consistency == Crypto::VerificationConsistency::Consistent;
+}
+
+}
+
+using namespace TLS13;
+
+void TLSv12::build_tls13_hello_extensions(PacketBuilder& builder)
+{
+    m_context.tls13.did_offer_pre_shared_key = false;
+
+    auto group = m_context.tls13.key_share_group;
+    auto curve = make_key_share_curve(group);
+    VERIFY(curve);
+    if (m_context.tls13.key_share_private_key.is_empty()) {
+        auto private_key = curve->generate_private_key();
+        if (private_key.is_error()) {
+            dbgln("TLS 1.3: Failed to generate a key share: {}", private_key.error());
+            return;
+        }
+        m_context.tls13.key_share_private_key = private_key.release_value();
+    }
+    auto public_key_result = curve->generate_public_key(m_context.tls13.key_share_private_key);
+    if (public_key_result.is_error()) {
+        dbgln("TLS 1.3: Failed to generate a key share: {}", public_key_result.error());
+        return;
+    }
+    auto public_key = public_key_result.release_value();
+
+    // supported_versions, in order of preference
+    builder.append((u16)ExtensionType::SUPPORTED_VERSIONS);
+    builder.append((u16)5);
+    builder.append((u8)4);
+    builder.append((u16)ProtocolVersion::VERSION_1_3);
+    builder.append((u16)ProtocolVersion::VERSION_1_2);
+
+    // key_share, with a single share for the group we expect the server to pick.
+    // If it prefers another one, it asks for that with a HelloRetryRequest.
+    builder.append((u16)ExtensionType::KEY_SHARE);
+    builder.append((u16)(2 + 2 + 2 + public_key.size()));
+    builder.append((u16)(2 + 2 + public_key.size()));
+    builder.append((u16)group);
+    builder.append((u16)public_key.size());
+    builder.append(public_key);
+
+    if (!m_context.tls13.cookie.is_empty()) {
+        builder.append((u16)ExtensionType::COOKIE);
+        builder.append((u16)(2 + m_context.tls13.cookie.size()));
+        builder.append((u16)m_context.tls13.cookie.size());
+        builder.append(m_context.tls13.cookie);
+    }
+
+    // psk_key_exchange_modes, we only resume with a fresh (EC)DHE exchange (psk_dhe_ke) to keep forward secrecy.
+    builder.append((u16)ExtensionType::PSK_KEY_EXCHANGE_MODES);
+    builder.append((u16)2);
+    builder.append((u8)1);
+    builder.append((u8)1);
+
+    auto const& ticket = m_context.options.session_ticket;
+    if (!ticket.has_value() || ticket->is_expired() || !m_context.options.usable_cipher_suites.contains_slow(ticket->cipher_suite))
+        return;
+
+    // After a HelloRetryRequest, the ticket can only be used if it was issued for the hash of the selected cipher suite.
+    if (m_context.tls13.did_receive_hello_retry_request && hash_kind_for_cipher_suite(ticket->cipher_suite) != hmac_hash())
+        return;
+
+    // pre_shared_key, which has to be the last extension. The binder is filled in by write_tls13_pre_shared_key_binder()
+    // once the rest of the ClientHello is known.
+    auto hash_length = hash_length_for(hash_kind_for_cipher_suite(ticket->cipher_suite));
+    auto ticket_age = (MonotonicTime::now_coarse() - ticket->issue_time).to_milliseconds();
+    size_t identities_length = 2 + ticket->ticket.size() + 4;
+    size_t binders_length = 1 + hash_length;
+
+    builder.append((u16)ExtensionType::PRE_SHARED_KEY);
+    builder.append((u16)(2 + identities_length + 2 + binders_length));
+    builder.append((u16)identities_length);
+    builder.append((u16)ticket->ticket.size());
+    builder.append(ticket->ticket);
+    builder.append_u32((u32)ticket_age + ticket->ticket_age_add);
+    builder.append((u16)binders_length);
+    builder.append((u8)hash_length);
+    for (size_t i = 0; i < hash_length; ++i)
+        builder.append((u8)0);
+
+    m_context.tls13.did_offer_pre_shared_key = true;
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.2.11.2
+ErrorOr<void> TLSv12::write_tls13_pre_shared_key_binder(ByteBuffer& client_hello)
+{
+    constexpr size_t header_size = 5;
+    auto const& ticket = *m_context.options.session_ticket;
+    auto kind = hash_kind_for_cipher_suite(ticket.cipher_suite);
+    auto hash_length = hash_length_for(kind);
+
+    // The binder covers the ClientHello up to, but not including, the list of binders.
+    auto binders_length = 2 + 1 + hash_length;
+    auto partial_client_hello = client_hello.bytes().slice(header_size, client_hello.size() - header_size - binders_length);
+
+    // After a HelloRetryRequest, the transcript so far comes first.
+    auto transcript = m_context.tls13.did_receive_hello_retry_request ? m_context.handshake_hash.copy() : Crypto::Hash::Manager(kind);
+    transcript.update(partial_client_hello);
+    auto transcript_digest = transcript.digest();
+    ReadonlyBytes transcript_hash { transcript_digest.immutable_data(), hash_length };
+
+    auto early_secret = TRY(HKDF::extract({}, ticket.pre_shared_key, kind));
+    auto binder_key = TRY(derive_secret(kind, early_secret, "res binder"sv, TRY(hash_of(kind, {}))));
+    auto binder = TRY(finished_verify_data(kind, binder_key, transcript_hash));
+
+    client_hello.overwrite(client_hello.size() - hash_length, binder.data(), hash_length);
+    return {};
+}
+
+bool TLSv12::is_hello_retry_request() const
+{
+    return ReadonlyBytes { m_context.remote_random, sizeof(m_context.remote_random) } == ReadonlyBytes { hello_retry_request_random, sizeof(hello_retry_request_random) };
+}
+
+ssize_t TLSv12::handle_tls13_server_hello_extension(ExtensionType type, ReadonlyBytes data)
+{
+    switch (type) {
+    case ExtensionType::SUPPORTED_VERSIONS: {
+        if (data.size() != 2)
+            return (i8)Error::BrokenPacket;
+        auto version = static_cast<ProtocolVersion>(AK::convert_between_host_and_network_endian(ByteReader::load16(data.data())));
+        if (version != ProtocolVersion::VERSION_1_3 || !supports_version(version)) {
+            dbgln("TLS 1.3: Server selected an unsupported version {:04x}", (u16)version);
+            return (i8)Error::IllegalParameter;
+        }
+        m_context.tls13.is_negotiated = true;
+        return 0;
+    }
+    case ExtensionType::KEY_SHARE: {
+        auto key_share = ByteBuffer::copy(data);
+        if (key_share.is_error())
+            return (i8)Error::OutOfMemory;
+        m_context.tls13.server_key_share = key_share.release_value();
+        return 0;
+    }
+    case ExtensionType::PRE_SHARED_KEY: {
+        if (data.size() != 2)
+            return (i8)Error::BrokenPacket;
+        auto selected_identity = AK::convert_between_host_and_network_endian(ByteReader::load16(data.data()));
+        if (!m_context.tls13.did_offer_pre_shared_key || selected_identity != 0)
+            return (i8)Error::IllegalParameter;
+        m_context.tls13.did_resume_session = true;
+        return 0;
+    }
+    case ExtensionType::COOKIE: {
+        if (data.size() < 2)
+            return (i8)Error::BrokenPacket;
+        auto cookie_length = AK::convert_between_host_and_network_endian(ByteReader::load16(data.data()));
+        if (cookie_length == 0 || data.size() != 2u + cookie_length)
+            return (i8)Error::BrokenPacket;
+        auto cookie = ByteBuffer::copy(data.slice(2));
+        if (cookie.is_error())
+            return (i8)Error::OutOfMemory;
+        m_context.tls13.cookie = cookie.release_value();
+        return 0;
+    }
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.1.4
+ssize_t TLSv12::handle_tls13_hello_retry_request()
+{
+    if (m_context.tls13.did_receive_hello_retry_request) {
+        dbgln("TLS 1.3: Received a second HelloRetryRequest");
+        return (i8)Error::UnexpectedMessage;
+    }
+    m_context.tls13.did_receive_hello_retry_request = true;
+
+    // The key_share of a HelloRetryRequest only names the group the server wants a share for.
+    if (!m_context.tls13.server_key_share.is_empty()) {
+        if (m_context.tls13.server_key_share.size() != 2)
+            return (i8)Error::BrokenPacket;
+        auto group = static_cast<SupportedGroup>(AK::convert_between_host_and_network_endian(ByteReader::load16(m_context.tls13.server_key_share.data())));
+        if (group == m_context.tls13.key_share_group || !m_context.options.elliptic_curves.contains_slow(group) || !make_key_share_curve(group)) {
+            dbgln("TLS 1.3: HelloRetryRequest asked for an unexpected group {}", to_underlying(group));
+            return (i8)Error::IllegalParameter;
+        }
+        m_context.tls13.key_share_group = group;
+        m_context.tls13.key_share_private_key.clear();
+        m_context.tls13.server_key_share.clear();
+    } else if (m_context.tls13.cookie.is_empty()) {
+        // A HelloRetryRequest that would not change the ClientHello is not allowed.
+        return (i8)Error::IllegalParameter;
+    }
+
+    replace_client_hello_with_message_hash(m_context.handshake_hash);
+
+    // Another ServerHello follows the new ClientHello.
+    m_context.tls13.did_resume_session = false;
+    m_context.handshake_messages[2] = 0;
+    return 0;
+}
+
+ssize_t TLSv12::finish_tls13_server_hello()
+{
+    if (m_context.tls13.state == TLS13HandshakeState::WaitServerHello) {
+        // The HelloRetryRequest is in the transcript now, so the new ClientHello can go out.
+        dbgln_if(TLS_DEBUG, "> client hello after hello retry request");
+        auto packet = build_hello();
+        write_packet(packet);
+        return 0;
+    }
+
+    if (auto result = tls13_derive_handshake_secrets(); result.is_error()) {
+        dbgln("TLS 1.3: Failed to derive the handshake secrets: {}", result.error());
+        return (i8)Error::IllegalParameter;
+    }
+    return 0;
+}
+
+ErrorOr<ByteBuffer> TLSv12::tls13_transcript_hash() const
+{
+    auto hash = m_context.handshake_hash.copy();
+    auto digest = hash.digest();
+    return ByteBuffer::copy(digest.immutable_data(), hash.digest_size());
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-7.1
+ErrorOr<void> TLSv12::tls13_derive_handshake_secrets()
+{
+    auto kind = hmac_hash();
+    auto hash_length = hash_length_for(kind);
+
+    auto server_key_share = m_context.tls13.server_key_share.bytes();
+    if (server_key_share.size() < 4)
+        return AK::Error::from_string_literal("Missing key share");
+    auto group = static_cast<SupportedGroup>(AK::convert_between_host_and_network_endian(ByteReader::load16(server_key_share.data())));
+    auto key_exchange_length = AK::convert_between_host_and_network_endian(ByteReader::load16(server_key_share.offset(2)));
+    if (group != m_context.tls13.key_share_group || server_key_share.size() != 4u + key_exchange_length)
+        return AK::Error::from_string_literal("Invalid key share");
+
+    auto curve = make_key_share_curve(group);
+    VERIFY(curve);
+    auto shared_point = TRY(curve->compute_coordinate(m_context.tls13.key_share_private_key, server_key_share.slice(4)));
+    auto shared_secret = TRY(curve->derive_premaster_key(shared_point));
+
+    ByteBuffer pre_shared_key;
+    if (m_context.tls13.did_resume_session) {
+        auto const& ticket = *m_context.options.session_ticket;
+        if (hash_kind_for_cipher_suite(ticket.cipher_suite) != kind)
+            return AK::Error::from_string_literal("Resumed with a cipher suite of a different hash");
+        pre_shared_key = TRY(ByteBuffer::copy(ticket.pre_shared_key));
+    } else {
+        pre_shared_key = TRY(ByteBuffer::create_zeroed(hash_length));
+    }
+
+    auto empty_hash = TRY(hash_of(kind, {}));
+    auto early_secret = TRY(HKDF::extract({}, pre_shared_key, kind));
+    auto handshake_secret = TRY(HKDF::extract(TRY(derive_secret(kind, early_secret, "derived"sv, empty_hash)), shared_secret, kind));
+
+    auto transcript_hash = TRY(tls13_transcript_hash());
+    m_context.tls13.client_handshake_traffic_secret = TRY(derive_secret(kind, handshake_secret, "c hs traffic"sv, transcript_hash));
+    m_context.tls13.server_handshake_traffic_secret = TRY(derive_secret(kind, handshake_secret, "s hs traffic"sv, transcript_hash));
+
+    auto zeros = TRY(ByteBuffer::create_zeroed(hash_length));
+    m_context.tls13.master_secret = TRY(HKDF::extract(TRY(derive_secret(kind, handshake_secret, "derived"sv, empty_hash)), zeros, kind));
+
+    TRY(tls13_set_traffic_keys(m_context.tls13.server_handshake_traffic_secret, false));
+    TRY(tls13_set_traffic_keys(m_context.tls13.client_handshake_traffic_secret, true));
+    m_context.cipher_spec_set = true;
+
+    m_context.tls13.key_share_private_key.clear();
+    m_context.tls13.server_key_share.clear();
+    return {};
+}
+
+ErrorOr<void> TLSv12::tls13_derive_application_secrets()
+{
+    auto kind = hmac_hash();
+    auto transcript_hash = TRY(tls13_transcript_hash());
+    m_context.tls13.client_application_traffic_secret = TRY(derive_secret(kind, m_context.tls13.master_secret, "c ap traffic"sv, transcript_hash));
+    m_context.tls13.server_application_traffic_secret = TRY(derive_secret(kind, m_context.tls13.master_secret, "s ap traffic"sv, transcript_hash));
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-7.3
+ErrorOr<void> TLSv12::tls13_set_traffic_keys(ReadonlyBytes traffic_secret, bool local)
+{
+    auto kind = hmac_hash();
+    auto key_size = key_length();
+    auto key = TRY(expand_label(kind, traffic_secret, "key"sv, {}, key_size));
+    auto iv = TRY(expand_label(kind, traffic_secret, "iv"sv, {}, 12));
+
+    if (local) {
+        m_cipher_local = Crypto::Cipher::AESCipher::GCMMode(key, key_size * 8, Crypto::Cipher::Intent::Encryption, Crypto::Cipher::PaddingMode::RFC5246);
+        memcpy(m_context.tls13.local_iv, iv.data(), sizeof(m_context.tls13.local_iv));
+        m_context.local_sequence_number = 0;
+        m_context.tls13.has_local_keys = true;
+    } else {
+        m_cipher_remote = Crypto::Cipher::AESCipher::GCMMode(key, key_size * 8, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::RFC5246);
+        memcpy(m_context.tls13.remote_iv, iv.data(), sizeof(m_context.tls13.remote_iv));
+        m_context.remote_sequence_number = 0;
+        m_context.tls13.has_remote_keys = true;
+    }
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-5.2
+void TLSv12::tls13_protect_record(ByteBuffer& packet)
+{
+    auto record = protect_record(m_cipher_local.get<Crypto::Cipher::AESCipher::GCMMode>(), { m_context.tls13.local_iv, sizeof(m_context.tls13.local_iv) }, m_context.local_sequence_number, packet);
+    if (record.is_error()) {
+        dbgln("LibTLS: Failed to allocate enough memory for the ciphertext");
+        VERIFY_NOT_REACHED();
+    }
+    packet = record.release_value();
+}
+
+ssize_t TLSv12::tls13_unprotect_record(ReadonlyBytes header, ReadonlyBytes ciphertext, ByteBuffer& plaintext, ContentType& inner_type)
+{
+    // Records may not be longer than 2^14 bytes, plus 256 bytes for the AEAD expansion.
+    if (ciphertext.size() <= 16 || ciphertext.size() > 16 * KiB + 256) {
+        dbgln("TLS 1.3: Invalid protected record length {}", ciphertext.size());
+        auto packet = build_alert(true, (u8)AlertDescription::RECORD_OVERFLOW);
+        write_packet(packet);
+        return (i8)Error::BrokenPacket;
+    }
+
+    auto error = unprotect_record(m_cipher_remote.get<Crypto::Cipher::AESCipher::GCMMode>(), { m_context.tls13.remote_iv, sizeof(m_context.tls13.remote_iv) }, m_context.remote_sequence_number, header, ciphertext, plaintext, inner_type);
+    switch (error) {
+    case Error::NoError:
+        return 0;
+    case Error::IntegrityCheckFailed: {
+        dbgln("integrity check failed");
+        auto packet = build_alert(true, (u8)AlertDescription::BAD_RECORD_MAC);
+        write_packet(packet);
+        return (i8)error;
+    }
+    case Error::UnexpectedMessage: {
+        dbgln("TLS 1.3: Protected record without a content type");
+        auto packet = build_alert(true, (u8)AlertDescription::UNEXPECTED_MESSAGE);
+        write_packet(packet);
+        return (i8)error;
+    }
+    default:
+        dbgln("Failed to allocate memory for the packet");
+        return (i8)Error::DecryptionFailed;
+    }
+}
+
+ssize_t TLSv12::handle_tls13_handshake_payload(ReadonlyBytes payload)
+{
+    // Handshake messages may span several records, so they are collected until they are complete.
+    if (m_context.tls13.handshake_message_buffer.try_append(payload).is_error())
+        return (i8)Error::OutOfMemory;
+
+    size_t offset = 0;
+    auto buffer = m_context.tls13.handshake_message_buffer.bytes();
+    ssize_t result = 0;
+    while (buffer.size() - offset >= 4) {
+        auto type = static_cast<HandshakeType>(buffer[offset]);
+        size_t length = buffer[offset + 1] * 0x10000 + buffer[offset + 2] * 0x100 + buffer[offset + 3];
+        if (buffer.size() - offset - 4 < length)
+            break;
+
+        auto message = buffer.slice(offset, 4 + length);
+        offset += 4 + length;
+
+        auto previous_state = m_context.tls13.state;
+        result = handle_tls13_handshake_message(type, message);
+        if (result < 0) {
+            send_alert_for_error((Error)result);
+            break;
+        }
+
+        // Once the keys change, all messages under the old keys must have been received, see RFC 8446, section 5.1.
+        bool did_change_keys = (previous_state == TLS13HandshakeState::WaitFinished && m_context.tls13.state == TLS13HandshakeState::Connected)
+            || type == HandshakeType::KEY_UPDATE;
+        if (did_change_keys && offset != buffer.size()) {
+            dbgln("TLS 1.3: Handshake data left over after a key change");
+            result = (i8)Error::UnexpectedMessage;
+            send_alert_for_error((Error)result);
+            break;
+        }
+    }
+
+    if (result < 0)
+        return result;
+
+    if (offset == buffer.size())
+        m_context.tls13.handshake_message_buffer.clear();
+    else if (offset > 0)
+        m_context.tls13.handshake_message_buffer = MUST(ByteBuffer::copy(buffer.slice(offset)));
+
+    return payload.size();
+}
+
+ssize_t TLSv12::handle_tls13_handshake_message(HandshakeType type, ReadonlyBytes message)
+{
+    auto body = message.slice(4);
+    auto& state = m_context.tls13.state;
+    dbgln_if(TLS_DEBUG, "TLS 1.3 handshake message {} of length {}", enum_to_string(type), body.size());
+
+    // Messages after the handshake are not part of the transcript.
+    if (state == TLS13HandshakeState::Connected) {
+        switch (type) {
+        case HandshakeType::NEW_SESSION_TICKET:
+            return handle_tls13_new_session_ticket(body);
+        case HandshakeType::KEY_UPDATE:
+            return handle_tls13_key_update(body);
+        default:
+            dbgln("TLS 1.3: Unexpected {} after the handshake", enum_to_string(type));
+            return (i8)Error::UnexpectedMessage;
+        }
+    }
+
+    ssize_t result = 0;
+    switch (type) {
+    case HandshakeType::ENCRYPTED_EXTENSIONS:
+        if (state != TLS13HandshakeState::WaitEncryptedExtensions)
+            return (i8)Error::UnexpectedMessage;
+        result = handle_tls13_encrypted_extensions(body);
+        // A resumed session is authenticated by the pre-shared key, and skips the certificate messages.
+        state = m_context.tls13.did_resume_session ? TLS13HandshakeState::WaitFinished : TLS13HandshakeState::WaitCertificateOrCertificateRequest;
+        break;
+    case HandshakeType::CERTIFICATE_REQUEST:
+        if (state != TLS13HandshakeState::WaitCertificateOrCertificateRequest)
+            return (i8)Error::UnexpectedMessage;
+        result = handle_tls13_certificate_request(body);
+        state = TLS13HandshakeState::WaitCertificate;
+        break;
+    case HandshakeType::CERTIFICATE:
+        if (state != TLS13HandshakeState::WaitCertificateOrCertificateRequest && state != TLS13HandshakeState::WaitCertificate)
+            return (i8)Error::UnexpectedMessage;
+        result = handle_tls13_certificate(body);
+        state = TLS13HandshakeState::WaitCertificateVerify;
+        break;
+    case HandshakeType::CERTIFICATE_VERIFY:
+        if (state != TLS13HandshakeState::WaitCertificateVerify)
+            return (i8)Error::UnexpectedMessage;
+        result = handle_tls13_certificate_verify(body);
+        state = TLS13HandshakeState::WaitFinished;
+        break;
+    case HandshakeType::FINISHED:
+        if (state != TLS13HandshakeState::WaitFinished)
+            return (i8)Error::UnexpectedMessage;
+        // The Finished message updates the transcript itself, as the client Finished needs it included.
+        return handle_tls13_finished(message);
+    default:
+        dbgln("TLS 1.3: Unexpected {} during the handshake", enum_to_string(type));
+        return (i8)Error::UnexpectedMessage;
+    }
+
+    if (result < 0)
+        return result;
+
+    update_hash(message, 0);
+    return 0;
+}
+
+ssize_t TLSv12::handle_tls13_encrypted_extensions(ReadonlyBytes buffer)
+{
+    if (buffer.size() < 2)
+        return (i8)Error::BrokenPacket;
+    size_t extensions_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.data()));
+    if (buffer.size() != 2 + extensions_length)
+        return (i8)Error::BrokenPacket;
+
+    auto extensions = buffer.slice(2);
+    while (!extensions.is_empty()) {
+        if (extensions.size() < 4)
+            return (i8)Error::BrokenPacket;
+        auto extension_type = (ExtensionType)AK::convert_between_host_and_network_endian(ByteReader::load16(extensions.data()));
+        size_t extension_length = AK::convert_between_host_and_network_endian(ByteReader::load16(extensions.offset(2)));
+        if (extensions.size() - 4 < extension_length)
+            return (i8)Error::BrokenPacket;
+        auto data = extensions.slice(4, extension_length);
+        extensions = extensions.slice(4 + extension_length);
+
+        dbgln_if(TLS_DEBUG, "Encrypted extension {} with length {}", enum_to_string(extension_type), extension_length);
+
+        if (extension_type == ExtensionType::APPLICATION_LAYER_PROTOCOL_NEGOTIATION) {
+            // The server selects exactly one of the protocols we offered.
+            if (data.size() < 3)
+                return (i8)Error::BrokenPacket;
+            size_t protocol_length = data[2];
+            if (data.size() != 3 + protocol_length)
+                return (i8)Error::BrokenPacket;
+            StringView protocol { data.slice(3) };
+            auto it = m_context.alpn.find_if([&](auto& offered) { return offered == protocol; });
+            if (it.is_end())
+                return (i8)Error::IllegalParameter;
+            m_context.negotiated_alpn = *it;
+            dbgln_if(TLS_DEBUG, "negotiated alpn: {}", *it);
+        }
+    }
+    return 0;
+}
+
+ssize_t TLSv12::handle_tls13_certificate_request(ReadonlyBytes buffer)
+{
+    if (buffer.size() < 1 || buffer.size() < 1u + buffer[0])
+        return (i8)Error::BrokenPacket;
+
+    auto context = ByteBuffer::copy(buffer.slice(1, buffer[0]));
+    if (context.is_error())
+        return (i8)Error::OutOfMemory;
+    m_context.tls13.certificate_request_context = context.release_value();
+    m_context.tls13.did_receive_certificate_request = true;
+
+    dbgln("certificate request");
+    if (on_tls_certificate_request)
+        on_tls_certificate_request(*this);
+    return 0;
+}
+
+ssize_t TLSv12::handle_tls13_certificate(ReadonlyBytes buffer)
+{
+    // struct {
+    //     opaque certificate_request_context<0..2^8-1>;
+    //     CertificateEntry certificate_list<0..2^24-1>;
+    // } Certificate;
+    if (buffer.size() < 4 || buffer[0] != 0)
+        return (i8)Error::BrokenPacket;
+    size_t list_length = buffer[1] * 0x10000 + buffer[2] * 0x100 + buffer[3];
+    if (buffer.size() != 4 + list_length)
+        return (i8)Error::BrokenPacket;
+
+    // struct {
+    //     opaque cert_data<1..2^24-1>;
+    //     Extension extensions<0..2^16-1>;
+    // } CertificateEntry;
+    m_context.certificates.clear();
+    auto entries = buffer.slice(4);
+    while (!entries.is_empty()) {
+        if (entries.size() < 3)
+            return (i8)Error::BrokenPacket;
+        size_t certificate_length = entries[0] * 0x10000 + entries[1] * 0x100 + entries[2];
+        if (entries.size() - 3 < certificate_length + 2)
+            return (i8)Error::BrokenPacket;
+        auto certificate_data = entries.slice(3, certificate_length);
+        size_t extensions_length = AK::convert_between_host_and_network_endian(ByteReader::load16(entries.offset(3 + certificate_length)));
+        if (entries.size() - 3 - certificate_length - 2 < extensions_length)
+            return (i8)Error::BrokenPacket;
+        entries = entries.slice(3 + certificate_length + 2 + extensions_length);
+
+        auto certificate = Certificate::parse_certificate(certificate_data, false);
+        if (certificate.is_error()) {
+            dbgln("TLS 1.3: Failed to parse a certificate: {}", certificate.error());
+            // Only the end-entity certificate has to be understood, the others are only used to build the chain.
+            if (m_context.certificates.is_empty())
+                return (i8)Error::UnsupportedCertificate;
+            continue;
+        }
+        m_context.certificates.append(certificate.release_value());
+    }
+
+    if (m_context.certificates.is_empty()) {
+        dbgln("TLS 1.3: The server sent no certificates");
+        return (i8)Error::BadCertificate;
+    }
+    return 0;
+}
+
+bool TLSv12::verify_rsa_pss_signature(SignatureAlgorithm algorithm, ReadonlyBytes message, ReadonlyBytes signature) const
+{
+    if (m_context.certificates.is_empty())
+        return false;
+    auto const& public_key = m_context.certificates.first().public_key;
+    if (public_key.algorithm.identifier.span() != rsa_encryption_oid.span())
+        return false;
+    return TLS13::verify_rsa_pss_signature(algorithm, public_key.rsa, message, signature);
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.4.3
+ssize_t TLSv12::handle_tls13_certificate_verify(ReadonlyBytes buffer)
+{
+    if (buffer.size() < 4)
+        return (i8)Error::BrokenPacket;
+    auto hash = static_cast<HashAlgorithm>(buffer[0]);
+    auto algorithm = static_cast<SignatureAlgorithm>(buffer[1]);
+    size_t signature_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset(2)));
+    if (buffer.size() != 4 + signature_length)
+        return (i8)Error::BrokenPacket;
+    auto signature = buffer.slice(4);
+
+    // The signature covers 64 spaces, a context string, a zero byte and the transcript hash.
+    constexpr auto context_string = "TLS 1.3, server CertificateVerify"sv;
+    auto transcript_hash = tls13_transcript_hash();
+    if (transcript_hash.is_error())
+        return (i8)Error::OutOfMemory;
+    ByteBuffer content;
+    if (content.try_ensure_capacity(64 + context_string.length() + 1 + transcript_hash.value().size()).is_error())
+        return (i8)Error::OutOfMemory;
+    for (size_t i = 0; i < 64; ++i)
+        content.append((u8)' ');
+    content.append(context_string.bytes());
+    content.append((u8)0);
+    content.append(transcript_hash.value());
+
+    bool is_valid = false;
+    auto const& public_key = m_context.certificates.first().public_key;
+    if (hash == HashAlgorithm::INTRINSIC && first_is_one_of(algorithm, SignatureAlgorithm::RSA_PSS_RSAE_SHA256, SignatureAlgorithm::RSA_PSS_RSAE_SHA384, SignatureAlgorithm::RSA_PSS_RSAE_SHA512)) {
+        is_valid = verify_rsa_pss_signature(algorithm, content, signature);
+    } else if (algorithm == SignatureAlgorithm::ECDSA && public_key.algorithm.identifier.span() == ec_public_key_encryption_oid.span()) {
+        // ECDSA schemes are bound to a curve in TLS 1.3.
+        ErrorOr<bool> result = false;
+        if (hash == HashAlgorithm::SHA256 && public_key.algorithm.ec_parameters == SupportedGroup::SECP256R1) {
+            auto digest = Crypto::Hash::SHA256::hash(content);
+            result = Crypto::Curves::SECP256r1 {}.verify(digest.bytes(), public_key.raw_key, signature);
+        } else if (hash == HashAlgorithm::SHA384 && public_key.algorithm.ec_parameters == SupportedGroup::SECP384R1) {
+            auto digest = Crypto::Hash::SHA384::hash(content);
+            result = Crypto::Curves::SECP384r1 {}.verify(digest.bytes(), public_key.raw_key, signature);
+        }
+        is_valid = !result.is_error() && result.value();
+    } else {
+        // FIXME: Support Ed25519 certificates.
+        dbgln("TLS 1.3: Unsupported signature scheme {:02x}{:02x}", (u8)hash, (u8)algorithm);
+        return (i8)Error::NotUnderstood;
+    }
+
+    if (!is_valid) {
+        dbgln("TLS 1.3: Verification of the CertificateVerify signature failed");
+        return (i8)Error::NotSafe;
+    }
+
+    if (!m_context.verify_chain(m_context.extensions.SNI)) {
+        dbgln("TLS 1.3: Failed to verify the server certificate chain");
+        return (i8)Error::BadCertificate;
+    }
+    return 0;
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.4.4
+ssize_t TLSv12::handle_tls13_finished(ReadonlyBytes message)
+{
+    auto kind = hmac_hash();
+    auto transcript_hash = tls13_transcript_hash();
+    if (transcript_hash.is_error())
+        return (i8)Error::OutOfMemory;
+    auto expected_verify_data = finished_verify_data(kind, m_context.tls13.server_handshake_traffic_secret, transcript_hash.value());
+    if (expected_verify_data.is_error())
+        return (i8)Error::OutOfMemory;
+
+    auto verify_data = message.slice(4);
+    if (verify_data.size() != expected_verify_data.value().size() || !timing_safe_compare(verify_data.data(), expected_verify_data.value().data(), verify_data.size())) {
+        dbgln("TLS 1.3: The server Finished message does not match the handshake");
+        return (i8)Error::NotSafe;
+    }
+    update_hash(message, 0);
+
+    if (auto result = tls13_derive_application_secrets(); result.is_error()) {
+        dbgln("TLS 1.3: Failed to derive the application secrets: {}", result.error());
+        return (i8)Error::OutOfMemory;
+    }
+    if (auto result = tls13_set_traffic_keys(m_context.tls13.server_application_traffic_secret, false); result.is_error()) {
+        dbgln("TLS 1.3: Failed to set the application traffic keys: {}", result.error());
+        return (i8)Error::OutOfMemory;
+    }
+
+    // We never have a certificate to offer, so a CertificateRequest gets an empty Certificate, and no CertificateVerify.
+    if (m_context.tls13.did_receive_certificate_request) {
+        dbgln_if(TLS_DEBUG, "> Client Certificate");
+        auto packet = build_tls13_certificate();
+        write_packet(packet);
+    }
+    {
+        dbgln_if(TLS_DEBUG, "> client finished");
+        auto packet = build_tls13_finished();
+        write_packet(packet);
+    }
+
+    // The resumption secret covers the transcript up to the client Finished.
+    auto final_transcript_hash = tls13_transcript_hash();
+    if (final_transcript_hash.is_error())
+        return (i8)Error::OutOfMemory;
+    auto resumption_master_secret = derive_secret(kind, m_context.tls13.master_secret, "res master"sv, final_transcript_hash.value());
+    auto local_keys = tls13_set_traffic_keys(m_context.tls13.client_application_traffic_secret, true);
+    if (resumption_master_secret.is_error() || local_keys.is_error()) {
+        dbgln("TLS 1.3: Failed to derive the application secrets");
+        return (i8)Error::OutOfMemory;
+    }
+    m_context.tls13.resumption_master_secret = resumption_master_secret.release_value();
+
+    m_context.tls13.client_handshake_traffic_secret.clear();
+    m_context.tls13.server_handshake_traffic_secret.clear();
+    m_context.tls13.master_secret.clear();
+    m_context.tls13.state = TLS13HandshakeState::Connected;
+    did_complete_handshake();
+    return 0;
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.6.1
+ssize_t TLSv12::handle_tls13_new_session_ticket(ReadonlyBytes buffer)
+{
+    // struct {
+    //     uint32 ticket_lifetime;
+    //     uint32 ticket_age_add;
+    //     opaque ticket_nonce<0..255>;
+    //     opaque ticket<1..2^16-1>;
+    //     Extension extensions<0..2^16-2>;
+    // } NewSessionTicket;
+    if (buffer.size() < 9)
+        return (i8)Error::BrokenPacket;
+    u32 lifetime = AK::convert_between_host_and_network_endian(ByteReader::load32(buffer.data()));
+    u32 age_add = AK::convert_between_host_and_network_endian(ByteReader::load32(buffer.offset(4)));
+    size_t nonce_length = buffer[8];
+    if (buffer.size() < 9 + nonce_length + 2)
+        return (i8)Error::BrokenPacket;
+    auto nonce = buffer.slice(9, nonce_length);
+    size_t ticket_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset(9 + nonce_length)));
+    if (ticket_length == 0 || buffer.size() < 9 + nonce_length + 2 + ticket_length)
+        return (i8)Error::BrokenPacket;
+    auto ticket_data = buffer.slice(9 + nonce_length + 2, ticket_length);
+
+    // A lifetime of zero means the ticket should not be used at all.
+    if (lifetime == 0)
+        return 0;
+
+    auto kind = hmac_hash();
+    auto pre_shared_key = expand_label(kind, m_context.tls13.resumption_master_secret, "resumption"sv, nonce, hash_length_for(kind));
+    auto ticket_copy = ByteBuffer::copy(ticket_data);
+    if (pre_shared_key.is_error() || ticket_copy.is_error())
+        return (i8)Error::OutOfMemory;
+
+    SessionTicket ticket;
+    ticket.ticket = ticket_copy.release_value();
+    ticket.pre_shared_key = pre_shared_key.release_value();
+    ticket.cipher_suite = m_context.cipher;
+    ticket.ticket_age_add = age_add;
+    ticket.lifetime = Duration::from_seconds(min(lifetime, maximum_ticket_lifetime_in_seconds));
+
+    dbgln_if(TLS_DEBUG, "Received a session ticket valid for {} seconds", ticket.lifetime.to_seconds());
+    if (m_context.options.session_ticket_handler)
+        m_context.options.session_ticket_handler(move(ticket));
+    return 0;
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.6.3
+ssize_t TLSv12::handle_tls13_key_update(ReadonlyBytes buffer)
+{
+    if (buffer.size() != 1 || buffer[0] > 1)
+        return (i8)Error::BrokenPacket;
+    bool update_requested = buffer[0] == 1;
+
+    auto kind = hmac_hash();
+    auto next_server_secret = expand_label(kind, m_context.tls13.server_application_traffic_secret, "traffic upd"sv, {}, hash_length_for(kind));
+    if (next_server_secret.is_error())
+        return (i8)Error::OutOfMemory;
+    m_context.tls13.server_application_traffic_secret = next_server_secret.release_value();
+    if (tls13_set_traffic_keys(m_context.tls13.server_application_traffic_secret, false).is_error())
+        return (i8)Error::OutOfMemory;
+
+    if (update_requested) {
+        auto packet = build_tls13_key_update(false);
+        write_packet(packet);
+
+        auto next_client_secret = expand_label(kind, m_context.tls13.client_application_traffic_secret, "traffic upd"sv, {}, hash_length_for(kind));
+        if (next_client_secret.is_error())
+            return (i8)Error::OutOfMemory;
+        m_context.tls13.client_application_traffic_secret = next_client_secret.release_value();
+        if (tls13_set_traffic_keys(m_context.tls13.client_application_traffic_secret, true).is_error())
+            return (i8)Error::OutOfMemory;
+    }
+    return 0;
+}
+
+ByteBuffer TLSv12::build_tls13_certificate()
+{
+    PacketBuilder builder { ContentType::HANDSHAKE, m_context.options.version };
+    auto& context = m_context.tls13.certificate_request_context;
+    builder.append((u8)HandshakeType::CERTIFICATE);
+    builder.append_u24(1 + context.size() + 3);
+    builder.append((u8)context.size());
+    builder.append(context);
+    builder.append_u24(0);
+    auto packet = builder.build();
+    update_packet(packet);
+    return packet;
+}
+
+ByteBuffer TLSv12::build_tls13_finished()
+{
+    auto verify_data = [&]() -> ErrorOr<ByteBuffer> {
+        return finished_verify_data(hmac_hash(), m_context.tls13.client_handshake_traffic_secret, TRY(tls13_transcript_hash()));
+    }();
+    if (verify_data.is_error()) {
+        dbgln("LibTLS: Failed to compute the Finished message: {}", verify_data.error());
+        VERIFY_NOT_REACHED();
+    }
+
+    PacketBuilder builder { ContentType::HANDSHAKE, m_context.options.version };
+    builder.append((u8)HandshakeType::FINISHED);
+    builder.append_u24(verify_data.value().size());
+    builder.append(verify_data.value());
+    auto packet = builder.build();
+    update_packet(packet);
+    return packet;
+}
+
+ByteBuffer TLSv12::build_tls13_key_update(bool update_requested)
+{
+    PacketBuilder builder { ContentType::HANDSHAKE, m_context.options.version };
+    builder.append((u8)HandshakeType::KEY_UPDATE);
+    builder.append_u24(1);
+    builder.append((u8)update_requested);
+    auto packet = builder.build();
+    update_packet(packet);
+    return packet;
+}
+
+}
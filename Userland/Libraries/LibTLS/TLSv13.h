@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Error.h>
+#include <AK/StringView.h>
+#include <LibCrypto/Cipher/AES.h>
+#include <LibCrypto/Hash/HashManager.h>
+#include <LibCrypto/PK/RSA.h>
+#include <LibTLS/TLSv12.h>
+
+// The parts of TLS 1.3 that don't depend on the state of a connection.
+namespace TLS::TLS13 {
+
+Crypto::Hash::HashKind hash_kind_for_cipher_suite(CipherSuite);
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-7.1
+ErrorOr<ByteBuffer> expand_label(Crypto::Hash::HashKind, ReadonlyBytes secret, StringView label, ReadonlyBytes context, size_t length);
+ErrorOr<ByteBuffer> derive_secret(Crypto::Hash::HashKind, ReadonlyBytes secret, StringView label, ReadonlyBytes transcript_hash);
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.4.4
+ErrorOr<ByteBuffer> finished_verify_data(Crypto::Hash::HashKind, ReadonlyBytes base_key, ReadonlyBytes transcript_hash);
+
+// After a HelloRetryRequest, the first ClientHello is replaced in the transcript by a synthetic message_hash message
+// holding its hash, see RFC 8446, section 4.4.1. The transcript has to contain only that ClientHello.
+void replace_client_hello_with_message_hash(Crypto::Hash::Manager& transcript);
+
+// Turns a plaintext record, header included, into a protected one with the given traffic key and sequence number.
+// https://www.rfc-editor.org/rfc/rfc8446#section-5.2
+ErrorOr<ByteBuffer> protect_record(Crypto::Cipher::AESCipher::GCMMode&, ReadonlyBytes iv, u64 sequence_number, ReadonlyBytes packet);
+
+// The reverse of protect_record(), which leaves the content of the record in `plaintext` and its real type in `inner_type`.
+Error unprotect_record(Crypto::Cipher::AESCipher::GCMMode&, ReadonlyBytes iv, u64 sequence_number, ReadonlyBytes header, ReadonlyBytes ciphertext, ByteBuffer& plaintext, ContentType& inner_type);
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.2.3
+bool verify_rsa_pss_signature(SignatureAlgorithm, Crypto::PK::RSAPublicKey<Crypto::UnsignedBigInteger> const&, ReadonlyBytes message, ReadonlyBytes signature);
+
+}
@@ -9,10 +9,37 @@
 #include <LibWasm/AbstractMachine/Configuration.h>
 #include <LibWasm/AbstractMachine/Interpreter.h>
 #include <LibWasm/AbstractMachine/Validator.h>
+#include <LibWasm/JIT/Compiler.h>
+#include <LibWasm/JIT/NativeFunction.h>
 #include <LibWasm/Types.h>
+#include <stdlib.h>
 
 namespace Wasm {
 
+WasmFunction::WasmFunction(FunctionType const& type, ModuleInstance const& module, Module::Function const& code)
+    : m_type(type)
+    , m_module(module)
+    , m_code(code)
+{
+}
+
+WasmFunction::WasmFunction(WasmFunction&&) = default;
+WasmFunction::~WasmFunction() = default;
+
+JIT::NativeFunction const* WasmFunction::native_function(Configuration& configuration)
+{
+    if (!configuration.should_use_jit())
+        return nullptr;
+
+#ifdef JIT_ARCH_SUPPORTED
+    if (!m_did_try_to_compile) {
+        m_did_try_to_compile = true;
+        m_native_function = JIT::Compiler::compile(configuration.store(), *this);
+    }
+#endif
+    return m_native_function.ptr();
+}
+
 Optional<FunctionAddress> Store::allocate(ModuleInstance& module, Module::Function const& function)
 {
     FunctionAddress address { m_functions.size() };
@@ -181,7 +208,6 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
                 config.enable_instruction_count_limit();
             config.set_frame(Frame {
                 auxiliary_instance,
-                Vector<Value> {},
                 entry.expression(),
                 1,
             });
@@ -208,7 +234,6 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
                     config.enable_instruction_count_limit();
                 config.set_frame(Frame {
                     main_module_instance,
-                    Vector<Value> {},
                     entry,
                     entry.instructions().size(),
                 });
@@ -218,6 +243,7 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
                     return IterationDecision::Continue;
                 }
 
+                auto entry_start = references.size();
                 for (auto& value : result.values()) {
                     if (!value.type().is_reference()) {
                         instantiation_result = InstantiationError { "Evaluated element entry is not a reference" };
@@ -229,7 +255,7 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
                         return IterationDecision::Continue;
                     }
                     // FIXME: type-check the reference.
-                    references.prepend(reference.release_value());
+                    references.insert(entry_start, reference.release_value());
                 }
             }
             elements.append(move(references));
@@ -261,7 +287,6 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
                 config.enable_instruction_count_limit();
             config.set_frame(Frame {
                 main_module_instance,
-                Vector<Value> {},
                 active_ptr->expression,
                 1,
             });
@@ -321,7 +346,6 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
                         config.enable_instruction_count_limit();
                     config.set_frame(Frame {
                         main_module_instance,
-                        Vector<Value> {},
                         data.offset,
                         1,
                     });
@@ -496,6 +520,12 @@ Optional<InstantiationError> AbstractMachine::allocate_all_final_phase(Module co
     return {};
 }
 
+// Like LIBJS_JIT, LIBWASM_JIT turns on the JIT for every machine.
+AbstractMachine::AbstractMachine()
+    : m_should_use_jit(getenv("LIBWASM_JIT") != nullptr)
+{
+}
+
 Result AbstractMachine::invoke(FunctionAddress address, Vector<Value> arguments)
 {
     BytecodeInterpreter interpreter(m_stack_info);
@@ -507,6 +537,8 @@ Result AbstractMachine::invoke(Interpreter& interpreter, FunctionAddress address
     Configuration configuration { m_store };
     if (m_should_limit_instruction_count)
         configuration.enable_instruction_count_limit();
+    if (m_should_use_jit)
+        configuration.enable_jit();
     return configuration.call(interpreter, address, move(arguments));
 }
 
@@ -23,6 +23,10 @@ namespace Wasm {
 class Configuration;
 struct Interpreter;
 
+namespace JIT {
+class NativeFunction;
+}
+
 struct InstantiationError {
     ByteString error { "Unknown error" };
 };
@@ -333,21 +337,23 @@ private:
 
 class WasmFunction {
 public:
-    explicit WasmFunction(FunctionType const& type, ModuleInstance const& module, Module::Function const& code)
-        : m_type(type)
-        , m_module(module)
-        , m_code(code)
-    {
-    }
+    explicit WasmFunction(FunctionType const& type, ModuleInstance const& module, Module::Function const& code);
+    WasmFunction(WasmFunction&&);
+    ~WasmFunction();
 
     auto& type() const { return m_type; }
     auto& module() const { return m_module; }
     auto& code() const { return m_code; }
 
+    // Compiles the function the first time it's asked for, returns null if the JIT is disabled or can't handle it.
+    JIT::NativeFunction const* native_function(Configuration&);
+
 private:
     FunctionType m_type;
     ModuleInstance const& m_module;
     Module::Function const& m_code;
+    OwnPtr<JIT::NativeFunction> m_native_function;
+    bool m_did_try_to_compile { false };
 };
 
 class HostFunction {
@@ -546,52 +552,39 @@ private:
     Vector<DataInstance> m_datas;
 };
 
-class Label {
-public:
-    explicit Label(size_t arity, InstructionPointer continuation)
-        : m_arity(arity)
-        , m_continuation(continuation)
-    {
-    }
-
-    auto continuation() const { return m_continuation; }
-    auto arity() const { return m_arity; }
-
-private:
-    size_t m_arity { 0 };
-    InstructionPointer m_continuation { 0 };
-};
-
 class Frame {
 public:
-    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity)
+    explicit Frame(ModuleInstance const& module, Expression const& expression, size_t arity)
         : m_module(module)
-        , m_locals(move(locals))
         , m_expression(expression)
         , m_arity(arity)
     {
     }
 
     auto& module() const { return m_module; }
-    auto& locals() const { return m_locals; }
-    auto& locals() { return m_locals; }
     auto& expression() const { return m_expression; }
     auto arity() const { return m_arity; }
 
+    // The locals live on the value stack, right below the values the frame works with.
+    auto locals_base() const { return m_locals_base; }
+    auto stack_base() const { return m_stack_base; }
+
 private:
+    friend class Configuration;
+
     ModuleInstance const& m_module;
-    Vector<Value> m_locals;
     Expression const& m_expression;
     size_t m_arity { 0 };
+    size_t m_locals_base { 0 };
+    size_t m_stack_base { 0 };
 };
 
 class Stack {
 public:
-    using EntryType = Variant<Value, Label, Frame>;
     Stack() = default;
 
     [[nodiscard]] ALWAYS_INLINE bool is_empty() const { return m_data.is_empty(); }
-    ALWAYS_INLINE void push(EntryType entry) { m_data.append(move(entry)); }
+    ALWAYS_INLINE void push(Value value) { m_data.append(move(value)); }
     ALWAYS_INLINE auto pop() { return m_data.take_last(); }
     ALWAYS_INLINE auto& peek() const { return m_data.last(); }
     ALWAYS_INLINE auto& peek() { return m_data.last(); }
@@ -601,14 +594,14 @@ public:
     ALWAYS_INLINE auto& entries() { return m_data; }
 
 private:
-    Vector<EntryType, 1024> m_data;
+    Vector<Value, 1024> m_data;
 };
 
 using InstantiationResult = AK::Result<NonnullOwnPtr<ModuleInstance>, InstantiationError>;
 
 class AbstractMachine {
 public:
-    explicit AbstractMachine() = default;
+    explicit AbstractMachine();
 
     // Validate a module; permanently sets the module's validity status.
     ErrorOr<void, ValidationError> validate(Module&);
@@ -621,6 +614,7 @@ public:
     auto& store() { return m_store; }
 
     void enable_instruction_count_limit() { m_should_limit_instruction_count = true; }
+    void enable_jit() { m_should_use_jit = true; }
 
 private:
     Optional<InstantiationError> allocate_all_initial_phase(Module const&, ModuleInstance&, Vector<ExternValue>&, Vector<Value>& global_values, Vector<FunctionAddress>& own_functions);
@@ -628,6 +622,7 @@ private:
     Store m_store;
     StackInfo m_stack_info;
     bool m_should_limit_instruction_count { false };
+    bool m_should_use_jit { false };
 };
 
 class Linker {
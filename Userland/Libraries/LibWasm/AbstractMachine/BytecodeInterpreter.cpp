@@ -54,35 +54,19 @@ void BytecodeInterpreter::interpret(Configuration& configuration)
         }
         auto& instruction = instructions[current_ip_value.value()];
         auto old_ip = current_ip_value;
-        interpret(configuration, current_ip_value, instruction);
-        if (did_trap())
+        interpret_instruction(configuration, current_ip_value, instruction);
+        if (did_trap()) [[unlikely]]
             return;
         if (current_ip_value == old_ip) // If no jump occurred
             ++current_ip_value;
     }
 }
 
-void BytecodeInterpreter::branch_to_label(Configuration& configuration, LabelIndex index)
+ALWAYS_INLINE void BytecodeInterpreter::branch_to(Configuration& configuration, BranchTarget const& target)
 {
-    dbgln_if(WASM_TRACE_DEBUG, "Branch to label with index {}...", index.value());
-    auto label = configuration.nth_label(index.value());
-    dbgln_if(WASM_TRACE_DEBUG, "...which is actually IP {}, and has {} result(s)", label->continuation().value(), label->arity());
-    auto results = pop_values(configuration, label->arity());
-
-    size_t drop_count = index.value() + 1;
-    for (; !configuration.stack().is_empty();) {
-        auto& entry = configuration.stack().peek();
-        if (entry.has<Label>()) {
-            if (--drop_count == 0)
-                break;
-        }
-        configuration.stack().pop();
-    }
-
-    for (auto& result : results)
-        configuration.stack().push(move(result));
-
-    configuration.ip() = label->continuation();
+    dbgln_if(WASM_TRACE_DEBUG, "Branch to IP {} with {} result(s), at stack height {}", target.ip.value(), target.arity, target.stack_height);
+    configuration.unwind_values_to(target.stack_height, target.arity);
+    configuration.ip() = target.ip;
 }
 
 template<typename ReadType, typename PushType>
@@ -96,7 +80,7 @@ void BytecodeInterpreter::load_and_push(Configuration& configuration, Instructio
         return;
     }
     auto& entry = configuration.stack().peek();
-    auto base = entry.get<Value>().to<i32>();
+    auto base = entry.to<i32>();
     if (!base.has_value()) {
         m_trap = Trap { "Memory access out of bounds" };
         return;
@@ -131,7 +115,7 @@ void BytecodeInterpreter::load_and_push_mxn(Configuration& configuration, Instru
         return;
     }
     auto& entry = configuration.stack().peek();
-    auto base = entry.get<Value>().to<i32>();
+    auto base = entry.to<i32>();
     if (!base.has_value()) {
         m_trap = Trap { "Memory access out of bounds" };
         return;
@@ -169,7 +153,7 @@ void BytecodeInterpreter::load_and_push_m_splat(Configuration& configuration, In
         return;
     }
     auto& entry = configuration.stack().peek();
-    auto base = entry.get<Value>().to<i32>();
+    auto base = entry.to<i32>();
     if (!base.has_value()) {
         m_trap = Trap { "Memory access out of bounds" };
         return;
@@ -222,7 +206,7 @@ void BytecodeInterpreter::pop_and_push_m_splat(Wasm::Configuration& configuratio
     using PopT = Conditional<M <= 32, NativeType<32>, NativeType<64>>;
     using ReadT = NativeType<M>;
     auto entry = configuration.stack().peek();
-    auto value = static_cast<ReadT>(*entry.get<Value>().to<PopT>());
+    auto value = static_cast<ReadT>(*entry.to<PopT>());
     dbgln_if(WASM_TRACE_DEBUG, "stack({}) -> splat({})", value, M);
     set_top_m_splat<M, NativeType>(configuration, value);
 }
@@ -240,7 +224,7 @@ template<typename M, template<typename> typename SetSign, typename VectorType>
 Optional<VectorType> BytecodeInterpreter::peek_vector(Configuration& configuration)
 {
     auto& entry = configuration.stack().peek();
-    auto value = entry.get<Value>().value().get_pointer<u128>();
+    auto value = entry.value().get_pointer<u128>();
     if (!value)
         return {};
     auto vector = bit_cast<VectorType>(*value);
@@ -263,17 +247,26 @@ void BytecodeInterpreter::call_address(Configuration& configuration, FunctionAdd
     auto instance = configuration.store().get(address);
     FunctionType const* type { nullptr };
     instance->visit([&](auto const& function) { type = &function.type(); });
-    TRAP_IF_NOT(configuration.stack().entries().size() > type->parameters().size());
+    TRAP_IF_NOT(configuration.stack().size() >= configuration.frame().stack_base() + type->parameters().size());
+
+    // Functions that have been compiled to native code are called just like host functions.
+    if (auto* wasm_function = instance->get_pointer<WasmFunction>(); wasm_function && !wasm_function->native_function(configuration)) {
+        // The arguments stay where they are and become the callee's first locals, its results end up in their place.
+        CallFrameHandle handle { *this, configuration };
+        configuration.enter_function(*wasm_function);
+        interpret(configuration);
+        if (!did_trap())
+            configuration.return_from_function();
+        return;
+    }
+
     Vector<Value> args;
     args.ensure_capacity(type->parameters().size());
     auto span = configuration.stack().entries().span().slice_from_end(type->parameters().size());
-    for (auto& entry : span) {
-        auto* call_argument = entry.get_pointer<Value>();
-        TRAP_IF_NOT(call_argument);
-        args.unchecked_append(move(*call_argument));
-    }
+    for (auto& argument : span)
+        args.unchecked_append(move(argument));
 
-    configuration.stack().entries().remove(configuration.stack().size() - span.size(), span.size());
+    configuration.stack().entries().shrink(configuration.stack().size() - span.size(), true);
 
     Result result { Trap { ""sv } };
     {
@@ -301,10 +294,8 @@ void BytecodeInterpreter::binary_numeric_operation(Configuration& configuration)
 {
     auto rhs_entry = configuration.stack().pop();
     auto& lhs_entry = configuration.stack().peek();
-    auto rhs_ptr = rhs_entry.get_pointer<Value>();
-    auto lhs_ptr = lhs_entry.get_pointer<Value>();
-    auto rhs = rhs_ptr->to<PopTypeRHS>();
-    auto lhs = lhs_ptr->to<PopTypeLHS>();
+    auto rhs = rhs_entry.to<PopTypeRHS>();
+    auto lhs = lhs_entry.to<PopTypeLHS>();
     PushType result;
     auto call_result = Operator {}(lhs.value(), rhs.value());
     if constexpr (IsSpecializationOf<decltype(call_result), AK::Result>) {
@@ -324,8 +315,7 @@ template<typename PopType, typename PushType, typename Operator>
 void BytecodeInterpreter::unary_operation(Configuration& configuration)
 {
     auto& entry = configuration.stack().peek();
-    auto entry_ptr = entry.get_pointer<Value>();
-    auto value = entry_ptr->to<PopType>();
+    auto value = entry.to<PopType>();
     auto call_result = Operator {}(*value);
     PushType result;
     if constexpr (IsSpecializationOf<decltype(call_result), AK::Result>) {
@@ -375,10 +365,10 @@ template<typename PopT, typename StoreT>
 void BytecodeInterpreter::pop_and_store(Configuration& configuration, Instruction const& instruction)
 {
     auto entry = configuration.stack().pop();
-    auto value = ConvertToRaw<StoreT> {}(*entry.get<Value>().to<PopT>());
+    auto value = ConvertToRaw<StoreT> {}(*entry.to<PopT>());
     dbgln_if(WASM_TRACE_DEBUG, "stack({}) -> temporary({}b)", value, sizeof(StoreT));
     auto base_entry = configuration.stack().pop();
-    auto base = base_entry.get<Value>().to<i32>();
+    auto base = base_entry.to<i32>();
     store_to_memory(configuration, instruction, { &value, sizeof(StoreT) }, *base);
 }
 
@@ -478,22 +468,7 @@ MakeUnsigned<T> BytecodeInterpreter::checked_unsigned_truncate(V value)
     return true;
 }
 
-Vector<Value> BytecodeInterpreter::pop_values(Configuration& configuration, size_t count)
-{
-    Vector<Value> results;
-    results.resize(count);
-
-    for (size_t i = 0; i < count; ++i) {
-        auto top_of_stack = configuration.stack().pop();
-        if (auto value = top_of_stack.get_pointer<Value>())
-            results[i] = move(*value);
-        else
-            TRAP_IF_NOT_NORETURN(value);
-    }
-    return results;
-}
-
-void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPointer& ip, Instruction const& instruction)
+ALWAYS_INLINE void BytecodeInterpreter::interpret_instruction(Configuration& configuration, InstructionPointer& ip, Instruction const& instruction)
 {
     dbgln_if(WASM_TRACE_DEBUG, "Executing instruction {} at ip {}", instruction_name(instruction.opcode()), ip.value());
 
@@ -504,11 +479,11 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::nop.value():
         return;
     case Instructions::local_get.value():
-        configuration.stack().push(Value(configuration.frame().locals()[instruction.arguments().get<LocalIndex>().value()]));
+        configuration.stack().push(Value(configuration.local(instruction.arguments().get<LocalIndex>())));
         return;
     case Instructions::local_set.value(): {
         auto entry = configuration.stack().pop();
-        configuration.frame().locals()[instruction.arguments().get<LocalIndex>().value()] = move(entry.get<Value>());
+        configuration.local(instruction.arguments().get<LocalIndex>()) = move(entry);
         return;
     }
     case Instructions::i32_const.value():
@@ -523,131 +498,53 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::f64_const.value():
         configuration.stack().push(Value(ValueType { ValueType::F64 }, instruction.arguments().get<double>()));
         return;
-    case Instructions::block.value(): {
-        size_t arity = 0;
-        size_t parameter_count = 0;
-        auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
-        switch (args.block_type.kind()) {
-        case BlockType::Empty:
-            break;
-        case BlockType::Type:
-            arity = 1;
-            break;
-        case BlockType::Index: {
-            auto& type = configuration.frame().module().types()[args.block_type.type_index().value()];
-            arity = type.results().size();
-            parameter_count = type.parameters().size();
-        }
-        }
-
-        configuration.stack().entries().insert(configuration.stack().size() - parameter_count, Label(arity, args.end_ip));
-        return;
-    }
-    case Instructions::loop.value(): {
-        size_t arity = 0;
-        size_t parameter_count = 0;
-        auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
-        switch (args.block_type.kind()) {
-        case BlockType::Empty:
-            break;
-        case BlockType::Type:
-            arity = 1;
-            break;
-        case BlockType::Index: {
-            auto& type = configuration.frame().module().types()[args.block_type.type_index().value()];
-            arity = type.results().size();
-            parameter_count = type.parameters().size();
-        }
-        }
-
-        configuration.stack().entries().insert(configuration.stack().size() - parameter_count, Label(arity, ip.value() + 1));
+    case Instructions::block.value():
+    case Instructions::loop.value():
+    case Instructions::structured_end.value():
+        // The validator has already worked out where branches out of these go.
         return;
-    }
     case Instructions::if_.value(): {
-        size_t arity = 0;
-        size_t parameter_count = 0;
         auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
-        switch (args.block_type.kind()) {
-        case BlockType::Empty:
-            break;
-        case BlockType::Type:
-            arity = 1;
-            break;
-        case BlockType::Index: {
-            auto& type = configuration.frame().module().types()[args.block_type.type_index().value()];
-            arity = type.results().size();
-            parameter_count = type.parameters().size();
-        }
-        }
-
         auto entry = configuration.stack().pop();
-        auto value = entry.get<Value>().to<i32>();
-        auto end_label = Label(arity, args.end_ip.value());
-        if (value.value() == 0) {
-            if (args.else_ip.has_value()) {
-                configuration.ip() = args.else_ip.value();
-                configuration.stack().entries().insert(configuration.stack().size() - parameter_count, end_label);
-            } else {
-                configuration.ip() = args.end_ip.value() + 1;
-            }
-        } else {
-            configuration.stack().entries().insert(configuration.stack().size() - parameter_count, end_label);
-        }
-        return;
-    }
-    case Instructions::structured_end.value():
-    case Instructions::structured_else.value(): {
-        auto index = configuration.nth_label_index(0);
-        auto label = configuration.stack().entries()[*index].get<Label>();
-        configuration.stack().entries().remove(*index, 1);
-
-        if (instruction.opcode() == Instructions::structured_end)
+        if (entry.to<i32>().value() != 0)
             return;
 
-        // Jump to the end label
-        configuration.ip() = label.continuation();
+        if (args.else_ip.has_value())
+            configuration.ip() = args.else_ip.value();
+        else
+            configuration.ip() = args.end_ip.value() + 1;
         return;
     }
+    case Instructions::structured_else.value():
+        // Reaching the else clause means we're done with the if, skip to its end.
+        return branch_to(configuration, configuration.frame().expression().branch_targets().target_for(ip));
     case Instructions::return_.value(): {
         auto& frame = configuration.frame();
-        Checked checked_index { configuration.stack().size() };
-        checked_index -= frame.arity();
-        VERIFY(!checked_index.has_overflow());
-
-        auto index = checked_index.value();
-        size_t i = 1;
-        for (; i <= index; ++i) {
-            auto& entry = configuration.stack().entries()[index - i];
-            if (entry.has<Label>()) {
-                if (configuration.stack().entries()[index - i - 1].has<Frame>())
-                    break;
-            }
-        }
-
-        configuration.stack().entries().remove(index - i + 1, i - 1);
+        configuration.unwind_values_to(0, frame.arity());
 
         // Jump past the call/indirect instruction
-        configuration.ip() = configuration.frame().expression().instructions().size();
+        configuration.ip() = frame.expression().instructions().size();
         return;
     }
     case Instructions::br.value():
-        return branch_to_label(configuration, instruction.arguments().get<LabelIndex>());
+        return branch_to(configuration, configuration.frame().expression().branch_targets().target_for(ip));
     case Instructions::br_if.value(): {
         auto entry = configuration.stack().pop();
-        if (entry.get<Value>().to<i32>().value_or(0) == 0)
+        if (entry.to<i32>().value_or(0) == 0)
             return;
-        return branch_to_label(configuration, instruction.arguments().get<LabelIndex>());
+        return branch_to(configuration, configuration.frame().expression().branch_targets().target_for(ip));
     }
     case Instructions::br_table.value(): {
         auto& arguments = instruction.arguments().get<Instruction::TableBranchArgs>();
         auto entry = configuration.stack().pop();
-        auto maybe_i = entry.get<Value>().to<i32>();
+        auto maybe_i = entry.to<i32>();
+        auto& branch_targets = configuration.frame().expression().branch_targets();
         if (0 <= *maybe_i) {
             size_t i = *maybe_i;
             if (i < arguments.labels.size())
-                return branch_to_label(configuration, arguments.labels[i]);
+                return branch_to(configuration, branch_targets.target_for(ip, i));
         }
-        return branch_to_label(configuration, arguments.default_);
+        return branch_to(configuration, branch_targets.target_for(ip, arguments.labels.size()));
     }
     case Instructions::call.value(): {
         auto index = instruction.arguments().get<FunctionIndex>();
@@ -661,7 +558,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         auto table_address = configuration.frame().module().tables()[args.table.value()];
         auto table_instance = configuration.store().get(table_address);
         auto entry = configuration.stack().pop();
-        auto index = entry.get<Value>().to<i32>();
+        auto index = entry.to<i32>();
         TRAP_IF_NOT(index.value() >= 0);
         TRAP_IF_NOT(static_cast<size_t>(index.value()) < table_instance->elements().size());
         auto element = table_instance->elements()[index.value()];
@@ -720,10 +617,10 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         return pop_and_store<i64, i32>(configuration, instruction);
     case Instructions::local_tee.value(): {
         auto& entry = configuration.stack().peek();
-        auto value = entry.get<Value>();
+        auto value = entry;
         auto local_index = instruction.arguments().get<LocalIndex>();
         dbgln_if(WASM_TRACE_DEBUG, "stack:peek -> locals({})", local_index.value());
-        configuration.frame().locals()[local_index.value()] = move(value);
+        configuration.local(local_index) = move(value);
         return;
     }
     case Instructions::global_get.value(): {
@@ -738,7 +635,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         auto global_index = instruction.arguments().get<GlobalIndex>();
         auto address = configuration.frame().module().globals()[global_index.value()];
         auto entry = configuration.stack().pop();
-        auto value = entry.get<Value>();
+        auto value = entry;
         dbgln_if(WASM_TRACE_DEBUG, "stack -> global({})", address.value());
         auto global = configuration.store().get(address);
         global->set_value(move(value));
@@ -759,7 +656,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         auto instance = configuration.store().get(address);
         i32 old_pages = instance->size() / Constants::page_size;
         auto& entry = configuration.stack().peek();
-        auto new_pages = entry.get<Value>().to<i32>();
+        auto new_pages = entry.to<i32>();
         dbgln_if(WASM_TRACE_DEBUG, "memory.grow({}), previously {} pages...", *new_pages, old_pages);
         if (instance->grow(new_pages.value() * Constants::page_size))
             configuration.stack().peek() = Value((i32)old_pages);
@@ -772,9 +669,9 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         auto& args = instruction.arguments().get<Instruction::MemoryIndexArgument>();
         auto address = configuration.frame().module().memories()[args.memory_index.value()];
         auto instance = configuration.store().get(address);
-        auto count = configuration.stack().pop().get<Value>().to<i32>().value();
-        auto value = configuration.stack().pop().get<Value>().to<i32>().value();
-        auto destination_offset = configuration.stack().pop().get<Value>().to<i32>().value();
+        auto count = configuration.stack().pop().to<i32>().value();
+        auto value = configuration.stack().pop().to<i32>().value();
+        auto destination_offset = configuration.stack().pop().to<i32>().value();
 
         TRAP_IF_NOT(static_cast<size_t>(destination_offset + count) <= instance->data().size());
 
@@ -799,9 +696,9 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         auto source_instance = configuration.store().get(source_address);
         auto destination_instance = configuration.store().get(destination_address);
 
-        auto count = configuration.stack().pop().get<Value>().to<i32>().value();
-        auto source_offset = configuration.stack().pop().get<Value>().to<i32>().value();
-        auto destination_offset = configuration.stack().pop().get<Value>().to<i32>().value();
+        auto count = configuration.stack().pop().to<i32>().value();
+        auto source_offset = configuration.stack().pop().to<i32>().value();
+        auto destination_offset = configuration.stack().pop().to<i32>().value();
 
         TRAP_IF_NOT(static_cast<size_t>(source_offset + count) <= source_instance->data().size());
         TRAP_IF_NOT(static_cast<size_t>(destination_offset + count) <= destination_instance->data().size());
@@ -833,9 +730,9 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         auto& args = instruction.arguments().get<Instruction::MemoryInitArgs>();
         auto& data_address = configuration.frame().module().datas()[args.data_index.value()];
         auto& data = *configuration.store().get(data_address);
-        auto count = *configuration.stack().pop().get<Value>().to<i32>();
-        auto source_offset = *configuration.stack().pop().get<Value>().to<i32>();
-        auto destination_offset = *configuration.stack().pop().get<Value>().to<i32>();
+        auto count = *configuration.stack().pop().to<i32>();
+        auto source_offset = *configuration.stack().pop().to<i32>();
+        auto destination_offset = *configuration.stack().pop().to<i32>();
 
         TRAP_IF_NOT(count > 0);
         TRAP_IF_NOT(source_offset + count > 0);
@@ -875,7 +772,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         return;
     }
     case Instructions::ref_is_null.value(): {
-        auto top = configuration.stack().peek().get_pointer<Value>();
+        auto top = &configuration.stack().peek();
         TRAP_IF_NOT(top->type().is_reference());
         auto is_null = top->to<Reference::Null>().has_value();
         configuration.stack().peek() = Value(ValueType(ValueType::I32), static_cast<u64>(is_null ? 1 : 0));
@@ -888,12 +785,12 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::select_typed.value(): {
         // Note: The type seems to only be used for validation.
         auto entry = configuration.stack().pop();
-        auto value = entry.get<Value>().to<i32>();
+        auto value = entry.to<i32>();
         dbgln_if(WASM_TRACE_DEBUG, "select({})", value.value());
         auto rhs_entry = configuration.stack().pop();
         auto& lhs_entry = configuration.stack().peek();
-        auto rhs = move(rhs_entry.get<Value>());
-        auto lhs = move(lhs_entry.get<Value>());
+        auto rhs = move(rhs_entry);
+        auto lhs = move(lhs_entry);
         configuration.stack().peek() = value.value() != 0 ? move(lhs) : move(rhs);
         return;
     }
@@ -1255,24 +1152,47 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     }
 }
 
-void DebuggerBytecodeInterpreter::interpret(Configuration& configuration, InstructionPointer& ip, Instruction const& instruction)
+void DebuggerBytecodeInterpreter::interpret(Configuration& configuration)
 {
-    if (pre_interpret_hook) {
-        auto result = pre_interpret_hook(configuration, ip, instruction);
-        if (!result) {
-            m_trap = Trap { "Trapped by user request" };
-            return;
+    m_trap = Empty {};
+    auto& instructions = configuration.frame().expression().instructions();
+    auto max_ip_value = InstructionPointer { instructions.size() };
+    auto& current_ip_value = configuration.ip();
+    auto const should_limit_instruction_count = configuration.should_limit_instruction_count();
+    u64 executed_instructions = 0;
+
+    while (current_ip_value < max_ip_value) {
+        if (should_limit_instruction_count) {
+            if (executed_instructions++ >= Constants::max_allowed_executed_instructions_per_call) [[unlikely]] {
+                m_trap = Trap { "Exceeded maximum allowed number of instructions" };
+                return;
+            }
+        }
+        auto& instruction = instructions[current_ip_value.value()];
+        auto old_ip = current_ip_value;
+
+        if (pre_interpret_hook) {
+            auto result = pre_interpret_hook(configuration, current_ip_value, instruction);
+            if (!result) {
+                m_trap = Trap { "Trapped by user request" };
+                return;
+            }
         }
-    }
 
-    BytecodeInterpreter::interpret(configuration, ip, instruction);
+        interpret_instruction(configuration, current_ip_value, instruction);
 
-    if (post_interpret_hook) {
-        auto result = post_interpret_hook(configuration, ip, instruction, *this);
-        if (!result) {
-            m_trap = Trap { "Trapped by user request" };
-            return;
+        if (post_interpret_hook) {
+            auto result = post_interpret_hook(configuration, current_ip_value, instruction, *this);
+            if (!result) {
+                m_trap = Trap { "Trapped by user request" };
+                return;
+            }
         }
+
+        if (did_trap())
+            return;
+        if (current_ip_value == old_ip) // If no jump occurred
+            ++current_ip_value;
     }
 }
 }
@@ -44,8 +44,8 @@ struct BytecodeInterpreter : public Interpreter {
     };
 
 protected:
-    virtual void interpret(Configuration&, InstructionPointer&, Instruction const&);
-    void branch_to_label(Configuration&, LabelIndex);
+    void interpret_instruction(Configuration&, InstructionPointer&, Instruction const&);
+    void branch_to(Configuration&, BranchTarget const&);
     template<typename ReadT, typename PushT>
     void load_and_push(Configuration&, Instruction const&);
     template<typename PopT, typename StoreT>
@@ -80,7 +80,6 @@ protected:
     template<typename T>
     T read_value(ReadonlyBytes data);
 
-    Vector<Value> pop_values(Configuration& configuration, size_t count);
     ALWAYS_INLINE bool trap_if_not(bool value, StringView reason)
     {
         if (!value)
@@ -99,11 +98,10 @@ struct DebuggerBytecodeInterpreter : public BytecodeInterpreter {
     }
     virtual ~DebuggerBytecodeInterpreter() override = default;
 
+    virtual void interpret(Configuration&) override;
+
     Function<bool(Configuration&, InstructionPointer&, Instruction const&)> pre_interpret_hook;
     Function<bool(Configuration&, InstructionPointer&, Instruction const&, Interpreter const&)> post_interpret_hook;
-
-private:
-    virtual void interpret(Configuration&, InstructionPointer&, Instruction const&) override;
 };
 
 }
@@ -7,34 +7,43 @@
 #include <AK/MemoryStream.h>
 #include <LibWasm/AbstractMachine/Configuration.h>
 #include <LibWasm/AbstractMachine/Interpreter.h>
+#include <LibWasm/JIT/NativeFunction.h>
 #include <LibWasm/Printer/Printer.h>
 
 namespace Wasm {
 
-Optional<size_t> Configuration::nth_label_index(size_t i)
+void Configuration::enter_function(WasmFunction const& function)
 {
-    for (size_t index = m_stack.size(); index > 0; --index) {
-        auto& entry = m_stack.entries()[index - 1];
-        if (entry.has<Label>()) {
-            if (i == 0)
-                return index - 1;
-            --i;
-        }
-    }
-    return {};
+    auto& code = function.code();
+    m_stack.entries().ensure_capacity(m_stack.size() + code.locals().size());
+    for (auto& type : code.locals())
+        m_stack.entries().unchecked_append(Value(type, 0ull));
+
+    push_frame(Frame { function.module(), code.body(), function.type().results().size() }, function.type().parameters().size() + code.locals().size());
+    m_ip = 0;
 }
 
-void Configuration::unwind(Badge<CallFrameHandle>, CallFrameHandle const& frame_handle)
+void Configuration::return_from_function()
 {
-    if (m_stack.size() == frame_handle.stack_size && frame_handle.frame_index == m_current_frame_index)
-        return;
+    auto arity = frame().arity();
+    auto locals_base = frame().locals_base();
+    auto& values = m_stack.entries();
+    auto results_base = values.size() - arity;
+    for (size_t i = 0; i < arity; ++i)
+        values[locals_base + i] = move(values[results_base + i]);
+    values.shrink(locals_base + arity, true);
+    m_frames.take_last();
+}
 
-    VERIFY(m_stack.size() > frame_handle.stack_size);
-    m_stack.entries().remove(frame_handle.stack_size, m_stack.size() - frame_handle.stack_size);
-    m_current_frame_index = frame_handle.frame_index;
+void Configuration::unwind(Badge<CallFrameHandle>, CallFrameHandle const& frame_handle)
+{
+    // A trap leaves the frames it happened in behind, so drop them along with their values.
+    if (m_frames.size() > frame_handle.frame_count) {
+        m_stack.entries().shrink(m_frames[frame_handle.frame_count].locals_base(), true);
+        m_frames.shrink(frame_handle.frame_count);
+    }
     m_depth--;
     m_ip = frame_handle.ip;
-    VERIFY(m_stack.size() == frame_handle.stack_size);
 }
 
 Result Configuration::call(Interpreter& interpreter, FunctionAddress address, Vector<Value> arguments)
@@ -43,18 +52,17 @@ Result Configuration::call(Interpreter& interpreter, FunctionAddress address, Ve
     if (!function)
         return Trap {};
     if (auto* wasm_function = function->get_pointer<WasmFunction>()) {
-        Vector<Value> locals = move(arguments);
-        locals.ensure_capacity(locals.size() + wasm_function->code().locals().size());
-        for (auto& type : wasm_function->code().locals())
-            locals.empend(type, 0ull);
-
-        set_frame(Frame {
-            wasm_function->module(),
-            move(locals),
-            wasm_function->code().body(),
-            wasm_function->type().results().size(),
-        });
-        m_ip = 0;
+        if (arguments.size() != wasm_function->type().parameters().size())
+            return Trap { "Wrong number of arguments" };
+
+        if (auto* native_function = wasm_function->native_function(*this))
+            return native_function->call(*this, interpreter, *wasm_function, arguments);
+
+        m_stack.entries().ensure_capacity(m_stack.size() + arguments.size());
+        for (auto& argument : arguments)
+            m_stack.entries().unchecked_append(move(argument));
+
+        enter_function(*wasm_function);
         return execute(interpreter);
     }
 
@@ -69,17 +77,17 @@ Result Configuration::execute(Interpreter& interpreter)
     if (interpreter.did_trap())
         return Trap { interpreter.trap_reason() };
 
-    if (stack().size() <= frame().arity() + 1)
+    auto& frame = this->frame();
+    if (m_stack.size() < frame.stack_base() + frame.arity())
         return Trap { "Not enough values to return from call" };
 
     Vector<Value> results;
-    results.ensure_capacity(frame().arity());
-    for (size_t i = 0; i < frame().arity(); ++i)
-        results.append(move(stack().pop().get<Value>()));
-    auto label = stack().pop();
-    // ASSERT: label == current frame
-    if (!label.has<Label>())
-        return Trap { "Invalid stack configuration" };
+    results.ensure_capacity(frame.arity());
+    for (size_t i = 0; i < frame.arity(); ++i)
+        results.unchecked_append(m_stack.pop());
+
+    m_stack.entries().shrink(frame.locals_base(), true);
+    m_frames.take_last();
     return Result { move(results) };
 }
 
@@ -92,21 +100,17 @@ void Configuration::dump_stack()
         memory_stream.read_until_filled(buffer).release_value_but_fixme_should_propagate_errors();
         dbgln(format.view(), StringView(buffer).trim_whitespace());
     };
-    for (auto const& entry : stack().entries()) {
-        entry.visit(
-            [&](Value const& v) {
-                print_value("    {}", v);
-            },
-            [&](Frame const& f) {
-                dbgln("    frame({})", f.arity());
-                for (auto& local : f.locals()) {
-                    print_value("        {}", local);
-                }
-            },
-            [](Label const& l) {
-                dbgln("    label({}) -> {}", l.arity(), l.continuation());
-            });
+    auto& values = m_stack.entries();
+    size_t index = 0;
+    for (auto const& frame : m_frames) {
+        for (; index < frame.locals_base(); ++index)
+            print_value("    {}", values[index]);
+        dbgln("    frame({})", frame.arity());
+        for (; index < frame.stack_base(); ++index)
+            print_value("        {}", values[index]);
     }
+    for (; index < values.size(); ++index)
+        print_value("    {}", values[index]);
 }
 
 }
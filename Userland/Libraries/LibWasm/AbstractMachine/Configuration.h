@@ -17,23 +17,20 @@ public:
     {
     }
 
-    Optional<Label> nth_label(size_t label)
+    // Pushes a new frame, the top `local_count` values on the stack become its first locals.
+    void push_frame(Frame&& frame, size_t local_count = 0)
     {
-        auto index = nth_label_index(label);
-        if (index.has_value())
-            return m_stack.entries()[index.value()].get<Label>();
-        return {};
+        frame.m_locals_base = m_stack.size() - local_count;
+        frame.m_stack_base = m_stack.size();
+        m_frames.append(move(frame));
     }
-    Optional<size_t> nth_label_index(size_t);
-    void set_frame(Frame&& frame)
-    {
-        m_current_frame_index = m_stack.size();
-        Label label(frame.arity(), frame.expression().instructions().size());
-        m_stack.push(move(frame));
-        m_stack.push(label);
-    }
-    ALWAYS_INLINE auto& frame() const { return m_stack.entries()[m_current_frame_index].get<Frame>(); }
-    ALWAYS_INLINE auto& frame() { return m_stack.entries()[m_current_frame_index].get<Frame>(); }
+    void set_frame(Frame&& frame) { push_frame(move(frame)); }
+    void enter_function(WasmFunction const&);
+    void return_from_function();
+
+    ALWAYS_INLINE auto& frame() const { return m_frames.last(); }
+    ALWAYS_INLINE auto& frame() { return m_frames.last(); }
+    ALWAYS_INLINE auto& local(LocalIndex index) { return m_stack.entries()[frame().locals_base() + index.value()]; }
     ALWAYS_INLINE auto& ip() const { return m_ip; }
     ALWAYS_INLINE auto& ip() { return m_ip; }
     ALWAYS_INLINE auto& depth() const { return m_depth; }
@@ -43,10 +40,22 @@ public:
     ALWAYS_INLINE auto& store() const { return m_store; }
     ALWAYS_INLINE auto& store() { return m_store; }
 
+    // Moves the top `arity` values down so that they end up right above `stack_height` values of the current frame.
+    ALWAYS_INLINE void unwind_values_to(size_t stack_height, size_t arity)
+    {
+        auto& values = m_stack.entries();
+        auto destination = frame().stack_base() + stack_height;
+        auto source = values.size() - arity;
+        if (destination == source)
+            return;
+        for (size_t i = 0; i < arity; ++i)
+            values[destination + i] = move(values[source + i]);
+        values.shrink(destination + arity, true);
+    }
+
     struct CallFrameHandle {
         explicit CallFrameHandle(Configuration& configuration)
-            : frame_index(configuration.m_current_frame_index)
-            , stack_size(configuration.m_stack.size())
+            : frame_count(configuration.m_frames.size())
             , ip(configuration.ip())
             , configuration(configuration)
         {
@@ -58,8 +67,7 @@ public:
             configuration.unwind({}, *this);
         }
 
-        size_t frame_index { 0 };
-        size_t stack_size { 0 };
+        size_t frame_count { 0 };
         InstructionPointer ip { 0 };
         Configuration& configuration;
     };
@@ -71,15 +79,19 @@ public:
     void enable_instruction_count_limit() { m_should_limit_instruction_count = true; }
     bool should_limit_instruction_count() const { return m_should_limit_instruction_count; }
 
+    // Native code doesn't count instructions, so a limit keeps everything in the interpreter.
+    void enable_jit() { m_should_use_jit = true; }
+    bool should_use_jit() const { return m_should_use_jit && !m_should_limit_instruction_count; }
+
     void dump_stack();
 
 private:
     Store& m_store;
-    size_t m_current_frame_index { 0 };
     Stack m_stack;
+    Vector<Frame, 16> m_frames;
     size_t m_depth { 0 };
     InstructionPointer m_ip;
     bool m_should_limit_instruction_count { false };
+    bool m_should_use_jit { false };
 };
-
 }
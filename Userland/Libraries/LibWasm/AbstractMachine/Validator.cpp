@@ -36,6 +36,7 @@ ErrorOr<void, ValidationError> Validator::validate(Module& module)
     }
 
     m_context = {};
+    m_function_branch_targets.clear();
 
     module.for_each_section_of_type<TypeSection>([this](TypeSection const& section) {
         m_context.types = section.types();
@@ -148,6 +149,10 @@ ErrorOr<void, ValidationError> Validator::validate(Module& module)
         }
     }
 
+    VERIFY(m_function_branch_targets.size() == module.functions().size());
+    for (size_t i = 0; i < m_function_branch_targets.size(); ++i)
+        module.set_branch_targets(i, move(m_function_branch_targets[i]), {});
+
     module.set_validation_status(Module::ValidationStatus::Valid, {});
     return {};
 }
@@ -274,7 +279,8 @@ ErrorOr<void, ValidationError> Validator::validate(CodeSection const& section)
         function_validator.m_context.labels = { ResultType { function_type.results() } };
         function_validator.m_context.return_ = ResultType { function_type.results() };
 
-        TRY(function_validator.validate(function.body(), function_type.results()));
+        auto result = TRY(function_validator.validate(function.body(), function_type.results()));
+        m_function_branch_targets.append(move(result.branch_targets));
     }
 
     return {};
@@ -1975,23 +1981,21 @@ VALIDATE_INSTRUCTION(structured_end)
     m_context = m_parent_contexts.take_last();
     auto last_block_type = m_entered_blocks.take_last();
 
-    switch (last_scope) {
-    case ChildScopeKind::Block:
-    case ChildScopeKind::IfWithoutElse:
-    case ChildScopeKind::Else:
-        m_block_details.take_last();
-        break;
-    case ChildScopeKind::IfWithElse:
+    if (last_scope == ChildScopeKind::IfWithElse)
         return Errors::invalid("usage of if without an else clause that appears to have one anyway"sv);
-    }
+
+    auto block_details = m_block_details.take_last();
 
     auto& results = last_block_type.results();
     for (size_t i = 1; i <= results.size(); ++i)
         TRY(stack.take(results[results.size() - i]));
 
+    TRY(stack.drop_unreachable_entries_above(block_details.initial_stack_size - last_block_type.parameters().size()));
+
     for (auto& result : results)
         stack.append(result);
 
+    resolve_pending_branch_targets(block_details.pending_branch_targets, m_current_ip + 1);
     return {};
 }
 
@@ -2010,6 +2014,10 @@ VALIDATE_INSTRUCTION(structured_else)
     for (size_t i = 1; i <= results.size(); ++i)
         TRY(stack.take(results[results.size() - i]));
 
+    // Falling through to the else clause leaves the if, just like a branch to its label does.
+    m_branch_targets.offsets[m_current_ip.value()] = m_branch_targets.targets.size();
+    add_branch_target(LabelIndex { 0 });
+
     auto& details = m_block_details.last().details.get<BlockDetails::IfDetails>();
     m_entered_scopes.last() = ChildScopeKind::Else;
     stack = move(details.initial_stack);
@@ -2049,7 +2057,7 @@ VALIDATE_INSTRUCTION(loop)
         stack.append(parameter);
 
     m_entered_scopes.append(ChildScopeKind::Block);
-    m_block_details.empend(stack.actual_size(), Empty {});
+    m_block_details.empend(stack.actual_size(), Empty {}, m_current_ip);
     m_parent_contexts.append(m_context);
     m_entered_blocks.append(block_type);
     m_context.labels.prepend(ResultType { block_type.parameters() });
@@ -2089,6 +2097,9 @@ VALIDATE_INSTRUCTION(br)
     for (size_t i = 1; i <= type.types().size(); ++i)
         TRY(stack.take(type.types()[type.types().size() - i]));
 
+    m_branch_targets.offsets[m_current_ip.value()] = m_branch_targets.targets.size();
+    add_branch_target(label);
+
     stack.append(StackEntry());
     return {};
 }
@@ -2114,6 +2125,9 @@ VALIDATE_INSTRUCTION(br_if)
     for (size_t i = 0; i < entries.size(); ++i)
         stack.append(entries[entries.size() - i - 1]);
 
+    m_branch_targets.offsets[m_current_ip.value()] = m_branch_targets.targets.size();
+    add_branch_target(label);
+
     return {};
 }
 
@@ -2146,6 +2160,11 @@ VALIDATE_INSTRUCTION(br_table)
         TRY((stack.take(expected)));
     }
 
+    m_branch_targets.offsets[m_current_ip.value()] = m_branch_targets.targets.size();
+    for (auto& label : args.labels)
+        add_branch_target(label);
+    add_branch_target(args.default_);
+
     stack.append(StackEntry());
 
     return {};
@@ -3783,9 +3802,14 @@ ErrorOr<Validator::ExpressionTypeResult, ValidationError> Validator::validate(Ex
     Stack stack;
     bool is_constant_expression = true;
 
-    for (auto& instruction : expression.instructions()) {
+    m_branch_targets = {};
+    m_branch_targets.offsets.resize(expression.instructions().size());
+    m_pending_function_end_targets.clear();
+
+    for (size_t i = 0; i < expression.instructions().size(); ++i) {
         bool is_constant = false;
-        TRY(validate(instruction, stack, is_constant));
+        m_current_ip = i;
+        TRY(validate(expression.instructions()[i], stack, is_constant));
 
         is_constant_expression &= is_constant;
     }
@@ -3794,10 +3818,44 @@ ErrorOr<Validator::ExpressionTypeResult, ValidationError> Validator::validate(Ex
     while (!expected_result_types.is_empty())
         TRY(stack.take(expected_result_types.take_last()));
 
+    TRY(stack.drop_unreachable_entries_above(0));
+
     for (auto& type : result_types)
         stack.append(type);
 
-    return ExpressionTypeResult { stack.release_vector(), is_constant_expression };
+    resolve_pending_branch_targets(m_pending_function_end_targets, expression.instructions().size());
+
+    return ExpressionTypeResult { stack.release_vector(), is_constant_expression, move(m_branch_targets) };
+}
+
+void Validator::add_branch_target(LabelIndex label)
+{
+    auto arity = m_context.labels[label.value()].types().size();
+    auto target_index = m_branch_targets.targets.size();
+
+    // The outermost label belongs to the function itself, branching to it returns from the function.
+    if (label.value() == m_block_details.size()) {
+        m_branch_targets.targets.append({ {}, arity, 0 });
+        m_pending_function_end_targets.append(target_index);
+        return;
+    }
+
+    auto block_index = m_block_details.size() - label.value() - 1;
+    auto& block = m_block_details[block_index];
+    auto stack_height = block.initial_stack_size - m_entered_blocks[block_index].parameters().size();
+    if (block.loop_ip.has_value()) {
+        m_branch_targets.targets.append({ *block.loop_ip, arity, stack_height });
+        return;
+    }
+
+    m_branch_targets.targets.append({ {}, arity, stack_height });
+    block.pending_branch_targets.append(target_index);
+}
+
+void Validator::resolve_pending_branch_targets(Vector<size_t> const& pending_targets, InstructionPointer ip)
+{
+    for (auto index : pending_targets)
+        m_branch_targets.targets[index].ip = ip;
 }
 
 bool Validator::Stack::operator==(Stack const& other) const
@@ -232,6 +232,26 @@ public:
             return result;
         }
 
+        // Drops everything above `size`, which is only allowed if it was left there by unreachable code.
+        ErrorOr<void, ValidationError> drop_unreachable_entries_above(size_t size, SourceLocation location = SourceLocation::current())
+        {
+            auto& entries = static_cast<Vector<StackEntry>&>(*this);
+            auto has_unknown_entry_above = [&](size_t index) {
+                for (; index < entries.size(); ++index) {
+                    if (!entries[index].is_known)
+                        return true;
+                }
+                return false;
+            };
+
+            if (entries.size() < size || (entries.size() > size && !has_unknown_entry_above(size)))
+                return Errors::invalid("stack height"sv, size, entries.size(), location);
+
+            entries.shrink(size);
+            m_did_insert_unknown_entry = has_unknown_entry_above(0);
+            return {};
+        }
+
         size_t actual_size() const { return Vector<StackEntry>::size(); }
         size_t size() const { return m_did_insert_unknown_entry ? static_cast<size_t>(-1) : actual_size(); }
 
@@ -246,6 +266,7 @@ public:
     struct ExpressionTypeResult {
         Vector<StackEntry> result_types;
         bool is_constant { false };
+        BranchTargets branch_targets;
     };
     ErrorOr<ExpressionTypeResult, ValidationError> validate(Expression const&, Vector<ValueType> const&);
     ErrorOr<void, ValidationError> validate(Instruction const& instruction, Stack& stack, bool& is_constant);
@@ -333,19 +354,38 @@ private:
     };
 
     struct BlockDetails {
-        size_t initial_stack_size { 0 };
         struct IfDetails {
             Stack initial_stack;
         };
+
+        BlockDetails(size_t initial_stack_size, Variant<IfDetails, Empty> details, Optional<InstructionPointer> loop_ip = {})
+            : initial_stack_size(initial_stack_size)
+            , details(move(details))
+            , loop_ip(loop_ip)
+        {
+        }
+
+        size_t initial_stack_size { 0 };
         Variant<IfDetails, Empty> details;
+        // Branches to a loop go back to its start, branches to anything else wait here until we reach its end.
+        Optional<InstructionPointer> loop_ip;
+        Vector<size_t> pending_branch_targets;
     };
 
+    void add_branch_target(LabelIndex);
+    void resolve_pending_branch_targets(Vector<size_t> const&, InstructionPointer);
+
     Context m_context;
     Vector<Context> m_parent_contexts;
     Vector<ChildScopeKind> m_entered_scopes;
     Vector<BlockDetails> m_block_details;
     Vector<FunctionType> m_entered_blocks;
     Vector<GlobalType> m_globals_without_internal_globals;
+
+    InstructionPointer m_current_ip { 0 };
+    BranchTargets m_branch_targets;
+    Vector<size_t> m_pending_function_end_targets;
+    Vector<BranchTargets> m_function_branch_targets;
 };
 
 }
@@ -0,0 +1,917 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibJIT/GDB.h>
+#include <LibWasm/Constants.h>
+#include <LibWasm/JIT/Compiler.h>
+#include <LibWasm/Opcode.h>
+#include <LibWasm/Printer/Printer.h>
+#include <sys/mman.h>
+
+#ifdef JIT_ARCH_SUPPORTED
+
+namespace Wasm::JIT {
+
+bool Compiler::is_supported(ValueType const& type) const
+{
+    return type.kind() == ValueType::I32 || type.kind() == ValueType::I64;
+}
+
+bool Compiler::is_supported(FunctionType const& type) const
+{
+    return all_of(type.parameters(), [&](auto& type) { return is_supported(type); })
+        && all_of(type.results(), [&](auto& type) { return is_supported(type); });
+}
+
+Optional<FunctionType> Compiler::block_type(BlockType const& type) const
+{
+    switch (type.kind()) {
+    case BlockType::Empty:
+        return FunctionType { {}, {} };
+    case BlockType::Type:
+        return FunctionType { {}, { type.value_type() } };
+    case BlockType::Index: {
+        auto& types = m_function.module().types();
+        if (type.type_index().value() >= types.size())
+            return {};
+        return types[type.type_index().value()];
+    }
+    }
+    VERIFY_NOT_REACHED();
+}
+
+Assembler::Operand Compiler::local(size_t index) const
+{
+    return Assembler::Operand::Mem64BaseAndOffset(SLOTS_BASE, index * sizeof(u64));
+}
+
+Assembler::Operand Compiler::stack_slot(size_t height) const
+{
+    return local(m_local_count + height);
+}
+
+void Compiler::push(Assembler::Reg reg)
+{
+    m_assembler.mov(stack_slot(m_stack_height), Assembler::Operand::Register(reg));
+    m_max_stack_height = max(m_max_stack_height, ++m_stack_height);
+}
+
+void Compiler::pop(Assembler::Reg reg)
+{
+    m_assembler.mov(Assembler::Operand::Register(reg), stack_slot(--m_stack_height));
+}
+
+void Compiler::pop32(Assembler::Reg reg)
+{
+    m_assembler.mov32(Assembler::Operand::Register(reg), stack_slot(--m_stack_height));
+}
+
+void Compiler::reload_memory_registers()
+{
+    m_assembler.mov(
+        Assembler::Operand::Register(MEMORY_BASE),
+        Assembler::Operand::Mem64BaseAndOffset(CONTEXT_BASE, offsetof(RuntimeContext, memory_base)));
+    m_assembler.mov(
+        Assembler::Operand::Register(MEMORY_SIZE),
+        Assembler::Operand::Mem64BaseAndOffset(CONTEXT_BASE, offsetof(RuntimeContext, memory_size)));
+}
+
+void Compiler::move_branch_values(ControlFrame const& frame)
+{
+    auto arity = frame.branch_arity();
+    auto first_value = m_stack_height - arity;
+    if (first_value == frame.stack_height)
+        return;
+    for (size_t i = 0; i < arity; ++i) {
+        m_assembler.mov(Assembler::Operand::Register(GPR1), stack_slot(first_value + i));
+        m_assembler.mov(stack_slot(frame.stack_height + i), Assembler::Operand::Register(GPR1));
+    }
+}
+
+bool Compiler::compile_block(Instruction const& instruction, ControlFrame::Kind kind)
+{
+    auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
+    auto type = block_type(args.block_type);
+    if (!type.has_value())
+        return false;
+
+    // The then branch is free to overwrite the parameters, so an else branch would have nothing to start from.
+    if (kind == ControlFrame::Kind::If && !type->parameters().is_empty() && args.else_ip.has_value())
+        return false;
+
+    if (kind == ControlFrame::Kind::If)
+        pop32(GPR0);
+
+    ControlFrame frame {
+        .kind = kind,
+        .stack_height = m_stack_height - type->parameters().size(),
+        .parameter_count = type->parameters().size(),
+        .result_count = type->results().size(),
+    };
+
+    if (kind == ControlFrame::Kind::If) {
+        m_assembler.jump_if(
+            Assembler::Operand::Register(GPR0),
+            Assembler::Condition::EqualTo,
+            Assembler::Operand::Imm(0),
+            frame.else_label);
+    }
+    if (kind == ControlFrame::Kind::Loop)
+        frame.label.link(m_assembler);
+
+    m_control_stack.append(move(frame));
+    return true;
+}
+
+void Compiler::compile_else()
+{
+    auto& frame = m_control_stack.last();
+    if (!m_is_unreachable)
+        m_assembler.jump(frame.label);
+    frame.else_label.link(m_assembler);
+    m_stack_height = frame.stack_height + frame.parameter_count;
+    m_is_unreachable = false;
+}
+
+void Compiler::compile_end()
+{
+    auto frame = m_control_stack.take_last();
+    if (frame.kind != ControlFrame::Kind::Loop)
+        frame.label.link(m_assembler);
+    // Without an else branch, a false condition goes straight to the end.
+    if (frame.kind == ControlFrame::Kind::If && !frame.else_label.offset_of_label_in_instruction_stream.has_value())
+        frame.else_label.link(m_assembler);
+    m_stack_height = frame.stack_height + frame.result_count;
+    m_max_stack_height = max(m_max_stack_height, m_stack_height);
+    m_is_unreachable = false;
+}
+
+void Compiler::compile_branch(size_t label_index)
+{
+    auto& frame = m_control_stack[m_control_stack.size() - label_index - 1];
+    move_branch_values(frame);
+    m_assembler.jump(frame.label);
+}
+
+void Compiler::compile_branch_table(Instruction::TableBranchArgs const& args)
+{
+    pop32(GPR0);
+    for (size_t i = 0; i < args.labels.size(); ++i) {
+        Assembler::Label next_label;
+        m_assembler.jump_if(
+            Assembler::Operand::Register(GPR0),
+            Assembler::Condition::NotEqualTo,
+            Assembler::Operand::Imm(i),
+            next_label);
+        compile_branch(args.labels[i].value());
+        next_label.link(m_assembler);
+    }
+    compile_branch(args.default_.value());
+}
+
+void Compiler::load_arguments_pointer(Assembler::Reg reg, size_t parameter_count)
+{
+    m_assembler.mov(Assembler::Operand::Register(reg), Assembler::Operand::Register(SLOTS_BASE));
+    auto offset = (m_local_count + m_stack_height - parameter_count) * sizeof(u64);
+    if (offset != 0)
+        m_assembler.add(Assembler::Operand::Register(reg), Assembler::Operand::Imm(offset));
+}
+
+void Compiler::native_call(void* function)
+{
+    // NOTE: Only the callee-saved registers survive the call, which are the only ones we keep state in.
+    m_assembler.native_call(bit_cast<u64>(function));
+}
+
+void Compiler::finish_call(FunctionType const& type)
+{
+    // A trap anywhere below us makes us return the same trap.
+    m_assembler.jump_if(
+        Assembler::Operand::Register(RET),
+        Assembler::Condition::NotEqualTo,
+        Assembler::Operand::Imm(0),
+        m_exit_label);
+
+    // The callee may have grown the memory.
+    reload_memory_registers();
+
+    m_stack_height = m_stack_height - type.parameters().size() + type.results().size();
+    m_max_stack_height = max(m_max_stack_height, m_stack_height);
+}
+
+bool Compiler::compile_call(FunctionIndex index)
+{
+    auto& functions = m_function.module().functions();
+    if (index.value() >= functions.size())
+        return false;
+    auto* function = m_store.get(functions[index.value()]);
+    if (!function)
+        return false;
+    FunctionType const* type { nullptr };
+    function->visit([&](auto const& function) { type = &function.type(); });
+    if (!is_supported(*type))
+        return false;
+
+    load_arguments_pointer(ARG2, type->parameters().size());
+    m_assembler.mov(Assembler::Operand::Register(ARG1), Assembler::Operand::Imm(index.value()));
+    m_assembler.mov(Assembler::Operand::Register(ARG0), Assembler::Operand::Register(CONTEXT_BASE));
+    native_call((void*)Runtime::call_function);
+    finish_call(*type);
+    return true;
+}
+
+bool Compiler::compile_call_indirect(Instruction::IndirectCallArgs const& args)
+{
+    auto& types = m_function.module().types();
+    if (args.type.value() >= types.size())
+        return false;
+    auto& type = types[args.type.value()];
+    if (!is_supported(type))
+        return false;
+
+    pop32(ARG3);
+    load_arguments_pointer(ARG4, type.parameters().size());
+    m_assembler.mov(Assembler::Operand::Register(ARG2), Assembler::Operand::Imm(args.type.value()));
+    m_assembler.mov(Assembler::Operand::Register(ARG1), Assembler::Operand::Imm(args.table.value()));
+    m_assembler.mov(Assembler::Operand::Register(ARG0), Assembler::Operand::Register(CONTEXT_BASE));
+    native_call((void*)Runtime::call_indirect);
+    finish_call(type);
+    return true;
+}
+
+void Compiler::compute_memory_address(Instruction::MemoryArgument const& args, size_t access_size)
+{
+    // The address is a u32 and so is the offset, so this can't overflow.
+    pop32(GPR0);
+    if (args.offset != 0) {
+        m_assembler.mov(Assembler::Operand::Register(GPR1), Assembler::Operand::Imm(args.offset));
+        m_assembler.add(Assembler::Operand::Register(GPR0), Assembler::Operand::Register(GPR1));
+    }
+
+    m_assembler.mov(Assembler::Operand::Register(GPR1), Assembler::Operand::Register(GPR0));
+    m_assembler.add(Assembler::Operand::Register(GPR1), Assembler::Operand::Imm(access_size));
+    m_assembler.cmp(Assembler::Operand::Register(GPR1), Assembler::Operand::Register(MEMORY_SIZE));
+    m_assembler.jump_if(Assembler::Condition::UnsignedGreaterThan, trap_label(TrapKind::MemoryAccessOutOfBounds));
+
+    m_assembler.add(Assembler::Operand::Register(GPR0), Assembler::Operand::Register(MEMORY_BASE));
+}
+
+bool Compiler::compile_load(Instruction const& instruction)
+{
+    auto& args = instruction.arguments().get<Instruction::MemoryArgument>();
+    if (args.memory_index.value() != 0)
+        return false;
+
+    auto dst = Assembler::Operand::Register(GPR0);
+    auto src = Assembler::Operand::Mem64BaseAndOffset(GPR0, 0);
+
+    switch (instruction.opcode().value()) {
+    case Instructions::i32_load.value():
+    case Instructions::i64_load32_u.value():
+        compute_memory_address(args, 4);
+        m_assembler.mov32(dst, src);
+        break;
+    case Instructions::i64_load32_s.value():
+        compute_memory_address(args, 4);
+        m_assembler.mov32(dst, src, Assembler::Extension::SignExtend);
+        break;
+    case Instructions::i64_load.value():
+        compute_memory_address(args, 8);
+        m_assembler.mov(dst, src);
+        break;
+    case Instructions::i32_load8_s.value():
+    case Instructions::i64_load8_s.value():
+        compute_memory_address(args, 1);
+        m_assembler.mov8(dst, src, Assembler::Extension::SignExtend);
+        if (instruction.opcode() == Instructions::i64_load8_s)
+            m_assembler.sign_extend_32_to_64_bits(GPR0);
+        break;
+    case Instructions::i32_load8_u.value():
+    case Instructions::i64_load8_u.value():
+        compute_memory_address(args, 1);
+        m_assembler.mov8(dst, src);
+        break;
+    case Instructions::i32_load16_s.value():
+    case Instructions::i64_load16_s.value():
+        compute_memory_address(args, 2);
+        m_assembler.mov16(dst, src, Assembler::Extension::SignExtend);
+        if (instruction.opcode() == Instructions::i64_load16_s)
+            m_assembler.sign_extend_32_to_64_bits(GPR0);
+        break;
+    case Instructions::i32_load16_u.value():
+    case Instructions::i64_load16_u.value():
+        compute_memory_address(args, 2);
+        m_assembler.mov16(dst, src);
+        break;
+    default:
+        return false;
+    }
+
+    push(GPR0);
+    return true;
+}
+
+bool Compiler::compile_store(Instruction const& instruction)
+{
+    auto& args = instruction.arguments().get<Instruction::MemoryArgument>();
+    if (args.memory_index.value() != 0)
+        return false;
+
+    auto dst = Assembler::Operand::Mem64BaseAndOffset(GPR0, 0);
+    auto src = Assembler::Operand::Register(GPR2);
+
+    pop(GPR2);
+    switch (instruction.opcode().value()) {
+    case Instructions::i32_store.value():
+    case Instructions::i64_store32.value():
+        compute_memory_address(args, 4);
+        m_assembler.mov32(dst, src);
+        break;
+    case Instructions::i64_store.value():
+        compute_memory_address(args, 8);
+        m_assembler.mov(dst, src);
+        break;
+    case Instructions::i32_store8.value():
+    case Instructions::i64_store8.value():
+        compute_memory_address(args, 1);
+        m_assembler.mov8(dst, src);
+        break;
+    case Instructions::i32_store16.value():
+    case Instructions::i64_store16.value():
+        compute_memory_address(args, 2);
+        m_assembler.mov16(dst, src);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+    return true;
+}
+
+void Compiler::compile_binary_operation(OpCode opcode)
+{
+    auto lhs = Assembler::Operand::Register(GPR0);
+    auto rhs = Assembler::Operand::Register(GPR1);
+
+    // Shifts and rotates take their count in CL, which is GPR1.
+    pop(GPR1);
+    pop(GPR0);
+
+    switch (opcode.value()) {
+    case Instructions::i32_add.value():
+        m_assembler.add32(lhs, rhs, {});
+        break;
+    case Instructions::i32_sub.value():
+        m_assembler.sub32(lhs, rhs, {});
+        break;
+    case Instructions::i32_mul.value():
+        m_assembler.mul32(lhs, rhs, {});
+        break;
+    case Instructions::i32_and.value():
+        m_assembler.bitwise_and32(lhs, rhs);
+        break;
+    case Instructions::i32_or.value():
+        m_assembler.bitwise_or32(lhs, rhs);
+        break;
+    case Instructions::i32_xor.value():
+        m_assembler.bitwise_xor32(lhs, rhs);
+        break;
+    case Instructions::i32_shl.value():
+        m_assembler.shift_left32(lhs, {});
+        break;
+    case Instructions::i32_shrs.value():
+        m_assembler.arithmetic_right_shift32(lhs, {});
+        break;
+    case Instructions::i32_shru.value():
+        m_assembler.shift_right32(lhs, {});
+        break;
+    case Instructions::i32_rotl.value():
+        m_assembler.rotate_left32(lhs, {});
+        break;
+    case Instructions::i32_rotr.value():
+        m_assembler.rotate_right32(lhs, {});
+        break;
+    case Instructions::i64_add.value():
+        m_assembler.add(lhs, rhs);
+        break;
+    case Instructions::i64_sub.value():
+        m_assembler.sub(lhs, rhs);
+        break;
+    case Instructions::i64_mul.value():
+        m_assembler.mul(lhs, rhs);
+        break;
+    case Instructions::i64_and.value():
+        m_assembler.bitwise_and(lhs, rhs);
+        break;
+    case Instructions::i64_or.value():
+        m_assembler.bitwise_or(lhs, rhs);
+        break;
+    case Instructions::i64_xor.value():
+        m_assembler.bitwise_xor(lhs, rhs);
+        break;
+    case Instructions::i64_shl.value():
+        m_assembler.shift_left(lhs, {});
+        break;
+    case Instructions::i64_shrs.value():
+        m_assembler.arithmetic_right_shift(lhs, {});
+        break;
+    case Instructions::i64_shru.value():
+        m_assembler.shift_right(lhs, {});
+        break;
+    case Instructions::i64_rotl.value():
+        m_assembler.rotate_left(lhs, {});
+        break;
+    case Instructions::i64_rotr.value():
+        m_assembler.rotate_right(lhs, {});
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+    push(GPR0);
+}
+
+void Compiler::compile_comparison(OpCode opcode)
+{
+    auto lhs = Assembler::Operand::Register(GPR0);
+    auto rhs = Assembler::Operand::Register(GPR1);
+
+    auto condition = Assembler::Condition::EqualTo;
+    switch (opcode.value()) {
+    case Instructions::i32_eqz.value():
+    case Instructions::i64_eqz.value():
+        pop(GPR0);
+        if (opcode == Instructions::i32_eqz)
+            m_assembler.cmp32(lhs, Assembler::Operand::Imm(0));
+        else
+            m_assembler.cmp(lhs, Assembler::Operand::Imm(0));
+        m_assembler.set_if(Assembler::Condition::EqualTo, lhs);
+        m_assembler.mov8(lhs, lhs);
+        push(GPR0);
+        return;
+    case Instructions::i32_eq.value():
+    case Instructions::i64_eq.value():
+        condition = Assembler::Condition::EqualTo;
+        break;
+    case Instructions::i32_ne.value():
+    case Instructions::i64_ne.value():
+        condition = Assembler::Condition::NotEqualTo;
+        break;
+    case Instructions::i32_lts.value():
+    case Instructions::i64_lts.value():
+        condition = Assembler::Condition::SignedLessThan;
+        break;
+    case Instructions::i32_ltu.value():
+    case Instructions::i64_ltu.value():
+        condition = Assembler::Condition::UnsignedLessThan;
+        break;
+    case Instructions::i32_gts.value():
+    case Instructions::i64_gts.value():
+        condition = Assembler::Condition::SignedGreaterThan;
+        break;
+    case Instructions::i32_gtu.value():
+    case Instructions::i64_gtu.value():
+        condition = Assembler::Condition::UnsignedGreaterThan;
+        break;
+    case Instructions::i32_les.value():
+    case Instructions::i64_les.value():
+        condition = Assembler::Condition::SignedLessThanOrEqualTo;
+        break;
+    case Instructions::i32_leu.value():
+    case Instructions::i64_leu.value():
+        condition = Assembler::Condition::UnsignedLessThanOrEqualTo;
+        break;
+    case Instructions::i32_ges.value():
+    case Instructions::i64_ges.value():
+        condition = Assembler::Condition::SignedGreaterThanOrEqualTo;
+        break;
+    case Instructions::i32_geu.value():
+    case Instructions::i64_geu.value():
+        condition = Assembler::Condition::UnsignedGreaterThanOrEqualTo;
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+    pop(GPR1);
+    pop(GPR0);
+    if (opcode.value() < Instructions::i64_eqz.value())
+        m_assembler.cmp32(lhs, rhs);
+    else
+        m_assembler.cmp(lhs, rhs);
+    m_assembler.set_if(condition, lhs);
+    m_assembler.mov8(lhs, lhs);
+    push(GPR0);
+}
+
+void Compiler::compile_division(OpCode opcode)
+{
+    auto is_64_bit = opcode.value() >= Instructions::i64_divs.value();
+    auto is_signed = opcode == Instructions::i32_divs || opcode == Instructions::i32_rems || opcode == Instructions::i64_divs || opcode == Instructions::i64_rems;
+    auto is_remainder = opcode == Instructions::i32_rems || opcode == Instructions::i32_remu || opcode == Instructions::i64_rems || opcode == Instructions::i64_remu;
+
+    auto dividend = Assembler::Operand::Register(GPR0);
+    auto divisor = Assembler::Operand::Register(GPR1);
+    auto minus_one = Assembler::Operand::Imm(bit_cast<u64>(static_cast<i64>(-1)));
+
+    pop(GPR1);
+    pop(GPR0);
+
+    if (is_64_bit)
+        m_assembler.cmp(divisor, Assembler::Operand::Imm(0));
+    else
+        m_assembler.cmp32(divisor, Assembler::Operand::Imm(0));
+    m_assembler.jump_if(Assembler::Condition::EqualTo, trap_label(TrapKind::IntegerDivisionOverflow));
+
+    Assembler::Label done_label;
+    if (is_signed) {
+        // Dividing the smallest integer by -1 overflows, which traps for division, and gives 0 for remainder.
+        Assembler::Label divide_label;
+        if (is_64_bit)
+            m_assembler.cmp(divisor, minus_one);
+        else
+            m_assembler.cmp32(divisor, minus_one);
+        m_assembler.jump_if(Assembler::Condition::NotEqualTo, divide_label);
+        if (is_remainder) {
+            m_assembler.mov(dividend, Assembler::Operand::Imm(0));
+            m_assembler.jump(done_label);
+        } else if (is_64_bit) {
+            m_assembler.mov(Assembler::Operand::Register(GPR2), Assembler::Operand::Imm(bit_cast<u64>(NumericLimits<i64>::min())));
+            m_assembler.cmp(dividend, Assembler::Operand::Register(GPR2));
+            m_assembler.jump_if(Assembler::Condition::EqualTo, trap_label(TrapKind::IntegerDivisionOverflow));
+        } else {
+            m_assembler.cmp32(dividend, Assembler::Operand::Imm(bit_cast<u64>(static_cast<i64>(NumericLimits<i32>::min()))));
+            m_assembler.jump_if(Assembler::Condition::EqualTo, trap_label(TrapKind::IntegerDivisionOverflow));
+        }
+        divide_label.link(m_assembler);
+
+        if (is_64_bit) {
+            m_assembler.sign_extend_rax_into_rdx();
+            m_assembler.signed_divide(divisor);
+        } else {
+            m_assembler.sign_extend_eax_into_edx();
+            m_assembler.signed_divide32(divisor);
+        }
+    } else {
+        m_assembler.mov(Assembler::Operand::Register(GPR2), Assembler::Operand::Imm(0));
+        if (is_64_bit)
+            m_assembler.unsigned_divide(divisor);
+        else
+            m_assembler.unsigned_divide32(divisor);
+    }
+
+    if (is_remainder)
+        m_assembler.mov(dividend, Assembler::Operand::Register(GPR2));
+    done_label.link(m_assembler);
+    push(GPR0);
+}
+
+void Compiler::compile_unreachable_instruction(Instruction const& instruction)
+{
+    switch (instruction.opcode().value()) {
+    case Instructions::block.value():
+    case Instructions::loop.value():
+    case Instructions::if_.value():
+        ++m_unreachable_depth;
+        return;
+    case Instructions::structured_else.value():
+        if (m_unreachable_depth == 0)
+            compile_else();
+        return;
+    case Instructions::structured_end.value():
+        if (m_unreachable_depth == 0)
+            compile_end();
+        else
+            --m_unreachable_depth;
+        return;
+    default:
+        return;
+    }
+}
+
+bool Compiler::compile_instruction(Instruction const& instruction)
+{
+    auto opcode = instruction.opcode();
+    switch (opcode.value()) {
+    case Instructions::unreachable.value():
+        m_assembler.jump(trap_label(TrapKind::Unreachable));
+        m_is_unreachable = true;
+        return true;
+    case Instructions::nop.value():
+        return true;
+    case Instructions::block.value():
+        return compile_block(instruction, ControlFrame::Kind::Block);
+    case Instructions::loop.value():
+        return compile_block(instruction, ControlFrame::Kind::Loop);
+    case Instructions::if_.value():
+        return compile_block(instruction, ControlFrame::Kind::If);
+    case Instructions::structured_else.value():
+        compile_else();
+        return true;
+    case Instructions::structured_end.value():
+        compile_end();
+        return true;
+    case Instructions::br.value():
+        compile_branch(instruction.arguments().get<LabelIndex>().value());
+        m_is_unreachable = true;
+        return true;
+    case Instructions::br_if.value(): {
+        Assembler::Label skip_label;
+        pop32(GPR0);
+        m_assembler.jump_if(
+            Assembler::Operand::Register(GPR0),
+            Assembler::Condition::EqualTo,
+            Assembler::Operand::Imm(0),
+            skip_label);
+        compile_branch(instruction.arguments().get<LabelIndex>().value());
+        skip_label.link(m_assembler);
+        return true;
+    }
+    case Instructions::br_table.value():
+        compile_branch_table(instruction.arguments().get<Instruction::TableBranchArgs>());
+        m_is_unreachable = true;
+        return true;
+    case Instructions::return_.value():
+        compile_branch(m_control_stack.size() - 1);
+        m_is_unreachable = true;
+        return true;
+    case Instructions::call.value():
+        return compile_call(instruction.arguments().get<FunctionIndex>());
+    case Instructions::call_indirect.value():
+        return compile_call_indirect(instruction.arguments().get<Instruction::IndirectCallArgs>());
+    case Instructions::drop.value():
+        --m_stack_height;
+        return true;
+    case Instructions::select.value():
+    case Instructions::select_typed.value():
+        pop32(GPR2);
+        pop(GPR1);
+        pop(GPR0);
+        m_assembler.cmp32(Assembler::Operand::Register(GPR2), Assembler::Operand::Imm(0));
+        m_assembler.mov_if(Assembler::Condition::EqualTo, Assembler::Operand::Register(GPR0), Assembler::Operand::Register(GPR1));
+        push(GPR0);
+        return true;
+    case Instructions::local_get.value():
+        m_assembler.mov(Assembler::Operand::Register(GPR0), local(instruction.arguments().get<LocalIndex>().value()));
+        push(GPR0);
+        return true;
+    case Instructions::local_set.value():
+        pop(GPR0);
+        m_assembler.mov(local(instruction.arguments().get<LocalIndex>().value()), Assembler::Operand::Register(GPR0));
+        return true;
+    case Instructions::local_tee.value():
+        m_assembler.mov(Assembler::Operand::Register(GPR0), stack_slot(m_stack_height - 1));
+        m_assembler.mov(local(instruction.arguments().get<LocalIndex>().value()), Assembler::Operand::Register(GPR0));
+        return true;
+    case Instructions::global_get.value():
+    case Instructions::global_set.value(): {
+        auto index = instruction.arguments().get<GlobalIndex>();
+        auto& globals = m_function.module().globals();
+        if (index.value() >= globals.size())
+            return false;
+        auto* global = m_store.get(globals[index.value()]);
+        if (!global || !is_supported(global->type().type()))
+            return false;
+        if (opcode == Instructions::global_set)
+            pop(ARG2);
+        m_assembler.mov(Assembler::Operand::Register(ARG1), Assembler::Operand::Imm(index.value()));
+        m_assembler.mov(Assembler::Operand::Register(ARG0), Assembler::Operand::Register(CONTEXT_BASE));
+        if (opcode == Instructions::global_set) {
+            native_call((void*)Runtime::global_set);
+        } else {
+            native_call((void*)Runtime::global_get);
+            push(RET);
+        }
+        return true;
+    }
+    case Instructions::i32_load.value():
+    case Instructions::i64_load.value():
+    case Instructions::i32_load8_s.value():
+    case Instructions::i32_load8_u.value():
+    case Instructions::i32_load16_s.value():
+    case Instructions::i32_load16_u.value():
+    case Instructions::i64_load8_s.value():
+    case Instructions::i64_load8_u.value():
+    case Instructions::i64_load16_s.value():
+    case Instructions::i64_load16_u.value():
+    case Instructions::i64_load32_s.value():
+    case Instructions::i64_load32_u.value():
+        return compile_load(instruction);
+    case Instructions::i32_store.value():
+    case Instructions::i64_store.value():
+    case Instructions::i32_store8.value():
+    case Instructions::i32_store16.value():
+    case Instructions::i64_store8.value():
+    case Instructions::i64_store16.value():
+    case Instructions::i64_store32.value():
+        return compile_store(instruction);
+    case Instructions::memory_size.value(): {
+        if (instruction.arguments().get<Instruction::MemoryIndexArgument>().memory_index.value() != 0)
+            return false;
+        static_assert(Constants::page_size == 1 << 16);
+        m_assembler.mov(Assembler::Operand::Register(GPR0), Assembler::Operand::Register(MEMORY_SIZE));
+        m_assembler.shift_right(Assembler::Operand::Register(GPR0), Assembler::Operand::Imm(16));
+        push(GPR0);
+        return true;
+    }
+    case Instructions::memory_grow.value():
+        if (instruction.arguments().get<Instruction::MemoryIndexArgument>().memory_index.value() != 0)
+            return false;
+        pop32(ARG1);
+        m_assembler.mov(Assembler::Operand::Register(ARG0), Assembler::Operand::Register(CONTEXT_BASE));
+        native_call((void*)Runtime::memory_grow);
+        reload_memory_registers();
+        push(RET);
+        return true;
+    case Instructions::i32_const.value():
+        m_assembler.mov(Assembler::Operand::Register(GPR0), Assembler::Operand::Imm(bit_cast<u32>(instruction.arguments().get<i32>())));
+        push(GPR0);
+        return true;
+    case Instructions::i64_const.value():
+        m_assembler.mov(Assembler::Operand::Register(GPR0), Assembler::Operand::Imm(bit_cast<u64>(instruction.arguments().get<i64>())));
+        push(GPR0);
+        return true;
+    case Instructions::i32_eqz.value():
+    case Instructions::i32_eq.value():
+    case Instructions::i32_ne.value():
+    case Instructions::i32_lts.value():
+    case Instructions::i32_ltu.value():
+    case Instructions::i32_gts.value():
+    case Instructions::i32_gtu.value():
+    case Instructions::i32_les.value():
+    case Instructions::i32_leu.value():
+    case Instructions::i32_ges.value():
+    case Instructions::i32_geu.value():
+    case Instructions::i64_eqz.value():
+    case Instructions::i64_eq.value():
+    case Instructions::i64_ne.value():
+    case Instructions::i64_lts.value():
+    case Instructions::i64_ltu.value():
+    case Instructions::i64_gts.value():
+    case Instructions::i64_gtu.value():
+    case Instructions::i64_les.value():
+    case Instructions::i64_leu.value():
+    case Instructions::i64_ges.value():
+    case Instructions::i64_geu.value():
+        compile_comparison(opcode);
+        return true;
+    case Instructions::i32_add.value():
+    case Instructions::i32_sub.value():
+    case Instructions::i32_mul.value():
+    case Instructions::i32_and.value():
+    case Instructions::i32_or.value():
+    case Instructions::i32_xor.value():
+    case Instructions::i32_shl.value():
+    case Instructions::i32_shrs.value():
+    case Instructions::i32_shru.value():
+    case Instructions::i32_rotl.value():
+    case Instructions::i32_rotr.value():
+    case Instructions::i64_add.value():
+    case Instructions::i64_sub.value():
+    case Instructions::i64_mul.value():
+    case Instructions::i64_and.value():
+    case Instructions::i64_or.value():
+    case Instructions::i64_xor.value():
+    case Instructions::i64_shl.value():
+    case Instructions::i64_shrs.value():
+    case Instructions::i64_shru.value():
+    case Instructions::i64_rotl.value():
+    case Instructions::i64_rotr.value():
+        compile_binary_operation(opcode);
+        return true;
+    case Instructions::i32_divs.value():
+    case Instructions::i32_divu.value():
+    case Instructions::i32_rems.value():
+    case Instructions::i32_remu.value():
+    case Instructions::i64_divs.value():
+    case Instructions::i64_divu.value():
+    case Instructions::i64_rems.value():
+    case Instructions::i64_remu.value():
+        compile_division(opcode);
+        return true;
+    case Instructions::i32_wrap_i64.value():
+        // The upper half of the slot is ignored for i32 values anyway.
+        return true;
+    case Instructions::i64_extend_ui32.value():
+        pop32(GPR0);
+        push(GPR0);
+        return true;
+    case Instructions::i64_extend_si32.value():
+    case Instructions::i64_extend32_s.value():
+        m_assembler.mov32(Assembler::Operand::Register(GPR0), stack_slot(--m_stack_height), Assembler::Extension::SignExtend);
+        push(GPR0);
+        return true;
+    case Instructions::i32_extend8_s.value():
+    case Instructions::i64_extend8_s.value():
+        m_assembler.mov8(Assembler::Operand::Register(GPR0), stack_slot(--m_stack_height), Assembler::Extension::SignExtend);
+        if (opcode == Instructions::i64_extend8_s)
+            m_assembler.sign_extend_32_to_64_bits(GPR0);
+        push(GPR0);
+        return true;
+    case Instructions::i32_extend16_s.value():
+    case Instructions::i64_extend16_s.value():
+        m_assembler.mov16(Assembler::Operand::Register(GPR0), stack_slot(--m_stack_height), Assembler::Extension::SignExtend);
+        if (opcode == Instructions::i64_extend16_s)
+            m_assembler.sign_extend_32_to_64_bits(GPR0);
+        push(GPR0);
+        return true;
+    default:
+        dbgln_if(WASM_JIT_DEBUG, "Wasm JIT: Unsupported instruction {}", instruction_name(opcode));
+        return false;
+    }
+}
+
+OwnPtr<NativeFunction> Compiler::compile(Store& store, WasmFunction const& function)
+{
+    auto& type = function.type();
+    auto& code = function.code();
+
+    Compiler compiler { store, function };
+    if (!compiler.is_supported(type) || !all_of(code.locals(), [&](auto& type) { return compiler.is_supported(type); }))
+        return nullptr;
+
+    compiler.m_local_count = type.parameters().size() + code.locals().size();
+    compiler.m_control_stack.append({
+        .kind = ControlFrame::Kind::Function,
+        .stack_height = 0,
+        .parameter_count = 0,
+        .result_count = type.results().size(),
+    });
+
+    compiler.m_assembler.enter();
+    compiler.m_assembler.mov(
+        Assembler::Operand::Register(CONTEXT_BASE),
+        Assembler::Operand::Register(ARG0));
+    compiler.m_assembler.mov(
+        Assembler::Operand::Register(SLOTS_BASE),
+        Assembler::Operand::Register(ARG1));
+    compiler.reload_memory_registers();
+
+    for (auto& instruction : code.body().instructions()) {
+        if (compiler.m_is_unreachable) {
+            compiler.compile_unreachable_instruction(instruction);
+            continue;
+        }
+        if (!compiler.compile_instruction(instruction))
+            return nullptr;
+    }
+
+    // The function body has no end instruction of its own, everything that returns ends up here.
+    VERIFY(compiler.m_control_stack.size() == 1);
+    compiler.m_control_stack.last().label.link(compiler.m_assembler);
+
+    // Callers find the results in the first slots.
+    for (size_t i = 0; i < type.results().size(); ++i) {
+        compiler.m_assembler.mov(Assembler::Operand::Register(GPR0), compiler.stack_slot(i));
+        compiler.m_assembler.mov(compiler.local(i), Assembler::Operand::Register(GPR0));
+    }
+    compiler.m_assembler.mov(Assembler::Operand::Register(RET), Assembler::Operand::Imm(to_underlying(TrapKind::None)));
+
+    compiler.m_exit_label.link(compiler.m_assembler);
+    compiler.m_assembler.exit();
+
+    for (size_t i = 0; i < compiler.m_trap_labels.size(); ++i) {
+        auto& label = compiler.m_trap_labels[i];
+        if (label.jump_slot_offsets_in_instruction_stream.is_empty())
+            continue;
+        label.link(compiler.m_assembler);
+        compiler.m_assembler.mov(Assembler::Operand::Register(RET), Assembler::Operand::Imm(i));
+        compiler.m_assembler.jump(compiler.m_exit_label);
+    }
+
+    auto* executable_memory = mmap(nullptr, compiler.m_output.size(), PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+    if (executable_memory == MAP_FAILED) {
+        dbgln("mmap: {}", strerror(errno));
+        return nullptr;
+    }
+
+    memcpy(executable_memory, compiler.m_output.data(), compiler.m_output.size());
+
+    if (mprotect(executable_memory, compiler.m_output.size(), PROT_READ | PROT_EXEC) < 0) {
+        dbgln("mprotect: {}", strerror(errno));
+        munmap(executable_memory, compiler.m_output.size());
+        return nullptr;
+    }
+
+    dbgln_if(WASM_JIT_DEBUG, "Wasm JIT: Compiled a function with {} instructions into {} bytes", code.body().instructions().size(), compiler.m_output.size());
+
+    auto const code_bytes = ReadonlyBytes {
+        executable_memory,
+        compiler.m_output.size(),
+    };
+
+    Optional<FixedArray<u8>> gdb_object {};
+
+    if (getenv("LIBWASM_JIT_GDB"))
+        gdb_object = ::JIT::GDB::build_gdb_image(code_bytes, "LibWasm JIT"sv, "LibWasm JITted code"sv);
+
+    auto slot_count = max(compiler.m_local_count + compiler.m_max_stack_height, type.results().size());
+    return make<NativeFunction>(executable_memory, compiler.m_output.size(), type.parameters().size(), compiler.m_local_count, slot_count, move(gdb_object));
+}
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <LibJIT/Assembler.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/JIT/NativeFunction.h>
+
+#ifdef JIT_ARCH_SUPPORTED
+
+namespace Wasm::JIT {
+
+using ::JIT::Assembler;
+
+// A single pass compiler from Wasm bytecode to x86-64 machine code.
+//
+// Locals and operand stack values live in 64-bit slots: local i is at slots[i], and the operand stack value at height h
+// is at slots[local_count + h]. Since the validator has already checked the stack height at every instruction, each
+// operand stack value has a fixed slot, and falling through the end of a block needs no moves at all.
+// Values of type i32 only use the low 32 bits of their slot, the upper bits are ignored.
+//
+// Only integer code is supported, compilation fails for any function using other types, and such functions stay with
+// the interpreter.
+class Compiler {
+public:
+    static OwnPtr<NativeFunction> compile(Store&, WasmFunction const&);
+
+private:
+    static constexpr auto SLOTS_BASE = Assembler::Reg::RBX;
+    static constexpr auto CONTEXT_BASE = Assembler::Reg::R15;
+    static constexpr auto MEMORY_BASE = Assembler::Reg::R13;
+    static constexpr auto MEMORY_SIZE = Assembler::Reg::R14;
+    static constexpr auto GPR0 = Assembler::Reg::RAX;
+    static constexpr auto GPR1 = Assembler::Reg::RCX;
+    static constexpr auto GPR2 = Assembler::Reg::RDX;
+    static constexpr auto ARG0 = Assembler::Reg::RDI;
+    static constexpr auto ARG1 = Assembler::Reg::RSI;
+    static constexpr auto ARG2 = Assembler::Reg::RDX;
+    static constexpr auto ARG3 = Assembler::Reg::RCX;
+    static constexpr auto ARG4 = Assembler::Reg::R8;
+    static constexpr auto RET = Assembler::Reg::RAX;
+
+    struct ControlFrame {
+        enum class Kind {
+            Function,
+            Block,
+            Loop,
+            If,
+        };
+
+        Kind kind { Kind::Block };
+        size_t stack_height { 0 };
+        size_t parameter_count { 0 };
+        size_t result_count { 0 };
+        Assembler::Label label {};
+        Assembler::Label else_label {};
+
+        // Branches to a loop go back to its start, and take its parameters along.
+        size_t branch_arity() const { return kind == Kind::Loop ? parameter_count : result_count; }
+    };
+
+    Compiler(Store& store, WasmFunction const& function)
+        : m_store(store)
+        , m_function(function)
+    {
+    }
+
+    bool compile_instruction(Instruction const&);
+    void compile_unreachable_instruction(Instruction const&);
+    bool compile_block(Instruction const&, ControlFrame::Kind);
+    void compile_else();
+    void compile_end();
+    void compile_branch(size_t label_index);
+    void compile_branch_table(Instruction::TableBranchArgs const&);
+    bool compile_call(FunctionIndex);
+    bool compile_call_indirect(Instruction::IndirectCallArgs const&);
+    bool compile_load(Instruction const&);
+    bool compile_store(Instruction const&);
+    void compile_binary_operation(OpCode);
+    void compile_comparison(OpCode);
+    void compile_division(OpCode);
+
+    bool is_supported(ValueType const&) const;
+    bool is_supported(FunctionType const&) const;
+    Optional<FunctionType> block_type(BlockType const&) const;
+
+    Assembler::Operand local(size_t index) const;
+    Assembler::Operand stack_slot(size_t height) const;
+    void push(Assembler::Reg);
+    void pop(Assembler::Reg);
+    void pop32(Assembler::Reg);
+
+    // Moves the values carried by a branch down to the stack height of the target frame.
+    void move_branch_values(ControlFrame const&);
+    void compute_memory_address(Instruction::MemoryArgument const&, size_t access_size);
+    void load_arguments_pointer(Assembler::Reg, size_t parameter_count);
+    void native_call(void* function);
+    void finish_call(FunctionType const&);
+    void reload_memory_registers();
+    Assembler::Label& trap_label(TrapKind kind) { return m_trap_labels[to_underlying(kind)]; }
+
+    Store& m_store;
+    WasmFunction const& m_function;
+
+    Vector<u8> m_output;
+    Assembler m_assembler { m_output };
+    Assembler::Label m_exit_label;
+    Array<Assembler::Label, to_underlying(TrapKind::External)> m_trap_labels;
+
+    Vector<ControlFrame> m_control_stack;
+    size_t m_local_count { 0 };
+    size_t m_stack_height { 0 };
+    size_t m_max_stack_height { 0 };
+
+    // Nesting depth of the blocks entered in unreachable code, these are skipped entirely.
+    bool m_is_unreachable { false };
+    size_t m_unreachable_depth { 0 };
+};
+
+}
+
+#endif
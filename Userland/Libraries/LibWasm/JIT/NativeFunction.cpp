@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/StackInfo.h>
+#include <AK/TemporaryChange.h>
+#include <LibJIT/GDB.h>
+#include <LibWasm/AbstractMachine/Configuration.h>
+#include <LibWasm/AbstractMachine/Interpreter.h>
+#include <LibWasm/JIT/NativeFunction.h>
+#include <sys/mman.h>
+
+namespace Wasm::JIT {
+
+// All native functions on a thread share one slot stack. A native callee's slots start at its arguments in the caller's
+// slots, anything else that may end up running native code again starts at `top`.
+struct SlotStack {
+    static SlotStack& the()
+    {
+        static thread_local SlotStack s_slot_stack;
+        return s_slot_stack;
+    }
+
+    bool has_room_for(u64 const* start, size_t slot_count) const
+    {
+        return start + slot_count <= slots.data() + slots.size();
+    }
+
+    static constexpr size_t capacity = 1 * MiB / sizeof(u64);
+
+    FixedArray<u64> slots { FixedArray<u64>::must_create_but_fixme_should_propagate_errors(capacity) };
+    u64* top { slots.data() };
+};
+
+static StackInfo const& stack_info()
+{
+    static thread_local StackInfo s_stack_info;
+    return s_stack_info;
+}
+
+static u64 to_slot(Value const& value)
+{
+    return value.value().visit(
+        [](i32 value) -> u64 { return bit_cast<u32>(value); },
+        [](i64 value) -> u64 { return bit_cast<u64>(value); },
+        [](auto const&) -> u64 { VERIFY_NOT_REACHED(); });
+}
+
+static StringView trap_reason(TrapKind kind)
+{
+    switch (kind) {
+    case TrapKind::Unreachable:
+        return "Unreachable"sv;
+    case TrapKind::IntegerDivisionOverflow:
+        return "Integer division overflow"sv;
+    case TrapKind::MemoryAccessOutOfBounds:
+        return "Memory access out of bounds"sv;
+    case TrapKind::InvalidIndirectCall:
+        return "Invalid indirect call"sv;
+    case TrapKind::StackExhausted:
+        return "Stack exhausted"sv;
+    case TrapKind::None:
+    case TrapKind::External:
+        break;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+RuntimeContext::RuntimeContext(Configuration& configuration, Interpreter& interpreter, ModuleInstance const& module, Optional<Result>& external_result)
+    : configuration(&configuration)
+    , interpreter(&interpreter)
+    , module(&module)
+    , external_result(&external_result)
+{
+    if (!module.memories().is_empty())
+        memory = configuration.store().get(module.memories().first());
+    refresh_memory();
+}
+
+void RuntimeContext::refresh_memory()
+{
+    if (!memory)
+        return;
+    memory_base = memory->data().data();
+    memory_size = memory->size();
+}
+
+NativeFunction::NativeFunction(void* code, size_t size, size_t parameter_count, size_t local_count, size_t slot_count, Optional<FixedArray<u8>> gdb_object)
+    : m_code(code)
+    , m_size(size)
+    , m_parameter_count(parameter_count)
+    , m_local_count(local_count)
+    , m_slot_count(slot_count)
+    , m_gdb_object(move(gdb_object))
+{
+    if (m_gdb_object.has_value())
+        ::JIT::GDB::register_into_gdb(m_gdb_object.value().span());
+}
+
+NativeFunction::~NativeFunction()
+{
+    if (m_gdb_object.has_value())
+        ::JIT::GDB::unregister_from_gdb(m_gdb_object.value().span());
+    munmap(m_code, m_size);
+}
+
+Result NativeFunction::call(Configuration& configuration, Interpreter& interpreter, WasmFunction const& function, ReadonlySpan<Value> arguments) const
+{
+    auto* slots = SlotStack::the().top;
+    if (!SlotStack::the().has_room_for(slots, m_slot_count))
+        return Trap { trap_reason(TrapKind::StackExhausted) };
+    for (size_t i = 0; i < arguments.size(); ++i)
+        slots[i] = to_slot(arguments[i]);
+
+    Optional<Result> external_result;
+    RuntimeContext context { configuration, interpreter, function.module(), external_result };
+    auto trap = run(context, slots);
+    if (trap == TrapKind::External)
+        return external_result.release_value();
+    if (trap != TrapKind::None)
+        return Trap { trap_reason(trap) };
+
+    auto& result_types = function.type().results();
+    Vector<Value> results;
+    results.ensure_capacity(result_types.size());
+    for (size_t i = result_types.size(); i > 0; --i)
+        results.unchecked_append(Value { result_types[i - 1], slots[i - 1] });
+    return Result { move(results) };
+}
+
+TrapKind NativeFunction::run(RuntimeContext& context, u64* slots) const
+{
+    if (!SlotStack::the().has_room_for(slots, m_slot_count))
+        return TrapKind::StackExhausted;
+
+    for (size_t i = m_parameter_count; i < m_local_count; ++i)
+        slots[i] = 0;
+
+    typedef TrapKind (*NativeCode)(RuntimeContext*, u64* slots);
+    return ((NativeCode)m_code)(&context, slots);
+}
+
+namespace Runtime {
+
+static TrapKind call_address(RuntimeContext& context, FunctionAddress address, u64* arguments)
+{
+    if (stack_info().size_free() < Constants::minimum_stack_space_to_keep_free)
+        return TrapKind::StackExhausted;
+
+    auto& configuration = *context.configuration;
+    auto* function = configuration.store().get(address);
+    if (!function)
+        return TrapKind::InvalidIndirectCall;
+
+    if (auto* wasm_function = function->get_pointer<WasmFunction>()) {
+        if (auto* native_function = wasm_function->native_function(configuration)) {
+            RuntimeContext callee_context { configuration, *context.interpreter, wasm_function->module(), *context.external_result };
+            return native_function->run(callee_context, arguments);
+        }
+    }
+
+    FunctionType const* type { nullptr };
+    function->visit([&](auto const& function) { type = &function.type(); });
+
+    Vector<Value> values;
+    values.ensure_capacity(type->parameters().size());
+    for (size_t i = 0; i < type->parameters().size(); ++i)
+        values.unchecked_append(Value { type->parameters()[i], arguments[i] });
+
+    Optional<Result> result;
+    {
+        // Whatever runs now may come back into native code, which has to stay clear of the arguments and results.
+        auto slot_count = max(type->parameters().size(), type->results().size());
+        TemporaryChange top_change { SlotStack::the().top, arguments + slot_count };
+        Configuration::CallFrameHandle handle { configuration };
+        result = configuration.call(*context.interpreter, address, move(values));
+    }
+
+    if (result->is_trap() || result->is_completion()) {
+        context.interpreter->clear_trap();
+        *context.external_result = result.release_value();
+        return TrapKind::External;
+    }
+
+    auto& results = result->values();
+    for (size_t i = 0; i < results.size(); ++i)
+        arguments[results.size() - i - 1] = to_slot(results[i]);
+    return TrapKind::None;
+}
+
+TrapKind call_function(RuntimeContext& context, u32 function_index, u64* arguments)
+{
+    auto trap = call_address(context, context.module->functions()[function_index], arguments);
+    context.refresh_memory();
+    return trap;
+}
+
+TrapKind call_indirect(RuntimeContext& context, u32 table_index, u32 type_index, u32 element_index, u64* arguments)
+{
+    auto& store = context.configuration->store();
+    auto* table = store.get(context.module->tables()[table_index]);
+    if (!table || element_index >= table->elements().size())
+        return TrapKind::InvalidIndirectCall;
+
+    auto& element = table->elements()[element_index];
+    if (!element.has_value() || !element->ref().has<Reference::Func>())
+        return TrapKind::InvalidIndirectCall;
+
+    // The compiled code only made room for the arguments and results of the expected type.
+    auto address = element->ref().get<Reference::Func>().address;
+    auto* function = store.get(address);
+    if (!function)
+        return TrapKind::InvalidIndirectCall;
+    FunctionType const* type { nullptr };
+    function->visit([&](auto const& function) { type = &function.type(); });
+    auto& expected_type = context.module->types()[type_index];
+    if (type->parameters() != expected_type.parameters() || type->results() != expected_type.results())
+        return TrapKind::InvalidIndirectCall;
+
+    auto trap = call_address(context, address, arguments);
+    context.refresh_memory();
+    return trap;
+}
+
+u64 global_get(RuntimeContext& context, u32 global_index)
+{
+    auto* global = context.configuration->store().get(context.module->globals()[global_index]);
+    return to_slot(global->value());
+}
+
+void global_set(RuntimeContext& context, u32 global_index, u64 value)
+{
+    auto* global = context.configuration->store().get(context.module->globals()[global_index]);
+    global->set_value(Value { global->type().type(), value });
+}
+
+u64 memory_grow(RuntimeContext& context, u32 page_count)
+{
+    auto old_page_count = context.memory->size() / Constants::page_size;
+    auto grew = context.memory->grow(static_cast<u64>(page_count) * Constants::page_size);
+    context.refresh_memory();
+    if (!grew)
+        return bit_cast<u32>(-1);
+    return old_page_count;
+}
+
+}
+
+}
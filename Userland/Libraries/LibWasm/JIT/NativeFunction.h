@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/FixedArray.h>
+#include <AK/Noncopyable.h>
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+
+namespace Wasm::JIT {
+
+// Native code returns one of these, anything but None makes every native caller return it as well.
+enum class TrapKind : u64 {
+    None = 0,
+    Unreachable,
+    IntegerDivisionOverflow,
+    MemoryAccessOutOfBounds,
+    InvalidIndirectCall,
+    StackExhausted,
+    // The reason is in RuntimeContext::external_result, e.g. a trap in interpreted code.
+    External,
+};
+
+// Native code keeps a pointer to this in a register, and passes it to every runtime helper.
+struct RuntimeContext {
+    RuntimeContext(Configuration&, Interpreter&, ModuleInstance const&, Optional<Result>& external_result);
+
+    void refresh_memory();
+
+    Configuration* configuration { nullptr };
+    Interpreter* interpreter { nullptr };
+    ModuleInstance const* module { nullptr };
+    Optional<Result>* external_result { nullptr };
+    MemoryInstance* memory { nullptr };
+
+    // These are read directly by native code, and have to be refreshed whenever the memory may have grown.
+    u8* memory_base { nullptr };
+    u64 memory_size { 0 };
+};
+
+// Native code keeps locals and operand stack values in untyped 64-bit slots, see Compiler for the layout.
+class NativeFunction {
+    AK_MAKE_NONCOPYABLE(NativeFunction);
+    AK_MAKE_NONMOVABLE(NativeFunction);
+
+public:
+    NativeFunction(void* code, size_t size, size_t parameter_count, size_t local_count, size_t slot_count, Optional<FixedArray<u8>> gdb_object = {});
+    ~NativeFunction();
+
+    // Calls the function like Configuration::call() would, the results are returned with the top of the stack first.
+    Result call(Configuration&, Interpreter&, WasmFunction const&, ReadonlySpan<Value> arguments) const;
+
+    // Runs the function on slots that already contain its arguments, the results are left in the first slots.
+    TrapKind run(RuntimeContext&, u64* slots) const;
+
+    ReadonlyBytes code_bytes() const { return { m_code, m_size }; }
+
+private:
+    void* m_code { nullptr };
+    size_t m_size { 0 };
+    size_t m_parameter_count { 0 };
+    size_t m_local_count { 0 };
+    size_t m_slot_count { 0 };
+    Optional<FixedArray<u8>> m_gdb_object;
+};
+
+// Native code calls these for everything that needs to go through the store.
+namespace Runtime {
+
+TrapKind call_function(RuntimeContext&, u32 function_index, u64* arguments);
+TrapKind call_indirect(RuntimeContext&, u32 table_index, u32 type_index, u32 element_index, u64* arguments);
+u64 global_get(RuntimeContext&, u32 global_index);
+void global_set(RuntimeContext&, u32 global_index, u64 value);
+u64 memory_grow(RuntimeContext&, u32 page_count);
+
+}
+
+}
@@ -273,7 +273,7 @@ ParseResult<BlockType> BlockType::parse(Stream& stream)
     ReconsumableStream new_stream { stream };
     new_stream.unread({ &kind, 1 });
 
-    auto index_value_or_error = stream.read_value<LEB128<ssize_t>>();
+    auto index_value_or_error = new_stream.read_value<LEB128<ssize_t>>();
     if (index_value_or_error.is_error())
         return with_eof_check(stream, ParseError::ExpectedIndex);
     ssize_t index_value = index_value_or_error.release_value();
@@ -1429,19 +1429,19 @@ ParseResult<ElementSection::Element> ElementSection::Element::parse(Stream& stre
         if (auto result = SegmentType0::parse(stream); result.is_error()) {
             return result.error();
         } else {
-            Vector<Instruction> instructions;
+            Vector<Expression> items;
             for (auto& index : result.value().function_indices)
-                instructions.empend(Instructions::ref_func, index);
-            return Element { ValueType(ValueType::FunctionReference), { Expression { move(instructions) } }, move(result.value().mode) };
+                items.append(Expression { { Instruction { Instructions::ref_func, index } } });
+            return Element { ValueType(ValueType::FunctionReference), move(items), move(result.value().mode) };
         }
     case 0x01:
         if (auto result = SegmentType1::parse(stream); result.is_error()) {
             return result.error();
         } else {
-            Vector<Instruction> instructions;
+            Vector<Expression> items;
             for (auto& index : result.value().function_indices)
-                instructions.empend(Instructions::ref_func, index);
-            return Element { ValueType(ValueType::FunctionReference), { Expression { move(instructions) } }, Passive {} };
+                items.append(Expression { { Instruction { Instructions::ref_func, index } } });
+            return Element { ValueType(ValueType::FunctionReference), move(items), Passive {} };
         }
     case 0x02:
         if (auto result = SegmentType2::parse(stream); result.is_error()) {
@@ -0,0 +1,241 @@
+// The branch targets, arities and stack heights are resolved by the validator, so these check that
+// the interpreter ends up in the right place with the right values on the stack.
+
+const i32 = 0x7f;
+const empty = 0x40;
+
+function uleb128(value) {
+    const bytes = [];
+    do {
+        let byte = value & 0x7f;
+        value >>>= 7;
+        if (value !== 0) byte |= 0x80;
+        bytes.push(byte);
+    } while (value !== 0);
+    return bytes;
+}
+
+function vector(items) {
+    return [...uleb128(items.length), ...items.flat()];
+}
+
+function section(id, contents) {
+    return [id, ...uleb128(contents.length), ...contents];
+}
+
+function encodeName(name) {
+    return vector([...name].map(character => character.charCodeAt(0)));
+}
+
+function encodeFunctionType({ params, results }) {
+    return [0x60, ...vector(params), ...vector(results)];
+}
+
+// Block types can refer to `blockTypes` by their index. Every function gets a type of its own after those.
+function buildModule({ functions, blockTypes = [] }) {
+    const types = [...blockTypes, ...functions].map(encodeFunctionType);
+    const code = functions.map(func => {
+        const locals = vector((func.locals ?? []).map(([count, type]) => [...uleb128(count), type]));
+        const body = [...locals, ...func.body, 0x0b];
+        return [...uleb128(body.length), ...body];
+    });
+    return new Uint8Array([
+        0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,
+        ...section(1, vector(types)),
+        ...section(3, vector(functions.map((_, index) => uleb128(blockTypes.length + index)))),
+        ...section(7, vector(functions.map((func, index) => [...encodeName(func.name), 0x00, ...uleb128(index)]))),
+        ...section(10, vector(code)),
+    ]);
+}
+
+function instantiate(description) {
+    const module = parseWebAssemblyModule(buildModule(description));
+    return name => {
+        const address = module.getExport(name);
+        return (...args) => module.invoke(address, ...args);
+    };
+}
+
+test("branches out of nested blocks", () => {
+    // prettier-ignore
+    const exports = instantiate({
+        functions: [{
+            name: "nested",
+            params: [i32],
+            results: [i32],
+            body: [
+                0x02, i32,              // block (result i32)
+                0x02, empty,            //   block
+                0x02, empty,            //     block
+                0x20, 0x00,             //       local.get 0
+                0x0d, 0x00,             //       br_if 0
+                0x41, 0x63,             //       i32.const 99 (left behind when branching)
+                0x41, 0x0a,             //       i32.const 10
+                0x0c, 0x02,             //       br 2
+                0x0b,                   //     end
+                0x41, 0x14,             //     i32.const 20
+                0x0c, 0x01,             //     br 1
+                0x0b,                   //   end
+                0x41, 0x1e,             //   i32.const 30
+                0x0b,                   // end
+            ],
+        }],
+    });
+
+    const nested = exports("nested");
+    expect(nested(0)).toBe(10);
+    expect(nested(1)).toBe(20);
+});
+
+test("br_table carries its result to every target", () => {
+    // prettier-ignore
+    const exports = instantiate({
+        functions: [{
+            name: "table",
+            params: [i32],
+            results: [i32],
+            body: [
+                0x02, i32,              // block (result i32)
+                0x02, i32,              //   block (result i32)
+                0x02, i32,              //     block (result i32)
+                0x41, 0x05,             //       i32.const 5 (left behind when branching)
+                0x41, 0xe4, 0x00,       //       i32.const 100
+                0x20, 0x00,             //       local.get 0
+                0x0e, 0x02, 0x00, 0x01, //       br_table 0 1
+                0x02,                   //                    2
+                0x0b,                   //     end
+                0x41, 0x01,             //     i32.const 1
+                0x6a,                   //     i32.add
+                0x0b,                   //   end
+                0x41, 0x0a,             //   i32.const 10
+                0x6a,                   //   i32.add
+                0x0b,                   // end
+            ],
+        }],
+    });
+
+    const table = exports("table");
+    expect(table(0)).toBe(111);
+    expect(table(1)).toBe(110);
+    expect(table(2)).toBe(100);
+    expect(table(1000)).toBe(100);
+});
+
+test("loops and blocks take parameters", () => {
+    // prettier-ignore
+    const exports = instantiate({
+        blockTypes: [
+            { params: [i32, i32], results: [i32] },
+            { params: [i32], results: [i32] },
+        ],
+        functions: [
+            {
+                name: "sum",
+                params: [i32],
+                results: [i32],
+                locals: [[1, i32]],
+                body: [
+                    0x41, 0x00,         // i32.const 0 (the sum)
+                    0x20, 0x00,         // local.get 0 (the counter)
+                    0x03, 0x00,         // loop (param i32 i32) (result i32)
+                    0x21, 0x01,         //   local.set 1
+                    0x20, 0x01,         //   local.get 1
+                    0x6a,               //   i32.add
+                    0x20, 0x01,         //   local.get 1
+                    0x41, 0x01,         //   i32.const 1
+                    0x6b,               //   i32.sub
+                    0x22, 0x01,         //   local.tee 1
+                    0x20, 0x01,         //   local.get 1
+                    0x0d, 0x00,         //   br_if 0
+                    0x1a,               //   drop
+                    0x0b,               // end
+                ],
+            },
+            {
+                name: "double",
+                params: [i32],
+                results: [i32],
+                body: [
+                    0x20, 0x00,         // local.get 0
+                    0x02, 0x01,         // block (param i32) (result i32)
+                    0x41, 0x02,         //   i32.const 2
+                    0x6c,               //   i32.mul
+                    0x0b,               // end
+                ],
+            },
+        ],
+    });
+
+    const sum = exports("sum");
+    expect(sum(1)).toBe(1);
+    expect(sum(4)).toBe(10);
+    expect(sum(100)).toBe(5050);
+
+    expect(exports("double")(21)).toBe(42);
+});
+
+test("code after a branch is never run", () => {
+    // prettier-ignore
+    const exports = instantiate({
+        functions: [
+            {
+                name: "afterBr",
+                params: [],
+                results: [i32],
+                body: [
+                    0x02, i32,          // block (result i32)
+                    0x41, 0x07,         //   i32.const 7
+                    0x0c, 0x00,         //   br 0
+                    0x00,               //   unreachable
+                    0x6a,               //   i32.add
+                    0x0b,               // end
+                ],
+            },
+            {
+                name: "afterBrInIf",
+                params: [i32],
+                results: [i32],
+                body: [
+                    0x20, 0x00,         // local.get 0
+                    0x04, i32,          // if (result i32)
+                    0x41, 0x01,         //   i32.const 1
+                    0x0c, 0x00,         //   br 0
+                    0x00,               //   unreachable
+                    0x05,               // else
+                    0x41, 0x03,         //   i32.const 3
+                    0x0b,               // end
+                ],
+            },
+            {
+                name: "afterReturn",
+                params: [],
+                results: [i32],
+                body: [
+                    0x41, 0x2a,         // i32.const 42
+                    0x0f,               // return
+                    0x00,               // unreachable
+                    0x1a,               // drop
+                    0x41, 0x00,         // i32.const 0
+                ],
+            },
+            {
+                name: "trap",
+                params: [],
+                results: [i32],
+                body: [
+                    0x02, empty,        // block
+                    0x00,               //   unreachable
+                    0x0c, 0x00,         //   br 0
+                    0x0b,               // end
+                    0x41, 0x00,         // i32.const 0
+                ],
+            },
+        ],
+    });
+
+    expect(exports("afterBr")()).toBe(7);
+    expect(exports("afterBrInIf")(1)).toBe(1);
+    expect(exports("afterBrInIf")(0)).toBe(3);
+    expect(exports("afterReturn")()).toBe(42);
+    expect(() => exports("trap")()).toThrow(TypeError, "Execution trapped");
+});
@@ -0,0 +1,491 @@
+// Every module is instantiated twice. One instance is run by the interpreter and the other one as native code, and
+// both have to return the same results, or both have to trap.
+
+const jitTest = isWasmJITSupported() ? test : test.skip;
+
+const i32 = 0x7f;
+const i64 = 0x7e;
+const empty = 0x40;
+
+function uleb128(value) {
+    const bytes = [];
+    do {
+        let byte = value & 0x7f;
+        value >>>= 7;
+        if (value !== 0) byte |= 0x80;
+        bytes.push(byte);
+    } while (value !== 0);
+    return bytes;
+}
+
+function vector(items) {
+    return [...uleb128(items.length), ...items.flat()];
+}
+
+function section(id, contents) {
+    return [id, ...uleb128(contents.length), ...contents];
+}
+
+function encodeName(name) {
+    return vector([...name].map(character => character.charCodeAt(0)));
+}
+
+function encodeFunctionType({ params, results }) {
+    return [0x60, ...vector(params), ...vector(results)];
+}
+
+// Block types and call_indirect can refer to `types` by their index. Every function gets a type of its own after
+// those. `table` lists the function indices to put into a table, and `memory` is the initial page count.
+function buildModule({ functions, types = [], table, memory }) {
+    const code = functions.map(func => {
+        const locals = vector((func.locals ?? []).map(([count, type]) => [...uleb128(count), type]));
+        const body = [...locals, ...func.body, 0x0b];
+        return [...uleb128(body.length), ...body];
+    });
+
+    const sections = [
+        section(1, vector([...types, ...functions].map(encodeFunctionType))),
+        section(3, vector(functions.map((_, index) => uleb128(types.length + index)))),
+    ];
+    if (table) sections.push(section(4, vector([[0x70, 0x00, ...uleb128(table.length)]])));
+    if (memory !== undefined) sections.push(section(5, vector([[0x00, ...uleb128(memory)]])));
+    sections.push(
+        section(7, vector(functions.map((func, index) => [...encodeName(func.name), 0x00, ...uleb128(index)])))
+    );
+    if (table) sections.push(section(9, vector([[0x00, 0x41, 0x00, 0x0b, ...vector(table.map(uleb128))]])));
+    sections.push(section(10, vector(code)));
+
+    return new Uint8Array([0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, ...sections.flat()]);
+}
+
+function run(invoke) {
+    try {
+        return { value: invoke() };
+    } catch (error) {
+        // Anything but a trap, like a function that couldn't be compiled, is a test failure.
+        if (!error.message.startsWith("Execution trapped")) throw error;
+        return { trap: error.message };
+    }
+}
+
+function describe(outcome) {
+    return "trap" in outcome ? outcome.trap : String(outcome.value);
+}
+
+// Each call is [name, ...arguments]. Returns what the native code did for every call.
+function expectSameResults(description, calls) {
+    const binary = buildModule(description);
+    const interpreted = parseWebAssemblyModule(binary);
+    const compiled = parseWebAssemblyModule(binary);
+
+    const mismatches = [];
+    const outcomes = [];
+    for (const [name, ...args] of calls) {
+        const expected = run(() => interpreted.invoke(interpreted.getExport(name), ...args));
+        const actual = run(() => compiled.invokeCompiled(compiled.getExport(name), ...args));
+        const bothTrapped = "trap" in expected && "trap" in actual;
+        if (!bothTrapped && (!("value" in actual) || actual.value !== expected.value))
+            mismatches.push(`${name}(${args.join(", ")}): expected ${describe(expected)}, got ${describe(actual)}`);
+        outcomes.push(actual);
+    }
+    expect(mismatches).toEqual([]);
+    return outcomes;
+}
+
+function binaryOperators(type, resultType, operators) {
+    return Object.entries(operators).map(([name, opcode]) => ({
+        name,
+        params: [type, type],
+        results: [resultType],
+        body: [0x20, 0x00, 0x20, 0x01, opcode],
+    }));
+}
+
+function everyPair(names, values) {
+    const calls = [];
+    for (const name of names) for (const lhs of values) for (const rhs of values) calls.push([name, lhs, rhs]);
+    return calls;
+}
+
+jitTest("i32 arithmetic and comparisons", () => {
+    const arithmetic = {
+        add: 0x6a, sub: 0x6b, mul: 0x6c, div_s: 0x6d, div_u: 0x6e, rem_s: 0x6f, rem_u: 0x70,
+        and: 0x71, or: 0x72, xor: 0x73, shl: 0x74, shr_s: 0x75, shr_u: 0x76, rotl: 0x77, rotr: 0x78,
+    };
+    const comparisons = {
+        eq: 0x46, ne: 0x47, lt_s: 0x48, lt_u: 0x49, gt_s: 0x4a,
+        gt_u: 0x4b, le_s: 0x4c, le_u: 0x4d, ge_s: 0x4e, ge_u: 0x4f,
+    };
+    const unary = {
+        eqz: 0x45,
+        extend8_s: 0xc0,
+        extend16_s: 0xc1,
+    };
+
+    const functions = [
+        ...binaryOperators(i32, i32, arithmetic),
+        ...binaryOperators(i32, i32, comparisons),
+        ...Object.entries(unary).map(([name, opcode]) => ({
+            name,
+            params: [i32],
+            results: [i32],
+            body: [0x20, 0x00, opcode],
+        })),
+    ];
+
+    const values = [0, 1, -1, 2, 7, -7, 31, 32, 33, 0x7f, 0x80, 0xffff, 0x7fffffff, -0x80000000, 123456789];
+    const calls = everyPair([...Object.keys(arithmetic), ...Object.keys(comparisons)], values);
+    for (const name of Object.keys(unary)) for (const value of values) calls.push([name, value]);
+
+    expectSameResults({ functions }, calls);
+});
+
+jitTest("i64 arithmetic, comparisons and conversions", () => {
+    const arithmetic = {
+        add: 0x7c, sub: 0x7d, mul: 0x7e, div_s: 0x7f, div_u: 0x80, rem_s: 0x81, rem_u: 0x82,
+        and: 0x83, or: 0x84, xor: 0x85, shl: 0x86, shr_s: 0x87, shr_u: 0x88, rotl: 0x89, rotr: 0x8a,
+    };
+    const comparisons = {
+        eq: 0x51, ne: 0x52, lt_s: 0x53, lt_u: 0x54, gt_s: 0x55,
+        gt_u: 0x56, le_s: 0x57, le_u: 0x58, ge_s: 0x59, ge_u: 0x5a,
+    };
+
+    const functions = [
+        ...binaryOperators(i64, i64, arithmetic),
+        ...binaryOperators(i64, i32, comparisons),
+        { name: "eqz", params: [i64], results: [i32], body: [0x20, 0x00, 0x50] },
+        { name: "wrap", params: [i64], results: [i32], body: [0x20, 0x00, 0xa7] },
+        { name: "extend8_s", params: [i64], results: [i64], body: [0x20, 0x00, 0xc2] },
+        { name: "extend16_s", params: [i64], results: [i64], body: [0x20, 0x00, 0xc3] },
+        { name: "extend32_s", params: [i64], results: [i64], body: [0x20, 0x00, 0xc4] },
+        { name: "extend_i32_s", params: [i32], results: [i64], body: [0x20, 0x00, 0xac] },
+        { name: "extend_i32_u", params: [i32], results: [i64], body: [0x20, 0x00, 0xad] },
+    ];
+
+    const values = [
+        0n, 1n, -1n, 2n, 7n, -7n, 63n, 64n, 65n, 0xffffffffn, 0x100000000n,
+        2n ** 63n - 1n, -(2n ** 63n), 1234567890123n,
+    ];
+    const calls = everyPair([...Object.keys(arithmetic), ...Object.keys(comparisons)], values);
+    for (const name of ["eqz", "wrap", "extend8_s", "extend16_s", "extend32_s"])
+        for (const value of values) calls.push([name, value]);
+    for (const value of [0, 1, -1, 0x7fffffff, -0x80000000]) {
+        calls.push(["extend_i32_s", value]);
+        calls.push(["extend_i32_u", value]);
+    }
+
+    expectSameResults({ functions }, calls);
+});
+
+jitTest("division traps", () => {
+    const [divideByZero, overflow, remainderOfOverflow, divideByZero64] = expectSameResults(
+        {
+            functions: [
+                ...binaryOperators(i32, i32, { div_s: 0x6d, rem_s: 0x6f }),
+                ...binaryOperators(i64, i64, { div_u64: 0x80 }),
+            ],
+        },
+        [
+            ["div_s", 1, 0],
+            ["div_s", -0x80000000, -1],
+            ["rem_s", -0x80000000, -1],
+            ["div_u64", 1n, 0n],
+        ]
+    );
+    expect(divideByZero.trap).toBe("Execution trapped: Integer division overflow");
+    expect(overflow.trap).toBe("Execution trapped: Integer division overflow");
+    expect(remainderOfOverflow.value).toBe(0);
+    expect(divideByZero64.trap).toBe("Execution trapped: Integer division overflow");
+});
+
+jitTest("control flow", () => {
+    // prettier-ignore
+    const functions = [
+        {
+            name: "nested",
+            params: [i32],
+            results: [i32],
+            body: [
+                0x02, i32,              // block (result i32)
+                0x02, empty,            //   block
+                0x02, empty,            //     block
+                0x20, 0x00,             //       local.get 0
+                0x0d, 0x00,             //       br_if 0
+                0x41, 0x63,             //       i32.const 99
+                0x41, 0x0a,             //       i32.const 10
+                0x0c, 0x02,             //       br 2
+                0x0b,                   //     end
+                0x41, 0x14,             //     i32.const 20
+                0x0c, 0x01,             //     br 1
+                0x0b,                   //   end
+                0x41, 0x1e,             //   i32.const 30
+                0x0b,                   // end
+            ],
+        },
+        {
+            name: "choose",
+            params: [i32],
+            results: [i32],
+            body: [
+                0x20, 0x00,             // local.get 0
+                0x04, i32,              // if (result i32)
+                0x41, 0x01,             //   i32.const 1
+                0x05,                   // else
+                0x41, 0x02,             //   i32.const 2
+                0x0b,                   // end
+                0x41, 0x07,             // i32.const 7
+                0x20, 0x00,             // local.get 0
+                0x41, 0x03,             // i32.const 3
+                0x46,                   // i32.eq
+                0x1b,                   // select
+            ],
+        },
+        {
+            name: "factorial",
+            params: [i64],
+            results: [i64],
+            locals: [[1, i64]],
+            body: [
+                0x42, 0x01,             // i64.const 1
+                0x21, 0x01,             // local.set 1
+                0x02, empty,            // block
+                0x03, empty,            //   loop
+                0x20, 0x00,             //     local.get 0
+                0x50,                   //     i64.eqz
+                0x0d, 0x01,             //     br_if 1
+                0x20, 0x01,             //     local.get 1
+                0x20, 0x00,             //     local.get 0
+                0x7e,                   //     i64.mul
+                0x21, 0x01,             //     local.set 1
+                0x20, 0x00,             //     local.get 0
+                0x42, 0x01,             //     i64.const 1
+                0x7d,                   //     i64.sub
+                0x21, 0x00,             //     local.set 0
+                0x0c, 0x00,             //     br 0
+                0x0b,                   //   end
+                0x0b,                   // end
+                0x20, 0x01,             // local.get 1
+            ],
+        },
+        {
+            name: "table",
+            params: [i32],
+            results: [i32],
+            body: [
+                0x02, i32,              // block (result i32)
+                0x02, i32,              //   block (result i32)
+                0x02, i32,              //     block (result i32)
+                0x41, 0x05,             //       i32.const 5
+                0x41, 0xe4, 0x00,       //       i32.const 100
+                0x20, 0x00,             //       local.get 0
+                0x0e, 0x02, 0x00, 0x01, //       br_table 0 1
+                0x02,                   //                    2
+                0x0b,                   //     end
+                0x41, 0x01,             //     i32.const 1
+                0x6a,                   //     i32.add
+                0x0b,                   //   end
+                0x41, 0x0a,             //   i32.const 10
+                0x6a,                   //   i32.add
+                0x0b,                   // end
+            ],
+        },
+        {
+            name: "trap",
+            params: [i32],
+            results: [i32],
+            body: [
+                0x20, 0x00,             // local.get 0
+                0x04, empty,            // if
+                0x00,                   //   unreachable
+                0x0b,                   // end
+                0x41, 0x00,             // i32.const 0
+            ],
+        },
+    ];
+
+    const calls = [];
+    for (const value of [0, 1, 2, 3, -1]) {
+        calls.push(["nested", value]);
+        calls.push(["choose", value]);
+        calls.push(["table", value]);
+        calls.push(["trap", value]);
+    }
+    for (const value of [0n, 1n, 5n, 20n, 25n]) calls.push(["factorial", value]);
+
+    expectSameResults({ functions }, calls);
+});
+
+jitTest("calls", () => {
+    // prettier-ignore
+    const functions = [
+        {
+            name: "fib",
+            params: [i32],
+            results: [i32],
+            body: [
+                0x20, 0x00,             // local.get 0
+                0x41, 0x02,             // i32.const 2
+                0x48,                   // i32.lt_s
+                0x04, i32,              // if (result i32)
+                0x20, 0x00,             //   local.get 0
+                0x05,                   // else
+                0x20, 0x00,             //   local.get 0
+                0x41, 0x01,             //   i32.const 1
+                0x6b,                   //   i32.sub
+                0x10, 0x00,             //   call 0 (fib)
+                0x20, 0x00,             //   local.get 0
+                0x41, 0x02,             //   i32.const 2
+                0x6b,                   //   i32.sub
+                0x10, 0x00,             //   call 0 (fib)
+                0x6a,                   //   i32.add
+                0x0b,                   // end
+            ],
+        },
+        {
+            name: "subtract",
+            params: [i32, i64],
+            results: [i64],
+            body: [
+                0x20, 0x01,             // local.get 1
+                0x20, 0x00,             // local.get 0
+                0xac,                   // i64.extend_i32_s
+                0x7d,                   // i64.sub
+            ],
+        },
+        {
+            name: "callSubtract",
+            params: [i32, i64],
+            results: [i64],
+            body: [
+                0x41, 0x07,             // i32.const 7 (left on the stack below the call)
+                0x20, 0x00,             // local.get 0
+                0x20, 0x01,             // local.get 1
+                0x10, 0x01,             // call 1 (subtract)
+                0x20, 0x00,             // local.get 0
+                0x1a,                   // drop
+                0x1a,                   // drop
+                0x1a,                   // drop
+                0x42, 0x00,             // i64.const 0
+                0x20, 0x00,             // local.get 0
+                0x20, 0x01,             // local.get 1
+                0x10, 0x01,             // call 1 (subtract)
+                0x7c,                   // i64.add
+            ],
+        },
+        {
+            name: "callIndirect",
+            params: [i32, i32],
+            results: [i32],
+            body: [
+                0x20, 0x00,             // local.get 0
+                0x20, 0x01,             // local.get 1
+                0x11, 0x00, 0x00,       // call_indirect (type 0) (table 0)
+            ],
+        },
+    ];
+
+    const calls = [];
+    for (const value of [0, 1, 2, 10, 20]) calls.push(["fib", value]);
+    for (const [lhs, rhs] of [
+        [1, 10n],
+        [-1, 0n],
+        [0x7fffffff, -(2n ** 63n)],
+    ])
+        calls.push(["callSubtract", lhs, rhs]);
+    // The table holds fib, which has the right type, and subtract, which doesn't.
+    for (const index of [0, 1, 2, -1]) calls.push(["callIndirect", 10, index]);
+
+    const outcomes = expectSameResults(
+        { types: [{ params: [i32], results: [i32] }], functions, table: [0, 1] },
+        calls
+    );
+    expect(outcomes.at(-4).value).toBe(55);
+    expect(outcomes.at(-3).trap).toBe("Execution trapped: Invalid indirect call");
+    expect(outcomes.at(-2).trap).toBe("Execution trapped: Invalid indirect call");
+    expect(outcomes.at(-1).trap).toBe("Execution trapped: Invalid indirect call");
+});
+
+jitTest("memory accesses are bounds checked", () => {
+    // prettier-ignore
+    const functions = [
+        {
+            name: "storeAndLoad32",
+            params: [i32, i32],
+            results: [i32],
+            body: [
+                0x20, 0x00,             // local.get 0
+                0x20, 0x01,             // local.get 1
+                0x36, 0x02, 0x00,       // i32.store align=4 offset=0
+                0x20, 0x00,             // local.get 0
+                0x28, 0x02, 0x00,       // i32.load align=4 offset=0
+            ],
+        },
+        {
+            name: "storeAndLoad64",
+            params: [i32, i64],
+            results: [i64],
+            body: [
+                0x20, 0x00,             // local.get 0
+                0x20, 0x01,             // local.get 1
+                0x37, 0x03, 0x00,       // i64.store align=8 offset=0
+                0x20, 0x00,             // local.get 0
+                0x29, 0x03, 0x00,       // i64.load align=8 offset=0
+            ],
+        },
+        {
+            name: "load8",
+            params: [i32],
+            results: [i32],
+            body: [
+                0x20, 0x00,             // local.get 0
+                0x2c, 0x00, 0x00,       // i32.load8_s align=1 offset=0
+                0x20, 0x00,             // local.get 0
+                0x2d, 0x00, 0x00,       // i32.load8_u align=1 offset=0
+                0x6a,                   // i32.add
+            ],
+        },
+        {
+            name: "loadWithOffset",
+            params: [i32],
+            results: [i32],
+            body: [
+                0x20, 0x00,             // local.get 0
+                0x2f, 0x01, 0xfe, 0xff, 0x03, // i32.load16_u align=2 offset=65534
+            ],
+        },
+        {
+            name: "grow",
+            params: [i32],
+            results: [i32],
+            body: [
+                0x20, 0x00,             // local.get 0
+                0x40, 0x00,             // memory.grow
+                0x1a,                   // drop
+                0x3f, 0x00,             // memory.size
+            ],
+        },
+    ];
+
+    const calls = [];
+    for (const address of [0, 1, 65532, 65533, 65535, 65536, 0x7fffffff, -1, -4])
+        calls.push(["storeAndLoad32", address, -12345]);
+    for (const address of [0, 65528, 65529, -8])
+        calls.push(["storeAndLoad64", address, -(2n ** 62n)]);
+    for (const address of [0, 65535, 65536, -1])
+        calls.push(["load8", address]);
+    for (const address of [0, 1, 2, -1])
+        calls.push(["loadWithOffset", address]);
+    // After growing the memory, the accesses that trapped before have to succeed.
+    calls.push(["grow", 1]);
+    calls.push(["storeAndLoad32", 65536, 42]);
+    calls.push(["storeAndLoad32", 131068, 42]);
+    calls.push(["storeAndLoad32", 131069, 42]);
+    calls.push(["load8", 131071]);
+
+    const outcomes = expectSameResults({ functions, memory: 1 }, calls);
+    expect(outcomes[2].value).toBe(-12345);
+    expect(outcomes[3].trap).toBe("Execution trapped: Memory access out of bounds");
+    expect(outcomes.at(-5).value).toBe(2);
+    expect(outcomes.at(-4).value).toBe(42);
+    expect(outcomes.at(-2).trap).toBe("Execution trapped: Memory access out of bounds");
+});
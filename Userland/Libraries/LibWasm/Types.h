@@ -666,6 +666,27 @@ private:
     Vector<Memory> m_memories;
 };
 
+// Where a branch ends up: the instruction to continue at, the number of values it carries along,
+// and how many values (counted from the start of the frame) are left below those once it's taken.
+struct BranchTarget {
+    InstructionPointer ip;
+    size_t arity { 0 };
+    size_t stack_height { 0 };
+};
+
+// The targets of all the branches in a function body, worked out by the validator so that
+// the interpreter doesn't need to keep track of labels at runtime.
+// br_table gets one target per label, followed by the one for its default label.
+struct BranchTargets {
+    BranchTarget const& target_for(InstructionPointer ip, size_t index = 0) const
+    {
+        return targets[offsets[ip.value()] + index];
+    }
+
+    Vector<u32> offsets;
+    Vector<BranchTarget> targets;
+};
+
 class Expression {
 public:
     explicit Expression(Vector<Instruction> instructions)
@@ -674,11 +695,14 @@ public:
     }
 
     auto& instructions() const { return m_instructions; }
+    auto& branch_targets() const { return m_branch_targets; }
+    void set_branch_targets(BranchTargets targets) { m_branch_targets = move(targets); }
 
     static ParseResult<Expression> parse(Stream& stream);
 
 private:
     Vector<Instruction> m_instructions;
+    BranchTargets m_branch_targets;
 };
 
 class GlobalSection {
@@ -1010,6 +1034,7 @@ public:
         auto& type() const { return m_type; }
         auto& locals() const { return m_local_types; }
         auto& body() const { return m_body; }
+        auto& body() { return m_body; }
 
     private:
         TypeIndex m_type;
@@ -1075,6 +1100,7 @@ public:
     }
 
     void set_validation_status(ValidationStatus status, Badge<Validator>) { set_validation_status(status); }
+    void set_branch_targets(size_t function_index, BranchTargets targets, Badge<Validator>) { m_functions[function_index].body().set_branch_targets(move(targets)); }
     ValidationStatus validation_status() const { return m_validation_status; }
     StringView validation_error() const { return *m_validation_error; }
     void set_validation_error(ByteString error) { m_validation_error = move(error); }
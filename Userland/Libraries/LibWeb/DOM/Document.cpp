@@ -2769,6 +2769,10 @@ void Document::destroy()
     // 3. Run any unloading document cleanup steps for document that are defined by this specification and other applicable specifications.
     run_unloading_cleanup_steps();
 
+    // AD-HOC: Images that are still being decoded won't be looked at anymore.
+    for (auto& image : m_shared_image_requests)
+        image.value->cancel_decoding();
+
     // 5. Remove any tasks whose document is document from any task queue (without running those tasks).
     HTML::main_thread_event_loop().task_queue().remove_tasks_matching([this](auto& task) {
         return task.document() == this;
@@ -13,13 +13,17 @@ namespace Web::HTML {
 
 JS_DEFINE_ALLOCATOR(AnimatedBitmapDecodedImageData);
 
-ErrorOr<JS::NonnullGCPtr<AnimatedBitmapDecodedImageData>> AnimatedBitmapDecodedImageData::create(JS::Realm& realm, Vector<Frame>&& frames, size_t loop_count, bool animated)
+ErrorOr<JS::NonnullGCPtr<AnimatedBitmapDecodedImageData>> AnimatedBitmapDecodedImageData::create(JS::Realm& realm, Vector<Frame>&& frames, size_t loop_count, bool animated, Optional<size_t> frame_count)
 {
-    return realm.heap().allocate<AnimatedBitmapDecodedImageData>(realm, move(frames), loop_count, animated);
+    auto total_frame_count = frame_count.value_or(frames.size());
+    VERIFY(!frames.is_empty());
+    VERIFY(total_frame_count >= frames.size());
+    return realm.heap().allocate<AnimatedBitmapDecodedImageData>(realm, move(frames), total_frame_count, loop_count, animated);
 }
 
-AnimatedBitmapDecodedImageData::AnimatedBitmapDecodedImageData(Vector<Frame>&& frames, size_t loop_count, bool animated)
+AnimatedBitmapDecodedImageData::AnimatedBitmapDecodedImageData(Vector<Frame>&& frames, size_t frame_count, size_t loop_count, bool animated)
     : m_frames(move(frames))
+    , m_frame_count(frame_count)
     , m_loop_count(loop_count)
     , m_animated(animated)
 {
@@ -27,18 +31,24 @@ AnimatedBitmapDecodedImageData::AnimatedBitmapDecodedImageData(Vector<Frame>&& f
 
 AnimatedBitmapDecodedImageData::~AnimatedBitmapDecodedImageData() = default;
 
+void AnimatedBitmapDecodedImageData::append_decoded_frames(Vector<Frame>&& frames)
+{
+    m_frames.extend(move(frames));
+    VERIFY(m_frames.size() <= m_frame_count);
+}
+
 RefPtr<Gfx::ImmutableBitmap> AnimatedBitmapDecodedImageData::bitmap(size_t frame_index, Gfx::IntSize) const
 {
-    if (frame_index >= m_frames.size())
+    if (frame_index >= m_frame_count)
         return nullptr;
-    return m_frames[frame_index].bitmap;
+    return m_frames[min(frame_index, m_frames.size() - 1)].bitmap;
 }
 
 int AnimatedBitmapDecodedImageData::frame_duration(size_t frame_index) const
 {
-    if (frame_index >= m_frames.size())
+    if (frame_index >= m_frame_count)
         return 0;
-    return m_frames[frame_index].duration;
+    return m_frames[min(frame_index, m_frames.size() - 1)].duration;
 }
 
 Optional<CSSPixels> AnimatedBitmapDecodedImageData::intrinsic_width() const
@@ -21,13 +21,20 @@ public:
         int duration { 0 };
     };
 
-    static ErrorOr<JS::NonnullGCPtr<AnimatedBitmapDecodedImageData>> create(JS::Realm&, Vector<Frame>&&, size_t loop_count, bool animated);
+    // The image may have more frames than it's created with, if the others are still being decoded. Until they're
+    // added, the last frame we have stands in for them.
+    static ErrorOr<JS::NonnullGCPtr<AnimatedBitmapDecodedImageData>> create(JS::Realm&, Vector<Frame>&&, size_t loop_count, bool animated, Optional<size_t> frame_count = {});
     virtual ~AnimatedBitmapDecodedImageData() override;
 
+    size_t decoded_frame_count() const { return m_frames.size(); }
+    void append_decoded_frames(Vector<Frame>&&);
+    // The remaining frames aren't coming, so the image ends with the ones it has.
+    void did_fail_to_decode_remaining_frames() { m_frame_count = m_frames.size(); }
+
     virtual RefPtr<Gfx::ImmutableBitmap> bitmap(size_t frame_index, Gfx::IntSize = {}) const override;
     virtual int frame_duration(size_t frame_index) const override;
 
-    virtual size_t frame_count() const override { return m_frames.size(); }
+    virtual size_t frame_count() const override { return m_frame_count; }
     virtual size_t loop_count() const override { return m_loop_count; }
     virtual bool is_animated() const override { return m_animated; }
 
@@ -36,9 +43,10 @@ public:
     virtual Optional<CSSPixelFraction> intrinsic_aspect_ratio() const override;
 
 private:
-    AnimatedBitmapDecodedImageData(Vector<Frame>&&, size_t loop_count, bool animated);
+    AnimatedBitmapDecodedImageData(Vector<Frame>&&, size_t frame_count, size_t loop_count, bool animated);
 
     Vector<Frame> m_frames;
+    size_t m_frame_count { 0 };
     size_t m_loop_count { 0 };
     bool m_animated { false };
 };
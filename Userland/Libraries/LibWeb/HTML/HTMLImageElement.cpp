@@ -158,9 +158,15 @@ RefPtr<Gfx::ImmutableBitmap> HTMLImageElement::current_image_bitmap(Gfx::IntSize
     return nullptr;
 }
 
-void HTMLImageElement::set_visible_in_viewport(bool)
+void HTMLImageElement::set_visible_in_viewport(bool visible)
 {
     // FIXME: Loosen grip on image data when it's not visible, e.g via volatile memory.
+
+    // Images that are still being decoded get to go first if they're visible.
+    for (auto request : { m_current_request, m_pending_request }) {
+        if (request && request->shared_image_request())
+            request->shared_image_request()->set_visible_in_viewport(visible);
+    }
 }
 
 // https://html.spec.whatwg.org/multipage/embedded-content.html#dom-img-width
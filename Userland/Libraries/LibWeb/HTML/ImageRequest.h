@@ -58,6 +58,7 @@ public:
     void fetch_image(JS::Realm&, JS::NonnullGCPtr<Fetch::Infrastructure::Request>);
     void add_callbacks(Function<void()> on_finish, Function<void()> on_fail);
 
+    SharedImageRequest* shared_image_request() { return m_shared_image_request; }
     SharedImageRequest const* shared_image_request() const { return m_shared_image_request; }
 
     virtual void visit_edges(JS::Cell::Visitor&) override;
@@ -134,6 +134,18 @@ void SharedImageRequest::add_callbacks(Function<void()> on_finish, Function<void
     m_callbacks.append(move(callbacks));
 }
 
+static Vector<AnimatedBitmapDecodedImageData::Frame> to_animated_bitmap_frames(ReadonlySpan<Web::Platform::Frame> decoded_frames)
+{
+    Vector<AnimatedBitmapDecodedImageData::Frame> frames;
+    for (auto& frame : decoded_frames) {
+        frames.append(AnimatedBitmapDecodedImageData::Frame {
+            .bitmap = Gfx::ImmutableBitmap::create(*frame.bitmap),
+            .duration = static_cast<int>(frame.duration),
+        });
+    }
+    return frames;
+}
+
 void SharedImageRequest::handle_successful_fetch(AK::URL const& url_string, StringView mime_type, ByteBuffer data)
 {
     // AD-HOC: At this point, things gets very ad-hoc.
@@ -141,37 +153,44 @@ void SharedImageRequest::handle_successful_fetch(AK::URL const& url_string, Stri
 
     bool const is_svg_image = mime_type == "image/svg+xml"sv || url_string.basename().ends_with(".svg"sv);
 
-    JS::GCPtr<DecodedImageData> image_data;
-
-    auto handle_failed_decode = [&] {
-        m_state = State::Failed;
-        for (auto& callback : m_callbacks) {
-            if (callback.on_fail)
-                callback.on_fail->function()();
-        }
-    };
-
     if (is_svg_image) {
         auto result = SVG::SVGDecodedImageData::create(m_document->realm(), m_page, url_string, data);
         if (result.is_error())
-            return handle_failed_decode();
+            return handle_failed_fetch();
+        return handle_successful_decode(result.release_value());
+    }
 
-        image_data = result.release_value();
-    } else {
-        auto result = Web::Platform::ImageCodecPlugin::the().decode_image(data.bytes());
-        if (!result.has_value())
-            return handle_failed_decode();
-
-        Vector<AnimatedBitmapDecodedImageData::Frame> frames;
-        for (auto& frame : result.value().frames) {
-            frames.append(AnimatedBitmapDecodedImageData::Frame {
-                .bitmap = Gfx::ImmutableBitmap::create(*frame.bitmap),
-                .duration = static_cast<int>(frame.duration),
-            });
+    // The decoder holds on to us until it's done, since nobody else might.
+    auto on_first_frame = [this, strong_this = JS::make_handle(*this)](Web::Platform::DecodedImage image, u32 frame_count) {
+        // The image is shown as soon as we have its first frame, and the others are added once they arrive.
+        handle_successful_decode(AnimatedBitmapDecodedImageData::create(m_document->realm(), to_animated_bitmap_frames(image.frames), image.loop_count, image.is_animated, frame_count).release_value_but_fixme_should_propagate_errors());
+    };
+    auto on_complete = [this, strong_this = JS::make_handle(*this)](Optional<Web::Platform::DecodedImage> result) {
+        m_decoding_image_id.clear();
+
+        if (m_image_data) {
+            auto& image_data = verify_cast<AnimatedBitmapDecodedImageData>(*m_image_data);
+            if (!result.has_value())
+                return image_data.did_fail_to_decode_remaining_frames();
+            image_data.append_decoded_frames(to_animated_bitmap_frames(result->frames.span().slice(image_data.decoded_frame_count())));
+            return;
         }
-        image_data = AnimatedBitmapDecodedImageData::create(m_document->realm(), move(frames), result.value().loop_count, result.value().is_animated).release_value_but_fixme_should_propagate_errors();
-    }
 
+        if (!result.has_value())
+            return handle_failed_fetch();
+        handle_successful_decode(AnimatedBitmapDecodedImageData::create(m_document->realm(), to_animated_bitmap_frames(result->frames), result->loop_count, result->is_animated).release_value_but_fixme_should_propagate_errors());
+    };
+    auto decoding_image_id = Web::Platform::ImageCodecPlugin::the().start_decoding_image(data.bytes(), move(on_first_frame), move(on_complete));
+    if (decoding_image_id.is_error())
+        return handle_failed_fetch();
+
+    m_decoding_image_id = decoding_image_id.release_value();
+    if (m_is_visible_in_viewport)
+        Web::Platform::ImageCodecPlugin::the().set_image_visible(*m_decoding_image_id, true);
+}
+
+void SharedImageRequest::handle_successful_decode(JS::NonnullGCPtr<DecodedImageData> image_data)
+{
     m_image_data = image_data;
 
     m_state = State::Finished;
@@ -203,4 +222,30 @@ bool SharedImageRequest::is_fetching() const
     return m_state == State::Fetching;
 }
 
+void SharedImageRequest::set_visible_in_viewport(bool visible)
+{
+    if (m_is_visible_in_viewport == visible)
+        return;
+    m_is_visible_in_viewport = visible;
+    if (m_decoding_image_id.has_value())
+        Web::Platform::ImageCodecPlugin::the().set_image_visible(*m_decoding_image_id, visible);
+}
+
+void SharedImageRequest::cancel_decoding()
+{
+    if (!m_decoding_image_id.has_value())
+        return;
+    Web::Platform::ImageCodecPlugin::the().cancel_decoding(m_decoding_image_id.release_value());
+
+    // If the first frame is already being shown, the image just stops there.
+    if (m_state == State::Finished) {
+        verify_cast<AnimatedBitmapDecodedImageData>(*m_image_data).did_fail_to_decode_remaining_frames();
+        return;
+    }
+
+    // Nobody is waiting for the image anymore, so there is nobody to tell either.
+    m_state = State::Failed;
+    m_callbacks.clear();
+}
+
 }
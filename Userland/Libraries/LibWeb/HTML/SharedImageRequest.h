@@ -40,6 +40,9 @@ public:
     bool is_fetching() const;
     bool needs_fetching() const;
 
+    void set_visible_in_viewport(bool);
+    void cancel_decoding();
+
 private:
     explicit SharedImageRequest(JS::NonnullGCPtr<Page>, AK::URL, JS::NonnullGCPtr<DOM::Document>);
 
@@ -48,6 +51,7 @@ private:
 
     void handle_successful_fetch(AK::URL const&, StringView mime_type, ByteBuffer data);
     void handle_failed_fetch();
+    void handle_successful_decode(JS::NonnullGCPtr<DecodedImageData>);
 
     enum class State {
         New,
@@ -71,6 +75,9 @@ private:
     JS::GCPtr<Fetch::Infrastructure::FetchController> m_fetch_controller;
 
     JS::GCPtr<DOM::Document> m_document;
+
+    Optional<i64> m_decoding_image_id;
+    bool m_is_visible_in_viewport { false };
 };
 
 }
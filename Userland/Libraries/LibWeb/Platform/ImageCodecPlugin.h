@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <AK/Error.h>
+#include <AK/Function.h>
 #include <AK/RefPtr.h>
 #include <AK/Vector.h>
 #include <LibGfx/Forward.h>
@@ -32,6 +34,14 @@ public:
     virtual ~ImageCodecPlugin();
 
     virtual Optional<DecodedImage> decode_image(ReadonlyBytes) = 0;
+
+    // Decodes the image in the background, and calls on_complete with the result on this thread once it's done.
+    // Images with more than one frame are first handed to on_first_frame with only their first frame, so they can be
+    // shown while the others are still being decoded.
+    virtual ErrorOr<i64> start_decoding_image(ReadonlyBytes, Function<void(DecodedImage, u32 frame_count)> on_first_frame, Function<void(Optional<DecodedImage>)> on_complete) = 0;
+    // Images that are visible are decoded before the ones that aren't.
+    virtual void set_image_visible(i64 image_id, bool) = 0;
+    virtual void cancel_decoding(i64 image_id) = 0;
 };
 
 }
@@ -17,6 +17,12 @@ ConnectionFromClient::ConnectionFromClient(NonnullOwnPtr<Core::LocalSocket> sock
 {
 }
 
+ConnectionFromClient::~ConnectionFromClient()
+{
+    for (auto& it : m_jobs)
+        DecoderPool::the().cancel(*it.value);
+}
+
 void ConnectionFromClient::die()
 {
     Core::EventLoop::current().quit(0);
@@ -72,4 +78,48 @@ Messages::ImageDecoderServer::DecodeImageResponse ConnectionFromClient::decode_i
     return { is_animated, loop_count, bitmaps, durations };
 }
 
+void ConnectionFromClient::start_decoding_image(i64 image_id, Core::AnonymousBuffer const& encoded_buffer, Optional<Gfx::IntSize> const& ideal_size, Optional<ByteString> const& mime_type)
+{
+    if (m_jobs.contains(image_id)) {
+        did_misbehave("Image is already being decoded");
+        return;
+    }
+    if (!encoded_buffer.is_valid()) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Encoded data is invalid");
+        async_did_fail_to_decode_image(image_id);
+        return;
+    }
+
+    auto job = make_ref_counted<DecoderPool::Job>();
+    job->encoded_data = encoded_buffer;
+    job->ideal_size = ideal_size;
+    job->mime_type = mime_type;
+    job->on_start = [this, image_id](bool is_animated, u32 loop_count, size_t frame_count) {
+        async_did_start_decoding_image(image_id, is_animated, loop_count, frame_count);
+    };
+    job->on_frame = [this, image_id](size_t index, NonnullRefPtr<Gfx::Bitmap> bitmap, u32 duration) {
+        async_did_decode_image_frame(image_id, index, bitmap->to_shareable_bitmap(), duration);
+    };
+    job->on_finish = [this, image_id](bool success) {
+        m_jobs.remove(image_id);
+        if (!success)
+            async_did_fail_to_decode_image(image_id);
+    };
+
+    m_jobs.set(image_id, job);
+    DecoderPool::the().enqueue(move(job));
+}
+
+void ConnectionFromClient::set_image_visible(i64 image_id, bool is_visible)
+{
+    if (auto job = m_jobs.get(image_id); job.has_value())
+        job.value()->is_visible = is_visible;
+}
+
+void ConnectionFromClient::cancel_decoding(i64 image_id)
+{
+    if (auto job = m_jobs.take(image_id); job.has_value())
+        DecoderPool::the().cancel(*job.value());
+}
+
 }
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <ImageDecoder/DecoderPool.h>
+#include <LibGfx/ImageFormats/ImageDecoder.h>
+#include <unistd.h>
+
+namespace ImageDecoder {
+
+DecoderPool& DecoderPool::the()
+{
+    static DecoderPool* s_the;
+    if (!s_the) {
+        // Each of our threads decodes an image of its own, so the decoders themselves stick to the thread they're on.
+        size_t thread_count = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+        thread_count = max(sysconf(_SC_NPROCESSORS_ONLN), 1);
+#endif
+        s_the = new DecoderPool(thread_count);
+        s_the->start();
+    }
+    return *s_the;
+}
+
+DecoderPool::DecoderPool(size_t thread_count)
+    : m_event_loop(Core::EventLoop::current())
+    , m_thread_count(thread_count)
+{
+}
+
+DecoderPool::~DecoderPool()
+{
+    {
+        Threading::MutexLocker locker(m_mutex);
+        m_is_stopping = true;
+        m_queue.clear();
+    }
+    m_condition.broadcast();
+
+    for (auto& thread : m_threads)
+        (void)thread->join();
+}
+
+void DecoderPool::start()
+{
+    VERIFY(m_threads.is_empty());
+    for (size_t i = 0; i < m_thread_count; ++i) {
+        auto thread = Threading::Thread::construct([this] {
+            while (auto job = take_next_job())
+                decode(job.release_nonnull());
+            return 0;
+        },
+            "ImageDecoder worker"sv);
+        thread->start();
+        m_threads.append(move(thread));
+    }
+}
+
+void DecoderPool::enqueue(NonnullRefPtr<Job> job)
+{
+    {
+        Threading::MutexLocker locker(m_mutex);
+        m_queue.append(move(job));
+    }
+    m_condition.signal();
+}
+
+void DecoderPool::cancel(Job& job)
+{
+    job.is_canceled = true;
+
+    Threading::MutexLocker locker(m_mutex);
+    m_queue.remove_first_matching([&](auto& queued_job) { return queued_job.ptr() == &job; });
+}
+
+RefPtr<DecoderPool::Job> DecoderPool::take_next_job()
+{
+    Threading::MutexLocker locker(m_mutex);
+    while (m_queue.is_empty() && !m_is_stopping)
+        m_condition.wait();
+    if (m_is_stopping)
+        return nullptr;
+
+    // Visible images go first, the others are decoded in the order they were asked for.
+    auto index = m_queue.find_first_index_if([](auto& job) { return job->is_visible.load(); });
+    return m_queue.take(index.value_or(0));
+}
+
+// The decoder may hold on to the frames it hands out, so we always give the main thread a copy it owns alone.
+static ErrorOr<NonnullRefPtr<Gfx::Bitmap>> copy_to_anonymous_buffer(Gfx::Bitmap const& bitmap)
+{
+    auto buffer = TRY(Core::AnonymousBuffer::create_with_size(round_up_to_power_of_two(bitmap.size_in_bytes(), PAGE_SIZE)));
+    auto copy = TRY(Gfx::Bitmap::create_with_anonymous_buffer(bitmap.format(), move(buffer), bitmap.size(), bitmap.scale()));
+    memcpy(copy->scanline(0), bitmap.scanline(0), bitmap.size_in_bytes());
+    return copy;
+}
+
+// This runs on one of our threads. Reference counts that aren't atomic must not be touched from here, which is why the
+// job's strings and buffers are only ever read, and why the job itself is handed back to the main thread to be
+// destroyed there.
+void DecoderPool::decode(NonnullRefPtr<Job> job)
+{
+    if (job->is_canceled)
+        return finish(move(job), false);
+
+    Optional<ByteString> mime_type;
+    if (job->mime_type.has_value())
+        mime_type = ByteString { job->mime_type->view() };
+
+    auto decoder = Gfx::ImageDecoder::try_create_for_raw_bytes(ReadonlyBytes { job->encoded_data.data<u8>(), job->encoded_data.size() }, move(mime_type));
+    if (!decoder) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Could not find suitable image decoder plugin for data");
+        return finish(move(job), false);
+    }
+    if (!decoder->frame_count()) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Could not decode image from encoded data");
+        return finish(move(job), false);
+    }
+
+    m_event_loop.deferred_invoke([job, is_animated = decoder->is_animated(), loop_count = decoder->loop_count(), frame_count = decoder->frame_count()] {
+        if (!job->is_canceled)
+            job->on_start(is_animated, loop_count, frame_count);
+    });
+
+    for (size_t i = 0; i < decoder->frame_count(); ++i) {
+        if (job->is_canceled)
+            return finish(move(job), false);
+
+        auto frame_or_error = decoder->frame(i, job->ideal_size);
+        if (frame_or_error.is_error()) {
+            dbgln_if(IMAGE_DECODER_DEBUG, "Could not decode frame {}: {}", i, frame_or_error.error());
+            return finish(move(job), false);
+        }
+        auto frame = frame_or_error.release_value();
+        auto bitmap_or_error = copy_to_anonymous_buffer(*frame.image);
+        if (bitmap_or_error.is_error())
+            return finish(move(job), false);
+
+        m_event_loop.deferred_invoke([job, i, bitmap = bitmap_or_error.release_value(), duration = frame.duration]() mutable {
+            if (!job->is_canceled)
+                job->on_frame(i, move(bitmap), duration);
+        });
+    }
+
+    finish(move(job), true);
+}
+
+void DecoderPool::finish(NonnullRefPtr<Job> job, bool success)
+{
+    m_event_loop.deferred_invoke([job = move(job), success] {
+        if (!job->is_canceled)
+            job->on_finish(success);
+    });
+}
+
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/AtomicRefCounted.h>
+#include <AK/ByteString.h>
+#include <AK/Function.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Vector.h>
+#include <LibCore/AnonymousBuffer.h>
+#include <LibCore/EventLoop.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Size.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+
+namespace ImageDecoder {
+
+// Decodes images on threads of its own, so that a page full of images doesn't have to wait for each of them in turn.
+// Images that are visible are decoded before the ones that aren't.
+class DecoderPool {
+public:
+    // Everything but the flags is set up before the job is queued, and left alone afterwards. The callbacks are
+    // called on the event loop that the pool was created on, and not at all once the job has been canceled.
+    struct Job : public AtomicRefCounted<Job> {
+        Core::AnonymousBuffer encoded_data;
+        Optional<Gfx::IntSize> ideal_size;
+        Optional<ByteString> mime_type;
+
+        Function<void(bool is_animated, u32 loop_count, size_t frame_count)> on_start;
+        Function<void(size_t index, NonnullRefPtr<Gfx::Bitmap>, u32 duration)> on_frame;
+        // Called last, whether the image could be decoded or not.
+        Function<void(bool success)> on_finish;
+
+        Atomic<bool> is_visible { false };
+        Atomic<bool> is_canceled { false };
+    };
+
+    static DecoderPool& the();
+
+    // The threads only start taking jobs once start() has been called, so jobs may be queued up before that.
+    explicit DecoderPool(size_t thread_count);
+    // Waits for the jobs that are being decoded, and drops the ones that are still queued.
+    ~DecoderPool();
+
+    void start();
+
+    void enqueue(NonnullRefPtr<Job>);
+    void cancel(Job&);
+
+private:
+    // Returns nothing once the pool is being destroyed.
+    RefPtr<Job> take_next_job();
+    void decode(NonnullRefPtr<Job>);
+    void finish(NonnullRefPtr<Job>, bool success);
+
+    Core::EventLoop& m_event_loop;
+    Threading::Mutex m_mutex;
+    Threading::ConditionVariable m_condition { m_mutex };
+    Vector<NonnullRefPtr<Job>> m_queue;
+    bool m_is_stopping { false };
+    size_t m_thread_count { 0 };
+    Vector<NonnullRefPtr<Threading::Thread>> m_threads;
+};
+
+}
@@ -64,4 +64,13 @@ Messages::LookupServer::LookupAddressResponse ConnectionFromClient::lookup_addre
         return { 1, ByteString() };
     return { 0, answers[0].record_data() };
 }
+
+Messages::LookupServer::CacheStatisticsResponse ConnectionFromClient::cache_statistics()
+{
+    auto& lookup_server = LookupServer::the();
+    auto& cache = lookup_server.cache();
+    auto& statistics = cache.statistics();
+    return { cache.size(), cache.capacity(), statistics.hits, statistics.negative_hits, statistics.misses, statistics.evictions, lookup_server.refresh_count() };
+}
+
 }
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "LookupCache.h"
+#include <AK/Debug.h>
+
+namespace LookupServer {
+
+// We don't keep anything around for longer than this, whatever the nameserver says.
+static constexpr u32 maximum_ttl = 86400;
+// https://www.rfc-editor.org/rfc/rfc2308#section-5
+static constexpr u32 maximum_negative_ttl = 3 * 3600;
+
+// An entry that was asked for at least this often since it was fetched is refreshed once less than a tenth of its
+// TTL is left, so that popular names don't ever have to wait for the nameservers.
+static constexpr u32 refresh_minimum_hits = 2;
+static constexpr u32 refresh_minimum_ttl = 10;
+
+LookupCache::LookupCache(size_t capacity)
+    : m_capacity(max(capacity, 1u))
+{
+}
+
+Optional<LookupCache::Hit> LookupCache::lookup(CacheKey const& key, MonotonicTime now)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        ++m_statistics.misses;
+        return {};
+    }
+
+    auto& entry = *it->value;
+    if (now >= entry.expiry_time) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "Cache entry for {} ({}) has expired", key.name.as_string(), key.record_type);
+        remove(entry);
+        ++m_statistics.misses;
+        return {};
+    }
+
+    m_lru_list.prepend(entry);
+    ++entry.hits_since_fetch;
+    if (entry.answers.is_empty())
+        ++m_statistics.negative_hits;
+    else
+        ++m_statistics.hits;
+
+    Hit hit;
+    // Hand out the TTL that is left, not the one we got.
+    auto remaining_ttl = static_cast<u32>((entry.expiry_time - now).to_seconds());
+    hit.answers.ensure_capacity(entry.answers.size());
+    for (auto& answer : entry.answers)
+        hit.answers.empend(answer.name(), answer.type(), answer.class_code(), remaining_ttl, answer.record_data(), answer.mdns_cache_flush());
+
+    if (!entry.is_being_refreshed
+        && !entry.answers.is_empty()
+        && entry.hits_since_fetch >= refresh_minimum_hits
+        && entry.ttl >= refresh_minimum_ttl
+        && entry.expiry_time - now < Duration::from_milliseconds(entry.ttl * 100)) {
+        // Further hits don't ask again, the refresh will replace this entry once it's done.
+        entry.is_being_refreshed = true;
+        hit.should_refresh = true;
+    }
+    return hit;
+}
+
+void LookupCache::put(CacheKey const& key, Vector<Answer> const& answers, MonotonicTime now)
+{
+    if (answers.is_empty())
+        return;
+
+    u32 ttl = maximum_ttl;
+    for (auto& answer : answers)
+        ttl = min(ttl, answer.ttl());
+    insert(key, answers, ttl, now);
+}
+
+void LookupCache::put_negative(CacheKey const& key, u32 ttl, MonotonicTime now)
+{
+    insert(key, {}, min(ttl, maximum_negative_ttl), now);
+}
+
+void LookupCache::did_fail_to_refresh(CacheKey const& key)
+{
+    if (auto it = m_entries.find(key); it != m_entries.end())
+        it->value->is_being_refreshed = false;
+}
+
+void LookupCache::insert(CacheKey const& key, Vector<Answer> answers, u32 ttl, MonotonicTime now)
+{
+    if (ttl == 0)
+        return;
+
+    if (auto it = m_entries.find(key); it != m_entries.end())
+        remove(*it->value);
+
+    while (m_entries.size() >= m_capacity) {
+        ++m_statistics.evictions;
+        remove(*m_lru_list.last());
+    }
+
+    auto entry = make<Entry>(key, move(answers), ttl, now);
+    m_lru_list.prepend(*entry);
+    m_entries.set(key, move(entry));
+}
+
+void LookupCache::remove(Entry& entry)
+{
+    m_lru_list.remove(entry);
+    auto key = entry.key;
+    m_entries.remove(key);
+}
+
+}
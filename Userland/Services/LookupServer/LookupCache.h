@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Time.h>
+#include <LibDNS/Answer.h>
+#include <LibDNS/Name.h>
+
+namespace LookupServer {
+
+using namespace DNS;
+
+struct CacheKey {
+    Name name;
+    RecordType record_type;
+
+    bool operator==(CacheKey const&) const = default;
+};
+
+}
+
+template<>
+struct AK::Traits<LookupServer::CacheKey> : public DefaultTraits<LookupServer::CacheKey> {
+    static unsigned hash(LookupServer::CacheKey const& key)
+    {
+        return pair_int_hash(DNS::Name::Traits::hash(key.name), to_underlying(key.record_type));
+    }
+};
+
+namespace LookupServer {
+
+// The answers to questions we asked the nameservers (or mDNS), until their TTL runs out. Questions that have no answer
+// are remembered as well (RFC 2308). Once full, the least recently used entry makes room for new ones.
+class LookupCache {
+public:
+    struct Statistics {
+        u64 hits { 0 };
+        u64 negative_hits { 0 };
+        u64 misses { 0 };
+        u64 evictions { 0 };
+    };
+
+    struct Hit {
+        // Empty if the name doesn't exist, or has no records of the type.
+        Vector<Answer> answers;
+        // The entry is popular and about to expire, so it should be fetched again before it does.
+        bool should_refresh { false };
+    };
+
+    explicit LookupCache(size_t capacity);
+
+    Optional<Hit> lookup(CacheKey const&, MonotonicTime now = MonotonicTime::now());
+    void put(CacheKey const&, Vector<Answer> const&, MonotonicTime now = MonotonicTime::now());
+    void put_negative(CacheKey const&, u32 ttl, MonotonicTime now = MonotonicTime::now());
+    // Lets the entry be refreshed again by a later hit, if the refresh that lookup() asked for didn't get an answer.
+    void did_fail_to_refresh(CacheKey const&);
+
+    size_t size() const { return m_entries.size(); }
+    size_t capacity() const { return m_capacity; }
+    Statistics const& statistics() const { return m_statistics; }
+
+private:
+    struct Entry {
+        Entry(CacheKey key, Vector<Answer> answers, u32 ttl, MonotonicTime now)
+            : key(move(key))
+            , answers(move(answers))
+            , expiry_time(now + Duration::from_seconds(ttl))
+            , ttl(ttl)
+        {
+        }
+
+        CacheKey key;
+        Vector<Answer> answers;
+        MonotonicTime expiry_time;
+        u32 ttl { 0 };
+        u32 hits_since_fetch { 0 };
+        bool is_being_refreshed { false };
+
+        IntrusiveListNode<Entry> m_list_node;
+    };
+
+    void insert(CacheKey const&, Vector<Answer>, u32 ttl, MonotonicTime now);
+    void remove(Entry&);
+
+    size_t m_capacity { 0 };
+    HashMap<CacheKey, NonnullOwnPtr<Entry>> m_entries;
+    // Most recently used first.
+    IntrusiveList<&Entry::m_list_node> m_lru_list;
+    Statistics m_statistics;
+};
+
+}
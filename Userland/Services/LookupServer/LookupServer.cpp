@@ -17,6 +17,7 @@
 #include <LibCore/File.h>
 #include <LibCore/LocalServer.h>
 #include <LibDNS/Packet.h>
+#include <LibThreading/BackgroundAction.h>
 #include <limits.h>
 #include <stdio.h>
 #include <time.h>
@@ -42,6 +43,7 @@ LookupServer::LookupServer()
     auto config = Core::ConfigFile::open_for_system("LookupServer").release_value_but_fixme_should_propagate_errors();
     dbgln("Using network config file at {}", config->filename());
     m_nameservers = config->read_entry("DNS", "Nameservers", "1.1.1.1,1.0.0.1").split(',');
+    m_lookup_cache = make<LookupCache>(config->read_num_entry<size_t>("DNS", "CacheSize", 1024));
 
     load_etc_hosts();
 
@@ -188,64 +190,79 @@ ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, RecordType record
     }
 
     // Third, try our cache.
-    if (auto cached_answers = m_lookup_cache.find(name); cached_answers != m_lookup_cache.end()) {
-        for (auto& answer : cached_answers->value) {
-            // TODO: Actually remove expired answers from the cache.
-            if (answer.type() == record_type && !answer.has_expired()) {
-                dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {}", name.as_string(), answer.record_data());
-                add_answer(answer);
-            }
-        }
-        if (!answers.is_empty())
-            return answers;
+    CacheKey key { name, record_type };
+    if (auto hit = m_lookup_cache->lookup(key); hit.has_value()) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {} answer(s)", name.as_string(), hit->answers.size());
+        if (hit->should_refresh)
+            refresh_in_background(key);
+        for (auto& answer : hit->answers)
+            add_answer(answer);
+        return answers;
     }
 
     // Fourth, look up .local names using mDNS instead of DNS nameservers.
     if (name.as_string().ends_with(".local"sv)) {
         answers = TRY(m_mdns->lookup(name, record_type));
-        for (auto& answer : answers)
-            put_in_cache(answer);
+        m_lookup_cache->put(key, answers);
         return answers;
     }
 
     // Fifth, ask the upstream nameservers.
-    for (auto& nameserver : m_nameservers) {
+    auto response = lookup_upstream(m_nameservers, name, record_type);
+    put_in_cache(key, response);
+    for (auto& answer : response.answers)
+        add_answer(answer);
+    return answers;
+}
+
+LookupServer::UpstreamResponse LookupServer::lookup_upstream(Vector<ByteString> const& nameservers, Name const& name, RecordType record_type)
+{
+    for (auto& nameserver : nameservers) {
         dbgln_if(LOOKUPSERVER_DEBUG, "Doing lookup using nameserver '{}'", nameserver);
         bool did_get_response = false;
         int retries = 3;
-        Vector<Answer> upstream_answers;
+        UpstreamResponse response;
         do {
-            auto upstream_answers_or_error = lookup(name, nameserver, did_get_response, record_type);
-            if (upstream_answers_or_error.is_error())
+            auto response_or_error = lookup(name, nameserver, did_get_response, record_type);
+            if (response_or_error.is_error())
                 continue;
-            upstream_answers = upstream_answers_or_error.release_value();
+            response = response_or_error.release_value();
             if (did_get_response)
                 break;
         } while (--retries);
-        if (!upstream_answers.is_empty()) {
-            for (auto& answer : upstream_answers) {
-                add_answer(answer);
-                put_in_cache(answer);
-            }
-            break;
-        } else {
-            if (!did_get_response)
-                dbgln("Never got a response from '{}', trying next nameserver", nameserver);
-            else
-                dbgln("Received response from '{}' but no result(s), trying next nameserver", nameserver);
-        }
+
+        // A negative response is as definitive as any answer, the other nameservers are going to say the same.
+        if (!response.answers.is_empty() || response.negative_ttl.has_value())
+            return response;
+
+        if (!did_get_response)
+            dbgln("Never got a response from '{}', trying next nameserver", nameserver);
+        else
+            dbgln("Received response from '{}' but no result(s), trying next nameserver", nameserver);
     }
 
-    // Sixth, fail.
-    if (answers.is_empty()) {
-        dbgln("Tried all nameservers but never got a response :(");
-        return Vector<Answer> {};
+    dbgln("Tried all nameservers but never got a response :(");
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc2308#section-5
+static Optional<u32> negative_cache_ttl(Packet const& response)
+{
+    for (auto& record : response.authorities()) {
+        // The SOA's MINIMUM field is the last one, after two (possibly compressed) names and four other fields.
+        auto const& data = record.record_data();
+        if (record.type() != RecordType::SOA || data.length() < 22)
+            continue;
+        auto const* minimum = reinterpret_cast<u8 const*>(data.characters()) + data.length() - 4;
+        u32 minimum_ttl = (minimum[0] << 24) | (minimum[1] << 16) | (minimum[2] << 8) | minimum[3];
+        return min(record.ttl(), minimum_ttl);
     }
 
-    return answers;
+    // Negative responses without an SOA record should not be cached.
+    return {};
 }
 
-ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, ByteString const& nameserver, bool& did_get_response, RecordType record_type, ShouldRandomizeCase should_randomize_case)
+ErrorOr<LookupServer::UpstreamResponse> LookupServer::lookup(Name const& name, ByteString const& nameserver, bool& did_get_response, RecordType record_type, ShouldRandomizeCase should_randomize_case)
 {
     Packet request;
     request.set_is_query();
@@ -265,19 +282,19 @@ ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, ByteString const&
     u8 response_buffer[4096];
     auto nrecv = TRY(udp_socket->read_some({ response_buffer, sizeof(response_buffer) })).size();
     if (udp_socket->is_eof())
-        return Vector<Answer> {};
+        return UpstreamResponse {};
 
     did_get_response = true;
 
     auto response_or_error = Packet::from_raw_packet({ response_buffer, nrecv });
     if (response_or_error.is_error())
-        return Vector<Answer> {};
+        return UpstreamResponse {};
 
     auto response = response_or_error.release_value();
 
     if (response.id() != request.id()) {
         dbgln("LookupServer: ID mismatch ({} vs {}) :(", response.id(), request.id());
-        return Vector<Answer> {};
+        return UpstreamResponse {};
     }
 
     if (response.code() == Packet::Code::REFUSED) {
@@ -285,12 +302,18 @@ ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, ByteString const&
             // Retry with 0x20 case randomization turned off.
             return lookup(name, nameserver, did_get_response, record_type, ShouldRandomizeCase::No);
         }
-        return Vector<Answer> {};
+        return UpstreamResponse {};
+    }
+
+    // Other failures come without the rest of the response.
+    if (response.code() != Packet::Code::NOERROR && response.code() != Packet::Code::NXDOMAIN) {
+        dbgln("LookupServer: Error response ({}) :(", to_underlying(response.code()));
+        return UpstreamResponse {};
     }
 
     if (response.question_count() != request.question_count()) {
         dbgln("LookupServer: Question count ({} vs {}) :(", response.question_count(), request.question_count());
-        return Vector<Answer> {};
+        return UpstreamResponse {};
     }
 
     // Verify the questions in our request and in their response match, ignoring case.
@@ -304,56 +327,57 @@ ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, ByteString const&
             dbgln("Request and response questions do not match");
             dbgln("   Request: name=_{}_, type={}, class={}", request_question.name().as_string(), response_question.record_type(), response_question.class_code());
             dbgln("  Response: name=_{}_, type={}, class={}", response_question.name().as_string(), response_question.record_type(), response_question.class_code());
-            return Vector<Answer> {};
+            return UpstreamResponse {};
         }
     }
 
-    if (response.answer_count() < 1) {
-        dbgln("LookupServer: No answers :(");
-        return Vector<Answer> {};
+    UpstreamResponse upstream_response;
+    for (auto& answer : response.answers()) {
+        if (answer.type() == record_type)
+            upstream_response.answers.append(answer);
     }
 
-    Vector<Answer, 8> answers;
-    for (auto& answer : response.answers()) {
-        put_in_cache(answer);
-        if (answer.type() != record_type)
-            continue;
-        answers.append(answer);
+    if (upstream_response.answers.is_empty()) {
+        upstream_response.negative_ttl = negative_cache_ttl(response);
+        dbgln_if(LOOKUPSERVER_DEBUG, "LookupServer: No answers, {}", response.code() == Packet::Code::NXDOMAIN ? "no such name" : "no records of this type");
     }
+    return upstream_response;
+}
 
-    return answers;
+void LookupServer::put_in_cache(CacheKey const& key, UpstreamResponse const& response)
+{
+    if (!response.answers.is_empty())
+        m_lookup_cache->put(key, response.answers);
+    else if (response.negative_ttl.has_value())
+        m_lookup_cache->put_negative(key, *response.negative_ttl);
 }
 
-void LookupServer::put_in_cache(Answer const& answer)
+void LookupServer::refresh_in_background(CacheKey const& key)
 {
-    if (answer.has_expired())
-        return;
-
-    // Prevent the cache from growing too big.
-    // TODO: Evict least used entries.
-    if (m_lookup_cache.size() >= 256)
-        m_lookup_cache.remove(m_lookup_cache.begin());
-
-    auto it = m_lookup_cache.find(answer.name());
-    if (it == m_lookup_cache.end())
-        m_lookup_cache.set(answer.name(), { answer });
-    else {
-        if (answer.mdns_cache_flush()) {
-            auto now = time(nullptr);
-
-            it->value.remove_all_matching([&](Answer const& other_answer) {
-                if (other_answer.type() != answer.type() || other_answer.class_code() != answer.class_code())
-                    return false;
-
-                if (other_answer.received_time() >= now - 1)
-                    return false;
-
-                dbgln_if(LOOKUPSERVER_DEBUG, "Removing cache entry: {}", other_answer.name());
-                return true;
-            });
-        }
-        it->value.append(answer);
-    }
+    dbgln_if(LOOKUPSERVER_DEBUG, "Refreshing {} ({}) in the background", key.name.as_string(), key.record_type);
+    ++m_refresh_count;
+
+    // Strings aren't safe to share between threads, so the background thread gets copies of its own.
+    Vector<ByteString> nameservers;
+    for (auto& nameserver : m_nameservers)
+        nameservers.append(nameserver.view());
+    Name name { key.name.as_string().view() };
+
+    (void)Threading::BackgroundAction<UpstreamResponse>::construct(
+        [nameservers = move(nameservers), name = move(name), record_type = key.record_type](auto&) -> ErrorOr<UpstreamResponse> {
+            return lookup_upstream(nameservers, name, record_type);
+        },
+        [this, key](UpstreamResponse response) -> ErrorOr<void> {
+            // None of the nameservers answered, the entry stays as it is until the next hit tries again.
+            if (response.answers.is_empty() && !response.negative_ttl.has_value())
+                m_lookup_cache->did_fail_to_refresh(key);
+            else
+                put_in_cache(key, response);
+            return {};
+        },
+        [this, key](Error) {
+            m_lookup_cache->did_fail_to_refresh(key);
+        });
 }
 
 }
@@ -8,6 +8,7 @@
 
 #include "ConnectionFromClient.h"
 #include "DNSServer.h"
+#include "LookupCache.h"
 #include "MulticastDNS.h"
 #include <LibCore/EventReceiver.h>
 #include <LibCore/FileWatcher.h>
@@ -26,14 +27,27 @@ public:
     static LookupServer& the();
     ErrorOr<Vector<Answer>> lookup(Name const& name, RecordType record_type);
 
+    LookupCache const& cache() const { return *m_lookup_cache; }
+    u64 refresh_count() const { return m_refresh_count; }
+
 private:
     LookupServer();
 
+    // What the nameservers told us about a question.
+    struct UpstreamResponse {
+        Vector<Answer> answers;
+        // Set if the name doesn't exist or has no records of the type, to how long we may remember that (RFC 2308).
+        Optional<u32> negative_ttl;
+    };
+
     ErrorOr<HashMap<Name, Vector<Answer>, Name::Traits>> try_load_etc_hosts();
     void load_etc_hosts();
-    void put_in_cache(Answer const&);
+    void put_in_cache(CacheKey const&, UpstreamResponse const&);
+    void refresh_in_background(CacheKey const&);
 
-    ErrorOr<Vector<Answer>> lookup(Name const& hostname, ByteString const& nameserver, bool& did_get_response, RecordType record_type, ShouldRandomizeCase = ShouldRandomizeCase::Yes);
+    // These don't touch any of our state, so they can run on a background thread.
+    static UpstreamResponse lookup_upstream(Vector<ByteString> const& nameservers, Name const& name, RecordType record_type);
+    static ErrorOr<UpstreamResponse> lookup(Name const& hostname, ByteString const& nameserver, bool& did_get_response, RecordType record_type, ShouldRandomizeCase = ShouldRandomizeCase::Yes);
 
     OwnPtr<IPC::MultiServer<ConnectionFromClient>> m_server;
     RefPtr<DNSServer> m_dns_server;
@@ -41,7 +55,8 @@ private:
     Vector<ByteString> m_nameservers;
     RefPtr<Core::FileWatcher> m_file_watcher;
     HashMap<Name, Vector<Answer>, Name::Traits> m_etc_hosts;
-    HashMap<Name, Vector<Answer>, Name::Traits> m_lookup_cache;
+    OwnPtr<LookupCache> m_lookup_cache;
+    u64 m_refresh_count { 0 };
 };
 
 }
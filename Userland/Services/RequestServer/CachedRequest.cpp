@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/Timer.h>
+#include <RequestServer/CachedRequest.h>
+#include <RequestServer/HttpCache.h>
+
+namespace RequestServer {
+
+CachedRequest::CachedRequest(ConnectionFromClient& client, URL url, NonnullOwnPtr<CacheEntry> entry, NonnullOwnPtr<Core::File>&& output_stream)
+    : Request(client, move(output_stream))
+    , m_url(move(url))
+    , m_entry(move(entry))
+{
+    // The client only learns about this request once start_request() returns, so don't respond before that.
+    m_start_timer = MUST(Core::Timer::create_single_shot(0, [this] {
+        respond_from_cache(m_entry.release_nonnull());
+    }));
+    m_start_timer->start();
+}
+
+CachedRequest::~CachedRequest() = default;
+
+NonnullOwnPtr<CachedRequest> CachedRequest::create(ConnectionFromClient& client, URL url, NonnullOwnPtr<CacheEntry> entry, NonnullOwnPtr<Core::File>&& output_stream)
+{
+    return adopt_own(*new CachedRequest(client, move(url), move(entry), move(output_stream)));
+}
+
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <LibCore/Forward.h>
+#include <RequestServer/Request.h>
+
+namespace RequestServer {
+
+// A request that is answered from the HTTP cache without going to the network at all.
+class CachedRequest final : public Request {
+public:
+    virtual ~CachedRequest() override;
+    static NonnullOwnPtr<CachedRequest> create(ConnectionFromClient&, URL, NonnullOwnPtr<CacheEntry>, NonnullOwnPtr<Core::File>&&);
+
+    virtual URL url() const override { return m_url; }
+
+private:
+    CachedRequest(ConnectionFromClient&, URL, NonnullOwnPtr<CacheEntry>, NonnullOwnPtr<Core::File>&&);
+
+    URL m_url;
+    OwnPtr<CacheEntry> m_entry;
+    RefPtr<Core::Timer> m_start_timer;
+};
+
+}
@@ -13,7 +13,95 @@ namespace RequestServer::ConnectionCache {
 
 HashMap<ConnectionKey, NonnullOwnPtr<Vector<NonnullOwnPtr<Connection<Core::TCPSocket, Core::Socket>>>>> g_tcp_connection_cache {};
 HashMap<ConnectionKey, NonnullOwnPtr<Vector<NonnullOwnPtr<Connection<TLS::TLSv12>>>>> g_tls_connection_cache {};
+HashMap<ConnectionKey, Vector<NonnullRefPtr<HTTP::Http2Connection>>> g_http2_connection_cache {};
 HashMap<ByteString, InferredServerProperties> g_inferred_server_properties;
+HashMap<ConnectionKey, Vector<TLS::SessionTicket>> g_tls_session_tickets;
+TLSHandshakeStatistics g_tls_handshake_statistics;
+
+TLS::Options tls_options_for(ConnectionKey const& key)
+{
+    TLS::Options options;
+
+    // Tickets are only used once, so that the connections can't be linked by them, see RFC 8446, appendix C.4.
+    if (auto it = g_tls_session_tickets.find(key); it != g_tls_session_tickets.end()) {
+        auto& tickets = it->value;
+        tickets.remove_all_matching([](auto& ticket) { return ticket.is_expired(); });
+        if (!tickets.is_empty())
+            options.set_session_ticket(tickets.take_last());
+        if (tickets.is_empty())
+            g_tls_session_tickets.remove(it);
+    }
+
+    options.set_session_ticket_handler([key](TLS::SessionTicket ticket) {
+        auto& tickets = g_tls_session_tickets.ensure(key);
+        if (tickets.size() >= MaxSessionTicketsPerServer)
+            tickets.take_first();
+        tickets.append(move(ticket));
+    });
+    return options;
+}
+
+void did_establish_tls_connection(TLS::TLSv12 const& socket)
+{
+    auto duration = socket.handshake_duration();
+    if (!duration.has_value())
+        return;
+
+    if (socket.did_resume_session()) {
+        ++g_tls_handshake_statistics.resumed_handshakes;
+        g_tls_handshake_statistics.resumed_handshake_time += *duration;
+    } else {
+        ++g_tls_handshake_statistics.full_handshakes;
+        g_tls_handshake_statistics.full_handshake_time += *duration;
+    }
+    dbgln_if(REQUESTSERVER_DEBUG, "TLS handshake ({}) took {}ms", socket.did_resume_session() ? "resumed" : "full", duration->to_milliseconds());
+}
+
+NonnullRefPtr<HTTP::Http2Connection> create_http2_connection(ConnectionKey const& key, NonnullOwnPtr<TLS::TLSv12> socket)
+{
+    auto connection = HTTP::Http2Connection::construct(move(socket));
+    dbgln_if(REQUESTSERVER_DEBUG, "Negotiated HTTP/2 with {}:{}, new connection {}", key.hostname, key.port, connection.ptr());
+
+    connection->set_idle_timeout(ConnectionKeepAliveTimeMilliseconds);
+    connection->on_close = [key, connection = connection.ptr()] {
+        dbgln_if(REQUESTSERVER_DEBUG, "Removing closed HTTP/2 connection {}", connection);
+        auto it = g_http2_connection_cache.find(key);
+        if (it == g_http2_connection_cache.end())
+            return;
+        it->value.remove_first_matching([&](auto& entry) { return entry.ptr() == connection; });
+        if (it->value.is_empty())
+            g_http2_connection_cache.remove(it);
+    };
+    connection->find_connection_for_retry = [key]() -> RefPtr<HTTP::Http2Connection> {
+        return find_or_create_http2_connection(key);
+    };
+    g_http2_connection_cache.ensure(key).append(connection);
+    return connection;
+}
+
+RefPtr<HTTP::Http2Connection> find_or_create_http2_connection(ConnectionKey const& key)
+{
+    if (auto it = g_http2_connection_cache.find(key); it != g_http2_connection_cache.end()) {
+        if (auto connection = it->value.find_if([](auto& connection) { return connection->can_open_streams(); }); !connection.is_end())
+            return *connection;
+    }
+
+    // HTTP/2 is only offered on direct connections, see get_or_create_connection().
+    VERIFY(key.proxy_data.type == Core::ProxyData::Direct);
+    auto options = tls_options_for(key);
+    options.set_alpn_protocols({ "h2" });
+    auto socket = TLS::TLSv12::connect(key.hostname, key.port, move(options));
+    if (socket.is_error()) {
+        dbgln("ConnectionCache: HTTP/2 connection to {}:{} failed: {}", key.hostname, key.port, socket.error());
+        return nullptr;
+    }
+    did_establish_tls_connection(*socket.value());
+    if (socket.value()->alpn() != "h2"sv) {
+        dbgln("ConnectionCache: {}:{} doesn't speak HTTP/2 anymore", key.hostname, key.port);
+        return nullptr;
+    }
+    return create_http2_connection(key, socket.release_value());
+}
 
 void request_did_finish(URL const& url, Core::Socket const* socket)
 {
@@ -103,6 +191,20 @@ void dump_jobs()
                 dbgln("    - {}", &job);
         }
     }
+    auto average_milliseconds = [](Duration total, size_t count) { return count ? total.to_milliseconds() / static_cast<i64>(count) : 0; };
+    auto const& statistics = g_tls_handshake_statistics;
+    dbgln("  TLS handshakes: {} full (avg {}ms), {} resumed (avg {}ms), tickets held for {} servers",
+        statistics.full_handshakes, average_milliseconds(statistics.full_handshake_time, statistics.full_handshakes),
+        statistics.resumed_handshakes, average_milliseconds(statistics.resumed_handshake_time, statistics.resumed_handshakes),
+        g_tls_session_tickets.size());
+    dbgln("=========== HTTP/2 Connection Cache ==========");
+    for (auto& connections : g_http2_connection_cache) {
+        dbgln(" - {}:{}", connections.key.hostname, connections.key.port);
+        for (auto& connection : connections.value) {
+            dbgln("  - Connection {} (usable={})", connection.ptr(), connection->can_open_streams());
+            dbgln("    {} active streams, {} queued, {} opened in total", connection->active_stream_count(), connection->queued_stream_count(), connection->streams_opened());
+        }
+    }
     dbgln("=========== TCP Connection Cache ==========");
     for (auto& connection : g_tcp_connection_cache) {
         dbgln(" - {}:{}", connection.key.hostname, connection.key.port);
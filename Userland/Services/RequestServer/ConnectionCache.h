@@ -16,6 +16,7 @@
 #include <LibCore/NetworkJob.h>
 #include <LibCore/SOCKSProxyClient.h>
 #include <LibCore/Timer.h>
+#include <LibHTTP/Http2Connection.h>
 #include <LibTLS/TLSv12.h>
 
 namespace RequestServer {
@@ -125,15 +126,37 @@ struct InferredServerProperties {
     size_t requests_served_per_connection { NumericLimits<size_t>::max() };
 };
 
+struct TLSHandshakeStatistics {
+    size_t full_handshakes { 0 };
+    size_t resumed_handshakes { 0 };
+    Duration full_handshake_time;
+    Duration resumed_handshake_time;
+};
+
 extern HashMap<ConnectionKey, NonnullOwnPtr<Vector<NonnullOwnPtr<Connection<Core::TCPSocket, Core::Socket>>>>> g_tcp_connection_cache;
 extern HashMap<ConnectionKey, NonnullOwnPtr<Vector<NonnullOwnPtr<Connection<TLS::TLSv12>>>>> g_tls_connection_cache;
+// Connections that negotiated HTTP/2, which all requests to the server share. There is usually only one, but those
+// that the server is shutting down stay around until their last requests are done.
+extern HashMap<ConnectionKey, Vector<NonnullRefPtr<HTTP::Http2Connection>>> g_http2_connection_cache;
 extern HashMap<ByteString, InferredServerProperties> g_inferred_server_properties;
+extern HashMap<ConnectionKey, Vector<TLS::SessionTicket>> g_tls_session_tickets;
+extern TLSHandshakeStatistics g_tls_handshake_statistics;
 
 void request_did_finish(URL const&, Core::Socket const*);
 void dump_jobs();
 
+// Sets up resumption of TLS 1.3 sessions: new connections to a server use one of the tickets from earlier connections
+// to it, and the tickets they receive are kept for later ones.
+TLS::Options tls_options_for(ConnectionKey const&);
+void did_establish_tls_connection(TLS::TLSv12 const&);
+
+NonnullRefPtr<HTTP::Http2Connection> create_http2_connection(ConnectionKey const&, NonnullOwnPtr<TLS::TLSv12>);
+// For requests that a server going away didn't process, which can be retried on another connection to it.
+RefPtr<HTTP::Http2Connection> find_or_create_http2_connection(ConnectionKey const&);
+
 constexpr static size_t MaxConcurrentConnectionsPerURL = 4;
 constexpr static size_t ConnectionKeepAliveTimeMilliseconds = 10'000;
+constexpr static size_t MaxSessionTicketsPerServer = 4;
 
 template<typename T>
 ErrorOr<void> recreate_socket_if_needed(T& connection, URL const& url)
@@ -149,7 +172,7 @@ ErrorOr<void> recreate_socket_if_needed(T& connection, URL const& url)
         };
 
         if constexpr (IsSame<TLS::TLSv12, SocketType>) {
-            TLS::Options options;
+            auto options = tls_options_for({ url.serialized_host().release_value_but_fixme_should_propagate_errors().to_byte_string(), url.port_or_default(), connection.proxy.data });
             options.set_alert_handler([&connection](TLS::AlertDescription alert) {
                 Core::NetworkJob::Error reason;
                 if (alert == TLS::AlertDescription::HANDSHAKE_FAILURE)
@@ -167,7 +190,9 @@ ErrorOr<void> recreate_socket_if_needed(T& connection, URL const& url)
                     return connection.job_data.provide_client_certificates();
                 return {};
             });
-            TRY(set_socket(TRY((connection.proxy.template tunnel<SocketType, SocketStorageType>(url, move(options))))));
+            auto socket = TRY((connection.proxy.template tunnel<SocketType, SocketStorageType>(url, move(options))));
+            did_establish_tls_connection(*socket);
+            TRY(set_socket(move(socket)));
         } else {
             TRY(set_socket(TRY((connection.proxy.template tunnel<SocketType, SocketStorageType>(url)))));
         }
@@ -183,11 +208,28 @@ decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto job, C
     auto hostname = url.serialized_host().release_value_but_fixme_should_propagate_errors().to_byte_string();
     auto& properties = g_inferred_server_properties.ensure(hostname);
 
-    auto& sockets_for_url = *cache.ensure({ move(hostname), url.port_or_default(), proxy_data }, [] { return make<CacheEntryType>(); });
+    ConnectionKey key { move(hostname), url.port_or_default(), proxy_data };
+    auto& sockets_for_url = *cache.ensure(key, [] { return make<CacheEntryType>(); });
 
     Proxy proxy { proxy_data };
 
     using ReturnType = decltype(sockets_for_url[0].ptr());
+    using ConnectionType = RemoveCVReference<decltype(*cache.begin()->value->at(0))>;
+
+    // HTTP/2 needs ALPN to be negotiated, so it is only used over TLS. SOCKS proxies are left out, as their client
+    // would have to live as long as the connection.
+    constexpr bool can_use_http2 = IsSame<TLS::TLSv12, typename ConnectionType::SocketType> && requires { job->start(declval<HTTP::Http2Connection&>()); };
+    auto should_offer_http2 = can_use_http2 && proxy_data.type == Core::ProxyData::Direct;
+    if constexpr (can_use_http2) {
+        if (auto it = g_http2_connection_cache.find(key); it != g_http2_connection_cache.end()) {
+            if (auto connection = it->value.find_if([](auto& connection) { return connection->can_open_streams(); }); !connection.is_end()) {
+                dbgln_if(REQUESTSERVER_DEBUG, "Starting request for {} on HTTP/2 connection {}", url, connection->ptr());
+                job->start(**connection);
+                return ReturnType { nullptr };
+            }
+        }
+    }
+
     // Find the connection with an empty queue; if none exist, we'll find the least backed-up connection later.
     // Note that servers that are known to serve a single request per connection (e.g. HTTP/1.0) usually have
     // issues with concurrent connections, so we'll only allow one connection per URL in that case to avoid issues.
@@ -197,8 +239,15 @@ decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto job, C
     auto did_add_new_connection = false;
     auto failed_to_find_a_socket = it.is_end();
     if (failed_to_find_a_socket && sockets_for_url.size() < ConnectionCache::MaxConcurrentConnectionsPerURL) {
-        using ConnectionType = RemoveCVReference<decltype(*cache.begin()->value->at(0))>;
-        auto connection_result = proxy.tunnel<typename ConnectionType::SocketType, typename ConnectionType::StorageType>(url);
+        auto connection_result = [&] {
+            if constexpr (IsSame<TLS::TLSv12, typename ConnectionType::SocketType>) {
+                auto options = tls_options_for(key);
+                if (should_offer_http2)
+                    options.set_alpn_protocols({ "h2", "http/1.1" });
+                return proxy.tunnel<typename ConnectionType::SocketType, typename ConnectionType::StorageType>(url, move(options));
+            } else
+                return proxy.tunnel<typename ConnectionType::SocketType, typename ConnectionType::StorageType>(url);
+        }();
         if (connection_result.is_error()) {
             dbgln("ConnectionCache: Connection to {} failed: {}", url, connection_result.error());
             Core::deferred_invoke([job] {
@@ -206,6 +255,17 @@ decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto job, C
             });
             return ReturnType { nullptr };
         }
+        if constexpr (IsSame<TLS::TLSv12, typename ConnectionType::SocketType>)
+            did_establish_tls_connection(*connection_result.value());
+        if constexpr (can_use_http2) {
+            if (connection_result.value()->alpn() == "h2"sv) {
+                auto connection = create_http2_connection(key, connection_result.release_value());
+                job->start(*connection);
+                if (sockets_for_url.is_empty())
+                    cache.remove(key);
+                return ReturnType { nullptr };
+            }
+        }
         auto socket_result = Core::BufferedSocket<typename ConnectionType::StorageType>::create(connection_result.release_value());
         if (socket_result.is_error()) {
             dbgln("ConnectionCache: Failed to make a buffered socket for {}: {}", url, socket_result.error());
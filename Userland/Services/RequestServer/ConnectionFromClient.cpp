@@ -130,6 +130,11 @@ public:
         ConnectionCache::request_did_finish(m_url, &socket);
     }
 
+    void start(HTTP::Http2Connection&)
+    {
+        // Having the connection is all we wanted.
+    }
+
     void fail(Core::NetworkJob::Error error)
     {
         dbgln("Pre-connect to {} failed: {}", m_url, Core::to_string(error));
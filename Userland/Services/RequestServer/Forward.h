@@ -8,9 +8,13 @@
 
 namespace RequestServer {
 
+class CacheEntry;
+class CacheEntryWriter;
+class CachedRequest;
 class ConnectionFromClient;
 class Request;
 class GeminiProtocol;
+class HttpCache;
 class HttpRequest;
 class HttpProtocol;
 class HttpsRequest;
@@ -0,0 +1,584 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Endian.h>
+#include <AK/LexicalPath.h>
+#include <AK/MemoryStream.h>
+#include <AK/QuickSort.h>
+#include <LibCore/DateTime.h>
+#include <LibCore/DirIterator.h>
+#include <LibCore/Directory.h>
+#include <LibCore/File.h>
+#include <LibCore/MappedFile.h>
+#include <LibCore/System.h>
+#include <LibCrypto/Hash/SHA2.h>
+#include <RequestServer/HttpCache.h>
+
+namespace RequestServer {
+
+static constexpr u32 entry_magic = 0x48434531; // "HCE1"
+static constexpr StringView temporary_file_prefix = "tmp."sv;
+
+// Leftovers from processes that crashed while writing an entry.
+static constexpr i64 abandoned_temporary_file_age_in_seconds = 24 * 60 * 60;
+
+// Responses with these status codes can be stored even without explicit freshness information, RFC 9110, 15.1.
+static constexpr Array heuristically_cacheable_status_codes { 200u, 203u, 204u, 300u, 301u, 308u, 404u, 405u, 410u, 414u, 501u };
+
+// These describe the stored body and must not be changed by a 304 response, RFC 9111, 3.2.
+static constexpr Array headers_not_updated_by_revalidation { "Content-Length"sv, "Content-Encoding"sv, "Content-Range"sv, "Transfer-Encoding"sv, "Set-Cookie"sv };
+
+struct CacheControl {
+    bool no_store { false };
+    bool no_cache { false };
+    Optional<i64> max_age;
+};
+
+static CacheControl parse_cache_control(HeaderMap const& headers)
+{
+    CacheControl cache_control;
+
+    auto value = headers.get("Cache-Control"sv);
+    if (!value.has_value()) {
+        // Pragma only matters if there's no Cache-Control, RFC 9111, 5.4.
+        if (auto pragma = headers.get("Pragma"sv); pragma.has_value() && pragma->contains("no-cache"sv, CaseSensitivity::CaseInsensitive))
+            cache_control.no_cache = true;
+        return cache_control;
+    }
+
+    for (auto directive : value->split_view(',')) {
+        directive = directive.trim_whitespace();
+        auto name = directive;
+        Optional<StringView> argument;
+        if (auto equals = directive.find('='); equals.has_value()) {
+            name = directive.substring_view(0, *equals).trim_whitespace();
+            argument = directive.substring_view(*equals + 1).trim_whitespace().trim("\""sv);
+        }
+
+        if (name.equals_ignoring_ascii_case("no-store"sv))
+            cache_control.no_store = true;
+        else if (name.equals_ignoring_ascii_case("no-cache"sv))
+            cache_control.no_cache = true;
+        else if (name.equals_ignoring_ascii_case("max-age"sv) && argument.has_value())
+            cache_control.max_age = argument->to_number<i64>();
+    }
+    return cache_control;
+}
+
+static Optional<UnixDateTime> parse_http_date(Optional<ByteString const&> value)
+{
+    // HTTP dates are always in GMT (RFC 9110, 5.6.7). Spelling that as an offset means we don't need the time zone database to parse them.
+    if (!value.has_value() || !value->ends_with(" GMT"sv))
+        return {};
+    auto date_time = Core::DateTime::parse("%a, %d %b %Y %H:%M:%S %z"sv, ByteString::formatted("{} +0000", value->substring_view(0, value->length() - 4)));
+    if (!date_time.has_value())
+        return {};
+    return UnixDateTime::from_seconds_since_epoch(date_time->timestamp());
+}
+
+static Vector<StringView> varying_header_names(HeaderMap const& response_headers)
+{
+    Vector<StringView> names;
+    if (auto vary = response_headers.get("Vary"sv); vary.has_value()) {
+        for (auto name : vary->split_view(','))
+            names.append(name.trim_whitespace());
+    }
+    return names;
+}
+
+// RFC 9111, 4.2.1.
+static i64 freshness_lifetime(CacheEntry::Metadata const& metadata)
+{
+    auto const& headers = metadata.response_headers;
+    if (auto max_age = parse_cache_control(headers).max_age; max_age.has_value())
+        return *max_age;
+
+    auto date = parse_http_date(headers.get("Date"sv)).value_or(metadata.response_time);
+    if (headers.contains("Expires"sv)) {
+        // An invalid date means the response has already expired.
+        auto expires = parse_http_date(headers.get("Expires"sv));
+        if (!expires.has_value())
+            return 0;
+        return (*expires - date).to_seconds();
+    }
+
+    // Heuristic freshness, 10% of the time since the last modification like most browsers do, RFC 9111, 4.2.2.
+    if (auto last_modified = parse_http_date(headers.get("Last-Modified"sv)); last_modified.has_value()) {
+        static constexpr i64 maximum_heuristic_lifetime = 7 * 24 * 60 * 60;
+        return min((date - *last_modified).to_seconds() / 10, maximum_heuristic_lifetime);
+    }
+
+    return 0;
+}
+
+// RFC 9111, 4.2.3.
+static i64 current_age(CacheEntry::Metadata const& metadata, UnixDateTime now)
+{
+    auto const& headers = metadata.response_headers;
+    auto age_value = headers.get("Age"sv).map([](auto const& age) { return age.template to_number<i64>().value_or(0); }).value_or(0);
+    auto date_value = parse_http_date(headers.get("Date"sv)).value_or(metadata.response_time);
+
+    auto apparent_age = max<i64>(0, (metadata.response_time - date_value).to_seconds());
+    auto response_delay = (metadata.response_time - metadata.request_time).to_seconds();
+    auto corrected_age_value = age_value + response_delay;
+    auto corrected_initial_age = max(apparent_age, corrected_age_value);
+    auto resident_time = max<i64>(0, (now - metadata.response_time).to_seconds());
+    return corrected_initial_age + resident_time;
+}
+
+static bool is_storable_response(u32 status_code, HeaderMap const& request_headers, HeaderMap const& response_headers)
+{
+    if (!heuristically_cacheable_status_codes.contains_slow(status_code))
+        return false;
+    if (parse_cache_control(request_headers).no_store || parse_cache_control(response_headers).no_store)
+        return false;
+    if (varying_header_names(response_headers).contains_slow("*"sv))
+        return false;
+    return true;
+}
+
+static ErrorOr<void> write_string(Stream& stream, StringView string)
+{
+    TRY(stream.write_value<LittleEndian<u32>>(string.length()));
+    TRY(stream.write_until_depleted(string.bytes()));
+    return {};
+}
+
+static ErrorOr<ByteString> read_string(Stream& stream)
+{
+    auto length = TRY(stream.read_value<LittleEndian<u32>>());
+    auto buffer = TRY(ByteBuffer::create_uninitialized(length));
+    TRY(stream.read_until_filled(buffer));
+    return ByteString { buffer.bytes() };
+}
+
+// The metadata goes after the body, followed by the body size, the metadata size and a magic number.
+static ErrorOr<void> write_metadata(Stream& stream, CacheEntry::Metadata const& metadata, u64 body_size)
+{
+    AllocatingMemoryStream buffer;
+    TRY(write_string(buffer, metadata.url));
+    TRY(buffer.write_value<LittleEndian<u32>>(metadata.status_code));
+    TRY(buffer.write_value<LittleEndian<i64>>(metadata.request_time.truncated_seconds_since_epoch()));
+    TRY(buffer.write_value<LittleEndian<i64>>(metadata.response_time.truncated_seconds_since_epoch()));
+    TRY(buffer.write_value<LittleEndian<u32>>(metadata.response_headers.size()));
+    for (auto const& header : metadata.response_headers) {
+        TRY(write_string(buffer, header.key));
+        TRY(write_string(buffer, header.value));
+    }
+    TRY(buffer.write_value<LittleEndian<u32>>(metadata.varying_headers.size()));
+    for (auto const& header : metadata.varying_headers) {
+        TRY(write_string(buffer, header.name));
+        TRY(buffer.write_value<u8>(header.value.has_value()));
+        TRY(write_string(buffer, header.value.value_or({})));
+    }
+
+    auto metadata_size = buffer.used_buffer_size();
+    TRY(buffer.write_value<LittleEndian<u64>>(body_size));
+    TRY(buffer.write_value<LittleEndian<u32>>(metadata_size));
+    TRY(buffer.write_value<LittleEndian<u32>>(entry_magic));
+
+    auto bytes = TRY(buffer.read_until_eof());
+    TRY(stream.write_until_depleted(bytes));
+    return {};
+}
+
+static ErrorOr<CacheEntry::Metadata> read_metadata(ReadonlyBytes bytes)
+{
+    FixedMemoryStream stream { bytes };
+    CacheEntry::Metadata metadata;
+    metadata.url = TRY(read_string(stream));
+    metadata.status_code = TRY(stream.read_value<LittleEndian<u32>>());
+    metadata.request_time = UnixDateTime::from_seconds_since_epoch(TRY(stream.read_value<LittleEndian<i64>>()));
+    metadata.response_time = UnixDateTime::from_seconds_since_epoch(TRY(stream.read_value<LittleEndian<i64>>()));
+    auto header_count = TRY(stream.read_value<LittleEndian<u32>>());
+    for (u32 i = 0; i < header_count; ++i) {
+        auto name = TRY(read_string(stream));
+        auto value = TRY(read_string(stream));
+        metadata.response_headers.set(move(name), move(value));
+    }
+    auto varying_header_count = TRY(stream.read_value<LittleEndian<u32>>());
+    for (u32 i = 0; i < varying_header_count; ++i) {
+        auto name = TRY(read_string(stream));
+        auto has_value = TRY(stream.read_value<u8>());
+        auto value = TRY(read_string(stream));
+        metadata.varying_headers.append({ move(name), has_value ? move(value) : Optional<ByteString> {} });
+    }
+    return metadata;
+}
+
+ErrorOr<NonnullOwnPtr<CacheEntry>> CacheEntry::open(ByteString path)
+{
+    auto file = TRY(Core::MappedFile::map(path));
+    auto bytes = file->bytes();
+
+    static constexpr size_t trailer_size = sizeof(u64) + sizeof(u32) + sizeof(u32);
+    if (bytes.size() < trailer_size)
+        return Error::from_string_literal("Cache entry is truncated");
+    FixedMemoryStream trailer { bytes.slice(bytes.size() - trailer_size) };
+    auto body_size = TRY(trailer.read_value<LittleEndian<u64>>());
+    auto metadata_size = TRY(trailer.read_value<LittleEndian<u32>>());
+    auto magic = TRY(trailer.read_value<LittleEndian<u32>>());
+    if (magic != entry_magic || body_size + metadata_size + trailer_size != bytes.size())
+        return Error::from_string_literal("Cache entry is corrupt");
+
+    auto metadata = TRY(read_metadata(bytes.slice(body_size, metadata_size)));
+    auto body = bytes.trim(body_size);
+    return adopt_nonnull_own_or_enomem(new (nothrow) CacheEntry(move(path), move(file), body, move(metadata)));
+}
+
+CacheEntry::CacheEntry(ByteString path, NonnullOwnPtr<Core::MappedFile> file, ReadonlyBytes body, Metadata metadata)
+    : m_path(move(path))
+    , m_file(move(file))
+    , m_body(body)
+    , m_metadata(move(metadata))
+{
+}
+
+CacheEntry::~CacheEntry() = default;
+
+bool CacheEntry::matches_varying_headers(HeaderMap const& request_headers) const
+{
+    for (auto const& header : m_metadata.varying_headers) {
+        if (request_headers.get(header.name) != header.value)
+            return false;
+    }
+    return true;
+}
+
+bool CacheEntry::is_fresh_for(HeaderMap const& request_headers, UnixDateTime now) const
+{
+    auto request_cache_control = parse_cache_control(request_headers);
+    if (request_cache_control.no_cache || parse_cache_control(m_metadata.response_headers).no_cache)
+        return false;
+
+    auto age = current_age(m_metadata, now);
+    if (request_cache_control.max_age.has_value() && age > *request_cache_control.max_age)
+        return false;
+    return freshness_lifetime(m_metadata) > age;
+}
+
+bool CacheEntry::can_be_revalidated() const
+{
+    return m_metadata.response_headers.contains("ETag"sv) || m_metadata.response_headers.contains("Last-Modified"sv);
+}
+
+void CacheEntry::add_revalidation_headers(HashMap<ByteString, ByteString>& request_headers) const
+{
+    if (auto etag = m_metadata.response_headers.get("ETag"sv); etag.has_value())
+        request_headers.set("If-None-Match", *etag);
+    if (auto last_modified = m_metadata.response_headers.get("Last-Modified"sv); last_modified.has_value())
+        request_headers.set("If-Modified-Since", *last_modified);
+}
+
+HeaderMap CacheEntry::response_headers_for_client(UnixDateTime now) const
+{
+    auto headers = m_metadata.response_headers;
+    headers.set("Age", ByteString::number(max<i64>(0, current_age(m_metadata, now))));
+    return headers;
+}
+
+OwnPtr<CacheEntryWriter> CacheEntryWriter::create(HttpCache& cache, URL const& url, HeaderMap request_headers, Stream& client_stream)
+{
+    auto temporary_path = cache.create_temporary_file_path();
+    if (temporary_path.is_error()) {
+        dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: Failed to create a temporary file: {}", temporary_path.error());
+        return nullptr;
+    }
+    auto file = Core::File::open(temporary_path.value(), Core::File::OpenMode::Write | Core::File::OpenMode::Truncate);
+    if (file.is_error()) {
+        dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: Failed to open {}: {}", temporary_path.value(), file.error());
+        (void)Core::System::unlink(temporary_path.value());
+        return nullptr;
+    }
+    return adopt_own_if_nonnull(new (nothrow) CacheEntryWriter(cache, url, move(request_headers), client_stream, temporary_path.release_value(), file.release_value()));
+}
+
+CacheEntryWriter::CacheEntryWriter(HttpCache& cache, URL const& url, HeaderMap request_headers, Stream& client_stream, ByteString temporary_path, NonnullOwnPtr<Core::File> file)
+    : m_cache(cache)
+    , m_url(url.serialize(URL::ExcludeFragment::Yes))
+    , m_request_headers(move(request_headers))
+    , m_request_time(UnixDateTime::now())
+    , m_client_stream(client_stream)
+    , m_temporary_path(move(temporary_path))
+    , m_file(move(file))
+{
+}
+
+CacheEntryWriter::~CacheEntryWriter()
+{
+    abandon();
+}
+
+ErrorOr<size_t> CacheEntryWriter::write_some(ReadonlyBytes bytes)
+{
+    auto written = TRY(m_client_stream.write_some(bytes));
+    if (m_file) {
+        if (m_body_size + written > HttpCache::maximum_entry_size) {
+            dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: Response for {} is too large to be cached", m_url);
+            abandon();
+        } else if (auto result = m_file->write_until_depleted(bytes.trim(written)); result.is_error()) {
+            dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: Failed to write to {}: {}", m_temporary_path, result.error());
+            abandon();
+        } else {
+            m_body_size += written;
+        }
+    }
+    return written;
+}
+
+void CacheEntryWriter::did_receive_headers(Optional<u32> status_code, HeaderMap const& response_headers)
+{
+    if (m_file && (!status_code.has_value() || !is_storable_response(*status_code, m_request_headers, response_headers)))
+        abandon();
+}
+
+void CacheEntryWriter::did_finish(bool success, Optional<u32> status_code, HeaderMap const& response_headers)
+{
+    if (!m_file)
+        return;
+    if (!success || !status_code.has_value() || !is_storable_response(*status_code, m_request_headers, response_headers))
+        return abandon();
+
+    CacheEntry::Metadata metadata;
+    metadata.url = m_url;
+    metadata.status_code = *status_code;
+    metadata.request_time = m_request_time;
+    metadata.response_time = UnixDateTime::now();
+    metadata.response_headers = response_headers;
+    // Cookies are handled when the response is first received, replaying them later would resurrect stale ones.
+    metadata.response_headers.remove("Set-Cookie"sv);
+    // The body has been decoded by the time it gets here.
+    metadata.response_headers.remove("Content-Encoding"sv);
+    metadata.response_headers.remove("Transfer-Encoding"sv);
+    metadata.response_headers.set("Content-Length", ByteString::number(m_body_size));
+    for (auto name : varying_header_names(response_headers)) {
+        Optional<ByteString> value;
+        if (auto request_value = m_request_headers.get(name); request_value.has_value())
+            value = *request_value;
+        metadata.varying_headers.append({ name, move(value) });
+    }
+
+    if (auto result = write_metadata(*m_file, metadata, m_body_size); result.is_error()) {
+        dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: Failed to write metadata to {}: {}", m_temporary_path, result.error());
+        return abandon();
+    }
+    m_file = nullptr;
+
+    if (auto result = m_cache.store(m_temporary_path, m_url, m_body_size); result.is_error()) {
+        dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: Failed to store {}: {}", m_url, result.error());
+        (void)Core::System::unlink(m_temporary_path);
+    }
+    m_temporary_path = {};
+}
+
+void CacheEntryWriter::abandon()
+{
+    if (!m_file)
+        return;
+    m_file = nullptr;
+    (void)Core::System::unlink(m_temporary_path);
+    m_temporary_path = {};
+}
+
+static OwnPtr<HttpCache> s_the;
+
+ErrorOr<void> HttpCache::initialize(ByteString directory)
+{
+    TRY(Core::Directory::create(directory, Core::Directory::CreateDirectories::Yes, 0700));
+    s_the = TRY(adopt_nonnull_own_or_enomem(new (nothrow) HttpCache(move(directory))));
+    s_the->evict_entries_if_needed();
+    return {};
+}
+
+HttpCache* HttpCache::the()
+{
+    return s_the.ptr();
+}
+
+HttpCache::HttpCache(ByteString directory)
+    : m_directory(move(directory))
+    // Make the first call to evict_entries_if_needed() find out how much is already stored.
+    , m_estimated_size(maximum_size + 1)
+{
+}
+
+bool HttpCache::is_cacheable_request(StringView method, HeaderMap const& request_headers)
+{
+    if (!method.equals_ignoring_ascii_case("GET"sv))
+        return false;
+
+    // Conditional and range requests are the client's business, just pass them on.
+    static constexpr Array client_managed_headers { "If-None-Match"sv, "If-Modified-Since"sv, "If-Match"sv, "If-Unmodified-Since"sv, "If-Range"sv, "Range"sv };
+    for (auto header : client_managed_headers) {
+        if (request_headers.contains(header))
+            return false;
+    }
+
+    return !parse_cache_control(request_headers).no_store;
+}
+
+ByteString HttpCache::path_for(StringView url) const
+{
+    auto digest = Crypto::Hash::SHA256::hash(url);
+    return LexicalPath::join(m_directory, ByteString::formatted("{:hex-dump}", digest.bytes())).string();
+}
+
+ErrorOr<ByteString> HttpCache::create_temporary_file_path() const
+{
+    auto pattern = ByteString::formatted("{}/{}XXXXXX", m_directory, temporary_file_prefix);
+    auto buffer = TRY(ByteBuffer::copy(pattern.bytes()));
+    TRY(buffer.try_append('\0'));
+    auto fd = TRY(Core::System::mkstemp(Span<char> { reinterpret_cast<char*>(buffer.data()), buffer.size() }));
+    TRY(Core::System::close(fd));
+    return ByteString { reinterpret_cast<char const*>(buffer.data()) };
+}
+
+OwnPtr<CacheEntry> HttpCache::open_entry(URL const& url, HeaderMap const& request_headers)
+{
+    auto serialized_url = url.serialize(URL::ExcludeFragment::Yes);
+    auto path = path_for(serialized_url);
+
+    auto entry = CacheEntry::open(path);
+    if (entry.is_error()) {
+        if (!entry.error().is_errno() || entry.error().code() != ENOENT) {
+            dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: Removing unreadable entry {}: {}", path, entry.error());
+            (void)Core::System::unlink(path);
+        }
+        return nullptr;
+    }
+
+    if (entry.value()->metadata().url != serialized_url || !entry.value()->matches_varying_headers(request_headers))
+        return nullptr;
+    return entry.release_value();
+}
+
+void HttpCache::remove_entry(URL const& url)
+{
+    (void)Core::System::unlink(path_for(url.serialize(URL::ExcludeFragment::Yes)));
+}
+
+OwnPtr<CacheEntry> HttpCache::update_entry_after_revalidation(CacheEntry const& entry, HeaderMap const& not_modified_headers, UnixDateTime request_time)
+{
+    auto metadata = entry.metadata();
+    metadata.request_time = request_time;
+    metadata.response_time = UnixDateTime::now();
+    for (auto const& header : not_modified_headers) {
+        if (!any_of(headers_not_updated_by_revalidation, [&](auto name) { return name.equals_ignoring_ascii_case(header.key); }))
+            metadata.response_headers.set(header.key, header.value);
+    }
+
+    auto update = [&]() -> ErrorOr<void> {
+        auto temporary_path = TRY(create_temporary_file_path());
+        auto result = [&]() -> ErrorOr<void> {
+            auto file = TRY(Core::File::open(temporary_path, Core::File::OpenMode::Write | Core::File::OpenMode::Truncate));
+            TRY(file->write_until_depleted(entry.body()));
+            TRY(write_metadata(*file, metadata, entry.body().size()));
+            TRY(Core::System::rename(temporary_path, entry.path()));
+            return {};
+        }();
+        if (result.is_error())
+            (void)Core::System::unlink(temporary_path);
+        return result;
+    };
+    if (auto result = update(); result.is_error()) {
+        dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: Failed to update {}: {}", metadata.url, result.error());
+        return nullptr;
+    }
+
+    auto updated_entry = CacheEntry::open(entry.path());
+    if (updated_entry.is_error())
+        return nullptr;
+    return updated_entry.release_value();
+}
+
+void HttpCache::did_use_entry(CacheEntry const& entry, bool was_revalidated)
+{
+    if (was_revalidated)
+        ++m_statistics.revalidated_hits;
+    else
+        ++m_statistics.hits;
+    m_statistics.bytes_served += entry.body().size();
+
+    // Bump the modification time, which eviction treats as the last use.
+    (void)Core::System::utime(entry.path(), {});
+}
+
+ErrorOr<void> HttpCache::store(ByteString const& temporary_path, ByteString const& url, u64 body_size)
+{
+    TRY(Core::System::rename(temporary_path, path_for(url)));
+    dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: Stored {} ({} bytes)", url, body_size);
+
+    ++m_statistics.stored_entries;
+    m_estimated_size += body_size;
+    evict_entries_if_needed();
+    return {};
+}
+
+// Other processes add to the cache as well, so this only keeps an estimate of the size, and looks at what's actually
+// on disk once the estimate goes over the limit.
+void HttpCache::evict_entries_if_needed()
+{
+    if (m_estimated_size <= maximum_size)
+        return;
+
+    struct StoredEntry {
+        ByteString path;
+        u64 size { 0 };
+        i64 last_used { 0 };
+    };
+    Vector<StoredEntry> entries;
+    u64 total_size = 0;
+    auto now = UnixDateTime::now().seconds_since_epoch();
+
+    Core::DirIterator iterator { m_directory, Core::DirIterator::SkipParentAndBaseDir };
+    while (iterator.has_next()) {
+        auto name = iterator.next_path();
+        auto path = LexicalPath::join(m_directory, name).string();
+        auto stat = Core::System::stat(path);
+        if (stat.is_error())
+            continue;
+
+        if (name.starts_with(temporary_file_prefix)) {
+            if (now - stat.value().st_mtime > abandoned_temporary_file_age_in_seconds)
+                (void)Core::System::unlink(path);
+            continue;
+        }
+
+        entries.append({ move(path), static_cast<u64>(stat.value().st_size), stat.value().st_mtime });
+        total_size += stat.value().st_size;
+    }
+
+    // Leave some room, so that this doesn't have to run again right away.
+    auto target_size = maximum_size / 10 * 9;
+    if (total_size > target_size) {
+        quick_sort(entries, [](auto const& a, auto const& b) { return a.last_used < b.last_used; });
+        for (auto const& entry : entries) {
+            if (total_size <= target_size)
+                break;
+            if (Core::System::unlink(entry.path).is_error())
+                continue;
+            dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: Evicted {} ({} bytes)", entry.path, entry.size);
+            total_size -= entry.size;
+            ++m_statistics.evicted_entries;
+        }
+    }
+
+    m_estimated_size = total_size;
+}
+
+void HttpCache::dump_statistics() const
+{
+    dbgln("=========== HTTP Cache ==========");
+    dbgln(" Directory: {}", m_directory);
+    dbgln(" Hits: {} ({} after revalidation)", m_statistics.hits + m_statistics.revalidated_hits, m_statistics.revalidated_hits);
+    dbgln(" Misses: {}", m_statistics.misses);
+    dbgln(" Stored entries: {}", m_statistics.stored_entries);
+    dbgln(" Evicted entries: {}", m_statistics.evicted_entries);
+    dbgln(" Bytes served from cache: {}", m_statistics.bytes_served);
+}
+
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteString.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Stream.h>
+#include <AK/Time.h>
+#include <AK/URL.h>
+#include <AK/Vector.h>
+#include <LibCore/Forward.h>
+#include <RequestServer/Forward.h>
+
+namespace RequestServer {
+
+using HeaderMap = HashMap<ByteString, ByteString, CaseInsensitiveStringTraits>;
+
+// A stored response, with its body mapped into memory.
+class CacheEntry {
+    AK_MAKE_NONCOPYABLE(CacheEntry);
+    AK_MAKE_NONMOVABLE(CacheEntry);
+
+public:
+    struct VaryingHeader {
+        ByteString name;
+        Optional<ByteString> value;
+    };
+
+    struct Metadata {
+        ByteString url;
+        u32 status_code { 0 };
+        UnixDateTime request_time;
+        UnixDateTime response_time;
+        HeaderMap response_headers;
+        // The request headers named by the response's `Vary` header, as they were in the request.
+        Vector<VaryingHeader> varying_headers;
+    };
+
+    static ErrorOr<NonnullOwnPtr<CacheEntry>> open(ByteString path);
+    ~CacheEntry();
+
+    ByteString const& path() const { return m_path; }
+    Metadata const& metadata() const { return m_metadata; }
+    ReadonlyBytes body() const { return m_body; }
+
+    bool matches_varying_headers(HeaderMap const& request_headers) const;
+    bool is_fresh_for(HeaderMap const& request_headers, UnixDateTime now) const;
+    bool can_be_revalidated() const;
+    void add_revalidation_headers(HashMap<ByteString, ByteString>& request_headers) const;
+
+    // The stored headers, plus an `Age` header as required for responses served from a cache.
+    HeaderMap response_headers_for_client(UnixDateTime now) const;
+
+private:
+    CacheEntry(ByteString path, NonnullOwnPtr<Core::MappedFile>, ReadonlyBytes body, Metadata);
+
+    ByteString m_path;
+    NonnullOwnPtr<Core::MappedFile> m_file;
+    ReadonlyBytes m_body;
+    Metadata m_metadata;
+};
+
+// Passes the response body on to the client, and keeps a copy of it in a temporary file. Once the response is complete,
+// it is moved into the cache if it may be stored at all.
+class CacheEntryWriter final : public Stream {
+public:
+    static OwnPtr<CacheEntryWriter> create(HttpCache&, URL const&, HeaderMap request_headers, Stream& client_stream);
+    virtual ~CacheEntryWriter() override;
+
+    virtual ErrorOr<Bytes> read_some(Bytes) override { return Error::from_errno(EBADF); }
+    virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
+    virtual bool is_eof() const override { return m_client_stream.is_eof(); }
+    virtual bool is_open() const override { return m_client_stream.is_open(); }
+    virtual void close() override { m_client_stream.close(); }
+
+    // Stops copying the body as soon as it is clear that the response can't be stored.
+    void did_receive_headers(Optional<u32> status_code, HeaderMap const& response_headers);
+    void did_finish(bool success, Optional<u32> status_code, HeaderMap const& response_headers);
+
+private:
+    CacheEntryWriter(HttpCache&, URL const&, HeaderMap request_headers, Stream& client_stream, ByteString temporary_path, NonnullOwnPtr<Core::File>);
+
+    void abandon();
+
+    HttpCache& m_cache;
+    ByteString m_url;
+    HeaderMap m_request_headers;
+    UnixDateTime m_request_time;
+    Stream& m_client_stream;
+
+    ByteString m_temporary_path;
+    OwnPtr<Core::File> m_file;
+    u64 m_body_size { 0 };
+};
+
+// A disk cache for HTTP responses, shared by all RequestServer processes of a user. It follows the rules for a
+// private cache in RFC 9111.
+//
+// Each response is stored in a file named after the SHA-256 hash of its URL, containing the body followed by the
+// metadata. Entries are written to a temporary file and renamed into place, so no process ever sees a partial entry,
+// and entries that are in use stay intact even if another process replaces or evicts them.
+// The modification time of an entry is the last time it was used, which is what eviction goes by.
+class HttpCache {
+public:
+    static constexpr u64 maximum_size = 256 * MiB;
+    static constexpr u64 maximum_entry_size = maximum_size / 8;
+
+    struct Statistics {
+        u64 hits { 0 };
+        u64 revalidated_hits { 0 };
+        u64 misses { 0 };
+        u64 stored_entries { 0 };
+        u64 evicted_entries { 0 };
+        u64 bytes_served { 0 };
+    };
+
+    // Without a successful call to this, the() returns nullptr and nothing is cached.
+    static ErrorOr<void> initialize(ByteString directory);
+    static HttpCache* the();
+
+    static bool is_cacheable_request(StringView method, HeaderMap const& request_headers);
+
+    // Returns an entry for the URL whose `Vary` header matches the request, if there is one.
+    OwnPtr<CacheEntry> open_entry(URL const&, HeaderMap const& request_headers);
+    void remove_entry(URL const&);
+
+    // Replaces the stored headers with the ones from a 304 response, see RFC 9111, 4.3.4, and returns the updated entry.
+    OwnPtr<CacheEntry> update_entry_after_revalidation(CacheEntry const&, HeaderMap const& not_modified_headers, UnixDateTime request_time);
+    void did_use_entry(CacheEntry const&, bool was_revalidated);
+    void did_miss() { ++m_statistics.misses; }
+
+    Statistics const& statistics() const { return m_statistics; }
+    void dump_statistics() const;
+
+private:
+    friend class CacheEntryWriter;
+
+    explicit HttpCache(ByteString directory);
+
+    ByteString path_for(StringView url) const;
+    ErrorOr<ByteString> create_temporary_file_path() const;
+    ErrorOr<void> store(ByteString const& temporary_path, ByteString const& url, u64 body_size);
+    void evict_entries_if_needed();
+
+    ByteString m_directory;
+    u64 m_estimated_size { 0 };
+    Statistics m_statistics;
+};
+
+}
@@ -8,14 +8,17 @@
 
 #include <AK/ByteBuffer.h>
 #include <AK/ByteString.h>
+#include <AK/GenericShorthands.h>
 #include <AK/HashMap.h>
 #include <AK/NonnullOwnPtr.h>
 #include <AK/Optional.h>
 #include <AK/OwnPtr.h>
 #include <AK/Types.h>
 #include <LibHTTP/HttpRequest.h>
+#include <RequestServer/CachedRequest.h>
 #include <RequestServer/ConnectionCache.h>
 #include <RequestServer/ConnectionFromClient.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/Request.h>
 
 namespace RequestServer::Detail {
@@ -24,16 +27,26 @@ template<typename TSelf, typename TJob>
 void init(TSelf* self, TJob job)
 {
     job->on_headers_received = [self](auto& headers, auto response_code) {
+        // A 304 is only meant for us, the client gets the stored response once the request is done.
+        if (self->is_response_to_revalidation(response_code))
+            return;
         if (response_code.has_value())
             self->set_status_code(response_code.value());
         self->set_response_headers(headers);
     };
 
     job->on_finish = [self](bool success) {
-        Core::deferred_invoke([url = self->job().url(), socket = self->job().socket()] {
-            ConnectionCache::request_did_finish(url, socket);
-        });
+        // Requests on an HTTP/2 connection don't hold up the ones after them.
+        if (!self->job().uses_http2()) {
+            Core::deferred_invoke([url = self->job().url(), socket = self->job().socket()] {
+                ConnectionCache::request_did_finish(url, socket);
+            });
+        }
         if (auto* response = self->job().response()) {
+            if (self->is_response_to_revalidation(response->code())) {
+                self->did_revalidate_cache_entry(response->headers());
+                return;
+            }
             self->set_status_code(response->code());
             self->set_response_headers(response->headers());
             self->set_downloaded_size(response->downloaded_size());
@@ -90,17 +103,51 @@ OwnPtr<Request> start_request(TBadgedProtocol&& protocol, ConnectionFromClient&
     else
         request.set_method(HTTP::HttpRequest::Method::GET);
     request.set_url(url);
-    request.set_headers(headers);
+
+    auto output_stream = MUST(Core::File::adopt_fd(pipe_result.value().write_fd, Core::File::OpenMode::Write));
+
+    auto request_headers = headers;
+    OwnPtr<CacheEntry> entry_being_revalidated;
+    OwnPtr<CacheEntryWriter> cache_entry_writer;
+    if (auto* cache = HttpCache::the()) {
+        HeaderMap cache_request_headers;
+        for (auto const& header : headers)
+            cache_request_headers.set(header.key, header.value);
+
+        if (HttpCache::is_cacheable_request(method, cache_request_headers)) {
+            if (auto entry = cache->open_entry(url, cache_request_headers)) {
+                if (entry->is_fresh_for(cache_request_headers, UnixDateTime::now())) {
+                    auto cached_request = CachedRequest::create(client, url, entry.release_nonnull(), move(output_stream));
+                    cached_request->set_request_fd(pipe_result.value().read_fd);
+                    return cached_request;
+                }
+                if (entry->can_be_revalidated()) {
+                    entry->add_revalidation_headers(request_headers);
+                    entry_being_revalidated = move(entry);
+                }
+            }
+            if (!entry_being_revalidated)
+                cache->did_miss();
+            cache_entry_writer = CacheEntryWriter::create(*cache, url, move(cache_request_headers), *output_stream);
+        } else if (!first_is_one_of(request.method(), HTTP::HttpRequest::Method::GET, HTTP::HttpRequest::Method::HEAD, HTTP::HttpRequest::Method::OPTIONS, HTTP::HttpRequest::Method::TRACE)) {
+            // Unsafe methods invalidate what's stored for the URL, RFC 9111, 4.4.
+            cache->remove_entry(url);
+        }
+    }
+    request.set_headers(request_headers);
 
     auto allocated_body_result = ByteBuffer::copy(body);
     if (allocated_body_result.is_error())
         return {};
     request.set_body(allocated_body_result.release_value());
 
-    auto output_stream = MUST(Core::File::adopt_fd(pipe_result.value().write_fd, Core::File::OpenMode::Write));
-    auto job = TJob::construct(move(request), *output_stream);
+    // The writer passes everything on to the output stream, and keeps a copy for the cache.
+    Stream& job_stream = cache_entry_writer ? static_cast<Stream&>(*cache_entry_writer) : static_cast<Stream&>(*output_stream);
+    auto job = TJob::construct(move(request), job_stream);
     auto protocol_request = TRequest::create_with_job(forward<TBadgedProtocol>(protocol), client, (TJob&)*job, move(output_stream));
     protocol_request->set_request_fd(pipe_result.value().read_fd);
+    protocol_request->set_cache_entry_writer(move(cache_entry_writer));
+    protocol_request->set_cache_entry_being_revalidated(move(entry_being_revalidated));
 
     if constexpr (IsSame<typename TBadgedProtocol::Type, HttpsProtocol>)
         ConnectionCache::get_or_create_connection(ConnectionCache::g_tls_connection_cache, url, job, proxy_data);
@@ -4,7 +4,10 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibCore/File.h>
+#include <LibCore/Notifier.h>
 #include <RequestServer/ConnectionFromClient.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/Request.h>
 
 namespace RequestServer {
@@ -19,6 +22,8 @@ Request::Request(ConnectionFromClient& client, NonnullOwnPtr<Core::File>&& outpu
 {
 }
 
+Request::~Request() = default;
+
 void Request::stop()
 {
     m_client.did_finish_request({}, *this, false);
@@ -27,6 +32,8 @@ void Request::stop()
 void Request::set_response_headers(HashMap<ByteString, ByteString, CaseInsensitiveStringTraits> const& response_headers)
 {
     m_response_headers = response_headers;
+    if (m_cache_entry_writer)
+        m_cache_entry_writer->did_receive_headers(m_status_code, m_response_headers);
     m_client.did_receive_headers({}, *this);
 }
 
@@ -36,6 +43,13 @@ void Request::set_certificate(ByteString, ByteString)
 
 void Request::did_finish(bool success)
 {
+    if (m_cache_entry_writer)
+        m_cache_entry_writer->did_finish(success, m_status_code, m_response_headers);
+    // The server sent a full response instead of a 304.
+    if (m_cache_entry_being_revalidated) {
+        if (auto* cache = HttpCache::the())
+            cache->did_miss();
+    }
     m_client.did_finish_request({}, *this, success);
 }
 
@@ -51,4 +65,77 @@ void Request::did_request_certificates()
     m_client.did_request_certificates({}, *this);
 }
 
+void Request::set_cache_entry_writer(OwnPtr<CacheEntryWriter> writer)
+{
+    m_cache_entry_writer = move(writer);
+}
+
+void Request::set_cache_entry_being_revalidated(OwnPtr<CacheEntry> entry)
+{
+    m_cache_entry_being_revalidated = move(entry);
+    m_revalidation_request_time = UnixDateTime::now();
+}
+
+bool Request::is_response_to_revalidation(Optional<u32> status_code) const
+{
+    return m_cache_entry_being_revalidated && status_code == 304u;
+}
+
+void Request::did_revalidate_cache_entry(HashMap<ByteString, ByteString, CaseInsensitiveStringTraits> const& not_modified_headers)
+{
+    VERIFY(m_cache_entry_being_revalidated);
+    auto* cache = HttpCache::the();
+    VERIFY(cache);
+
+    auto entry = m_cache_entry_being_revalidated.release_nonnull();
+    if (auto updated_entry = cache->update_entry_after_revalidation(*entry, not_modified_headers, m_revalidation_request_time))
+        entry = updated_entry.release_nonnull();
+    respond_from_cache(move(entry), true);
+}
+
+void Request::respond_from_cache(NonnullOwnPtr<CacheEntry> entry, bool was_revalidated)
+{
+    // Nothing new is coming in, so there's nothing to store either.
+    m_cache_entry_writer = nullptr;
+
+    if (auto* cache = HttpCache::the())
+        cache->did_use_entry(*entry, was_revalidated);
+
+    set_status_code(entry->metadata().status_code);
+    set_response_headers(entry->response_headers_for_client(UnixDateTime::now()));
+    m_cache_entry_being_served = move(entry);
+    m_cached_body_offset = 0;
+    send_cached_body();
+}
+
+void Request::send_cached_body()
+{
+    auto body = m_cache_entry_being_served->body();
+    while (m_cached_body_offset < body.size()) {
+        auto result = m_output_stream->write_some(body.slice(m_cached_body_offset));
+        if (result.is_error()) {
+            if (result.error().is_errno() && result.error().code() == EINTR)
+                continue;
+            if (result.error().is_errno() && result.error().code() == EAGAIN) {
+                // The client isn't keeping up, continue once there is room in the pipe again.
+                if (!m_cached_body_notifier) {
+                    m_cached_body_notifier = Core::Notifier::construct(m_output_stream->fd(), Core::Notifier::Type::Write);
+                    m_cached_body_notifier->on_activation = [this] { send_cached_body(); };
+                }
+                return;
+            }
+            dbgln("Request: Failed to send cached response for {}: {}", url(), result.error());
+            m_cached_body_notifier = nullptr;
+            did_finish(false);
+            return;
+        }
+        m_cached_body_offset += result.value();
+    }
+
+    m_cached_body_notifier = nullptr;
+    set_downloaded_size(body.size());
+    did_progress(body.size(), body.size());
+    did_finish(true);
+}
+
 }
@@ -10,14 +10,17 @@
 #include <AK/NonnullOwnPtr.h>
 #include <AK/Optional.h>
 #include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <AK/Time.h>
 #include <AK/URL.h>
+#include <LibCore/Forward.h>
 #include <RequestServer/Forward.h>
 
 namespace RequestServer {
 
 class Request {
 public:
-    virtual ~Request() = default;
+    virtual ~Request();
 
     i32 id() const { return m_id; }
     virtual URL url() const = 0;
@@ -42,10 +45,23 @@ public:
     void set_downloaded_size(size_t size) { m_downloaded_size = size; }
     Core::File const& output_stream() const { return *m_output_stream; }
 
+    // Keeps a copy of the response body as it is passed on, to be stored in the HTTP cache once the request finishes.
+    void set_cache_entry_writer(OwnPtr<CacheEntryWriter>);
+
+    // The request was made conditional on this entry, a 304 response means it can be used after all.
+    void set_cache_entry_being_revalidated(OwnPtr<CacheEntry>);
+    bool is_response_to_revalidation(Optional<u32> status_code) const;
+    void did_revalidate_cache_entry(HashMap<ByteString, ByteString, CaseInsensitiveStringTraits> const& not_modified_headers);
+
+    // Sends the stored response to the client and finishes the request, which usually destroys it.
+    void respond_from_cache(NonnullOwnPtr<CacheEntry>, bool was_revalidated = false);
+
 protected:
     explicit Request(ConnectionFromClient&, NonnullOwnPtr<Core::File>&&);
 
 private:
+    void send_cached_body();
+
     ConnectionFromClient& m_client;
     i32 m_id { 0 };
     int m_request_fd { -1 }; // Passed to client.
@@ -54,6 +70,13 @@ private:
     size_t m_downloaded_size { 0 };
     NonnullOwnPtr<Core::File> m_output_stream;
     HashMap<ByteString, ByteString, CaseInsensitiveStringTraits> m_response_headers;
+
+    OwnPtr<CacheEntryWriter> m_cache_entry_writer;
+    OwnPtr<CacheEntry> m_cache_entry_being_revalidated;
+    UnixDateTime m_revalidation_request_time;
+    OwnPtr<CacheEntry> m_cache_entry_being_served;
+    size_t m_cached_body_offset { 0 };
+    RefPtr<Core::Notifier> m_cached_body_notifier;
 };
 
 }
@@ -4,34 +4,42 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/LexicalPath.h>
 #include <AK/OwnPtr.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/LocalServer.h>
+#include <LibCore/StandardPaths.h>
 #include <LibCore/System.h>
 #include <LibIPC/SingleServer.h>
 #include <LibMain/Main.h>
 #include <LibTLS/Certificate.h>
 #include <RequestServer/ConnectionFromClient.h>
 #include <RequestServer/GeminiProtocol.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/HttpProtocol.h>
 #include <RequestServer/HttpsProtocol.h>
 #include <signal.h>
 
 ErrorOr<int> serenity_main(Main::Arguments)
 {
-    if constexpr (TLS_SSL_KEYLOG_DEBUG)
-        TRY(Core::System::pledge("stdio inet accept unix cpath wpath rpath sendfd recvfd sigaction"));
-    else
-        TRY(Core::System::pledge("stdio inet accept unix rpath sendfd recvfd sigaction"));
+    // The HTTP cache is written to and evicted from, hence cpath, wpath and fattr.
+    TRY(Core::System::pledge("stdio inet accept unix cpath wpath rpath fattr sendfd recvfd sigaction"));
 
 #ifdef SIGINFO
-    signal(SIGINFO, [](int) { RequestServer::ConnectionCache::dump_jobs(); });
+    signal(SIGINFO, [](int) {
+        RequestServer::ConnectionCache::dump_jobs();
+        if (auto* cache = RequestServer::HttpCache::the())
+            cache->dump_statistics();
+    });
 #endif
 
-    if constexpr (TLS_SSL_KEYLOG_DEBUG)
-        TRY(Core::System::pledge("stdio inet accept unix cpath wpath rpath sendfd recvfd"));
-    else
-        TRY(Core::System::pledge("stdio inet accept unix rpath sendfd recvfd"));
+    TRY(Core::System::pledge("stdio inet accept unix cpath wpath rpath fattr sendfd recvfd"));
+
+    // Not being able to cache anything is no reason not to work at all.
+    auto cache_directory = LexicalPath::join(Core::StandardPaths::cache_directory(), "RequestServer"sv).string();
+    auto cache_result = RequestServer::HttpCache::initialize(cache_directory);
+    if (cache_result.is_error())
+        dbgln("RequestServer: Failed to initialize the HTTP cache: {}", cache_result.error());
 
     // Ensure the certificates are read out here.
     // FIXME: Allow specifying extra certificates on the command line, or in other configuration.
@@ -43,6 +51,8 @@ ErrorOr<int> serenity_main(Main::Arguments)
     TRY(Core::System::unveil("/etc/timezone", "r"));
     if constexpr (TLS_SSL_KEYLOG_DEBUG)
         TRY(Core::System::unveil("/home/anon", "rwc"));
+    if (!cache_result.is_error())
+        TRY(Core::System::unveil(cache_directory, "rwc"sv));
     TRY(Core::System::unveil(nullptr, nullptr));
 
     [[maybe_unused]] auto gemini = make<RequestServer::GeminiProtocol>();
@@ -15,6 +15,14 @@ namespace SQLServer {
 static HashMap<SQL::StatementID, NonnullRefPtr<SQLStatement>> s_statements;
 static SQL::StatementID s_next_statement_id = 0;
 
+// The maximum number of rows sent to the client in a single message.
+static constexpr size_t result_batch_size = 64;
+
+static bool modifies_database(SQL::AST::Statement const& statement)
+{
+    return !is<SQL::AST::Select>(statement) && !is<SQL::AST::Explain>(statement) && !is<SQL::AST::DescribeTable>(statement);
+}
+
 RefPtr<SQLStatement> SQLStatement::statement_for(SQL::StatementID statement_id)
 {
     if (s_statements.contains(statement_id))
@@ -70,6 +78,33 @@ Optional<SQL::ExecutionID> SQLStatement::execute(Vector<SQL::Value> placeholder_
     auto execution_id = m_next_execution_id++;
 
     Core::deferred_invoke([this, strong_this = NonnullRefPtr(*this), placeholder_values = move(placeholder_values), execution_id] {
+        // Cursors of ongoing SELECT statements must not see the database change underneath them.
+        if (modifies_database(*m_statement))
+            buffer_ongoing_executions(connection().database());
+
+        if (is<SQL::AST::Select>(*m_statement)) {
+            auto cursor = SQL::AST::Cursor::create(connection().database(), static_ptr_cast<SQL::AST::Select const>(m_statement), placeholder_values);
+            if (cursor.is_error()) {
+                report_error(cursor.release_error(), execution_id);
+                return;
+            }
+
+            auto client_connection = ConnectionFromClient::client_connection_for(connection().client_id());
+            if (!client_connection) {
+                warnln("Cannot return statement execution results. Client disconnected");
+                return;
+            }
+
+            client_connection->async_execution_success(statement_id(), execution_id, cursor.value()->column_names(), true, 0, 0, 0);
+
+            Execution execution;
+            execution.cursor = cursor.release_value();
+
+            m_ongoing_executions.set(execution_id, move(execution));
+            ready_for_next_result(execution_id);
+            return;
+        }
+
         auto execution_result = m_statement->execute(connection().database(), placeholder_values);
 
         if (execution_result.is_error()) {
@@ -89,7 +124,12 @@ Optional<SQL::ExecutionID> SQLStatement::execute(Vector<SQL::Value> placeholder_
         if (should_send_result_rows(result)) {
             client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), true, 0, 0, 0);
 
-            m_ongoing_executions.set(execution_id, { move(result), result_size });
+            Execution execution;
+            execution.buffered_rows.ensure_capacity(result_size);
+            for (auto& result_row : result)
+                execution.buffered_rows.unchecked_append(result_row.row.take_data());
+
+            m_ongoing_executions.set(execution_id, move(execution));
             ready_for_next_result(execution_id);
         } else {
             if (result.command() == SQL::SQLCommand::Insert)
@@ -119,14 +159,87 @@ void SQLStatement::ready_for_next_result(SQL::ExecutionID execution_id)
         return;
     }
 
-    if (execution->result.is_empty()) {
+    Vector<Vector<SQL::Value>> rows;
+
+    while (rows.size() < result_batch_size) {
+        if (execution->next_buffered_row < execution->buffered_rows.size()) {
+            rows.append(move(execution->buffered_rows[execution->next_buffered_row++]));
+            continue;
+        }
+
+        if (!execution->cursor)
+            break;
+
+        auto row = execution->cursor->next();
+        if (row.is_error()) {
+            m_ongoing_executions.remove(execution_id);
+            report_error(row.release_error(), execution_id);
+            return;
+        }
+
+        if (!row.value().has_value()) {
+            execution->cursor = nullptr;
+            break;
+        }
+
+        rows.append(row.value()->take_data());
+    }
+
+    if (rows.is_empty()) {
         client_connection->async_results_exhausted(statement_id(), execution_id, execution->result_size);
         m_ongoing_executions.remove(execution_id);
         return;
     }
 
-    auto result_row = execution->result.take_first();
-    client_connection->async_next_result(statement_id(), execution_id, result_row.row.take_data());
+    execution->result_size += rows.size();
+    client_connection->async_next_results(statement_id(), execution_id, move(rows));
+}
+
+void SQLStatement::buffer_ongoing_executions(SQL::Database const& database)
+{
+    Vector<NonnullRefPtr<SQLStatement>> statements;
+    for (auto const& it : s_statements) {
+        if (it.value->connection().database().ptr() == &database)
+            statements.append(it.value);
+    }
+
+    for (auto& statement : statements)
+        statement->buffer_remaining_results();
+}
+
+void SQLStatement::buffer_remaining_results()
+{
+    struct FailedExecution {
+        SQL::ExecutionID execution_id;
+        SQL::Result error;
+    };
+    Vector<FailedExecution> failed_executions;
+
+    for (auto& it : m_ongoing_executions) {
+        auto& execution = it.value;
+        if (!execution.cursor)
+            continue;
+
+        while (true) {
+            auto row = execution.cursor->next();
+            if (row.is_error()) {
+                failed_executions.append({ it.key, row.release_error() });
+                break;
+            }
+            if (!row.value().has_value())
+                break;
+
+            execution.buffered_rows.append(row.value()->take_data());
+        }
+
+        execution.cursor = nullptr;
+    }
+
+    // Reporting an error forgets about the statement, so this has to happen after iterating over the executions.
+    for (auto& failed_execution : failed_executions) {
+        m_ongoing_executions.remove(failed_execution.execution_id);
+        report_error(move(failed_execution.error), failed_execution.execution_id);
+    }
 }
 
 bool SQLStatement::should_send_result_rows(SQL::ResultSet const& result) const
@@ -136,6 +249,7 @@ bool SQLStatement::should_send_result_rows(SQL::ResultSet const& result) const
 
     switch (result.command()) {
     case SQL::SQLCommand::Describe:
+    case SQL::SQLCommand::Explain:
     case SQL::SQLCommand::Select:
         return true;
     default:
@@ -7,9 +7,11 @@
 #pragma once
 
 #include <AK/NonnullRefPtr.h>
+#include <AK/OwnPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/Vector.h>
 #include <LibSQL/AST/AST.h>
+#include <LibSQL/AST/Operator.h>
 #include <LibSQL/Result.h>
 #include <LibSQL/ResultSet.h>
 #include <LibSQL/Type.h>
@@ -34,11 +36,18 @@ private:
     bool should_send_result_rows(SQL::ResultSet const& result) const;
     void report_error(SQL::Result, SQL::ExecutionID execution_id);
 
+    static void buffer_ongoing_executions(SQL::Database const&);
+    void buffer_remaining_results();
+
     DatabaseConnection& m_connection;
     SQL::StatementID m_statement_id { 0 };
 
+    // The rows of a SELECT statement are read from its cursor as the client asks for them. Rows of
+    // other statements, and rows read ahead before the database is modified, are buffered instead.
     struct Execution {
-        SQL::ResultSet result;
+        OwnPtr<SQL::AST::Cursor> cursor;
+        Vector<Vector<SQL::Value>> buffered_rows;
+        size_t next_buffered_row { 0 };
         size_t result_size { 0 };
     };
     HashMap<SQL::ExecutionID, Execution> m_ongoing_executions;
@@ -6,10 +6,11 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/AllOf.h>
 #include <AK/Base64.h>
+#include <AK/CharacterTypes.h>
 #include <AK/Debug.h>
 #include <AK/LexicalPath.h>
-#include <AK/MemoryStream.h>
 #include <AK/NumberFormat.h>
 #include <AK/QuickSort.h>
 #include <AK/StringBuilder.h>
@@ -25,78 +26,297 @@
 #include <LibHTTP/HttpResponse.h>
 #include <WebServer/Client.h>
 #include <WebServer/Configuration.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <stdio.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
 namespace WebServer {
 
-Client::Client(NonnullOwnPtr<Core::BufferedTCPSocket> socket, Core::EventReceiver* parent)
+// Pipelined requests follow each other directly, so we need to know where one ends before parsing it. These limits
+// keep a client from making us buffer arbitrary amounts of data, we only serve GET requests anyway.
+static constexpr size_t maximum_header_size = 64 * KiB;
+static constexpr size_t maximum_body_size = 64 * KiB;
+// While a response is being sent, we stop reading further requests once this much is waiting.
+static constexpr size_t maximum_buffered_input_size = 256 * KiB;
+static constexpr size_t file_chunk_size = 64 * KiB;
+
+struct RequestFraming {
+    size_t size { 0 };
+    // We can't tell where the body of a malformed request ends, so `size` only covers its headers then.
+    bool is_malformed { false };
+};
+
+// https://www.rfc-editor.org/rfc/rfc9112#section-6.3
+static ErrorOr<Optional<RequestFraming>, HTTP::HttpRequest::ParseError> framing_of_first_request(ReadonlyBytes data)
+{
+    auto header_end = StringView { data }.find("\r\n\r\n"sv);
+    if (!header_end.has_value()) {
+        if (data.size() > maximum_header_size)
+            return HTTP::HttpRequest::ParseError::RequestTooLarge;
+        return OptionalNone {};
+    }
+
+    auto headers_size = *header_end + 4;
+    RequestFraming const malformed { .size = headers_size, .is_malformed = true };
+
+    Optional<size_t> content_length;
+    for (auto line : StringView { data.slice(0, *header_end) }.split_view("\r\n"sv)) {
+        auto colon = line.find(':');
+        if (!colon.has_value())
+            continue;
+        auto name = line.substring_view(0, *colon);
+
+        // We don't implement any transfer codings, and guessing where a chunked body ends would let the next
+        // request be smuggled in.
+        if (name.equals_ignoring_ascii_case("Transfer-Encoding"sv))
+            return malformed;
+        if (!name.equals_ignoring_ascii_case("Content-Length"sv))
+            continue;
+
+        auto value = line.substring_view(*colon + 1).trim_whitespace();
+        if (value.is_empty() || !all_of(value, is_ascii_digit))
+            return malformed;
+        auto length = value.to_number<size_t>();
+        if (!length.has_value() || (content_length.has_value() && *content_length != *length))
+            return malformed;
+        if (*length > maximum_body_size)
+            return HTTP::HttpRequest::ParseError::RequestTooLarge;
+        content_length = length;
+    }
+
+    auto size = headers_size + content_length.value_or(0);
+    if (data.size() < size)
+        return OptionalNone {};
+    return RequestFraming { .size = size };
+}
+
+// https://www.rfc-editor.org/rfc/rfc9112#section-9.3
+static bool wants_persistent_connection(ReadonlyBytes raw_request, HTTP::HttpRequest const& request)
+{
+    auto request_line = StringView { raw_request }.find("\r\n"sv).map([&](auto end) { return StringView { raw_request.slice(0, end) }; });
+    bool is_http_1_0 = request_line.has_value() && request_line->ends_with("HTTP/1.0"sv);
+
+    Optional<StringView> connection;
+    if (auto it = request.headers().find_if([](auto& header) { return header.name.equals_ignoring_ascii_case("Connection"sv); }); !it.is_end())
+        connection = it->value.view().trim_whitespace();
+
+    if (is_http_1_0)
+        return connection.has_value() && connection->equals_ignoring_ascii_case("keep-alive"sv);
+    return !connection.has_value() || !connection->equals_ignoring_ascii_case("close"sv);
+}
+
+Client::Client(NonnullOwnPtr<Core::TCPSocket> socket, Core::EventReceiver* parent)
     : Core::EventReceiver(parent)
     , m_socket(move(socket))
 {
+    m_idle_timer = MUST(Core::Timer::create_single_shot(Configuration::the().keep_alive_timeout_milliseconds(), [this] {
+        dbgln_if(WEBSERVER_DEBUG, "Closing idle connection");
+        die();
+    },
+        this));
 }
 
 void Client::die()
 {
+    if (!m_socket->is_open())
+        return;
+
     m_socket->close();
+    m_idle_timer->stop();
+    if (m_write_notifier)
+        m_write_notifier->set_enabled(false);
     deferred_invoke([this] { remove_from_parent(); });
 }
 
+void Client::handle_error(WrappedError const& error)
+{
+    error.visit(
+        [](AK::Error const& error) {
+            warnln("Internal error: {}", error);
+        },
+        [](HTTP::HttpRequest::ParseError const& error) {
+            warnln("HTTP request parsing error: {}", HTTP::HttpRequest::parse_error_to_string(error));
+        });
+
+    die();
+}
+
 void Client::start()
 {
-    m_socket->on_ready_to_read = [this] {
-        if (auto result = on_ready_to_read(); result.is_error()) {
-            result.error().visit(
-                [](AK::Error const& error) {
-                    warnln("Internal error: {}", error);
-                },
-                [](HTTP::HttpRequest::ParseError const& error) {
-                    warnln("HTTP request parsing error: {}", HTTP::HttpRequest::parse_error_to_string(error));
-                });
+    // We already put as much of a response into each write as we can, Nagle's algorithm would only hold back the last
+    // segment of every response until the client acknowledges the previous one.
+    int option = 1;
+    if (auto result = Core::System::setsockopt(m_socket->fd().value(), IPPROTO_TCP, TCP_NODELAY, &option, sizeof(option)); result.is_error())
+        dbgln("Failed to disable Nagle's algorithm: {}", result.error());
 
-            die();
-        }
+    m_socket->on_ready_to_read = [this] {
+        if (auto result = on_ready_to_read(); result.is_error())
+            handle_error(result.error());
     };
+    m_idle_timer->start();
 }
 
 ErrorOr<void, Client::WrappedError> Client::on_ready_to_read()
 {
-    // FIXME: Mostly copied from LibWeb/WebDriver/Client.cpp. As noted there, this should be move the LibHTTP and made spec compliant.
-    auto buffer = TRY(ByteBuffer::create_uninitialized(m_socket->buffer_size()));
-
-    for (;;) {
-        if (!TRY(m_socket->can_read_without_blocking()))
+    u8 buffer[16 * KiB];
+    while (!m_is_sending_response || m_input.size() < maximum_buffered_input_size) {
+        auto result = m_socket->read_some({ buffer, sizeof(buffer) });
+        if (result.is_error()) {
+            if (result.error().is_errno() && result.error().code() == EINTR)
+                continue;
+            if (result.error().is_errno() && result.error().code() == EAGAIN)
+                break;
+            return result.release_error();
+        }
+        if (result.value().is_empty()) {
+            m_peer_has_closed = m_socket->is_eof();
             break;
+        }
+        if (!m_is_shutting_down)
+            TRY(m_input.try_append(result.value()));
+    }
 
-        auto data = TRY(m_socket->read_some(buffer));
-        TRY(m_remaining_request.try_append(StringView { data }));
+    return handle_buffered_requests();
+}
 
-        if (m_socket->is_eof())
+ErrorOr<void, Client::WrappedError> Client::handle_buffered_requests()
+{
+    while (!m_is_sending_response && !m_is_shutting_down && m_socket->is_open()) {
+        auto framing = TRY(framing_of_first_request(m_input));
+        if (!framing.has_value())
             break;
+
+        auto raw_request = m_input.bytes().slice(0, framing->size);
+        dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", StringView { raw_request });
+
+        ++m_requests_served;
+        m_idle_timer->stop();
+
+        // Nothing after a malformed request can be trusted to be a request of its own, so this is the last response.
+        // Its headers may not even make sense to HttpRequest, the request line is all we need to answer it.
+        if (framing->is_malformed) {
+            auto request_line = StringView { raw_request }.substring_view(0, *StringView { raw_request }.find("\r\n"sv));
+            auto request = TRY(HTTP::HttpRequest::from_raw_request(ByteString::formatted("{}\r\n\r\n", request_line).bytes()));
+            m_should_close_after_response = true;
+            m_input.clear();
+            TRY(send_error_response(400, request));
+        } else {
+            auto request = TRY(HTTP::HttpRequest::from_raw_request(raw_request));
+            m_should_close_after_response = !wants_persistent_connection(raw_request, request) || m_requests_served >= Configuration::the().max_requests_per_connection();
+            m_input = TRY(m_input.slice(framing->size, m_input.size() - framing->size));
+            TRY(handle_request(request));
+        }
+        if (TRY(write_pending_output()))
+            did_finish_response();
     }
 
-    if (m_remaining_request.is_empty())
+    if (!m_socket->is_open())
         return {};
 
-    auto request = TRY(m_remaining_request.to_byte_buffer());
-    dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", ByteString::copy(request));
+    // Whatever the client sent after it closed its side still gets its response.
+    // The socket stays readable at EOF, so we stop listening for it until we're done with the response.
+    if (m_peer_has_closed) {
+        m_socket->set_notifications_enabled(false);
+        if (!m_is_sending_response)
+            die();
+        return {};
+    }
+
+    // Requests that are held up by a slow response stay in the socket's buffer, until the client can't send anymore.
+    m_socket->set_notifications_enabled(!m_is_sending_response || m_input.size() < maximum_buffered_input_size);
+    return {};
+}
 
-    auto maybe_parsed_request = HTTP::HttpRequest::from_raw_request(TRY(m_remaining_request.to_byte_buffer()));
-    if (maybe_parsed_request.is_error()) {
-        if (maybe_parsed_request.error() == HTTP::HttpRequest::ParseError::RequestIncomplete) {
-            // If request is not complete we need to wait for more data to arrive
-            return {};
+ErrorOr<bool> Client::write_pending_output()
+{
+    while (true) {
+        if (m_output_offset == m_output.size()) {
+            m_output.clear();
+            m_output_offset = 0;
+            if (!m_body_file || m_body_bytes_remaining == 0)
+                break;
+
+            TRY(m_output.try_resize(min(m_body_bytes_remaining, file_chunk_size)));
+            auto chunk = TRY(m_body_file->read_some(m_output.bytes()));
+            if (chunk.is_empty())
+                return Error::from_string_literal("File is shorter than when the response started");
+            m_output.resize(chunk.size());
+            m_body_bytes_remaining -= chunk.size();
+        }
+
+        auto result = m_socket->write_some(m_output.bytes().slice(m_output_offset));
+        if (result.is_error()) {
+            if (result.error().is_errno() && result.error().code() == EINTR)
+                continue;
+            if (result.error().is_errno() && result.error().code() == EAGAIN) {
+                // The client isn't keeping up, continue once there is room in the socket again.
+                if (!m_write_notifier) {
+                    m_write_notifier = Core::Notifier::construct(m_socket->fd().value(), Core::Notifier::Type::Write, this);
+                    m_write_notifier->on_activation = [this] {
+                        auto result = write_pending_output();
+                        if (result.is_error())
+                            return handle_error(result.release_error());
+                        if (!result.value())
+                            return;
+                        did_finish_response();
+                        if (auto result = handle_buffered_requests(); result.is_error())
+                            handle_error(result.error());
+                    };
+                }
+                m_write_notifier->set_enabled(true);
+                return false;
+            }
+            return result.release_error();
         }
-        return maybe_parsed_request.error();
+        m_output_offset += result.value();
     }
 
-    m_remaining_request.clear();
+    if (m_write_notifier)
+        m_write_notifier->set_enabled(false);
+    return true;
+}
 
-    TRY(handle_request(maybe_parsed_request.value()));
+void Client::did_finish_response()
+{
+    m_is_sending_response = false;
+    m_body_file = nullptr;
+
+    if (m_should_close_after_response)
+        return shut_down();
+    m_idle_timer->start();
+}
 
+// https://www.rfc-editor.org/rfc/rfc9112#section-9.6
+// Closing the socket while requests from the client are still unread would reset the connection, and could take the
+// responses that were already sent with it. So we only stop sending, and discard anything else until the client closes
+// its side as well.
+void Client::shut_down()
+{
+    if (auto result = Core::System::shutdown(m_socket->fd().value(), SHUT_WR); result.is_error())
+        return die();
+
+    m_is_shutting_down = true;
+    m_input.clear();
+    m_idle_timer->start();
+}
+
+ErrorOr<void> Client::queue_response(StringBuilder const& builder)
+{
+    VERIFY(!m_is_sending_response);
+    TRY(m_output.try_append(builder.string_view().bytes()));
+    m_is_sending_response = true;
     return {};
 }
 
+ErrorOr<void> Client::append_connection_header(StringBuilder& builder)
+{
+    if (m_should_close_after_response)
+        return builder.try_append("Connection: close\r\n"sv);
+    return builder.try_appendff("Connection: keep-alive\r\nKeep-Alive: timeout={}\r\n", Configuration::the().keep_alive_timeout_milliseconds() / 1000);
+}
+
 ErrorOr<bool> Client::handle_request(HTTP::HttpRequest const& request)
 {
     auto resource_decoded = URL::percent_decode(request.resource());
@@ -166,20 +386,35 @@ ErrorOr<bool> Client::handle_request(HTTP::HttpRequest const& request)
         return false;
     }
 
-    auto stream = TRY(Core::File::open(real_path.bytes_as_string_view(), Core::File::OpenMode::Read));
+    auto file = TRY(Core::File::open(real_path.bytes_as_string_view(), Core::File::OpenMode::Read));
 
     auto const info = ContentInfo {
         .type = TRY(String::from_utf8(Core::guess_mime_type_based_on_filename(real_path.bytes_as_string_view()))),
         .length = TRY(FileSystem::size(real_path.bytes_as_string_view()))
     };
-    TRY(send_response(*stream, request, move(info)));
+    TRY(send_response(move(file), request, move(info)));
     return true;
 }
 
-ErrorOr<void> Client::send_response(Stream& response, HTTP::HttpRequest const& request, ContentInfo content_info)
+ErrorOr<void> Client::send_response(NonnullOwnPtr<Core::File> body, HTTP::HttpRequest const& request, ContentInfo content_info)
+{
+    TRY(send_response_headers(request, content_info));
+    m_body_file = move(body);
+    m_body_bytes_remaining = content_info.length;
+    return {};
+}
+
+ErrorOr<void> Client::send_response(ReadonlyBytes body, HTTP::HttpRequest const& request, ContentInfo content_info)
+{
+    TRY(send_response_headers(request, content_info));
+    TRY(m_output.try_append(body));
+    return {};
+}
+
+ErrorOr<void> Client::send_response_headers(HTTP::HttpRequest const& request, ContentInfo const& content_info)
 {
     StringBuilder builder;
-    TRY(builder.try_append("HTTP/1.0 200 OK\r\n"sv));
+    TRY(builder.try_append("HTTP/1.1 200 OK\r\n"sv));
     TRY(builder.try_append("Server: WebServer (SerenityOS)\r\n"sv));
     TRY(builder.try_append("X-Frame-Options: SAMEORIGIN\r\n"sv));
     TRY(builder.try_append("X-Content-Type-Options: nosniff\r\n"sv));
@@ -189,53 +424,26 @@ ErrorOr<void> Client::send_response(Stream& response, HTTP::HttpRequest const& r
     else
         TRY(builder.try_appendff("Content-Type: {}\r\n", content_info.type));
     TRY(builder.try_appendff("Content-Length: {}\r\n", content_info.length));
+    TRY(append_connection_header(builder));
     TRY(builder.try_append("\r\n"sv));
 
-    auto builder_contents = TRY(builder.to_byte_buffer());
-    TRY(m_socket->write_until_depleted(builder_contents));
+    TRY(queue_response(builder));
     log_response(200, request);
-
-    char buffer[PAGE_SIZE];
-    do {
-        auto size = TRY(response.read_some({ buffer, sizeof(buffer) })).size();
-        if (response.is_eof() && size == 0)
-            break;
-
-        ReadonlyBytes write_buffer { buffer, size };
-        while (!write_buffer.is_empty()) {
-            auto nwritten = TRY(m_socket->write_some(write_buffer));
-
-            if (nwritten == 0) {
-                dbgln("EEEEEE got 0 bytes written!");
-            }
-
-            write_buffer = write_buffer.slice(nwritten);
-        }
-    } while (true);
-
-    auto keep_alive = false;
-    if (auto it = request.headers().find_if([](auto& header) { return header.name.equals_ignoring_ascii_case("Connection"sv); }); !it.is_end()) {
-        if (it->value.trim_whitespace().equals_ignoring_ascii_case("keep-alive"sv))
-            keep_alive = true;
-    }
-    if (!keep_alive)
-        m_socket->close();
-
     return {};
 }
 
 ErrorOr<void> Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& request)
 {
     StringBuilder builder;
-    TRY(builder.try_append("HTTP/1.0 301 Moved Permanently\r\n"sv));
+    TRY(builder.try_append("HTTP/1.1 301 Moved Permanently\r\n"sv));
     TRY(builder.try_append("Location: "sv));
     TRY(builder.try_append(redirect_path));
     TRY(builder.try_append("\r\n"sv));
+    TRY(builder.try_append("Content-Length: 0\r\n"sv));
+    TRY(append_connection_header(builder));
     TRY(builder.try_append("\r\n"sv));
 
-    auto builder_contents = TRY(builder.to_byte_buffer());
-    TRY(m_socket->write_until_depleted(builder_contents));
-
+    TRY(queue_response(builder));
     log_response(301, request);
     return {};
 }
@@ -338,8 +546,7 @@ ErrorOr<void> Client::handle_directory_listing(String const& requested_path, Str
     TRY(builder.try_append("</html>\n"sv));
 
     auto response = builder.to_byte_string();
-    FixedMemoryStream stream { response.bytes() };
-    return send_response(stream, request, { .type = "text/html"_string, .length = response.length() });
+    return send_response(response.bytes(), request, { .type = "text/html"_string, .length = response.length() });
 }
 
 ErrorOr<void> Client::send_error_response(unsigned code, HTTP::HttpRequest const& request, Vector<String> const& headers)
@@ -353,7 +560,7 @@ ErrorOr<void> Client::send_error_response(unsigned code, HTTP::HttpRequest const
     TRY(content_builder.try_append("</h1></body></html>"sv));
 
     StringBuilder header_builder;
-    TRY(header_builder.try_appendff("HTTP/1.0 {} ", code));
+    TRY(header_builder.try_appendff("HTTP/1.1 {} ", code));
     TRY(header_builder.try_append(reason_phrase));
     TRY(header_builder.try_append("\r\n"sv));
 
@@ -363,9 +570,11 @@ ErrorOr<void> Client::send_error_response(unsigned code, HTTP::HttpRequest const
     }
     TRY(header_builder.try_append("Content-Type: text/html; charset=UTF-8\r\n"sv));
     TRY(header_builder.try_appendff("Content-Length: {}\r\n", content_builder.length()));
+    TRY(append_connection_header(header_builder));
     TRY(header_builder.try_append("\r\n"sv));
-    TRY(m_socket->write_until_depleted(TRY(header_builder.to_byte_buffer())));
-    TRY(m_socket->write_until_depleted(TRY(content_builder.to_byte_buffer())));
+    TRY(header_builder.try_append(content_builder.string_view()));
+
+    TRY(queue_response(header_builder));
 
     log_response(code, request);
     return {};
@@ -9,12 +9,17 @@
 
 #include <AK/String.h>
 #include <LibCore/EventReceiver.h>
+#include <LibCore/File.h>
+#include <LibCore/Notifier.h>
 #include <LibCore/Socket.h>
+#include <LibCore/Timer.h>
 #include <LibHTTP/Forward.h>
 #include <LibHTTP/HttpRequest.h>
 
 namespace WebServer {
 
+// One connection, which may carry any number of requests. Pipelined requests are answered one after the other, and
+// responses are written without blocking, so a slow client only holds up itself.
 class Client final : public Core::EventReceiver {
     C_OBJECT(Client);
 
@@ -22,7 +27,7 @@ public:
     void start();
 
 private:
-    Client(NonnullOwnPtr<Core::BufferedTCPSocket>, Core::EventReceiver* parent);
+    Client(NonnullOwnPtr<Core::TCPSocket>, Core::EventReceiver* parent);
 
     using WrappedError = Variant<AK::Error, HTTP::HttpRequest::ParseError>;
 
@@ -32,17 +37,43 @@ private:
     };
 
     ErrorOr<void, WrappedError> on_ready_to_read();
+    ErrorOr<void, WrappedError> handle_buffered_requests();
     ErrorOr<bool> handle_request(HTTP::HttpRequest const&);
-    ErrorOr<void> send_response(Stream&, HTTP::HttpRequest const&, ContentInfo);
+    ErrorOr<void> send_response(NonnullOwnPtr<Core::File>, HTTP::HttpRequest const&, ContentInfo);
+    ErrorOr<void> send_response(ReadonlyBytes, HTTP::HttpRequest const&, ContentInfo);
+    ErrorOr<void> send_response_headers(HTTP::HttpRequest const&, ContentInfo const&);
     ErrorOr<void> send_redirect(StringView redirect, HTTP::HttpRequest const&);
     ErrorOr<void> send_error_response(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers = {});
+    ErrorOr<void> append_connection_header(StringBuilder&);
+    ErrorOr<void> queue_response(StringBuilder const&);
+    // Returns whether the whole response was sent, otherwise the rest follows once the socket is writable again.
+    ErrorOr<bool> write_pending_output();
+    void did_finish_response();
+    void handle_error(WrappedError const&);
+    void shut_down();
     void die();
     void log_response(unsigned code, HTTP::HttpRequest const&);
     ErrorOr<void> handle_directory_listing(String const& requested_path, String const& real_path, HTTP::HttpRequest const&);
     bool verify_credentials(Vector<HTTP::HttpRequest::Header> const&);
 
-    NonnullOwnPtr<Core::BufferedTCPSocket> m_socket;
-    StringBuilder m_remaining_request;
+    NonnullOwnPtr<Core::TCPSocket> m_socket;
+    RefPtr<Core::Notifier> m_write_notifier;
+    RefPtr<Core::Timer> m_idle_timer;
+
+    // Received data that doesn't belong to a request that was handled yet.
+    ByteBuffer m_input;
+    bool m_peer_has_closed { false };
+
+    // The response being sent. Files are read in chunks, each only once the previous one was sent.
+    bool m_is_sending_response { false };
+    ByteBuffer m_output;
+    size_t m_output_offset { 0 };
+    OwnPtr<Core::File> m_body_file;
+    size_t m_body_bytes_remaining { 0 };
+
+    size_t m_requests_served { 0 };
+    bool m_should_close_after_response { false };
+    bool m_is_shutting_down { false };
 };
 
 }
@@ -20,11 +20,19 @@ public:
     String const& document_root_path() const { return m_document_root_path; }
     Optional<HTTP::HttpRequest::BasicAuthenticationCredentials> const& credentials() const { return m_credentials; }
 
+    // How long an idle connection is kept open for further requests, and how many requests it may serve in total.
+    int keep_alive_timeout_milliseconds() const { return m_keep_alive_timeout_milliseconds; }
+    void set_keep_alive_timeout_milliseconds(int milliseconds) { m_keep_alive_timeout_milliseconds = milliseconds; }
+    size_t max_requests_per_connection() const { return m_max_requests_per_connection; }
+    void set_max_requests_per_connection(size_t count) { m_max_requests_per_connection = count; }
+
     static Configuration const& the();
 
 private:
     String m_document_root_path;
     Optional<HTTP::HttpRequest::BasicAuthenticationCredentials> m_credentials;
+    int m_keep_alive_timeout_milliseconds { 5000 };
+    size_t m_max_requests_per_connection { 1000 };
 };
 
 }
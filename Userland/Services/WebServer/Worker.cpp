@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <WebServer/Client.h>
+#include <WebServer/Worker.h>
+
+namespace WebServer {
+
+Worker::Worker(Core::TCPServer& server)
+    : m_server(server)
+{
+    m_notifier = Core::Notifier::construct(m_server.fd(), Core::Notifier::Type::Read, this);
+    m_notifier->on_activation = [this] { accept_clients(); };
+}
+
+void Worker::accept_clients()
+{
+    while (true) {
+        auto maybe_client_socket = m_server.accept();
+        if (maybe_client_socket.is_error()) {
+            // Another worker was faster, or we took everything that was waiting.
+            auto const& error = maybe_client_socket.error();
+            if (error.is_errno() && error.code() == EAGAIN)
+                return;
+            warnln("Failed to accept the client: {}", error);
+            return;
+        }
+
+        auto client = Client::construct(maybe_client_socket.release_value(), this);
+        client->start();
+    }
+}
+
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <LibCore/EventReceiver.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/TCPServer.h>
+
+namespace WebServer {
+
+// Accepts connections on a listening socket shared with the other workers, and serves them on the event loop of the
+// thread it was created on. Whichever worker wakes up first gets the connection.
+class Worker final : public Core::EventReceiver {
+    C_OBJECT(Worker);
+
+private:
+    explicit Worker(Core::TCPServer&);
+
+    void accept_clients();
+
+    Core::TCPServer& m_server;
+    RefPtr<Core::Notifier> m_notifier;
+};
+
+}
@@ -15,9 +15,11 @@
 #include <LibFileSystem/FileSystem.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibMain/Main.h>
-#include <WebServer/Client.h>
+#include <LibThreading/Thread.h>
 #include <WebServer/Configuration.h>
+#include <WebServer/Worker.h>
 #include <stdio.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
@@ -31,12 +33,22 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     ByteString username;
     ByteString password;
     ByteString document_root_path = default_document_root_path.to_byte_string();
+    size_t worker_count = 1;
+    int keep_alive_timeout = 5;
+    size_t max_requests_per_connection = 1000;
+
+#ifdef _SC_NPROCESSORS_ONLN
+    worker_count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
 
     Core::ArgsParser args_parser;
     args_parser.add_option(listen_address, "IP address to listen on", "listen-address", 'l', "listen_address");
     args_parser.add_option(port, "Port to listen on", "port", 'p', "port");
     args_parser.add_option(username, "HTTP basic authentication username", "user", 'U', "username");
     args_parser.add_option(password, "HTTP basic authentication password", "pass", 'P', "password");
+    args_parser.add_option(worker_count, "Number of threads serving clients", "workers", 'w', "count");
+    args_parser.add_option(keep_alive_timeout, "Seconds an idle connection is kept open", "keep-alive-timeout", 't', "seconds");
+    args_parser.add_option(max_requests_per_connection, "Requests a connection may make before it is closed", "max-requests", 'm', "count");
     args_parser.add_positional_argument(document_root_path, "Path to serve the contents of", "path", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
@@ -56,13 +68,18 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         return 1;
     }
 
+    if (worker_count == 0) {
+        warnln("At least one worker is required.");
+        return 1;
+    }
+
     auto real_document_root_path = TRY(FileSystem::real_path(document_root_path));
     if (!FileSystem::exists(real_document_root_path)) {
         warnln("Root path does not exist: '{}'", document_root_path);
         return 1;
     }
 
-    TRY(Core::System::pledge("stdio accept rpath inet unix"));
+    TRY(Core::System::pledge("stdio thread accept rpath inet unix"));
 
     Optional<HTTP::HttpRequest::BasicAuthenticationCredentials> credentials;
     if (!username.is_empty() && !password.is_empty())
@@ -70,31 +87,11 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
     // FIXME: This should accept a ByteString for the path instead.
     WebServer::Configuration configuration(TRY(String::from_byte_string(real_document_root_path)), credentials);
-
-    Core::EventLoop loop;
+    configuration.set_keep_alive_timeout_milliseconds(keep_alive_timeout * 1000);
+    configuration.set_max_requests_per_connection(max_requests_per_connection);
 
     auto server = TRY(Core::TCPServer::try_create());
-
-    server->on_ready_to_accept = [&] {
-        auto maybe_client_socket = server->accept();
-        if (maybe_client_socket.is_error()) {
-            warnln("Failed to accept the client: {}", maybe_client_socket.error());
-            return;
-        }
-
-        auto maybe_buffered_socket = Core::BufferedTCPSocket::create(maybe_client_socket.release_value());
-        if (maybe_buffered_socket.is_error()) {
-            warnln("Could not obtain a buffered socket for the client: {}", maybe_buffered_socket.error());
-            return;
-        }
-
-        // FIXME: Propagate errors
-        MUST(maybe_buffered_socket.value()->set_blocking(true));
-        auto client = WebServer::Client::construct(maybe_buffered_socket.release_value(), server);
-        client->start();
-    };
-
-    TRY(server->listen(ipv4_address.value(), port));
+    TRY(server->listen(ipv4_address.value(), port, Core::TCPServer::AllowAddressReuse::No, SOMAXCONN));
 
     out("Listening on ");
     out("\033]8;;http://{}:{}\033\\", ipv4_address.value(), server->local_port());
@@ -106,6 +103,22 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     TRY(Core::System::unveil(real_document_root_path, "r"sv));
     TRY(Core::System::unveil(nullptr, nullptr));
 
-    TRY(Core::System::pledge("stdio accept rpath"));
-    return loop.exec();
+    TRY(Core::System::pledge("stdio thread accept rpath"));
+
+    // Every worker runs its own event loop and waits for connections on the same listening socket.
+    Vector<NonnullRefPtr<Threading::Thread>> workers;
+    for (size_t i = 0; i < worker_count; ++i) {
+        auto worker = Threading::Thread::construct([&server] {
+            Core::EventLoop loop;
+            auto worker = WebServer::Worker::construct(*server);
+            return static_cast<intptr_t>(loop.exec());
+        },
+            "WebServer worker"sv);
+        worker->start();
+        workers.append(move(worker));
+    }
+
+    for (auto& worker : workers)
+        (void)worker->join();
+    return 0;
 }
@@ -4,17 +4,65 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/LexicalPath.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/File.h>
 #include <LibCore/System.h>
 #include <LibCrypto/Hash/HashManager.h>
 #include <LibMain/Main.h>
+#include <LibThreading/Thread.h>
 #include <unistd.h>
 
+// The manager is reused for every file, and may be left with part of a file that failed to read.
+static ErrorOr<ByteString> checksum_of_file(Crypto::Hash::Manager& hash, StringView path)
+{
+    hash.reset();
+    auto file = TRY(Core::File::open_file_or_standard_stream(path, Core::File::OpenMode::Read));
+    Array<u8, PAGE_SIZE> buffer;
+    while (!file->is_eof())
+        hash.update(TRY(file->read_some(buffer)));
+    return ByteString::formatted("{:hex-dump}", hash.digest().bytes());
+}
+
+// Hashes the files on up to `job_count` threads, and prints the results in the order the paths were given in.
+static ErrorOr<bool> print_checksums_in_parallel(Crypto::Hash::HashKind hash_kind, Vector<StringView> const& paths, size_t job_count)
+{
+    Vector<Optional<ErrorOr<ByteString>>> checksums;
+    checksums.resize(paths.size());
+    Atomic<size_t> next_path_index { 0 };
+
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    for (size_t i = 0; i < min(job_count, paths.size()); ++i) {
+        auto thread = TRY(Threading::Thread::try_create([&] {
+            Crypto::Hash::Manager hash;
+            hash.initialize(hash_kind);
+            for (auto index = next_path_index++; index < paths.size(); index = next_path_index++)
+                checksums[index] = checksum_of_file(hash, paths[index]);
+            return 0;
+        },
+            "checksum"sv));
+        thread->start();
+        threads.append(move(thread));
+    }
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    bool has_error = false;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (checksums[i]->is_error()) {
+            warnln("{}: {}", paths[i], checksums[i]->release_error());
+            has_error = true;
+            continue;
+        }
+        outln("{}  {}", checksums[i]->value(), paths[i]);
+    }
+    return has_error;
+}
+
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
-    TRY(Core::System::pledge("stdio rpath"));
+    TRY(Core::System::pledge("stdio rpath thread"));
 
     auto program_name = LexicalPath::basename(arguments.strings[0]);
     auto hash_kind = Crypto::Hash::HashKind::None;
@@ -39,16 +87,21 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     auto paths_help_string = ByteString::formatted("File(s) to print {} checksum of", hash_name);
 
     bool verify_from_paths = false;
+    size_t job_count = 1;
     Vector<StringView> paths;
 
     Core::ArgsParser args_parser;
     args_parser.add_option(verify_from_paths, "Verify checksums from file(s)", "check", 'c');
+    args_parser.add_option(job_count, "Hash up to this many files at once", "jobs", 'j', "count");
     args_parser.add_positional_argument(paths, paths_help_string.characters(), "path", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
     if (paths.is_empty())
         paths.append("-"sv);
 
+    if (!verify_from_paths && job_count > 1)
+        return TRY(print_checksums_in_parallel(hash_kind, paths, job_count)) ? 1 : 0;
+
     Crypto::Hash::Manager hash;
     hash.initialize(hash_kind);
 
@@ -57,6 +110,18 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     int failed_verification_count = 0;
 
     for (auto const& path : paths) {
+        // Like with --jobs, a file that can't be read doesn't stop us from hashing the others.
+        if (!verify_from_paths) {
+            auto checksum_or_error = checksum_of_file(hash, path);
+            if (checksum_or_error.is_error()) {
+                has_error = true;
+                warnln("{}: {}", path, checksum_or_error.release_error());
+                continue;
+            }
+            outln("{}  {}", checksum_or_error.value(), path);
+            continue;
+        }
+
         auto file_or_error = Core::File::open_file_or_standard_stream(path, Core::File::OpenMode::Read);
         if (file_or_error.is_error()) {
             ++read_fail_count;
@@ -65,46 +130,36 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             continue;
         }
         auto file = file_or_error.release_value();
-        Array<u8, PAGE_SIZE> buffer;
-        if (!verify_from_paths) {
-            while (!file->is_eof())
-                hash.update(TRY(file->read_some(buffer)));
-            outln("{:hex-dump}  {}", hash.digest().bytes(), path);
-        } else {
-            StringBuilder checksum_list_contents;
-            Array<u8, 1> checksum_list_buffer;
-            while (!file->is_eof())
-                checksum_list_contents.append(TRY(file->read_some(checksum_list_buffer)).data()[0]);
-            Vector<StringView> const lines = checksum_list_contents.string_view().split_view("\n"sv);
-
-            for (size_t i = 0; i < lines.size(); ++i) {
-                Vector<StringView> const line = lines[i].split_view("  "sv);
-                if (line.size() != 2) {
-                    ++read_fail_count;
-                    // The real line number is greater than the iterator.
-                    warnln("{}: {}: Failed to parse line {}", program_name, path, i + 1);
-                    continue;
-                }
-
-                // line[0] = checksum
-                // line[1] = filename
-                StringView const filename = line[1];
-                auto file_from_filename_or_error = Core::File::open_file_or_standard_stream(filename, Core::File::OpenMode::Read);
-                if (file_from_filename_or_error.is_error()) {
-                    ++read_fail_count;
-                    warnln("{}: {}", filename, file_from_filename_or_error.release_error());
-                    continue;
-                }
-                auto file_from_filename = file_from_filename_or_error.release_value();
-                hash.reset();
-                while (!file_from_filename->is_eof())
-                    hash.update(TRY(file_from_filename->read_some(buffer)));
-                if (ByteString::formatted("{:hex-dump}", hash.digest().bytes()) == line[0])
-                    outln("{}: OK", filename);
-                else {
-                    ++failed_verification_count;
-                    warnln("{}: FAILED", filename);
-                }
+
+        StringBuilder checksum_list_contents;
+        Array<u8, 1> checksum_list_buffer;
+        while (!file->is_eof())
+            checksum_list_contents.append(TRY(file->read_some(checksum_list_buffer)).data()[0]);
+        Vector<StringView> const lines = checksum_list_contents.string_view().split_view("\n"sv);
+
+        for (size_t i = 0; i < lines.size(); ++i) {
+            Vector<StringView> const line = lines[i].split_view("  "sv);
+            if (line.size() != 2) {
+                ++read_fail_count;
+                // The real line number is greater than the iterator.
+                warnln("{}: {}: Failed to parse line {}", program_name, path, i + 1);
+                continue;
+            }
+
+            // line[0] = checksum
+            // line[1] = filename
+            StringView const filename = line[1];
+            auto checksum_or_error = checksum_of_file(hash, filename);
+            if (checksum_or_error.is_error()) {
+                ++read_fail_count;
+                warnln("{}: {}", filename, checksum_or_error.release_error());
+                continue;
+            }
+            if (checksum_or_error.value() == line[0])
+                outln("{}: OK", filename);
+            else {
+                ++failed_verification_count;
+                warnln("{}: FAILED", filename);
             }
         }
     }
@@ -6,23 +6,63 @@
 
 #include <AK/IPv4Address.h>
 #include <LibCore/ArgsParser.h>
+#include <LibCore/EventLoop.h>
 #include <LibCore/System.h>
+#include <LibIPC/ConnectionToServer.h>
 #include <LibMain/Main.h>
+#include <LookupServer/LookupClientEndpoint.h>
+#include <LookupServer/LookupServerEndpoint.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <string.h>
 
+class LookupServerConnection final
+    : public IPC::ConnectionToServer<LookupClientEndpoint, LookupServerEndpoint>
+    , public LookupClientEndpoint {
+    IPC_CLIENT_CONNECTION(LookupServerConnection, "/tmp/portal/lookup"sv)
+
+private:
+    LookupServerConnection(NonnullOwnPtr<Core::LocalSocket> socket)
+        : IPC::ConnectionToServer<LookupClientEndpoint, LookupServerEndpoint>(*this, move(socket))
+    {
+    }
+};
+
+static ErrorOr<int> print_cache_statistics()
+{
+    Core::EventLoop loop;
+    auto connection = TRY(LookupServerConnection::try_create());
+    auto statistics = connection->cache_statistics();
+
+    outln("Entries:   {} of {}", statistics.entries(), statistics.capacity());
+    outln("Hits:      {} ({} negative)", statistics.hits() + statistics.negative_hits(), statistics.negative_hits());
+    outln("Misses:    {}", statistics.misses());
+    outln("Evictions: {}", statistics.evictions());
+    outln("Refreshes: {}", statistics.refreshes());
+    return 0;
+}
+
 ErrorOr<int> serenity_main(Main::Arguments args)
 {
     TRY(Core::System::pledge("stdio unix"));
 
     ByteString name_or_ip {};
+    bool show_cache_statistics = false;
     Core::ArgsParser args_parser;
     args_parser.set_general_help("Convert between domain name and IPv4 address.");
-    args_parser.add_positional_argument(name_or_ip, "Domain name or IPv4 address", "name");
+    args_parser.add_option(show_cache_statistics, "Show statistics of LookupServer's cache instead", "cache-statistics", 's');
+    args_parser.add_positional_argument(name_or_ip, "Domain name or IPv4 address", "name", Core::ArgsParser::Required::No);
     args_parser.parse(args);
 
+    if (show_cache_statistics)
+        return print_cache_statistics();
+
+    if (name_or_ip.is_empty()) {
+        args_parser.print_usage(stderr, args.strings[0]);
+        return 1;
+    }
+
     // If input looks like an IPv4 address, we should do a reverse lookup.
     auto ip_address = IPv4Address::from_string(name_or_ip);
     if (ip_address.has_value()) {
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/NumberFormat.h>
+#include <AK/Queue.h>
+#include <AK/QuickSort.h>
+#include <AK/Time.h>
+#include <AK/URL.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/Socket.h>
+#include <LibCore/System.h>
+#include <LibCore/Timer.h>
+#include <LibMain/Main.h>
+#include <signal.h>
+
+struct Target {
+    ByteString host;
+    u16 port { 0 };
+    ByteString request;
+    size_t pipeline_depth { 1 };
+    bool keep_alive { true };
+};
+
+struct Statistics {
+    size_t completed_requests { 0 };
+    size_t failed_requests { 0 };
+    size_t non_success_responses { 0 };
+    u64 received_bytes { 0 };
+    Vector<u64> latencies_in_microseconds;
+};
+
+static bool s_is_running = true;
+
+// Keeps `pipeline_depth` requests in flight on one connection, and measures how long each took from being sent until
+// the last byte of its response arrived.
+class Connection {
+public:
+    Connection(Target const& target, Statistics& statistics)
+        : m_target(target)
+        , m_statistics(statistics)
+    {
+    }
+
+    void start()
+    {
+        auto socket_or_error = Core::TCPSocket::connect(m_target.host, m_target.port);
+        if (socket_or_error.is_error()) {
+            warnln("Failed to connect to {}:{}: {}", m_target.host, m_target.port, socket_or_error.error());
+            s_is_running = false;
+            Core::EventLoop::current().quit(1);
+            return;
+        }
+        m_socket = socket_or_error.release_value();
+        if (auto result = m_socket->set_blocking(false); result.is_error())
+            return fail(result.release_error());
+        m_socket->on_ready_to_read = [this] { read_responses(); };
+
+        auto request_count = m_target.keep_alive ? m_target.pipeline_depth : 1;
+        for (size_t i = 0; i < request_count; ++i)
+            send_request();
+    }
+
+private:
+    void send_request()
+    {
+        if (m_restart_is_pending)
+            return;
+        m_request_start_times.enqueue(MonotonicTime::now());
+        if (auto result = m_socket->write_until_depleted(m_target.request.bytes()); result.is_error())
+            fail(result.release_error());
+    }
+
+    void read_responses()
+    {
+        bool server_has_closed = false;
+        while (true) {
+            u8 buffer[64 * KiB];
+            auto result = m_socket->read_some({ buffer, sizeof(buffer) });
+            if (result.is_error()) {
+                if (result.error().is_errno() && result.error().code() == EAGAIN)
+                    break;
+                return fail(result.release_error());
+            }
+            if (result.value().is_empty()) {
+                server_has_closed = true;
+                break;
+            }
+            m_input.append(result.value());
+            m_statistics.received_bytes += result.value().size();
+        }
+
+        while (!m_request_start_times.is_empty()) {
+            auto response = parse_response();
+            if (response.is_error())
+                return fail(response.release_error());
+            if (!response.value())
+                break;
+
+            if (!s_is_running)
+                return;
+            if (!m_target.keep_alive || m_server_will_close)
+                return restart_later();
+            send_request();
+        }
+
+        if (server_has_closed) {
+            if (!m_request_start_times.is_empty())
+                return fail(Error::from_string_literal("Connection closed by the server"));
+            restart_later();
+        }
+    }
+
+    // Returns whether a complete response was consumed from the input.
+    ErrorOr<bool> parse_response()
+    {
+        auto data = StringView { m_input.bytes() };
+        auto header_end = data.find("\r\n\r\n"sv);
+        if (!header_end.has_value())
+            return false;
+
+        auto lines = data.substring_view(0, *header_end).split_view("\r\n"sv);
+        auto status_line = lines.take_first().split_view(' ');
+        if (status_line.size() < 2 || !status_line[0].starts_with("HTTP/"sv))
+            return Error::from_string_literal("Invalid status line");
+        auto status = status_line[1].to_number<unsigned>();
+        if (!status.has_value())
+            return Error::from_string_literal("Invalid status code");
+
+        Optional<size_t> content_length;
+        for (auto line : lines) {
+            auto colon = line.find(':');
+            if (!colon.has_value())
+                continue;
+            auto name = line.substring_view(0, *colon);
+            auto value = line.substring_view(*colon + 1).trim_whitespace();
+            if (name.equals_ignoring_ascii_case("Content-Length"sv))
+                content_length = value.to_number<size_t>();
+
+            // Requests that were pipelined behind this one won't be answered, and are sent again on a new connection.
+            if (name.equals_ignoring_ascii_case("Connection"sv) && value.equals_ignoring_ascii_case("close"sv))
+                m_server_will_close = true;
+        }
+        if (!content_length.has_value())
+            return Error::from_string_literal("Response without a Content-Length");
+
+        auto response_size = *header_end + 4 + *content_length;
+        if (m_input.size() < response_size)
+            return false;
+        m_input = TRY(m_input.slice(response_size, m_input.size() - response_size));
+
+        auto latency = MonotonicTime::now() - m_request_start_times.dequeue();
+        if (s_is_running) {
+            ++m_statistics.completed_requests;
+            if (*status >= 400)
+                ++m_statistics.non_success_responses;
+            TRY(m_statistics.latencies_in_microseconds.try_append(latency.to_microseconds()));
+        }
+        return true;
+    }
+
+    void fail(Error error)
+    {
+        if (s_is_running) {
+            dbgln("Request failed: {}", error);
+            m_statistics.failed_requests += max(m_request_start_times.size(), 1u);
+        }
+        restart_later();
+    }
+
+    void restart()
+    {
+        m_restart_is_pending = false;
+        m_server_will_close = false;
+        m_socket = nullptr;
+        m_input.clear();
+        m_request_start_times.clear();
+        if (s_is_running)
+            start();
+    }
+
+    // The socket can't be destroyed from within its own callback.
+    void restart_later()
+    {
+        if (m_restart_is_pending)
+            return;
+        m_restart_is_pending = true;
+        if (m_socket)
+            m_socket->set_notifications_enabled(false);
+        Core::deferred_invoke([this] { restart(); });
+    }
+
+    Target const& m_target;
+    Statistics& m_statistics;
+    OwnPtr<Core::TCPSocket> m_socket;
+    ByteBuffer m_input;
+    Queue<MonotonicTime> m_request_start_times;
+    bool m_restart_is_pending { false };
+    bool m_server_will_close { false };
+};
+
+static u64 percentile(Vector<u64> const& sorted_values, double fraction)
+{
+    if (sorted_values.is_empty())
+        return 0;
+    auto index = min(static_cast<size_t>(fraction * sorted_values.size()), sorted_values.size() - 1);
+    return sorted_values[index];
+}
+
+ErrorOr<int> serenity_main(Main::Arguments arguments)
+{
+    StringView url_string;
+    size_t connection_count = 16;
+    int duration_in_seconds = 10;
+    size_t pipeline_depth = 1;
+    bool no_keep_alive = false;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Load an HTTP/1.1 server with concurrent requests, and report throughput and latency.");
+    args_parser.add_option(connection_count, "Number of concurrent connections", "connections", 'c', "count");
+    args_parser.add_option(duration_in_seconds, "How long to run for", "duration", 'd', "seconds");
+    args_parser.add_option(pipeline_depth, "Requests in flight on each connection", "pipeline", 'p', "depth");
+    args_parser.add_option(no_keep_alive, "Open a new connection for every request", "no-keep-alive", 'n');
+    args_parser.add_positional_argument(url_string, "URL to request", "url");
+    args_parser.parse(arguments);
+
+    URL url(url_string);
+    if (!url.is_valid() || url.scheme() != "http"sv) {
+        warnln("Invalid URL, only http:// is supported: {}", url_string);
+        return 1;
+    }
+    if (connection_count == 0 || pipeline_depth == 0) {
+        warnln("Need at least one connection and one request in flight");
+        return 1;
+    }
+
+    Target target;
+    target.host = TRY(url.serialized_host()).to_byte_string();
+    target.port = url.port_or_default();
+    target.pipeline_depth = pipeline_depth;
+    target.keep_alive = !no_keep_alive;
+    target.request = ByteString::formatted("GET {} HTTP/1.1\r\nHost: {}\r\nConnection: {}\r\n\r\n",
+        url.serialize_path(URL::ApplyPercentDecoding::No), target.host, no_keep_alive ? "close"sv : "keep-alive"sv);
+
+    // A write to a connection that the server just closed is handled like any other error.
+    TRY(Core::System::signal(SIGPIPE, SIG_IGN));
+
+    Core::EventLoop loop;
+    Statistics statistics;
+    Vector<NonnullOwnPtr<Connection>> connections;
+    for (size_t i = 0; i < connection_count; ++i) {
+        auto connection = make<Connection>(target, statistics);
+        connection->start();
+        connections.append(move(connection));
+    }
+
+    auto timer = Core::ElapsedTimer::start_new();
+    auto stop_timer = TRY(Core::Timer::create_single_shot(duration_in_seconds * 1000, [&] {
+        s_is_running = false;
+        loop.quit(0);
+    }));
+    stop_timer->start();
+    if (loop.exec() != 0)
+        return 1;
+
+    auto elapsed_seconds = timer.elapsed_milliseconds() / 1000.0;
+    auto& latencies = statistics.latencies_in_microseconds;
+    quick_sort(latencies);
+    u64 total_latency = 0;
+    for (auto latency : latencies)
+        total_latency += latency;
+
+    outln("{} connections, pipeline depth {}, {}", connection_count, pipeline_depth, no_keep_alive ? "no keep-alive" : "keep-alive");
+    outln("Requests:   {} completed, {} failed, {} with an error status", statistics.completed_requests, statistics.failed_requests, statistics.non_success_responses);
+    outln("Throughput: {:.1} requests/s, {}/s", statistics.completed_requests / elapsed_seconds, human_readable_size(statistics.received_bytes / elapsed_seconds));
+    outln("Latency:    avg {:.2}ms, p50 {:.2}ms, p90 {:.2}ms, p99 {:.2}ms, max {:.2}ms",
+        latencies.is_empty() ? 0.0 : total_latency / latencies.size() / 1000.0,
+        percentile(latencies, 0.5) / 1000.0,
+        percentile(latencies, 0.9) / 1000.0,
+        percentile(latencies, 0.99) / 1000.0,
+        latencies.is_empty() ? 0.0 : latencies.last() / 1000.0);
+    return 0;
+}
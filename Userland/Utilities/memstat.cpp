@@ -45,6 +45,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     u64 physical_uncommitted = json.get_u64("physical_uncommitted"sv).value_or(0);
     u32 kmalloc_call_count = json.get_u32("kmalloc_call_count"sv).value_or(0);
     u32 kfree_call_count = json.get_u32("kfree_call_count"sv).value_or(0);
+    u64 kmalloc_lock_acquire_count = json.get_u64("kmalloc_lock_acquire_count"sv).value_or(0);
+    u64 kmalloc_lock_contended_count = json.get_u64("kmalloc_lock_contended_count"sv).value_or(0);
 
     u64 kmalloc_bytes_total = kmalloc_allocated + kmalloc_available;
     u64 physical_pages_total = physical_allocated + physical_available;
@@ -66,5 +68,6 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     outln("Kmalloc call count: {}", kmalloc_call_count);
     outln("Kfree call count: {}", kfree_call_count);
     outln("Kmalloc/Kfree delta: {}", TRY(String::formatted("{:+}", kmalloc_call_count - kfree_call_count)));
+    outln("Kmalloc lock acquisitions: {} ({} contended)", kmalloc_lock_acquire_count, kmalloc_lock_contended_count);
     return 0;
 }
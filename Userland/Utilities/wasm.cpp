@@ -8,6 +8,7 @@
 #include <AK/MemoryStream.h>
 #include <AK/StackInfo.h>
 #include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
 #include <LibCore/File.h>
 #include <LibCore/MappedFile.h>
 #include <LibFileSystem/FileSystem.h>
@@ -282,6 +283,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     bool export_all_imports = false;
     bool shell_mode = false;
     bool wasi = false;
+    bool jit = false;
+    size_t repeat_count = 0;
     ByteString exported_function_to_execute;
     Vector<u64> values_to_push;
     Vector<ByteString> modules_to_link_in;
@@ -297,6 +300,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     parser.add_option(export_all_imports, "Export noop functions corresponding to imports", "export-noop", 0);
     parser.add_option(shell_mode, "Launch a REPL in the module's context (implies -i)", "shell", 's');
     parser.add_option(wasi, "Enable WASI", "wasi", 'w');
+    parser.add_option(jit, "Compile functions to native code where possible", "jit", 0);
+    parser.add_option(repeat_count, "Time this many executions of the function before running it once more for its result", "repeat", 0, "count");
     parser.add_option(Core::ArgsParser::Option {
         .argument_mode = Core::ArgsParser::OptionArgumentMode::Required,
         .help_string = "Directory mappings to expose via WASI",
@@ -373,6 +378,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
     if (attempt_instantiate) {
         Wasm::AbstractMachine machine;
+        if (jit)
+            machine.enable_jit();
         Optional<Wasm::Wasi::Implementation> wasi_impl;
 
         if (wasi) {
@@ -509,7 +516,6 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             Wasm::Expression expression { {} };
             config.set_frame(Wasm::Frame {
                 *module_instance,
-                Vector<Wasm::Value> {},
                 expression,
                 0,
             });
@@ -582,6 +588,18 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
                 outln();
             }
 
+            if (repeat_count > 0) {
+                Core::ElapsedTimer timer { true };
+                timer.start();
+                for (size_t i = 0; i < repeat_count; ++i) {
+                    auto result = machine.invoke(g_interpreter, run_address.value(), values).assert_wasm_result();
+                    if (result.is_trap())
+                        break;
+                }
+                auto elapsed = timer.elapsed_time();
+                warnln("Executed {} times in {}ms ({}us per call)", repeat_count, elapsed.to_milliseconds(), elapsed.to_microseconds() / static_cast<i64>(repeat_count));
+            }
+
             auto result = machine.invoke(g_interpreter, run_address.value(), move(values)).assert_wasm_result();
 
             if (debug)